@@ -17,6 +17,7 @@ typedef struct
 ** Cash ops
 */
 PG_FUNCTION_INFO_V1(gbt_cash_compress);
+PG_FUNCTION_INFO_V1(gbt_cash_fetch);
 PG_FUNCTION_INFO_V1(gbt_cash_union);
 PG_FUNCTION_INFO_V1(gbt_cash_picksplit);
 PG_FUNCTION_INFO_V1(gbt_cash_consistent);
@@ -25,6 +26,7 @@ PG_FUNCTION_INFO_V1(gbt_cash_penalty);
 PG_FUNCTION_INFO_V1(gbt_cash_same);
 
 Datum		gbt_cash_compress(PG_FUNCTION_ARGS);
+Datum		gbt_cash_fetch(PG_FUNCTION_ARGS);
 Datum		gbt_cash_union(PG_FUNCTION_ARGS);
 Datum		gbt_cash_picksplit(PG_FUNCTION_ARGS);
 Datum		gbt_cash_consistent(PG_FUNCTION_ARGS);
@@ -132,6 +134,14 @@ gbt_cash_compress(PG_FUNCTION_ARGS)
 	PG_RETURN_POINTER(gbt_num_compress(retval, entry, &tinfo));
 }
 
+Datum
+gbt_cash_fetch(PG_FUNCTION_ARGS)
+{
+	GISTENTRY  *entry = (GISTENTRY *) PG_GETARG_POINTER(0);
+
+	PG_RETURN_POINTER(gbt_num_fetch(entry, &tinfo));
+}
+
 
 Datum
 gbt_cash_consistent(PG_FUNCTION_ARGS)
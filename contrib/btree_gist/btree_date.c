@@ -17,6 +17,7 @@ typedef struct
 ** date ops
 */
 PG_FUNCTION_INFO_V1(gbt_date_compress);
+PG_FUNCTION_INFO_V1(gbt_date_fetch);
 PG_FUNCTION_INFO_V1(gbt_date_union);
 PG_FUNCTION_INFO_V1(gbt_date_picksplit);
 PG_FUNCTION_INFO_V1(gbt_date_consistent);
@@ -25,6 +26,7 @@ PG_FUNCTION_INFO_V1(gbt_date_penalty);
 PG_FUNCTION_INFO_V1(gbt_date_same);
 
 Datum		gbt_date_compress(PG_FUNCTION_ARGS);
+Datum		gbt_date_fetch(PG_FUNCTION_ARGS);
 Datum		gbt_date_union(PG_FUNCTION_ARGS);
 Datum		gbt_date_picksplit(PG_FUNCTION_ARGS);
 Datum		gbt_date_consistent(PG_FUNCTION_ARGS);
@@ -143,6 +145,14 @@ gbt_date_compress(PG_FUNCTION_ARGS)
 	PG_RETURN_POINTER(gbt_num_compress(retval, entry, &tinfo));
 }
 
+Datum
+gbt_date_fetch(PG_FUNCTION_ARGS)
+{
+	GISTENTRY  *entry = (GISTENTRY *) PG_GETARG_POINTER(0);
+
+	PG_RETURN_POINTER(gbt_num_fetch(entry, &tinfo));
+}
+
 
 
 Datum
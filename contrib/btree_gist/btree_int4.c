@@ -16,6 +16,7 @@ typedef struct int32key
 ** int32 ops
 */
 PG_FUNCTION_INFO_V1(gbt_int4_compress);
+PG_FUNCTION_INFO_V1(gbt_int4_fetch);
 PG_FUNCTION_INFO_V1(gbt_int4_union);
 PG_FUNCTION_INFO_V1(gbt_int4_picksplit);
 PG_FUNCTION_INFO_V1(gbt_int4_consistent);
@@ -24,6 +25,7 @@ PG_FUNCTION_INFO_V1(gbt_int4_penalty);
 PG_FUNCTION_INFO_V1(gbt_int4_same);
 
 Datum		gbt_int4_compress(PG_FUNCTION_ARGS);
+Datum		gbt_int4_fetch(PG_FUNCTION_ARGS);
 Datum		gbt_int4_union(PG_FUNCTION_ARGS);
 Datum		gbt_int4_picksplit(PG_FUNCTION_ARGS);
 Datum		gbt_int4_consistent(PG_FUNCTION_ARGS);
@@ -133,6 +135,14 @@ gbt_int4_compress(PG_FUNCTION_ARGS)
 	PG_RETURN_POINTER(gbt_num_compress(retval, entry, &tinfo));
 }
 
+Datum
+gbt_int4_fetch(PG_FUNCTION_ARGS)
+{
+	GISTENTRY  *entry = (GISTENTRY *) PG_GETARG_POINTER(0);
+
+	PG_RETURN_POINTER(gbt_num_fetch(entry, &tinfo));
+}
+
 
 Datum
 gbt_int4_consistent(PG_FUNCTION_ARGS)
@@ -18,6 +18,7 @@ typedef struct
 ** OID ops
 */
 PG_FUNCTION_INFO_V1(gbt_macad_compress);
+PG_FUNCTION_INFO_V1(gbt_macad_fetch);
 PG_FUNCTION_INFO_V1(gbt_macad_union);
 PG_FUNCTION_INFO_V1(gbt_macad_picksplit);
 PG_FUNCTION_INFO_V1(gbt_macad_consistent);
@@ -25,6 +26,7 @@ PG_FUNCTION_INFO_V1(gbt_macad_penalty);
 PG_FUNCTION_INFO_V1(gbt_macad_same);
 
 Datum		gbt_macad_compress(PG_FUNCTION_ARGS);
+Datum		gbt_macad_fetch(PG_FUNCTION_ARGS);
 Datum		gbt_macad_union(PG_FUNCTION_ARGS);
 Datum		gbt_macad_picksplit(PG_FUNCTION_ARGS);
 Datum		gbt_macad_consistent(PG_FUNCTION_ARGS);
@@ -120,6 +122,14 @@ gbt_macad_compress(PG_FUNCTION_ARGS)
 	PG_RETURN_POINTER(gbt_num_compress(retval, entry, &tinfo));
 }
 
+Datum
+gbt_macad_fetch(PG_FUNCTION_ARGS)
+{
+	GISTENTRY  *entry = (GISTENTRY *) PG_GETARG_POINTER(0);
+
+	PG_RETURN_POINTER(gbt_num_fetch(entry, &tinfo));
+}
+
 
 Datum
 gbt_macad_consistent(PG_FUNCTION_ARGS)
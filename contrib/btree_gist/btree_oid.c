@@ -16,6 +16,7 @@ typedef struct
 ** OID ops
 */
 PG_FUNCTION_INFO_V1(gbt_oid_compress);
+PG_FUNCTION_INFO_V1(gbt_oid_fetch);
 PG_FUNCTION_INFO_V1(gbt_oid_union);
 PG_FUNCTION_INFO_V1(gbt_oid_picksplit);
 PG_FUNCTION_INFO_V1(gbt_oid_consistent);
@@ -24,6 +25,7 @@ PG_FUNCTION_INFO_V1(gbt_oid_penalty);
 PG_FUNCTION_INFO_V1(gbt_oid_same);
 
 Datum		gbt_oid_compress(PG_FUNCTION_ARGS);
+Datum		gbt_oid_fetch(PG_FUNCTION_ARGS);
 Datum		gbt_oid_union(PG_FUNCTION_ARGS);
 Datum		gbt_oid_picksplit(PG_FUNCTION_ARGS);
 Datum		gbt_oid_consistent(PG_FUNCTION_ARGS);
@@ -133,6 +135,14 @@ gbt_oid_compress(PG_FUNCTION_ARGS)
 	PG_RETURN_POINTER(gbt_num_compress(retval, entry, &tinfo));
 }
 
+Datum
+gbt_oid_fetch(PG_FUNCTION_ARGS)
+{
+	GISTENTRY  *entry = (GISTENTRY *) PG_GETARG_POINTER(0);
+
+	PG_RETURN_POINTER(gbt_num_fetch(entry, &tinfo));
+}
+
 
 Datum
 gbt_oid_consistent(PG_FUNCTION_ARGS)
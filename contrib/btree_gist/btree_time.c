@@ -18,6 +18,7 @@ typedef struct
 ** time ops
 */
 PG_FUNCTION_INFO_V1(gbt_time_compress);
+PG_FUNCTION_INFO_V1(gbt_time_fetch);
 PG_FUNCTION_INFO_V1(gbt_timetz_compress);
 PG_FUNCTION_INFO_V1(gbt_time_union);
 PG_FUNCTION_INFO_V1(gbt_time_picksplit);
@@ -28,6 +29,7 @@ PG_FUNCTION_INFO_V1(gbt_time_penalty);
 PG_FUNCTION_INFO_V1(gbt_time_same);
 
 Datum		gbt_time_compress(PG_FUNCTION_ARGS);
+Datum		gbt_time_fetch(PG_FUNCTION_ARGS);
 Datum		gbt_timetz_compress(PG_FUNCTION_ARGS);
 Datum		gbt_time_union(PG_FUNCTION_ARGS);
 Datum		gbt_time_picksplit(PG_FUNCTION_ARGS);
@@ -172,6 +174,14 @@ gbt_time_compress(PG_FUNCTION_ARGS)
 	PG_RETURN_POINTER(gbt_num_compress(retval, entry, &tinfo));
 }
 
+Datum
+gbt_time_fetch(PG_FUNCTION_ARGS)
+{
+	GISTENTRY  *entry = (GISTENTRY *) PG_GETARG_POINTER(0);
+
+	PG_RETURN_POINTER(gbt_num_fetch(entry, &tinfo));
+}
+
 
 Datum
 gbt_timetz_compress(PG_FUNCTION_ARGS)
@@ -18,6 +18,7 @@ typedef struct
 ** timestamp ops
 */
 PG_FUNCTION_INFO_V1(gbt_ts_compress);
+PG_FUNCTION_INFO_V1(gbt_ts_fetch);
 PG_FUNCTION_INFO_V1(gbt_tstz_compress);
 PG_FUNCTION_INFO_V1(gbt_ts_union);
 PG_FUNCTION_INFO_V1(gbt_ts_picksplit);
@@ -29,6 +30,7 @@ PG_FUNCTION_INFO_V1(gbt_ts_penalty);
 PG_FUNCTION_INFO_V1(gbt_ts_same);
 
 Datum		gbt_ts_compress(PG_FUNCTION_ARGS);
+Datum		gbt_ts_fetch(PG_FUNCTION_ARGS);
 Datum		gbt_tstz_compress(PG_FUNCTION_ARGS);
 Datum		gbt_ts_union(PG_FUNCTION_ARGS);
 Datum		gbt_ts_picksplit(PG_FUNCTION_ARGS);
@@ -245,6 +247,14 @@ gbt_ts_compress(PG_FUNCTION_ARGS)
 	PG_RETURN_POINTER(gbt_num_compress(retval, entry, &tinfo));
 }
 
+Datum
+gbt_ts_fetch(PG_FUNCTION_ARGS)
+{
+	GISTENTRY  *entry = (GISTENTRY *) PG_GETARG_POINTER(0);
+
+	PG_RETURN_POINTER(gbt_num_fetch(entry, &tinfo));
+}
+
 
 Datum
 gbt_tstz_compress(PG_FUNCTION_ARGS)
@@ -130,6 +130,8 @@ extern GIST_SPLITVEC *gbt_num_picksplit(const GistEntryVector *entryvec, GIST_SP
 extern GISTENTRY *gbt_num_compress(GISTENTRY *retval, GISTENTRY *entry,
 				 const gbtree_ninfo *tinfo);
 
+extern GISTENTRY *gbt_num_fetch(GISTENTRY *entry, const gbtree_ninfo *tinfo);
+
 
 extern void *gbt_num_union(GBT_NUMKEY *out, const GistEntryVector *entryvec,
 			  const gbtree_ninfo *tinfo);
@@ -29,7 +29,10 @@ typedef struct
 
 
 PG_FUNCTION_INFO_V1(gbt_var_decompress);
+PG_FUNCTION_INFO_V1(gbt_var_fetch);
+
 Datum		gbt_var_decompress(PG_FUNCTION_ARGS);
+Datum		gbt_var_fetch(PG_FUNCTION_ARGS);
 
 
 Datum
@@ -52,6 +55,26 @@ gbt_var_decompress(PG_FUNCTION_ARGS)
 	PG_RETURN_POINTER(entry);
 }
 
+/*
+ * Return the original value of a leaf key, for index-only scans.  Leaf keys
+ * hold the value itself as both bounds, so just return the lower one.
+ */
+Datum
+gbt_var_fetch(PG_FUNCTION_ARGS)
+{
+	GISTENTRY  *entry = (GISTENTRY *) PG_GETARG_POINTER(0);
+	GBT_VARKEY *key = (GBT_VARKEY *) DatumGetPointer(PG_DETOAST_DATUM(entry->key));
+	GBT_VARKEY_R r = gbt_var_key_readable(key);
+	GISTENTRY  *retval;
+
+	retval = palloc(sizeof(GISTENTRY));
+	gistentryinit(*retval, PointerGetDatum(r.lower),
+				  entry->rel, entry->page,
+				  entry->offset, TRUE);
+
+	PG_RETURN_POINTER(retval);
+}
+
 /* Returns a better readable representaion of variable key ( sets pointer ) */
 GBT_VARKEY_R
 gbt_var_key_readable(const GBT_VARKEY *k)
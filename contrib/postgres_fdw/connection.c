@@ -34,6 +34,11 @@
  * commands at the same nesting depth on the remote as we're executing at
  * ourselves, so that rolling back a subtransaction will kill the right
  * queries and not the wrong ones.
+ *
+ * pending_scan is the scan, if any, that has sent a FETCH on the connection
+ * asynchronously and not yet collected its result.  Anyone else wanting to
+ * use the connection must make that scan collect it first; see
+ * pgfdw_complete_pending.
  */
 typedef struct ConnCacheKey
 {
@@ -49,6 +54,7 @@ typedef struct ConnCacheEntry
 								 * one level of subxact open, etc */
 	bool		have_prep_stmt; /* have we prepared any stmts in this xact? */
 	bool		have_error;		/* have any subxacts aborted in this xact? */
+	ForeignScanState *pending_scan; /* scan with a FETCH in progress */
 } ConnCacheEntry;
 
 /*
@@ -67,6 +73,7 @@ static bool xact_got_connection = false;
 static PGconn *connect_pg_server(ForeignServer *server, UserMapping *user);
 static void check_conn_params(const char **keywords, const char **values);
 static void configure_remote_session(PGconn *conn);
+static ConnCacheEntry *find_conn_entry(PGconn *conn);
 static void do_sql_command(PGconn *conn, const char *sql);
 static void begin_remote_xact(ConnCacheEntry *entry);
 static void pgfdw_xact_callback(XactEvent event, void *arg);
@@ -142,6 +149,7 @@ GetConnection(ForeignServer *server, UserMapping *user,
 		entry->xact_depth = 0;
 		entry->have_prep_stmt = false;
 		entry->have_error = false;
+		entry->pending_scan = NULL;
 	}
 
 	/*
@@ -160,6 +168,7 @@ GetConnection(ForeignServer *server, UserMapping *user,
 		entry->xact_depth = 0;	/* just to be sure */
 		entry->have_prep_stmt = false;
 		entry->have_error = false;
+		entry->pending_scan = NULL;
 		entry->conn = connect_pg_server(server, user);
 		elog(DEBUG3, "new postgres_fdw connection %p for server \"%s\"",
 			 entry->conn, server->servername);
@@ -353,6 +362,8 @@ do_sql_command(PGconn *conn, const char *sql)
 {
 	PGresult   *res;
 
+	pgfdw_complete_pending(conn);
+
 	res = PQexec(conn, sql);
 	if (PQresultStatus(res) != PGRES_COMMAND_OK)
 		pgfdw_report_error(ERROR, res, conn, true, sql);
@@ -418,6 +429,70 @@ ReleaseConnection(PGconn *conn)
 	 */
 }
 
+/*
+ * Find the connection cache entry for a connection.  Returns NULL if there
+ * is none, which happens only while the connection is being established.
+ */
+static ConnCacheEntry *
+find_conn_entry(PGconn *conn)
+{
+	HASH_SEQ_STATUS scan;
+	ConnCacheEntry *entry;
+
+	hash_seq_init(&scan, ConnectionHash);
+	while ((entry = (ConnCacheEntry *) hash_seq_search(&scan)))
+	{
+		if (entry->conn == conn)
+		{
+			hash_seq_term(&scan);
+			return entry;
+		}
+	}
+
+	return NULL;
+}
+
+/*
+ * Record which scan, if any, has an asynchronous FETCH in progress on the
+ * connection.
+ */
+void
+pgfdw_set_pending_scan(PGconn *conn, ForeignScanState *node)
+{
+	ConnCacheEntry *entry = find_conn_entry(conn);
+
+	if (entry == NULL)
+		elog(ERROR, "could not find postgres_fdw connection %p", conn);
+	entry->pending_scan = node;
+}
+
+/*
+ * Return the scan that has an asynchronous FETCH in progress on the
+ * connection, or NULL if there is none.
+ */
+ForeignScanState *
+pgfdw_get_pending_scan(PGconn *conn)
+{
+	ConnCacheEntry *entry = find_conn_entry(conn);
+
+	return entry ? entry->pending_scan : NULL;
+}
+
+/*
+ * Make sure no asynchronous FETCH is in progress on the connection, by
+ * having the scan that sent it collect its result.  This must be done
+ * before sending any other command on the connection.
+ */
+void
+pgfdw_complete_pending(PGconn *conn)
+{
+	ConnCacheEntry *entry = find_conn_entry(conn);
+
+	/* pgfdw_collect_fetch resets pending_scan once it has the result */
+	if (entry != NULL && entry->pending_scan != NULL)
+		pgfdw_collect_fetch(entry->pending_scan);
+}
+
 /*
  * Assign a "unique" number for a cursor.
  *
@@ -539,6 +614,12 @@ pgfdw_xact_callback(XactEvent event, void *arg)
 		if (entry->conn == NULL)
 			continue;
 
+		/*
+		 * Any scan still waiting for a FETCH is not going to collect it now;
+		 * the commands below will discard its result.
+		 */
+		entry->pending_scan = NULL;
+
 		/* If it has an open remote transaction, try to close it */
 		if (entry->xact_depth > 0)
 		{
@@ -696,6 +777,12 @@ pgfdw_subxact_callback(SubXactEvent event, SubTransactionId mySubid,
 		}
 		else
 		{
+			/*
+			 * We can't safely collect a pending FETCH while aborting, so let
+			 * the rollback discard it; its scan will complain if it's ever
+			 * asked for the result.
+			 */
+			entry->pending_scan = NULL;
 			/* Assume we might have lost track of prepared statements */
 			entry->have_error = true;
 			/* Rollback all remote subtransactions during abort */
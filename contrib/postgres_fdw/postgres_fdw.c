@@ -46,6 +46,9 @@ PG_MODULE_MAGIC;
 /* Default CPU cost to process 1 row (above and beyond cpu_tuple_cost). */
 #define DEFAULT_FDW_TUPLE_COST		0.01
 
+/* Number of rows to FETCH at a time; arbitrary, but shouldn't be enormous. */
+#define FETCH_SIZE					100
+
 /*
  * FDW-specific planner information kept in RelOptInfo.fdw_private for a
  * foreign table.  This information is collected by postgresGetForeignRelSize.
@@ -153,8 +156,23 @@ typedef struct PgFdwScanState
 	int			fetch_ct_2;		/* Min(# of fetches done, 2) */
 	bool		eof_reached;	/* true if last fetch reached EOF */
 
+	/*
+	 * For asynchronous execution, a FETCH can be sent before we need its
+	 * rows; once collected, they wait here until the current batch is used
+	 * up.  Once a scan has been started asynchronously, we also send the
+	 * FETCH for each following batch as soon as the previous one is moved
+	 * into place, so it arrives while the current batch is returned.
+	 */
+	bool		is_async;		/* started by StartForeignScanAsync? */
+	bool		fetch_pending;	/* sent a FETCH we haven't collected yet? */
+	bool		have_next_batch;	/* collected a batch not yet in tuples? */
+	HeapTuple  *next_tuples;	/* array of tuples in that batch */
+	int			num_next_tuples;	/* # of tuples in next_tuples */
+	bool		next_eof;		/* true if that batch reached EOF */
+
 	/* working memory contexts */
 	MemoryContext batch_cxt;	/* context holding current batch of tuples */
+	MemoryContext next_batch_cxt;	/* context holding next_tuples */
 	MemoryContext temp_cxt;		/* context for per-tuple temporary data */
 } PgFdwScanState;
 
@@ -251,6 +269,9 @@ static void postgresBeginForeignScan(ForeignScanState *node, int eflags);
 static TupleTableSlot *postgresIterateForeignScan(ForeignScanState *node);
 static void postgresReScanForeignScan(ForeignScanState *node);
 static void postgresEndForeignScan(ForeignScanState *node);
+static bool postgresStartForeignScanAsync(ForeignScanState *node);
+static bool postgresIsForeignScanReady(ForeignScanState *node,
+						   pgsocket *waitsock);
 static void postgresAddForeignUpdateTargets(Query *parsetree,
 								RangeTblEntry *target_rte,
 								Relation target_relation);
@@ -308,6 +329,8 @@ static bool ec_member_matches_foreign(PlannerInfo *root, RelOptInfo *rel,
 						  void *arg);
 static void create_cursor(ForeignScanState *node);
 static void fetch_more_data(ForeignScanState *node);
+static void send_fetch_request(ForeignScanState *node);
+static void receive_batch(ForeignScanState *node);
 static void close_cursor(PGconn *conn, unsigned int cursor_number);
 static void prepare_foreign_modify(PgFdwModifyState *fmstate);
 static const char **convert_prep_stmt_params(PgFdwModifyState *fmstate,
@@ -348,6 +371,10 @@ postgres_fdw_handler(PG_FUNCTION_ARGS)
 	routine->ReScanForeignScan = postgresReScanForeignScan;
 	routine->EndForeignScan = postgresEndForeignScan;
 
+	/* Support functions for asynchronous execution */
+	routine->StartForeignScanAsync = postgresStartForeignScanAsync;
+	routine->IsForeignScanReady = postgresIsForeignScanReady;
+
 	/* Functions for updating foreign tables */
 	routine->AddForeignUpdateTargets = postgresAddForeignUpdateTargets;
 	routine->PlanForeignModify = postgresPlanForeignModify;
@@ -906,6 +933,11 @@ postgresBeginForeignScan(ForeignScanState *node, int eflags)
 											   ALLOCSET_DEFAULT_MINSIZE,
 											   ALLOCSET_DEFAULT_INITSIZE,
 											   ALLOCSET_DEFAULT_MAXSIZE);
+	fsstate->next_batch_cxt = AllocSetContextCreate(estate->es_query_cxt,
+												"postgres_fdw next tuple data",
+													ALLOCSET_DEFAULT_MINSIZE,
+													ALLOCSET_DEFAULT_INITSIZE,
+													ALLOCSET_DEFAULT_MAXSIZE);
 	fsstate->temp_cxt = AllocSetContextCreate(estate->es_query_cxt,
 											  "postgres_fdw temporary data",
 											  ALLOCSET_SMALL_MINSIZE,
@@ -1010,6 +1042,10 @@ postgresReScanForeignScan(ForeignScanState *node)
 	if (!fsstate->cursor_exists)
 		return;
 
+	/* Collect any FETCH we sent ahead, so the cursor position is known. */
+	if (fsstate->fetch_pending)
+		receive_batch(node);
+
 	/*
 	 * If any internal parameters affecting this node have changed, we'd
 	 * better destroy and recreate the cursor.	Otherwise, rewinding it should
@@ -1029,7 +1065,10 @@ postgresReScanForeignScan(ForeignScanState *node)
 	}
 	else
 	{
-		/* Easy: just rescan what we already have in memory, if anything */
+		/*
+		 * Easy: just rescan what we already have in memory, if anything.  A
+		 * batch collected but not yet used is necessarily the first one.
+		 */
 		fsstate->next_tuple = 0;
 		return;
 	}
@@ -1038,6 +1077,7 @@ postgresReScanForeignScan(ForeignScanState *node)
 	 * We don't use a PG_TRY block here, so be careful not to throw error
 	 * without releasing the PGresult.
 	 */
+	pgfdw_complete_pending(fsstate->conn);
 	res = PQexec(fsstate->conn, sql);
 	if (PQresultStatus(res) != PGRES_COMMAND_OK)
 		pgfdw_report_error(ERROR, res, fsstate->conn, true, sql);
@@ -1049,6 +1089,7 @@ postgresReScanForeignScan(ForeignScanState *node)
 	fsstate->next_tuple = 0;
 	fsstate->fetch_ct_2 = 0;
 	fsstate->eof_reached = false;
+	fsstate->have_next_batch = false;
 }
 
 /*
@@ -1064,6 +1105,10 @@ postgresEndForeignScan(ForeignScanState *node)
 	if (fsstate == NULL)
 		return;
 
+	/* Collect any FETCH still in progress, so the connection is free */
+	if (fsstate->fetch_pending)
+		receive_batch(node);
+
 	/* Close the cursor if open, to prevent accumulation of cursors */
 	if (fsstate->cursor_exists)
 		close_cursor(fsstate->conn, fsstate->cursor_number);
@@ -1075,6 +1120,87 @@ postgresEndForeignScan(ForeignScanState *node)
 	/* MemoryContexts will be deleted automatically. */
 }
 
+/*
+ * postgresStartForeignScanAsync
+ *		Send the query for the next batch of rows without waiting for it.
+ *
+ * The rows are collected later by postgresIterateForeignScan, or sooner if
+ * anyone else needs the connection.  Returns false if the scan can't run
+ * asynchronously, in which case it is simply iterated in the usual way.
+ */
+static bool
+postgresStartForeignScanAsync(ForeignScanState *node)
+{
+	PgFdwScanState *fsstate = (PgFdwScanState *) node->fdw_state;
+	ForeignScanState *pending;
+
+	/* if fsstate is NULL, we are in EXPLAIN; nothing to do */
+	if (fsstate == NULL)
+		return false;
+
+	/*
+	 * Only one query can be in progress on a connection at a time.  If
+	 * another scan got in first, leave this one to be run synchronously;
+	 * collecting the other scan's rows would only serialize the two anyway.
+	 */
+	pending = pgfdw_get_pending_scan(fsstate->conn);
+	if (pending != NULL && pending != node)
+		return false;
+
+	if (!fsstate->cursor_exists)
+		create_cursor(node);
+
+	fsstate->is_async = true;
+	if (!fsstate->fetch_pending && !fsstate->have_next_batch &&
+		!fsstate->eof_reached)
+		send_fetch_request(node);
+
+	return true;
+}
+
+/*
+ * postgresIsForeignScanReady
+ *		Report whether postgresIterateForeignScan can return its next row
+ *		without waiting for the remote server.
+ *
+ * If not, *waitsock is set to the connection's socket, which becomes
+ * readable when the awaited rows arrive.
+ */
+static bool
+postgresIsForeignScanReady(ForeignScanState *node, pgsocket *waitsock)
+{
+	PgFdwScanState *fsstate = (PgFdwScanState *) node->fdw_state;
+	PGconn	   *conn = fsstate->conn;
+
+	/* Rows buffered, or nothing more to fetch? */
+	if (fsstate->next_tuple < fsstate->num_tuples ||
+		fsstate->have_next_batch || fsstate->eof_reached)
+		return true;
+
+	if (!fsstate->fetch_pending)
+	{
+		/*
+		 * We need another batch.  Ask for it now, unless the connection is
+		 * busy with another scan's FETCH; then we'd have to wait for that
+		 * anyway, so just let the caller iterate us.
+		 */
+		if (!fsstate->cursor_exists ||
+			pgfdw_get_pending_scan(conn) != NULL)
+			return true;
+		send_fetch_request(node);
+	}
+
+	if (!PQconsumeInput(conn))
+		pgfdw_report_error(ERROR, NULL, conn, false, fsstate->query);
+	if (PQisBusy(conn))
+	{
+		*waitsock = PQsocket(conn);
+		return false;
+	}
+
+	return true;
+}
+
 /*
  * postgresAddForeignUpdateTargets
  *		Add resjunk column(s) needed for update/delete on a foreign table
@@ -1365,6 +1491,7 @@ postgresExecForeignInsert(EState *estate,
 	 * We don't use a PG_TRY block here, so be careful not to throw error
 	 * without releasing the PGresult.
 	 */
+	pgfdw_complete_pending(fmstate->conn);
 	res = PQexecPrepared(fmstate->conn,
 						 fmstate->p_name,
 						 fmstate->p_nums,
@@ -1435,6 +1562,7 @@ postgresExecForeignUpdate(EState *estate,
 	 * We don't use a PG_TRY block here, so be careful not to throw error
 	 * without releasing the PGresult.
 	 */
+	pgfdw_complete_pending(fmstate->conn);
 	res = PQexecPrepared(fmstate->conn,
 						 fmstate->p_name,
 						 fmstate->p_nums,
@@ -1505,6 +1633,7 @@ postgresExecForeignDelete(EState *estate,
 	 * We don't use a PG_TRY block here, so be careful not to throw error
 	 * without releasing the PGresult.
 	 */
+	pgfdw_complete_pending(fmstate->conn);
 	res = PQexecPrepared(fmstate->conn,
 						 fmstate->p_name,
 						 fmstate->p_nums,
@@ -1561,6 +1690,7 @@ postgresEndForeignModify(EState *estate,
 		 * We don't use a PG_TRY block here, so be careful not to throw error
 		 * without releasing the PGresult.
 		 */
+		pgfdw_complete_pending(fmstate->conn);
 		res = PQexec(fmstate->conn, sql);
 		if (PQresultStatus(res) != PGRES_COMMAND_OK)
 			pgfdw_report_error(ERROR, res, fmstate->conn, true, sql);
@@ -1798,6 +1928,7 @@ get_remote_estimate(const char *sql, PGconn *conn,
 		/*
 		 * Execute EXPLAIN remotely.
 		 */
+		pgfdw_complete_pending(conn);
 		res = PQexec(conn, sql);
 		if (PQresultStatus(res) != PGRES_TUPLES_OK)
 			pgfdw_report_error(ERROR, res, conn, false, sql);
@@ -1931,6 +2062,7 @@ create_cursor(ForeignScanState *node)
 	 * We don't use a PG_TRY block here, so be careful not to throw error
 	 * without releasing the PGresult.
 	 */
+	pgfdw_complete_pending(conn);
 	res = PQexecParams(conn, buf.data, numParams, NULL, values,
 					   NULL, NULL, 0);
 	if (PQresultStatus(res) != PGRES_COMMAND_OK)
@@ -1944,6 +2076,7 @@ create_cursor(ForeignScanState *node)
 	fsstate->next_tuple = 0;
 	fsstate->fetch_ct_2 = 0;
 	fsstate->eof_reached = false;
+	fsstate->have_next_batch = false;
 
 	/* Clean up */
 	pfree(buf.data);
@@ -1956,46 +2089,152 @@ static void
 fetch_more_data(ForeignScanState *node)
 {
 	PgFdwScanState *fsstate = (PgFdwScanState *) node->fdw_state;
-	PGresult   *volatile res = NULL;
-	MemoryContext oldcontext;
+	MemoryContext cxt;
+
+	/* Get the next batch, unless it was collected already */
+	if (!fsstate->have_next_batch)
+		receive_batch(node);
 
 	/*
-	 * We'll store the tuples in the batch_cxt.  First, flush the previous
-	 * batch.
+	 * Make it the current batch.  We swap the contexts rather than copying
+	 * the tuples; the previous batch can be flushed now, since the caller
+	 * has finished with it.
 	 */
-	fsstate->tuples = NULL;
 	MemoryContextReset(fsstate->batch_cxt);
-	oldcontext = MemoryContextSwitchTo(fsstate->batch_cxt);
+	cxt = fsstate->batch_cxt;
+	fsstate->batch_cxt = fsstate->next_batch_cxt;
+	fsstate->next_batch_cxt = cxt;
+
+	fsstate->tuples = fsstate->next_tuples;
+	fsstate->num_tuples = fsstate->num_next_tuples;
+	fsstate->next_tuple = 0;
+	fsstate->eof_reached = fsstate->next_eof;
+
+	fsstate->next_tuples = NULL;
+	fsstate->have_next_batch = false;
+
+	/*
+	 * If we're running asynchronously, ask for the following batch right
+	 * away.  Don't if another scan's FETCH is in progress on the connection,
+	 * since we'd have to wait for that here.
+	 */
+	if (fsstate->is_async && !fsstate->eof_reached &&
+		pgfdw_get_pending_scan(fsstate->conn) == NULL)
+		send_fetch_request(node);
+}
+
+/*
+ * Send a FETCH for the node's cursor, without waiting for the result.
+ */
+static void
+send_fetch_request(ForeignScanState *node)
+{
+	PgFdwScanState *fsstate = (PgFdwScanState *) node->fdw_state;
+	PGconn	   *conn = fsstate->conn;
+	char		sql[64];
+
+	Assert(!fsstate->fetch_pending && !fsstate->have_next_batch);
+
+	/* Nothing else may be in progress on the connection */
+	pgfdw_complete_pending(conn);
+
+	snprintf(sql, sizeof(sql), "FETCH %d FROM c%u",
+			 FETCH_SIZE, fsstate->cursor_number);
+
+	if (!PQsendQuery(conn, sql))
+		pgfdw_report_error(ERROR, NULL, conn, false, sql);
+
+	fsstate->fetch_pending = true;
+	pgfdw_set_pending_scan(conn, node);
+}
+
+/*
+ * Exported wrapper so that connection.c can have a scan collect the FETCH
+ * it has in progress before the connection is used for anything else.
+ */
+void
+pgfdw_collect_fetch(ForeignScanState *node)
+{
+	receive_batch(node);
+}
+
+/*
+ * Get the next batch of rows from the node's cursor into next_tuples,
+ * either by collecting the result of a FETCH sent earlier by
+ * send_fetch_request, or by running one now.
+ *
+ * This must not touch the current batch: the caller may still be using its
+ * tuples.
+ */
+static void
+receive_batch(ForeignScanState *node)
+{
+	PgFdwScanState *fsstate = (PgFdwScanState *) node->fdw_state;
+	PGresult   *volatile res = NULL;
+	MemoryContext oldcontext;
+
+	Assert(!fsstate->have_next_batch);
+
+	/* We'll store the tuples in the next_batch_cxt. */
+	fsstate->next_tuples = NULL;
+	MemoryContextReset(fsstate->next_batch_cxt);
+	oldcontext = MemoryContextSwitchTo(fsstate->next_batch_cxt);
 
 	/* PGresult must be released before leaving this function. */
 	PG_TRY();
 	{
 		PGconn	   *conn = fsstate->conn;
-		char		sql[64];
-		int			fetch_size;
 		int			numrows;
 		int			i;
 
-		/* The fetch size is arbitrary, but shouldn't be enormous. */
-		fetch_size = 100;
+		if (fsstate->fetch_pending)
+		{
+			/*
+			 * If the connection no longer thinks we own it, a transaction
+			 * abort discarded our FETCH, and the cursor went with it.
+			 */
+			fsstate->fetch_pending = false;
+			if (pgfdw_get_pending_scan(conn) != node)
+				ereport(ERROR,
+						(errcode(ERRCODE_FDW_ERROR),
+						 errmsg("asynchronous fetch from foreign table \"%s\" was interrupted",
+								RelationGetRelationName(fsstate->rel))));
+			pgfdw_set_pending_scan(conn, NULL);
+
+			/* Wait for the result, keeping only the last one */
+			for (;;)
+			{
+				PGresult   *next = PQgetResult(conn);
 
-		snprintf(sql, sizeof(sql), "FETCH %d FROM c%u",
-				 fetch_size, fsstate->cursor_number);
+				if (next == NULL)
+					break;
+				PQclear(res);
+				res = next;
+			}
+		}
+		else
+		{
+			char		sql[64];
+
+			snprintf(sql, sizeof(sql), "FETCH %d FROM c%u",
+					 FETCH_SIZE, fsstate->cursor_number);
+
+			pgfdw_complete_pending(conn);
+			res = PQexec(conn, sql);
+		}
 
-		res = PQexec(conn, sql);
 		/* On error, report the original query, not the FETCH. */
 		if (PQresultStatus(res) != PGRES_TUPLES_OK)
 			pgfdw_report_error(ERROR, res, conn, false, fsstate->query);
 
 		/* Convert the data into HeapTuples */
 		numrows = PQntuples(res);
-		fsstate->tuples = (HeapTuple *) palloc0(numrows * sizeof(HeapTuple));
-		fsstate->num_tuples = numrows;
-		fsstate->next_tuple = 0;
+		fsstate->next_tuples = (HeapTuple *) palloc0(numrows * sizeof(HeapTuple));
+		fsstate->num_next_tuples = numrows;
 
 		for (i = 0; i < numrows; i++)
 		{
-			fsstate->tuples[i] =
+			fsstate->next_tuples[i] =
 				make_tuple_from_result_row(res, i,
 										   fsstate->rel,
 										   fsstate->attinmeta,
@@ -2008,7 +2247,8 @@ fetch_more_data(ForeignScanState *node)
 			fsstate->fetch_ct_2++;
 
 		/* Must be EOF if we didn't get as many tuples as we asked for. */
-		fsstate->eof_reached = (numrows < fetch_size);
+		fsstate->next_eof = (numrows < FETCH_SIZE);
+		fsstate->have_next_batch = true;
 
 		PQclear(res);
 		res = NULL;
@@ -2089,6 +2329,7 @@ close_cursor(PGconn *conn, unsigned int cursor_number)
 	 * We don't use a PG_TRY block here, so be careful not to throw error
 	 * without releasing the PGresult.
 	 */
+	pgfdw_complete_pending(conn);
 	res = PQexec(conn, sql);
 	if (PQresultStatus(res) != PGRES_COMMAND_OK)
 		pgfdw_report_error(ERROR, res, conn, true, sql);
@@ -2121,6 +2362,7 @@ prepare_foreign_modify(PgFdwModifyState *fmstate)
 	 * We don't use a PG_TRY block here, so be careful not to throw error
 	 * without releasing the PGresult.
 	 */
+	pgfdw_complete_pending(fmstate->conn);
 	res = PQprepare(fmstate->conn,
 					p_name,
 					fmstate->query,
@@ -2276,6 +2518,7 @@ postgresAnalyzeForeignTable(Relation relation,
 	/* In what follows, do not risk leaking any PGresults. */
 	PG_TRY();
 	{
+		pgfdw_complete_pending(conn);
 		res = PQexec(conn, sql.data);
 		if (PQresultStatus(res) != PGRES_TUPLES_OK)
 			pgfdw_report_error(ERROR, res, conn, false, sql.data);
@@ -2370,6 +2613,7 @@ postgresAcquireSampleRowsFunc(Relation relation, int elevel,
 	/* In what follows, do not risk leaking any PGresults. */
 	PG_TRY();
 	{
+		pgfdw_complete_pending(conn);
 		res = PQexec(conn, sql.data);
 		if (PQresultStatus(res) != PGRES_COMMAND_OK)
 			pgfdw_report_error(ERROR, res, conn, false, sql.data);
@@ -15,6 +15,7 @@
 
 #include "foreign/foreign.h"
 #include "lib/stringinfo.h"
+#include "nodes/execnodes.h"
 #include "nodes/relation.h"
 #include "utils/rel.h"
 
@@ -23,6 +24,7 @@
 /* in postgres_fdw.c */
 extern int	set_transmission_modes(void);
 extern void reset_transmission_modes(int nestlevel);
+extern void pgfdw_collect_fetch(ForeignScanState *node);
 
 /* in connection.c */
 extern PGconn *GetConnection(ForeignServer *server, UserMapping *user,
@@ -30,6 +32,9 @@ extern PGconn *GetConnection(ForeignServer *server, UserMapping *user,
 extern void ReleaseConnection(PGconn *conn);
 extern unsigned int GetCursorNumber(PGconn *conn);
 extern unsigned int GetPrepStmtNumber(PGconn *conn);
+extern void pgfdw_set_pending_scan(PGconn *conn, ForeignScanState *node);
+extern ForeignScanState *pgfdw_get_pending_scan(PGconn *conn);
+extern void pgfdw_complete_pending(PGconn *conn);
 extern void pgfdw_report_error(int elevel, PGresult *res, PGconn *conn,
 				   bool clear, const char *sql);
 
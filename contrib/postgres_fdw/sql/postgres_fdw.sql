@@ -384,3 +384,80 @@ insert into loc1(f2) values('bye');
 insert into rem1(f2) values('bye remote');
 select * from loc1;
 select * from rem1;
+
+-- ===================================================================
+-- test NOT NULL columns of a foreign table holding remote nulls
+-- ===================================================================
+create table loc2 (f1 int, f2 int, f3 text);
+create foreign table rem2 (f1 int not null, f2 int not null, f3 text)
+  server loopback options(table_name 'loc2');
+insert into loc2 values (1, 2, 'a'), (null, 4, 'b'), (5, null, null);
+-- reordering the columns makes the scan deform each row
+select f3, f2, f1 from rem2 order by f3;
+
+-- ===================================================================
+-- test asynchronous execution of foreign scans under Append
+-- ===================================================================
+create server loopback2 foreign data wrapper postgres_fdw
+  options (dbname 'contrib_regression');
+create user mapping for current_user server loopback2;
+create table loc3 (f1 int, f2 text);
+create table loc4 (f1 int, f2 text);
+insert into loc3 select i, 'a' || i from generate_series(1, 250) i;
+insert into loc4 select i, 'b' || i from generate_series(1001, 1150) i;
+-- rem3 and rem4 share a connection, while rem5 has one of its own
+create foreign table rem3 (f1 int, f2 text)
+  server loopback options(table_name 'loc3');
+create foreign table rem4 (f1 int, f2 text)
+  server loopback options(table_name 'loc4');
+create foreign table rem5 (f1 int, f2 text)
+  server loopback2 options(table_name 'loc4');
+-- each scan needs several FETCHes, so scans on the same server have to
+-- hand over the connection while a FETCH is in progress
+select count(*), sum(f1), min(f1), max(f1)
+  from (select f1 from rem3 union all select f1 from rem4) u;
+select count(*), sum(f1), min(f1), max(f1)
+  from (select f1 from rem3 union all select f1 from rem5) u;
+select count(*), sum(f1), min(f1), max(f1)
+  from (select f1 from rem3 union all select f1 from rem4
+        union all select f1 from rem5 union all select f1 from loc3) u;
+select * from (select * from rem3 union all select * from rem4
+               union all select * from rem5) u
+  order by f1 offset 247 limit 5;
+-- rescan under a nested loop, rewinding the cursors
+select t.a, s.cnt
+  from (values (1), (2), (3)) t(a),
+       lateral (select count(*) as cnt
+                  from (select f1 from rem3 union all select f1 from rem4
+                        union all select f1 from rem5 offset 0) u
+                 where u.f1 % 3 = t.a - 1) s
+  order by t.a;
+-- rescan with new parameter values, recreating the cursors
+select t.a, (select count(*)
+               from (select f1 from rem3 union all select f1 from rem5) u
+              where u.f1 > t.a)
+  from (values (100), (1100)) t(a)
+  order by t.a;
+-- abort with FETCHes outstanding
+begin;
+declare c cursor for select f1 from rem3 union all select f1 from rem4
+  union all select f1 from rem5;
+move 120 in c;
+rollback;
+begin;
+savepoint s;
+declare c cursor for select f1 from rem3 union all select f1 from rem4
+  union all select f1 from rem5;
+move 120 in c;
+rollback to savepoint s;
+select count(*) from (select f1 from rem3 union all select f1 from rem5) u;
+declare c cursor for select f1 from rem3 union all select f1 from rem4
+  union all select f1 from rem5;
+move 120 in c;
+commit;
+select f1 / (f1 - 240)
+  from (select f1 from rem3 union all select f1 from rem4
+        union all select f1 from rem5) u;
+select count(*), sum(f1), min(f1), max(f1)
+  from (select f1 from rem3 union all select f1 from rem4
+        union all select f1 from rem5) u;
@@ -1022,22 +1022,33 @@ heap_deformtuple(HeapTuple tuple,
  *		on each call we extract attributes up to the one needed, without
  *		re-computing information about previously extracted attributes.
  *		slot->tts_nvalid is the number of attributes already extracted.
+ *
+ *		Attribute layout is taken from the descriptor's TupleDeformInfo
+ *		rather than from the pg_attribute rows, and the attributes at
+ *		fixed offsets are fetched in a separate loop without null checks
+ *		when the tuple's nulls allow it.
  */
 static void
 slot_deform_tuple(TupleTableSlot *slot, int natts)
 {
 	HeapTuple	tuple = slot->tts_tuple;
 	TupleDesc	tupleDesc = slot->tts_tupleDescriptor;
+	TupleDeformInfo *deform;
 	Datum	   *values = slot->tts_values;
 	bool	   *isnull = slot->tts_isnull;
 	HeapTupleHeader tup = tuple->t_data;
 	bool		hasnulls = HeapTupleHasNulls(tuple);
-	Form_pg_attribute *att = tupleDesc->attrs;
 	int			attnum;
 	char	   *tp;				/* ptr to tuple data */
 	long		off;			/* offset in tuple data */
 	bits8	   *bp = tup->t_bits;		/* ptr to null bitmap in tuple */
-	bool		slow;			/* can we use/set attcacheoff? */
+	bool		slow;			/* can we use fixed offsets? */
+
+	deform = tupleDesc->tddeform;
+	if (deform == NULL)
+		deform = TupleDescBuildDeformInfo(tupleDesc);
+
+	tp = (char *) tup + tup->t_hoff;
 
 	/*
 	 * Check whether the first call for this tuple, and initialize or restore
@@ -1046,9 +1057,41 @@ slot_deform_tuple(TupleTableSlot *slot, int natts)
 	attnum = slot->tts_nvalid;
 	if (attnum == 0)
 	{
-		/* Start from the first attribute */
-		off = 0;
-		slow = false;
+		int			nfast;
+
+		/*
+		 * Leading attributes whose offsets are the same in every tuple can be
+		 * fetched without computing alignment, up to the first null one.  We
+		 * must check the null bitmap even for columns declared NOT NULL: that
+		 * isn't enforced for foreign tables, and constraint checking itself
+		 * deforms the violating tuple.
+		 */
+		nfast = Min(natts, deform->nfixed);
+		for (; attnum < nfast; attnum++)
+		{
+			TupleDeformAttr *thisatt = &deform->attrs[attnum];
+
+			if (hasnulls && att_isnull(attnum, bp))
+				break;
+
+			values[attnum] = fetch_att(tp + thisatt->off, thisatt->byval,
+									   thisatt->len);
+			isnull[attnum] = false;
+		}
+
+		if (attnum > 0)
+		{
+			TupleDeformAttr *lastatt = &deform->attrs[attnum - 1];
+
+			off = att_addlength_pointer(lastatt->off, lastatt->len,
+										tp + lastatt->off);
+			slow = (lastatt->len <= 0);
+		}
+		else
+		{
+			off = 0;
+			slow = false;
+		}
 	}
 	else
 	{
@@ -1057,57 +1100,39 @@ slot_deform_tuple(TupleTableSlot *slot, int natts)
 		slow = slot->tts_slow;
 	}
 
-	tp = (char *) tup + tup->t_hoff;
-
 	for (; attnum < natts; attnum++)
 	{
-		Form_pg_attribute thisatt = att[attnum];
+		TupleDeformAttr *thisatt = &deform->attrs[attnum];
 
 		if (hasnulls && att_isnull(attnum, bp))
 		{
 			values[attnum] = (Datum) 0;
 			isnull[attnum] = true;
-			slow = true;		/* can't use attcacheoff anymore */
+			slow = true;		/* can't use fixed offsets anymore */
 			continue;
 		}
 
 		isnull[attnum] = false;
 
-		if (!slow && thisatt->attcacheoff >= 0)
-			off = thisatt->attcacheoff;
-		else if (thisatt->attlen == -1)
+		if (!slow && thisatt->off >= 0)
+			off = thisatt->off;
+		else if (thisatt->len == -1)
 		{
-			/*
-			 * We can only cache the offset for a varlena attribute if the
-			 * offset is already suitably aligned, so that there would be no
-			 * pad bytes in any case: then the offset will be valid for either
-			 * an aligned or unaligned value.
-			 */
-			if (!slow &&
-				off == att_align_nominal(off, thisatt->attalign))
-				thisatt->attcacheoff = off;
-			else
-			{
-				off = att_align_pointer(off, thisatt->attalign, -1,
-										tp + off);
-				slow = true;
-			}
+			off = att_align_pointer(off, thisatt->align, -1, tp + off);
+			slow = true;
 		}
 		else
 		{
 			/* not varlena, so safe to use att_align_nominal */
-			off = att_align_nominal(off, thisatt->attalign);
-
-			if (!slow)
-				thisatt->attcacheoff = off;
+			off = att_align_nominal(off, thisatt->align);
 		}
 
-		values[attnum] = fetchatt(thisatt, tp + off);
+		values[attnum] = fetch_att(tp + off, thisatt->byval, thisatt->len);
 
-		off = att_addlength_pointer(off, thisatt->attlen, tp + off);
+		off = att_addlength_pointer(off, thisatt->len, tp + off);
 
-		if (thisatt->attlen <= 0)
-			slow = true;		/* can't use attcacheoff anymore */
+		if (thisatt->len <= 0)
+			slow = true;		/* can't use fixed offsets anymore */
 	}
 
 	/*
@@ -25,6 +25,7 @@
 #include "parser/parse_type.h"
 #include "utils/acl.h"
 #include "utils/builtins.h"
+#include "utils/memutils.h"
 #include "utils/resowner_private.h"
 #include "utils/syscache.h"
 
@@ -92,6 +93,7 @@ CreateTemplateTupleDesc(int natts, bool hasoid)
 	desc->tdtypmod = -1;
 	desc->tdhasoid = hasoid;
 	desc->tdrefcount = -1;		/* assume not reference-counted */
+	desc->tddeform = NULL;
 
 	return desc;
 }
@@ -125,6 +127,7 @@ CreateTupleDesc(int natts, bool hasoid, Form_pg_attribute *attrs)
 	desc->tdtypmod = -1;
 	desc->tdhasoid = hasoid;
 	desc->tdrefcount = -1;		/* assume not reference-counted */
+	desc->tddeform = NULL;
 
 	return desc;
 }
@@ -300,9 +303,80 @@ FreeTupleDesc(TupleDesc tupdesc)
 		pfree(tupdesc->constr);
 	}
 
+	if (tupdesc->tddeform)
+		pfree(tupdesc->tddeform);
+
 	pfree(tupdesc);
 }
 
+/*
+ * TupleDescBuildDeformInfo
+ *		Build the deforming information for a tuple descriptor, and
+ *		remember it in the descriptor.
+ *
+ * The result is allocated in the same memory context as the descriptor, so
+ * that it lives exactly as long.  The descriptor's attributes must not be
+ * changed afterwards.
+ */
+TupleDeformInfo *
+TupleDescBuildDeformInfo(TupleDesc tupdesc)
+{
+	TupleDeformInfo *deform;
+	long		off = 0;
+	bool		fixed = true;
+	int			i;
+
+	Assert(tupdesc->tddeform == NULL);
+
+	deform = (TupleDeformInfo *)
+		MemoryContextAlloc(GetMemoryChunkContext(tupdesc),
+						   offsetof(TupleDeformInfo, attrs) +
+						   tupdesc->natts * sizeof(TupleDeformAttr));
+	deform->nfixed = 0;
+
+	for (i = 0; i < tupdesc->natts; i++)
+	{
+		Form_pg_attribute att = tupdesc->attrs[i];
+		TupleDeformAttr *datt = &deform->attrs[i];
+
+		datt->len = att->attlen;
+		datt->byval = att->attbyval;
+		datt->align = att->attalign;
+		datt->off = -1;
+
+		if (!fixed)
+			continue;
+
+		/*
+		 * As in heap_deform_tuple, a varlena attribute has a fixed offset
+		 * only if no padding could precede it, whether or not its value is
+		 * stored with an aligned header.  No attribute after it does.
+		 */
+		if (att->attlen == -1)
+		{
+			if (off == att_align_nominal(off, att->attalign))
+				datt->off = off;
+			fixed = false;
+		}
+		else
+		{
+			off = att_align_nominal(off, att->attalign);
+			datt->off = off;
+			if (att->attlen > 0)
+				off += att->attlen;
+			else
+				fixed = false;	/* cstring */
+		}
+
+		if (datt->off >= 0)
+			deform->nfixed = i + 1;
+	}
+
+	tupdesc->tddeform = deform;
+
+	return deform;
+}
+
 /*
  * Increment the reference count of a tupdesc, and log the reference in
  * CurrentResourceOwner.
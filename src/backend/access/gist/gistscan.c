@@ -17,6 +17,7 @@
 #include "access/gist_private.h"
 #include "access/gistscan.h"
 #include "access/relscan.h"
+#include "catalog/pg_type.h"
 #include "utils/memutils.h"
 #include "utils/rel.h"
 
@@ -199,6 +200,50 @@ gistrescan(PG_FUNCTION_ARGS)
 	so->curTreeItem = NULL;
 	so->firstCall = true;
 
+	/*
+	 * If we're doing an index-only scan, on the first call set up the
+	 * descriptor for the tuples reconstructed by the Fetch methods, and a
+	 * memory context to hold them.  The index's own descriptor shows the
+	 * opclasses' storage types, which can differ from the indexed datatypes
+	 * (points are stored as boxes, for instance), so use the opclass input
+	 * type instead wherever they differ.  A polymorphic input type tells us
+	 * nothing, but an opclass like that stores the indexed datatype anyway.
+	 */
+	if (scan->xs_want_itup && so->giststate->fetchTupdesc == NULL)
+	{
+		Relation	index = scan->indexRelation;
+		TupleDesc	fetchTupdesc;
+
+		oldCxt = MemoryContextSwitchTo(so->giststate->scanCxt);
+
+		fetchTupdesc = CreateTupleDescCopy(RelationGetDescr(index));
+		for (i = 0; i < fetchTupdesc->natts; i++)
+		{
+			Form_pg_attribute att = fetchTupdesc->attrs[i];
+			Oid			opcintype = index->rd_opcintype[i];
+
+			if (att->atttypid != opcintype && !IsPolymorphicType(opcintype))
+				TupleDescInitEntry(fetchTupdesc, (AttrNumber) (i + 1),
+								   NameStr(att->attname), opcintype, -1, 0);
+		}
+		so->giststate->fetchTupdesc = fetchTupdesc;
+
+		so->pageDataCxt = AllocSetContextCreate(so->giststate->scanCxt,
+												"GiST page data context",
+												ALLOCSET_DEFAULT_MINSIZE,
+												ALLOCSET_DEFAULT_INITSIZE,
+												ALLOCSET_DEFAULT_MAXSIZE);
+
+		MemoryContextSwitchTo(oldCxt);
+	}
+	if (scan->xs_want_itup)
+		scan->xs_itupdesc = so->giststate->fetchTupdesc;
+
+	/* Any tuple returned before is gone with the queue or page data */
+	scan->xs_itup = NULL;
+	if (so->pageDataCxt)
+		MemoryContextReset(so->pageDataCxt);
+
 	/* Update scan key, if a new one is given */
 	if (key && scan->numberOfKeys > 0)
 	{
@@ -75,12 +75,21 @@
 /* GUC variable */
 bool		synchronize_seqscans = true;
 
+/*
+ * Number of consecutive blocks a participant in a parallel heap scan claims
+ * at a time.  Handing out ranges rather than single blocks keeps each
+ * process's reads sequential, so that kernel readahead still works.
+ */
+#define PARALLEL_HEAPSCAN_CHUNK_BLOCKS	32
+
 
 static HeapScanDesc heap_beginscan_internal(Relation relation,
 						Snapshot snapshot,
 						int nkeys, ScanKey key,
+						ParallelHeapScanDesc parallel_scan,
 						bool allow_strat, bool allow_sync,
 						bool is_bitmapscan, bool temp_snap);
+static BlockNumber heap_parallelscan_nextpage(HeapScanDesc scan);
 static HeapTuple heap_prepare_insert(Relation relation, HeapTuple tup,
 					TransactionId xid, CommandId cid, int options);
 static XLogRecPtr log_heap_update(Relation reln, Buffer oldbuf,
@@ -219,7 +228,10 @@ initscan(HeapScanDesc scan, ScanKey key, bool is_rescan)
 	 * results for a non-MVCC snapshot, the caller must hold some higher-level
 	 * lock that ensures the interesting tuple(s) won't change.)
 	 */
-	scan->rs_nblocks = RelationGetNumberOfBlocks(scan->rs_rd);
+	if (scan->rs_parallel != NULL)
+		scan->rs_nblocks = scan->rs_parallel->phs_nblocks;
+	else
+		scan->rs_nblocks = RelationGetNumberOfBlocks(scan->rs_rd);
 
 	/*
 	 * If the table is large relative to NBuffers, use a bulk-read access
@@ -241,6 +253,13 @@ initscan(HeapScanDesc scan, ScanKey key, bool is_rescan)
 	else
 		allow_strat = allow_sync = false;
 
+	/*
+	 * A parallel scan hands out blocks in order from a shared counter, so
+	 * there is no point in trying to synchronize with other scans.
+	 */
+	if (scan->rs_parallel != NULL)
+		allow_sync = false;
+
 	if (allow_strat)
 	{
 		if (scan->rs_strategy == NULL)
@@ -278,6 +297,8 @@ initscan(HeapScanDesc scan, ScanKey key, bool is_rescan)
 	ItemPointerSetInvalid(&scan->rs_ctup.t_self);
 	scan->rs_cbuf = InvalidBuffer;
 	scan->rs_cblock = InvalidBlockNumber;
+	scan->rs_pnext = InvalidBlockNumber;
+	scan->rs_pend = InvalidBlockNumber;
 
 	/* we don't have a marked position... */
 	ItemPointerSetInvalid(&(scan->rs_mctid));
@@ -472,7 +493,20 @@ heapgettup(HeapScanDesc scan,
 				tuple->t_data = NULL;
 				return;
 			}
-			page = scan->rs_startblock; /* first page */
+			if (scan->rs_parallel != NULL)
+			{
+				page = heap_parallelscan_nextpage(scan);
+
+				/* Other participants may have claimed every block already */
+				if (page == InvalidBlockNumber)
+				{
+					Assert(!BufferIsValid(scan->rs_cbuf));
+					tuple->t_data = NULL;
+					return;
+				}
+			}
+			else
+				page = scan->rs_startblock;		/* first page */
 			heapgetpage(scan, page);
 			lineoff = FirstOffsetNumber;		/* first offnum */
 			scan->rs_inited = true;
@@ -507,6 +541,9 @@ heapgettup(HeapScanDesc scan,
 				return;
 			}
 
+			/* Parallel scans can only go forward */
+			Assert(scan->rs_parallel == NULL);
+
 			/*
 			 * Disable reporting to syncscan logic in a backwards scan; it's
 			 * not very likely anyone else is doing the same thing at the same
@@ -644,6 +681,11 @@ heapgettup(HeapScanDesc scan,
 				page = scan->rs_nblocks;
 			page--;
 		}
+		else if (scan->rs_parallel != NULL)
+		{
+			page = heap_parallelscan_nextpage(scan);
+			finished = (page == InvalidBlockNumber);
+		}
 		else
 		{
 			page++;
@@ -747,7 +789,20 @@ heapgettup_pagemode(HeapScanDesc scan,
 				tuple->t_data = NULL;
 				return;
 			}
-			page = scan->rs_startblock; /* first page */
+			if (scan->rs_parallel != NULL)
+			{
+				page = heap_parallelscan_nextpage(scan);
+
+				/* Other participants may have claimed every block already */
+				if (page == InvalidBlockNumber)
+				{
+					Assert(!BufferIsValid(scan->rs_cbuf));
+					tuple->t_data = NULL;
+					return;
+				}
+			}
+			else
+				page = scan->rs_startblock;		/* first page */
 			heapgetpage(scan, page);
 			lineindex = 0;
 			scan->rs_inited = true;
@@ -779,6 +834,9 @@ heapgettup_pagemode(HeapScanDesc scan,
 				return;
 			}
 
+			/* Parallel scans can only go forward */
+			Assert(scan->rs_parallel == NULL);
+
 			/*
 			 * Disable reporting to syncscan logic in a backwards scan; it's
 			 * not very likely anyone else is doing the same thing at the same
@@ -905,6 +963,11 @@ heapgettup_pagemode(HeapScanDesc scan,
 				page = scan->rs_nblocks;
 			page--;
 		}
+		else if (scan->rs_parallel != NULL)
+		{
+			page = heap_parallelscan_nextpage(scan);
+			finished = (page == InvalidBlockNumber);
+		}
 		else
 		{
 			page++;
@@ -1291,7 +1354,7 @@ HeapScanDesc
 heap_beginscan(Relation relation, Snapshot snapshot,
 			   int nkeys, ScanKey key)
 {
-	return heap_beginscan_internal(relation, snapshot, nkeys, key,
+	return heap_beginscan_internal(relation, snapshot, nkeys, key, NULL,
 								   true, true, false, false);
 }
 
@@ -1301,7 +1364,7 @@ heap_beginscan_catalog(Relation relation, int nkeys, ScanKey key)
 	Oid			relid = RelationGetRelid(relation);
 	Snapshot	snapshot = RegisterSnapshot(GetCatalogSnapshot(relid));
 
-	return heap_beginscan_internal(relation, snapshot, nkeys, key,
+	return heap_beginscan_internal(relation, snapshot, nkeys, key, NULL,
 								   true, true, false, true);
 }
 
@@ -1310,7 +1373,7 @@ heap_beginscan_strat(Relation relation, Snapshot snapshot,
 					 int nkeys, ScanKey key,
 					 bool allow_strat, bool allow_sync)
 {
-	return heap_beginscan_internal(relation, snapshot, nkeys, key,
+	return heap_beginscan_internal(relation, snapshot, nkeys, key, NULL,
 								   allow_strat, allow_sync, false, false);
 }
 
@@ -1318,13 +1381,14 @@ HeapScanDesc
 heap_beginscan_bm(Relation relation, Snapshot snapshot,
 				  int nkeys, ScanKey key)
 {
-	return heap_beginscan_internal(relation, snapshot, nkeys, key,
+	return heap_beginscan_internal(relation, snapshot, nkeys, key, NULL,
 								   false, false, true, false);
 }
 
 static HeapScanDesc
 heap_beginscan_internal(Relation relation, Snapshot snapshot,
 						int nkeys, ScanKey key,
+						ParallelHeapScanDesc parallel_scan,
 						bool allow_strat, bool allow_sync,
 						bool is_bitmapscan, bool temp_snap)
 {
@@ -1352,6 +1416,7 @@ heap_beginscan_internal(Relation relation, Snapshot snapshot,
 	scan->rs_allow_strat = allow_strat;
 	scan->rs_allow_sync = allow_sync;
 	scan->rs_temp_snap = temp_snap;
+	scan->rs_parallel = parallel_scan;
 
 	/*
 	 * we can use page-at-a-time mode if it's an MVCC-safe snapshot
@@ -1389,6 +1454,112 @@ heap_beginscan_internal(Relation relation, Snapshot snapshot,
 	return scan;
 }
 
+/* ----------------
+ *		heap_parallelscan_estimate - estimate storage for ParallelHeapScanDesc
+ *
+ *		Callers use this to size the dynamic shared memory segment in which
+ *		the shared scan state will live.
+ * ----------------
+ */
+Size
+heap_parallelscan_estimate(void)
+{
+	return sizeof(ParallelHeapScanDescData);
+}
+
+/* ----------------
+ *		heap_parallelscan_initialize - initialize ParallelHeapScanDesc
+ *
+ *		Must be called by exactly one process, before any participant
+ *		begins scanning.  The number of blocks to scan is fixed here, for
+ *		the same reason initscan() fixes it for a regular scan.
+ * ----------------
+ */
+void
+heap_parallelscan_initialize(ParallelHeapScanDesc target, Relation relation)
+{
+	target->phs_relid = RelationGetRelid(relation);
+	target->phs_nblocks = RelationGetNumberOfBlocks(relation);
+	SpinLockInit(&target->phs_mutex);
+	target->phs_cblock = 0;
+}
+
+/* ----------------
+ *		heap_parallelscan_stop - hand out no more blocks
+ *
+ *		Used when the scan's results are no longer wanted.  Participants
+ *		finish the range of blocks they have already claimed, and then see
+ *		the end of the scan.
+ * ----------------
+ */
+void
+heap_parallelscan_stop(ParallelHeapScanDesc pscan)
+{
+	/* use volatile pointer to prevent code rearrangement */
+	volatile ParallelHeapScanDescData *parallel_scan = pscan;
+
+	SpinLockAcquire(&parallel_scan->phs_mutex);
+	parallel_scan->phs_cblock = parallel_scan->phs_nblocks;
+	SpinLockRelease(&parallel_scan->phs_mutex);
+}
+
+/* ----------------
+ *		heap_beginscan_parallel - join a parallel relation scan
+ *
+ *		Each participant calls this with the shared scan state; the blocks
+ *		of the relation are divided among the participants so that each
+ *		block is returned by exactly one of them.  Only forward scans are
+ *		supported, and the scan cannot be rescanned or marked.
+ * ----------------
+ */
+HeapScanDesc
+heap_beginscan_parallel(Relation relation, Snapshot snapshot,
+						ParallelHeapScanDesc parallel_scan)
+{
+	Assert(RelationGetRelid(relation) == parallel_scan->phs_relid);
+
+	return heap_beginscan_internal(relation, snapshot, 0, NULL, parallel_scan,
+								   true, false, false, false);
+}
+
+/* ----------------
+ *		heap_parallelscan_nextpage - get the next page to scan
+ *
+ *		Returns the next block of our current range, claiming a fresh range
+ *		from the shared state when the current one is used up.  Returns
+ *		InvalidBlockNumber once every block has been handed out.
+ * ----------------
+ */
+static BlockNumber
+heap_parallelscan_nextpage(HeapScanDesc scan)
+{
+	/* use volatile pointer to prevent code rearrangement */
+	volatile ParallelHeapScanDescData *parallel_scan = scan->rs_parallel;
+	BlockNumber page;
+	BlockNumber end;
+
+	if (scan->rs_pnext != InvalidBlockNumber && scan->rs_pnext < scan->rs_pend)
+		return scan->rs_pnext++;
+
+	SpinLockAcquire(&parallel_scan->phs_mutex);
+	page = parallel_scan->phs_cblock;
+	end = parallel_scan->phs_nblocks;
+	if (page < end)
+	{
+		if (end - page > PARALLEL_HEAPSCAN_CHUNK_BLOCKS)
+			end = page + PARALLEL_HEAPSCAN_CHUNK_BLOCKS;
+		parallel_scan->phs_cblock = end;
+	}
+	SpinLockRelease(&parallel_scan->phs_mutex);
+
+	if (page >= end)
+		return InvalidBlockNumber;
+
+	scan->rs_pnext = page + 1;
+	scan->rs_pend = end;
+	return page;
+}
+
 /* ----------------
  *		heap_rescan		- restart a relation scan
  * ----------------
@@ -16,6 +16,7 @@
  *		visibilitymap_pin_ok - check whether correct map page is already pinned
  *		visibilitymap_set	 - set a bit in a previously pinned page
  *		visibilitymap_test	 - test if a bit is set
+ *		visibilitymap_test_since - test if a bit was set before a WAL position
  *		visibilitymap_count  - count number of bits set in visibility map
  *		visibilitymap_truncate	- truncate the visibility map
  *
@@ -368,6 +369,67 @@ visibilitymap_test(Relation rel, BlockNumber heapBlk, Buffer *buf)
 	return result;
 }
 
+/*
+ *	visibilitymap_test_since - test if a bit was set before a WAL position
+ *
+ * Like visibilitymap_test, but returns true only if the bit is set and no
+ * bit on the same map page has been set since 'since', a WAL insert position
+ * (or, in recovery, a replay position) obtained by the caller earlier.  The
+ * answer then tells the caller that heapBlk has been all-visible continuously
+ * since that point, since clearing a bit and setting it again would have
+ * advanced the map page's LSN.  That's a coarse test, as it covers many heap
+ * pages at once, but it errs only on the side of returning false.
+ *
+ * Bits aren't WAL-logged for relations that don't need WAL, so their map
+ * pages keep an invalid LSN; callers must not rely on this for unlogged
+ * relations that someone else could be vacuuming concurrently.
+ *
+ * Unlike visibilitymap_test, we lock the map page, so that the bit and the
+ * LSN are read consistently.
+ */
+bool
+visibilitymap_test_since(Relation rel, BlockNumber heapBlk, Buffer *buf,
+						 XLogRecPtr since)
+{
+	BlockNumber mapBlock = HEAPBLK_TO_MAPBLOCK(heapBlk);
+	uint32		mapByte = HEAPBLK_TO_MAPBYTE(heapBlk);
+	uint8		mapBit = HEAPBLK_TO_MAPBIT(heapBlk);
+	bool		result;
+	Page		page;
+	char	   *map;
+
+#ifdef TRACE_VISIBILITYMAP
+	elog(DEBUG1, "vm_test_since %s %d", RelationGetRelationName(rel), heapBlk);
+#endif
+
+	/* Reuse the old pinned buffer if possible */
+	if (BufferIsValid(*buf))
+	{
+		if (BufferGetBlockNumber(*buf) != mapBlock)
+		{
+			ReleaseBuffer(*buf);
+			*buf = InvalidBuffer;
+		}
+	}
+
+	if (!BufferIsValid(*buf))
+	{
+		*buf = vm_readbuf(rel, mapBlock, false);
+		if (!BufferIsValid(*buf))
+			return false;
+	}
+
+	page = BufferGetPage(*buf);
+	map = PageGetContents(page);
+
+	LockBuffer(*buf, BUFFER_LOCK_SHARE);
+	result = (map[mapByte] & (1 << mapBit)) &&
+		PageGetLSN(page) <= since;
+	LockBuffer(*buf, BUFFER_LOCK_UNLOCK);
+
+	return result;
+}
+
 /*
  *	visibilitymap_count  - count number of bits set in visibility map
  *
@@ -121,6 +121,8 @@ RelationGetIndexScan(Relation indexRelation, int nkeys, int norderbys)
 	scan->xs_cbuf = InvalidBuffer;
 	scan->xs_continue_hot = false;
 
+	scan->xs_batch = NULL;		/* may be set later */
+
 	return scan;
 }
 
@@ -143,6 +145,9 @@ IndexScanEnd(IndexScanDesc scan)
 		pfree(scan->keyData);
 	if (scan->orderByData != NULL)
 		pfree(scan->orderByData);
+	/* index_batch_init allocates the batch and its arrays as one chunk */
+	if (scan->xs_batch != NULL)
+		pfree(scan->xs_batch);
 
 	pfree(scan);
 }
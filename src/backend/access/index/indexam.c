@@ -18,8 +18,10 @@
  *		index_rescan	- restart a scan of an index
  *		index_endscan	- end a scan
  *		index_insert	- insert an index tuple into a relation
+ *		index_insert_multi	- insert a batch of index tuples into a relation
  *		index_markpos	- mark a scan position
  *		index_restrpos	- restore a scan position
+ *		index_batch_init	- fetch TIDs from the index in batches
  *		index_getnext_tid	- get the next TID from a scan
  *		index_fetch_heap		- get the scan's next heap tuple
  *		index_getnext	- get the next heap tuple from a scan
@@ -135,6 +137,12 @@ do { \
 
 static IndexScanDesc index_beginscan_internal(Relation indexRelation,
 						 int nkeys, int norderbys, Snapshot snapshot);
+static void index_batch_reset(IndexScanBatch batch);
+static ItemPointer index_batch_getnext_tid(IndexScanDesc scan,
+						ScanDirection direction);
+#ifdef USE_PREFETCH
+static void index_batch_prefetch(IndexScanDesc scan, IndexScanBatch batch);
+#endif
 
 
 /* ----------------------------------------------------------------
@@ -229,6 +237,42 @@ index_insert(Relation indexRelation,
 									  Int32GetDatum((int32) checkUnique)));
 }
 
+/* ----------------
+ *		index_insert_multi - insert a batch of index tuples into a relation
+ *
+ * This is like calling index_insert with UNIQUE_CHECK_NO for each of the
+ * ntuples entries, but lets the AM share work between them.  values and
+ * isnull hold the index columns of each entry in turn.  The caller must
+ * check that the AM provides aminsertmulti.
+ * ----------------
+ */
+void
+index_insert_multi(Relation indexRelation,
+				   Datum *values,
+				   bool *isnull,
+				   ItemPointer heap_t_ctids,
+				   Relation heapRelation,
+				   int ntuples)
+{
+	FmgrInfo   *procedure;
+
+	RELATION_CHECKS;
+	GET_REL_PROCEDURE(aminsertmulti);
+
+	if (!(indexRelation->rd_am->ampredlocks))
+		CheckForSerializableConflictIn(indexRelation,
+									   (HeapTuple) NULL,
+									   InvalidBuffer);
+
+	FunctionCall6(procedure,
+				  PointerGetDatum(indexRelation),
+				  PointerGetDatum(values),
+				  PointerGetDatum(isnull),
+				  PointerGetDatum(heap_t_ctids),
+				  PointerGetDatum(heapRelation),
+				  Int32GetDatum(ntuples));
+}
+
 /*
  * index_beginscan - start a scan of an index with amgettuple
  *
@@ -353,6 +397,10 @@ index_rescan(IndexScanDesc scan,
 				  Int32GetDatum(nkeys),
 				  PointerGetDatum(orderbys),
 				  Int32GetDatum(norderbys));
+
+	/* The AM has dealt with any killed entries, so forget the batch */
+	if (scan->xs_batch != NULL)
+		index_batch_reset(scan->xs_batch);
 }
 
 /* ----------------
@@ -396,6 +444,9 @@ index_markpos(IndexScanDesc scan)
 	SCAN_CHECKS;
 	GET_SCAN_PROCEDURE(ammarkpos);
 
+	/* the AM's position is a batch ahead of ours, so we can't do this */
+	Assert(scan->xs_batch == NULL);
+
 	FunctionCall1(procedure, PointerGetDatum(scan));
 }
 
@@ -425,6 +476,8 @@ index_restrpos(IndexScanDesc scan)
 	SCAN_CHECKS;
 	GET_SCAN_PROCEDURE(amrestrpos);
 
+	Assert(scan->xs_batch == NULL);
+
 	scan->xs_continue_hot = false;
 
 	scan->kill_prior_tuple = false;		/* for safety */
@@ -432,6 +485,73 @@ index_restrpos(IndexScanDesc scan)
 	FunctionCall1(procedure, PointerGetDatum(scan));
 }
 
+/* ----------------
+ *		index_batch_init - fetch TIDs from the index in batches
+ *
+ * Normally index_getnext_tid asks the AM for one TID at a time, so the heap
+ * page holding each tuple is read only when the tuple is wanted, and a scan
+ * of uncached data has just one I/O request outstanding.  If the AM can
+ * return all the matching entries of an index page at once (amgetbatch),
+ * we can instead look ahead in the batch and issue prefetch requests for
+ * the heap pages that will be needed next, the same way a bitmap heap scan
+ * does.  How far ahead we look is governed by effective_io_concurrency.
+ *
+ * The caller must have started the scan with index_beginscan, must not want
+ * index tuples, and must promise not to change the scan direction or to use
+ * mark/restore, since the AM's position in the index is that of the end of
+ * the current batch.  If the AM doesn't support batches, or prefetching is
+ * disabled, this does nothing and the scan works in the ordinary way.
+ * ----------------
+ */
+void
+index_batch_init(IndexScanDesc scan)
+{
+#ifdef USE_PREFETCH
+	IndexScanBatch batch;
+	char	   *ptr;
+
+	SCAN_CHECKS;
+	Assert(scan->heapRelation != NULL);
+	Assert(!scan->xs_want_itup);
+
+	if (target_prefetch_pages <= 0 ||
+		!RegProcedureIsValid(scan->indexRelation->rd_am->amgetbatch))
+		return;
+
+	/* Allocate the batch and its arrays as one chunk; see IndexScanEnd */
+	ptr = palloc(MAXALIGN(sizeof(IndexScanBatchData)) +
+				 MAXALIGN(MaxIndexTuplesPerPage * sizeof(ItemPointerData)) +
+				 MAXALIGN(MaxIndexTuplesPerPage * sizeof(int)) +
+				 MaxIndexTuplesPerPage * sizeof(bool));
+	batch = (IndexScanBatch) ptr;
+	ptr += MAXALIGN(sizeof(IndexScanBatchData));
+	batch->heapTids = (ItemPointerData *) ptr;
+	ptr += MAXALIGN(MaxIndexTuplesPerPage * sizeof(ItemPointerData));
+	batch->killedItems = (int *) ptr;
+	ptr += MAXALIGN(MaxIndexTuplesPerPage * sizeof(int));
+	batch->recheck = (bool *) ptr;
+
+	index_batch_reset(batch);
+	scan->xs_batch = batch;
+#endif   /* USE_PREFETCH */
+}
+
+/*
+ * index_batch_reset --- forget the contents of a batch, at scan (re)start
+ */
+static void
+index_batch_reset(IndexScanBatch batch)
+{
+	batch->nitems = 0;
+	batch->nkilled = 0;
+	batch->dir = NoMovementScanDirection;
+	batch->nextItem = 0;
+	batch->prefetchItem = 0;
+	batch->prefetchBlock = InvalidBlockNumber;
+	batch->prefetchPages = 0;
+	batch->prefetchTarget = -1;
+}
+
 /* ----------------
  * index_getnext_tid - get the next TID from a scan
  *
@@ -445,6 +565,9 @@ index_getnext_tid(IndexScanDesc scan, ScanDirection direction)
 	FmgrInfo   *procedure;
 	bool		found;
 
+	if (scan->xs_batch != NULL)
+		return index_batch_getnext_tid(scan, direction);
+
 	SCAN_CHECKS;
 	GET_SCAN_PROCEDURE(amgettuple);
 
@@ -481,6 +604,150 @@ index_getnext_tid(IndexScanDesc scan, ScanDirection direction)
 	return &scan->xs_ctup.t_self;
 }
 
+/*
+ * index_batch_getnext_tid --- index_getnext_tid for a batched scan
+ */
+static ItemPointer
+index_batch_getnext_tid(IndexScanDesc scan, ScanDirection direction)
+{
+	IndexScanBatch batch = scan->xs_batch;
+	FmgrInfo   *procedure;
+	BlockNumber blkno;
+	bool		newpage;
+
+	SCAN_CHECKS;
+	GET_SCAN_PROCEDURE(amgetbatch);
+
+	Assert(TransactionIdIsValid(RecentGlobalXmin));
+
+	/*
+	 * If the previously returned tuple was found dead, remember that for the
+	 * AM, which marks all such entries when it's done with the batch.
+	 */
+	if (scan->kill_prior_tuple)
+	{
+		Assert(batch->nextItem > 0 && batch->nkilled < batch->nitems);
+		batch->killedItems[batch->nkilled++] = batch->nextItem - 1;
+		scan->kill_prior_tuple = false;
+	}
+
+	if (batch->nextItem >= batch->nitems)
+	{
+		bool		found;
+
+		/*
+		 * Have the AM read the next batch.  It puts the entries into
+		 * scan->xs_batch, after dealing with any killed entries of the
+		 * previous one.
+		 */
+		found = DatumGetBool(FunctionCall2(procedure,
+										   PointerGetDatum(scan),
+										   Int32GetDatum(direction)));
+		Assert(batch->nkilled == 0);
+
+		batch->dir = direction;
+		batch->nextItem = 0;
+		batch->prefetchItem = 0;
+		batch->prefetchBlock = InvalidBlockNumber;
+		batch->prefetchPages = 0;
+
+		/* If we're out of index entries, we're done */
+		if (!found || batch->nitems == 0)
+		{
+			batch->nitems = 0;
+			/* ... but first, release any held pin on a heap page */
+			if (BufferIsValid(scan->xs_cbuf))
+			{
+				ReleaseBuffer(scan->xs_cbuf);
+				scan->xs_cbuf = InvalidBuffer;
+			}
+			return NULL;
+		}
+	}
+	else if (direction != batch->dir)
+		elog(ERROR, "cannot change direction of a batched index scan");
+
+	/*
+	 * Take the next entry.  Each run of entries pointing to the same heap
+	 * page is prefetched only once, so an entry that starts a new run uses up
+	 * one of the pages prefetched so far; unless the prefetching hasn't got
+	 * this far, in which case it must skip this entry, since the caller is
+	 * about to read the page anyway.
+	 */
+	scan->xs_ctup.t_self = batch->heapTids[batch->nextItem];
+	scan->xs_recheck = batch->recheck[batch->nextItem];
+	blkno = ItemPointerGetBlockNumber(&scan->xs_ctup.t_self);
+	newpage = (batch->nextItem == 0 ||
+			   blkno != ItemPointerGetBlockNumber(&batch->heapTids[batch->nextItem - 1]));
+	if (batch->nextItem < batch->prefetchItem)
+	{
+		if (newpage)
+			batch->prefetchPages--;
+	}
+	else
+	{
+		batch->prefetchItem = batch->nextItem + 1;
+		batch->prefetchBlock = blkno;
+	}
+	batch->nextItem++;
+
+#ifdef USE_PREFETCH
+
+	/*
+	 * Increase the prefetch distance as the scan reaches new heap pages, in
+	 * the same way as a bitmap heap scan does, so that a scan that stops
+	 * early because of a LIMIT doesn't issue lots of useless prefetches.
+	 */
+	if (newpage)
+	{
+		if (batch->prefetchTarget >= target_prefetch_pages)
+			 /* don't increase any further */ ;
+		else if (batch->prefetchTarget >= target_prefetch_pages / 2)
+			batch->prefetchTarget = target_prefetch_pages;
+		else if (batch->prefetchTarget > 0)
+			batch->prefetchTarget *= 2;
+		else
+			batch->prefetchTarget++;
+	}
+
+	index_batch_prefetch(scan, batch);
+#endif   /* USE_PREFETCH */
+
+	pgstat_count_index_tuples(scan->indexRelation, 1);
+
+	/* Return the TID of the tuple we found. */
+	return &scan->xs_ctup.t_self;
+}
+
+#ifdef USE_PREFETCH
+/*
+ * index_batch_prefetch --- prefetch the heap pages of upcoming batch entries
+ *
+ * We don't look beyond the end of the current batch, since the AM hasn't
+ * read the next one yet; prefetching starts over with each new batch.
+ */
+static void
+index_batch_prefetch(IndexScanDesc scan, IndexScanBatch batch)
+{
+	while (batch->prefetchPages < batch->prefetchTarget &&
+		   batch->prefetchItem < batch->nitems)
+	{
+		BlockNumber blkno;
+
+		blkno = ItemPointerGetBlockNumber(&batch->heapTids[batch->prefetchItem]);
+		batch->prefetchItem++;
+
+		/* Consecutive entries often point to the same heap page */
+		if (blkno == batch->prefetchBlock)
+			continue;
+
+		PrefetchBuffer(scan->heapRelation, MAIN_FORKNUM, blkno);
+		batch->prefetchBlock = blkno;
+		batch->prefetchPages++;
+	}
+}
+#endif   /* USE_PREFETCH */
+
 /* ----------------
  *		index_fetch_heap - get the scan's next heap tuple
  *
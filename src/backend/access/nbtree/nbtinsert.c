@@ -44,6 +44,14 @@ typedef struct
 	int			best_delta;		/* best size delta so far */
 } FindSplitData;
 
+typedef struct
+{
+	/* context data for _bt_sort_tuples_cmp */
+	TupleDesc	itupdesc;		/* descriptor of the index tuples */
+	int			keysz;			/* number of key columns */
+	ScanKey		scankey;		/* comparison info, from _bt_mkscankey_nodata */
+} BTSortTuplesContext;
+
 
 static Buffer _bt_newroot(Relation rel, Buffer lbuf, Buffer rbuf);
 
@@ -63,6 +71,10 @@ static void _bt_insertonpg(Relation rel, Buffer buf,
 			   IndexTuple itup,
 			   OffsetNumber newitemoff,
 			   bool split_only_page);
+static void _bt_insertonleaf(Relation rel, Buffer buf,
+				 IndexTuple itup,
+				 OffsetNumber newitemoff);
+static int	_bt_sort_tuples_cmp(const void *a, const void *b, void *arg);
 static Buffer _bt_split(Relation rel, Buffer buf, OffsetNumber firstright,
 		  OffsetNumber newitemoff, Size newitemsz,
 		  IndexTuple newitem, bool newitemonleft);
@@ -198,6 +210,141 @@ top:
 	return is_unique;
 }
 
+/*
+ *	_bt_doinsert_multi() -- Insert a batch of index tuples into the tree.
+ *
+ *		This routine is called by the public interface routine,
+ *		btinsertmulti.  It has the same effect as calling _bt_doinsert for
+ *		each tuple with UNIQUE_CHECK_NO, but it's cheaper when many tuples
+ *		are inserted at once, as in a bulk load.
+ *
+ *		We sort the tuples into index order first.  Then, once we have
+ *		descended the tree to the leaf page for one tuple and inserted it,
+ *		the following tuples often belong on the same page too.  We keep the
+ *		page write-locked and add them to it directly, as long as they are
+ *		not beyond its high key and there is room for them.  Any tuple that
+ *		doesn't qualify gets a fresh descent of its own, and a page split is
+ *		left to _bt_insertonpg as usual.
+ *
+ *		Adding a tuple to the page where a preceding, smaller or equal, key
+ *		went is always legal: that page is the first one where the smaller
+ *		key could go, or one to its right within a run of equal keys, so no
+ *		page further left can hold the new key either.
+ *
+ *		The order of the tuples in the itups array is changed.
+ */
+void
+_bt_doinsert_multi(Relation rel, IndexTuple *itups, int ntuples,
+				   Relation heapRel)
+{
+	int			natts = rel->rd_rel->relnatts;
+	BTSortTuplesContext cxt;
+	ScanKey		itup_scankey;
+	int			i;
+
+	/* Sort the tuples into index order, ties broken by heap TID */
+	if (ntuples > 1)
+	{
+		cxt.itupdesc = RelationGetDescr(rel);
+		cxt.keysz = natts;
+		cxt.scankey = _bt_mkscankey_nodata(rel);
+		qsort_arg((void *) itups, ntuples, sizeof(IndexTuple),
+				  _bt_sort_tuples_cmp, (void *) &cxt);
+		_bt_freeskey(cxt.scankey);
+	}
+
+	i = 0;
+	itup_scankey = NULL;
+	while (i < ntuples)
+	{
+		IndexTuple	itup = itups[i];
+		BTStack		stack;
+		Buffer		buf;
+		Page		page;
+		BTPageOpaque lpageop;
+		OffsetNumber offset;
+		Size		itemsz;
+
+		/* we need an insertion scan key to do our search, so build one */
+		if (itup_scankey == NULL)
+			itup_scankey = _bt_mkscankey(rel, itup);
+
+		/* find the first page containing this key, as in _bt_doinsert */
+		stack = _bt_search(rel, natts, itup_scankey, false, &buf, BT_WRITE);
+
+		LockBuffer(buf, BUFFER_LOCK_UNLOCK);
+		LockBuffer(buf, BT_WRITE);
+
+		buf = _bt_moveright(rel, buf, natts, itup_scankey, false, BT_WRITE);
+
+		CheckForSerializableConflictIn(rel, NULL, buf);
+
+		offset = InvalidOffsetNumber;
+		_bt_findinsertloc(rel, &buf, &offset, natts, itup_scankey, itup,
+						  heapRel);
+
+		for (;;)
+		{
+			page = BufferGetPage(buf);
+			lpageop = (BTPageOpaque) PageGetSpecialPointer(page);
+			itemsz = MAXALIGN(IndexTupleDSize(*itup));
+
+			if (PageGetFreeSpace(page) < itemsz)
+			{
+				/* have to split the page; that releases it too */
+				_bt_insertonpg(rel, buf, stack, itup, offset, false);
+				buf = InvalidBuffer;
+				_bt_freeskey(itup_scankey);
+				itup_scankey = NULL;
+				i++;
+				break;
+			}
+
+			_bt_insertonleaf(rel, buf, itup, offset);
+			_bt_freeskey(itup_scankey);
+			itup_scankey = NULL;
+			i++;
+
+			if (i >= ntuples)
+				break;
+
+			/* Can the next tuple go on this page, too? */
+			itup = itups[i];
+			itup_scankey = _bt_mkscankey(rel, itup);
+
+			if (!P_RIGHTMOST(lpageop) &&
+				_bt_compare(rel, natts, itup_scankey, page, P_HIKEY) > 0)
+				break;
+
+			/* let _bt_findinsertloc complain about an oversized tuple */
+			itemsz = MAXALIGN(IndexTupleDSize(*itup));
+			if (itemsz > BTMaxItemSize(page))
+				break;
+
+			if (PageGetFreeSpace(page) < itemsz)
+			{
+				/*
+				 * Try removing LP_DEAD items first.  If that doesn't make
+				 * enough room, start over with a fresh descent, so that
+				 * _bt_findinsertloc can consider moving right.
+				 */
+				if (P_HAS_GARBAGE(lpageop))
+					_bt_vacuum_one_page(rel, buf, heapRel);
+				if (PageGetFreeSpace(page) < itemsz)
+					break;
+			}
+
+			offset = _bt_binsrch(rel, buf, natts, itup_scankey, false);
+		}
+
+		if (BufferIsValid(buf))
+			_bt_relbuf(rel, buf);
+		_bt_freestack(stack);
+	}
+
+	Assert(itup_scankey == NULL);
+}
+
 /*
  *	_bt_check_unique() -- Check for violation of unique index constraint
  *
@@ -875,6 +1022,69 @@ _bt_insertonpg(Relation rel,
 	}
 }
 
+/*
+ *	_bt_insertonleaf() -- Insert a tuple on a leaf page that has room for it.
+ *
+ *		This is the simple case of _bt_insertonpg, for _bt_doinsert_multi:
+ *		the caller has checked that no split is needed.  Unlike
+ *		_bt_insertonpg, we keep the pin and write lock on the buffer, so that
+ *		the caller can go on to add more tuples to the same page.
+ */
+static void
+_bt_insertonleaf(Relation rel,
+				 Buffer buf,
+				 IndexTuple itup,
+				 OffsetNumber newitemoff)
+{
+	Page		page = BufferGetPage(buf);
+	Size		itemsz;
+
+	Assert(P_ISLEAF((BTPageOpaque) PageGetSpecialPointer(page)));
+
+	itemsz = IndexTupleDSize(*itup);
+	itemsz = MAXALIGN(itemsz);	/* be safe, PageAddItem will do this but we
+								 * need to be consistent */
+	Assert(PageGetFreeSpace(page) >= itemsz);
+
+	/* Do the update.  No ereport(ERROR) until changes are logged */
+	START_CRIT_SECTION();
+
+	if (!_bt_pgaddtup(page, itemsz, itup, newitemoff))
+		elog(PANIC, "failed to add new item to block %u in index \"%s\"",
+			 BufferGetBlockNumber(buf), RelationGetRelationName(rel));
+
+	MarkBufferDirty(buf);
+
+	/* XLOG stuff; the same as an ordinary leaf insertion */
+	if (RelationNeedsWAL(rel))
+	{
+		xl_btree_insert xlrec;
+		XLogRecPtr	recptr;
+		XLogRecData rdata[2];
+
+		xlrec.target.node = rel->rd_node;
+		ItemPointerSet(&(xlrec.target.tid), BufferGetBlockNumber(buf),
+					   newitemoff);
+
+		rdata[0].data = (char *) &xlrec;
+		rdata[0].len = SizeOfBtreeInsert;
+		rdata[0].buffer = InvalidBuffer;
+		rdata[0].next = &(rdata[1]);
+
+		rdata[1].data = (char *) itup;
+		rdata[1].len = IndexTupleDSize(*itup);
+		rdata[1].buffer = buf;
+		rdata[1].buffer_std = true;
+		rdata[1].next = NULL;
+
+		recptr = XLogInsert(RM_BTREE_ID, XLOG_BTREE_INSERT_LEAF, rdata);
+
+		PageSetLSN(page, recptr);
+	}
+
+	END_CRIT_SECTION();
+}
+
 /*
  *	_bt_split() -- split a page in the btree.
  *
@@ -2051,6 +2261,64 @@ _bt_isequal(TupleDesc itupdesc, Page page, OffsetNumber offnum,
 	return true;
 }
 
+/*
+ * qsort_arg comparator for sorting index tuples in _bt_doinsert_multi
+ *
+ * This compares the key columns like _bt_load does when merging spools, and
+ * then the heap TIDs, so that equal keys are inserted in heap order.
+ */
+static int
+_bt_sort_tuples_cmp(const void *a, const void *b, void *arg)
+{
+	IndexTuple	itup1 = *((const IndexTuple *) a);
+	IndexTuple	itup2 = *((const IndexTuple *) b);
+	BTSortTuplesContext *cxt = (BTSortTuplesContext *) arg;
+	int			i;
+
+	for (i = 1; i <= cxt->keysz; i++)
+	{
+		ScanKey		entry = cxt->scankey + i - 1;
+		Datum		attrDatum1,
+					attrDatum2;
+		bool		isNull1,
+					isNull2;
+		int32		compare;
+
+		attrDatum1 = index_getattr(itup1, i, cxt->itupdesc, &isNull1);
+		attrDatum2 = index_getattr(itup2, i, cxt->itupdesc, &isNull2);
+		if (isNull1)
+		{
+			if (isNull2)
+				compare = 0;	/* NULL "=" NULL */
+			else if (entry->sk_flags & SK_BT_NULLS_FIRST)
+				compare = -1;	/* NULL "<" NOT_NULL */
+			else
+				compare = 1;	/* NULL ">" NOT_NULL */
+		}
+		else if (isNull2)
+		{
+			if (entry->sk_flags & SK_BT_NULLS_FIRST)
+				compare = 1;	/* NOT_NULL ">" NULL */
+			else
+				compare = -1;	/* NOT_NULL "<" NULL */
+		}
+		else
+		{
+			compare = DatumGetInt32(FunctionCall2Coll(&entry->sk_func,
+													  entry->sk_collation,
+													  attrDatum1,
+													  attrDatum2));
+
+			if (entry->sk_flags & SK_BT_DESC)
+				compare = -compare;
+		}
+		if (compare != 0)
+			return compare;
+	}
+
+	return ItemPointerCompare(&itup1->t_tid, &itup2->t_tid);
+}
+
 /*
  * _bt_vacuum_one_page - vacuum just one index page.
  *
@@ -74,6 +74,7 @@ static void btvacuumscan(IndexVacuumInfo *info, IndexBulkDeleteResult *stats,
 			 BTCycleId cycleid);
 static void btvacuumpage(BTVacState *vstate, BlockNumber blkno,
 			 BlockNumber orig_blkno);
+static void btbatchkilleditems(IndexScanDesc scan);
 
 
 /*
@@ -88,6 +89,7 @@ btbuild(PG_FUNCTION_ARGS)
 	IndexBuildResult *result;
 	double		reltuples;
 	BTBuildState buildstate;
+	int			nworkers;
 
 	buildstate.isUnique = indexInfo->ii_Unique;
 	buildstate.haveDead = false;
@@ -109,25 +111,41 @@ btbuild(PG_FUNCTION_ARGS)
 		elog(ERROR, "index \"%s\" already contains data",
 			 RelationGetRelationName(index));
 
-	buildstate.spool = _bt_spoolinit(heap, index, indexInfo->ii_Unique, false);
-
 	/*
-	 * If building a unique index, put dead tuples in a second spool to keep
-	 * them out of the uniqueness check.
+	 * If the table is big enough, have parallel workers help with the heap
+	 * scan and sort.  We get back a spool that merges everyone's output, and
+	 * a spool of dead tuples only if there were any.
 	 */
-	if (indexInfo->ii_Unique)
-		buildstate.spool2 = _bt_spoolinit(heap, index, false, true);
+	nworkers = _bt_parallel_degree(heap, indexInfo);
+	if (nworkers > 0)
+	{
+		reltuples = _bt_parallel_spool(heap, index, indexInfo, nworkers,
+									   &buildstate.spool, &buildstate.spool2,
+									   &buildstate.indtuples);
+	}
+	else
+	{
+		buildstate.spool = _bt_spoolinit(heap, index, indexInfo->ii_Unique,
+										 false);
+
+		/*
+		 * If building a unique index, put dead tuples in a second spool to
+		 * keep them out of the uniqueness check.
+		 */
+		if (indexInfo->ii_Unique)
+			buildstate.spool2 = _bt_spoolinit(heap, index, false, true);
 
-	/* do the heap scan */
-	reltuples = IndexBuildHeapScan(heap, index, indexInfo, true,
-								   btbuildCallback, (void *) &buildstate);
+		/* do the heap scan */
+		reltuples = IndexBuildHeapScan(heap, index, indexInfo, true,
+									   btbuildCallback, (void *) &buildstate);
 
-	/* okay, all heap tuples are indexed */
-	if (buildstate.spool2 && !buildstate.haveDead)
-	{
-		/* spool2 turns out to be unnecessary */
-		_bt_spooldestroy(buildstate.spool2);
-		buildstate.spool2 = NULL;
+		/* okay, all heap tuples are indexed */
+		if (buildstate.spool2 && !buildstate.haveDead)
+		{
+			/* spool2 turns out to be unnecessary */
+			_bt_spooldestroy(buildstate.spool2);
+			buildstate.spool2 = NULL;
+		}
 	}
 
 	/*
@@ -255,6 +273,44 @@ btinsert(PG_FUNCTION_ARGS)
 	PG_RETURN_BOOL(result);
 }
 
+/*
+ *	btinsertmulti() -- insert a batch of index tuples into a btree.
+ *
+ *		The values and isnull arrays hold the key columns of each entry in
+ *		turn.  No uniqueness checking is done, so this is only used for
+ *		non-unique indexes.
+ */
+Datum
+btinsertmulti(PG_FUNCTION_ARGS)
+{
+	Relation	rel = (Relation) PG_GETARG_POINTER(0);
+	Datum	   *values = (Datum *) PG_GETARG_POINTER(1);
+	bool	   *isnull = (bool *) PG_GETARG_POINTER(2);
+	ItemPointer ht_ctids = (ItemPointer) PG_GETARG_POINTER(3);
+	Relation	heapRel = (Relation) PG_GETARG_POINTER(4);
+	int			ntuples = PG_GETARG_INT32(5);
+	int			natts = RelationGetNumberOfAttributes(rel);
+	IndexTuple *itups;
+	int			i;
+
+	/* generate the index tuples */
+	itups = (IndexTuple *) palloc(ntuples * sizeof(IndexTuple));
+	for (i = 0; i < ntuples; i++)
+	{
+		itups[i] = index_form_tuple(RelationGetDescr(rel),
+									values + i * natts, isnull + i * natts);
+		itups[i]->t_tid = ht_ctids[i];
+	}
+
+	_bt_doinsert_multi(rel, itups, ntuples, heapRel);
+
+	for (i = 0; i < ntuples; i++)
+		pfree(itups[i]);
+	pfree(itups);
+
+	PG_RETURN_VOID();
+}
+
 /*
  *	btgettuple() -- Get the next tuple in the scan.
  */
@@ -283,7 +339,21 @@ btgettuple(PG_FUNCTION_ARGS)
 		_bt_start_array_keys(scan, dir);
 	}
 
-	/* This loop handles advancing to the next array elements, if any */
+	/*
+	 * Likewise, if this is a skip scan, find the first value of the leading
+	 * index column during the first call.
+	 */
+	if (so->skipState != BTSKIP_NONE && !BTScanPosIsValid(so->currPos))
+	{
+		/* punt if the index is empty */
+		if (!_bt_start_skip_key(scan, dir))
+			PG_RETURN_BOOL(false);
+	}
+
+	/*
+	 * This loop handles advancing to the next array elements, or to the next
+	 * value of the leading column in a skip scan, if any
+	 */
 	do
 	{
 		/*
@@ -325,8 +395,9 @@ btgettuple(PG_FUNCTION_ARGS)
 		/* If we have a tuple, return it ... */
 		if (res)
 			break;
-		/* ... otherwise see if we have more array keys to deal with */
-	} while (so->numArrayKeys && _bt_advance_array_keys(scan, dir));
+		/* ... otherwise see if we have more array keys or values to skip to */
+	} while ((so->numArrayKeys && _bt_advance_array_keys(scan, dir)) ||
+			 (so->skipState != BTSKIP_NONE && _bt_advance_skip_key(scan, dir)));
 
 	PG_RETURN_BOOL(res);
 }
@@ -355,7 +426,21 @@ btgetbitmap(PG_FUNCTION_ARGS)
 		_bt_start_array_keys(scan, ForwardScanDirection);
 	}
 
-	/* This loop handles advancing to the next array elements, if any */
+	/*
+	 * Likewise, if this is a skip scan, find the first value of the leading
+	 * index column.
+	 */
+	if (so->skipState != BTSKIP_NONE)
+	{
+		/* punt if the index is empty */
+		if (!_bt_start_skip_key(scan, ForwardScanDirection))
+			PG_RETURN_INT64(ntids);
+	}
+
+	/*
+	 * This loop handles advancing to the next array elements, or to the next
+	 * value of the leading column in a skip scan, if any
+	 */
 	do
 	{
 		/* Fetch the first page & tuple */
@@ -385,12 +470,129 @@ btgetbitmap(PG_FUNCTION_ARGS)
 				ntids++;
 			}
 		}
-		/* Now see if we have more array keys to deal with */
-	} while (so->numArrayKeys && _bt_advance_array_keys(scan, ForwardScanDirection));
+		/* Now see if we have more array keys or values to skip to */
+	} while ((so->numArrayKeys &&
+			  _bt_advance_array_keys(scan, ForwardScanDirection)) ||
+			 (so->skipState != BTSKIP_NONE &&
+			  _bt_advance_skip_key(scan, ForwardScanDirection)));
 
 	PG_RETURN_INT64(ntids);
 }
 
+/*
+ *	btgetbatch() -- get the next batch of tuples in the scan.
+ *
+ * A batch is all the matching items of one leaf page, which _bt_readpage
+ * has already saved in so->currPos; we just copy their heap TIDs out in
+ * scan order.  We then leave so->currPos.itemIndex at the last item, so that
+ * the next call moves on to the next page.
+ */
+Datum
+btgetbatch(PG_FUNCTION_ARGS)
+{
+	IndexScanDesc scan = (IndexScanDesc) PG_GETARG_POINTER(0);
+	ScanDirection dir = (ScanDirection) PG_GETARG_INT32(1);
+	BTScanOpaque so = (BTScanOpaque) scan->opaque;
+	IndexScanBatch batch = scan->xs_batch;
+	bool		res;
+	int			i;
+
+	/* Remember the killed items of the previous batch, before leaving it */
+	btbatchkilleditems(scan);
+	batch->nitems = 0;
+
+	/* Initialize array keys and skip key, as in btgettuple */
+	if (so->numArrayKeys && !BTScanPosIsValid(so->currPos))
+	{
+		/* punt if we have any unsatisfiable array keys */
+		if (so->numArrayKeys < 0)
+			PG_RETURN_BOOL(false);
+
+		_bt_start_array_keys(scan, dir);
+	}
+
+	if (so->skipState != BTSKIP_NONE && !BTScanPosIsValid(so->currPos))
+	{
+		/* punt if the index is empty */
+		if (!_bt_start_skip_key(scan, dir))
+			PG_RETURN_BOOL(false);
+	}
+
+	/*
+	 * Step to the next page with any matching items.  Either way, we end up
+	 * at the first item of that page in scan order.
+	 */
+	do
+	{
+		if (!BTScanPosIsValid(so->currPos))
+			res = _bt_first(scan, dir);
+		else
+			res = _bt_next(scan, dir);
+
+		if (res)
+			break;
+	} while ((so->numArrayKeys && _bt_advance_array_keys(scan, dir)) ||
+			 (so->skipState != BTSKIP_NONE && _bt_advance_skip_key(scan, dir)));
+
+	if (!res)
+		PG_RETURN_BOOL(false);
+
+	if (ScanDirectionIsForward(dir))
+	{
+		Assert(so->currPos.itemIndex == so->currPos.firstItem);
+		for (i = so->currPos.firstItem; i <= so->currPos.lastItem; i++)
+			batch->heapTids[batch->nitems++] = so->currPos.items[i].heapTid;
+		so->currPos.itemIndex = so->currPos.lastItem;
+	}
+	else
+	{
+		Assert(so->currPos.itemIndex == so->currPos.lastItem);
+		for (i = so->currPos.lastItem; i >= so->currPos.firstItem; i--)
+			batch->heapTids[batch->nitems++] = so->currPos.items[i].heapTid;
+		so->currPos.itemIndex = so->currPos.firstItem;
+	}
+
+	/* btree indexes are never lossy */
+	memset(batch->recheck, 0, batch->nitems * sizeof(bool));
+
+	PG_RETURN_BOOL(true);
+}
+
+/*
+ * Transfer the items of the current batch that the caller found to be dead
+ * into so->killedItems, for _bt_killitems to deal with before we leave the
+ * page.  The batch holds the items of so->currPos in scan order.
+ */
+static void
+btbatchkilleditems(IndexScanDesc scan)
+{
+	BTScanOpaque so = (BTScanOpaque) scan->opaque;
+	IndexScanBatch batch = scan->xs_batch;
+	int			i;
+
+	if (batch == NULL || batch->nkilled == 0)
+		return;
+
+	Assert(BTScanPosIsValid(so->currPos));
+	if (so->killedItems == NULL)
+		so->killedItems = (int *)
+			palloc(MaxIndexTuplesPerPage * sizeof(int));
+
+	for (i = 0; i < batch->nkilled; i++)
+	{
+		int			itemIndex;
+
+		if (ScanDirectionIsForward(batch->dir))
+			itemIndex = so->currPos.firstItem + batch->killedItems[i];
+		else
+			itemIndex = so->currPos.lastItem - batch->killedItems[i];
+
+		if (so->numKilled < MaxIndexTuplesPerPage)
+			so->killedItems[so->numKilled++] = itemIndex;
+	}
+	batch->nkilled = 0;
+}
+
 /*
  *	btbeginscan() -- start a scan on a btree index
  */
@@ -422,6 +624,9 @@ btbeginscan(PG_FUNCTION_ARGS)
 	so->arrayKeys = NULL;
 	so->arrayContext = NULL;
 
+	so->skipState = BTSKIP_NONE;	/* likewise for skipping */
+	so->skipKey = NULL;
+
 	so->killedItems = NULL;		/* until needed */
 	so->numKilled = 0;
 
@@ -457,6 +662,7 @@ btrescan(PG_FUNCTION_ARGS)
 	if (BTScanPosIsValid(so->currPos))
 	{
 		/* Before leaving current page, deal with any killed items */
+		btbatchkilleditems(scan);
 		if (so->numKilled > 0)
 			_bt_killitems(scan, false);
 		ReleaseBuffer(so->currPos.buf);
@@ -505,6 +711,9 @@ btrescan(PG_FUNCTION_ARGS)
 	/* If any keys are SK_SEARCHARRAY type, set up array-key info */
 	_bt_preprocess_array_keys(scan);
 
+	/* If the leading index column can be skipped over, set that up */
+	_bt_preprocess_skip_key(scan);
+
 	PG_RETURN_VOID();
 }
 
@@ -521,6 +730,7 @@ btendscan(PG_FUNCTION_ARGS)
 	if (BTScanPosIsValid(so->currPos))
 	{
 		/* Before leaving current page, deal with any killed items */
+		btbatchkilleditems(scan);
 		if (so->numKilled > 0)
 			_bt_killitems(scan, false);
 		ReleaseBuffer(so->currPos.buf);
@@ -540,6 +750,9 @@ btendscan(PG_FUNCTION_ARGS)
 	/* so->arrayKeyData and so->arrayKeys are in arrayContext */
 	if (so->arrayContext != NULL)
 		MemoryContextDelete(so->arrayContext);
+	/* likewise, everything belonging to so->skipKey is in its context */
+	if (so->skipKey != NULL)
+		MemoryContextDelete(so->skipKey->skipContext);
 	if (so->killedItems != NULL)
 		pfree(so->killedItems);
 	if (so->currTuples != NULL)
@@ -581,6 +794,10 @@ btmarkpos(PG_FUNCTION_ARGS)
 	if (so->numArrayKeys)
 		_bt_mark_array_keys(scan);
 
+	/* ... and the current skip key, if skipping */
+	if (so->skipState != BTSKIP_NONE)
+		_bt_mark_skip_key(scan);
+
 	PG_RETURN_VOID();
 }
 
@@ -597,6 +814,10 @@ btrestrpos(PG_FUNCTION_ARGS)
 	if (so->numArrayKeys)
 		_bt_restore_array_keys(scan);
 
+	/* ... and the marked skip key, if skipping */
+	if (so->skipState != BTSKIP_NONE)
+		_bt_restore_skip_key(scan);
+
 	if (so->markItemIndex >= 0)
 	{
 		/*
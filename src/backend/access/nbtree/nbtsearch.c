@@ -20,6 +20,7 @@
 #include "miscadmin.h"
 #include "pgstat.h"
 #include "storage/predicate.h"
+#include "utils/datum.h"
 #include "utils/lsyscache.h"
 #include "utils/rel.h"
 
@@ -1602,3 +1603,148 @@ _bt_endpoint(IndexScanDesc scan, ScanDirection dir)
 
 	return true;
 }
+
+/*
+ *	_bt_skip_next_value() -- Find the next value of the first index column
+ *		for a skip scan.
+ *
+ * If havePrev is false, we find the first value in the index in the given
+ * scan direction, by walking down to the leftmost or rightmost leaf page.
+ * Otherwise we find the nearest value beyond the one in the current skip key
+ * by searching for that value afresh, with the nextkey logic used by
+ * _bt_first(), so that whatever lies between is not visited at all.
+ *
+ * On success, the value (copied into the skip scan's memory context) is
+ * returned in *value and *isnull, and the block number of the leaf page
+ * we found it on in *blkno.  Returns false if there are no more values.
+ * No buffer pin or lock is held on exit.
+ */
+bool
+_bt_skip_next_value(IndexScanDesc scan, ScanDirection dir, bool havePrev,
+					Datum *value, bool *isnull, BlockNumber *blkno)
+{
+	Relation	rel = scan->indexRelation;
+	BTScanOpaque so = (BTScanOpaque) scan->opaque;
+	TupleDesc	itupdesc = RelationGetDescr(rel);
+	Buffer		buf;
+	Page		page;
+	BTPageOpaque opaque;
+	OffsetNumber offnum;
+	IndexTuple	itup;
+	Datum		datum;
+
+	Assert(so->skipKey != NULL);
+
+	if (!havePrev)
+	{
+		buf = _bt_get_endpoint(rel, 0, ScanDirectionIsBackward(dir));
+		if (!BufferIsValid(buf))
+		{
+			/* Empty index; as in _bt_endpoint, lock the whole relation */
+			PredicateLockRelation(rel, scan->xs_snapshot);
+			return false;
+		}
+		page = BufferGetPage(buf);
+		opaque = (BTPageOpaque) PageGetSpecialPointer(page);
+		if (ScanDirectionIsForward(dir))
+			offnum = P_FIRSTDATAKEY(opaque);
+		else
+			offnum = PageGetMaxOffsetNumber(page);
+	}
+	else
+	{
+		ScanKey		skey = &so->skipKey->keyData[0];
+		ScanKeyData inskey;
+		BTStack		stack;
+		bool		nextkey;
+
+		/*
+		 * Build an insertion scankey for the current value, the same way
+		 * _bt_mkscankey() would.  A forward scan wants the first item > the
+		 * value; a backward scan wants the last item < the value, which is
+		 * the one before the first item >= the value.
+		 */
+		ScanKeyEntryInitializeWithInfo(&inskey,
+									   (skey->sk_flags & SK_ISNULL) |
+							(rel->rd_indoption[0] << SK_BT_INDOPTION_SHIFT),
+									   1,
+									   InvalidStrategy,
+									   InvalidOid,
+									   rel->rd_indcollation[0],
+									   index_getprocinfo(rel, 1, BTORDER_PROC),
+									   skey->sk_argument);
+		nextkey = ScanDirectionIsForward(dir);
+
+		stack = _bt_search(rel, 1, &inskey, nextkey, &buf, BT_READ);
+		_bt_freestack(stack);
+		if (!BufferIsValid(buf))
+		{
+			PredicateLockRelation(rel, scan->xs_snapshot);
+			return false;
+		}
+		offnum = _bt_binsrch(rel, buf, 1, &inskey, nextkey);
+		if (!nextkey)
+			offnum = OffsetNumberPrev(offnum);
+	}
+
+	/*
+	 * If there's no item at that position on this page, move on to the
+	 * adjacent page in the scan direction, until we find one.
+	 */
+	for (;;)
+	{
+		page = BufferGetPage(buf);
+		opaque = (BTPageOpaque) PageGetSpecialPointer(page);
+		if (!P_IGNORE(opaque))
+		{
+			PredicateLockPage(rel, BufferGetBlockNumber(buf),
+							  scan->xs_snapshot);
+			if (offnum >= P_FIRSTDATAKEY(opaque) &&
+				offnum <= PageGetMaxOffsetNumber(page))
+				break;
+		}
+
+		if (ScanDirectionIsForward(dir))
+		{
+			BlockNumber next = opaque->btpo_next;
+
+			_bt_relbuf(rel, buf);
+			if (next == P_NONE)
+				return false;
+			/* check for interrupts while we're not holding any buffer lock */
+			CHECK_FOR_INTERRUPTS();
+			buf = _bt_getbuf(rel, next, BT_READ);
+			page = BufferGetPage(buf);
+			opaque = (BTPageOpaque) PageGetSpecialPointer(page);
+			offnum = P_FIRSTDATAKEY(opaque);
+		}
+		else
+		{
+			buf = _bt_walk_left(rel, buf);
+			if (!BufferIsValid(buf))
+				return false;
+			page = BufferGetPage(buf);
+			offnum = PageGetMaxOffsetNumber(page);
+		}
+	}
+
+	/* Copy out the value before letting go of the page */
+	itup = (IndexTuple) PageGetItem(page, PageGetItemId(page, offnum));
+	datum = index_getattr(itup, 1, itupdesc, isnull);
+	if (*isnull)
+		*value = (Datum) 0;
+	else
+	{
+		MemoryContext oldcxt;
+
+		oldcxt = MemoryContextSwitchTo(so->skipKey->skipContext);
+		*value = datumCopy(datum, itupdesc->attrs[0]->attbyval,
+						   itupdesc->attrs[0]->attlen);
+		MemoryContextSwitchTo(oldcxt);
+	}
+	*blkno = BufferGetBlockNumber(buf);
+
+	_bt_relbuf(rel, buf);
+
+	return true;
+}
@@ -55,6 +55,17 @@
  * This code isn't concerned about the FSM at all. The caller is responsible
  * for initializing that.
  *
+ * For a large table, the heap scan and sort can be shared out among parallel
+ * workers.  The leader and each worker scan blocks of the heap handed out by
+ * a shared parallel heap scan, and sort what they find with their share of
+ * maintenance_work_mem.  Each worker then streams its sorted output back to
+ * the leader through a shm_mq, and the leader's spool merges those streams
+ * and its own sorted tuples on the fly as _bt_load reads them.  Dead tuples
+ * found during a unique index build are sent ahead of the sorted stream, and
+ * the leader collects them all into a spool of its own before the merge
+ * begins, so that no worker is left waiting on a queue the leader isn't
+ * reading.
+ *
  * Portions Copyright (c) 1996-2014, PostgreSQL Global Development Group
  * Portions Copyright (c) 1994, Regents of the University of California
  *
@@ -68,13 +79,83 @@
 
 #include "access/heapam_xlog.h"
 #include "access/nbtree.h"
+#include "access/parallel.h"
+#include "access/relscan.h"
+#include "access/xact.h"
+#include "catalog/catalog.h"
+#include "catalog/index.h"
 #include "miscadmin.h"
+#include "optimizer/clauses.h"
+#include "optimizer/cost.h"
+#include "storage/proc.h"
+#include "storage/procarray.h"
+#include "storage/shm_mq.h"
 #include "storage/smgr.h"
+#include "storage/spin.h"
 #include "tcop/tcopprot.h"
 #include "utils/rel.h"
+#include "utils/snapmgr.h"
 #include "utils/tuplesort.h"
 
 
+/* Keys for a parallel index build's shared state. */
+#define PARALLEL_BTREE_KEY_SHARED		UINT64CONST(1)
+#define PARALLEL_BTREE_KEY_QUEUES		UINT64CONST(2)
+
+/*
+ * Size of each worker's tuple queue.  The leader reads from one queue at a
+ * time as the merge demands, so a larger queue lets each worker run further
+ * ahead of it.
+ */
+#define PARALLEL_BTREE_QUEUE_SIZE		(BLCKSZ * 32)
+
+/*
+ * State shared by all participants in a parallel index build.  The fields
+ * below the mutex are totals that each participant adds to when it has
+ * finished scanning.
+ */
+typedef struct BTShared
+{
+	Oid			heaprelid;
+	Oid			indexrelid;
+	bool		isunique;
+	int			sortmem;		/* each participant's sort memory, in kB */
+	TransactionId OldestXmin;	/* cutoff for HeapTupleSatisfiesVacuum */
+	ParallelHeapScanDescData heapscan;	/* shared block allocation */
+
+	slock_t		mutex;
+	double		reltuples;		/* heap tuples scanned */
+	double		indtuples;		/* index tuples spooled */
+	bool		havedead;		/* any dead tuples, for unique builds? */
+	bool		brokenhotchain; /* any broken HOT chains? */
+} BTShared;
+
+/*
+ * The leader's state for a parallel index build, attached to the spool that
+ * merges the participants' output.  Source i of the merge is worker i's
+ * queue, and the last source is the leader's own sorted tuples.
+ */
+typedef struct BTLeader
+{
+	ParallelContext *pcxt;
+	int			nqueues;		/* number of workers launched */
+	shm_mq_handle **queues;		/* NULL once a worker has finished */
+	struct BTSpool *localspool; /* leader's own sorted share */
+	IndexTuple	localtup;		/* last tuple from localspool, to be freed */
+} BTLeader;
+
+/*
+ * Callback state for a participant's scan of its share of the heap.
+ */
+typedef struct BTParticipantState
+{
+	struct BTSpool *spool;
+	struct BTSpool *spool2;
+	double		indtuples;
+	bool		haveDead;
+} BTParticipantState;
+
+
 /*
  * Status record for spooling/sorting phase.  (Note we may have two of
  * these due to the special requirements for uniqueness-checking with
@@ -86,6 +167,7 @@ struct BTSpool
 	Relation	heap;
 	Relation	index;
 	bool		isunique;
+	BTLeader   *leader;			/* parallel build state, if merging */
 };
 
 /*
@@ -136,6 +218,18 @@ static void _bt_buildadd(BTWriteState *wstate, BTPageState *state,
 static void _bt_uppershutdown(BTWriteState *wstate, BTPageState *state);
 static void _bt_load(BTWriteState *wstate,
 		 BTSpool *btspool, BTSpool *btspool2);
+static BTSpool *_bt_spoolinit_mem(Relation heap, Relation index,
+				  bool isunique, int btKbytes);
+static void _bt_parallel_scan_and_sort(BTShared *shared, Relation heap,
+						   Relation index, IndexInfo *indexInfo,
+						   BTSpool *spool, BTSpool *spool2);
+static void _bt_parallel_callback(Relation index, HeapTuple htup,
+					  Datum *values, bool *isnull,
+					  bool tupleIsAlive, void *state);
+static bool _bt_parallel_send(shm_mq_handle *mqh, BTSpool *spool);
+static void *_bt_parallel_fetch(void *arg, int source);
+static void _bt_parallel_end(BTLeader *btleader);
+static void _bt_parallel_build_main(dsm_segment *seg, shm_toc *toc);
 
 
 /*
@@ -149,13 +243,8 @@ static void _bt_load(BTWriteState *wstate,
 BTSpool *
 _bt_spoolinit(Relation heap, Relation index, bool isunique, bool isdead)
 {
-	BTSpool    *btspool = (BTSpool *) palloc0(sizeof(BTSpool));
 	int			btKbytes;
 
-	btspool->heap = heap;
-	btspool->index = index;
-	btspool->isunique = isunique;
-
 	/*
 	 * We size the sort area as maintenance_work_mem rather than work_mem to
 	 * speed index creation.  This should be OK since a single backend can't
@@ -165,6 +254,21 @@ _bt_spoolinit(Relation heap, Relation index, bool isunique, bool isdead)
 	 * work_mem.
 	 */
 	btKbytes = isdead ? work_mem : maintenance_work_mem;
+
+	return _bt_spoolinit_mem(heap, index, isunique, btKbytes);
+}
+
+/*
+ * create and initialize a spool structure with a given sort memory size
+ */
+static BTSpool *
+_bt_spoolinit_mem(Relation heap, Relation index, bool isunique, int btKbytes)
+{
+	BTSpool    *btspool = (BTSpool *) palloc0(sizeof(BTSpool));
+
+	btspool->heap = heap;
+	btspool->index = index;
+	btspool->isunique = isunique;
 	btspool->sortstate = tuplesort_begin_index_btree(heap, index, isunique,
 													 btKbytes, false);
 
@@ -178,6 +282,8 @@ void
 _bt_spooldestroy(BTSpool *btspool)
 {
 	tuplesort_end(btspool->sortstate);
+	if (btspool->leader != NULL)
+		_bt_parallel_end(btspool->leader);
 	pfree(btspool);
 }
 
@@ -823,3 +929,443 @@ _bt_load(BTWriteState *wstate, BTSpool *btspool, BTSpool *btspool2)
 		smgrimmedsync(wstate->index->rd_smgr, MAIN_FORKNUM);
 	}
 }
+
+
+/*
+ * _bt_parallel_degree() -- how many workers should build this index?
+ *
+ * Returns zero if the build should not be done in parallel.  As for a
+ * parallel sequential scan, we ask for one worker once the table reaches
+ * min_parallel_relation_size, and one more each time it triples in size, up
+ * to max_parallel_degree.
+ */
+int
+_bt_parallel_degree(Relation heap, IndexInfo *indexInfo)
+{
+	BlockNumber nblocks;
+	double		threshold;
+	int			nworkers;
+
+	if (max_parallel_degree <= 0 || IsParallelWorker())
+		return 0;
+
+	/*
+	 * A concurrent build scans with an MVCC snapshot of its own, which we
+	 * have no way to share.  Workers can't read temporary tables, which live
+	 * in our local buffers, and we'd rather not have them poking at system
+	 * catalogs that might be in the middle of being reindexed.  They can't
+	 * take part in serializable conflict detection either.
+	 */
+	if (indexInfo->ii_Concurrent ||
+		RelationUsesLocalBuffers(heap) ||
+		IsSystemRelation(heap) ||
+		IsolationIsSerializable() ||
+		!ActiveSnapshotSet())
+		return 0;
+
+	/* The workers must be able to evaluate any expressions and predicate. */
+	if (has_parallel_hazard((Node *) indexInfo->ii_Expressions) ||
+		has_parallel_hazard((Node *) indexInfo->ii_Predicate))
+		return 0;
+
+	/* Small tables aren't worth the cost of starting workers. */
+	nblocks = RelationGetNumberOfBlocks(heap);
+	threshold = Max(min_parallel_relation_size, 1);
+	if ((double) nblocks < threshold)
+		return 0;
+
+	nworkers = 1;
+	while (nworkers < max_parallel_degree &&
+		   (double) nblocks >= threshold * 3)
+	{
+		nworkers++;
+		threshold *= 3;
+	}
+
+	return nworkers;
+}
+
+/*
+ * _bt_parallel_spool() -- scan and sort the heap with parallel workers
+ *
+ * Launch up to nworkers workers, and scan and sort a share of the heap
+ * ourselves while they do the same.  On return, *spoolp is a spool that
+ * merges everyone's sorted output, and *spool2p is a spool of dead tuples,
+ * or NULL if there were none or the index isn't unique.  The spool must be
+ * passed to _bt_spooldestroy() once _bt_leafbuild() is finished with it,
+ * which will also shut down the workers.
+ *
+ * Returns the total number of heap tuples scanned, and sets *indtuples to
+ * the number of index tuples spooled.
+ */
+double
+_bt_parallel_spool(Relation heap, Relation index, IndexInfo *indexInfo,
+				   int nworkers, BTSpool **spoolp, BTSpool **spool2p,
+				   double *indtuples)
+{
+	ParallelContext *pcxt;
+	BTShared   *shared;
+	volatile BTShared *vshared;
+	BTLeader   *btleader;
+	BTSpool    *spool;
+	BTSpool    *spool2 = NULL;
+	char	   *mqspace;
+	double		reltuples;
+	bool		havedead;
+	bool		brokenhotchain;
+	int			sortmem;
+	int			i;
+
+	Assert(nworkers > 0);
+
+	/* Each participant, ourselves included, sorts with an equal share. */
+	sortmem = Max(maintenance_work_mem / (nworkers + 1), 64);
+
+	/* Size and create the dynamic shared memory segment. */
+	pcxt = CreateParallelContext(_bt_parallel_build_main, nworkers);
+	shm_toc_estimate_chunk(&pcxt->estimator, sizeof(BTShared));
+	shm_toc_estimate_chunk(&pcxt->estimator,
+						   mul_size(PARALLEL_BTREE_QUEUE_SIZE, nworkers));
+	shm_toc_estimate_keys(&pcxt->estimator, 2);
+	InitializeParallelDSM(pcxt);
+
+	shared = shm_toc_allocate(pcxt->toc, sizeof(BTShared));
+	shared->heaprelid = RelationGetRelid(heap);
+	shared->indexrelid = RelationGetRelid(index);
+	shared->isunique = indexInfo->ii_Unique;
+	shared->sortmem = sortmem;
+	/* okay to ignore lazy VACUUMs here, as IndexBuildHeapScan does */
+	shared->OldestXmin = GetOldestXmin(heap->rd_rel->relisshared, true);
+	heap_parallelscan_initialize(&shared->heapscan, heap);
+	SpinLockInit(&shared->mutex);
+	shared->reltuples = 0;
+	shared->indtuples = 0;
+	shared->havedead = false;
+	shared->brokenhotchain = false;
+	shm_toc_insert(pcxt->toc, PARALLEL_BTREE_KEY_SHARED, shared);
+
+	mqspace = shm_toc_allocate(pcxt->toc,
+							   mul_size(PARALLEL_BTREE_QUEUE_SIZE, nworkers));
+	for (i = 0; i < nworkers; ++i)
+	{
+		shm_mq	   *mq;
+
+		mq = shm_mq_create(mqspace + i * PARALLEL_BTREE_QUEUE_SIZE,
+						   PARALLEL_BTREE_QUEUE_SIZE);
+		shm_mq_set_receiver(mq, MyProc);
+	}
+	shm_toc_insert(pcxt->toc, PARALLEL_BTREE_KEY_QUEUES, mqspace);
+
+	LaunchParallelWorkers(pcxt);
+
+	/*
+	 * Attach to the queues of the workers we actually got.  Passing the
+	 * worker's handle lets us notice if it fails to start.
+	 */
+	btleader = (BTLeader *) palloc0(sizeof(BTLeader));
+	btleader->pcxt = pcxt;
+	btleader->nqueues = pcxt->nworkers_launched;
+	btleader->queues = (shm_mq_handle **)
+		palloc0(sizeof(shm_mq_handle *) * nworkers);
+	for (i = 0; i < pcxt->nworkers_launched; ++i)
+		btleader->queues[i] =
+			shm_mq_attach((shm_mq *) (mqspace + i * PARALLEL_BTREE_QUEUE_SIZE),
+						  pcxt->seg, pcxt->worker[i].bgwhandle);
+
+	/*
+	 * Scan and sort our own share of the heap.  This also guarantees that
+	 * every block gets scanned, even if none of the workers started.  Our
+	 * dead tuples go straight into the final dead-tuple spool.
+	 */
+	btleader->localspool = _bt_spoolinit_mem(heap, index, indexInfo->ii_Unique,
+											 sortmem);
+	if (indexInfo->ii_Unique)
+		spool2 = _bt_spoolinit(heap, index, false, true);
+	_bt_parallel_scan_and_sort(shared, heap, index, indexInfo,
+							   btleader->localspool, spool2);
+
+	/*
+	 * Collect the workers' dead tuples, which each sends ahead of its sorted
+	 * tuples and follows with an empty message.  Once we have them all,
+	 * every worker has finished its scan and added to the shared totals.
+	 */
+	for (i = 0; i < btleader->nqueues; ++i)
+	{
+		for (;;)
+		{
+			shm_mq_result result;
+			Size		nbytes;
+			void	   *data;
+
+			result = shm_mq_receive(btleader->queues[i], &nbytes, &data, false);
+			if (result == SHM_MQ_DETACHED)
+			{
+				/*
+				 * The worker is gone without finishing its part.  Unless it
+				 * simply never started, this will throw an error.
+				 */
+				btleader->queues[i] = NULL;
+				CheckParallelWorkerExit(pcxt, i);
+				break;
+			}
+			if (nbytes == 0)
+				break;
+			Assert(spool2 != NULL);
+			_bt_spool((IndexTuple) data, spool2);
+		}
+	}
+
+	/* use volatile pointer to prevent code rearrangement */
+	vshared = shared;
+	SpinLockAcquire(&vshared->mutex);
+	reltuples = vshared->reltuples;
+	*indtuples = vshared->indtuples;
+	havedead = vshared->havedead;
+	brokenhotchain = vshared->brokenhotchain;
+	SpinLockRelease(&vshared->mutex);
+
+	if (brokenhotchain)
+		indexInfo->ii_BrokenHotChain = true;
+
+	if (spool2 != NULL && !havedead)
+	{
+		/* spool2 turns out to be unnecessary */
+		_bt_spooldestroy(spool2);
+		spool2 = NULL;
+	}
+
+	/*
+	 * Finally, set up the spool that merges everyone's sorted tuples.  It
+	 * enforces uniqueness across participants just as each participant's own
+	 * sort did within its share.
+	 */
+	spool = _bt_spoolinit_mem(heap, index, indexInfo->ii_Unique, sortmem);
+	spool->leader = btleader;
+	tuplesort_attach_sources(spool->sortstate, btleader->nqueues + 1,
+							 _bt_parallel_fetch, btleader);
+
+	*spoolp = spool;
+	*spool2p = spool2;
+	return reltuples;
+}
+
+/*
+ * Scan one participant's share of the heap into its spools, sort the live
+ * tuples, and add to the shared totals.  The dead-tuple spool is left
+ * unsorted.
+ */
+static void
+_bt_parallel_scan_and_sort(BTShared *shared, Relation heap, Relation index,
+						   IndexInfo *indexInfo, BTSpool *spool,
+						   BTSpool *spool2)
+{
+	volatile BTShared *vshared = shared;
+	BTParticipantState pstate;
+	double		reltuples;
+
+	pstate.spool = spool;
+	pstate.spool2 = spool2;
+	pstate.indtuples = 0;
+	pstate.haveDead = false;
+
+	reltuples = IndexBuildHeapScanParallel(heap, index, indexInfo,
+										   &shared->heapscan,
+										   shared->OldestXmin,
+										   _bt_parallel_callback,
+										   (void *) &pstate);
+
+	tuplesort_performsort(spool->sortstate);
+
+	SpinLockAcquire(&vshared->mutex);
+	vshared->reltuples += reltuples;
+	vshared->indtuples += pstate.indtuples;
+	if (pstate.haveDead)
+		vshared->havedead = true;
+	if (indexInfo->ii_BrokenHotChain)
+		vshared->brokenhotchain = true;
+	SpinLockRelease(&vshared->mutex);
+}
+
+/*
+ * Per-tuple callback from IndexBuildHeapScanParallel; like btbuildCallback.
+ */
+static void
+_bt_parallel_callback(Relation index,
+					  HeapTuple htup,
+					  Datum *values,
+					  bool *isnull,
+					  bool tupleIsAlive,
+					  void *state)
+{
+	BTParticipantState *pstate = (BTParticipantState *) state;
+	IndexTuple	itup;
+
+	/* form an index tuple and point it at the heap tuple */
+	itup = index_form_tuple(RelationGetDescr(index), values, isnull);
+	itup->t_tid = htup->t_self;
+
+	if (tupleIsAlive || pstate->spool2 == NULL)
+		_bt_spool(itup, pstate->spool);
+	else
+	{
+		/* dead tuples are put into spool2 */
+		pstate->haveDead = true;
+		_bt_spool(itup, pstate->spool2);
+	}
+
+	pstate->indtuples += 1;
+
+	pfree(itup);
+}
+
+/*
+ * Send the contents of a sorted spool to the leader.  Returns false if the
+ * leader has stopped listening.
+ */
+static bool
+_bt_parallel_send(shm_mq_handle *mqh, BTSpool *spool)
+{
+	IndexTuple	itup;
+	bool		should_free;
+
+	while ((itup = tuplesort_getindextuple(spool->sortstate, true,
+										   &should_free)) != NULL)
+	{
+		shm_mq_result result;
+
+		CHECK_FOR_INTERRUPTS();
+
+		result = shm_mq_send(mqh, IndexTupleSize(itup), itup, false);
+		if (should_free)
+			pfree(itup);
+		if (result == SHM_MQ_DETACHED)
+			return false;
+	}
+
+	return true;
+}
+
+/*
+ * Fetch the next tuple of one of the sorted streams the leader merges; see
+ * tuplesort_attach_sources().
+ */
+static void *
+_bt_parallel_fetch(void *arg, int source)
+{
+	BTLeader   *btleader = (BTLeader *) arg;
+	shm_mq_result result;
+	Size		nbytes;
+	void	   *data;
+
+	if (source == btleader->nqueues)
+	{
+		/* Our own sorted tuples */
+		IndexTuple	itup;
+		bool		should_free;
+
+		if (btleader->localtup != NULL)
+		{
+			pfree(btleader->localtup);
+			btleader->localtup = NULL;
+		}
+		itup = tuplesort_getindextuple(btleader->localspool->sortstate, true,
+									   &should_free);
+		if (should_free)
+			btleader->localtup = itup;
+		return itup;
+	}
+
+	if (btleader->queues[source] == NULL)
+		return NULL;
+
+	result = shm_mq_receive(btleader->queues[source], &nbytes, &data, false);
+	if (result == SHM_MQ_DETACHED)
+	{
+		/* This worker is done; find out whether it succeeded. */
+		btleader->queues[source] = NULL;
+		CheckParallelWorkerExit(btleader->pcxt, source);
+		return NULL;
+	}
+	Assert(result == SHM_MQ_SUCCESS);
+
+	return data;
+}
+
+/*
+ * Shut down a parallel index build, once the merge has consumed everything
+ * the workers sent.
+ */
+static void
+_bt_parallel_end(BTLeader *btleader)
+{
+	WaitForParallelWorkersToExit(btleader->pcxt);
+	DestroyParallelContext(btleader->pcxt);
+
+	if (btleader->localtup != NULL)
+		pfree(btleader->localtup);
+	_bt_spooldestroy(btleader->localspool);
+	pfree(btleader->queues);
+	pfree(btleader);
+}
+
+/*
+ * Main entrypoint for a parallel index build worker.
+ *
+ * We scan and sort our share of the heap, then send the leader our dead
+ * tuples (if the index is unique), an empty message, and our sorted live
+ * tuples, in that order.
+ */
+static void
+_bt_parallel_build_main(dsm_segment *seg, shm_toc *toc)
+{
+	BTShared   *shared;
+	char	   *mqspace;
+	shm_mq	   *mq;
+	shm_mq_handle *mqh;
+	Relation	heap;
+	Relation	index;
+	IndexInfo  *indexInfo;
+	BTSpool    *spool;
+	BTSpool    *spool2 = NULL;
+	bool		listening = true;
+
+	shared = shm_toc_lookup(toc, PARALLEL_BTREE_KEY_SHARED);
+	mqspace = shm_toc_lookup(toc, PARALLEL_BTREE_KEY_QUEUES);
+	Assert(shared != NULL && mqspace != NULL);
+
+	/* Attach to our queue. */
+	mq = (shm_mq *) (mqspace +
+					 ParallelWorkerNumber * PARALLEL_BTREE_QUEUE_SIZE);
+	shm_mq_set_sender(mq, MyProc);
+	mqh = shm_mq_attach(mq, seg, NULL);
+
+	/*
+	 * The leader holds locks on both relations until after we exit, so we
+	 * needn't take any; trying to could deadlock, since it holds an
+	 * exclusive lock on the new index.
+	 */
+	heap = heap_open(shared->heaprelid, NoLock);
+	index = index_open(shared->indexrelid, NoLock);
+	indexInfo = BuildIndexInfo(index);
+
+	spool = _bt_spoolinit_mem(heap, index, shared->isunique, shared->sortmem);
+	if (shared->isunique)
+		spool2 = _bt_spoolinit(heap, index, false, true);
+
+	_bt_parallel_scan_and_sort(shared, heap, index, indexInfo, spool, spool2);
+
+	if (spool2 != NULL)
+	{
+		tuplesort_performsort(spool2->sortstate);
+		listening = _bt_parallel_send(mqh, spool2);
+	}
+	if (listening &&
+		shm_mq_send(mqh, 0, "", false) == SHM_MQ_SUCCESS)
+		(void) _bt_parallel_send(mqh, spool);
+
+	if (spool2 != NULL)
+		_bt_spooldestroy(spool2);
+	_bt_spooldestroy(spool);
+	index_close(index, NoLock);
+	heap_close(heap, NoLock);
+}
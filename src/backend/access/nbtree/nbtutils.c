@@ -20,8 +20,10 @@
 #include "access/nbtree.h"
 #include "access/reloptions.h"
 #include "access/relscan.h"
+#include "catalog/catalog.h"
 #include "miscadmin.h"
 #include "utils/array.h"
+#include "utils/datum.h"
 #include "utils/lsyscache.h"
 #include "utils/memutils.h"
 #include "utils/rel.h"
@@ -655,6 +657,399 @@ _bt_restore_array_keys(IndexScanDesc scan)
 }
 
 
+/*
+ * _bt_preprocess_skip_key() -- Set up a skip scan, if possible
+ *
+ * A scan with keys on the second index column but none on the first would
+ * ordinarily have to read the whole index, since the keys on the second
+ * column can't be used as starting or stopping boundaries.  Instead, we can
+ * do one primitive index scan for each distinct value of the first column,
+ * adding an implicit "column = value" key to the scan keys each time; then
+ * the keys on the second column become boundaries, and each next value is
+ * located with a fresh descent of the tree.  When the first column has few
+ * distinct values, that visits only a small fraction of the index.
+ *
+ * The skip key goes into so->skipKey->keyData[0], ahead of a copy of
+ * scan->keyData, and _bt_preprocess_keys() takes its input from there.  As
+ * with array keys, the value can't be filled in until we know the scan
+ * direction; see _bt_start_skip_key().
+ *
+ * We don't try to combine skipping with array keys, nor to skip over more
+ * than one leading column.  System catalog indexes are not considered,
+ * to avoid doing catalog lookups while scanning catalogs.
+ */
+void
+_bt_preprocess_skip_key(IndexScanDesc scan)
+{
+	BTScanOpaque so = (BTScanOpaque) scan->opaque;
+	Relation	rel = scan->indexRelation;
+	BTSkipKeyInfo *skip;
+	bool		found_second = false;
+	int			i;
+
+	so->skipState = BTSKIP_NONE;
+
+	if (so->numArrayKeys != 0 || scan->numberOfKeys < 1 ||
+		rel->rd_index->indnatts < 2 || IsSystemRelation(rel))
+		return;
+
+	/* The keys are ordered by attribute, as _bt_preprocess_keys checks */
+	for (i = 0; i < scan->numberOfKeys; i++)
+	{
+		AttrNumber	attno = scan->keyData[i].sk_attno;
+
+		if (attno == 1)
+			return;
+		if (attno == 2)
+			found_second = true;
+	}
+	if (!found_second)
+		return;
+
+	if (so->skipKey == NULL)
+	{
+		Oid			opfamily = rel->rd_opfamily[0];
+		Oid			opcintype = rel->rd_opcintype[0];
+		Oid			eqop;
+		Oid			geop;
+		Oid			leop;
+		MemoryContext skipContext;
+
+		eqop = get_opfamily_member(opfamily, opcintype, opcintype,
+								   BTEqualStrategyNumber);
+		geop = get_opfamily_member(opfamily, opcintype, opcintype,
+								   BTGreaterEqualStrategyNumber);
+		leop = get_opfamily_member(opfamily, opcintype, opcintype,
+								   BTLessEqualStrategyNumber);
+		if (!OidIsValid(eqop) || !OidIsValid(geop) || !OidIsValid(leop))
+			return;
+
+		skipContext = AllocSetContextCreate(CurrentMemoryContext,
+											"BTree Skip Context",
+											ALLOCSET_SMALL_MINSIZE,
+											ALLOCSET_SMALL_INITSIZE,
+											ALLOCSET_SMALL_MAXSIZE);
+		skip = (BTSkipKeyInfo *) MemoryContextAllocZero(skipContext,
+													  sizeof(BTSkipKeyInfo));
+		skip->skipContext = skipContext;
+		skip->keyData = (ScanKey)
+			MemoryContextAllocZero(skipContext,
+						   (scan->numberOfKeys + 1) * sizeof(ScanKeyData));
+		fmgr_info_cxt(get_opcode(eqop), &skip->eqproc, skipContext);
+		fmgr_info_cxt(get_opcode(geop), &skip->geproc, skipContext);
+		fmgr_info_cxt(get_opcode(leop), &skip->leproc, skipContext);
+
+		/* No value yet; make the key look like an IS NULL key meanwhile */
+		skip->keyData[0].sk_flags = SK_ISNULL | SK_SEARCHNULL;
+		skip->mark_key.sk_flags = SK_ISNULL | SK_SEARCHNULL;
+		skip->mark_state = BTSKIP_NONE;
+
+		/* _bt_preprocess_keys needs room for the extra key, too */
+		so->keyData = (ScanKey) repalloc(so->keyData,
+						   (scan->numberOfKeys + 1) * sizeof(ScanKeyData));
+
+		so->skipKey = skip;
+	}
+	skip = so->skipKey;
+
+	memcpy(&skip->keyData[1], scan->keyData,
+		   scan->numberOfKeys * sizeof(ScanKeyData));
+	skip->mark_state = BTSKIP_NONE;
+
+	so->skipState = BTSKIP_ACTIVE;
+}
+
+/*
+ * Release the value of a skip key, if it has one of its own.
+ */
+static void
+_bt_free_skip_value(IndexScanDesc scan, ScanKey skey)
+{
+	Form_pg_attribute attr = RelationGetDescr(scan->indexRelation)->attrs[0];
+
+	if (!(skey->sk_flags & SK_ISNULL) && !attr->attbyval)
+		pfree(DatumGetPointer(skey->sk_argument));
+	skey->sk_flags = SK_ISNULL | SK_SEARCHNULL;
+	skey->sk_argument = (Datum) 0;
+}
+
+/*
+ * Install a new skip key, of the given strategy, for a value returned by
+ * _bt_skip_next_value().
+ */
+static void
+_bt_set_skip_key(IndexScanDesc scan, Datum value, bool isnull,
+				 StrategyNumber strategy)
+{
+	BTScanOpaque so = (BTScanOpaque) scan->opaque;
+	BTSkipKeyInfo *skip = so->skipKey;
+	Relation	rel = scan->indexRelation;
+	ScanKey		skey = &skip->keyData[0];
+	MemoryContext oldcxt;
+
+	_bt_free_skip_value(scan, skey);
+
+	oldcxt = MemoryContextSwitchTo(skip->skipContext);
+	if (isnull)
+	{
+		/* _bt_fix_scankey_strategy will fill in the strategy */
+		Assert(strategy == BTEqualStrategyNumber);
+		ScanKeyEntryInitialize(skey,
+							   SK_ISNULL | SK_SEARCHNULL,
+							   1,
+							   InvalidStrategy,
+							   InvalidOid,
+							   InvalidOid,
+							   InvalidOid,
+							   (Datum) 0);
+	}
+	else
+	{
+		FmgrInfo   *proc;
+
+		switch (strategy)
+		{
+			case BTEqualStrategyNumber:
+				proc = &skip->eqproc;
+				break;
+			case BTGreaterEqualStrategyNumber:
+				proc = &skip->geproc;
+				break;
+			case BTLessEqualStrategyNumber:
+				proc = &skip->leproc;
+				break;
+			default:
+				elog(ERROR, "unexpected skip key strategy: %d",
+					 (int) strategy);
+				proc = NULL;	/* keep compiler quiet */
+				break;
+		}
+		ScanKeyEntryInitializeWithInfo(skey,
+									   0,
+									   1,
+									   strategy,
+									   rel->rd_opcintype[0],
+									   rel->rd_indcollation[0],
+									   proc,
+									   value);
+	}
+	MemoryContextSwitchTo(oldcxt);
+
+	skip->generation++;
+}
+
+/*
+ * _bt_start_skip_key() -- Initialize the skip key at start of a scan
+ *
+ * Find the first value of the first index column in the scan direction, and
+ * set up the skip key to match it.  Returns FALSE if the index is empty.
+ */
+bool
+_bt_start_skip_key(IndexScanDesc scan, ScanDirection dir)
+{
+	BTScanOpaque so = (BTScanOpaque) scan->opaque;
+	BTSkipKeyInfo *skip = so->skipKey;
+	Datum		value;
+	bool		isnull;
+	BlockNumber blkno;
+
+	if (!_bt_skip_next_value(scan, dir, false, &value, &isnull, &blkno))
+		return false;
+
+	so->skipState = BTSKIP_ACTIVE;
+	skip->cur_blkno = blkno;
+	skip->num_dense = 0;
+	_bt_set_skip_key(scan, value, isnull, BTEqualStrategyNumber);
+
+	return true;
+}
+
+/*
+ * _bt_advance_skip_key() -- Advance to the next value of the first column
+ *
+ * Returns TRUE if there is another primitive index scan to do, FALSE if not.
+ * On TRUE result, the skip key has been set up for it.
+ *
+ * If the values of the first column turn out to be so dense that each one
+ * only takes up part of a page, skipping costs two tree descents per value
+ * and saves nothing, so we give up on it: the skip key becomes a plain
+ * boundary condition ("column >= value" in a forward scan), and the rest of
+ * the index is read in one go.  That can't return entries with a null first
+ * column, so if there might be some still ahead of us, one last primitive
+ * scan with an IS NULL skip key picks them up.
+ */
+bool
+_bt_advance_skip_key(IndexScanDesc scan, ScanDirection dir)
+{
+	BTScanOpaque so = (BTScanOpaque) scan->opaque;
+	BTSkipKeyInfo *skip = so->skipKey;
+	int16		indoption = scan->indexRelation->rd_indoption[0];
+	Datum		value;
+	bool		isnull;
+	BlockNumber blkno;
+
+	/*
+	 * If the other keys are contradictory, no value of the first column will
+	 * help.  (The skip key itself can't cause that, being the only key on
+	 * the first column.)
+	 */
+	if (!so->qual_ok)
+		return false;
+
+	/*
+	 * If the scan has changed direction since we gave up skipping (FETCH
+	 * BACKWARD in a scroll cursor, say), we have now come back to where the
+	 * final pass started, and the values we skipped over on the way there lie
+	 * ahead of us again.  Go back to skipping, carrying on from the value the
+	 * final pass started at.  If we'd got as far as the nulls, that's the
+	 * nulls themselves, since the final pass covered all the other values.
+	 */
+	if (so->skipState != BTSKIP_ACTIVE && dir != skip->final_dir)
+	{
+		ScanKey		skey = &skip->keyData[0];
+
+		isnull = (skey->sk_flags & SK_ISNULL) != 0;
+		if (isnull)
+			value = (Datum) 0;
+		else
+		{
+			Form_pg_attribute attr;
+			MemoryContext oldcxt;
+
+			attr = RelationGetDescr(scan->indexRelation)->attrs[0];
+			oldcxt = MemoryContextSwitchTo(skip->skipContext);
+			value = datumCopy(skey->sk_argument, attr->attbyval,
+							  attr->attlen);
+			MemoryContextSwitchTo(oldcxt);
+		}
+		so->skipState = BTSKIP_ACTIVE;
+		skip->cur_blkno = InvalidBlockNumber;
+		skip->num_dense = 0;
+		_bt_set_skip_key(scan, value, isnull, BTEqualStrategyNumber);
+	}
+
+	switch (so->skipState)
+	{
+		case BTSKIP_ACTIVE:
+			break;
+		case BTSKIP_FINAL:
+			/* Are there nulls ahead of us in the scan direction? */
+			if (ScanDirectionIsForward(dir) ==
+				((indoption & INDOPTION_NULLS_FIRST) == 0))
+			{
+				so->skipState = BTSKIP_NULLS;
+				_bt_set_skip_key(scan, (Datum) 0, true,
+								 BTEqualStrategyNumber);
+				return true;
+			}
+			return false;
+		default:
+			return false;
+	}
+
+	if (!_bt_skip_next_value(scan, dir, true, &value, &isnull, &blkno))
+		return false;
+
+	if (blkno == skip->cur_blkno)
+		skip->num_dense++;
+	else
+		skip->num_dense = 0;
+	skip->cur_blkno = blkno;
+
+	if (skip->num_dense >= BTSKIP_MAX_DENSE && !isnull)
+	{
+		StrategyNumber strategy;
+
+		/*
+		 * The key is expressed in terms of the operator's own ordering, so
+		 * for a DESC column the sense is reversed (_bt_preprocess_keys will
+		 * commute it back).
+		 */
+		if (ScanDirectionIsForward(dir) == ((indoption & INDOPTION_DESC) == 0))
+			strategy = BTGreaterEqualStrategyNumber;
+		else
+			strategy = BTLessEqualStrategyNumber;
+		so->skipState = BTSKIP_FINAL;
+		skip->final_dir = dir;
+		_bt_set_skip_key(scan, value, false, strategy);
+	}
+	else
+		_bt_set_skip_key(scan, value, isnull, BTEqualStrategyNumber);
+
+	return true;
+}
+
+/*
+ * _bt_mark_skip_key() -- Handle the skip key during btmarkpos
+ *
+ * Save the current skip key as the "mark" position.
+ */
+void
+_bt_mark_skip_key(IndexScanDesc scan)
+{
+	BTScanOpaque so = (BTScanOpaque) scan->opaque;
+	BTSkipKeyInfo *skip = so->skipKey;
+	Form_pg_attribute attr = RelationGetDescr(scan->indexRelation)->attrs[0];
+	ScanKey		skey = &skip->keyData[0];
+
+	if (skip->mark_state != BTSKIP_NONE &&
+		skip->mark_generation == skip->generation)
+		return;					/* mark already matches */
+
+	_bt_free_skip_value(scan, &skip->mark_key);
+	memcpy(&skip->mark_key, skey, sizeof(ScanKeyData));
+	if (!(skey->sk_flags & SK_ISNULL))
+	{
+		MemoryContext oldcxt = MemoryContextSwitchTo(skip->skipContext);
+
+		skip->mark_key.sk_argument = datumCopy(skey->sk_argument,
+											   attr->attbyval,
+											   attr->attlen);
+		MemoryContextSwitchTo(oldcxt);
+	}
+	skip->mark_state = so->skipState;
+	skip->mark_final_dir = skip->final_dir;
+	skip->mark_generation = skip->generation;
+}
+
+/*
+ * _bt_restore_skip_key() -- Handle the skip key during btrestrpos
+ *
+ * Restore the skip key to what it was when the mark was set.
+ */
+void
+_bt_restore_skip_key(IndexScanDesc scan)
+{
+	BTScanOpaque so = (BTScanOpaque) scan->opaque;
+	BTSkipKeyInfo *skip = so->skipKey;
+	Form_pg_attribute attr = RelationGetDescr(scan->indexRelation)->attrs[0];
+	ScanKey		skey = &skip->keyData[0];
+
+	if (skip->mark_state == BTSKIP_NONE ||
+		skip->mark_generation == skip->generation)
+		return;
+
+	_bt_free_skip_value(scan, skey);
+	memcpy(skey, &skip->mark_key, sizeof(ScanKeyData));
+	if (!(skey->sk_flags & SK_ISNULL))
+	{
+		MemoryContext oldcxt = MemoryContextSwitchTo(skip->skipContext);
+
+		skey->sk_argument = datumCopy(skip->mark_key.sk_argument,
+									  attr->attbyval,
+									  attr->attlen);
+		MemoryContextSwitchTo(oldcxt);
+	}
+	so->skipState = skip->mark_state;
+	skip->final_dir = skip->mark_final_dir;
+	skip->generation = skip->mark_generation;
+
+	/* As in _bt_restore_array_keys, redo the preprocessing */
+	_bt_preprocess_keys(scan);
+	Assert(so->qual_ok);
+}
+
+
 /*
  *	_bt_preprocess_keys() -- Preprocess scan keys
  *
@@ -764,9 +1159,15 @@ _bt_preprocess_keys(IndexScanDesc scan)
 		return;					/* done if qual-less scan */
 
 	/*
-	 * Read so->arrayKeyData if array keys are present, else scan->keyData
+	 * Read the skip key and its companions if this is a skip scan, else
+	 * so->arrayKeyData if array keys are present, else scan->keyData
 	 */
-	if (so->arrayKeyData != NULL)
+	if (so->skipState != BTSKIP_NONE)
+	{
+		inkeys = so->skipKey->keyData;
+		numberOfKeys++;
+	}
+	else if (so->arrayKeyData != NULL)
 		inkeys = so->arrayKeyData;
 	else
 		inkeys = scan->keyData;
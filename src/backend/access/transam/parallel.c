@@ -0,0 +1,642 @@
+/*-------------------------------------------------------------------------
+ *
+ * parallel.c
+ *	  Infrastructure for launching parallel workers
+ *
+ * A parallel context is a dynamic shared memory segment plus a group of
+ * dynamic background workers that attach to it.  The master backend sizes
+ * the segment by adding its own requirements to the context's shm_toc
+ * estimator, calls InitializeParallelDSM() to create it, fills in whatever
+ * data the workers need, and then calls LaunchParallelWorkers().  Each
+ * worker connects to the master's database, restores the master's active
+ * snapshot, and then calls the entrypoint function given when the context
+ * was created.
+ *
+ * Workers also adopt the master's XIDs, command ID and combo CIDs, so they
+ * see the same tuples as the master, including those written earlier in
+ * the master's transaction.  They do not see its GUC settings or predicate
+ * locks, nor anything in its local buffers, so callers must not use
+ * parallelism in serializable transactions or on temporary relations, and
+ * must only give workers code that does not depend on session state.  The
+ * master must not change anything the workers might look at while they are
+ * running.  Workers normally run with XactReadOnly set.  If the master sets
+ * allow_writes in the context before creating the segment, workers may
+ * instead write tuples, which are stamped with the master's current XID and
+ * command ID and so become part of the master's transaction; it's then up to
+ * the caller to make sure that what they write doesn't need anything else a
+ * worker can't do, such as firing triggers.
+ *
+ * An error in a worker, along with its detail and context, is saved in the
+ * shared segment before the worker exits.  The master notices the worker's
+ * departure through whatever message queue it uses to talk to the worker,
+ * and then calls CheckParallelWorkerExit() to rethrow the error.
+ *
+ * Portions Copyright (c) 1996-2014, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, Regents of the University of California
+ *
+ * IDENTIFICATION
+ *	  src/backend/access/transam/parallel.c
+ *
+ *-------------------------------------------------------------------------
+ */
+
+#include "postgres.h"
+
+#include "access/parallel.h"
+#include "access/xact.h"
+#include "commands/dbcommands.h"
+#include "libpq/pqsignal.h"
+#include "miscadmin.h"
+#include "storage/ipc.h"
+#include "storage/proc.h"
+#include "storage/spin.h"
+#include "tcop/tcopprot.h"
+#include "utils/combocid.h"
+#include "utils/memutils.h"
+#include "utils/resowner.h"
+#include "utils/snapmgr.h"
+
+
+/* Magic number for parallel context TOC. */
+#define PARALLEL_MAGIC						0x50477c7c
+
+/*
+ * Magic numbers for parallel state sharing.  Higher-level code should use
+ * smaller values, leaving these very large ones for use by this module.
+ */
+#define PARALLEL_KEY_FIXED					UINT64CONST(0xFFFFFFFFFFFF0001)
+#define PARALLEL_KEY_SNAPSHOT				UINT64CONST(0xFFFFFFFFFFFF0002)
+#define PARALLEL_KEY_TRANSACTION_STATE		UINT64CONST(0xFFFFFFFFFFFF0003)
+#define PARALLEL_KEY_COMBO_CID				UINT64CONST(0xFFFFFFFFFFFF0004)
+
+/* Length of each error field a worker can pass back to the master. */
+#define PARALLEL_ERROR_MESSAGE_LEN			1024
+
+/* Worker states, as seen by the master. */
+#define PARALLEL_WORKER_NOT_STARTED			0
+#define PARALLEL_WORKER_RUNNING				1
+#define PARALLEL_WORKER_FINISHED			2
+#define PARALLEL_WORKER_FAILED				3
+
+/* Per-worker status, in the fixed shared state. */
+typedef struct ParallelWorkerSlot
+{
+	int			status;
+	int			sqlerrcode;
+	char		message[PARALLEL_ERROR_MESSAGE_LEN];
+	char		detail[PARALLEL_ERROR_MESSAGE_LEN];
+	char		context[PARALLEL_ERROR_MESSAGE_LEN];
+} ParallelWorkerSlot;
+
+/* Fixed-size parallel state. */
+typedef struct FixedParallelState
+{
+	/* Fixed-size state that workers must restore. */
+	Oid			database_id;
+	char		database_name[NAMEDATALEN];
+	Oid			current_user_id;
+	int			sec_context;
+	PGPROC	   *parallel_master_pgproc;
+	pid_t		parallel_master_pid;
+	parallel_worker_main_type entrypoint;
+	bool		allow_writes;
+
+	/* Mutex protects the worker slots. */
+	slock_t		mutex;
+	ParallelWorkerSlot worker[FLEXIBLE_ARRAY_MEMBER];
+} FixedParallelState;
+
+/*
+ * Our parallel worker number.  We initialize this to -1, meaning that we are
+ * not a parallel worker.  In parallel workers, it will be set to a value >= 0
+ * and < the number of workers before any user code is invoked; each parallel
+ * worker will get a different parallel worker number.
+ */
+int			ParallelWorkerNumber = -1;
+
+/* List of active parallel contexts. */
+static dlist_head pcxt_list = DLIST_STATIC_INIT(pcxt_list);
+
+/*
+ * Establish a new parallel context.  Unless there is an error, the context
+ * should be destroyed before exiting the current subtransaction.
+ */
+ParallelContext *
+CreateParallelContext(parallel_worker_main_type entrypoint, int nworkers)
+{
+	MemoryContext oldcontext;
+	ParallelContext *pcxt;
+
+	/* It is unsafe to create a parallel context if not in parallel mode. */
+	Assert(!IsParallelWorker());
+
+	/* Number of workers should be non-negative. */
+	Assert(nworkers >= 0);
+
+	/* We might be running in a short-lived memory context. */
+	oldcontext = MemoryContextSwitchTo(TopTransactionContext);
+
+	/* Initialize a new ParallelContext. */
+	pcxt = palloc0(sizeof(ParallelContext));
+	pcxt->subid = GetCurrentSubTransactionId();
+	pcxt->nworkers = nworkers;
+	pcxt->entrypoint = entrypoint;
+	shm_toc_initialize_estimator(&pcxt->estimator);
+	dlist_push_head(&pcxt_list, &pcxt->node);
+
+	/* Restore previous memory context. */
+	MemoryContextSwitchTo(oldcontext);
+
+	return pcxt;
+}
+
+/*
+ * Establish the dynamic shared memory segment for a parallel context and
+ * copy state and other bookkeeping information that will be needed by
+ * parallel workers into it.  The caller must already have added its own
+ * requirements to pcxt->estimator.  The active snapshot is the one workers
+ * will see.
+ */
+void
+InitializeParallelDSM(ParallelContext *pcxt)
+{
+	MemoryContext oldcontext;
+	Size		segsize;
+	Size		snapshot_len;
+	Size		tstate_len;
+	Size		combocid_len;
+	Snapshot	snapshot = GetActiveSnapshot();
+	FixedParallelState *fps;
+	char	   *snapshotspace;
+	char	   *tstatespace;
+	char	   *combocidspace;
+	char	   *dbname;
+	int			i;
+
+	/* We might be running in a very short-lived memory context. */
+	oldcontext = MemoryContextSwitchTo(TopTransactionContext);
+
+	/* Workers that write need an XID to stamp their tuples with. */
+	if (pcxt->allow_writes)
+		(void) GetCurrentTransactionId();
+
+	/* Estimate space for our own state. */
+	shm_toc_estimate_chunk(&pcxt->estimator,
+						   add_size(offsetof(FixedParallelState, worker),
+									mul_size(sizeof(ParallelWorkerSlot),
+											 pcxt->nworkers)));
+	snapshot_len = EstimateSnapshotSpace(snapshot);
+	shm_toc_estimate_chunk(&pcxt->estimator, snapshot_len);
+	tstate_len = EstimateTransactionStateSpace();
+	shm_toc_estimate_chunk(&pcxt->estimator, tstate_len);
+	combocid_len = EstimateComboCIDStateSpace();
+	shm_toc_estimate_chunk(&pcxt->estimator, combocid_len);
+	shm_toc_estimate_keys(&pcxt->estimator, 4);
+
+	/* Create DSM and initialize with new table of contents. */
+	segsize = shm_toc_estimate(&pcxt->estimator);
+	pcxt->seg = dsm_create(segsize);
+	pcxt->toc = shm_toc_create(PARALLEL_MAGIC,
+							   dsm_segment_address(pcxt->seg),
+							   segsize);
+
+	/* Initialize fixed-size state in shared memory. */
+	fps = (FixedParallelState *)
+		shm_toc_allocate(pcxt->toc,
+						 add_size(offsetof(FixedParallelState, worker),
+								  mul_size(sizeof(ParallelWorkerSlot),
+										   pcxt->nworkers)));
+	fps->database_id = MyDatabaseId;
+	dbname = get_database_name(MyDatabaseId);
+	if (dbname == NULL)
+		elog(ERROR, "cache lookup failed for database %u", MyDatabaseId);
+	strlcpy(fps->database_name, dbname, NAMEDATALEN);
+	GetUserIdAndSecContext(&fps->current_user_id, &fps->sec_context);
+	fps->parallel_master_pgproc = MyProc;
+	fps->parallel_master_pid = MyProcPid;
+	fps->entrypoint = pcxt->entrypoint;
+	fps->allow_writes = pcxt->allow_writes;
+	SpinLockInit(&fps->mutex);
+	for (i = 0; i < pcxt->nworkers; ++i)
+	{
+		fps->worker[i].status = PARALLEL_WORKER_NOT_STARTED;
+		fps->worker[i].sqlerrcode = 0;
+		fps->worker[i].message[0] = '\0';
+		fps->worker[i].detail[0] = '\0';
+		fps->worker[i].context[0] = '\0';
+	}
+	shm_toc_insert(pcxt->toc, PARALLEL_KEY_FIXED, fps);
+
+	/* Serialize the snapshot the workers will use. */
+	snapshotspace = shm_toc_allocate(pcxt->toc, snapshot_len);
+	SerializeSnapshot(snapshot, snapshotspace);
+	shm_toc_insert(pcxt->toc, PARALLEL_KEY_SNAPSHOT, snapshotspace);
+
+	/* Serialize our transaction's XIDs, command ID and combo CIDs. */
+	tstatespace = shm_toc_allocate(pcxt->toc, tstate_len);
+	SerializeTransactionState(tstate_len, tstatespace);
+	shm_toc_insert(pcxt->toc, PARALLEL_KEY_TRANSACTION_STATE, tstatespace);
+	combocidspace = shm_toc_allocate(pcxt->toc, combocid_len);
+	SerializeComboCIDState(combocid_len, combocidspace);
+	shm_toc_insert(pcxt->toc, PARALLEL_KEY_COMBO_CID, combocidspace);
+
+	/* Allocate space for worker information. */
+	pcxt->worker = palloc0(sizeof(ParallelWorkerInfo) * Max(pcxt->nworkers, 1));
+
+	/* Restore previous memory context. */
+	MemoryContextSwitchTo(oldcontext);
+}
+
+/*
+ * Launch parallel workers.
+ *
+ * We might not be able to register as many workers as requested, if
+ * max_worker_processes is exhausted; callers must cope with any number of
+ * workers, including zero, as indicated by pcxt->nworkers_launched.  Worker
+ * i is always the one registered with pcxt->worker[i].bgwhandle.
+ */
+void
+LaunchParallelWorkers(ParallelContext *pcxt)
+{
+	MemoryContext oldcontext;
+	BackgroundWorker worker;
+	int			i;
+
+	/* Skip this if we have no workers. */
+	if (pcxt->nworkers == 0)
+		return;
+
+	/* We might be running in a short-lived memory context. */
+	oldcontext = MemoryContextSwitchTo(TopTransactionContext);
+
+	/* Configure a worker. */
+	snprintf(worker.bgw_name, BGW_MAXLEN, "parallel worker for PID %d",
+			 MyProcPid);
+	worker.bgw_flags =
+		BGWORKER_SHMEM_ACCESS | BGWORKER_BACKEND_DATABASE_CONNECTION;
+	worker.bgw_start_time = BgWorkerStart_ConsistentState;
+	worker.bgw_restart_time = BGW_NEVER_RESTART;
+	worker.bgw_main = ParallelWorkerMain;
+	worker.bgw_library_name[0] = '\0';
+	worker.bgw_function_name[0] = '\0';
+	worker.bgw_main_arg = UInt32GetDatum(dsm_segment_handle(pcxt->seg));
+	worker.bgw_notify_pid = MyProcPid;
+	memset(&worker.bgw_extra, 0, BGW_EXTRALEN);
+
+	/*
+	 * Start workers.
+	 *
+	 * The caller must be able to tolerate ending up with fewer workers than
+	 * expected, so there is no need to throw an error here if registration
+	 * fails.  It wouldn't help much anyway, because registering the worker
+	 * in no way guarantees that it will start up and initialize successfully.
+	 */
+	for (i = 0; i < pcxt->nworkers; ++i)
+	{
+		memcpy(worker.bgw_extra, &i, sizeof(int));
+		if (!RegisterDynamicBackgroundWorker(&worker,
+											 &pcxt->worker[i].bgwhandle))
+			break;
+		pcxt->nworkers_launched++;
+	}
+
+	/* Restore previous memory context. */
+	MemoryContextSwitchTo(oldcontext);
+}
+
+/*
+ * Check how a parallel worker left.
+ *
+ * Callers should call this after noticing that a worker has detached from
+ * the queue they use to talk to it.  If the worker failed, or exited while
+ * it was doing work on our behalf without saying why, we throw an error; if
+ * it finished normally, or never got as far as running any of our code, we
+ * simply return.
+ */
+void
+CheckParallelWorkerExit(ParallelContext *pcxt, int worker)
+{
+	FixedParallelState *fps;
+	volatile ParallelWorkerSlot *slot;
+	int			status;
+
+	Assert(worker >= 0 && worker < pcxt->nworkers_launched);
+
+	fps = shm_toc_lookup(pcxt->toc, PARALLEL_KEY_FIXED);
+	slot = &fps->worker[worker];
+
+	SpinLockAcquire(&fps->mutex);
+	status = slot->status;
+	SpinLockRelease(&fps->mutex);
+
+	/* A failed worker won't touch its slot again, so we can read it freely. */
+	if (status == PARALLEL_WORKER_FAILED)
+		ereport(ERROR,
+				(errcode(slot->sqlerrcode),
+				 errmsg_internal("%s", slot->message),
+				 slot->detail[0] != '\0' ?
+				 errdetail_internal("%s", slot->detail) : 0,
+				 slot->context[0] != '\0' ?
+				 errcontext("%s", slot->context) : 0,
+				 errcontext("parallel worker")));
+	else if (status == PARALLEL_WORKER_RUNNING)
+		ereport(ERROR,
+				(errcode(ERRCODE_OBJECT_NOT_IN_PREREQUISITE_STATE),
+				 errmsg("parallel worker exited unexpectedly")));
+}
+
+/*
+ * Wait for all workers to exit.
+ *
+ * Even if the parallel operation seems to have completed successfully, it's
+ * important to call this function afterwards.  We must not miss any errors
+ * the workers may have thrown during the parallel operation, or any that they
+ * may yet throw while shutting down; and workers may rely on the master's
+ * locks on the relations they use, which the master must not release until
+ * they are gone.
+ */
+void
+WaitForParallelWorkersToExit(ParallelContext *pcxt)
+{
+	int			i;
+
+	/* Wait until the workers actually die. */
+	for (i = 0; i < pcxt->nworkers_launched; ++i)
+	{
+		BgwHandleStatus status;
+
+		if (pcxt->worker == NULL || pcxt->worker[i].bgwhandle == NULL)
+			continue;
+
+		status = WaitForBackgroundWorkerShutdown(pcxt->worker[i].bgwhandle);
+
+		/*
+		 * If the postmaster kicked the bucket, we have no chance of cleaning
+		 * up safely -- we won't be able to tell when our workers are actually
+		 * dead.  This doesn't necessitate a PANIC since they will all abort
+		 * eventually, but we can't safely continue this session.
+		 */
+		if (status == BGWH_POSTMASTER_DIED)
+			ereport(FATAL,
+					(errcode(ERRCODE_ADMIN_SHUTDOWN),
+				 errmsg("postmaster exited during a parallel transaction")));
+
+		/* Release memory. */
+		pfree(pcxt->worker[i].bgwhandle);
+		pcxt->worker[i].bgwhandle = NULL;
+	}
+}
+
+/*
+ * Destroy a parallel context.
+ *
+ * If expecting a clean exit, you should use WaitForParallelWorkersToExit()
+ * first, before calling this function.  When this function is invoked, any
+ * remaining workers are forcibly killed; the dynamic shared memory segment
+ * is unmapped; and we then wait (uninterruptibly) for the workers to exit.
+ */
+void
+DestroyParallelContext(ParallelContext *pcxt)
+{
+	int			i;
+
+	/*
+	 * Be careful about order of operations here!  We remove the parallel
+	 * context from the list before we do anything else; otherwise, if an
+	 * error occurs during a subsequent step, we might try to nuke it again
+	 * from AtEOXact_Parallel or AtEOSubXact_Parallel.
+	 */
+	dlist_delete(&pcxt->node);
+
+	/* Kill any workers that haven't finished of their own accord. */
+	if (pcxt->worker != NULL && pcxt->toc != NULL)
+	{
+		FixedParallelState *fps;
+
+		fps = shm_toc_lookup(pcxt->toc, PARALLEL_KEY_FIXED);
+		for (i = 0; i < pcxt->nworkers_launched; ++i)
+		{
+			volatile ParallelWorkerSlot *slot = &fps->worker[i];
+			int			status;
+
+			if (pcxt->worker[i].bgwhandle == NULL)
+				continue;
+
+			SpinLockAcquire(&fps->mutex);
+			status = slot->status;
+			SpinLockRelease(&fps->mutex);
+
+			if (status != PARALLEL_WORKER_FINISHED &&
+				status != PARALLEL_WORKER_FAILED)
+				TerminateBackgroundWorker(pcxt->worker[i].bgwhandle);
+		}
+	}
+
+	/*
+	 * If we have allocated a shared memory segment, detach it.  This will
+	 * implicitly detach any message queues in it, so that workers blocked on
+	 * them notice that we are gone.
+	 */
+	if (pcxt->seg != NULL)
+	{
+		dsm_detach(pcxt->seg);
+		pcxt->seg = NULL;
+		pcxt->toc = NULL;
+	}
+
+	/*
+	 * We can't finish transaction commit or abort until all of the workers
+	 * have exited.  This means, in particular, that we can't respond to
+	 * interrupts at this stage.
+	 */
+	HOLD_INTERRUPTS();
+	WaitForParallelWorkersToExit(pcxt);
+	RESUME_INTERRUPTS();
+
+	/* Free the worker array itself. */
+	if (pcxt->worker != NULL)
+	{
+		pfree(pcxt->worker);
+		pcxt->worker = NULL;
+	}
+
+	/* Free the ParallelContext itself. */
+	pfree(pcxt);
+}
+
+/*
+ * End-of-subtransaction cleanup for parallel contexts.
+ *
+ * Currently, it's forbidden to enter or leave a subtransaction while
+ * a parallel operation is in progress, so there should be nothing to do
+ * on commit; but on abort we must get rid of any contexts created inside
+ * the aborted subtransaction.
+ */
+void
+AtEOSubXact_Parallel(bool isCommit, SubTransactionId mySubId)
+{
+	dlist_mutable_iter iter;
+
+	dlist_foreach_modify(iter, &pcxt_list)
+	{
+		ParallelContext *pcxt;
+
+		pcxt = dlist_container(ParallelContext, node, iter.cur);
+		if (pcxt->subid != mySubId)
+			continue;
+		if (isCommit)
+			elog(WARNING, "leaked parallel context");
+		DestroyParallelContext(pcxt);
+	}
+}
+
+/*
+ * End-of-transaction cleanup for parallel contexts.
+ */
+void
+AtEOXact_Parallel(bool isCommit)
+{
+	while (!dlist_is_empty(&pcxt_list))
+	{
+		ParallelContext *pcxt;
+
+		pcxt = dlist_head_element(ParallelContext, node, &pcxt_list);
+		if (isCommit)
+			elog(WARNING, "leaked parallel context");
+		DestroyParallelContext(pcxt);
+	}
+}
+
+/*
+ * Main entrypoint for parallel workers.
+ */
+void
+ParallelWorkerMain(Datum main_arg)
+{
+	dsm_segment *seg;
+	shm_toc    *toc;
+	FixedParallelState *fps;
+	volatile ParallelWorkerSlot *slot;
+	Snapshot	snapshot;
+
+	/* Find out which worker slot is ours. */
+	memcpy(&ParallelWorkerNumber, MyBgworkerEntry->bgw_extra, sizeof(int));
+
+	/*
+	 * Establish signal handlers.  We want CHECK_FOR_INTERRUPTS() to kill off
+	 * this worker just as it would a normal user backend.
+	 */
+	pqsignal(SIGTERM, die);
+	BackgroundWorkerUnblockSignals();
+
+	/* Set up a memory context and resource owner. */
+	Assert(CurrentResourceOwner == NULL);
+	CurrentResourceOwner = ResourceOwnerCreate(NULL, "parallel toplevel");
+	CurrentMemoryContext = AllocSetContextCreate(TopMemoryContext,
+												 "parallel worker",
+												 ALLOCSET_DEFAULT_MINSIZE,
+												 ALLOCSET_DEFAULT_INITSIZE,
+												 ALLOCSET_DEFAULT_MAXSIZE);
+
+	/*
+	 * Now that we have a resource owner, we can attach to the dynamic shared
+	 * memory segment and read the table of contents.
+	 */
+	seg = dsm_attach(DatumGetUInt32(main_arg));
+	if (seg == NULL)
+		ereport(ERROR,
+				(errcode(ERRCODE_OBJECT_NOT_IN_PREREQUISITE_STATE),
+				 errmsg("unable to map dynamic shared memory segment")));
+	toc = shm_toc_attach(PARALLEL_MAGIC, dsm_segment_address(seg));
+	if (toc == NULL)
+		ereport(ERROR,
+				(errcode(ERRCODE_OBJECT_NOT_IN_PREREQUISITE_STATE),
+			   errmsg("bad magic number in dynamic shared memory segment")));
+
+	/* Look up fixed parallel state. */
+	fps = shm_toc_lookup(toc, PARALLEL_KEY_FIXED);
+	Assert(fps != NULL);
+	slot = &fps->worker[ParallelWorkerNumber];
+
+	/*
+	 * Connect to the master's database.  We connect as the bootstrap
+	 * superuser, so that per-role connection limits don't get in the way,
+	 * and switch to the master's user ID below.  An error up to this point
+	 * is harmless to the master: we haven't done any work for it yet.
+	 */
+	BackgroundWorkerInitializeConnection(fps->database_name, NULL);
+
+	PG_TRY();
+	{
+		if (MyDatabaseId != fps->database_id)
+			ereport(ERROR,
+					(errcode(ERRCODE_UNDEFINED_DATABASE),
+					 errmsg("database \"%s\" does not match the parallel master's database",
+							fps->database_name)));
+
+		/*
+		 * Start a transaction that acts as part of the master's, running on
+		 * the master's snapshot.  It's read-only unless the master said
+		 * otherwise.
+		 */
+		StartTransactionCommand();
+		XactReadOnly = !fps->allow_writes;
+		RestoreTransactionState(shm_toc_lookup(toc,
+										   PARALLEL_KEY_TRANSACTION_STATE));
+		RestoreComboCIDState(shm_toc_lookup(toc, PARALLEL_KEY_COMBO_CID));
+		snapshot = RestoreSnapshot(shm_toc_lookup(toc, PARALLEL_KEY_SNAPSHOT));
+		RestoreTransactionSnapshot(snapshot, fps->parallel_master_pgproc);
+		PushActiveSnapshot(snapshot);
+
+		/* Act on behalf of the master's current user. */
+		SetUserIdAndSecContext(fps->current_user_id, fps->sec_context);
+
+		SpinLockAcquire(&fps->mutex);
+		slot->status = PARALLEL_WORKER_RUNNING;
+		SpinLockRelease(&fps->mutex);
+
+		/* Do the actual work. */
+		fps->entrypoint(seg, toc);
+
+		PopActiveSnapshot();
+		CommitTransactionCommand();
+	}
+	PG_CATCH();
+	{
+		ErrorData  *edata;
+
+		/* Tell the master what went wrong, then let the error take us out. */
+		MemoryContextSwitchTo(TopMemoryContext);
+		edata = CopyErrorData();
+
+		SpinLockAcquire(&fps->mutex);
+		slot->status = PARALLEL_WORKER_FAILED;
+		slot->sqlerrcode = edata->sqlerrcode;
+		strlcpy((char *) slot->message,
+				edata->message ? edata->message : "",
+				PARALLEL_ERROR_MESSAGE_LEN);
+		strlcpy((char *) slot->detail,
+				edata->detail ? edata->detail : "",
+				PARALLEL_ERROR_MESSAGE_LEN);
+		strlcpy((char *) slot->context,
+				edata->context ? edata->context : "",
+				PARALLEL_ERROR_MESSAGE_LEN);
+		SpinLockRelease(&fps->mutex);
+
+		PG_RE_THROW();
+	}
+	PG_END_TRY();
+
+	SpinLockAcquire(&fps->mutex);
+	slot->status = PARALLEL_WORKER_FINISHED;
+	SpinLockRelease(&fps->mutex);
+
+	/*
+	 * Detach explicitly, so that any message queues in the segment are
+	 * detached only now that our status says we finished cleanly.
+	 */
+	dsm_detach(seg);
+
+	/* Exit with status 1, so that the postmaster doesn't restart us. */
+	proc_exit(1);
+}
@@ -21,6 +21,7 @@
 #include <unistd.h>
 
 #include "access/multixact.h"
+#include "access/parallel.h"
 #include "access/subtrans.h"
 #include "access/transam.h"
 #include "access/twophase.h"
@@ -46,6 +47,7 @@
 #include "storage/procarray.h"
 #include "storage/sinvaladt.h"
 #include "storage/smgr.h"
+#include "utils/builtins.h"
 #include "utils/catcache.h"
 #include "utils/combocid.h"
 #include "utils/guc.h"
@@ -199,6 +201,21 @@ static SubTransactionId currentSubTransactionId;
 static CommandId currentCommandId;
 static bool currentCommandIdUsed;
 
+/*
+ * In a parallel worker, the XIDs of the master's transaction and all of its
+ * live subtransactions, which we consider to be our own.  The array is kept
+ * sorted so that TransactionIdIsCurrentTransactionId can binary-search it.
+ */
+static TransactionId *ParallelCurrentXids;
+static int	nParallelCurrentXids = 0;
+
+/*
+ * In a parallel worker, the XID of the master's current subtransaction, if
+ * it had one.  Tuples written by a worker are stamped with this XID; the
+ * worker never gets an XID of its own.
+ */
+static TransactionId ParallelCurrentXid = InvalidTransactionId;
+
 /*
  * xactStartTimestamp is the value of transaction_timestamp().
  * stmtStartTimestamp is the value of statement_timestamp().
@@ -378,6 +395,13 @@ GetCurrentTransactionId(void)
 {
 	TransactionState s = CurrentTransactionState;
 
+	if (IsParallelWorker())
+	{
+		if (!TransactionIdIsValid(ParallelCurrentXid))
+			elog(ERROR, "cannot assign transaction IDs in a parallel worker");
+		return ParallelCurrentXid;
+	}
+
 	if (!TransactionIdIsValid(s->transactionId))
 		AssignTransactionId(s);
 	return s->transactionId;
@@ -393,6 +417,8 @@ GetCurrentTransactionId(void)
 TransactionId
 GetCurrentTransactionIdIfAny(void)
 {
+	if (IsParallelWorker())
+		return ParallelCurrentXid;
 	return CurrentTransactionState->transactionId;
 }
 
@@ -738,6 +764,34 @@ TransactionIdIsCurrentTransactionId(TransactionId xid)
 	if (!TransactionIdIsNormal(xid))
 		return false;
 
+	/*
+	 * In a parallel worker, the XIDs we must consider as current are stored
+	 * in ParallelCurrentXids rather than the transaction-state stack.
+	 */
+	if (nParallelCurrentXids > 0)
+	{
+		int			low,
+					high;
+
+		low = 0;
+		high = nParallelCurrentXids - 1;
+		while (low <= high)
+		{
+			int			middle;
+			TransactionId probe;
+
+			middle = low + (high - low) / 2;
+			probe = ParallelCurrentXids[middle];
+			if (TransactionIdEquals(probe, xid))
+				return true;
+			else if (TransactionIdPrecedes(probe, xid))
+				low = middle + 1;
+			else
+				high = middle - 1;
+		}
+		return false;
+	}
+
 	/*
 	 * We will return true for the Xid of the current subtransaction, any of
 	 * its subcommitted children, any of its parents, or any of their
@@ -778,6 +832,96 @@ TransactionIdIsCurrentTransactionId(TransactionId xid)
 	return false;
 }
 
+/*
+ *	EstimateTransactionStateSpace
+ *		Estimate the amount of space that will be needed by
+ *		SerializeTransactionState.
+ */
+Size
+EstimateTransactionStateSpace(void)
+{
+	TransactionState s;
+	Size		nxids = 3;		/* command ID, current XID and XID count */
+
+	for (s = CurrentTransactionState; s != NULL; s = s->parent)
+	{
+		if (s->state == TRANS_ABORT)
+			continue;
+		if (TransactionIdIsValid(s->transactionId))
+			nxids = add_size(nxids, 1);
+		nxids = add_size(nxids, s->nChildXids);
+	}
+
+	return mul_size(nxids, sizeof(TransactionId));
+}
+
+/*
+ *	SerializeTransactionState
+ *		Write out the state a parallel worker needs to act as part of the
+ *		current transaction: the current command ID, the current XID (if
+ *		any), then the number of XIDs the worker should consider as current,
+ *		then a sorted array of those XIDs.  maxsize must be at least the
+ *		value returned by EstimateTransactionStateSpace.
+ */
+void
+SerializeTransactionState(Size maxsize, char *start_address)
+{
+	TransactionState s;
+	TransactionId *result = (TransactionId *) start_address;
+	TransactionId *xids = &result[3];
+	int			nxids = 0;
+
+	Assert(maxsize >= EstimateTransactionStateSpace());
+
+	for (s = CurrentTransactionState; s != NULL; s = s->parent)
+	{
+		if (s->state == TRANS_ABORT)
+			continue;
+		if (TransactionIdIsValid(s->transactionId))
+			xids[nxids++] = s->transactionId;
+		memcpy(&xids[nxids], s->childXids,
+			   s->nChildXids * sizeof(TransactionId));
+		nxids += s->nChildXids;
+	}
+	qsort(xids, nxids, sizeof(TransactionId), xidComparator);
+
+	result[0] = (TransactionId) currentCommandId;
+	result[1] = CurrentTransactionState->transactionId;
+	result[2] = (TransactionId) nxids;
+}
+
+/*
+ *	RestoreTransactionState
+ *		In a parallel worker that has just started its transaction, adopt
+ *		the command ID and XIDs written by SerializeTransactionState.
+ *
+ * The worker never assigns an XID or command ID of its own.  This determines
+ * which tuples it considers to have been written by its own transaction and
+ * which of those it can see, and, if it's allowed to write, the XID and
+ * command ID it writes with.
+ */
+void
+RestoreTransactionState(char *tstatespace)
+{
+	TransactionId *tstate = (TransactionId *) tstatespace;
+	int			nxids = (int) tstate[2];
+
+	Assert(IsParallelWorker());
+	Assert(nParallelCurrentXids == 0);
+
+	currentCommandId = (CommandId) tstate[0];
+	ParallelCurrentXid = tstate[1];
+	if (nxids > 0)
+	{
+		ParallelCurrentXids = (TransactionId *)
+			MemoryContextAlloc(TopTransactionContext,
+							   nxids * sizeof(TransactionId));
+		memcpy(ParallelCurrentXids, &tstate[3],
+			   nxids * sizeof(TransactionId));
+		nParallelCurrentXids = nxids;
+	}
+}
+
 /*
  *	TransactionStartedDuringRecovery
  *
@@ -1420,7 +1564,11 @@ AtSubCommit_childXids(void)
 static TransactionId
 RecordTransactionAbort(bool isSubXact)
 {
-	TransactionId xid = GetCurrentTransactionIdIfAny();
+	/*
+	 * Not GetCurrentTransactionIdIfAny(), which in a parallel worker reports
+	 * the master's XID.  That's not ours to abort.
+	 */
+	TransactionId xid = CurrentTransactionState->transactionId;
 	TransactionId latestXid;
 	int			nrels;
 	RelFileNode *rels;
@@ -1889,6 +2037,9 @@ CommitTransaction(void)
 
 	CallXactCallbacks(XACT_EVENT_PRE_COMMIT);
 
+	/* Parallel workers must all be gone by now. */
+	AtEOXact_Parallel(true);
+
 	/*
 	 * The remaining actions cannot call any user-defined code, so it's safe
 	 * to start shutting down within-transaction services.	But note that most
@@ -2016,6 +2167,8 @@ CommitTransaction(void)
 	AtEOXact_SMgr();
 	AtEOXact_Files();
 	AtEOXact_ComboCid();
+	nParallelCurrentXids = 0;
+	ParallelCurrentXid = InvalidTransactionId;
 	AtEOXact_HashTables(true);
 	AtEOXact_PgStat(true);
 	AtEOXact_Snapshot(true);
@@ -2094,6 +2247,9 @@ PrepareTransaction(void)
 
 	CallXactCallbacks(XACT_EVENT_PRE_PREPARE);
 
+	/* Parallel workers must all be gone by now. */
+	AtEOXact_Parallel(true);
+
 	/*
 	 * The remaining actions cannot call any user-defined code, so it's safe
 	 * to start shutting down within-transaction services.	But note that most
@@ -2271,6 +2427,8 @@ PrepareTransaction(void)
 	AtEOXact_SMgr();
 	AtEOXact_Files();
 	AtEOXact_ComboCid();
+	nParallelCurrentXids = 0;
+	ParallelCurrentXid = InvalidTransactionId;
 	AtEOXact_HashTables(true);
 	/* don't call AtEOXact_PgStat here */
 	AtEOXact_Snapshot(true);
@@ -2380,6 +2538,7 @@ AbortTransaction(void)
 	/*
 	 * do abort processing
 	 */
+	AtEOXact_Parallel(false);
 	AfterTriggerEndXact(false); /* 'false' means it's abort */
 	AtAbort_Portals();
 	AtEOXact_LargeObject(false);
@@ -2433,6 +2592,8 @@ AbortTransaction(void)
 		AtEOXact_SMgr();
 		AtEOXact_Files();
 		AtEOXact_ComboCid();
+		nParallelCurrentXids = 0;
+		ParallelCurrentXid = InvalidTransactionId;
 		AtEOXact_HashTables(false);
 		AtEOXact_PgStat(false);
 		pgstat_report_xact_timestamp(0);
@@ -4181,6 +4342,7 @@ CommitSubTransaction(void)
 	/* Post-commit cleanup */
 	if (TransactionIdIsValid(s->transactionId))
 		AtSubCommit_childXids();
+	AtEOSubXact_Parallel(true, s->subTransactionId);
 	AfterTriggerEndSubXact(true);
 	AtSubCommit_Portals(s->subTransactionId,
 						s->parent->subTransactionId,
@@ -4322,6 +4484,7 @@ AbortSubTransaction(void)
 	 */
 	if (s->curTransactionOwner)
 	{
+		AtEOSubXact_Parallel(false, s->subTransactionId);
 		AfterTriggerEndSubXact(false);
 		AtSubAbort_Portals(s->subTransactionId,
 						   s->parent->subTransactionId,
@@ -108,6 +108,14 @@ static void index_update_stats(Relation rel,
 static void IndexCheckExclusion(Relation heapRelation,
 					Relation indexRelation,
 					IndexInfo *indexInfo);
+static double IndexBuildHeapScanInternal(Relation heapRelation,
+						   Relation indexRelation,
+						   IndexInfo *indexInfo,
+						   bool allow_sync,
+						   ParallelHeapScanDesc pscan,
+						   TransactionId OldestXmin,
+						   IndexBuildCallback callback,
+						   void *callback_state);
 static bool validate_index_callback(ItemPointer itemptr, void *opaque);
 static void validate_index_heapscan(Relation heapRelation,
 						Relation indexRelation,
@@ -2095,6 +2103,52 @@ IndexBuildHeapScan(Relation heapRelation,
 				   bool allow_sync,
 				   IndexBuildCallback callback,
 				   void *callback_state)
+{
+	return IndexBuildHeapScanInternal(heapRelation, indexRelation, indexInfo,
+									  allow_sync, NULL, InvalidTransactionId,
+									  callback, callback_state);
+}
+
+/*
+ * IndexBuildHeapScanParallel - scan part of the heap relation for tuples to
+ * be indexed, as one participant in a parallel index build
+ *
+ * This is like IndexBuildHeapScan, except that the blocks of the heap are
+ * shared out among all the participants through pscan, so each of them sees
+ * only some of the tuples.  All participants must pass the same OldestXmin,
+ * so that they agree about which tuples are dead.  Concurrent builds are not
+ * supported.
+ */
+double
+IndexBuildHeapScanParallel(Relation heapRelation,
+						   Relation indexRelation,
+						   IndexInfo *indexInfo,
+						   ParallelHeapScanDesc pscan,
+						   TransactionId OldestXmin,
+						   IndexBuildCallback callback,
+						   void *callback_state)
+{
+	Assert(!indexInfo->ii_Concurrent);
+	Assert(TransactionIdIsValid(OldestXmin));
+
+	return IndexBuildHeapScanInternal(heapRelation, indexRelation, indexInfo,
+									  false, pscan, OldestXmin,
+									  callback, callback_state);
+}
+
+/*
+ * Guts of IndexBuildHeapScan and IndexBuildHeapScanParallel.  OldestXmin is
+ * only used for a parallel scan; otherwise we work it out for ourselves.
+ */
+static double
+IndexBuildHeapScanInternal(Relation heapRelation,
+						   Relation indexRelation,
+						   IndexInfo *indexInfo,
+						   bool allow_sync,
+						   ParallelHeapScanDesc pscan,
+						   TransactionId OldestXmin,
+						   IndexBuildCallback callback,
+						   void *callback_state)
 {
 	bool		is_system_catalog;
 	bool		checking_uniqueness;
@@ -2108,7 +2162,6 @@ IndexBuildHeapScan(Relation heapRelation,
 	EState	   *estate;
 	ExprContext *econtext;
 	Snapshot	snapshot;
-	TransactionId OldestXmin;
 	BlockNumber root_blkno = InvalidBlockNumber;
 	OffsetNumber root_offsets[MaxHeapTuplesPerPage];
 
@@ -2156,15 +2209,20 @@ IndexBuildHeapScan(Relation heapRelation,
 	{
 		snapshot = SnapshotAny;
 		/* okay to ignore lazy VACUUMs here */
-		OldestXmin = GetOldestXmin(heapRelation->rd_rel->relisshared, true);
+		if (pscan == NULL)
+			OldestXmin = GetOldestXmin(heapRelation->rd_rel->relisshared,
+									   true);
 	}
 
-	scan = heap_beginscan_strat(heapRelation,	/* relation */
-								snapshot,		/* snapshot */
-								0,		/* number of keys */
-								NULL,	/* scan key */
-								true,	/* buffer access strategy OK */
-								allow_sync);	/* syncscan OK? */
+	if (pscan != NULL)
+		scan = heap_beginscan_parallel(heapRelation, snapshot, pscan);
+	else
+		scan = heap_beginscan_strat(heapRelation,	/* relation */
+									snapshot,	/* snapshot */
+									0,	/* number of keys */
+									NULL,		/* scan key */
+									true,		/* buffer access strategy OK */
+									allow_sync);		/* syncscan OK? */
 
 	reltuples = 0;
 
@@ -15,6 +15,7 @@
 #include "postgres.h"
 
 #include <ctype.h>
+#include <limits.h>
 #include <unistd.h>
 #include <sys/stat.h>
 #include <netinet/in.h>
@@ -22,6 +23,7 @@
 
 #include "access/heapam.h"
 #include "access/htup_details.h"
+#include "access/parallel.h"
 #include "access/sysattr.h"
 #include "access/xact.h"
 #include "catalog/namespace.h"
@@ -37,8 +39,11 @@
 #include "optimizer/clauses.h"
 #include "optimizer/planner.h"
 #include "parser/parse_relation.h"
+#include "pgstat.h"
 #include "rewrite/rewriteHandler.h"
 #include "storage/fd.h"
+#include "storage/shm_mq.h"
+#include "storage/spin.h"
 #include "tcop/tcopprot.h"
 #include "utils/acl.h"
 #include "utils/builtins.h"
@@ -128,6 +133,7 @@ typedef struct CopyStateData
 	bool		convert_selectively;	/* do selective binary conversion? */
 	List	   *convert_select; /* list of column names (can be NIL) */
 	bool	   *convert_select_flags;	/* per-column CSV/TEXT CS flags */
+	int			nworkers;		/* parallel workers to load with, or 0 */
 
 	/* these are just for error messages, see CopyFromErrorCallback */
 	const char *cur_relname;	/* table name for error messages */
@@ -159,6 +165,18 @@ typedef struct CopyStateData
 	ExprState **defexprs;		/* array of default att expressions */
 	bool		volatile_defexprs;		/* is any of defexprs volatile? */
 
+	/*
+	 * In a parallel COPY FROM worker, input lines come from the leader in
+	 * chunks through chunk_queue, rather than from the data source.
+	 * chunk_data is the chunk being processed, chunk_pos is the offset of
+	 * its next line, and chunk_lineno is that line's number.
+	 */
+	shm_mq_handle *chunk_queue;
+	char	   *chunk_data;
+	Size		chunk_len;
+	Size		chunk_pos;
+	int			chunk_lineno;
+
 	/*
 	 * These variables are used to reduce overhead in textual COPY FROM.
 	 *
@@ -198,6 +216,49 @@ typedef struct CopyStateData
 	int			raw_buf_len;	/* total # of bytes stored */
 } CopyStateData;
 
+/*
+ * In a parallel COPY FROM, the leader reads the input and splits it into
+ * lines, converting them to the server encoding as it goes, and sends the
+ * lines to the workers in chunks of up to PARALLEL_COPY_CHUNK_LINES lines or
+ * about PARALLEL_COPY_CHUNK_SIZE bytes.  The workers parse the lines and
+ * insert the tuples.  A chunk is the line number of its first line,
+ * followed by each line as an int32 length and that many bytes.
+ */
+#define PARALLEL_COPY_KEY_SHARED		UINT64CONST(1)
+#define PARALLEL_COPY_KEY_QUEUES		UINT64CONST(2)
+
+#define PARALLEL_COPY_QUEUE_SIZE		(RAW_BUF_SIZE * 4)
+#define PARALLEL_COPY_CHUNK_LINES		1000
+#define PARALLEL_COPY_CHUNK_SIZE		RAW_BUF_SIZE
+
+/*
+ * State shared by the leader and workers of a parallel COPY FROM.  The
+ * attnums array is followed by the per-column FORCE NOT NULL flags, and
+ * then by the NULL string.
+ */
+typedef struct CopyFromShared
+{
+	Oid			relid;			/* table being loaded */
+	bool		csv_mode;
+	bool		oids;
+	char		delim;
+	char		quote;
+	char		escape;
+	int			natts;			/* number of FORCE NOT NULL flags */
+	int			nattnums;		/* number of columns in the input */
+
+	/* mutex protects the count of tuples loaded */
+	slock_t		mutex;
+	uint64		processed;
+
+	int			attnums[FLEXIBLE_ARRAY_MEMBER];
+} CopyFromShared;
+
+#define CopyFromSharedForceNotNull(shared) \
+	((bool *) &(shared)->attnums[(shared)->nattnums])
+#define CopyFromSharedNullPrint(shared) \
+	((char *) (CopyFromSharedForceNotNull(shared) + (shared)->natts))
+
 /* DestReceiver for COPY (SELECT) TO */
 typedef struct
 {
@@ -289,6 +350,14 @@ static uint64 CopyTo(CopyState cstate);
 static void CopyOneRowTo(CopyState cstate, Oid tupleOid,
 			 Datum *values, bool *nulls);
 static uint64 CopyFrom(CopyState cstate);
+static void CopyFromInitState(CopyState cstate);
+static bool CopyFromParallelOK(CopyState cstate);
+static bool CopyFromParallel(CopyState cstate, uint64 *processed);
+static void CopySendChunk(ParallelContext *pcxt, shm_mq_handle *mqh,
+			  int worker, StringInfo chunk);
+static void CopyFromParallelMain(dsm_segment *seg, shm_toc *toc);
+static CopyState BeginCopyFromWorker(Relation rel, CopyFromShared *shared);
+static bool CopyGetChunkLine(CopyState cstate);
 static void CopyFromInsertBatch(CopyState cstate, EState *estate,
 					CommandId mycid, int hi_options,
 					ResultRelInfo *resultRelInfo, TupleTableSlot *myslot,
@@ -854,7 +923,9 @@ DoCopy(const CopyStmt *stmt, const char *queryString, uint64 *processed)
 
 		cstate = BeginCopyFrom(rel, stmt->filename, stmt->is_program,
 							   stmt->attlist, stmt->options);
-		*processed = CopyFrom(cstate);	/* copy from file to database */
+		/* copy from file to database, with parallel workers if possible */
+		if (!CopyFromParallel(cstate, processed))
+			*processed = CopyFrom(cstate);
 		EndCopyFrom(cstate);
 	}
 	else
@@ -900,6 +971,7 @@ ProcessCopyOptions(CopyState cstate,
 				   List *options)
 {
 	bool		format_specified = false;
+	bool		parallel_specified = false;
 	ListCell   *option;
 
 	/* Support external use for option sanity checking */
@@ -1039,6 +1111,20 @@ ProcessCopyOptions(CopyState cstate,
 						 errmsg("argument to option \"%s\" must be a list of column names",
 								defel->defname)));
 		}
+		else if (strcmp(defel->defname, "parallel") == 0)
+		{
+			if (parallel_specified)
+				ereport(ERROR,
+						(errcode(ERRCODE_SYNTAX_ERROR),
+						 errmsg("conflicting or redundant options")));
+			parallel_specified = true;
+			cstate->nworkers = defGetInt32(defel);
+			if (cstate->nworkers < 0)
+				ereport(ERROR,
+						(errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+						 errmsg("argument to option \"%s\" must be a non-negative integer",
+								defel->defname)));
+		}
 		else if (strcmp(defel->defname, "encoding") == 0)
 		{
 			if (cstate->file_encoding >= 0)
@@ -1073,6 +1159,11 @@ ProcessCopyOptions(CopyState cstate,
 				(errcode(ERRCODE_SYNTAX_ERROR),
 				 errmsg("cannot specify NULL in BINARY mode")));
 
+	if (cstate->binary && cstate->nworkers > 0)
+		ereport(ERROR,
+				(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+				 errmsg("cannot specify PARALLEL in BINARY mode")));
+
 	/* Set defaults for omitted options */
 	if (!cstate->delim)
 		cstate->delim = cstate->csv_mode ? "," : "\t";
@@ -1178,6 +1269,12 @@ ProcessCopyOptions(CopyState cstate,
 				(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
 			  errmsg("COPY force not null only available using COPY FROM")));
 
+	/* Check parallel */
+	if (cstate->nworkers > 0 && !is_from)
+		ereport(ERROR,
+				(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+				 errmsg("COPY PARALLEL only available using COPY FROM")));
+
 	/* Don't allow the delimiter to appear in the null string. */
 	if (strchr(cstate->null_print, cstate->delim[0]) != NULL)
 		ereport(ERROR,
@@ -2162,6 +2259,12 @@ CopyFrom(CopyState cstate)
 	{
 		useHeapMultiInsert = true;
 		bufferedTuples = palloc(MAX_BUFFERED_TUPLES * sizeof(HeapTuple));
+
+		/*
+		 * Likewise, collect the entries for indexes that can take them in
+		 * batches, and insert them after each batch of heap tuples.
+		 */
+		ExecSetupIndexBatches(resultRelInfo, MAX_BUFFERED_TUPLES);
 	}
 
 	/* Prepare to catch AFTER triggers. */
@@ -2252,6 +2355,23 @@ CopyFrom(CopyState cstate)
 
 			if (useHeapMultiInsert)
 			{
+				/*
+				 * CopyFromInsertBatch assumes that the buffered tuples come
+				 * from consecutive lines, when reporting errors.  In a
+				 * parallel worker they might not, so flush the buffer at
+				 * any gap.
+				 */
+				if (nBufferedTuples > 0 &&
+					cstate->cur_lineno != firstBufferedLineNo + nBufferedTuples)
+				{
+					CopyFromInsertBatch(cstate, estate, mycid, hi_options,
+										resultRelInfo, myslot, bistate,
+										nBufferedTuples, bufferedTuples,
+										firstBufferedLineNo);
+					nBufferedTuples = 0;
+					bufferedTuplesSize = 0;
+				}
+
 				/* Add this tuple to the tuple buffer */
 				if (nBufferedTuples == 0)
 					firstBufferedLineNo = cstate->cur_lineno;
@@ -2397,6 +2517,15 @@ CopyFromInsertBatch(CopyState cstate, EState *estate, CommandId mycid,
 								 recheckIndexes);
 			list_free(recheckIndexes);
 		}
+
+		/*
+		 * Now insert the entries collected for the indexes that take them
+		 * in batches.  An error here can't be pinned on any one line.
+		 */
+		cstate->cur_lineno = firstBufferedLineNo;
+		oldcontext = MemoryContextSwitchTo(GetPerTupleMemoryContext(estate));
+		ExecFlushIndexBatches(resultRelInfo);
+		MemoryContextSwitchTo(oldcontext);
 	}
 
 	/*
@@ -2438,6 +2567,115 @@ BeginCopyFrom(Relation rel,
 {
 	CopyState	cstate;
 	bool		pipe = (filename == NULL);
+	Oid			in_func_oid;
+	MemoryContext oldcontext;
+
+	cstate = BeginCopy(true, rel, NULL, NULL, attnamelist, options);
+	oldcontext = MemoryContextSwitchTo(cstate->copycontext);
+
+	CopyFromInitState(cstate);
+	cstate->is_program = is_program;
+
+	if (pipe)
+	{
+		Assert(!is_program);	/* the grammar does not allow this */
+		if (whereToSendOutput == DestRemote)
+			ReceiveCopyBegin(cstate);
+		else
+			cstate->copy_file = stdin;
+	}
+	else
+	{
+		cstate->filename = pstrdup(filename);
+
+		if (cstate->is_program)
+		{
+			cstate->copy_file = OpenPipeStream(cstate->filename, PG_BINARY_R);
+			if (cstate->copy_file == NULL)
+				ereport(ERROR,
+						(errmsg("could not execute command \"%s\": %m",
+								cstate->filename)));
+		}
+		else
+		{
+			struct stat st;
+
+			cstate->copy_file = AllocateFile(cstate->filename, PG_BINARY_R);
+			if (cstate->copy_file == NULL)
+				ereport(ERROR,
+						(errcode_for_file_access(),
+						 errmsg("could not open file \"%s\" for reading: %m",
+								cstate->filename)));
+
+			fstat(fileno(cstate->copy_file), &st);
+			if (S_ISDIR(st.st_mode))
+				ereport(ERROR,
+						(errcode(ERRCODE_WRONG_OBJECT_TYPE),
+						 errmsg("\"%s\" is a directory", cstate->filename)));
+		}
+	}
+
+	if (cstate->binary)
+	{
+		/* Read and verify binary header */
+		char		readSig[11];
+		int32		tmp;
+
+		/* Signature */
+		if (CopyGetData(cstate, readSig, 11, 11) != 11 ||
+			memcmp(readSig, BinarySignature, 11) != 0)
+			ereport(ERROR,
+					(errcode(ERRCODE_BAD_COPY_FILE_FORMAT),
+					 errmsg("COPY file signature not recognized")));
+		/* Flags field */
+		if (!CopyGetInt32(cstate, &tmp))
+			ereport(ERROR,
+					(errcode(ERRCODE_BAD_COPY_FILE_FORMAT),
+					 errmsg("invalid COPY file header (missing flags)")));
+		cstate->file_has_oids = (tmp & (1 << 16)) != 0;
+		tmp &= ~(1 << 16);
+		if ((tmp >> 16) != 0)
+			ereport(ERROR,
+					(errcode(ERRCODE_BAD_COPY_FILE_FORMAT),
+				 errmsg("unrecognized critical flags in COPY file header")));
+		/* Header extension length */
+		if (!CopyGetInt32(cstate, &tmp) ||
+			tmp < 0)
+			ereport(ERROR,
+					(errcode(ERRCODE_BAD_COPY_FILE_FORMAT),
+					 errmsg("invalid COPY file header (missing length)")));
+		/* Skip extension header, if present */
+		while (tmp-- > 0)
+		{
+			if (CopyGetData(cstate, readSig, 1, 1) != 1)
+				ereport(ERROR,
+						(errcode(ERRCODE_BAD_COPY_FILE_FORMAT),
+						 errmsg("invalid COPY file header (wrong length)")));
+		}
+	}
+
+	if (cstate->file_has_oids && cstate->binary)
+	{
+		getTypeBinaryInputInfo(OIDOID,
+							   &in_func_oid, &cstate->oid_typioparam);
+		fmgr_info(in_func_oid, &cstate->oid_in_function);
+	}
+
+	MemoryContextSwitchTo(oldcontext);
+
+	return cstate;
+}
+
+/*
+ * Set up the parts of a CopyState for COPY FROM that don't depend on the
+ * data source: the per-attribute input functions and defaults, and the
+ * workspace for parsing text input.  Used by BeginCopyFrom, and by parallel
+ * workers, which get their input from the leader.  The caller must have
+ * switched into the copy context.
+ */
+static void
+CopyFromInitState(CopyState cstate)
+{
 	TupleDesc	tupDesc;
 	Form_pg_attribute *attr;
 	AttrNumber	num_phys_attrs,
@@ -2448,12 +2686,8 @@ BeginCopyFrom(Relation rel,
 	Oid			in_func_oid;
 	int		   *defmap;
 	ExprState **defexprs;
-	MemoryContext oldcontext;
 	bool		volatile_defexprs;
 
-	cstate = BeginCopy(true, rel, NULL, NULL, attnamelist, options);
-	oldcontext = MemoryContextSwitchTo(cstate->copycontext);
-
 	/* Initialize state variables */
 	cstate->fe_eof = false;
 	cstate->eol_type = EOL_UNKNOWN;
@@ -2544,111 +2778,20 @@ BeginCopyFrom(Relation rel,
 	cstate->defexprs = defexprs;
 	cstate->volatile_defexprs = volatile_defexprs;
 	cstate->num_defaults = num_defaults;
-	cstate->is_program = is_program;
-
-	if (pipe)
-	{
-		Assert(!is_program);	/* the grammar does not allow this */
-		if (whereToSendOutput == DestRemote)
-			ReceiveCopyBegin(cstate);
-		else
-			cstate->copy_file = stdin;
-	}
-	else
-	{
-		cstate->filename = pstrdup(filename);
-
-		if (cstate->is_program)
-		{
-			cstate->copy_file = OpenPipeStream(cstate->filename, PG_BINARY_R);
-			if (cstate->copy_file == NULL)
-				ereport(ERROR,
-						(errmsg("could not execute command \"%s\": %m",
-								cstate->filename)));
-		}
-		else
-		{
-			struct stat st;
-
-			cstate->copy_file = AllocateFile(cstate->filename, PG_BINARY_R);
-			if (cstate->copy_file == NULL)
-				ereport(ERROR,
-						(errcode_for_file_access(),
-						 errmsg("could not open file \"%s\" for reading: %m",
-								cstate->filename)));
-
-			fstat(fileno(cstate->copy_file), &st);
-			if (S_ISDIR(st.st_mode))
-				ereport(ERROR,
-						(errcode(ERRCODE_WRONG_OBJECT_TYPE),
-						 errmsg("\"%s\" is a directory", cstate->filename)));
-		}
-	}
-
-	if (!cstate->binary)
-	{
-		/* must rely on user to tell us... */
-		cstate->file_has_oids = cstate->oids;
-	}
-	else
-	{
-		/* Read and verify binary header */
-		char		readSig[11];
-		int32		tmp;
-
-		/* Signature */
-		if (CopyGetData(cstate, readSig, 11, 11) != 11 ||
-			memcmp(readSig, BinarySignature, 11) != 0)
-			ereport(ERROR,
-					(errcode(ERRCODE_BAD_COPY_FILE_FORMAT),
-					 errmsg("COPY file signature not recognized")));
-		/* Flags field */
-		if (!CopyGetInt32(cstate, &tmp))
-			ereport(ERROR,
-					(errcode(ERRCODE_BAD_COPY_FILE_FORMAT),
-					 errmsg("invalid COPY file header (missing flags)")));
-		cstate->file_has_oids = (tmp & (1 << 16)) != 0;
-		tmp &= ~(1 << 16);
-		if ((tmp >> 16) != 0)
-			ereport(ERROR,
-					(errcode(ERRCODE_BAD_COPY_FILE_FORMAT),
-				 errmsg("unrecognized critical flags in COPY file header")));
-		/* Header extension length */
-		if (!CopyGetInt32(cstate, &tmp) ||
-			tmp < 0)
-			ereport(ERROR,
-					(errcode(ERRCODE_BAD_COPY_FILE_FORMAT),
-					 errmsg("invalid COPY file header (missing length)")));
-		/* Skip extension header, if present */
-		while (tmp-- > 0)
-		{
-			if (CopyGetData(cstate, readSig, 1, 1) != 1)
-				ereport(ERROR,
-						(errcode(ERRCODE_BAD_COPY_FILE_FORMAT),
-						 errmsg("invalid COPY file header (wrong length)")));
-		}
-	}
-
-	if (cstate->file_has_oids && cstate->binary)
-	{
-		getTypeBinaryInputInfo(OIDOID,
-							   &in_func_oid, &cstate->oid_typioparam);
-		fmgr_info(in_func_oid, &cstate->oid_in_function);
-	}
 
 	/* create workspace for CopyReadAttributes results */
 	if (!cstate->binary)
 	{
 		AttrNumber	attr_count = list_length(cstate->attnumlist);
-		int			nfields = cstate->file_has_oids ? (attr_count + 1) : attr_count;
+		int			nfields;
+
+		/* must rely on user to tell us... */
+		cstate->file_has_oids = cstate->oids;
 
+		nfields = cstate->file_has_oids ? (attr_count + 1) : attr_count;
 		cstate->max_fields = nfields;
 		cstate->raw_fields = (char **) palloc(nfields * sizeof(char *));
 	}
-
-	MemoryContextSwitchTo(oldcontext);
-
-	return cstate;
 }
 
 /*
@@ -2671,26 +2814,35 @@ NextCopyFromRawFields(CopyState cstate, char ***fields, int *nfields)
 	/* only available for text or csv input */
 	Assert(!cstate->binary);
 
-	/* on input just throw the header line away */
-	if (cstate->cur_lineno == 0 && cstate->header_line)
+	if (cstate->chunk_queue != NULL)
 	{
-		cstate->cur_lineno++;
-		if (CopyReadLine(cstate))
-			return false;		/* done */
+		/* In a parallel worker, the leader has read the line for us */
+		if (!CopyGetChunkLine(cstate))
+			return false;
 	}
+	else
+	{
+		/* on input just throw the header line away */
+		if (cstate->cur_lineno == 0 && cstate->header_line)
+		{
+			cstate->cur_lineno++;
+			if (CopyReadLine(cstate))
+				return false;	/* done */
+		}
 
-	cstate->cur_lineno++;
+		cstate->cur_lineno++;
 
-	/* Actually read the line into memory here */
-	done = CopyReadLine(cstate);
+		/* Actually read the line into memory here */
+		done = CopyReadLine(cstate);
 
-	/*
-	 * EOF at start of line means we're done.  If we see EOF after some
-	 * characters, we act as though it was newline followed by EOF, ie,
-	 * process the line and then exit loop on next iteration.
-	 */
-	if (done && cstate->line_buf.len == 0)
-		return false;
+		/*
+		 * EOF at start of line means we're done.  If we see EOF after some
+		 * characters, we act as though it was newline followed by EOF, ie,
+		 * process the line and then exit loop on next iteration.
+		 */
+		if (done && cstate->line_buf.len == 0)
+			return false;
+	}
 
 	/* Parse the line into de-escaped field values */
 	if (cstate->csv_mode)
@@ -2946,6 +3098,457 @@ EndCopyFrom(CopyState cstate)
 	EndCopy(cstate);
 }
 
+/*
+ * Can this COPY FROM be done by parallel workers?
+ *
+ * Workers can't fire triggers, and don't see our temporary tables, our
+ * predicate locks, or the relcache state that lets us skip WAL for a table
+ * created or truncated in this transaction, so any of those mean loading
+ * serially.  Default expressions and constraints are evaluated in the
+ * workers, so they must be parallel-safe; domain types are ruled out
+ * altogether, since their input functions check the domain's constraints.
+ *
+ * Unique indexes and exclusion constraints are ruled out too.  A worker
+ * inserting a key that conflicts with one another transaction has inserted
+ * but not committed waits for that transaction, which in turn may be
+ * waiting for a lock we hold.  The deadlock detector doesn't know that the
+ * worker acts for us, so it would never notice.
+ */
+static bool
+CopyFromParallelOK(CopyState cstate)
+{
+	Relation	rel = cstate->rel;
+	TupleDesc	tupDesc = RelationGetDescr(rel);
+	List	   *indexoidlist;
+	ListCell   *lc;
+	bool		result = true;
+	int			i;
+
+	if (IsParallelWorker() || IsolationIsSerializable())
+		return false;
+
+	if (rel->rd_rel->relkind != RELKIND_RELATION ||
+		rel->rd_rel->relpersistence == RELPERSISTENCE_TEMP ||
+		rel->trigdesc != NULL)
+		return false;
+
+	if (cstate->freeze ||
+		rel->rd_createSubid != InvalidSubTransactionId ||
+		rel->rd_newRelfilenodeSubid != InvalidSubTransactionId)
+		return false;
+
+	for (i = 0; i < cstate->num_defaults; i++)
+	{
+		if (has_parallel_hazard((Node *) cstate->defexprs[i]->expr))
+			return false;
+	}
+
+	for (i = 0; i < tupDesc->natts; i++)
+	{
+		if (tupDesc->attrs[i]->attisdropped)
+			continue;
+		if (get_typtype(tupDesc->attrs[i]->atttypid) == TYPTYPE_DOMAIN)
+			return false;
+	}
+
+	if (tupDesc->constr != NULL)
+	{
+		for (i = 0; i < tupDesc->constr->num_check; i++)
+		{
+			Node	   *check = stringToNode(tupDesc->constr->check[i].ccbin);
+
+			if (has_parallel_hazard(check))
+				return false;
+		}
+	}
+
+	indexoidlist = RelationGetIndexList(rel);
+	foreach(lc, indexoidlist)
+	{
+		Relation	index = index_open(lfirst_oid(lc), AccessShareLock);
+
+		if (index->rd_index->indisunique || index->rd_index->indisexclusion)
+			result = false;
+		index_close(index, AccessShareLock);
+		if (!result)
+			break;
+	}
+	list_free(indexoidlist);
+
+	return result;
+}
+
+/*
+ * Load the data with parallel workers, if the PARALLEL option asked for them
+ * and we can get some.  Returns false, without having read any input, if the
+ * load must be done by CopyFrom instead; otherwise returns true and sets
+ * *processed to the number of tuples loaded.
+ *
+ * Each worker inserts the tuples from the chunks it's given, so the tuples
+ * are not stored in input order.
+ */
+static bool
+CopyFromParallel(CopyState cstate, uint64 *processed)
+{
+	ParallelContext *pcxt;
+	CopyFromShared *shared;
+	volatile CopyFromShared *vshared;
+	Size		sharedsize;
+	char	   *mqspace;
+	shm_mq_handle **queues;
+	int		   *workers;
+	int			nqueues = 0;
+	int			nworkers;
+	StringInfoData chunk;
+	int			nlines = 0;
+	int			next = 0;
+	ErrorContextCallback errcallback;
+	ListCell   *lc;
+	uint64		remaining;
+	int			n;
+	int			i;
+
+	if (cstate->nworkers == 0 || !CopyFromParallelOK(cstate))
+		return false;
+
+	/* There's no point asking for more workers than could ever run. */
+	nworkers = Min(cstate->nworkers, max_worker_processes);
+
+	/* The workers insert with our command ID. */
+	(void) GetCurrentCommandId(true);
+
+	/* Size and create the dynamic shared memory segment. */
+	sharedsize = add_size(offsetof(CopyFromShared, attnums),
+						  list_length(cstate->attnumlist) * sizeof(int));
+	sharedsize = add_size(sharedsize,
+						  RelationGetDescr(cstate->rel)->natts * sizeof(bool));
+	sharedsize = add_size(sharedsize, cstate->null_print_len + 1);
+
+	pcxt = CreateParallelContext(CopyFromParallelMain, nworkers);
+	pcxt->allow_writes = true;
+	shm_toc_estimate_chunk(&pcxt->estimator, sharedsize);
+	shm_toc_estimate_chunk(&pcxt->estimator,
+						   mul_size(PARALLEL_COPY_QUEUE_SIZE, nworkers));
+	shm_toc_estimate_keys(&pcxt->estimator, 2);
+	InitializeParallelDSM(pcxt);
+
+	shared = shm_toc_allocate(pcxt->toc, sharedsize);
+	shared->relid = RelationGetRelid(cstate->rel);
+	shared->csv_mode = cstate->csv_mode;
+	shared->oids = cstate->oids;
+	shared->delim = cstate->delim[0];
+	shared->quote = cstate->csv_mode ? cstate->quote[0] : '\0';
+	shared->escape = cstate->csv_mode ? cstate->escape[0] : '\0';
+	shared->natts = RelationGetDescr(cstate->rel)->natts;
+	shared->nattnums = list_length(cstate->attnumlist);
+	SpinLockInit(&shared->mutex);
+	shared->processed = 0;
+	i = 0;
+	foreach(lc, cstate->attnumlist)
+		shared->attnums[i++] = lfirst_int(lc);
+	memcpy(CopyFromSharedForceNotNull(shared), cstate->force_notnull_flags,
+		   shared->natts * sizeof(bool));
+	strcpy(CopyFromSharedNullPrint(shared), cstate->null_print);
+	shm_toc_insert(pcxt->toc, PARALLEL_COPY_KEY_SHARED, shared);
+
+	mqspace = shm_toc_allocate(pcxt->toc,
+							   mul_size(PARALLEL_COPY_QUEUE_SIZE, nworkers));
+	for (i = 0; i < nworkers; ++i)
+	{
+		shm_mq	   *mq;
+
+		mq = shm_mq_create(mqspace + i * PARALLEL_COPY_QUEUE_SIZE,
+						   PARALLEL_COPY_QUEUE_SIZE);
+		shm_mq_set_sender(mq, MyProc);
+	}
+	shm_toc_insert(pcxt->toc, PARALLEL_COPY_KEY_QUEUES, mqspace);
+
+	LaunchParallelWorkers(pcxt);
+
+	/*
+	 * Wait for the workers we got to attach to their queues.  A worker that
+	 * never starts takes no data, so we can just do without it; but once
+	 * attached, a worker that goes away before we're done must have failed.
+	 */
+	queues = (shm_mq_handle **)
+		palloc(sizeof(shm_mq_handle *) * Max(pcxt->nworkers_launched, 1));
+	workers = (int *) palloc(sizeof(int) * Max(pcxt->nworkers_launched, 1));
+	for (i = 0; i < pcxt->nworkers_launched; ++i)
+	{
+		shm_mq_handle *mqh;
+
+		mqh = shm_mq_attach((shm_mq *) (mqspace + i * PARALLEL_COPY_QUEUE_SIZE),
+							pcxt->seg, pcxt->worker[i].bgwhandle);
+		if (shm_mq_wait_for_attach(mqh) == SHM_MQ_SUCCESS)
+		{
+			queues[nqueues] = mqh;
+			workers[nqueues] = i;
+			nqueues++;
+		}
+		else
+			CheckParallelWorkerExit(pcxt, i);
+	}
+
+	if (nqueues == 0)
+	{
+		/* No workers after all, so the caller must do the work. */
+		WaitForParallelWorkersToExit(pcxt);
+		DestroyParallelContext(pcxt);
+		pfree(queues);
+		pfree(workers);
+		return false;
+	}
+
+	/*
+	 * Read the input a line at a time, and deal the lines out to the workers
+	 * in chunks.  The error context callback applies only while we're
+	 * reading; an error reported by a worker has its own context.
+	 */
+	errcallback.callback = CopyFromErrorCallback;
+	errcallback.arg = (void *) cstate;
+	errcallback.previous = error_context_stack;
+
+	initStringInfo(&chunk);
+	for (;;)
+	{
+		bool		done;
+		int32		len;
+
+		CHECK_FOR_INTERRUPTS();
+
+		error_context_stack = &errcallback;
+
+		/* on input just throw the header line away */
+		if (cstate->cur_lineno == 0 && cstate->header_line)
+		{
+			cstate->cur_lineno++;
+			if (CopyReadLine(cstate))
+			{
+				error_context_stack = errcallback.previous;
+				break;
+			}
+		}
+
+		cstate->cur_lineno++;
+		done = CopyReadLine(cstate);
+
+		error_context_stack = errcallback.previous;
+
+		/* As in NextCopyFromRawFields, EOF at start of line means we're done */
+		if (done && cstate->line_buf.len == 0)
+			break;
+
+		if (nlines == 0)
+			appendBinaryStringInfo(&chunk, (char *) &cstate->cur_lineno,
+								   sizeof(int));
+		len = cstate->line_buf.len;
+		appendBinaryStringInfo(&chunk, (char *) &len, sizeof(int32));
+		appendBinaryStringInfo(&chunk, cstate->line_buf.data, len);
+		nlines++;
+
+		if (nlines >= PARALLEL_COPY_CHUNK_LINES ||
+			chunk.len >= PARALLEL_COPY_CHUNK_SIZE)
+		{
+			CopySendChunk(pcxt, queues[next], workers[next], &chunk);
+			next = (next + 1) % nqueues;
+			resetStringInfo(&chunk);
+			nlines = 0;
+		}
+
+		if (done)
+			break;
+	}
+	if (nlines > 0)
+		CopySendChunk(pcxt, queues[next], workers[next], &chunk);
+	pfree(chunk.data);
+
+	/*
+	 * Detaching from the queues tells the workers there's no more data.  Once
+	 * they've all exited, make sure they all succeeded.
+	 */
+	for (i = 0; i < nqueues; ++i)
+		shm_mq_detach((shm_mq *) (mqspace +
+								  workers[i] * PARALLEL_COPY_QUEUE_SIZE));
+	WaitForParallelWorkersToExit(pcxt);
+	for (i = 0; i < nqueues; ++i)
+		CheckParallelWorkerExit(pcxt, workers[i]);
+
+	/* use volatile pointer to prevent code rearrangement */
+	vshared = shared;
+	SpinLockAcquire(&vshared->mutex);
+	*processed = vshared->processed;
+	SpinLockRelease(&vshared->mutex);
+
+	/*
+	 * The workers leave their inserts out of the table statistics, since
+	 * whether they stick depends on our transaction; count them here.
+	 */
+	for (remaining = *processed; remaining > 0; remaining -= n)
+	{
+		n = (int) Min(remaining, (uint64) INT_MAX);
+		pgstat_count_heap_insert(cstate->rel, n);
+	}
+
+	DestroyParallelContext(pcxt);
+	pfree(queues);
+	pfree(workers);
+
+	return true;
+}
+
+/*
+ * Send a chunk of lines to a parallel COPY FROM worker.
+ */
+static void
+CopySendChunk(ParallelContext *pcxt, shm_mq_handle *mqh, int worker,
+			  StringInfo chunk)
+{
+	if (shm_mq_send(mqh, chunk->len, chunk->data, false) == SHM_MQ_DETACHED)
+	{
+		/* The worker is gone; find out why. */
+		CheckParallelWorkerExit(pcxt, worker);
+		elog(ERROR, "parallel worker stopped accepting COPY data");
+	}
+}
+
+/*
+ * Main entrypoint for a parallel COPY FROM worker.
+ *
+ * We parse and insert the lines in each chunk the leader sends us, until the
+ * leader detaches from our queue, and then add the number of tuples we
+ * loaded to the shared count.
+ */
+static void
+CopyFromParallelMain(dsm_segment *seg, shm_toc *toc)
+{
+	CopyFromShared *shared;
+	volatile CopyFromShared *vshared;
+	char	   *mqspace;
+	shm_mq	   *mq;
+	Relation	rel;
+	CopyState	cstate;
+	uint64		processed;
+
+	shared = shm_toc_lookup(toc, PARALLEL_COPY_KEY_SHARED);
+	mqspace = shm_toc_lookup(toc, PARALLEL_COPY_KEY_QUEUES);
+	Assert(shared != NULL && mqspace != NULL);
+
+	/*
+	 * The leader holds RowExclusiveLock on the table until after we exit, so
+	 * we needn't lock it ourselves.
+	 */
+	rel = heap_open(shared->relid, NoLock);
+	cstate = BeginCopyFromWorker(rel, shared);
+
+	/* Attach to our queue. */
+	mq = (shm_mq *) (mqspace +
+					 ParallelWorkerNumber * PARALLEL_COPY_QUEUE_SIZE);
+	shm_mq_set_receiver(mq, MyProc);
+	cstate->chunk_queue = shm_mq_attach(mq, seg, NULL);
+
+	processed = CopyFrom(cstate);
+
+	EndCopyFrom(cstate);
+	heap_close(rel, NoLock);
+
+	vshared = shared;
+	SpinLockAcquire(&vshared->mutex);
+	vshared->processed += processed;
+	SpinLockRelease(&vshared->mutex);
+}
+
+/*
+ * Set up a CopyState for a parallel COPY FROM worker, using the options the
+ * leader put in shared memory.  The leader has already converted the input
+ * to the server encoding, so there's no transcoding to do here.
+ */
+static CopyState
+BeginCopyFromWorker(Relation rel, CopyFromShared *shared)
+{
+	CopyState	cstate;
+	MemoryContext oldcontext;
+	int			i;
+
+	cstate = (CopyStateData *) palloc0(sizeof(CopyStateData));
+	cstate->copycontext = AllocSetContextCreate(CurrentMemoryContext,
+												"COPY",
+												ALLOCSET_DEFAULT_MINSIZE,
+												ALLOCSET_DEFAULT_INITSIZE,
+												ALLOCSET_DEFAULT_MAXSIZE);
+
+	oldcontext = MemoryContextSwitchTo(cstate->copycontext);
+
+	cstate->rel = rel;
+	cstate->csv_mode = shared->csv_mode;
+	cstate->oids = shared->oids;
+	cstate->delim = pnstrdup(&shared->delim, 1);
+	if (cstate->csv_mode)
+	{
+		cstate->quote = pnstrdup(&shared->quote, 1);
+		cstate->escape = pnstrdup(&shared->escape, 1);
+	}
+	cstate->null_print = pstrdup(CopyFromSharedNullPrint(shared));
+	cstate->null_print_len = strlen(cstate->null_print);
+
+	for (i = 0; i < shared->nattnums; i++)
+		cstate->attnumlist = lappend_int(cstate->attnumlist,
+										 shared->attnums[i]);
+	cstate->force_notnull_flags = (bool *) palloc(shared->natts * sizeof(bool));
+	memcpy(cstate->force_notnull_flags, CopyFromSharedForceNotNull(shared),
+		   shared->natts * sizeof(bool));
+
+	cstate->file_encoding = GetDatabaseEncoding();
+	cstate->need_transcoding = false;
+	cstate->copy_dest = COPY_FILE;
+
+	CopyFromInitState(cstate);
+
+	MemoryContextSwitchTo(oldcontext);
+
+	return cstate;
+}
+
+/*
+ * In a parallel COPY FROM worker, put the next line the leader sent us into
+ * line_buf, and set cur_lineno to its line number.  Returns false once the
+ * leader has detached, meaning there are no more lines.
+ */
+static bool
+CopyGetChunkLine(CopyState cstate)
+{
+	int32		len;
+
+	while (cstate->chunk_pos >= cstate->chunk_len)
+	{
+		shm_mq_result result;
+		Size		nbytes;
+		void	   *data;
+
+		result = shm_mq_receive(cstate->chunk_queue, &nbytes, &data, false);
+		if (result == SHM_MQ_DETACHED)
+			return false;
+		Assert(result == SHM_MQ_SUCCESS);
+
+		cstate->chunk_data = (char *) data;
+		cstate->chunk_len = nbytes;
+		memcpy(&cstate->chunk_lineno, cstate->chunk_data, sizeof(int));
+		cstate->chunk_pos = sizeof(int);
+	}
+
+	memcpy(&len, cstate->chunk_data + cstate->chunk_pos, sizeof(int32));
+	cstate->chunk_pos += sizeof(int32);
+
+	resetStringInfo(&cstate->line_buf);
+	appendBinaryStringInfo(&cstate->line_buf,
+						   cstate->chunk_data + cstate->chunk_pos, len);
+	cstate->chunk_pos += len;
+	cstate->line_buf_valid = true;
+	cstate->line_buf_converted = true;
+	cstate->cur_lineno = cstate->chunk_lineno++;
+
+	return true;
+}
+
 /*
  * Read the next input line and stash it in line_buf, with conversion to
  * server encoding.
@@ -52,7 +52,7 @@ static void report_triggers(ResultRelInfo *rInfo, bool show_relname,
 				ExplainState *es);
 static double elapsed_time(instr_time *starttime);
 static void ExplainPreScanNode(PlanState *planstate, Bitmapset **rels_used);
-static void ExplainPreScanMemberNodes(List *plans, PlanState **planstates,
+static void ExplainPreScanMemberNodes(PlanState **planstates, int nplans,
 						  Bitmapset **rels_used);
 static void ExplainPreScanSubPlans(List *plans, Bitmapset **rels_used);
 static void ExplainNode(PlanState *planstate, List *ancestors,
@@ -78,17 +78,33 @@ static void show_merge_append_keys(MergeAppendState *mstate, List *ancestors,
 					   ExplainState *es);
 static void show_agg_keys(AggState *astate, List *ancestors,
 			  ExplainState *es);
+static void show_grouping_sets(PlanState *planstate, Agg *agg,
+				   List *ancestors, ExplainState *es);
+static void show_grouping_set_keys(PlanState *planstate, Agg *aggnode,
+					   Sort *sortnode, List *context, bool useprefix,
+					   List *ancestors, ExplainState *es);
 static void show_group_keys(GroupState *gstate, List *ancestors,
 				ExplainState *es);
 static void show_sort_group_keys(PlanState *planstate, const char *qlabel,
 					 int nkeys, AttrNumber *keycols,
 					 List *ancestors, ExplainState *es);
 static void show_sort_info(SortState *sortstate, ExplainState *es);
+static void show_incremental_sort_keys(IncrementalSortState *incrsortstate,
+						   List *ancestors, ExplainState *es);
+static void show_incremental_sort_info(IncrementalSortState *incrsortstate,
+						   ExplainState *es);
+static void show_resultcache_info(ResultCacheState *rcstate, List *ancestors,
+					  ExplainState *es);
 static void show_hash_info(HashState *hashstate, ExplainState *es);
+static void show_nestloop_batch_info(NestLoopState *nlstate, List *ancestors,
+						 ExplainState *es);
+static void show_hashagg_info(AggState *aggstate, ExplainState *es);
+static void show_agg_batch_info(AggState *aggstate, ExplainState *es);
 static void show_tidbitmap_info(BitmapHeapScanState *planstate,
 								ExplainState *es);
 static void show_instrumentation_count(const char *qlabel, int which,
 						   PlanState *planstate, ExplainState *es);
+static void show_hashfilter_info(ScanState *scanstate, ExplainState *es);
 static void show_foreignscan_info(ForeignScanState *fsstate, ExplainState *es);
 static const char *explain_get_index_name(Oid indexId);
 static void ExplainIndexScanDetails(Oid indexid, ScanDirection indexorderdir,
@@ -97,7 +113,7 @@ static void ExplainScanTarget(Scan *plan, ExplainState *es);
 static void ExplainModifyTarget(ModifyTable *plan, ExplainState *es);
 static void ExplainTargetRel(Plan *plan, Index rti, ExplainState *es);
 static void show_modifytable_info(ModifyTableState *mtstate, ExplainState *es);
-static void ExplainMemberNodes(List *plans, PlanState **planstates,
+static void ExplainMemberNodes(PlanState **planstates, int nplans,
 				   List *ancestors, ExplainState *es);
 static void ExplainSubPlans(List *plans, List *ancestors,
 				const char *relationship, ExplainState *es);
@@ -325,8 +341,10 @@ ExplainOneQuery(Query *query, IntoClause *into, ExplainState *es,
 
 		INSTR_TIME_SET_CURRENT(planstart);
 
-		/* plan the query */
-		plan = pg_plan_query(query, 0, params);
+		/* plan the query; unless it writes a table, it runs to completion */
+		plan = pg_plan_query(query,
+							 into ? 0 : CURSOR_OPT_PARALLEL_OK,
+							 params);
 
 		INSTR_TIME_SET_CURRENT(planduration);
 		INSTR_TIME_SUBTRACT(planduration, planstart);
@@ -708,6 +726,7 @@ ExplainPreScanNode(PlanState *planstate, Bitmapset **rels_used)
 	switch (nodeTag(plan))
 	{
 		case T_SeqScan:
+		case T_ParallelSeqScan:
 		case T_IndexScan:
 		case T_IndexOnlyScan:
 		case T_BitmapHeapScan:
@@ -746,28 +765,28 @@ ExplainPreScanNode(PlanState *planstate, Bitmapset **rels_used)
 	switch (nodeTag(plan))
 	{
 		case T_ModifyTable:
-			ExplainPreScanMemberNodes(((ModifyTable *) plan)->plans,
-								  ((ModifyTableState *) planstate)->mt_plans,
+			ExplainPreScanMemberNodes(((ModifyTableState *) planstate)->mt_plans,
+									  ((ModifyTableState *) planstate)->mt_nplans,
 									  rels_used);
 			break;
 		case T_Append:
-			ExplainPreScanMemberNodes(((Append *) plan)->appendplans,
-									((AppendState *) planstate)->appendplans,
+			ExplainPreScanMemberNodes(((AppendState *) planstate)->appendplans,
+									  ((AppendState *) planstate)->as_nplans,
 									  rels_used);
 			break;
 		case T_MergeAppend:
-			ExplainPreScanMemberNodes(((MergeAppend *) plan)->mergeplans,
-								((MergeAppendState *) planstate)->mergeplans,
+			ExplainPreScanMemberNodes(((MergeAppendState *) planstate)->mergeplans,
+									  ((MergeAppendState *) planstate)->ms_nplans,
 									  rels_used);
 			break;
 		case T_BitmapAnd:
-			ExplainPreScanMemberNodes(((BitmapAnd *) plan)->bitmapplans,
-								 ((BitmapAndState *) planstate)->bitmapplans,
+			ExplainPreScanMemberNodes(((BitmapAndState *) planstate)->bitmapplans,
+									  ((BitmapAndState *) planstate)->nplans,
 									  rels_used);
 			break;
 		case T_BitmapOr:
-			ExplainPreScanMemberNodes(((BitmapOr *) plan)->bitmapplans,
-								  ((BitmapOrState *) planstate)->bitmapplans,
+			ExplainPreScanMemberNodes(((BitmapOrState *) planstate)->bitmapplans,
+									  ((BitmapOrState *) planstate)->nplans,
 									  rels_used);
 			break;
 		case T_SubqueryScan:
@@ -787,14 +806,13 @@ ExplainPreScanNode(PlanState *planstate, Bitmapset **rels_used)
  * Prescan the constituent plans of a ModifyTable, Append, MergeAppend,
  * BitmapAnd, or BitmapOr node.
  *
- * Note: we don't actually need to examine the Plan list members, but
- * we need the list in order to determine the length of the PlanState array.
+ * Note: we look at the PlanState array, not the Plan list, since an Append
+ * or MergeAppend may have pruned some of its plans at startup.
  */
 static void
-ExplainPreScanMemberNodes(List *plans, PlanState **planstates,
+ExplainPreScanMemberNodes(PlanState **planstates, int nplans,
 						  Bitmapset **rels_used)
 {
-	int			nplans = list_length(plans);
 	int			j;
 
 	for (j = 0; j < nplans; j++)
@@ -846,6 +864,7 @@ ExplainNode(PlanState *planstate, List *ancestors,
 	const char *pname;			/* node type name for text output */
 	const char *sname;			/* node type name for non-text output */
 	const char *strategy = NULL;
+	const char *partialmode = NULL;
 	const char *operation = NULL;
 	int			save_indent = es->indent;
 	bool		haschildren;
@@ -902,6 +921,9 @@ ExplainNode(PlanState *planstate, List *ancestors,
 		case T_SeqScan:
 			pname = sname = "Seq Scan";
 			break;
+		case T_ParallelSeqScan:
+			pname = sname = "Parallel Seq Scan";
+			break;
 		case T_IndexScan:
 			pname = sname = "Index Scan";
 			break;
@@ -938,9 +960,15 @@ ExplainNode(PlanState *planstate, List *ancestors,
 		case T_Material:
 			pname = sname = "Materialize";
 			break;
+		case T_ResultCache:
+			pname = sname = "Result Cache";
+			break;
 		case T_Sort:
 			pname = sname = "Sort";
 			break;
+		case T_IncrementalSort:
+			pname = sname = "Incremental Sort";
+			break;
 		case T_Group:
 			pname = sname = "Group";
 			break;
@@ -965,6 +993,18 @@ ExplainNode(PlanState *planstate, List *ancestors,
 					strategy = "???";
 					break;
 			}
+			if (!((Agg *) plan)->finalizeAggs)
+			{
+				partialmode = "Partial";
+				pname = psprintf("%s %s", partialmode, pname);
+			}
+			else if (((Agg *) plan)->combineStates)
+			{
+				partialmode = "Finalize";
+				pname = psprintf("%s %s", partialmode, pname);
+			}
+			else
+				partialmode = "Simple";
 			break;
 		case T_WindowAgg:
 			pname = sname = "WindowAgg";
@@ -1030,6 +1070,8 @@ ExplainNode(PlanState *planstate, List *ancestors,
 		ExplainPropertyText("Node Type", sname, es);
 		if (strategy)
 			ExplainPropertyText("Strategy", strategy, es);
+		if (partialmode)
+			ExplainPropertyText("Partial Mode", partialmode, es);
 		if (operation)
 			ExplainPropertyText("Operation", operation, es);
 		if (relationship)
@@ -1041,6 +1083,7 @@ ExplainNode(PlanState *planstate, List *ancestors,
 	switch (nodeTag(plan))
 	{
 		case T_SeqScan:
+		case T_ParallelSeqScan:
 		case T_BitmapHeapScan:
 		case T_TidScan:
 		case T_SubqueryScan:
@@ -1257,6 +1300,7 @@ ExplainNode(PlanState *planstate, List *ancestors,
 			if (plan->qual)
 				show_instrumentation_count("Rows Removed by Filter", 1,
 										   planstate, es);
+			show_hashfilter_info((ScanState *) planstate, es);
 			break;
 		case T_IndexOnlyScan:
 			show_scan_qual(((IndexOnlyScan *) plan)->indexqual,
@@ -1288,6 +1332,7 @@ ExplainNode(PlanState *planstate, List *ancestors,
 			if (plan->qual)
 				show_instrumentation_count("Rows Removed by Filter", 1,
 										   planstate, es);
+			show_hashfilter_info((ScanState *) planstate, es);
 			if (es->analyze)
 				show_tidbitmap_info((BitmapHeapScanState *) planstate, es);
 			break;
@@ -1300,6 +1345,19 @@ ExplainNode(PlanState *planstate, List *ancestors,
 			if (plan->qual)
 				show_instrumentation_count("Rows Removed by Filter", 1,
 										   planstate, es);
+			show_hashfilter_info((ScanState *) planstate, es);
+			break;
+		case T_ParallelSeqScan:
+			show_scan_qual(plan->qual, "Filter", planstate, ancestors, es);
+			if (plan->qual)
+				show_instrumentation_count("Rows Removed by Filter", 1,
+										   planstate, es);
+			ExplainPropertyInteger("Number of Workers",
+								   ((ParallelSeqScan *) plan)->num_workers, es);
+			if (es->analyze)
+				ExplainPropertyInteger("Workers Launched",
+				((ParallelSeqScanState *) planstate)->pss_nworkers_launched,
+									   es);
 			break;
 		case T_FunctionScan:
 			if (es->verbose)
@@ -1357,6 +1415,8 @@ ExplainNode(PlanState *planstate, List *ancestors,
 			if (plan->qual)
 				show_instrumentation_count("Rows Removed by Filter", 2,
 										   planstate, es);
+			show_nestloop_batch_info((NestLoopState *) planstate, ancestors,
+									 es);
 			break;
 		case T_MergeJoin:
 			show_upper_qual(((MergeJoin *) plan)->mergeclauses,
@@ -1390,6 +1450,11 @@ ExplainNode(PlanState *planstate, List *ancestors,
 			if (plan->qual)
 				show_instrumentation_count("Rows Removed by Filter", 1,
 										   planstate, es);
+			if (es->analyze)
+			{
+				show_hashagg_info((AggState *) planstate, es);
+				show_agg_batch_info((AggState *) planstate, es);
+			}
 			break;
 		case T_Group:
 			show_group_keys((GroupState *) planstate, ancestors, es);
@@ -1402,9 +1467,29 @@ ExplainNode(PlanState *planstate, List *ancestors,
 			show_sort_keys((SortState *) planstate, ancestors, es);
 			show_sort_info((SortState *) planstate, es);
 			break;
+		case T_IncrementalSort:
+			show_incremental_sort_keys((IncrementalSortState *) planstate,
+									   ancestors, es);
+			show_incremental_sort_info((IncrementalSortState *) planstate,
+									   es);
+			break;
+		case T_Append:
+			if (((AppendState *) planstate)->as_nremoved > 0)
+				ExplainPropertyInteger("Subplans Removed",
+								  ((AppendState *) planstate)->as_nremoved,
+									   es);
+			break;
 		case T_MergeAppend:
 			show_merge_append_keys((MergeAppendState *) planstate,
 								   ancestors, es);
+			if (((MergeAppendState *) planstate)->ms_nremoved > 0)
+				ExplainPropertyInteger("Subplans Removed",
+							 ((MergeAppendState *) planstate)->ms_nremoved,
+									   es);
+			break;
+		case T_ResultCache:
+			show_resultcache_info((ResultCacheState *) planstate, ancestors,
+								  es);
 			break;
 		case T_Result:
 			show_upper_qual((List *) ((Result *) plan)->resconstantqual,
@@ -1566,28 +1651,28 @@ ExplainNode(PlanState *planstate, List *ancestors,
 	switch (nodeTag(plan))
 	{
 		case T_ModifyTable:
-			ExplainMemberNodes(((ModifyTable *) plan)->plans,
-							   ((ModifyTableState *) planstate)->mt_plans,
+			ExplainMemberNodes(((ModifyTableState *) planstate)->mt_plans,
+							   ((ModifyTableState *) planstate)->mt_nplans,
 							   ancestors, es);
 			break;
 		case T_Append:
-			ExplainMemberNodes(((Append *) plan)->appendplans,
-							   ((AppendState *) planstate)->appendplans,
+			ExplainMemberNodes(((AppendState *) planstate)->appendplans,
+							   ((AppendState *) planstate)->as_nplans,
 							   ancestors, es);
 			break;
 		case T_MergeAppend:
-			ExplainMemberNodes(((MergeAppend *) plan)->mergeplans,
-							   ((MergeAppendState *) planstate)->mergeplans,
+			ExplainMemberNodes(((MergeAppendState *) planstate)->mergeplans,
+							   ((MergeAppendState *) planstate)->ms_nplans,
 							   ancestors, es);
 			break;
 		case T_BitmapAnd:
-			ExplainMemberNodes(((BitmapAnd *) plan)->bitmapplans,
-							   ((BitmapAndState *) planstate)->bitmapplans,
+			ExplainMemberNodes(((BitmapAndState *) planstate)->bitmapplans,
+							   ((BitmapAndState *) planstate)->nplans,
 							   ancestors, es);
 			break;
 		case T_BitmapOr:
-			ExplainMemberNodes(((BitmapOr *) plan)->bitmapplans,
-							   ((BitmapOrState *) planstate)->bitmapplans,
+			ExplainMemberNodes(((BitmapOrState *) planstate)->bitmapplans,
+							   ((BitmapOrState *) planstate)->nplans,
 							   ancestors, es);
 			break;
 		case T_SubqueryScan:
@@ -1749,6 +1834,24 @@ show_sort_keys(SortState *sortstate, List *ancestors, ExplainState *es)
 						 ancestors, es);
 }
 
+/*
+ * Show the sort keys for an IncrementalSort node, and which of them the
+ * input is already sorted by.
+ */
+static void
+show_incremental_sort_keys(IncrementalSortState *incrsortstate,
+						   List *ancestors, ExplainState *es)
+{
+	IncrementalSort *plan = (IncrementalSort *) incrsortstate->ss.ps.plan;
+
+	show_sort_group_keys((PlanState *) incrsortstate, "Sort Key",
+						 plan->sort.numCols, plan->sort.sortColIdx,
+						 ancestors, es);
+	show_sort_group_keys((PlanState *) incrsortstate, "Presorted Key",
+						 plan->presortedCols, plan->sort.sortColIdx,
+						 ancestors, es);
+}
+
 /*
  * Likewise, for a MergeAppend node.
  */
@@ -1772,17 +1875,120 @@ show_agg_keys(AggState *astate, List *ancestors,
 {
 	Agg		   *plan = (Agg *) astate->ss.ps.plan;
 
-	if (plan->numCols > 0)
+	if (plan->numCols > 0 || plan->groupingSets)
 	{
 		/* The key columns refer to the tlist of the child plan */
 		ancestors = lcons(astate, ancestors);
-		show_sort_group_keys(outerPlanState(astate), "Group Key",
-							 plan->numCols, plan->grpColIdx,
-							 ancestors, es);
+
+		if (plan->groupingSets)
+			show_grouping_sets(outerPlanState(astate), plan, ancestors, es);
+		else
+			show_sort_group_keys(outerPlanState(astate), "Group Key",
+								 plan->numCols, plan->grpColIdx,
+								 ancestors, es);
+
 		ancestors = list_delete_first(ancestors);
 	}
 }
 
+/*
+ * Show the grouping sets computed by an Agg node, including those of the
+ * other Agg nodes in its chain.
+ */
+static void
+show_grouping_sets(PlanState *planstate, Agg *agg,
+				   List *ancestors, ExplainState *es)
+{
+	List	   *context;
+	bool		useprefix;
+	ListCell   *lc;
+
+	/* Set up deparsing context */
+	context = deparse_context_for_planstate((Node *) planstate,
+											ancestors,
+											es->rtable,
+											es->rtable_names);
+	useprefix = (list_length(es->rtable) > 1 || es->verbose);
+
+	ExplainOpenGroup("Grouping Sets", "Grouping Sets", false, es);
+
+	show_grouping_set_keys(planstate, agg, NULL,
+						   context, useprefix, ancestors, es);
+
+	foreach(lc, agg->chain)
+	{
+		Agg		   *aggnode = lfirst(lc);
+		Sort	   *sortnode = (Sort *) aggnode->plan.lefttree;
+
+		show_grouping_set_keys(planstate, aggnode, sortnode,
+							   context, useprefix, ancestors, es);
+	}
+
+	ExplainCloseGroup("Grouping Sets", "Grouping Sets", false, es);
+}
+
+/*
+ * Show the keys of each grouping set of one phase.  Each set's columns are
+ * a prefix of the Agg's grpColIdx; if the phase needs its input re-sorted,
+ * the sort keys are shown first.
+ */
+static void
+show_grouping_set_keys(PlanState *planstate, Agg *aggnode, Sort *sortnode,
+					   List *context, bool useprefix,
+					   List *ancestors, ExplainState *es)
+{
+	Plan	   *plan = planstate->plan;
+	char	   *exprstr;
+	ListCell   *lc;
+
+	ExplainOpenGroup("Grouping Set", NULL, true, es);
+
+	if (sortnode)
+	{
+		show_sort_group_keys(planstate, "Sort Key",
+							 sortnode->numCols, sortnode->sortColIdx,
+							 ancestors, es);
+		if (es->format == EXPLAIN_FORMAT_TEXT)
+			es->indent++;
+	}
+
+	ExplainOpenGroup("Group Keys", "Group Keys", false, es);
+
+	foreach(lc, aggnode->groupingSets)
+	{
+		List	   *result = NIL;
+		int			nkeys = list_length((List *) lfirst(lc));
+		int			keyno;
+
+		for (keyno = 0; keyno < nkeys; keyno++)
+		{
+			AttrNumber	keyresno = aggnode->grpColIdx[keyno];
+			TargetEntry *target = get_tle_by_resno(plan->targetlist,
+												   keyresno);
+
+			if (!target)
+				elog(ERROR, "no tlist entry for key %d", keyresno);
+			/* Deparse the expression, showing any top-level cast */
+			exprstr = deparse_expression((Node *) target->expr, context,
+										 useprefix, true);
+
+			result = lappend(result, exprstr);
+		}
+
+		if (!result && es->format == EXPLAIN_FORMAT_TEXT)
+			ExplainPropertyText("Group Key", "()", es);
+		else
+			ExplainPropertyListNested("Group Key", result, es);
+	}
+
+	ExplainCloseGroup("Group Keys", "Group Keys", false, es);
+
+	if (sortnode && es->format == EXPLAIN_FORMAT_TEXT)
+		es->indent--;
+
+	ExplainCloseGroup("Grouping Set", NULL, true, es);
+}
+
 /*
  * Show the grouping keys for a Group node.
  */
@@ -1876,6 +2082,153 @@ show_sort_info(SortState *sortstate, ExplainState *es)
 	}
 }
 
+/*
+ * Show the keys a nestloop sorts its batches of outer rows by (in VERBOSE
+ * mode only), and if it's EXPLAIN ANALYZE, how many batches it read
+ */
+static void
+show_nestloop_batch_info(NestLoopState *nlstate, List *ancestors,
+						 ExplainState *es)
+{
+	NestLoop   *plan = (NestLoop *) nlstate->js.ps.plan;
+
+	if (plan->numBatchKeys <= 0)
+		return;
+
+	if (es->verbose)
+	{
+		AttrNumber *keycols;
+		int			i;
+
+		/* The keys are columns of the outer plan's tlist */
+		keycols = (AttrNumber *) palloc(plan->numBatchKeys * sizeof(AttrNumber));
+		for (i = 0; i < plan->numBatchKeys; i++)
+		{
+			NestLoopParam *nlp;
+
+			nlp = (NestLoopParam *) list_nth(plan->nestParams,
+											 plan->batchKeyParams[i]);
+			keycols[i] = nlp->paramval->varattno;
+		}
+
+		ancestors = lcons(nlstate, ancestors);
+		show_sort_group_keys(outerPlanState(nlstate), "Batch Sort Key",
+							 plan->numBatchKeys, keycols, ancestors, es);
+		ancestors = list_delete_first(ancestors);
+		pfree(keycols);
+	}
+
+	if (!es->analyze || nlstate->nl_NumBatches == 0)
+		return;
+
+	if (es->format == EXPLAIN_FORMAT_TEXT)
+	{
+		appendStringInfoSpaces(es->str, es->indent * 2);
+		appendStringInfo(es->str, "Batches: %ld  Peak Batch Size: %d\n",
+						 nlstate->nl_NumBatches, nlstate->nl_MaxBatchCount);
+	}
+	else
+	{
+		ExplainPropertyLong("Batches", nlstate->nl_NumBatches, es);
+		ExplainPropertyInteger("Peak Batch Size",
+							   nlstate->nl_MaxBatchCount, es);
+	}
+}
+
+/*
+ * If it's EXPLAIN ANALYZE, show how many batches an incremental sort sorted,
+ * and the most space any one of them needed
+ */
+static void
+show_incremental_sort_info(IncrementalSortState *incrsortstate,
+						   ExplainState *es)
+{
+	const char *spaceType = incrsortstate->maxSpaceType;
+	long		spaceUsed = incrsortstate->maxSpaceUsed;
+
+	if (!es->analyze || incrsortstate->nbatches == 0)
+		return;
+
+	/* The current batch hasn't been counted yet */
+	if (incrsortstate->tuplesortstate != NULL)
+	{
+		const char *sortMethod;
+		const char *curSpaceType;
+		long		curSpaceUsed;
+
+		tuplesort_get_stats((Tuplesortstate *) incrsortstate->tuplesortstate,
+							&sortMethod, &curSpaceType, &curSpaceUsed);
+		if (spaceType == NULL || curSpaceUsed > spaceUsed)
+		{
+			spaceType = curSpaceType;
+			spaceUsed = curSpaceUsed;
+		}
+	}
+
+	if (es->format == EXPLAIN_FORMAT_TEXT)
+	{
+		appendStringInfoSpaces(es->str, es->indent * 2);
+		appendStringInfo(es->str, "Sort Batches: %ld  Peak %s: %ldkB\n",
+						 incrsortstate->nbatches, spaceType, spaceUsed);
+	}
+	else
+	{
+		ExplainPropertyLong("Sort Batches", incrsortstate->nbatches, es);
+		ExplainPropertyLong("Peak Sort Space Used", spaceUsed, es);
+		ExplainPropertyText("Peak Sort Space Type", spaceType, es);
+	}
+}
+
+/*
+ * Show the cache keys of a ResultCache node, and if it's EXPLAIN ANALYZE,
+ * how well the cache worked
+ */
+static void
+show_resultcache_info(ResultCacheState *rcstate, List *ancestors,
+					  ExplainState *es)
+{
+	ResultCache *plan = (ResultCache *) rcstate->ss.ps.plan;
+	List	   *context;
+	List	   *result = NIL;
+	bool		useprefix;
+	ListCell   *lc;
+
+	/* Set up deparsing context */
+	context = deparse_context_for_planstate((Node *) rcstate,
+											ancestors,
+											es->rtable,
+											es->rtable_names);
+	useprefix = (list_length(es->rtable) > 1 || es->verbose);
+
+	foreach(lc, plan->param_exprs)
+		result = lappend(result,
+						 deparse_expression((Node *) lfirst(lc), context,
+											useprefix, false));
+	ExplainPropertyList("Cache Key", result, es);
+
+	if (!es->analyze)
+		return;
+
+	if (es->format == EXPLAIN_FORMAT_TEXT)
+	{
+		appendStringInfoSpaces(es->str, es->indent * 2);
+		appendStringInfo(es->str,
+						 "Hits: %ld  Misses: %ld  Evictions: %ld  Overflows: %ld  Memory Usage: %ldkB\n",
+						 rcstate->hits, rcstate->misses, rcstate->evictions,
+						 rcstate->overflows,
+						 (long) ((rcstate->mem_peak + 1023) / 1024));
+	}
+	else
+	{
+		ExplainPropertyLong("Cache Hits", rcstate->hits, es);
+		ExplainPropertyLong("Cache Misses", rcstate->misses, es);
+		ExplainPropertyLong("Cache Evictions", rcstate->evictions, es);
+		ExplainPropertyLong("Cache Overflows", rcstate->overflows, es);
+		ExplainPropertyLong("Peak Memory Usage",
+							(long) ((rcstate->mem_peak + 1023) / 1024), es);
+	}
+}
+
 /*
  * Show information on hash buckets/batches.
  */
@@ -1919,7 +2272,55 @@ show_hash_info(HashState *hashstate, ExplainState *es)
 }
 
 /*
- * If it's EXPLAIN ANALYZE, show exact/lossy pages for a BitmapHeapScan node
+ * If it's EXPLAIN ANALYZE, show memory use and spilling of a hashed Agg node
+ */
+static void
+show_hashagg_info(AggState *aggstate, ExplainState *es)
+{
+	Agg		   *agg = (Agg *) aggstate->ss.ps.plan;
+	long		memPeakKb = (aggstate->hash_mem_peak + 1023) / 1024;
+	long		diskKb = (long) ((aggstate->hash_disk_used + 1023) / 1024);
+
+	if (agg->aggstrategy != AGG_HASHED || aggstate->hash_batches_used == 0)
+		return;
+
+	if (es->format != EXPLAIN_FORMAT_TEXT)
+	{
+		ExplainPropertyLong("HashAgg Batches", aggstate->hash_batches_used, es);
+		ExplainPropertyLong("Peak Memory Usage", memPeakKb, es);
+		ExplainPropertyLong("Disk Usage", diskKb, es);
+	}
+	else if (aggstate->hash_batches_used > 1)
+	{
+		appendStringInfoSpaces(es->str, es->indent * 2);
+		appendStringInfo(es->str,
+						 "Batches: %ld  Memory Usage: %ldkB  Disk Usage: %ldkB\n",
+						 aggstate->hash_batches_used, memPeakKb, diskKb);
+	}
+	else
+	{
+		appendStringInfoSpaces(es->str, es->indent * 2);
+		appendStringInfo(es->str, "Batches: %ld  Memory Usage: %ldkB\n",
+						 aggstate->hash_batches_used, memPeakKb);
+	}
+}
+
+/*
+ * If it's EXPLAIN ANALYZE, show how many input batches a plain Agg node read,
+ * if it reads its input in batches
+ */
+static void
+show_agg_batch_info(AggState *aggstate, ExplainState *es)
+{
+	if (aggstate->batch == NULL)
+		return;
+
+	ExplainPropertyLong("Input Batches", aggstate->input_batches, es);
+}
+
+/*
+ * If it's EXPLAIN ANALYZE, show exact/lossy pages for a BitmapHeapScan node,
+ * and how many of the exact ones we didn't need to fetch
  */
 static void
 show_tidbitmap_info(BitmapHeapScanState *planstate, ExplainState *es)
@@ -1928,6 +2329,9 @@ show_tidbitmap_info(BitmapHeapScanState *planstate, ExplainState *es)
 	{
 		ExplainPropertyLong("Exact Heap Blocks", planstate->exact_pages, es);
 		ExplainPropertyLong("Lossy Heap Blocks", planstate->lossy_pages, es);
+		if (planstate->can_skip_fetch)
+			ExplainPropertyLong("Skipped Heap Blocks",
+								planstate->skipped_pages, es);
 	}
 	else
 	{
@@ -1937,6 +2341,9 @@ show_tidbitmap_info(BitmapHeapScanState *planstate, ExplainState *es)
 			appendStringInfo(es->str, " exact=%ld", planstate->exact_pages);
 		if (planstate->lossy_pages > 0)
 			appendStringInfo(es->str, " lossy=%ld", planstate->lossy_pages);
+		if (planstate->skipped_pages > 0)
+			appendStringInfo(es->str, " skipped=%ld",
+							 planstate->skipped_pages);
 		appendStringInfoChar(es->str, '\n');
 	}
 }
@@ -1972,6 +2379,32 @@ show_instrumentation_count(const char *qlabel, int which,
 	}
 }
 
+/*
+ * Show how many rows a scan threw away because a hash join above it said
+ * they couldn't match, if it has such a filter.
+ */
+static void
+show_hashfilter_info(ScanState *scanstate, ExplainState *es)
+{
+	HashJoinFilter *filter = scanstate->ss_HashFilter;
+	double		nloops;
+
+	if (!es->analyze || !scanstate->ps.instrument || filter == NULL)
+		return;
+
+	nloops = scanstate->ps.instrument->nloops;
+
+	/* In text mode, suppress zero counts, as for the other filters */
+	if (filter->nremoved > 0 || es->format != EXPLAIN_FORMAT_TEXT)
+	{
+		if (nloops > 0)
+			ExplainPropertyFloat("Rows Removed by Bloom Filter",
+								 filter->nremoved / nloops, 0, es);
+		else
+			ExplainPropertyFloat("Rows Removed by Bloom Filter", 0.0, 0, es);
+	}
+}
+
 /*
  * Show extra information for a ForeignScan node.
  */
@@ -2097,6 +2530,7 @@ ExplainTargetRel(Plan *plan, Index rti, ExplainState *es)
 	switch (nodeTag(plan))
 	{
 		case T_SeqScan:
+		case T_ParallelSeqScan:
 		case T_IndexScan:
 		case T_IndexOnlyScan:
 		case T_BitmapHeapScan:
@@ -2218,14 +2652,13 @@ show_modifytable_info(ModifyTableState *mtstate, ExplainState *es)
  * The ancestors list should already contain the immediate parent of these
  * plans.
  *
- * Note: we don't actually need to examine the Plan list members, but
- * we need the list in order to determine the length of the PlanState array.
+ * Note: we look at the PlanState array, not the Plan list, since an Append
+ * or MergeAppend may have pruned some of its plans at startup.
  */
 static void
-ExplainMemberNodes(List *plans, PlanState **planstates,
+ExplainMemberNodes(PlanState **planstates, int nplans,
 				   List *ancestors, ExplainState *es)
 {
-	int			nplans = list_length(plans);
 	int			j;
 
 	for (j = 0; j < nplans; j++)
@@ -2325,6 +2758,52 @@ ExplainPropertyList(const char *qlabel, List *data, ExplainState *es)
 	}
 }
 
+/*
+ * Explain a property that takes the form of a list of unlabeled items within
+ * another list.  "data" is a list of C strings.
+ */
+void
+ExplainPropertyListNested(const char *qlabel, List *data, ExplainState *es)
+{
+	ListCell   *lc;
+	bool		first = true;
+
+	switch (es->format)
+	{
+		case EXPLAIN_FORMAT_TEXT:
+		case EXPLAIN_FORMAT_XML:
+			ExplainPropertyList(qlabel, data, es);
+			return;
+
+		case EXPLAIN_FORMAT_JSON:
+			ExplainJSONLineEnding(es);
+			appendStringInfoSpaces(es->str, es->indent * 2);
+			appendStringInfoChar(es->str, '[');
+			foreach(lc, data)
+			{
+				if (!first)
+					appendStringInfoString(es->str, ", ");
+				escape_json(es->str, (const char *) lfirst(lc));
+				first = false;
+			}
+			appendStringInfoChar(es->str, ']');
+			break;
+
+		case EXPLAIN_FORMAT_YAML:
+			ExplainYAMLLineStarting(es);
+			appendStringInfoString(es->str, "- [");
+			foreach(lc, data)
+			{
+				if (!first)
+					appendStringInfoString(es->str, ", ");
+				escape_yaml(es->str, (const char *) lfirst(lc));
+				first = false;
+			}
+			appendStringInfoChar(es->str, ']');
+			break;
+	}
+}
+
 /*
  * Explain a simple property.
  *
@@ -0,0 +1,444 @@
+/*-------------------------------------------------------------------------
+ *
+ * execBatch.c
+ *	  executor utility routines for passing tuples a batch at a time
+ *
+ * Most plan nodes hand their parent one TupleTableSlot per ExecProcNode
+ * call.  For nodes that process a great many rows cheaply, such as a plain
+ * aggregate over a sequential scan, the per-call overhead can exceed the
+ * useful work.  A TupleBatch lets such a child hand over many rows at once,
+ * deformed into per-column arrays; see ExecProcNodeBatch.
+ *
+ * This file holds the TupleBatch support routines, plus "batch quals":
+ * simple qual clauses of the form "column op constant" that can be checked
+ * by one loop over a column array, instead of evaluating the whole qual
+ * expression once per row.
+ *
+ * Portions Copyright (c) 1996-2014, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, Regents of the University of California
+ *
+ *
+ * IDENTIFICATION
+ *	  src/backend/executor/execBatch.c
+ *
+ *-------------------------------------------------------------------------
+ */
+#include "postgres.h"
+
+#include "catalog/objectaccess.h"
+#include "executor/executor.h"
+#include "executor/tuplebatch.h"
+#include "miscadmin.h"
+#include "optimizer/planmain.h"
+#include "storage/bufmgr.h"
+#include "utils/acl.h"
+#include "utils/datum.h"
+#include "utils/lsyscache.h"
+#include "utils/memutils.h"
+
+
+/*
+ * One clause of a batch qual: a strict boolean operator applied to a column
+ * of the scan tuple and a constant.  The constant is preloaded into fcinfo,
+ * so only the column's argument slot changes from row to row.
+ */
+typedef struct BatchQualClause
+{
+	AttrNumber	attno;			/* column being tested */
+	int			vararg;			/* which argument the column is (0 or 1) */
+	bool		constisnull;	/* constant is NULL, so the test must fail */
+	FmgrInfo	flinfo;			/* operator's function */
+	FunctionCallInfoData fcinfo;	/* call info, constant preloaded */
+} BatchQualClause;
+
+
+/*****************************************************************************
+ *		TupleBatch support routines
+ *****************************************************************************/
+
+/*
+ * MakeTupleBatch
+ *		Create an empty batch for rows of the given descriptor, whose
+ *		consumer needs the first ncols columns.
+ *
+ * The batch is allocated in CurrentMemoryContext.
+ */
+TupleBatch *
+MakeTupleBatch(TupleDesc tupdesc, int ncols, int maxrows)
+{
+	TupleBatch *batch;
+
+	Assert(ncols >= 0 && ncols <= tupdesc->natts);
+	Assert(maxrows > 0);
+
+	batch = (TupleBatch *) palloc0(sizeof(TupleBatch));
+	batch->tupdesc = tupdesc;
+	batch->maxrows = maxrows;
+	batch->ncols = ncols;
+	batch->values = (Datum **) palloc0(tupdesc->natts * sizeof(Datum *));
+	batch->isnull = (bool **) palloc0(tupdesc->natts * sizeof(bool *));
+	batch->keep = (bool *) palloc(maxrows * sizeof(bool));
+	batch->batchcxt = AllocSetContextCreate(CurrentMemoryContext,
+											"TupleBatch",
+											ALLOCSET_DEFAULT_MINSIZE,
+											ALLOCSET_DEFAULT_INITSIZE,
+											ALLOCSET_DEFAULT_MAXSIZE);
+
+	return batch;
+}
+
+/*
+ * TupleBatchReset
+ *		Empty the batch, releasing any buffer pins and copied values.
+ */
+void
+TupleBatchReset(TupleBatch *batch)
+{
+	int			i;
+
+	for (i = 0; i < batch->nbuffers; i++)
+		ReleaseBuffer(batch->buffers[i]);
+	batch->nbuffers = 0;
+	batch->nrows = 0;
+	batch->nvalid = 0;
+	MemoryContextReset(batch->batchcxt);
+}
+
+/*
+ * TupleBatchFree
+ *		Release all resources of a batch.
+ */
+void
+TupleBatchFree(TupleBatch *batch)
+{
+	int			i;
+
+	TupleBatchReset(batch);
+	MemoryContextDelete(batch->batchcxt);
+	for (i = 0; i < batch->nallocated; i++)
+	{
+		pfree(batch->values[i]);
+		pfree(batch->isnull[i]);
+	}
+	pfree(batch->values);
+	pfree(batch->isnull);
+	pfree(batch->keep);
+	pfree(batch);
+}
+
+/*
+ * TupleBatchPinBuffer
+ *		Make the batch hold a pin on the buffer that a row about to be
+ *		added points into.
+ *
+ * Rows are expected to arrive in buffer order, so we only need to look at
+ * the most recently pinned buffer.  Returns false if the batch already holds
+ * as many pins as it's allowed to; the caller must then copy the row.
+ */
+bool
+TupleBatchPinBuffer(TupleBatch *batch, Buffer buffer)
+{
+	Assert(BufferIsValid(buffer));
+
+	if (batch->nbuffers > 0 &&
+		batch->buffers[batch->nbuffers - 1] == buffer)
+		return true;
+
+	if (batch->nbuffers >= TUPLE_BATCH_MAX_PINS)
+		return false;
+
+	IncrBufferRefCount(buffer);
+	batch->buffers[batch->nbuffers++] = buffer;
+	return true;
+}
+
+/*
+ * TupleBatchAddSlot
+ *		Append the first natts columns of a slot's tuple to the batch.
+ *
+ * All rows of a batch must be added with the same natts, which must be at
+ * least batch->ncols.  If copy is true, pass-by-reference values are copied
+ * into the batch's own memory; otherwise the caller must guarantee that they
+ * stay valid until the batch is reset, typically with TupleBatchPinBuffer.
+ */
+void
+TupleBatchAddSlot(TupleBatch *batch, TupleTableSlot *slot, int natts,
+				  bool copy)
+{
+	Form_pg_attribute *attrs = batch->tupdesc->attrs;
+	int			row = batch->nrows;
+	int			i;
+
+	Assert(row < batch->maxrows);
+	Assert(natts >= batch->ncols && natts <= batch->tupdesc->natts);
+
+	if (row == 0)
+	{
+		/* First row fixes the number of columns filled in */
+		if (natts > batch->nallocated)
+		{
+			MemoryContext cxt = batch->batchcxt->parent;
+
+			for (i = batch->nallocated; i < natts; i++)
+			{
+				batch->values[i] = (Datum *)
+					MemoryContextAlloc(cxt, batch->maxrows * sizeof(Datum));
+				batch->isnull[i] = (bool *)
+					MemoryContextAlloc(cxt, batch->maxrows * sizeof(bool));
+			}
+			batch->nallocated = natts;
+		}
+		batch->nvalid = natts;
+	}
+	Assert(natts == batch->nvalid);
+
+	slot_getsomeattrs(slot, natts);
+
+	for (i = 0; i < natts; i++)
+	{
+		Datum		value = slot->tts_values[i];
+		bool		isnull = slot->tts_isnull[i];
+
+		if (copy && !isnull && !attrs[i]->attbyval)
+		{
+			MemoryContext oldContext;
+
+			oldContext = MemoryContextSwitchTo(batch->batchcxt);
+			value = datumCopy(value, false, attrs[i]->attlen);
+			MemoryContextSwitchTo(oldContext);
+		}
+		batch->values[i][row] = value;
+		batch->isnull[i][row] = isnull;
+	}
+
+	batch->nrows++;
+}
+
+/*
+ * TupleBatchCompact
+ *		Remove the rows whose batch->keep flag is false.
+ */
+void
+TupleBatchCompact(TupleBatch *batch)
+{
+	bool	   *keep = batch->keep;
+	int			nrows = batch->nrows;
+	int			nkept = 0;
+	int			col;
+	int			row;
+
+	for (col = 0; col < batch->nvalid; col++)
+	{
+		Datum	   *values = batch->values[col];
+		bool	   *isnull = batch->isnull[col];
+
+		nkept = 0;
+		for (row = 0; row < nrows; row++)
+		{
+			if (keep[row])
+			{
+				values[nkept] = values[row];
+				isnull[nkept] = isnull[row];
+				nkept++;
+			}
+		}
+	}
+
+	/* with no columns at all, we still need the count */
+	if (batch->nvalid == 0)
+	{
+		for (row = 0; row < nrows; row++)
+			nkept += keep[row] ? 1 : 0;
+	}
+
+	batch->nrows = nkept;
+}
+
+
+/*****************************************************************************
+ *		Batch quals
+ *****************************************************************************/
+
+/*
+ * ExecInitBatchQual
+ *		Prepare a plan qual (an implicit-AND list of clauses, not yet passed
+ *		through ExecInitExpr) for evaluation over batches.
+ *
+ * Each clause must have the form "Var op Const" or "Const op Var", where Var
+ * is a user column of the scan tuple and op is strict.  Returns a list of
+ * BatchQualClause, or NIL if the qual is empty or has any other kind of
+ * clause, in which case the caller must evaluate it row by row as usual.
+ *
+ * Since this checks permission to call the operators' functions, it should
+ * be called only when the qual is about to be evaluated, not at plan node
+ * initialization (which happens for EXPLAIN, too).
+ */
+List *
+ExecInitBatchQual(List *qual)
+{
+	List	   *result = NIL;
+	ListCell   *lc;
+
+	foreach(lc, qual)
+	{
+		OpExpr	   *op = (OpExpr *) lfirst(lc);
+		Node	   *leftop;
+		Node	   *rightop;
+		Var		   *var;
+		Const	   *con;
+		int			vararg;
+		BatchQualClause *bq;
+		AclResult	aclresult;
+
+		if (!IsA(op, OpExpr) ||
+			list_length(op->args) != 2 ||
+			op->opretset)
+			goto fail;
+
+		leftop = (Node *) linitial(op->args);
+		rightop = (Node *) lsecond(op->args);
+
+		if (IsA(leftop, Var) && IsA(rightop, Const))
+		{
+			var = (Var *) leftop;
+			con = (Const *) rightop;
+			vararg = 0;
+		}
+		else if (IsA(leftop, Const) && IsA(rightop, Var))
+		{
+			var = (Var *) rightop;
+			con = (Const *) leftop;
+			vararg = 1;
+		}
+		else
+			goto fail;
+
+		if (var->varattno <= 0 || var->varlevelsup != 0)
+			goto fail;
+
+		set_opfuncid(op);
+		if (!func_strict(op->opfuncid))
+			goto fail;
+
+		/*
+		 * Check permission to call the function, as init_fcache would when
+		 * the clause is evaluated in the ordinary way.
+		 */
+		aclresult = pg_proc_aclcheck(op->opfuncid, GetUserId(), ACL_EXECUTE);
+		if (aclresult != ACLCHECK_OK)
+			aclcheck_error(aclresult, ACL_KIND_PROC,
+						   get_func_name(op->opfuncid));
+		InvokeFunctionExecuteHook(op->opfuncid);
+
+		bq = (BatchQualClause *) palloc0(sizeof(BatchQualClause));
+		bq->attno = var->varattno;
+		bq->vararg = vararg;
+		bq->constisnull = con->constisnull;
+		fmgr_info(op->opfuncid, &bq->flinfo);
+		fmgr_info_set_expr((Node *) op, &bq->flinfo);
+		InitFunctionCallInfoData(bq->fcinfo, &bq->flinfo, 2,
+								 op->inputcollid, NULL, NULL);
+		bq->fcinfo.arg[1 - vararg] = con->constvalue;
+		bq->fcinfo.argnull[1 - vararg] = con->constisnull;
+		bq->fcinfo.argnull[vararg] = false;
+
+		result = lappend(result, bq);
+	}
+
+	return result;
+
+fail:
+	list_free_deep(result);
+	return NIL;
+}
+
+/*
+ * ExecBatchQualNeededAtts
+ *		Return the number of leading columns a batch qual looks at.
+ */
+int
+ExecBatchQualNeededAtts(List *batchqual)
+{
+	int			natts = 0;
+	ListCell   *lc;
+
+	foreach(lc, batchqual)
+	{
+		BatchQualClause *bq = (BatchQualClause *) lfirst(lc);
+
+		natts = Max(natts, bq->attno);
+	}
+
+	return natts;
+}
+
+/*
+ * ExecBatchQual
+ *		Remove the rows of a batch that fail a batch qual.
+ *
+ * The batch must have at least ExecBatchQualNeededAtts columns filled in.
+ * The functions are called in econtext's per-tuple memory, which the caller
+ * should reset afterwards.  Returns the number of rows removed.
+ */
+int
+ExecBatchQual(List *batchqual, TupleBatch *batch, ExprContext *econtext)
+{
+	MemoryContext oldContext;
+	int			nremoved = 0;
+	ListCell   *lc;
+
+	oldContext = MemoryContextSwitchTo(econtext->ecxt_per_tuple_memory);
+
+	foreach(lc, batchqual)
+	{
+		BatchQualClause *bq = (BatchQualClause *) lfirst(lc);
+		FunctionCallInfo fcinfo = &bq->fcinfo;
+		Datum	   *values = batch->values[bq->attno - 1];
+		bool	   *isnull = batch->isnull[bq->attno - 1];
+		bool	   *keep = batch->keep;
+		int			nrows = batch->nrows;
+		int			nkept = 0;
+		int			row;
+
+		Assert(bq->attno <= batch->nvalid);
+
+		if (batch->nrows == 0)
+			break;
+
+		if (bq->constisnull)
+		{
+			/* strict operator on a NULL constant can never yield true */
+			nremoved += nrows;
+			batch->nrows = 0;
+			break;
+		}
+
+		for (row = 0; row < nrows; row++)
+		{
+			Datum		result;
+
+			if (isnull[row])
+			{
+				keep[row] = false;
+				continue;
+			}
+
+			fcinfo->arg[bq->vararg] = values[row];
+			fcinfo->isnull = false;
+			result = FunctionCallInvoke(fcinfo);
+			keep[row] = !fcinfo->isnull && DatumGetBool(result);
+			if (keep[row])
+				nkept++;
+		}
+
+		if (nkept < nrows)
+		{
+			TupleBatchCompact(batch);
+			nremoved += nrows - nkept;
+		}
+	}
+
+	MemoryContextSwitchTo(oldContext);
+
+	return nremoved;
+}
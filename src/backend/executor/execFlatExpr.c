@@ -0,0 +1,1142 @@
+/*-------------------------------------------------------------------------
+ *
+ * execFlatExpr.c
+ *	  routines to evaluate expressions as flat programs of steps
+ *
+ * ExecInitExpr builds a tree of ExprState nodes that mirrors the expression
+ * tree, and evaluating it means one indirect function call per node, each
+ * recursing into its children.  For the common expression types found in
+ * plan quals and target lists (column references, constants, function and
+ * operator calls, AND/OR/NOT, CASE, "scalar op ANY/ALL (array)" and IS
+ * [NOT] NULL) that overhead is often larger than the work done by the
+ * nodes themselves.
+ *
+ * ExecInitExprFlat instead compiles such an expression into a linear array
+ * of ExprSteps, which ExecEvalProgram runs in a single loop.  Each step
+ * stores its result directly where its consumer wants it: arguments of a
+ * function call are written straight into that call's FunctionCallInfo, so
+ * no intermediate results are passed around.  Short-circuiting (AND, OR,
+ * CASE) is done with jumps between steps.  Subexpressions of any other type
+ * are built with ExecInitExpr as usual and evaluated by a single step that
+ * calls ExecEvalExpr on them.  So are "scalar op ANY/ALL (array)" whose
+ * array is a large constant, since execQual.c evaluates those with a hash
+ * table rather than our loop over the elements.
+ *
+ * Portions Copyright (c) 1996-2014, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, Regents of the University of California
+ *
+ *
+ * IDENTIFICATION
+ *	  src/backend/executor/execFlatExpr.c
+ *
+ *-------------------------------------------------------------------------
+ */
+#include "postgres.h"
+
+#include "access/htup_details.h"
+#include "catalog/objectaccess.h"
+#include "executor/executor.h"
+#include "miscadmin.h"
+#include "nodes/nodeFuncs.h"
+#include "optimizer/planmain.h"
+#include "pgstat.h"
+#include "utils/acl.h"
+#include "utils/array.h"
+#include "utils/builtins.h"
+#include "utils/lsyscache.h"
+
+
+/*
+ * Step opcodes.  The _FIRST variants make one-time checks or lookups and
+ * then overwrite their own opcode with the plain variant.
+ */
+typedef enum ExprStepOp
+{
+	EEOP_DONE,
+	EEOP_INNER_VAR_FIRST,
+	EEOP_OUTER_VAR_FIRST,
+	EEOP_SCAN_VAR_FIRST,
+	EEOP_INNER_VAR,
+	EEOP_OUTER_VAR,
+	EEOP_SCAN_VAR,
+	EEOP_CONST,
+	EEOP_FUNC_FIRST,
+	EEOP_FUNC,
+	EEOP_FUNC_STRICT,
+	EEOP_BOOL_AND,
+	EEOP_BOOL_OR,
+	EEOP_BOOL_NOT,
+	EEOP_JUMP,
+	EEOP_JUMP_IF_NOT_TRUE,
+	EEOP_CASE_TESTVAL,
+	EEOP_NULLTEST_ISNULL,
+	EEOP_NULLTEST_ISNOTNULL,
+	EEOP_SCALARARRAYOP,
+	EEOP_EXPRSTATE
+} ExprStepOp;
+
+/*
+ * One step of an expression program.  Every step but EEOP_DONE and the
+ * jumps stores its result into *resvalue and *resnull.  Those point into
+ * separately allocated storage (a FunctionCallInfo's argument arrays, a CASE
+ * test value, or the ExprProgramState itself), never into the step array,
+ * which is reallocated while the program is being built.  For the same
+ * reason jump targets are kept as step indexes.
+ */
+typedef struct ExprStep
+{
+	ExprStepOp	opcode;
+	Datum	   *resvalue;
+	bool	   *resnull;
+	union
+	{
+		/* for EEOP_*_VAR[_FIRST] */
+		struct
+		{
+			AttrNumber	attnum;
+			Oid			vartype;
+		}			var;
+
+		/* for EEOP_CONST */
+		struct
+		{
+			Datum		value;
+			bool		isnull;
+		}			constval;
+
+		/* for EEOP_FUNC_FIRST, EEOP_FUNC, EEOP_FUNC_STRICT */
+		struct
+		{
+			Expr	   *expr;		/* FuncExpr or OpExpr, for fn_expr */
+			Oid			funcid;
+			FmgrInfo   *finfo;		/* looked up on first use */
+			FunctionCallInfo fcinfo;	/* arguments are filled in by the
+										 * preceding steps */
+			int			nargs;
+		}			func;
+
+		/* for EEOP_BOOL_AND, EEOP_BOOL_OR */
+		struct
+		{
+			bool	   *anynull;	/* has any input been NULL so far? */
+			bool		first;		/* is this the first input? */
+			bool		last;		/* is this the last input? */
+			int			jumpdone;	/* where to go once result is known */
+		}			boolexpr;
+
+		/* for EEOP_JUMP, EEOP_JUMP_IF_NOT_TRUE */
+		struct
+		{
+			int			target;
+		}			jump;
+
+		/* for EEOP_CASE_TESTVAL */
+		struct
+		{
+			Datum	   *value;
+			bool	   *isnull;
+		}			casetest;
+
+		/* for EEOP_SCALARARRAYOP */
+		struct
+		{
+			Expr	   *expr;		/* ScalarArrayOpExpr, for fn_expr */
+			Oid			funcid;
+			FmgrInfo   *finfo;		/* looked up on first use */
+			FunctionCallInfo fcinfo;	/* scalar in arg[0], array in arg[1] */
+			bool		useOr;
+			/* element type info, cached across calls */
+			Oid			element_type;
+			int16		typlen;
+			bool		typbyval;
+			char		typalign;
+		}			scalararrayop;
+
+		/* for EEOP_EXPRSTATE */
+		struct
+		{
+			ExprState  *state;
+		}			exprstate;
+	}			d;
+} ExprStep;
+
+/* working state while compiling an expression */
+typedef struct ExprCompileState
+{
+	PlanState  *parent;			/* passed to ExecInitExpr for subtrees */
+	ExprStep   *steps;
+	int			nsteps;
+	int			maxsteps;
+	Datum	   *casevalue;		/* innermost CASE test value, if any */
+	bool	   *casenull;
+} ExprCompileState;
+
+static bool flat_expr_worthwhile(Node *node);
+static bool flat_expr_supported(Node *node, bool incase);
+static bool contain_case_test_walker(Node *node, void *context);
+static int	flat_new_step(ExprCompileState *cs, ExprStepOp opcode,
+			  Datum *resvalue, bool *resnull);
+static void flat_compile(Expr *node, ExprCompileState *cs,
+			 Datum *resvalue, bool *resnull);
+static void flat_compile_func(Expr *node, Oid funcid, Oid inputcollid,
+				  List *args, ExprCompileState *cs,
+				  Datum *resvalue, bool *resnull);
+static void flat_check_var(ExprStep *op, TupleTableSlot *slot);
+static void flat_init_func(Oid funcid, Expr *expr, FmgrInfo *finfo,
+			   ExprContext *econtext);
+static void flat_eval_scalararrayop(ExprStep *op, ExprContext *econtext);
+static Datum ExecEvalProgram(ExprProgramState *pstate, ExprContext *econtext,
+				bool *isNull, ExprDoneCond *isDone);
+
+
+/* ----------------------------------------------------------------
+ *		ExecInitExprFlat
+ *
+ *		Prepare an expression tree for execution, like ExecInitExpr,
+ *		but compile it into an ExprProgramState if it is of a form
+ *		that gains from being flattened.  Otherwise this is just
+ *		ExecInitExpr.
+ *
+ *		Callers must not assume anything about the node type of the
+ *		result: unlike ExecInitExpr, the top-level ExprState need not
+ *		correspond to the top-level expression node.
+ * ----------------------------------------------------------------
+ */
+ExprState *
+ExecInitExprFlat(Expr *node, PlanState *parent)
+{
+	ExprProgramState *pstate;
+	ExprCompileState cs;
+
+	/*
+	 * Check the whole tree before building anything, since initializing
+	 * subexpressions has side effects (such as registering Aggrefs with
+	 * their parent Agg node) that we couldn't undo if we then had to fall
+	 * back to the ordinary representation.
+	 */
+	if (node == NULL ||
+		!flat_expr_worthwhile((Node *) node) ||
+		expression_returns_set((Node *) node) ||
+		!flat_expr_supported((Node *) node, false))
+		return ExecInitExpr(node, parent);
+
+	pstate = makeNode(ExprProgramState);
+	pstate->xprstate.expr = node;
+	pstate->xprstate.evalfunc = (ExprStateEvalFunc) ExecEvalProgram;
+
+	cs.parent = parent;
+	cs.maxsteps = 16;
+	cs.steps = (ExprStep *) palloc(cs.maxsteps * sizeof(ExprStep));
+	cs.nsteps = 0;
+	cs.casevalue = NULL;
+	cs.casenull = NULL;
+
+	flat_compile(node, &cs, &pstate->resvalue, &pstate->resnull);
+	flat_new_step(&cs, EEOP_DONE, NULL, NULL);
+
+	pstate->steps = cs.steps;
+	pstate->nsteps = cs.nsteps;
+
+	return (ExprState *) pstate;
+}
+
+/* ----------------------------------------------------------------
+ *		ExecInitQual
+ *
+ *		Prepare an implicitly-ANDed qual list for ExecQual.  Each
+ *		clause is compiled separately, so that ExecQual can still
+ *		stop at the first clause that fails.
+ * ----------------------------------------------------------------
+ */
+List *
+ExecInitQual(List *qual, PlanState *parent)
+{
+	List	   *result = NIL;
+	ListCell   *lc;
+
+	foreach(lc, qual)
+	{
+		Expr	   *clause = (Expr *) lfirst(lc);
+
+		result = lappend(result, ExecInitExprFlat(clause, parent));
+	}
+
+	return result;
+}
+
+/*
+ * Is it worth flattening this expression?  A bare column reference or
+ * constant is already evaluated about as fast as it can be, and anything
+ * else at the top would be handled by a single EEOP_EXPRSTATE step anyway.
+ */
+static bool
+flat_expr_worthwhile(Node *node)
+{
+	while (IsA(node, RelabelType))
+		node = (Node *) ((RelabelType *) node)->arg;
+
+	switch (nodeTag(node))
+	{
+		case T_FuncExpr:
+		case T_OpExpr:
+		case T_BoolExpr:
+		case T_CaseExpr:
+			return true;
+		case T_ScalarArrayOpExpr:
+			return !ExecScalarArrayOpUsesHash((ScalarArrayOpExpr *) node);
+		case T_NullTest:
+			return !((NullTest *) node)->argisrow;
+		default:
+			return false;
+	}
+}
+
+/*
+ * Can this expression be flattened?  incase is true if we're within the
+ * scope of a CASE with a test value.
+ *
+ * Node types we don't compile natively are always acceptable, since they're
+ * evaluated as ExprState subtrees, except that a CaseTestExpr inside such a
+ * subtree would expect to find the CASE test value in the ExprContext,
+ * where our own CASE steps don't put it.
+ */
+static bool
+flat_expr_supported(Node *node, bool incase)
+{
+	ListCell   *lc;
+
+	/* Guard against stack overflow due to overly complex expressions */
+	check_stack_depth();
+
+	if (node == NULL)
+		return true;
+
+	switch (nodeTag(node))
+	{
+		case T_Var:
+		case T_Const:
+			return true;
+
+		case T_CaseTestExpr:
+			return incase;
+
+		case T_RelabelType:
+			return flat_expr_supported((Node *) ((RelabelType *) node)->arg,
+									   incase);
+
+		case T_ScalarArrayOpExpr:
+			/* hashed ones are evaluated as a subtree */
+			if (ExecScalarArrayOpUsesHash((ScalarArrayOpExpr *) node))
+				return !(incase && contain_case_test_walker(node, NULL));
+			/* FALL THRU */
+
+		case T_FuncExpr:
+		case T_OpExpr:
+		case T_BoolExpr:
+			{
+				List	   *args;
+
+				if (IsA(node, FuncExpr))
+					args = ((FuncExpr *) node)->args;
+				else if (IsA(node, OpExpr))
+					args = ((OpExpr *) node)->args;
+				else if (IsA(node, ScalarArrayOpExpr))
+					args = ((ScalarArrayOpExpr *) node)->args;
+				else
+					args = ((BoolExpr *) node)->args;
+
+				/* let ExecInitExpr's path report this at run time */
+				if (list_length(args) > FUNC_MAX_ARGS)
+					return false;
+
+				foreach(lc, args)
+				{
+					if (!flat_expr_supported((Node *) lfirst(lc), incase))
+						return false;
+				}
+				return true;
+			}
+
+		case T_CaseExpr:
+			{
+				CaseExpr   *caseexpr = (CaseExpr *) node;
+
+				if (!flat_expr_supported((Node *) caseexpr->arg, incase))
+					return false;
+				if (caseexpr->arg != NULL)
+					incase = true;
+
+				foreach(lc, caseexpr->args)
+				{
+					CaseWhen   *when = (CaseWhen *) lfirst(lc);
+
+					if (!flat_expr_supported((Node *) when->expr, incase) ||
+						!flat_expr_supported((Node *) when->result, incase))
+						return false;
+				}
+				return flat_expr_supported((Node *) caseexpr->defresult,
+										   incase);
+			}
+
+		case T_NullTest:
+			if (!((NullTest *) node)->argisrow)
+				return flat_expr_supported((Node *) ((NullTest *) node)->arg,
+										   incase);
+			/* row-valued tests are evaluated as a subtree */
+			/* FALL THRU */
+
+		default:
+			if (incase && contain_case_test_walker(node, NULL))
+				return false;
+			return true;
+	}
+}
+
+static bool
+contain_case_test_walker(Node *node, void *context)
+{
+	if (node == NULL)
+		return false;
+	if (IsA(node, CaseTestExpr))
+		return true;
+	return expression_tree_walker(node, contain_case_test_walker, context);
+}
+
+/*
+ * Append a step to the program being built, returning its index.
+ */
+static int
+flat_new_step(ExprCompileState *cs, ExprStepOp opcode,
+			  Datum *resvalue, bool *resnull)
+{
+	ExprStep   *step;
+
+	if (cs->nsteps >= cs->maxsteps)
+	{
+		cs->maxsteps *= 2;
+		cs->steps = (ExprStep *) repalloc(cs->steps,
+										  cs->maxsteps * sizeof(ExprStep));
+	}
+
+	step = &cs->steps[cs->nsteps];
+	memset(step, 0, sizeof(ExprStep));
+	step->opcode = opcode;
+	step->resvalue = resvalue;
+	step->resnull = resnull;
+
+	return cs->nsteps++;
+}
+
+/*
+ * Append the steps to evaluate node, leaving its result in
+ * *resvalue and *resnull.  node must have passed flat_expr_supported.
+ */
+static void
+flat_compile(Expr *node, ExprCompileState *cs, Datum *resvalue, bool *resnull)
+{
+	int			s;
+
+	/* Guard against stack overflow due to overly complex expressions */
+	check_stack_depth();
+
+	switch (nodeTag(node))
+	{
+		case T_Var:
+			{
+				Var		   *variable = (Var *) node;
+				ExprStepOp	opcode;
+
+				/* whole-row references are left to execQual.c */
+				if (variable->varattno == InvalidAttrNumber)
+				{
+					s = flat_new_step(cs, EEOP_EXPRSTATE, resvalue, resnull);
+					cs->steps[s].d.exprstate.state =
+						ExecInitExpr(node, cs->parent);
+					break;
+				}
+
+				switch (variable->varno)
+				{
+					case INNER_VAR:
+						opcode = EEOP_INNER_VAR_FIRST;
+						break;
+					case OUTER_VAR:
+						opcode = EEOP_OUTER_VAR_FIRST;
+						break;
+					default:
+						opcode = EEOP_SCAN_VAR_FIRST;
+						break;
+				}
+				s = flat_new_step(cs, opcode, resvalue, resnull);
+				cs->steps[s].d.var.attnum = variable->varattno;
+				cs->steps[s].d.var.vartype = variable->vartype;
+			}
+			break;
+
+		case T_Const:
+			{
+				Const	   *con = (Const *) node;
+
+				s = flat_new_step(cs, EEOP_CONST, resvalue, resnull);
+				cs->steps[s].d.constval.value = con->constvalue;
+				cs->steps[s].d.constval.isnull = con->constisnull;
+			}
+			break;
+
+		case T_CaseTestExpr:
+			Assert(cs->casevalue != NULL);
+			s = flat_new_step(cs, EEOP_CASE_TESTVAL, resvalue, resnull);
+			cs->steps[s].d.casetest.value = cs->casevalue;
+			cs->steps[s].d.casetest.isnull = cs->casenull;
+			break;
+
+		case T_RelabelType:
+			/* a no-op at run time */
+			flat_compile(((RelabelType *) node)->arg, cs, resvalue, resnull);
+			break;
+
+		case T_FuncExpr:
+			{
+				FuncExpr   *funcexpr = (FuncExpr *) node;
+
+				flat_compile_func(node, funcexpr->funcid,
+								  funcexpr->inputcollid, funcexpr->args,
+								  cs, resvalue, resnull);
+			}
+			break;
+
+		case T_OpExpr:
+			{
+				OpExpr	   *opexpr = (OpExpr *) node;
+
+				set_opfuncid(opexpr);
+				flat_compile_func(node, opexpr->opfuncid,
+								  opexpr->inputcollid, opexpr->args,
+								  cs, resvalue, resnull);
+			}
+			break;
+
+		case T_ScalarArrayOpExpr:
+			{
+				ScalarArrayOpExpr *opexpr = (ScalarArrayOpExpr *) node;
+				FmgrInfo   *finfo;
+				FunctionCallInfo fcinfo;
+
+				/* leave hashed evaluation to execQual.c */
+				if (ExecScalarArrayOpUsesHash(opexpr))
+				{
+					s = flat_new_step(cs, EEOP_EXPRSTATE, resvalue, resnull);
+					cs->steps[s].d.exprstate.state =
+						ExecInitExpr(node, cs->parent);
+					break;
+				}
+
+				Assert(list_length(opexpr->args) == 2);
+				set_sa_opfuncid(opexpr);
+
+				finfo = (FmgrInfo *) palloc0(sizeof(FmgrInfo));
+				fcinfo = (FunctionCallInfo) palloc0(sizeof(FunctionCallInfoData));
+				InitFunctionCallInfoData(*fcinfo, finfo, 2,
+										 opexpr->inputcollid, NULL, NULL);
+
+				flat_compile((Expr *) linitial(opexpr->args), cs,
+							 &fcinfo->arg[0], &fcinfo->argnull[0]);
+				flat_compile((Expr *) lsecond(opexpr->args), cs,
+							 &fcinfo->arg[1], &fcinfo->argnull[1]);
+
+				s = flat_new_step(cs, EEOP_SCALARARRAYOP, resvalue, resnull);
+				cs->steps[s].d.scalararrayop.expr = node;
+				cs->steps[s].d.scalararrayop.funcid = opexpr->opfuncid;
+				cs->steps[s].d.scalararrayop.finfo = finfo;
+				cs->steps[s].d.scalararrayop.fcinfo = fcinfo;
+				cs->steps[s].d.scalararrayop.useOr = opexpr->useOr;
+				cs->steps[s].d.scalararrayop.element_type = InvalidOid;
+			}
+			break;
+
+		case T_BoolExpr:
+			{
+				BoolExpr   *boolexpr = (BoolExpr *) node;
+
+				if (boolexpr->boolop == NOT_EXPR)
+				{
+					Assert(list_length(boolexpr->args) == 1);
+					flat_compile((Expr *) linitial(boolexpr->args), cs,
+								 resvalue, resnull);
+					flat_new_step(cs, EEOP_BOOL_NOT, resvalue, resnull);
+				}
+				else
+				{
+					ExprStepOp	opcode;
+					bool	   *anynull;
+					List	   *adjust = NIL;
+					int			nargs = list_length(boolexpr->args);
+					int			i = 0;
+					ListCell   *lc;
+
+					opcode = (boolexpr->boolop == AND_EXPR) ?
+						EEOP_BOOL_AND : EEOP_BOOL_OR;
+					anynull = (bool *) palloc(sizeof(bool));
+
+					/*
+					 * Each input is evaluated into our result location, and
+					 * is followed by a step that decides whether the result
+					 * is already known.  Their jumps all go to the end.
+					 */
+					foreach(lc, boolexpr->args)
+					{
+						flat_compile((Expr *) lfirst(lc), cs,
+									 resvalue, resnull);
+						s = flat_new_step(cs, opcode, resvalue, resnull);
+						cs->steps[s].d.boolexpr.anynull = anynull;
+						cs->steps[s].d.boolexpr.first = (i == 0);
+						cs->steps[s].d.boolexpr.last = (i == nargs - 1);
+						adjust = lappend_int(adjust, s);
+						i++;
+					}
+
+					foreach(lc, adjust)
+						cs->steps[lfirst_int(lc)].d.boolexpr.jumpdone =
+							cs->nsteps;
+					list_free(adjust);
+				}
+			}
+			break;
+
+		case T_CaseExpr:
+			{
+				CaseExpr   *caseexpr = (CaseExpr *) node;
+				Datum	   *save_casevalue = cs->casevalue;
+				bool	   *save_casenull = cs->casenull;
+				List	   *adjust = NIL;
+				ListCell   *lc;
+
+				/*
+				 * The test value, if any, gets storage of its own; the
+				 * CaseTestExprs in the WHEN clauses refer to it.
+				 */
+				if (caseexpr->arg != NULL)
+				{
+					Datum	   *casevalue = (Datum *) palloc(sizeof(Datum));
+					bool	   *casenull = (bool *) palloc(sizeof(bool));
+
+					flat_compile(caseexpr->arg, cs, casevalue, casenull);
+					cs->casevalue = casevalue;
+					cs->casenull = casenull;
+				}
+
+				foreach(lc, caseexpr->args)
+				{
+					CaseWhen   *when = (CaseWhen *) lfirst(lc);
+					int			whenstep;
+
+					/* the condition goes into our result location for now */
+					flat_compile(when->expr, cs, resvalue, resnull);
+					whenstep = flat_new_step(cs, EEOP_JUMP_IF_NOT_TRUE,
+											 resvalue, resnull);
+
+					flat_compile(when->result, cs, resvalue, resnull);
+					s = flat_new_step(cs, EEOP_JUMP, NULL, NULL);
+					adjust = lappend_int(adjust, s);
+
+					/* if the condition isn't true, go on to the next one */
+					cs->steps[whenstep].d.jump.target = cs->nsteps;
+				}
+
+				if (caseexpr->defresult)
+					flat_compile(caseexpr->defresult, cs, resvalue, resnull);
+				else
+				{
+					s = flat_new_step(cs, EEOP_CONST, resvalue, resnull);
+					cs->steps[s].d.constval.value = (Datum) 0;
+					cs->steps[s].d.constval.isnull = true;
+				}
+
+				foreach(lc, adjust)
+					cs->steps[lfirst_int(lc)].d.jump.target = cs->nsteps;
+				list_free(adjust);
+
+				cs->casevalue = save_casevalue;
+				cs->casenull = save_casenull;
+			}
+			break;
+
+		case T_NullTest:
+			{
+				NullTest   *ntest = (NullTest *) node;
+
+				if (!ntest->argisrow)
+				{
+					flat_compile(ntest->arg, cs, resvalue, resnull);
+					flat_new_step(cs, (ntest->nulltesttype == IS_NULL) ?
+								  EEOP_NULLTEST_ISNULL :
+								  EEOP_NULLTEST_ISNOTNULL,
+								  resvalue, resnull);
+					break;
+				}
+			}
+			/* FALL THRU */
+
+		default:
+			s = flat_new_step(cs, EEOP_EXPRSTATE, resvalue, resnull);
+			cs->steps[s].d.exprstate.state = ExecInitExpr(node, cs->parent);
+			break;
+	}
+}
+
+/*
+ * Append the steps for a function or operator call.  The arguments are
+ * evaluated straight into the call's FunctionCallInfo.
+ */
+static void
+flat_compile_func(Expr *node, Oid funcid, Oid inputcollid, List *args,
+				  ExprCompileState *cs, Datum *resvalue, bool *resnull)
+{
+	int			nargs = list_length(args);
+	FmgrInfo   *finfo;
+	FunctionCallInfo fcinfo;
+	ListCell   *lc;
+	int			i;
+	int			s;
+
+	/* function lookup and permission check happen on first execution */
+	finfo = (FmgrInfo *) palloc0(sizeof(FmgrInfo));
+	fcinfo = (FunctionCallInfo) palloc0(sizeof(FunctionCallInfoData));
+	InitFunctionCallInfoData(*fcinfo, finfo, nargs, inputcollid, NULL, NULL);
+
+	i = 0;
+	foreach(lc, args)
+	{
+		flat_compile((Expr *) lfirst(lc), cs,
+					 &fcinfo->arg[i], &fcinfo->argnull[i]);
+		i++;
+	}
+
+	s = flat_new_step(cs, EEOP_FUNC_FIRST, resvalue, resnull);
+	cs->steps[s].d.func.expr = node;
+	cs->steps[s].d.func.funcid = funcid;
+	cs->steps[s].d.func.finfo = finfo;
+	cs->steps[s].d.func.fcinfo = fcinfo;
+	cs->steps[s].d.func.nargs = nargs;
+}
+
+/*
+ * One-time checks for a column reference; see ExecEvalScalarVar.
+ */
+static void
+flat_check_var(ExprStep *op, TupleTableSlot *slot)
+{
+	AttrNumber	attnum = op->d.var.attnum;
+
+	if (attnum > 0)
+	{
+		TupleDesc	slot_tupdesc = slot->tts_tupleDescriptor;
+		Form_pg_attribute attr;
+
+		if (attnum > slot_tupdesc->natts)		/* should never happen */
+			elog(ERROR, "attribute number %d exceeds number of columns %d",
+				 attnum, slot_tupdesc->natts);
+
+		attr = slot_tupdesc->attrs[attnum - 1];
+
+		/* can't check type if dropped, since atttypid is probably 0 */
+		if (!attr->attisdropped)
+		{
+			if (op->d.var.vartype != attr->atttypid)
+				ereport(ERROR,
+						(errmsg("attribute %d has wrong type", attnum),
+						 errdetail("Table has type %s, but query expects %s.",
+								   format_type_be(attr->atttypid),
+								   format_type_be(op->d.var.vartype))));
+		}
+	}
+}
+
+/*
+ * Look up a function on first use; see init_fcache.
+ */
+static void
+flat_init_func(Oid funcid, Expr *expr, FmgrInfo *finfo,
+			   ExprContext *econtext)
+{
+	AclResult	aclresult;
+
+	/* Check permission to call function */
+	aclresult = pg_proc_aclcheck(funcid, GetUserId(), ACL_EXECUTE);
+	if (aclresult != ACLCHECK_OK)
+		aclcheck_error(aclresult, ACL_KIND_PROC, get_func_name(funcid));
+	InvokeFunctionExecuteHook(funcid);
+
+	fmgr_info_cxt(funcid, finfo, econtext->ecxt_per_query_memory);
+	fmgr_info_set_expr((Node *) expr, finfo);
+
+	/* expression_returns_set said no */
+	Assert(!finfo->fn_retset);
+}
+
+/*
+ * Evaluate "scalar op ANY/ALL (array)", whose two inputs have already been
+ * evaluated into the step's FunctionCallInfo.  This follows
+ * ExecEvalScalarArrayOp.
+ */
+static void
+flat_eval_scalararrayop(ExprStep *op, ExprContext *econtext)
+{
+	FunctionCallInfo fcinfo = op->d.scalararrayop.fcinfo;
+	bool		useOr = op->d.scalararrayop.useOr;
+	bool		strict;
+	ArrayType  *arr;
+	int			nitems;
+	Datum		result;
+	bool		resultnull;
+	int			i;
+	int16		typlen;
+	bool		typbyval;
+	char		typalign;
+	char	   *s;
+	bits8	   *bitmap;
+	int			bitmask;
+
+	if (op->d.scalararrayop.finfo->fn_oid == InvalidOid)
+		flat_init_func(op->d.scalararrayop.funcid, op->d.scalararrayop.expr,
+					   op->d.scalararrayop.finfo, econtext);
+	strict = op->d.scalararrayop.finfo->fn_strict;
+
+	/*
+	 * If the array is NULL then we return NULL --- it's not very meaningful
+	 * to do anything else, even if the operator isn't strict.
+	 */
+	if (fcinfo->argnull[1])
+	{
+		*op->resvalue = (Datum) 0;
+		*op->resnull = true;
+		return;
+	}
+	/* Else okay to fetch and detoast the array */
+	arr = DatumGetArrayTypeP(fcinfo->arg[1]);
+
+	/*
+	 * If the array is empty, we return either FALSE or TRUE per the useOr
+	 * flag, whether or not the scalar is NULL.
+	 */
+	nitems = ArrayGetNItems(ARR_NDIM(arr), ARR_DIMS(arr));
+	if (nitems <= 0)
+	{
+		*op->resvalue = BoolGetDatum(!useOr);
+		*op->resnull = false;
+		return;
+	}
+
+	/*
+	 * If the scalar is NULL, and the function is strict, return NULL; no
+	 * point in iterating the loop.
+	 */
+	if (fcinfo->argnull[0] && strict)
+	{
+		*op->resvalue = (Datum) 0;
+		*op->resnull = true;
+		return;
+	}
+
+	/* look up the element type info only when it changes */
+	if (op->d.scalararrayop.element_type != ARR_ELEMTYPE(arr))
+	{
+		get_typlenbyvalalign(ARR_ELEMTYPE(arr),
+							 &op->d.scalararrayop.typlen,
+							 &op->d.scalararrayop.typbyval,
+							 &op->d.scalararrayop.typalign);
+		op->d.scalararrayop.element_type = ARR_ELEMTYPE(arr);
+	}
+	typlen = op->d.scalararrayop.typlen;
+	typbyval = op->d.scalararrayop.typbyval;
+	typalign = op->d.scalararrayop.typalign;
+
+	result = BoolGetDatum(!useOr);
+	resultnull = false;
+
+	/* Loop over the array elements */
+	s = (char *) ARR_DATA_PTR(arr);
+	bitmap = ARR_NULLBITMAP(arr);
+	bitmask = 1;
+
+	for (i = 0; i < nitems; i++)
+	{
+		Datum		thisresult;
+
+		/* Get array element, checking for NULL */
+		if (bitmap && (*bitmap & bitmask) == 0)
+		{
+			fcinfo->arg[1] = (Datum) 0;
+			fcinfo->argnull[1] = true;
+		}
+		else
+		{
+			fcinfo->arg[1] = fetch_att(s, typbyval, typlen);
+			fcinfo->argnull[1] = false;
+			s = att_addlength_pointer(s, typlen, s);
+			s = (char *) att_align_nominal(s, typalign);
+		}
+
+		/* Call comparison function */
+		if (fcinfo->argnull[1] && strict)
+		{
+			fcinfo->isnull = true;
+			thisresult = (Datum) 0;
+		}
+		else
+		{
+			fcinfo->isnull = false;
+			thisresult = FunctionCallInvoke(fcinfo);
+		}
+
+		/* Combine results per OR or AND semantics */
+		if (fcinfo->isnull)
+			resultnull = true;
+		else if (useOr)
+		{
+			if (DatumGetBool(thisresult))
+			{
+				result = BoolGetDatum(true);
+				resultnull = false;
+				break;			/* needn't look at any more elements */
+			}
+		}
+		else
+		{
+			if (!DatumGetBool(thisresult))
+			{
+				result = BoolGetDatum(false);
+				resultnull = false;
+				break;			/* needn't look at any more elements */
+			}
+		}
+
+		/* advance bitmap pointer if any */
+		if (bitmap)
+		{
+			bitmask <<= 1;
+			if (bitmask == 0x100)
+			{
+				bitmap++;
+				bitmask = 1;
+			}
+		}
+	}
+
+	*op->resvalue = result;
+	*op->resnull = resultnull;
+}
+
+/* ----------------------------------------------------------------
+ *		ExecEvalProgram
+ *
+ *		Evaluate an expression compiled by ExecInitExprFlat.
+ * ----------------------------------------------------------------
+ */
+static Datum
+ExecEvalProgram(ExprProgramState *pstate, ExprContext *econtext,
+				bool *isNull, ExprDoneCond *isDone)
+{
+	ExprStep   *steps = pstate->steps;
+	ExprStep   *op = steps;
+
+	/* Guard against stack overflow due to overly complex expressions */
+	check_stack_depth();
+
+	if (isDone)
+		*isDone = ExprSingleResult;
+
+	for (;;)
+	{
+		switch (op->opcode)
+		{
+			case EEOP_DONE:
+				*isNull = pstate->resnull;
+				return pstate->resvalue;
+
+			case EEOP_INNER_VAR_FIRST:
+				flat_check_var(op, econtext->ecxt_innertuple);
+				op->opcode = EEOP_INNER_VAR;
+				/* FALL THRU */
+
+			case EEOP_INNER_VAR:
+				*op->resvalue = slot_getattr(econtext->ecxt_innertuple,
+											 op->d.var.attnum, op->resnull);
+				break;
+
+			case EEOP_OUTER_VAR_FIRST:
+				flat_check_var(op, econtext->ecxt_outertuple);
+				op->opcode = EEOP_OUTER_VAR;
+				/* FALL THRU */
+
+			case EEOP_OUTER_VAR:
+				*op->resvalue = slot_getattr(econtext->ecxt_outertuple,
+											 op->d.var.attnum, op->resnull);
+				break;
+
+			case EEOP_SCAN_VAR_FIRST:
+				flat_check_var(op, econtext->ecxt_scantuple);
+				op->opcode = EEOP_SCAN_VAR;
+				/* FALL THRU */
+
+			case EEOP_SCAN_VAR:
+				*op->resvalue = slot_getattr(econtext->ecxt_scantuple,
+											 op->d.var.attnum, op->resnull);
+				break;
+
+			case EEOP_CONST:
+				*op->resvalue = op->d.constval.value;
+				*op->resnull = op->d.constval.isnull;
+				break;
+
+			case EEOP_FUNC_FIRST:
+				flat_init_func(op->d.func.funcid, op->d.func.expr,
+							   op->d.func.finfo, econtext);
+				op->opcode = op->d.func.finfo->fn_strict ?
+					EEOP_FUNC_STRICT : EEOP_FUNC;
+				continue;		/* run this step again */
+
+			case EEOP_FUNC_STRICT:
+				{
+					FunctionCallInfo fcinfo = op->d.func.fcinfo;
+					int			i;
+
+					/* a strict function yields NULL on any NULL input */
+					for (i = 0; i < op->d.func.nargs; i++)
+					{
+						if (fcinfo->argnull[i])
+							break;
+					}
+					if (i < op->d.func.nargs)
+					{
+						*op->resvalue = (Datum) 0;
+						*op->resnull = true;
+						break;
+					}
+				}
+				/* FALL THRU */
+
+			case EEOP_FUNC:
+				{
+					FunctionCallInfo fcinfo = op->d.func.fcinfo;
+					PgStat_FunctionCallUsage fcusage;
+
+					pgstat_init_function_usage(fcinfo, &fcusage);
+
+					fcinfo->isnull = false;
+					*op->resvalue = FunctionCallInvoke(fcinfo);
+					*op->resnull = fcinfo->isnull;
+
+					pgstat_end_function_usage(&fcusage, true);
+				}
+				break;
+
+			case EEOP_BOOL_AND:
+				if (op->d.boolexpr.first)
+					*op->d.boolexpr.anynull = false;
+
+				if (*op->resnull)
+					*op->d.boolexpr.anynull = true;
+				else if (!DatumGetBool(*op->resvalue))
+				{
+					/* result is already FALSE, skip the remaining inputs */
+					op = &steps[op->d.boolexpr.jumpdone];
+					continue;
+				}
+
+				if (op->d.boolexpr.last)
+				{
+					/* no input was FALSE, so result is NULL or TRUE */
+					if (*op->d.boolexpr.anynull)
+					{
+						*op->resvalue = (Datum) 0;
+						*op->resnull = true;
+					}
+					else
+					{
+						*op->resvalue = BoolGetDatum(true);
+						*op->resnull = false;
+					}
+				}
+				break;
+
+			case EEOP_BOOL_OR:
+				if (op->d.boolexpr.first)
+					*op->d.boolexpr.anynull = false;
+
+				if (*op->resnull)
+					*op->d.boolexpr.anynull = true;
+				else if (DatumGetBool(*op->resvalue))
+				{
+					/* result is already TRUE, skip the remaining inputs */
+					op = &steps[op->d.boolexpr.jumpdone];
+					continue;
+				}
+
+				if (op->d.boolexpr.last)
+				{
+					/* no input was TRUE, so result is NULL or FALSE */
+					if (*op->d.boolexpr.anynull)
+					{
+						*op->resvalue = (Datum) 0;
+						*op->resnull = true;
+					}
+					else
+					{
+						*op->resvalue = BoolGetDatum(false);
+						*op->resnull = false;
+					}
+				}
+				break;
+
+			case EEOP_BOOL_NOT:
+				/* NOT NULL is NULL, so leave a NULL input alone */
+				if (!*op->resnull)
+					*op->resvalue = BoolGetDatum(!DatumGetBool(*op->resvalue));
+				break;
+
+			case EEOP_JUMP:
+				op = &steps[op->d.jump.target];
+				continue;
+
+			case EEOP_JUMP_IF_NOT_TRUE:
+				if (*op->resnull || !DatumGetBool(*op->resvalue))
+				{
+					op = &steps[op->d.jump.target];
+					continue;
+				}
+				break;
+
+			case EEOP_CASE_TESTVAL:
+				*op->resvalue = *op->d.casetest.value;
+				*op->resnull = *op->d.casetest.isnull;
+				break;
+
+			case EEOP_NULLTEST_ISNULL:
+				*op->resvalue = BoolGetDatum(*op->resnull);
+				*op->resnull = false;
+				break;
+
+			case EEOP_NULLTEST_ISNOTNULL:
+				*op->resvalue = BoolGetDatum(!*op->resnull);
+				*op->resnull = false;
+				break;
+
+			case EEOP_SCALARARRAYOP:
+				flat_eval_scalararrayop(op, econtext);
+				break;
+
+			case EEOP_EXPRSTATE:
+				*op->resvalue = ExecEvalExpr(op->d.exprstate.state, econtext,
+											 op->resnull, NULL);
+				break;
+
+			default:
+				elog(ERROR, "unrecognized expression step: %d",
+					 (int) op->opcode);
+				break;
+		}
+
+		op++;
+	}
+}
@@ -20,6 +20,7 @@
  *	 INTERFACE ROUTINES
  *		ExecInitNode	-		initialize a plan node and its subplans
  *		ExecProcNode	-		get a tuple by executing the plan node
+ *		ExecProcNodeBatch -		get a batch of tuples from the plan node
  *		ExecEndNode		-		shut down a plan node and its subplans
  *
  *	 NOTES
@@ -90,6 +91,7 @@
 #include "executor/nodeGroup.h"
 #include "executor/nodeHash.h"
 #include "executor/nodeHashjoin.h"
+#include "executor/nodeIncrementalSort.h"
 #include "executor/nodeIndexonlyscan.h"
 #include "executor/nodeIndexscan.h"
 #include "executor/nodeLimit.h"
@@ -99,8 +101,10 @@
 #include "executor/nodeMergejoin.h"
 #include "executor/nodeModifyTable.h"
 #include "executor/nodeNestloop.h"
+#include "executor/nodeParallelSeqscan.h"
 #include "executor/nodeRecursiveunion.h"
 #include "executor/nodeResult.h"
+#include "executor/nodeResultCache.h"
 #include "executor/nodeSeqscan.h"
 #include "executor/nodeSetOp.h"
 #include "executor/nodeSort.h"
@@ -111,6 +115,7 @@
 #include "executor/nodeValuesscan.h"
 #include "executor/nodeWindowAgg.h"
 #include "executor/nodeWorktablescan.h"
+#include "executor/tuplebatch.h"
 #include "miscadmin.h"
 
 
@@ -189,6 +194,11 @@ ExecInitNode(Plan *node, EState *estate, int eflags)
 												   estate, eflags);
 			break;
 
+		case T_ParallelSeqScan:
+			result = (PlanState *) ExecInitParallelSeqScan((ParallelSeqScan *) node,
+														   estate, eflags);
+			break;
+
 		case T_IndexScan:
 			result = (PlanState *) ExecInitIndexScan((IndexScan *) node,
 													 estate, eflags);
@@ -270,11 +280,21 @@ ExecInitNode(Plan *node, EState *estate, int eflags)
 													estate, eflags);
 			break;
 
+		case T_ResultCache:
+			result = (PlanState *) ExecInitResultCache((ResultCache *) node,
+													   estate, eflags);
+			break;
+
 		case T_Sort:
 			result = (PlanState *) ExecInitSort((Sort *) node,
 												estate, eflags);
 			break;
 
+		case T_IncrementalSort:
+			result = (PlanState *) ExecInitIncrementalSort((IncrementalSort *) node,
+														   estate, eflags);
+			break;
+
 		case T_Group:
 			result = (PlanState *) ExecInitGroup((Group *) node,
 												 estate, eflags);
@@ -400,6 +420,10 @@ ExecProcNode(PlanState *node)
 			result = ExecSeqScan((SeqScanState *) node);
 			break;
 
+		case T_ParallelSeqScanState:
+			result = ExecParallelSeqScan((ParallelSeqScanState *) node);
+			break;
+
 		case T_IndexScanState:
 			result = ExecIndexScan((IndexScanState *) node);
 			break;
@@ -464,10 +488,18 @@ ExecProcNode(PlanState *node)
 			result = ExecMaterial((MaterialState *) node);
 			break;
 
+		case T_ResultCacheState:
+			result = ExecResultCache((ResultCacheState *) node);
+			break;
+
 		case T_SortState:
 			result = ExecSort((SortState *) node);
 			break;
 
+		case T_IncrementalSortState:
+			result = ExecIncrementalSort((IncrementalSortState *) node);
+			break;
+
 		case T_GroupState:
 			result = ExecGroup((GroupState *) node);
 			break;
@@ -513,6 +545,82 @@ ExecProcNode(PlanState *node)
 }
 
 
+/* ----------------------------------------------------------------
+ *		ExecSupportsBatch
+ *
+ *		Can the node fill a TupleBatch natively?  ExecProcNodeBatch
+ *		works on any node, but for the others it merely collects
+ *		tuples from ExecProcNode, which saves nothing.
+ * ----------------------------------------------------------------
+ */
+bool
+ExecSupportsBatch(PlanState *node)
+{
+	switch (nodeTag(node))
+	{
+		case T_SeqScanState:
+			return ExecSeqScanSupportsBatch((SeqScanState *) node);
+
+		default:
+			return false;
+	}
+}
+
+/* ----------------------------------------------------------------
+ *		ExecProcNodeBatch
+ *
+ *		Execute the given node to fill a batch with the next tuples
+ *		it produces.  Returns the number of tuples in the batch, zero
+ *		meaning that the node is exhausted.
+ *
+ *		The batch's previous contents are discarded.
+ * ----------------------------------------------------------------
+ */
+int
+ExecProcNodeBatch(PlanState *node, TupleBatch *batch)
+{
+	if (!ExecSupportsBatch(node))
+	{
+		TupleTableSlot *slot;
+
+		/* Fill the batch one tuple at a time, copying the values */
+		TupleBatchReset(batch);
+		while (batch->nrows < batch->maxrows)
+		{
+			slot = ExecProcNode(node);
+			if (TupIsNull(slot))
+				break;
+			TupleBatchAddSlot(batch, slot, batch->ncols, true);
+		}
+		return batch->nrows;
+	}
+
+	CHECK_FOR_INTERRUPTS();
+
+	if (node->chgParam != NULL) /* something changed */
+		ExecReScan(node);		/* let ReScan handle this */
+
+	if (node->instrument)
+		InstrStartNode(node->instrument);
+
+	switch (nodeTag(node))
+	{
+		case T_SeqScanState:
+			ExecSeqScanBatch((SeqScanState *) node, batch);
+			break;
+
+		default:
+			elog(ERROR, "unrecognized node type: %d", (int) nodeTag(node));
+			break;
+	}
+
+	if (node->instrument)
+		InstrStopNode(node->instrument, batch->nrows);
+
+	return batch->nrows;
+}
+
+
 /* ----------------------------------------------------------------
  *		MultiExecProcNode
  *
@@ -634,6 +742,10 @@ ExecEndNode(PlanState *node)
 			ExecEndSeqScan((SeqScanState *) node);
 			break;
 
+		case T_ParallelSeqScanState:
+			ExecEndParallelSeqScan((ParallelSeqScanState *) node);
+			break;
+
 		case T_IndexScanState:
 			ExecEndIndexScan((IndexScanState *) node);
 			break;
@@ -700,10 +812,18 @@ ExecEndNode(PlanState *node)
 			ExecEndMaterial((MaterialState *) node);
 			break;
 
+		case T_ResultCacheState:
+			ExecEndResultCache((ResultCacheState *) node);
+			break;
+
 		case T_SortState:
 			ExecEndSort((SortState *) node);
 			break;
 
+		case T_IncrementalSortState:
+			ExecEndIncrementalSort((IncrementalSortState *) node);
+			break;
+
 		case T_GroupState:
 			ExecEndGroup((GroupState *) node);
 			break;
@@ -0,0 +1,189 @@
+/*-------------------------------------------------------------------------
+ *
+ * execPrune.c
+ *	  run-time pruning of the subplans of Append and MergeAppend nodes
+ *
+ * The planner removes inheritance children whose CHECK constraints
+ * contradict the query's restriction clauses, but it can only do that with
+ * clauses that compare against constants.  Clauses that compare against
+ * Params, such as the parameters of a generic prepared plan, the outputs of
+ * initplans, or the values supplied by an outer nestloop, have to wait for
+ * the executor.  For each child that has such clauses, the planner gives
+ * the Append (or MergeAppend) the clauses and the child's constraints; see
+ * make_prune_info in createplan.c.  Here, we substitute the current values
+ * of the Params into the clauses and retry the proof.
+ *
+ * The values of external Params can't change during execution, so a
+ * subplan that can be pruned using those alone is never initialized.  The
+ * values of PARAM_EXEC Params can change at every rescan, so subplans that
+ * depend on them are initialized as usual and just skipped while they
+ * can't return anything.
+ *
+ * Portions Copyright (c) 1996-2014, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, Regents of the University of California
+ *
+ *
+ * IDENTIFICATION
+ *	  src/backend/executor/execPrune.c
+ *
+ *-------------------------------------------------------------------------
+ */
+#include "postgres.h"
+
+#include "executor/executor.h"
+#include "executor/nodeSubplan.h"
+#include "nodes/makefuncs.h"
+#include "nodes/nodeFuncs.h"
+#include "optimizer/clauses.h"
+#include "optimizer/predtest.h"
+#include "utils/lsyscache.h"
+#include "utils/memutils.h"
+
+
+typedef struct
+{
+	ExprContext *econtext;
+	bool		use_exec_params;	/* substitute PARAM_EXEC values? */
+	bool		found_exec_param;	/* saw a PARAM_EXEC Param? */
+} substitute_params_context;
+
+static Node *substitute_params_mutator(Node *node,
+						  substitute_params_context *context);
+static Node *make_param_const(Param *param, Datum value, bool isnull);
+
+
+/*
+ * ExecSubplanIsPrunable
+ *		Can the subplan with the given pruning quals and constraints be
+ *		skipped, because it can't return any rows with the current values
+ *		of the Params?
+ *
+ * When the node is being initialized, the values of PARAM_EXEC Params are
+ * not available yet, so the caller must pass initial = true; only external
+ * Params are then used.  In that case *needs_recheck is set to show
+ * whether the quals involve PARAM_EXEC Params too, which means that the
+ * subplan should be checked again at run time.
+ *
+ * Working memory is taken from the econtext's per-tuple memory, which is
+ * reset before returning.
+ */
+bool
+ExecSubplanIsPrunable(ExprContext *econtext, List *quals, List *constraints,
+					  bool initial, bool *needs_recheck)
+{
+	substitute_params_context context;
+	MemoryContext oldcontext;
+	List	   *clauses;
+	bool		result = false;
+	ListCell   *lc;
+
+	if (needs_recheck)
+		*needs_recheck = false;
+	if (quals == NIL || constraints == NIL)
+		return false;
+
+	oldcontext = MemoryContextSwitchTo(econtext->ecxt_per_tuple_memory);
+
+	/*
+	 * Replace the Params with Consts holding their current values, then
+	 * simplify, so that predtest.c has constants to reason with.
+	 */
+	context.econtext = econtext;
+	context.use_exec_params = !initial;
+	context.found_exec_param = false;
+	clauses = (List *) substitute_params_mutator((Node *) quals, &context);
+	clauses = (List *) eval_const_expressions(NULL, (Node *) clauses);
+
+	/* A clause that reduced to constant FALSE or NULL refutes everything */
+	foreach(lc, clauses)
+	{
+		Node	   *clause = (Node *) lfirst(lc);
+
+		if (IsA(clause, Const) &&
+			(((Const *) clause)->constisnull ||
+			 !DatumGetBool(((Const *) clause)->constvalue)))
+		{
+			result = true;
+			break;
+		}
+	}
+
+	if (!result)
+		result = predicate_refuted_by(constraints, clauses);
+
+	MemoryContextSwitchTo(oldcontext);
+	ResetExprContext(econtext);
+
+	if (needs_recheck)
+		*needs_recheck = context.found_exec_param;
+
+	return result;
+}
+
+/*
+ * Replace each Param whose value is available with a Const.
+ */
+static Node *
+substitute_params_mutator(Node *node, substitute_params_context *context)
+{
+	if (node == NULL)
+		return NULL;
+	if (IsA(node, Param))
+	{
+		Param	   *param = (Param *) node;
+		ExprContext *econtext = context->econtext;
+
+		if (param->paramkind == PARAM_EXTERN)
+		{
+			ParamListInfo paramInfo = econtext->ecxt_param_list_info;
+			int			thisParamId = param->paramid;
+
+			/* Much as in ExecEvalParamExtern, but leave it if not found */
+			if (paramInfo &&
+				thisParamId > 0 && thisParamId <= paramInfo->numParams)
+			{
+				ParamExternData *prm = &paramInfo->params[thisParamId - 1];
+
+				/* give hook a chance in case parameter is dynamic */
+				if (!OidIsValid(prm->ptype) && paramInfo->paramFetch != NULL)
+					(*paramInfo->paramFetch) (paramInfo, thisParamId);
+
+				if (OidIsValid(prm->ptype) && prm->ptype == param->paramtype)
+					return make_param_const(param, prm->value, prm->isnull);
+			}
+		}
+		else if (param->paramkind == PARAM_EXEC)
+		{
+			context->found_exec_param = true;
+			if (context->use_exec_params)
+			{
+				ParamExecData *prm;
+
+				prm = &(econtext->ecxt_param_exec_vals[param->paramid]);
+				if (prm->execPlan != NULL)
+				{
+					/* Parameter not evaluated yet, so go do it */
+					ExecSetParamPlan(prm->execPlan, econtext);
+					/* ExecSetParamPlan should have processed this param... */
+					Assert(prm->execPlan == NULL);
+				}
+				return make_param_const(param, prm->value, prm->isnull);
+			}
+		}
+		return node;
+	}
+	return expression_tree_mutator(node, substitute_params_mutator,
+								   (void *) context);
+}
+
+static Node *
+make_param_const(Param *param, Datum value, bool isnull)
+{
+	int16		typLen;
+	bool		typByVal;
+
+	get_typlenbyval(param->paramtype, &typLen, &typByVal);
+	return (Node *) makeConst(param->paramtype, param->paramtypmod,
+							  param->paramcollid, (int) typLen,
+							  value, isnull, typByVal);
+}
@@ -48,6 +48,7 @@
 #include "miscadmin.h"
 #include "nodes/makefuncs.h"
 #include "nodes/nodeFuncs.h"
+#include "optimizer/planmain.h"
 #include "optimizer/planner.h"
 #include "parser/parse_coerce.h"
 #include "pgstat.h"
@@ -59,6 +60,13 @@
 #include "utils/xml.h"
 
 
+/*
+ * Smallest constant array for which "scalar op ANY/ALL (array)" is evaluated
+ * with a hash table of the elements instead of comparing with each in turn.
+ */
+#define MIN_ARRAY_SIZE_FOR_HASHED_SAOP	9
+
+
 /* static function decls */
 static Datum ExecEvalArrayRef(ArrayRefExprState *astate,
 				 ExprContext *econtext,
@@ -70,6 +78,9 @@ static Datum ExecEvalAggref(AggrefExprState *aggref,
 static Datum ExecEvalWindowFunc(WindowFuncExprState *wfunc,
 				   ExprContext *econtext,
 				   bool *isNull, ExprDoneCond *isDone);
+static Datum ExecEvalGroupingFuncExpr(GroupingFuncExprState *gstate,
+						 ExprContext *econtext,
+						 bool *isNull, ExprDoneCond *isDone);
 static Datum ExecEvalScalarVar(ExprState *exprstate, ExprContext *econtext,
 				  bool *isNull, ExprDoneCond *isDone);
 static Datum ExecEvalScalarVarFast(ExprState *exprstate, ExprContext *econtext,
@@ -118,6 +129,15 @@ static Datum ExecEvalDistinct(FuncExprState *fcache, ExprContext *econtext,
 static Datum ExecEvalScalarArrayOp(ScalarArrayOpExprState *sstate,
 					  ExprContext *econtext,
 					  bool *isNull, ExprDoneCond *isDone);
+static bool scalararrayop_hash_funcs(ScalarArrayOpExpr *opexpr, Oid *eqfunc,
+						 Oid *lhs_hash_func, Oid *rhs_hash_func);
+static bool ExecInitHashedScalarArrayOp(ScalarArrayOpExprState *sstate,
+							ScalarArrayOpExpr *opexpr);
+static void ExecBuildScalarArrayOpHash(ScalarArrayOpExprState *sstate,
+						   ExprContext *econtext, Datum arraydatum);
+static Datum ExecEvalHashedScalarArrayOp(ScalarArrayOpExprState *sstate,
+							ExprContext *econtext,
+							FunctionCallInfo fcinfo, bool *isNull);
 static Datum ExecEvalNot(BoolExprState *notclause, ExprContext *econtext,
 			bool *isNull, ExprDoneCond *isDone);
 static Datum ExecEvalOr(BoolExprState *orExpr, ExprContext *econtext,
@@ -538,6 +558,45 @@ ExecEvalAggref(AggrefExprState *aggref, ExprContext *econtext,
 	return econtext->ecxt_aggvalues[aggref->aggno];
 }
 
+/* ----------------------------------------------------------------
+ *		ExecEvalGroupingFuncExpr
+ *
+ *		Return a bitmask with a bit for each (unevaluated) argument expression
+ *		(rightmost arg is least significant bit).
+ *
+ *		A bit is set if the corresponding expression is NOT part of the set of
+ *		grouping expressions in the current grouping set.
+ * ----------------------------------------------------------------
+ */
+static Datum
+ExecEvalGroupingFuncExpr(GroupingFuncExprState *gstate,
+						 ExprContext *econtext,
+						 bool *isNull,
+						 ExprDoneCond *isDone)
+{
+	int			result = 0;
+	int			attnum = 0;
+	Bitmapset  *grouped_cols = gstate->aggstate->grouped_cols;
+	ListCell   *lc;
+
+	if (isDone)
+		*isDone = ExprSingleResult;
+
+	*isNull = false;
+
+	foreach(lc, (gstate->clauses))
+	{
+		attnum = lfirst_int(lc);
+
+		result = result << 1;
+
+		if (!bms_is_member(attnum, grouped_cols))
+			result = result | 1;
+	}
+
+	return Int32GetDatum(result);
+}
+
 /* ----------------------------------------------------------------
  *		ExecEvalWindowFunc
  *
@@ -2595,6 +2654,9 @@ ExecEvalScalarArrayOp(ScalarArrayOpExprState *sstate,
 	typbyval = sstate->typbyval;
 	typalign = sstate->typalign;
 
+	if (sstate->useHash)
+		return ExecEvalHashedScalarArrayOp(sstate, econtext, fcinfo, isNull);
+
 	result = BoolGetDatum(!useOr);
 	resultnull = false;
 
@@ -2673,6 +2735,265 @@ ExecEvalScalarArrayOp(ScalarArrayOpExprState *sstate,
 	return result;
 }
 
+/*
+ * Entry of the hash table built by ExecBuildScalarArrayOpHash.  The table
+ * uses open addressing with linear probing; unused entries have used = false.
+ */
+struct ScalarArrayOpHashEntry
+{
+	Datum		value;			/* a non-null array element */
+	uint32		hash;			/* its hash value */
+	bool		used;
+};
+
+/*
+ * scalararrayop_hash_funcs
+ *
+ * Decide whether a ScalarArrayOpExpr can be evaluated with a hash table of
+ * the array's elements, and if so, return the functions needed.  That is
+ * the case when the array is a constant with at least
+ * MIN_ARRAY_SIZE_FOR_HASHED_SAOP elements, and the operator is hashable, or
+ * for ALL, has a hashable negator; so "x IN (...)" and "x NOT IN (...)" both
+ * qualify.  All the functions involved must be strict, so that a NULL can
+ * never compare equal to anything.
+ */
+static bool
+scalararrayop_hash_funcs(ScalarArrayOpExpr *opexpr, Oid *eqfunc,
+						 Oid *lhs_hash_func, Oid *rhs_hash_func)
+{
+	Const	   *arrayarg = (Const *) lsecond(opexpr->args);
+	ArrayType  *arr;
+	Oid			eqop;
+
+	if (!IsA(arrayarg, Const) || arrayarg->constisnull)
+		return false;
+	arr = DatumGetArrayTypeP(arrayarg->constvalue);
+	if (ArrayGetNItems(ARR_NDIM(arr), ARR_DIMS(arr)) <
+		MIN_ARRAY_SIZE_FOR_HASHED_SAOP)
+		return false;
+
+	if (opexpr->useOr)
+		eqop = opexpr->opno;
+	else
+		eqop = get_negator(opexpr->opno);
+	if (!OidIsValid(eqop))
+		return false;
+	if (!get_op_hash_functions(eqop, lhs_hash_func, rhs_hash_func))
+		return false;
+	*eqfunc = get_opcode(eqop);
+	set_sa_opfuncid(opexpr);
+	if (!func_strict(opexpr->opfuncid) || !func_strict(*eqfunc) ||
+		!func_strict(*lhs_hash_func) || !func_strict(*rhs_hash_func))
+		return false;
+
+	/*
+	 * The negator's function and the hash functions are called on the
+	 * user's behalf although the query doesn't name them, so fall back to
+	 * the plain loop if the user can't execute them.
+	 */
+	if (pg_proc_aclcheck(*eqfunc, GetUserId(), ACL_EXECUTE) != ACLCHECK_OK ||
+		pg_proc_aclcheck(*lhs_hash_func, GetUserId(), ACL_EXECUTE) != ACLCHECK_OK ||
+		pg_proc_aclcheck(*rhs_hash_func, GetUserId(), ACL_EXECUTE) != ACLCHECK_OK)
+		return false;
+
+	return true;
+}
+
+/*
+ * ExecScalarArrayOpUsesHash
+ *
+ * Will ExecInitExpr set up this ScalarArrayOpExpr for hashed evaluation?
+ * execFlatExpr.c asks, so as to leave such expressions to us.
+ */
+bool
+ExecScalarArrayOpUsesHash(ScalarArrayOpExpr *opexpr)
+{
+	Oid			eqfunc;
+	Oid			lhs_hash_func;
+	Oid			rhs_hash_func;
+
+	return scalararrayop_hash_funcs(opexpr, &eqfunc,
+									&lhs_hash_func, &rhs_hash_func);
+}
+
+/*
+ * ExecInitHashedScalarArrayOp
+ *
+ * If a ScalarArrayOpExpr can be evaluated with a hash table, look up the
+ * functions needed and return true.
+ */
+static bool
+ExecInitHashedScalarArrayOp(ScalarArrayOpExprState *sstate,
+							ScalarArrayOpExpr *opexpr)
+{
+	Oid			eqfunc;
+	Oid			lhs_hash_func;
+	Oid			rhs_hash_func;
+
+	if (!scalararrayop_hash_funcs(opexpr, &eqfunc,
+								  &lhs_hash_func, &rhs_hash_func))
+		return false;
+
+	fmgr_info(eqfunc, &sstate->hash_eqfunc);
+	fmgr_info(lhs_hash_func, &sstate->hash_lhs_func);
+	fmgr_info(rhs_hash_func, &sstate->hash_rhs_func);
+	sstate->hash_entries = NULL;
+
+	return true;
+}
+
+/*
+ * ExecBuildScalarArrayOpHash
+ *
+ * Build the hash table of the array's elements, in per-query memory.  When
+ * the scalar and the elements are of the same type, duplicate elements are
+ * entered only once.
+ */
+static void
+ExecBuildScalarArrayOpHash(ScalarArrayOpExprState *sstate,
+						   ExprContext *econtext, Datum arraydatum)
+{
+	ScalarArrayOpExpr *opexpr = (ScalarArrayOpExpr *) sstate->fxprstate.xprstate.expr;
+	MemoryContext oldcontext;
+	ArrayType  *arr;
+	ScalarArrayOpHashEntry *entries;
+	int			nitems;
+	uint32		nentries;
+	uint32		mask;
+	bool		dedup;
+	int16		typlen = sstate->typlen;
+	bool		typbyval = sstate->typbyval;
+	char		typalign = sstate->typalign;
+	char	   *s;
+	bits8	   *bitmap;
+	int			bitmask;
+	int			i;
+
+	oldcontext = MemoryContextSwitchTo(econtext->ecxt_per_query_memory);
+
+	/* The entries point into the array, so it must live as long as they do */
+	arr = DatumGetArrayTypePCopy(arraydatum);
+	nitems = ArrayGetNItems(ARR_NDIM(arr), ARR_DIMS(arr));
+
+	/* Keep the table at most half full */
+	nentries = 16;
+	while (nentries < (uint32) nitems * 2)
+		nentries <<= 1;
+	mask = nentries - 1;
+	entries = (ScalarArrayOpHashEntry *)
+		palloc0(nentries * sizeof(ScalarArrayOpHashEntry));
+
+	MemoryContextSwitchTo(oldcontext);
+
+	dedup = (exprType((Node *) linitial(opexpr->args)) == ARR_ELEMTYPE(arr));
+
+	s = (char *) ARR_DATA_PTR(arr);
+	bitmap = ARR_NULLBITMAP(arr);
+	bitmask = 1;
+
+	for (i = 0; i < nitems; i++)
+	{
+		if (bitmap && (*bitmap & bitmask) == 0)
+			sstate->hash_has_nulls = true;
+		else
+		{
+			Datum		elt;
+			uint32		hash;
+			uint32		pos;
+
+			elt = fetch_att(s, typbyval, typlen);
+			s = att_addlength_pointer(s, typlen, s);
+			s = (char *) att_align_nominal(s, typalign);
+
+			hash = DatumGetUInt32(FunctionCall1Coll(&sstate->hash_rhs_func,
+													opexpr->inputcollid,
+													elt));
+			for (pos = hash & mask;; pos = (pos + 1) & mask)
+			{
+				ScalarArrayOpHashEntry *entry = &entries[pos];
+
+				if (!entry->used)
+				{
+					entry->value = elt;
+					entry->hash = hash;
+					entry->used = true;
+					break;
+				}
+				if (dedup && entry->hash == hash &&
+					DatumGetBool(FunctionCall2Coll(&sstate->hash_eqfunc,
+												   opexpr->inputcollid,
+												   entry->value, elt)))
+					break;
+			}
+		}
+
+		/* advance bitmap pointer if any */
+		if (bitmap)
+		{
+			bitmask <<= 1;
+			if (bitmask == 0x100)
+			{
+				bitmap++;
+				bitmask = 1;
+			}
+		}
+	}
+
+	sstate->hash_mask = mask;
+	sstate->hash_entries = entries;
+}
+
+/*
+ * ExecEvalHashedScalarArrayOp
+ *
+ * Evaluate "scalar op ANY/ALL (array)" by looking the scalar up in the hash
+ * table of the array's elements, building it first if necessary.  The
+ * caller has dealt with a NULL or empty array and a NULL scalar.
+ *
+ * For ANY, the result is true if an equal element is found.  For ALL, the
+ * table holds the elements compared with the negator, so the result is
+ * false if one is found.  Otherwise, the result is NULL if the array has
+ * NULL elements, just as when comparing with each one in turn.
+ */
+static Datum
+ExecEvalHashedScalarArrayOp(ScalarArrayOpExprState *sstate,
+							ExprContext *econtext,
+							FunctionCallInfo fcinfo, bool *isNull)
+{
+	ScalarArrayOpExpr *opexpr = (ScalarArrayOpExpr *) sstate->fxprstate.xprstate.expr;
+	Datum		scalar = fcinfo->arg[0];
+	uint32		hash;
+	uint32		pos;
+
+	Assert(!fcinfo->argnull[0]);
+
+	if (sstate->hash_entries == NULL)
+		ExecBuildScalarArrayOpHash(sstate, econtext, fcinfo->arg[1]);
+
+	hash = DatumGetUInt32(FunctionCall1Coll(&sstate->hash_lhs_func,
+											opexpr->inputcollid,
+											scalar));
+	for (pos = hash & sstate->hash_mask;; pos = (pos + 1) & sstate->hash_mask)
+	{
+		ScalarArrayOpHashEntry *entry = &sstate->hash_entries[pos];
+
+		if (!entry->used)
+			break;
+		if (entry->hash == hash &&
+			DatumGetBool(FunctionCall2Coll(&sstate->hash_eqfunc,
+										   opexpr->inputcollid,
+										   scalar, entry->value)))
+			return BoolGetDatum(opexpr->useOr);
+	}
+
+	if (sstate->hash_has_nulls)
+	{
+		*isNull = true;
+		return (Datum) 0;
+	}
+	return BoolGetDatum(!opexpr->useOr);
+}
+
 /* ----------------------------------------------------------------
  *		ExecEvalNot
  *		ExecEvalOr
@@ -4455,6 +4776,29 @@ ExecInitExpr(Expr *node, PlanState *parent)
 				state = (ExprState *) astate;
 			}
 			break;
+		case T_GroupingFunc:
+			{
+				GroupingFunc *grp_node = (GroupingFunc *) node;
+				GroupingFuncExprState *grp_state = makeNode(GroupingFuncExprState);
+				Agg		   *agg = NULL;
+
+				if (!parent || !IsA(parent, AggState) ||
+					!IsA(parent->plan, Agg))
+					elog(ERROR, "parent of GROUPING is not Agg node");
+
+				grp_state->aggstate = (AggState *) parent;
+
+				agg = (Agg *) (parent->plan);
+
+				if (agg->groupingSets)
+					grp_state->clauses = grp_node->cols;
+				else
+					grp_state->clauses = NIL;
+
+				state = (ExprState *) grp_state;
+				state->evalfunc = (ExprStateEvalFunc) ExecEvalGroupingFuncExpr;
+			}
+			break;
 		case T_WindowFunc:
 			{
 				WindowFunc *wfunc = (WindowFunc *) node;
@@ -4575,6 +4919,7 @@ ExecInitExpr(Expr *node, PlanState *parent)
 					ExecInitExpr((Expr *) opexpr->args, parent);
 				sstate->fxprstate.func.fn_oid = InvalidOid;		/* not initialized */
 				sstate->element_type = InvalidOid;		/* ditto */
+				sstate->useHash = ExecInitHashedScalarArrayOp(sstate, opexpr);
 				state = (ExprState *) sstate;
 			}
 			break;
@@ -5034,7 +5379,8 @@ ExecInitExpr(Expr *node, PlanState *parent)
 				GenericExprState *gstate = makeNode(GenericExprState);
 
 				gstate->xprstate.evalfunc = NULL;		/* not used */
-				gstate->arg = ExecInitExpr(tle->expr, parent);
+				/* target list entries are worth flattening when possible */
+				gstate->arg = ExecInitExprFlat(tle->expr, parent);
 				state = (ExprState *) gstate;
 			}
 			break;
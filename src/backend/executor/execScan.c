@@ -19,6 +19,7 @@
 #include "postgres.h"
 
 #include "executor/executor.h"
+#include "executor/nodeHash.h"
 #include "miscadmin.h"
 #include "utils/memutils.h"
 
@@ -123,10 +124,11 @@ ExecScan(ScanState *node,
 	econtext = node->ps.ps_ExprContext;
 
 	/*
-	 * If we have neither a qual to check nor a projection to do, just skip
-	 * all the overhead and return the raw scan tuple.
+	 * If we have neither a qual to check nor a projection to do, nor a hash
+	 * join filter to apply, just skip all the overhead and return the raw
+	 * scan tuple.
 	 */
-	if (!qual && !projInfo)
+	if (!qual && !projInfo && !node->ss_HashFilter)
 	{
 		ResetExprContext(econtext);
 		return ExecScanFetch(node, accessMtd, recheckMtd);
@@ -185,6 +187,17 @@ ExecScan(ScanState *node,
 		 */
 		econtext->ecxt_scantuple = slot;
 
+		/*
+		 * If a hash join above us has told us which rows it can't use, throw
+		 * them away before spending anything more on them.
+		 */
+		if (node->ss_HashFilter &&
+			!ExecHashFilterTuple(node->ss_HashFilter, econtext))
+		{
+			ResetExprContext(econtext);
+			continue;
+		}
+
 		/*
 		 * check that the current tuple satisfies the qual-clause
 		 *
@@ -32,6 +32,9 @@
  *		ExecCloseIndices		 | referenced by InitPlan, EndPlan,
  *		ExecInsertIndexTuples	/  ExecInsert, ExecUpdate
  *
+ *		ExecSetupIndexBatches	\  referenced by CopyFrom
+ *		ExecFlushIndexBatches	/
+ *
  *		RegisterExprContextCallback    Register function shutdown callback
  *		UnregisterExprContextCallback  Deregister function shutdown callback
  *
@@ -49,6 +52,7 @@
 #include "nodes/nodeFuncs.h"
 #include "parser/parsetree.h"
 #include "storage/lmgr.h"
+#include "utils/datum.h"
 #include "utils/memutils.h"
 #include "utils/tqual.h"
 
@@ -971,12 +975,120 @@ ExecCloseIndices(ResultRelInfo *resultRelInfo)
 		index_close(indexDescs[i], RowExclusiveLock);
 	}
 
+	/* Release the memory of any index batches */
+	if (resultRelInfo->ri_IndexBatches != NULL)
+	{
+		for (i = 0; i < numIndices; i++)
+		{
+			IndexInsertBatch *batch = resultRelInfo->ri_IndexBatches[i];
+
+			if (batch != NULL)
+			{
+				Assert(batch->ntuples == 0);
+				MemoryContextDelete(batch->context);
+			}
+		}
+	}
+
 	/*
 	 * XXX should free indexInfo array here too?  Currently we assume that
 	 * such stuff will be cleaned up automatically in FreeExecutorState.
 	 */
 }
 
+/* ----------------------------------------------------------------
+ *		ExecSetupIndexBatches
+ *
+ *		Arrange for ExecInsertIndexTuples to collect the entries for
+ *		suitable indexes of the result relation, instead of inserting them
+ *		one at a time.  The caller must then call ExecFlushIndexBatches
+ *		to insert the collected entries, before anything can look at the
+ *		indexes; so this is only useful when many tuples are inserted at
+ *		once and nothing else happens in between, as in COPY FROM.
+ *
+ *		An index is suitable if its AM can insert a batch of entries in one
+ *		call, and it needs no uniqueness or exclusion checks, whose errors
+ *		should refer to the tuple being inserted.  maxtuples is the number
+ *		of tuples the caller will insert between flushes.
+ * ----------------------------------------------------------------
+ */
+void
+ExecSetupIndexBatches(ResultRelInfo *resultRelInfo, int maxtuples)
+{
+	int			numIndices = resultRelInfo->ri_NumIndices;
+	IndexInsertBatch **batches;
+	int			i;
+
+	if (numIndices == 0)
+		return;
+
+	batches = (IndexInsertBatch **)
+		palloc0(numIndices * sizeof(IndexInsertBatch *));
+
+	for (i = 0; i < numIndices; i++)
+	{
+		Relation	indexRelation = resultRelInfo->ri_IndexRelationDescs[i];
+		IndexInfo  *indexInfo = resultRelInfo->ri_IndexRelationInfo[i];
+		int			natts = indexInfo->ii_NumIndexAttrs;
+		IndexInsertBatch *batch;
+
+		if (indexRelation == NULL ||
+			!RegProcedureIsValid(indexRelation->rd_am->aminsertmulti) ||
+			indexRelation->rd_index->indisunique ||
+			indexInfo->ii_ExclusionOps != NULL)
+			continue;
+
+		batch = (IndexInsertBatch *) palloc(sizeof(IndexInsertBatch));
+		batch->ntuples = 0;
+		batch->maxtuples = maxtuples;
+		batch->values = (Datum *) palloc(maxtuples * natts * sizeof(Datum));
+		batch->isnull = (bool *) palloc(maxtuples * natts * sizeof(bool));
+		batch->heapTids = (ItemPointerData *)
+			palloc(maxtuples * sizeof(ItemPointerData));
+		batch->context = AllocSetContextCreate(CurrentMemoryContext,
+											   "IndexInsertBatch",
+											   ALLOCSET_DEFAULT_MINSIZE,
+											   ALLOCSET_DEFAULT_INITSIZE,
+											   ALLOCSET_DEFAULT_MAXSIZE);
+		batches[i] = batch;
+	}
+
+	resultRelInfo->ri_IndexBatches = batches;
+}
+
+/* ----------------------------------------------------------------
+ *		ExecFlushIndexBatches
+ *
+ *		Insert the index entries collected by ExecInsertIndexTuples.
+ * ----------------------------------------------------------------
+ */
+void
+ExecFlushIndexBatches(ResultRelInfo *resultRelInfo)
+{
+	int			i;
+
+	if (resultRelInfo->ri_IndexBatches == NULL)
+		return;
+
+	for (i = 0; i < resultRelInfo->ri_NumIndices; i++)
+	{
+		IndexInsertBatch *batch = resultRelInfo->ri_IndexBatches[i];
+
+		if (batch == NULL || batch->ntuples == 0)
+			continue;
+
+		index_insert_multi(resultRelInfo->ri_IndexRelationDescs[i],
+						   batch->values,
+						   batch->isnull,
+						   batch->heapTids,
+						   resultRelInfo->ri_RelationDesc,
+						   batch->ntuples);
+
+		batch->ntuples = 0;
+		MemoryContextReset(batch->context);
+	}
+}
+
 /* ----------------------------------------------------------------
  *		ExecInsertIndexTuples
  *
@@ -1083,6 +1195,46 @@ ExecInsertIndexTuples(TupleTableSlot *slot,
 					   values,
 					   isnull);
 
+		/*
+		 * If we're collecting entries for this index, just add this one to
+		 * the batch.  The index has no constraint to check.
+		 */
+		if (resultRelInfo->ri_IndexBatches != NULL &&
+			resultRelInfo->ri_IndexBatches[i] != NULL)
+		{
+			IndexInsertBatch *batch = resultRelInfo->ri_IndexBatches[i];
+			TupleDesc	itupdesc = RelationGetDescr(indexRelation);
+			int			natts = itupdesc->natts;
+			Datum	   *batchvalues;
+			bool	   *batchisnull;
+			int			j;
+
+			if (batch->ntuples >= batch->maxtuples)
+				ExecFlushIndexBatches(resultRelInfo);
+
+			batchvalues = batch->values + batch->ntuples * natts;
+			batchisnull = batch->isnull + batch->ntuples * natts;
+			for (j = 0; j < natts; j++)
+			{
+				Form_pg_attribute att = itupdesc->attrs[j];
+
+				/* values may point into per-tuple memory, so copy them */
+				batchisnull[j] = isnull[j];
+				if (isnull[j] || att->attbyval)
+					batchvalues[j] = values[j];
+				else
+				{
+					MemoryContext oldContext;
+
+					oldContext = MemoryContextSwitchTo(batch->context);
+					batchvalues[j] = datumCopy(values[j], false, att->attlen);
+					MemoryContextSwitchTo(oldContext);
+				}
+			}
+			batch->heapTids[batch->ntuples++] = *tupleid;
+			continue;
+		}
+
 		/*
 		 * The index AM does the actual insertion, plus uniqueness checking.
 		 *
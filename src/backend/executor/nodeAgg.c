@@ -54,6 +54,43 @@
  *	  is used to run finalize functions and compute the output tuple;
  *	  this context can be reset once per output tuple.
  *
+ *	  With grouping sets, one Agg node computes several groupings of its
+ *	  input at once.  In sorted mode, the grouping sets computed in one pass
+ *	  form a rollup: each is a prefix of the one before, in grpColIdx order,
+ *	  so the groups of all of them can be found in the same sorted input by
+ *	  checking how many leading columns change between tuples.  We keep
+ *	  transition values for every set of the rollup at once, each set in an
+ *	  aggcontext of its own; when a group of one set ends, so do the current
+ *	  groups of all the longer sets.  Any further rollups are described by
+ *	  the Agg nodes in the node's chain list, and each is computed in a
+ *	  "phase" of its own: while reading its input, a phase copies every tuple
+ *	  into a tuplesort ordered for the next phase, which reads that instead
+ *	  of the outer plan.  In hashed mode, each grouping set is a phase with a
+ *	  hash table of its own, and all the tables are filled in the same pass.
+ *	  Output rows show NULL for any grouping column not in the set they
+ *	  belong to, and GROUPING() checks aggstate->grouped_cols to tell which
+ *	  columns those are.
+ *
+ *	  In AGG_PLAIN mode, if the outer plan can produce tuples a batch at a
+ *	  time (see ExecProcNodeBatch) and every aggregate just takes plain
+ *	  input columns, we read the input in batches and run each transition
+ *	  function in a loop over the batch's column arrays, skipping the
+ *	  per-row ExecProcNode and ExecProject calls.
+ *
+ *	  In AGG_HASHED mode, the hash table can outgrow work_mem if the planner
+ *	  underestimated the number of groups.  When the memory used by
+ *	  aggcontext exceeds work_mem, we stop creating new groups: input tuples
+ *	  that belong to groups already in the table are still aggregated, but
+ *	  the rest are written to one of several spill files, chosen by their
+ *	  hash value.  Once the groups in memory have been emitted, the hash
+ *	  table is emptied and each spill file is read back in turn as a new
+ *	  batch of input.  A batch that again doesn't fit is split further,
+ *	  using the next bits of the hash value, so every batch eventually gets
+ *	  processed in memory (or we run out of hash bits, whereupon we simply
+ *	  ignore work_mem).  With hashed grouping sets, each set's hash table
+ *	  spills to files of its own, and each batch is read back into the table
+ *	  of the set it came from.
+ *
  *	  The executor's AggState node is passed as the fmgr "context" value in
  *	  all transfunc and finalfunc calls.  It is not recommended that the
  *	  transition functions look at the AggState node directly, but they can
@@ -76,6 +113,16 @@
  *	  AggState is available as context in earlier releases (back to 8.1),
  *	  but direct examination of the node is needed to use it before 9.0.
  *
+ *	  The planner can also split an aggregate into two steps, so that several
+ *	  Agg nodes each aggregate part of the input and a final Agg node merges
+ *	  their results.  An Aggref marked aggpartial skips the finalfunc and
+ *	  returns the transition value itself; if the node's serialStates flag
+ *	  is set, an INTERNAL transition value is first flattened to bytea by
+ *	  the aggregate's serialfunc.  An Aggref marked aggcombine takes such
+ *	  transition values as its input: the aggregate's combinefunc is used in
+ *	  place of the transfunc (with the deserialfunc applied to each input
+ *	  first, if serialStates is set), and everything else works as usual.
+ *
  *	  As of 9.4, aggregate transition functions can also use AggGetAggref()
  *	  to get hold of the Aggref expression node for their aggregate call.
  *	  This is mainly intended for ordered-set aggregates, which are not
@@ -101,7 +148,9 @@
 #include "catalog/pg_proc.h"
 #include "executor/executor.h"
 #include "executor/nodeAgg.h"
+#include "executor/tuplebatch.h"
 #include "miscadmin.h"
+#include "storage/buffile.h"
 #include "nodes/nodeFuncs.h"
 #include "optimizer/clauses.h"
 #include "optimizer/tlist.h"
@@ -147,13 +196,19 @@ typedef struct AggStatePerAggData
 	/*
 	 * Number of aggregated input columns to pass to the transfn.  This
 	 * includes the ORDER BY columns for ordered-set aggs, but not for plain
-	 * aggs.  (This doesn't count the transition state value!)
+	 * aggs.  (This doesn't count the transition state value!)  It's always 1
+	 * when combining partial aggregates.
 	 */
 	int			numTransInputs;
 
-	/* Oids of transfer functions */
+	/*
+	 * Oids of transfer functions.  When combining partial aggregates,
+	 * transfn_oid is the aggregate's combine function.
+	 */
 	Oid			transfn_oid;
 	Oid			finalfn_oid;	/* may be InvalidOid */
+	Oid			serialfn_oid;	/* may be InvalidOid */
+	Oid			deserialfn_oid; /* may be InvalidOid */
 
 	/*
 	 * fmgr lookup data for transfer functions --- only valid when
@@ -162,6 +217,8 @@ typedef struct AggStatePerAggData
 	 */
 	FmgrInfo	transfn;
 	FmgrInfo	finalfn;
+	FmgrInfo	serialfn;
+	FmgrInfo	deserialfn;
 
 	/* Input collation derived for aggregate */
 	Oid			aggCollation;
@@ -234,7 +291,8 @@ typedef struct AggStatePerAggData
 	 * rest.
 	 */
 
-	Tuplesortstate *sortstate;	/* sort object, if DISTINCT or ORDER BY */
+	Tuplesortstate **sortstates;	/* sort objects, if DISTINCT or ORDER BY;
+									 * one per grouping set */
 
 	/*
 	 * This field is a pre-initialized FunctionCallInfo struct used for
@@ -243,6 +301,12 @@ typedef struct AggStatePerAggData
 	 * worth the extra space consumption.
 	 */
 	FunctionCallInfoData transfn_fcinfo;
+
+	/*
+	 * If the input is read a batch at a time, the batch column holding each
+	 * of the aggregate's inputs (0-based).
+	 */
+	int		   *batchInputCols;
 }	AggStatePerAggData;
 
 /*
@@ -252,11 +316,12 @@ typedef struct AggStatePerAggData
  * an input tuple group and updated for each input tuple.
  *
  * In AGG_PLAIN and AGG_SORTED modes, we have a single array of these
- * structs (pointed to by aggstate->pergroup); we re-use the array for
- * each input group, if it's AGG_SORTED mode.  In AGG_HASHED mode, the
- * hash table contains an array of these structs for each tuple group.
+ * structs (pointed to by aggstate->pergroup), holding numaggs entries for
+ * each grouping set; we re-use the array for each input group, if it's
+ * AGG_SORTED mode.  In AGG_HASHED mode, the hash table contains an array
+ * of these structs for each tuple group.
  *
- * Logically, the sortstate field belongs in this struct, but we do not
+ * Logically, the sortstates field belongs in this struct, but we do not
  * keep it here for space reasons: we don't support DISTINCT aggregates
  * in AGG_HASHED mode, so there's no reason to use up a pointer field
  * in every entry of the hashtable.
@@ -277,6 +342,30 @@ typedef struct AggStatePerGroupData
 	 */
 } AggStatePerGroupData;
 
+/*
+ * AggStatePerPhaseData - per-grouping-set-phase state
+ *
+ * Grouping sets are divided into phases, each computed by one pass over the
+ * input: a rollup of sets sharing one sort order in AGG_SORTED mode, or a
+ * single set with a hash table of its own in AGG_HASHED mode.  Without
+ * grouping sets there's just one phase, with numsets = 0.
+ */
+typedef struct AggStatePerPhaseData
+{
+	Agg		   *aggnode;		/* Agg node for phase data */
+	Sort	   *sortnode;		/* Sort node for input ordering for phase */
+	int			numsets;		/* number of grouping sets (or 0) */
+	int		   *gset_lengths;	/* lengths of grouping sets */
+	Bitmapset **grouped_cols;	/* column groupings for rollup */
+	FmgrInfo   *eqfunctions;	/* per-grouping-field equality fns */
+	/* these fields are used in AGG_HASHED mode: */
+	FmgrInfo   *hashfunctions;	/* per-grouping-field hash fns */
+	TupleHashTable hashtable;	/* hash table with one entry per group */
+	TupleTableSlot *hashslot;	/* slot for loading hash table */
+	List	   *hash_needed;	/* list of columns needed in hash table */
+	TupleHashIterator hashiter; /* for iterating through hash table */
+} AggStatePerPhaseData;
+
 /*
  * To implement hashed aggregation, we need a hashtable that stores a
  * representative tuple and an array of AggStatePerGroup structs for each
@@ -292,14 +381,49 @@ typedef struct AggHashEntryData
 	AggStatePerGroupData pergroup[1];	/* VARIABLE LENGTH ARRAY */
 }	AggHashEntryData;	/* VARIABLE LENGTH STRUCT */
 
+/*
+ * When a hashed aggregation runs out of work_mem, tuples of groups that
+ * aren't already in the hash table are written to spill files.  Each spilled
+ * tuple is stored as its hash value followed by the MinimalTuple.  The spill
+ * file is chosen by the next partition_bits of the hash value after the
+ * used_bits that selected the current batch; we take bits from the high end,
+ * since dynahash uses the low-order bits to choose buckets.
+ */
+#define HASHAGG_MIN_PARTITIONS	4
+#define HASHAGG_MAX_PARTITIONS	256
+
+struct HashAggSpill
+{
+	int			npartitions;	/* number of spill files */
+	int			partition_bits; /* log2(npartitions) */
+	BufFile   **partitions;		/* spill files, or NULL if not yet used */
+};
+
+/*
+ * A spill file that has been completely written, waiting to be read back in
+ * as input to the hash table.
+ */
+typedef struct HashAggBatch
+{
+	BufFile    *input_file;		/* spilled tuples */
+	int			used_bits;		/* hash bits that selected these tuples */
+	int			phase;			/* phase whose hash table they belong in */
+} HashAggBatch;
+
 
+static void initialize_phase(AggState *aggstate, int newphase);
+static TupleTableSlot *fetch_input_tuple(AggState *aggstate);
+static void select_current_set(AggState *aggstate, int setno);
 static void initialize_aggregates(AggState *aggstate,
 					  AggStatePerAgg peragg,
-					  AggStatePerGroup pergroup);
+					  AggStatePerGroup pergroup,
+					  int numReset);
 static void advance_transition_function(AggState *aggstate,
 							AggStatePerAgg peraggstate,
 							AggStatePerGroup pergroupstate);
 static void advance_aggregates(AggState *aggstate, AggStatePerGroup pergroup);
+static void advance_aggregates_batch(AggState *aggstate,
+						 AggStatePerGroup pergroup);
 static void process_ordered_aggregate_single(AggState *aggstate,
 								 AggStatePerAgg peraggstate,
 								 AggStatePerGroup pergroupstate);
@@ -310,95 +434,232 @@ static void finalize_aggregate(AggState *aggstate,
 				   AggStatePerAgg peraggstate,
 				   AggStatePerGroup pergroupstate,
 				   Datum *resultVal, bool *resultIsNull);
+static void prepare_projection_slot(AggState *aggstate,
+						TupleTableSlot *slot,
+						int currentSet);
+static void finalize_aggregates(AggState *aggstate,
+					AggStatePerAgg peragg,
+					AggStatePerGroup pergroup,
+					int currentSet);
+static TupleTableSlot *project_aggregates(AggState *aggstate);
 static Bitmapset *find_unaggregated_cols(AggState *aggstate);
 static bool find_unaggregated_cols_walker(Node *node, Bitmapset **colnos);
 static void build_hash_table(AggState *aggstate);
 static AggHashEntry lookup_hash_entry(AggState *aggstate,
 				  TupleTableSlot *inputslot);
 static TupleTableSlot *agg_retrieve_direct(AggState *aggstate);
+static void agg_setup_batch(AggState *aggstate);
 static void agg_fill_hash_table(AggState *aggstate);
 static TupleTableSlot *agg_retrieve_hash_table(AggState *aggstate);
+static bool agg_refill_hash_table(AggState *aggstate);
+static void hash_agg_check_limits(AggState *aggstate);
+static void hash_agg_enter_spill_mode(AggState *aggstate);
+static uint32 hash_agg_hash_tuple(AggState *aggstate, TupleTableSlot *slot);
+static void hash_agg_spill_tuple(AggState *aggstate, TupleTableSlot *slot,
+					 uint32 hashvalue);
+static bool hash_agg_read_spilled(BufFile *file, TupleTableSlot *slot,
+					  uint32 *hashvalue);
+static void hash_agg_finish_spill(AggState *aggstate);
+static void hash_agg_release_spill(AggState *aggstate);
 static Datum GetAggInitVal(Datum textInitVal, Oid transtype);
 
 
 /*
- * Initialize all aggregates for a new group of input values.
+ * Switch to phase "newphase", which must either be 0 (to reset) or
+ * current_phase + 1. Juggle the tuplesorts accordingly.
+ *
+ * This is used only in sorted mode; hashed phases are all processed together
+ * and just switch aggstate->phase directly.
+ */
+static void
+initialize_phase(AggState *aggstate, int newphase)
+{
+	Assert(newphase == 0 || newphase == aggstate->current_phase + 1);
+
+	/*
+	 * Whatever the previous state, we're now done with whatever input
+	 * tuplesort was in use.
+	 */
+	if (aggstate->sort_in)
+	{
+		tuplesort_end(aggstate->sort_in);
+		aggstate->sort_in = NULL;
+	}
+
+	if (newphase == 0)
+	{
+		/*
+		 * Discard any existing output tuplesort.
+		 */
+		if (aggstate->sort_out)
+		{
+			tuplesort_end(aggstate->sort_out);
+			aggstate->sort_out = NULL;
+		}
+	}
+	else
+	{
+		/*
+		 * The old output tuplesort becomes the new input one, and this is the
+		 * right time to actually sort it.
+		 */
+		aggstate->sort_in = aggstate->sort_out;
+		aggstate->sort_out = NULL;
+		Assert(aggstate->sort_in);
+		tuplesort_performsort(aggstate->sort_in);
+	}
+
+	/*
+	 * If this isn't the last phase, we need to sort appropriately for the
+	 * next phase in sequence.
+	 */
+	if (newphase < aggstate->numphases - 1)
+	{
+		Sort	   *sortnode = aggstate->phases[newphase + 1].sortnode;
+		PlanState  *outerNode = outerPlanState(aggstate);
+		TupleDesc	tupDesc = ExecGetResultType(outerNode);
+
+		aggstate->sort_out = tuplesort_begin_heap(tupDesc,
+												  sortnode->numCols,
+												  sortnode->sortColIdx,
+												  sortnode->sortOperators,
+												  sortnode->collations,
+												  sortnode->nullsFirst,
+												  work_mem,
+												  false);
+	}
+
+	aggstate->current_phase = newphase;
+	aggstate->phase = &aggstate->phases[newphase];
+}
+
+/*
+ * Fetch a tuple from either the outer plan (for phase 0) or from the sorter
+ * populated by the previous phase.  Copy it to the sorter for the next phase
+ * if any.
+ */
+static TupleTableSlot *
+fetch_input_tuple(AggState *aggstate)
+{
+	TupleTableSlot *slot;
+
+	if (aggstate->sort_in)
+	{
+		if (!tuplesort_gettupleslot(aggstate->sort_in, true,
+									aggstate->sort_slot))
+			return NULL;
+		slot = aggstate->sort_slot;
+	}
+	else
+		slot = ExecProcNode(outerPlanState(aggstate));
+
+	if (!TupIsNull(slot) && aggstate->sort_out)
+		tuplesort_puttupleslot(aggstate->sort_out, slot);
+
+	return slot;
+}
+
+/*
+ * Make grouping set "setno" the current one, so that transition values are
+ * stored in (and AggCheckCallContext reports) its memory context.
+ */
+static void
+select_current_set(AggState *aggstate, int setno)
+{
+	aggstate->current_set = setno;
+	aggstate->aggcontext = aggstate->aggcontexts[setno]->ecxt_per_tuple_memory;
+}
+
+/*
+ * Initialize all aggregates for a new group of input values, for the first
+ * numReset grouping sets of the current phase (or for the only set, if
+ * there are no grouping sets).
  *
  * When called, CurrentMemoryContext should be the per-query context.
  */
 static void
 initialize_aggregates(AggState *aggstate,
 					  AggStatePerAgg peragg,
-					  AggStatePerGroup pergroup)
+					  AggStatePerGroup pergroup,
+					  int numReset)
 {
 	int			aggno;
+	int			setno;
+	int			numaggs = aggstate->numaggs;
 
-	for (aggno = 0; aggno < aggstate->numaggs; aggno++)
+	for (setno = 0; setno < numReset; setno++)
 	{
-		AggStatePerAgg peraggstate = &peragg[aggno];
-		AggStatePerGroup pergroupstate = &pergroup[aggno];
+		select_current_set(aggstate, setno);
 
-		/*
-		 * Start a fresh sort operation for each DISTINCT/ORDER BY aggregate.
-		 */
-		if (peraggstate->numSortCols > 0)
+		for (aggno = 0; aggno < numaggs; aggno++)
 		{
+			AggStatePerAgg peraggstate = &peragg[aggno];
+			AggStatePerGroup pergroupstate = &pergroup[aggno + setno * numaggs];
+
 			/*
-			 * In case of rescan, maybe there could be an uncompleted sort
-			 * operation?  Clean it up if so.
+			 * Start a fresh sort operation for each DISTINCT/ORDER BY
+			 * aggregate.
 			 */
-			if (peraggstate->sortstate)
-				tuplesort_end(peraggstate->sortstate);
+			if (peraggstate->numSortCols > 0)
+			{
+				/*
+				 * In case of rescan, maybe there could be an uncompleted sort
+				 * operation?  Clean it up if so.
+				 */
+				if (peraggstate->sortstates[setno])
+					tuplesort_end(peraggstate->sortstates[setno]);
+
+				/*
+				 * We use a plain Datum sorter when there's a single input
+				 * column; otherwise sort the full tuple.  (See comments for
+				 * process_ordered_aggregate_single.)
+				 */
+				peraggstate->sortstates[setno] =
+					(peraggstate->numInputs == 1) ?
+					tuplesort_begin_datum(peraggstate->evaldesc->attrs[0]->atttypid,
+										  peraggstate->sortOperators[0],
+										  peraggstate->sortCollations[0],
+										  peraggstate->sortNullsFirst[0],
+										  work_mem, false) :
+					tuplesort_begin_heap(peraggstate->evaldesc,
+										 peraggstate->numSortCols,
+										 peraggstate->sortColIdx,
+										 peraggstate->sortOperators,
+										 peraggstate->sortCollations,
+										 peraggstate->sortNullsFirst,
+										 work_mem, false);
+			}
 
 			/*
-			 * We use a plain Datum sorter when there's a single input column;
-			 * otherwise sort the full tuple.  (See comments for
-			 * process_ordered_aggregate_single.)
+			 * (Re)set transValue to the initial value.
+			 *
+			 * Note that when the initial value is pass-by-ref, we must copy
+			 * it (into the aggcontext) since we will pfree the transValue
+			 * later.
 			 */
-			peraggstate->sortstate =
-				(peraggstate->numInputs == 1) ?
-				tuplesort_begin_datum(peraggstate->evaldesc->attrs[0]->atttypid,
-									  peraggstate->sortOperators[0],
-									  peraggstate->sortCollations[0],
-									  peraggstate->sortNullsFirst[0],
-									  work_mem, false) :
-				tuplesort_begin_heap(peraggstate->evaldesc,
-									 peraggstate->numSortCols,
-									 peraggstate->sortColIdx,
-									 peraggstate->sortOperators,
-									 peraggstate->sortCollations,
-									 peraggstate->sortNullsFirst,
-									 work_mem, false);
-		}
-
-		/*
-		 * (Re)set transValue to the initial value.
-		 *
-		 * Note that when the initial value is pass-by-ref, we must copy it
-		 * (into the aggcontext) since we will pfree the transValue later.
-		 */
-		if (peraggstate->initValueIsNull)
-			pergroupstate->transValue = peraggstate->initValue;
-		else
-		{
-			MemoryContext oldContext;
+			if (peraggstate->initValueIsNull)
+				pergroupstate->transValue = peraggstate->initValue;
+			else
+			{
+				MemoryContext oldContext;
 
-			oldContext = MemoryContextSwitchTo(aggstate->aggcontext);
-			pergroupstate->transValue = datumCopy(peraggstate->initValue,
-												  peraggstate->transtypeByVal,
+				oldContext = MemoryContextSwitchTo(aggstate->aggcontext);
+				pergroupstate->transValue = datumCopy(peraggstate->initValue,
+												peraggstate->transtypeByVal,
 												  peraggstate->transtypeLen);
-			MemoryContextSwitchTo(oldContext);
-		}
-		pergroupstate->transValueIsNull = peraggstate->initValueIsNull;
+				MemoryContextSwitchTo(oldContext);
+			}
+			pergroupstate->transValueIsNull = peraggstate->initValueIsNull;
 
-		/*
-		 * If the initial value for the transition state doesn't exist in the
-		 * pg_aggregate table then we will let the first non-NULL value
-		 * returned from the outer procNode become the initial value. (This is
-		 * useful for aggregates like max() and min().) The noTransValue flag
-		 * signals that we still need to do this.
-		 */
-		pergroupstate->noTransValue = peraggstate->initValueIsNull;
+			/*
+			 * If the initial value for the transition state doesn't exist in
+			 * the pg_aggregate table then we will let the first non-NULL
+			 * value returned from the outer procNode become the initial
+			 * value. (This is useful for aggregates like max() and min().)
+			 * The noTransValue flag signals that we still need to do this.
+			 */
+			pergroupstate->noTransValue = peraggstate->initValueIsNull;
+		}
 	}
 }
 
@@ -513,7 +774,8 @@ advance_transition_function(AggState *aggstate,
  * Advance all the aggregates for one input tuple.	The input tuple
  * has been stored in tmpcontext->ecxt_outertuple, so that it is accessible
  * to ExecEvalExpr.  pergroup is the array of per-group structs to use
- * (this might be in a hashtable entry).
+ * (this might be in a hashtable entry), with an entry per aggregate for
+ * each grouping set of the current phase.
  *
  * When called, CurrentMemoryContext should be the per-query context.
  */
@@ -521,11 +783,13 @@ static void
 advance_aggregates(AggState *aggstate, AggStatePerGroup pergroup)
 {
 	int			aggno;
+	int			setno;
+	int			numGroupingSets = Max(aggstate->phase->numsets, 1);
+	int			numaggs = aggstate->numaggs;
 
-	for (aggno = 0; aggno < aggstate->numaggs; aggno++)
+	for (aggno = 0; aggno < numaggs; aggno++)
 	{
 		AggStatePerAgg peraggstate = &aggstate->peragg[aggno];
-		AggStatePerGroup pergroupstate = &pergroup[aggno];
 		ExprState  *filter = peraggstate->aggrefstate->aggfilter;
 		int			numTransInputs = peraggstate->numTransInputs;
 		int			i;
@@ -569,13 +833,17 @@ advance_aggregates(AggState *aggstate, AggStatePerGroup pergroup)
 					continue;
 			}
 
-			/* OK, put the tuple into the tuplesort object */
-			if (peraggstate->numInputs == 1)
-				tuplesort_putdatum(peraggstate->sortstate,
-								   slot->tts_values[0],
-								   slot->tts_isnull[0]);
-			else
-				tuplesort_puttupleslot(peraggstate->sortstate, slot);
+			for (setno = 0; setno < numGroupingSets; setno++)
+			{
+				/* OK, put the tuple into the tuplesort object */
+				if (peraggstate->numInputs == 1)
+					tuplesort_putdatum(peraggstate->sortstates[setno],
+									   slot->tts_values[0],
+									   slot->tts_isnull[0]);
+				else
+					tuplesort_puttupleslot(peraggstate->sortstates[setno],
+										   slot);
+			}
 		}
 		else
 		{
@@ -591,12 +859,98 @@ advance_aggregates(AggState *aggstate, AggStatePerGroup pergroup)
 				fcinfo->argnull[i + 1] = slot->tts_isnull[i];
 			}
 
-			advance_transition_function(aggstate, peraggstate, pergroupstate);
+			/*
+			 * If we're combining serialized partial states, turn the input
+			 * back into the aggregate's real state type.  The result only
+			 * has to last until the combinefn has absorbed it.
+			 */
+			if (OidIsValid(peraggstate->deserialfn_oid) && !fcinfo->argnull[1])
+			{
+				FunctionCallInfoData dsinfo;
+				MemoryContext oldContext;
+
+				oldContext = MemoryContextSwitchTo(aggstate->tmpcontext->ecxt_per_tuple_memory);
+				InitFunctionCallInfoData(dsinfo, &peraggstate->deserialfn, 2,
+										 InvalidOid, (void *) aggstate, NULL);
+				dsinfo.arg[0] = fcinfo->arg[1];
+				dsinfo.argnull[0] = false;
+				/* dummy second argument, which is of type internal */
+				dsinfo.arg[1] = PointerGetDatum(NULL);
+				dsinfo.argnull[1] = false;
+
+				fcinfo->arg[1] = FunctionCallInvoke(&dsinfo);
+				fcinfo->argnull[1] = dsinfo.isnull;
+				MemoryContextSwitchTo(oldContext);
+			}
+
+			for (setno = 0; setno < numGroupingSets; setno++)
+			{
+				AggStatePerGroup pergroupstate;
+
+				pergroupstate = &pergroup[aggno + setno * numaggs];
+
+				select_current_set(aggstate, setno);
+				advance_transition_function(aggstate, peraggstate,
+											pergroupstate);
+			}
 		}
 	}
 }
 
 
+/*
+ * Advance all the aggregates over the whole input, read a batch at a time.
+ *
+ * Each aggregate's inputs are plain columns of the batch, so we can load
+ * them straight into the transition function's arguments, and run each
+ * transition function in a loop over the batch.
+ *
+ * When called, CurrentMemoryContext should be the per-query context.
+ */
+static void
+advance_aggregates_batch(AggState *aggstate, AggStatePerGroup pergroup)
+{
+	PlanState  *outerPlan = outerPlanState(aggstate);
+	TupleBatch *batch = aggstate->batch;
+
+	while (ExecProcNodeBatch(outerPlan, batch) > 0)
+	{
+		int			aggno;
+
+		aggstate->input_batches++;
+
+		for (aggno = 0; aggno < aggstate->numaggs; aggno++)
+		{
+			AggStatePerAgg peraggstate = &aggstate->peragg[aggno];
+			AggStatePerGroup pergroupstate = &pergroup[aggno];
+			FunctionCallInfo fcinfo = &peraggstate->transfn_fcinfo;
+			int			numTransInputs = peraggstate->numTransInputs;
+			int			row;
+			int			i;
+
+			for (row = 0; row < batch->nrows; row++)
+			{
+				/* arg 0 will be the transition value */
+				for (i = 0; i < numTransInputs; i++)
+				{
+					int			col = peraggstate->batchInputCols[i];
+
+					fcinfo->arg[i + 1] = batch->values[col][row];
+					fcinfo->argnull[i + 1] = batch->isnull[col][row];
+				}
+
+				advance_transition_function(aggstate, peraggstate,
+											pergroupstate);
+			}
+		}
+
+		/* Reset per-input-tuple context after each batch */
+		ResetExprContext(aggstate->tmpcontext);
+	}
+
+	TupleBatchReset(batch);
+}
+
 /*
  * Run the transition function for a DISTINCT or ORDER BY aggregate
  * with only one input.  This is called after we have completed
@@ -630,10 +984,11 @@ process_ordered_aggregate_single(AggState *aggstate,
 	FunctionCallInfo fcinfo = &peraggstate->transfn_fcinfo;
 	Datum	   *newVal;
 	bool	   *isNull;
+	Tuplesortstate *sortstate = peraggstate->sortstates[aggstate->current_set];
 
 	Assert(peraggstate->numDistinctCols < 2);
 
-	tuplesort_performsort(peraggstate->sortstate);
+	tuplesort_performsort(sortstate);
 
 	/* Load the column into argument 1 (arg 0 will be transition value) */
 	newVal = fcinfo->arg + 1;
@@ -645,8 +1000,7 @@ process_ordered_aggregate_single(AggState *aggstate,
 	 * pfree them when they are no longer needed.
 	 */
 
-	while (tuplesort_getdatum(peraggstate->sortstate, true,
-							  newVal, isNull))
+	while (tuplesort_getdatum(sortstate, true, newVal, isNull))
 	{
 		/*
 		 * Clear and select the working context for evaluation of the equality
@@ -689,8 +1043,8 @@ process_ordered_aggregate_single(AggState *aggstate,
 	if (!oldIsNull && !peraggstate->inputtypeByVal)
 		pfree(DatumGetPointer(oldVal));
 
-	tuplesort_end(peraggstate->sortstate);
-	peraggstate->sortstate = NULL;
+	tuplesort_end(sortstate);
+	peraggstate->sortstates[aggstate->current_set] = NULL;
 }
 
 /*
@@ -714,15 +1068,16 @@ process_ordered_aggregate_multi(AggState *aggstate,
 	int			numTransInputs = peraggstate->numTransInputs;
 	int			numDistinctCols = peraggstate->numDistinctCols;
 	bool		haveOldValue = false;
+	Tuplesortstate *sortstate = peraggstate->sortstates[aggstate->current_set];
 	int			i;
 
-	tuplesort_performsort(peraggstate->sortstate);
+	tuplesort_performsort(sortstate);
 
 	ExecClearTuple(slot1);
 	if (slot2)
 		ExecClearTuple(slot2);
 
-	while (tuplesort_gettupleslot(peraggstate->sortstate, true, slot1))
+	while (tuplesort_gettupleslot(sortstate, true, slot1))
 	{
 		/*
 		 * Extract the first numTransInputs columns as datums to pass to the
@@ -770,8 +1125,8 @@ process_ordered_aggregate_multi(AggState *aggstate,
 	if (slot2)
 		ExecClearTuple(slot2);
 
-	tuplesort_end(peraggstate->sortstate);
-	peraggstate->sortstate = NULL;
+	tuplesort_end(sortstate);
+	peraggstate->sortstates[aggstate->current_set] = NULL;
 }
 
 /*
@@ -812,9 +1167,30 @@ finalize_aggregate(AggState *aggstate,
 	}
 
 	/*
-	 * Apply the agg's finalfn if one is provided, else return transValue.
+	 * Apply the agg's finalfn if one is provided, else return transValue.  A
+	 * partial aggregate has no finalfn here, but may need its transValue
+	 * serialized.
 	 */
-	if (OidIsValid(peraggstate->finalfn_oid))
+	if (OidIsValid(peraggstate->serialfn_oid))
+	{
+		if (pergroupstate->transValueIsNull)
+		{
+			/* serialfn is strict, and NULL means no input anyway */
+			*resultVal = (Datum) 0;
+			*resultIsNull = true;
+		}
+		else
+		{
+			InitFunctionCallInfoData(fcinfo, &(peraggstate->serialfn), 1,
+									 InvalidOid, (void *) aggstate, NULL);
+			fcinfo.arg[0] = pergroupstate->transValue;
+			fcinfo.argnull[0] = false;
+
+			*resultVal = FunctionCallInvoke(&fcinfo);
+			*resultIsNull = fcinfo.isnull;
+		}
+	}
+	else if (OidIsValid(peraggstate->finalfn_oid))
 	{
 		int			numFinalArgs;
 
@@ -884,6 +1260,151 @@ finalize_aggregate(AggState *aggstate,
 	MemoryContextSwitchTo(oldContext);
 }
 
+
+/*
+ * Prepare to finalize and project based on the specified representative tuple
+ * slot and grouping set.
+ *
+ * In the specified tuple slot, force to null all attributes that should be
+ * read as null in the context of the current grouping set.  Also stash the
+ * current group bitmap where GROUPING() can get at it.
+ *
+ * This relies on three conditions:
+ *
+ * 1) Nothing is ever going to try and extract the whole tuple from this slot,
+ * only reference it in evaluations, which will only access individual
+ * attributes.
+ *
+ * 2) No system columns are going to need to be nulled. (If a system column is
+ * referenced in a group clause, it is actually projected in the outer plan
+ * tlist.)
+ *
+ * 3) Within a given phase, we never need to recover the value of an attribute
+ * once it has been set to null.
+ *
+ */
+static void
+prepare_projection_slot(AggState *aggstate, TupleTableSlot *slot, int currentSet)
+{
+	if (aggstate->phase->grouped_cols)
+	{
+		Bitmapset  *grouped_cols = aggstate->phase->grouped_cols[currentSet];
+
+		aggstate->grouped_cols = grouped_cols;
+
+		if (slot->tts_isempty)
+		{
+			/*
+			 * Force all values to be NULL if working on an empty input tuple
+			 * (i.e. an empty grouping set for which no input rows were
+			 * supplied).
+			 */
+			ExecStoreAllNullTuple(slot);
+		}
+		else if (aggstate->all_grouped_cols)
+		{
+			ListCell   *lc;
+
+			/* all_grouped_cols is arranged in desc order */
+			slot_getsomeattrs(slot, linitial_int(aggstate->all_grouped_cols));
+
+			foreach(lc, aggstate->all_grouped_cols)
+			{
+				int			attnum = lfirst_int(lc);
+
+				if (!bms_is_member(attnum, grouped_cols))
+					slot->tts_isnull[attnum - 1] = true;
+			}
+		}
+	}
+}
+
+/*
+ * Compute the final value of all aggregates for one group.
+ *
+ * This function handles only one grouping set at a time.
+ *
+ * Results are stored in the output econtext aggvalues/aggnulls.
+ */
+static void
+finalize_aggregates(AggState *aggstate,
+					AggStatePerAgg peragg,
+					AggStatePerGroup pergroup,
+					int currentSet)
+{
+	ExprContext *econtext = aggstate->ss.ps.ps_ExprContext;
+	Datum	   *aggvalues = econtext->ecxt_aggvalues;
+	bool	   *aggnulls = econtext->ecxt_aggnulls;
+	int			aggno;
+
+	Assert(currentSet == 0 ||
+		   ((Agg *) aggstate->ss.ps.plan)->aggstrategy != AGG_HASHED);
+
+	select_current_set(aggstate, currentSet);
+
+	for (aggno = 0; aggno < aggstate->numaggs; aggno++)
+	{
+		AggStatePerAgg peraggstate = &peragg[aggno];
+		AggStatePerGroup pergroupstate;
+
+		pergroupstate = &pergroup[aggno + (currentSet * (aggstate->numaggs))];
+
+		if (peraggstate->numSortCols > 0)
+		{
+			Assert(((Agg *) aggstate->ss.ps.plan)->aggstrategy != AGG_HASHED);
+
+			if (peraggstate->numInputs == 1)
+				process_ordered_aggregate_single(aggstate,
+												 peraggstate,
+												 pergroupstate);
+			else
+				process_ordered_aggregate_multi(aggstate,
+												peraggstate,
+												pergroupstate);
+		}
+
+		finalize_aggregate(aggstate, peraggstate, pergroupstate,
+						   &aggvalues[aggno], &aggnulls[aggno]);
+	}
+}
+
+/*
+ * Project the result of a group (whose aggs have already been calculated by
+ * finalize_aggregates). Returns the result slot, or NULL if no row is
+ * projected (suppressed by qual or by an empty SRF).
+ */
+static TupleTableSlot *
+project_aggregates(AggState *aggstate)
+{
+	ExprContext *econtext = aggstate->ss.ps.ps_ExprContext;
+
+	/*
+	 * Check the qual (HAVING clause); if the group does not match, ignore it.
+	 */
+	if (ExecQual(aggstate->ss.ps.qual, econtext, false))
+	{
+		/*
+		 * Form and return or store a projection tuple using the aggregate
+		 * results and the representative input tuple.
+		 */
+		ExprDoneCond isDone;
+		TupleTableSlot *result;
+
+		result = ExecProject(aggstate->ss.ps.ps_ProjInfo, &isDone);
+
+		if (isDone != ExprEndResult)
+		{
+			aggstate->ss.ps.ps_TupFromTlist =
+				(isDone == ExprMultipleResult);
+			return result;
+		}
+	}
+	else
+		InstrCountFiltered1(aggstate, 1);
+
+	return NULL;
+}
+
 /*
  * find_unaggregated_cols
  *	  Construct a bitmapset of the column numbers of un-aggregated Vars
@@ -918,21 +1439,25 @@ find_unaggregated_cols_walker(Node *node, Bitmapset **colnos)
 		*colnos = bms_add_member(*colnos, var->varattno);
 		return false;
 	}
-	if (IsA(node, Aggref))		/* do not descend into aggregate exprs */
+	if (IsA(node, Aggref) || IsA(node, GroupingFunc))
+	{
+		/* do not descend into aggregate exprs */
 		return false;
+	}
 	return expression_tree_walker(node, find_unaggregated_cols_walker,
 								  (void *) colnos);
 }
 
 /*
- * Initialize the hash table to empty.
+ * Initialize the hash table of the current phase to empty.
  *
  * The hash table always lives in the aggcontext memory context.
  */
 static void
 build_hash_table(AggState *aggstate)
 {
-	Agg		   *node = (Agg *) aggstate->ss.ps.plan;
+	AggStatePerPhase phase = aggstate->phase;
+	Agg		   *node = phase->aggnode;
 	MemoryContext tmpmem = aggstate->tmpcontext->ecxt_per_tuple_memory;
 	Size		entrysize;
 
@@ -942,14 +1467,14 @@ build_hash_table(AggState *aggstate)
 	entrysize = sizeof(AggHashEntryData) +
 		(aggstate->numaggs - 1) * sizeof(AggStatePerGroupData);
 
-	aggstate->hashtable = BuildTupleHashTable(node->numCols,
-											  node->grpColIdx,
-											  aggstate->eqfunctions,
-											  aggstate->hashfunctions,
-											  node->numGroups,
-											  entrysize,
-											  aggstate->aggcontext,
-											  tmpmem);
+	phase->hashtable = BuildTupleHashTable(node->numCols,
+										   node->grpColIdx,
+										   phase->eqfunctions,
+										   phase->hashfunctions,
+										   node->numGroups,
+										   entrysize,
+										   aggstate->aggcontext,
+										   tmpmem);
 }
 
 /*
@@ -976,18 +1501,25 @@ build_hash_table(AggState *aggstate)
  * columns.  However, the search will be needed when we add support for
  * SQL99 semantics that allow use of "functionally dependent" columns that
  * haven't been explicitly grouped by.
+ *
+ * With grouping sets, the grouping columns of the other sets always read as
+ * NULL in the output of this phase, so there's no need to store them.
  */
 static List *
 find_hash_columns(AggState *aggstate)
 {
-	Agg		   *node = (Agg *) aggstate->ss.ps.plan;
+	Agg		   *node = aggstate->phase->aggnode;
 	Bitmapset  *colnos;
 	List	   *collist;
+	ListCell   *lc;
 	int			i;
 
 	/* Find Vars that will be needed in tlist and qual */
 	colnos = find_unaggregated_cols(aggstate);
-	/* Add in all the grouping columns */
+	/* ... less the ones that belong to other grouping sets */
+	foreach(lc, aggstate->all_grouped_cols)
+		colnos = bms_del_member(colnos, lfirst_int(lc));
+	/* Add in all the grouping columns of this phase */
 	for (i = 0; i < node->numCols; i++)
 		colnos = bms_add_member(colnos, node->grpColIdx[i]);
 	/* Convert to list, using lcons so largest element ends up first */
@@ -1021,17 +1553,19 @@ hash_agg_entry_size(int numAggs)
 
 /*
  * Find or create a hashtable entry for the tuple group containing the
- * given tuple.
+ * given tuple.  If we're in spill mode, new groups aren't created; NULL is
+ * returned instead, and the caller must spill the tuple.
  *
  * When called, CurrentMemoryContext should be the per-query context.
  */
 static AggHashEntry
 lookup_hash_entry(AggState *aggstate, TupleTableSlot *inputslot)
 {
-	TupleTableSlot *hashslot = aggstate->hashslot;
+	AggStatePerPhase phase = aggstate->phase;
+	TupleTableSlot *hashslot = phase->hashslot;
 	ListCell   *l;
 	AggHashEntry entry;
-	bool		isnew;
+	bool		isnew = false;
 
 	/* if first time through, initialize hashslot by cloning input slot */
 	if (hashslot->tts_tupleDescriptor == NULL)
@@ -1042,8 +1576,8 @@ lookup_hash_entry(AggState *aggstate, TupleTableSlot *inputslot)
 	}
 
 	/* transfer just the needed columns into hashslot */
-	slot_getsomeattrs(inputslot, linitial_int(aggstate->hash_needed));
-	foreach(l, aggstate->hash_needed)
+	slot_getsomeattrs(inputslot, linitial_int(phase->hash_needed));
+	foreach(l, phase->hash_needed)
 	{
 		int			varNumber = lfirst_int(l) - 1;
 
@@ -1052,27 +1586,315 @@ lookup_hash_entry(AggState *aggstate, TupleTableSlot *inputslot)
 	}
 
 	/* find or create the hashtable entry using the filtered tuple */
-	entry = (AggHashEntry) LookupTupleHashEntry(aggstate->hashtable,
+	entry = (AggHashEntry) LookupTupleHashEntry(phase->hashtable,
 												hashslot,
-												&isnew);
+								 aggstate->hash_spill_mode ? NULL : &isnew);
 
 	if (isnew)
 	{
 		/* initialize aggregates for new tuple group */
-		initialize_aggregates(aggstate, aggstate->peragg, entry->pergroup);
+		initialize_aggregates(aggstate, aggstate->peragg, entry->pergroup, 1);
+
+		/* and see whether that took us over work_mem */
+		hash_agg_check_limits(aggstate);
 	}
 
 	return entry;
 }
 
 /*
- * ExecAgg -
+ * Check whether the hash table and transition values have outgrown
+ * work_mem, and if so, switch to spill mode.
  *
- *	  ExecAgg receives tuples from its outer subplan and aggregates over
- *	  the appropriate attribute for each aggregate function use (Aggref
- *	  node) appearing in the targetlist or qual of the node.  The number
- *	  of tuples to aggregate over depends on whether grouped or plain
- *	  aggregation is selected.	In grouped aggregation, we produce a result
+ * We only check when a new group is created.  Transition values of existing
+ * groups can grow too (think array_agg), but there's nothing we could do
+ * about that short of spilling partially aggregated states.
+ *
+ * With hashed grouping sets, the tables of all the sets share aggcontext, so
+ * we check their total size and all of them stop growing together.
+ */
+static void
+hash_agg_check_limits(AggState *aggstate)
+{
+	Size		mem = MemoryContextMemAllocated(aggstate->aggcontext);
+
+	if (mem > aggstate->hash_mem_peak)
+		aggstate->hash_mem_peak = mem;
+
+	if (mem > work_mem * 1024L && !aggstate->hash_spill_mode)
+		hash_agg_enter_spill_mode(aggstate);
+}
+
+/*
+ * Stop adding groups to the hash tables, and set up spill files to receive
+ * the tuples of any new groups.  Each phase (that is, each hashed grouping
+ * set) gets its own set of spill files.
+ *
+ * We aim for about a quarter of work_mem worth of BufFile buffers, within
+ * sane limits.  If the batch has already been partitioned so many times
+ * that we're out of hash bits, don't spill at all.
+ */
+static void
+hash_agg_enter_spill_mode(AggState *aggstate)
+{
+	HashAggSpill *spill;
+	long		npartitions;
+	int			partition_bits;
+	int			phaseno;
+
+	npartitions = (work_mem * 1024L / 4) / BLCKSZ / aggstate->numphases;
+	npartitions = Max(npartitions, HASHAGG_MIN_PARTITIONS);
+	npartitions = Min(npartitions, HASHAGG_MAX_PARTITIONS);
+
+	/* round down to a power of 2 */
+	partition_bits = 0;
+	while ((1L << (partition_bits + 1)) <= npartitions)
+		partition_bits++;
+	partition_bits = Min(partition_bits, 32 - aggstate->hash_used_bits);
+	if (partition_bits <= 0)
+		return;
+
+	spill = (HashAggSpill *)
+		palloc(aggstate->numphases * sizeof(HashAggSpill));
+	for (phaseno = 0; phaseno < aggstate->numphases; phaseno++)
+	{
+		spill[phaseno].npartitions = 1 << partition_bits;
+		spill[phaseno].partition_bits = partition_bits;
+		spill[phaseno].partitions = (BufFile **)
+			palloc0(spill[phaseno].npartitions * sizeof(BufFile *));
+	}
+
+	aggstate->hash_spill = spill;
+	aggstate->hash_spill_mode = true;
+	aggstate->hash_spilled = true;
+}
+
+/*
+ * Compute the hash value of the grouping columns of an input tuple.
+ *
+ * This is the same calculation as TupleHashTableHash, which we can't call
+ * directly because it works from inside a hash table lookup.
+ */
+static uint32
+hash_agg_hash_tuple(AggState *aggstate, TupleTableSlot *slot)
+{
+	Agg		   *node = aggstate->phase->aggnode;
+	MemoryContext oldContext;
+	uint32		hashkey = 0;
+	int			i;
+
+	/* Reset-able context in case the hash functions leak memory */
+	oldContext =
+		MemoryContextSwitchTo(aggstate->tmpcontext->ecxt_per_tuple_memory);
+
+	for (i = 0; i < node->numCols; i++)
+	{
+		AttrNumber	att = node->grpColIdx[i];
+		Datum		attr;
+		bool		isNull;
+
+		/* rotate hashkey left 1 bit at each step */
+		hashkey = (hashkey << 1) | ((hashkey & 0x80000000) ? 1 : 0);
+
+		attr = slot_getattr(slot, att, &isNull);
+
+		if (!isNull)			/* treat nulls as having hash key 0 */
+		{
+			uint32		hkey;
+
+			hkey = DatumGetUInt32(FunctionCall1(&aggstate->phase->hashfunctions[i],
+												attr));
+			hashkey ^= hkey;
+		}
+	}
+
+	MemoryContextSwitchTo(oldContext);
+
+	return hashkey;
+}
+
+/*
+ * Write an input tuple, whose group isn't in the current phase's hash table,
+ * to that phase's spill file selected by its hash value.
+ *
+ * When called, CurrentMemoryContext should be the per-query context.
+ */
+static void
+hash_agg_spill_tuple(AggState *aggstate, TupleTableSlot *slot,
+					 uint32 hashvalue)
+{
+	HashAggSpill *spill;
+	MinimalTuple tuple;
+	BufFile    *file;
+	int			partno;
+	size_t		written;
+
+	Assert(aggstate->hash_spill != NULL);
+	spill = &aggstate->hash_spill[aggstate->phase - aggstate->phases];
+
+	partno = (hashvalue << aggstate->hash_used_bits) >>
+		(32 - spill->partition_bits);
+
+	file = spill->partitions[partno];
+	if (file == NULL)
+	{
+		/* First write to this spill file, so open it */
+		file = BufFileCreateTemp(false);
+		spill->partitions[partno] = file;
+	}
+
+	tuple = ExecFetchSlotMinimalTuple(slot);
+
+	written = BufFileWrite(file, (void *) &hashvalue, sizeof(uint32));
+	if (written != sizeof(uint32))
+		ereport(ERROR,
+				(errcode_for_file_access(),
+				 errmsg("could not write to hash-aggregate temporary file: %m")));
+
+	written = BufFileWrite(file, (void *) tuple, tuple->t_len);
+	if (written != tuple->t_len)
+		ereport(ERROR,
+				(errcode_for_file_access(),
+				 errmsg("could not write to hash-aggregate temporary file: %m")));
+
+	aggstate->hash_disk_used += sizeof(uint32) + tuple->t_len;
+}
+
+/*
+ * Read the next tuple from a spill file, storing it in the given slot.
+ * Returns false at end of file.
+ */
+static bool
+hash_agg_read_spilled(BufFile *file, TupleTableSlot *slot, uint32 *hashvalue)
+{
+	uint32		header[2];
+	size_t		nread;
+	MinimalTuple tuple;
+
+	/*
+	 * Like ExecHashJoinGetSavedTuple, read the hash value and the tuple
+	 * length at once, then the rest of the tuple.
+	 */
+	nread = BufFileRead(file, (void *) header, sizeof(header));
+	if (nread == 0)				/* end of file */
+	{
+		ExecClearTuple(slot);
+		return false;
+	}
+	if (nread != sizeof(header))
+		ereport(ERROR,
+				(errcode_for_file_access(),
+				 errmsg("could not read from hash-aggregate temporary file: %m")));
+	*hashvalue = header[0];
+	tuple = (MinimalTuple) palloc(header[1]);
+	tuple->t_len = header[1];
+	nread = BufFileRead(file,
+						(void *) ((char *) tuple + sizeof(uint32)),
+						header[1] - sizeof(uint32));
+	if (nread != header[1] - sizeof(uint32))
+		ereport(ERROR,
+				(errcode_for_file_access(),
+				 errmsg("could not read from hash-aggregate temporary file: %m")));
+	ExecStoreMinimalTuple(tuple, slot, true);
+	return true;
+}
+
+/*
+ * At the end of a pass over the input, turn the spill files written during
+ * the pass into batches to be processed later.
+ *
+ * New batches go on the front of the list, so that we finish splitting one
+ * oversized batch before moving on to the next; that keeps the number of
+ * spill files in existence at any one time down.
+ */
+static void
+hash_agg_finish_spill(AggState *aggstate)
+{
+	Size		mem;
+	int			phaseno;
+	int			i;
+
+	/* Transition values may have grown since the last group was added */
+	mem = MemoryContextMemAllocated(aggstate->aggcontext);
+	if (mem > aggstate->hash_mem_peak)
+		aggstate->hash_mem_peak = mem;
+
+	if (aggstate->hash_spill == NULL)
+		return;
+
+	for (phaseno = aggstate->numphases - 1; phaseno >= 0; phaseno--)
+	{
+		HashAggSpill *spill = &aggstate->hash_spill[phaseno];
+
+		for (i = spill->npartitions - 1; i >= 0; i--)
+		{
+			HashAggBatch *batch;
+
+			if (spill->partitions[i] == NULL)
+				continue;
+
+			batch = (HashAggBatch *) palloc(sizeof(HashAggBatch));
+			batch->input_file = spill->partitions[i];
+			batch->used_bits = aggstate->hash_used_bits + spill->partition_bits;
+			batch->phase = phaseno;
+			aggstate->hash_batches = lcons(batch, aggstate->hash_batches);
+		}
+		pfree(spill->partitions);
+	}
+
+	pfree(aggstate->hash_spill);
+	aggstate->hash_spill = NULL;
+}
+
+/*
+ * Close any spill files, whether still being written or waiting to be read.
+ */
+static void
+hash_agg_release_spill(AggState *aggstate)
+{
+	ListCell   *lc;
+
+	if (aggstate->hash_spill != NULL)
+	{
+		int			phaseno;
+		int			i;
+
+		for (phaseno = 0; phaseno < aggstate->numphases; phaseno++)
+		{
+			HashAggSpill *spill = &aggstate->hash_spill[phaseno];
+
+			for (i = 0; i < spill->npartitions; i++)
+			{
+				if (spill->partitions[i] != NULL)
+					BufFileClose(spill->partitions[i]);
+			}
+			pfree(spill->partitions);
+		}
+		pfree(aggstate->hash_spill);
+		aggstate->hash_spill = NULL;
+	}
+
+	foreach(lc, aggstate->hash_batches)
+	{
+		HashAggBatch *batch = (HashAggBatch *) lfirst(lc);
+
+		BufFileClose(batch->input_file);
+	}
+	list_free_deep(aggstate->hash_batches);
+	aggstate->hash_batches = NIL;
+
+	aggstate->hash_spill_mode = false;
+	aggstate->hash_used_bits = 0;
+}
+
+/*
+ * ExecAgg -
+ *
+ *	  ExecAgg receives tuples from its outer subplan and aggregates over
+ *	  the appropriate attribute for each aggregate function use (Aggref
+ *	  node) appearing in the targetlist or qual of the node.  The number
+ *	  of tuples to aggregate over depends on whether grouped or plain
+ *	  aggregation is selected.	In grouped aggregation, we produce a result
  *	  row for each group; in plain aggregation there's a single result row
  *	  for the whole query.	In either case, the value of each aggregate is
  *	  stored in the expression context to be used when ExecProject evaluates
@@ -1123,28 +1945,31 @@ ExecAgg(AggState *node)
 static TupleTableSlot *
 agg_retrieve_direct(AggState *aggstate)
 {
-	Agg		   *node = (Agg *) aggstate->ss.ps.plan;
-	PlanState  *outerPlan;
+	Agg		   *node = aggstate->phase->aggnode;
 	ExprContext *econtext;
 	ExprContext *tmpcontext;
-	Datum	   *aggvalues;
-	bool	   *aggnulls;
 	AggStatePerAgg peragg;
 	AggStatePerGroup pergroup;
 	TupleTableSlot *outerslot;
 	TupleTableSlot *firstSlot;
-	int			aggno;
+	TupleTableSlot *result;
+	bool		hasGroupingSets = aggstate->phase->numsets > 0;
+	int			numGroupingSets = Max(aggstate->phase->numsets, 1);
+	int			currentSet;
+	int			nextSetSize;
+	int			numReset;
+	int			i;
 
 	/*
 	 * get state info from node
+	 *
+	 * econtext is the per-output-tuple expression context
+	 *
+	 * tmpcontext is the per-input-tuple expression context
 	 */
-	outerPlan = outerPlanState(aggstate);
-	/* econtext is the per-output-tuple expression context */
 	econtext = aggstate->ss.ps.ps_ExprContext;
-	aggvalues = econtext->ecxt_aggvalues;
-	aggnulls = econtext->ecxt_aggnulls;
-	/* tmpcontext is the per-input-tuple expression context */
 	tmpcontext = aggstate->tmpcontext;
+
 	peragg = aggstate->peragg;
 	pergroup = aggstate->pergroup;
 	firstSlot = aggstate->ss.ss_ScanTupleSlot;
@@ -1152,38 +1977,18 @@ agg_retrieve_direct(AggState *aggstate)
 	/*
 	 * We loop retrieving groups until we find one matching
 	 * aggstate->ss.ps.qual
+	 *
+	 * For grouping sets, we have the invariant that aggstate->projected_set
+	 * is either -1 (initial call) or the index (starting from 0) in
+	 * gset_lengths for the group we just completed (either by projecting a
+	 * row or by discarding it in the qual).
 	 */
 	while (!aggstate->agg_done)
 	{
-		/*
-		 * If we don't already have the first tuple of the new group, fetch it
-		 * from the outer plan.
-		 */
-		if (aggstate->grp_firstTuple == NULL)
-		{
-			outerslot = ExecProcNode(outerPlan);
-			if (!TupIsNull(outerslot))
-			{
-				/*
-				 * Make a copy of the first input tuple; we will use this for
-				 * comparisons (in group mode) and for projection.
-				 */
-				aggstate->grp_firstTuple = ExecCopySlotTuple(outerslot);
-			}
-			else
-			{
-				/* outer plan produced no tuples at all */
-				aggstate->agg_done = true;
-				/* If we are grouping, we should produce no tuples too */
-				if (node->aggstrategy != AGG_PLAIN)
-					return NULL;
-			}
-		}
-
 		/*
 		 * Clear the per-output-tuple context for each group, as well as
 		 * aggcontext (which contains any pass-by-ref transvalues of the old
-		 * group).	We also clear any child contexts of the aggcontext; some
+		 * group).  We also clear any child contexts of the aggcontext; some
 		 * aggregate functions store working state in such contexts.
 		 *
 		 * We use ReScanExprContext not just ResetExprContext because we want
@@ -1193,131 +1998,265 @@ agg_retrieve_direct(AggState *aggstate)
 		 */
 		ReScanExprContext(econtext);
 
-		MemoryContextResetAndDeleteChildren(aggstate->aggcontext);
+		/*
+		 * Determine how many grouping sets need to be reset at this boundary.
+		 */
+		if (aggstate->projected_set >= 0 &&
+			aggstate->projected_set < numGroupingSets)
+			numReset = aggstate->projected_set + 1;
+		else
+			numReset = numGroupingSets;
 
 		/*
-		 * Initialize working state for a new input tuple group
+		 * numReset can change on a phase boundary, but that's OK; we want to
+		 * reset the contexts used in _this_ phase, and later, after possibly
+		 * changing phase, initialize the right number of aggregates for the
+		 * _new_ phase.
 		 */
-		initialize_aggregates(aggstate, peragg, pergroup);
+		for (i = 0; i < numReset; i++)
+		{
+			ReScanExprContext(aggstate->aggcontexts[i]);
+			MemoryContextDeleteChildren(aggstate->aggcontexts[i]->ecxt_per_tuple_memory);
+		}
 
-		if (aggstate->grp_firstTuple != NULL)
+		/*
+		 * Check if input is complete and there are no more groups to project
+		 * in this phase; move to next phase or mark as done.
+		 */
+		if (aggstate->input_done == true &&
+			aggstate->projected_set >= (numGroupingSets - 1))
+		{
+			if (aggstate->current_phase < aggstate->numphases - 1)
+			{
+				initialize_phase(aggstate, aggstate->current_phase + 1);
+				aggstate->input_done = false;
+				aggstate->projected_set = -1;
+				numGroupingSets = Max(aggstate->phase->numsets, 1);
+				node = aggstate->phase->aggnode;
+				numReset = numGroupingSets;
+			}
+			else
+			{
+				aggstate->agg_done = true;
+				break;
+			}
+		}
+
+		/*
+		 * Get the number of columns in the next grouping set after the last
+		 * projected one (if any). This is the number of columns to compare to
+		 * see if we reached the boundary of that set too.
+		 */
+		if (aggstate->projected_set >= 0 &&
+			aggstate->projected_set < (numGroupingSets - 1))
+			nextSetSize = aggstate->phase->gset_lengths[aggstate->projected_set + 1];
+		else
+			nextSetSize = 0;
+
+		/*----------
+		 * If a subgroup for the current grouping set is present, project it.
+		 *
+		 * We have a new group if:
+		 *	- we're out of input but haven't projected all grouping sets
+		 *	  (checked above)
+		 * OR
+		 *	  - we already projected a row that wasn't from the last grouping
+		 *		set
+		 *	  AND
+		 *	  - the next grouping set has at least one grouping column (since
+		 *		empty grouping sets project only once input is exhausted)
+		 *	  AND
+		 *	  - the previous and pending rows differ on the grouping columns
+		 *		of the next grouping set
+		 *----------
+		 */
+		if (aggstate->input_done ||
+			(node->aggstrategy == AGG_SORTED &&
+			 aggstate->projected_set != -1 &&
+			 aggstate->projected_set < (numGroupingSets - 1) &&
+			 nextSetSize > 0 &&
+			 !execTuplesMatch(econtext->ecxt_outertuple,
+							  tmpcontext->ecxt_outertuple,
+							  nextSetSize,
+							  node->grpColIdx,
+							  aggstate->phase->eqfunctions,
+							  tmpcontext->ecxt_per_tuple_memory)))
+		{
+			aggstate->projected_set += 1;
+
+			Assert(aggstate->projected_set < numGroupingSets);
+			Assert(nextSetSize > 0 || aggstate->input_done);
+		}
+		else
 		{
 			/*
-			 * Store the copied first input tuple in the tuple table slot
-			 * reserved for it.  The tuple will be deleted when it is cleared
-			 * from the slot.
+			 * We no longer care what group we just projected, the next
+			 * projection will always be the first (or only) grouping set
+			 * (unless the input proves to be empty).
 			 */
-			ExecStoreTuple(aggstate->grp_firstTuple,
-						   firstSlot,
-						   InvalidBuffer,
-						   true);
-			aggstate->grp_firstTuple = NULL;	/* don't keep two pointers */
-
-			/* set up for first advance_aggregates call */
-			tmpcontext->ecxt_outertuple = firstSlot;
+			aggstate->projected_set = 0;
 
 			/*
-			 * Process each outer-plan tuple, and then fetch the next one,
-			 * until we exhaust the outer plan or cross a group boundary.
+			 * If we don't already have the first tuple of the new group,
+			 * fetch it from the outer plan.
 			 */
-			for (;;)
+			if (aggstate->grp_firstTuple == NULL && aggstate->batch == NULL)
 			{
-				advance_aggregates(aggstate, pergroup);
-
-				/* Reset per-input-tuple context after each tuple */
-				ResetExprContext(tmpcontext);
-
-				outerslot = ExecProcNode(outerPlan);
-				if (TupIsNull(outerslot))
+				outerslot = fetch_input_tuple(aggstate);
+				if (!TupIsNull(outerslot))
 				{
-					/* no more outer-plan tuples available */
-					aggstate->agg_done = true;
-					break;
+					/*
+					 * Make a copy of the first input tuple; we will use this
+					 * for comparisons (in group mode) and for projection.
+					 */
+					aggstate->grp_firstTuple = ExecCopySlotTuple(outerslot);
 				}
-				/* set up for next advance_aggregates call */
-				tmpcontext->ecxt_outertuple = outerslot;
+				else
+				{
+					/* outer plan produced no tuples at all */
+					if (hasGroupingSets)
+					{
+						/*
+						 * If there was no input at all, we need to project
+						 * rows only if there are grouping sets of size 0.
+						 * Note that this implies that there can't be any
+						 * references to ungrouped Vars, which would otherwise
+						 * cause issues with the empty output slot.
+						 */
+						aggstate->input_done = true;
+
+						while (aggstate->phase->gset_lengths[aggstate->projected_set] > 0)
+						{
+							aggstate->projected_set += 1;
+							if (aggstate->projected_set >= numGroupingSets)
+							{
+								/*
+								 * We can't set agg_done here because we might
+								 * have more phases to do, even though the
+								 * input is empty. So we need to restart the
+								 * whole outer loop.
+								 */
+								break;
+							}
+						}
+
+						if (aggstate->projected_set >= numGroupingSets)
+							continue;
+					}
+					else
+					{
+						aggstate->agg_done = true;
+						/* If we are grouping, we should produce no tuples too */
+						if (node->aggstrategy != AGG_PLAIN)
+							return NULL;
+					}
+				}
+			}
 
+			/*
+			 * Initialize working state for a new input tuple group.
+			 */
+			initialize_aggregates(aggstate, peragg, pergroup, numReset);
+
+			if (aggstate->batch != NULL)
+			{
+				/* Plain aggregation reading batches: consume the whole input */
+				advance_aggregates_batch(aggstate, pergroup);
+				aggstate->agg_done = true;
+			}
+			else if (aggstate->grp_firstTuple != NULL)
+			{
 				/*
-				 * If we are grouping, check whether we've crossed a group
-				 * boundary.
+				 * Store the copied first input tuple in the tuple table slot
+				 * reserved for it.  The tuple will be deleted when it is
+				 * cleared from the slot.
 				 */
-				if (node->aggstrategy == AGG_SORTED)
+				ExecStoreTuple(aggstate->grp_firstTuple,
+							   firstSlot,
+							   InvalidBuffer,
+							   true);
+				aggstate->grp_firstTuple = NULL;		/* don't keep two pointers */
+
+				/* set up for first advance_aggregates call */
+				tmpcontext->ecxt_outertuple = firstSlot;
+
+				/*
+				 * Process each outer-plan tuple, and then fetch the next one,
+				 * until we exhaust the outer plan or cross a group boundary.
+				 */
+				for (;;)
 				{
-					if (!execTuplesMatch(firstSlot,
-										 outerslot,
-										 node->numCols, node->grpColIdx,
-										 aggstate->eqfunctions,
-										 tmpcontext->ecxt_per_tuple_memory))
+					advance_aggregates(aggstate, pergroup);
+
+					/* Reset per-input-tuple context after each tuple */
+					ResetExprContext(tmpcontext);
+
+					outerslot = fetch_input_tuple(aggstate);
+					if (TupIsNull(outerslot))
 					{
-						/*
-						 * Save the first input tuple of the next group.
-						 */
-						aggstate->grp_firstTuple = ExecCopySlotTuple(outerslot);
+						/* no more outer-plan tuples available */
+						if (hasGroupingSets)
+							aggstate->input_done = true;
+						else
+							aggstate->agg_done = true;
 						break;
 					}
+					/* set up for next advance_aggregates call */
+					tmpcontext->ecxt_outertuple = outerslot;
+
+					/*
+					 * If we are grouping, check whether we've crossed a group
+					 * boundary.
+					 */
+					if (node->aggstrategy == AGG_SORTED)
+					{
+						if (!execTuplesMatch(firstSlot,
+											 outerslot,
+											 node->numCols,
+											 node->grpColIdx,
+											 aggstate->phase->eqfunctions,
+										  tmpcontext->ecxt_per_tuple_memory))
+						{
+							/*
+							 * Save the first input tuple of the next group.
+							 */
+							aggstate->grp_firstTuple = ExecCopySlotTuple(outerslot);
+							break;
+						}
+					}
 				}
 			}
+
+			/*
+			 * Use the representative input tuple for any references to
+			 * non-aggregated input columns in aggregate direct args, the node
+			 * qual, and the tlist.  (If we are not grouping, and there are no
+			 * input rows at all, we will come here with an empty firstSlot
+			 * ... but if not grouping, there can't be any references to
+			 * non-aggregated input columns, so no problem.)
+			 */
+			econtext->ecxt_outertuple = firstSlot;
 		}
 
-		/*
-		 * Use the representative input tuple for any references to
-		 * non-aggregated input columns in aggregate direct args, the node
-		 * qual, and the tlist.  (If we are not grouping, and there are no
-		 * input rows at all, we will come here with an empty firstSlot ...
-		 * but if not grouping, there can't be any references to
-		 * non-aggregated input columns, so no problem.)
-		 */
-		econtext->ecxt_outertuple = firstSlot;
+		Assert(aggstate->projected_set >= 0);
+
+		currentSet = aggstate->projected_set;
+
+		prepare_projection_slot(aggstate, econtext->ecxt_outertuple, currentSet);
 
 		/*
 		 * Done scanning input tuple group. Finalize each aggregate
 		 * calculation, and stash results in the per-output-tuple context.
 		 */
-		for (aggno = 0; aggno < aggstate->numaggs; aggno++)
-		{
-			AggStatePerAgg peraggstate = &peragg[aggno];
-			AggStatePerGroup pergroupstate = &pergroup[aggno];
-
-			if (peraggstate->numSortCols > 0)
-			{
-				if (peraggstate->numInputs == 1)
-					process_ordered_aggregate_single(aggstate,
-													 peraggstate,
-													 pergroupstate);
-				else
-					process_ordered_aggregate_multi(aggstate,
-													peraggstate,
-													pergroupstate);
-			}
-
-			finalize_aggregate(aggstate, peraggstate, pergroupstate,
-							   &aggvalues[aggno], &aggnulls[aggno]);
-		}
+		finalize_aggregates(aggstate, peragg, pergroup, currentSet);
 
 		/*
-		 * Check the qual (HAVING clause); if the group does not match, ignore
-		 * it and loop back to try to process another group.
+		 * If there's no row to project right now, we must continue rather
+		 * than returning a null since there might be more groups.
 		 */
-		if (ExecQual(aggstate->ss.ps.qual, econtext, false))
-		{
-			/*
-			 * Form and return a projection tuple using the aggregate results
-			 * and the representative input tuple.
-			 */
-			TupleTableSlot *result;
-			ExprDoneCond isDone;
-
-			result = ExecProject(aggstate->ss.ps.ps_ProjInfo, &isDone);
-
-			if (isDone != ExprEndResult)
-			{
-				aggstate->ss.ps.ps_TupFromTlist =
-					(isDone == ExprMultipleResult);
-				return result;
-			}
-		}
-		else
-			InstrCountFiltered1(aggstate, 1);
+		result = project_aggregates(aggstate);
+		if (result)
+			return result;
 	}
 
 	/* No more groups */
@@ -1334,6 +2273,7 @@ agg_fill_hash_table(AggState *aggstate)
 	ExprContext *tmpcontext;
 	AggHashEntry entry;
 	TupleTableSlot *outerslot;
+	int			phaseno;
 
 	/*
 	 * get state info from node
@@ -1344,7 +2284,8 @@ agg_fill_hash_table(AggState *aggstate)
 
 	/*
 	 * Process each outer-plan tuple, and then fetch the next one, until we
-	 * exhaust the outer plan.
+	 * exhaust the outer plan.  With hashed grouping sets, each phase has its
+	 * own hash table, and every input tuple is entered into all of them.
 	 */
 	for (;;)
 	{
@@ -1354,19 +2295,34 @@ agg_fill_hash_table(AggState *aggstate)
 		/* set up for advance_aggregates call */
 		tmpcontext->ecxt_outertuple = outerslot;
 
-		/* Find or build hashtable entry for this tuple's group */
-		entry = lookup_hash_entry(aggstate, outerslot);
+		for (phaseno = 0; phaseno < aggstate->numphases; phaseno++)
+		{
+			aggstate->phase = &aggstate->phases[phaseno];
 
-		/* Advance the aggregates */
-		advance_aggregates(aggstate, entry->pergroup);
+			/* Find or build hashtable entry for this tuple's group */
+			entry = lookup_hash_entry(aggstate, outerslot);
+
+			/* Advance the aggregates, or spill the tuple for a later batch */
+			if (entry != NULL)
+				advance_aggregates(aggstate, entry->pergroup);
+			else
+				hash_agg_spill_tuple(aggstate, outerslot,
+									 hash_agg_hash_tuple(aggstate, outerslot));
+		}
 
 		/* Reset per-input-tuple context after each tuple */
 		ResetExprContext(tmpcontext);
 	}
 
+	hash_agg_finish_spill(aggstate);
+
 	aggstate->table_filled = true;
-	/* Initialize to walk the hash table */
-	ResetTupleHashIterator(aggstate->hashtable, &aggstate->hashiter);
+	aggstate->hash_batches_used++;
+	/* Initialize to walk the first hash table */
+	aggstate->current_phase = 0;
+	aggstate->phase = &aggstate->phases[0];
+	ResetTupleHashIterator(aggstate->phase->hashtable,
+						   &aggstate->phase->hashiter);
 }
 
 /*
@@ -1376,21 +2332,17 @@ static TupleTableSlot *
 agg_retrieve_hash_table(AggState *aggstate)
 {
 	ExprContext *econtext;
-	Datum	   *aggvalues;
-	bool	   *aggnulls;
 	AggStatePerAgg peragg;
 	AggStatePerGroup pergroup;
 	AggHashEntry entry;
 	TupleTableSlot *firstSlot;
-	int			aggno;
+	TupleTableSlot *result;
 
 	/*
 	 * get state info from node
 	 */
 	/* econtext is the per-output-tuple expression context */
 	econtext = aggstate->ss.ps.ps_ExprContext;
-	aggvalues = econtext->ecxt_aggvalues;
-	aggnulls = econtext->ecxt_aggnulls;
 	peragg = aggstate->peragg;
 	firstSlot = aggstate->ss.ss_ScanTupleSlot;
 
@@ -1403,9 +2355,29 @@ agg_retrieve_hash_table(AggState *aggstate)
 		/*
 		 * Find the next entry in the hash table
 		 */
-		entry = (AggHashEntry) ScanTupleHashTable(&aggstate->hashiter);
+		entry = (AggHashEntry) ScanTupleHashTable(&aggstate->phase->hashiter);
 		if (entry == NULL)
 		{
+			/*
+			 * Move on to the next grouping set's hash table, if any.  That's
+			 * only done on the first pass over the input (the only one with
+			 * no hash bits used up); a spilled batch fills just the table of
+			 * the set it was spilled from.
+			 */
+			if (aggstate->hash_used_bits == 0 &&
+				aggstate->current_phase < aggstate->numphases - 1)
+			{
+				aggstate->current_phase++;
+				aggstate->phase = &aggstate->phases[aggstate->current_phase];
+				ResetTupleHashIterator(aggstate->phase->hashtable,
+									   &aggstate->phase->hashiter);
+				continue;
+			}
+
+			/* Move on to the next spilled batch, if any */
+			if (agg_refill_hash_table(aggstate))
+				continue;
+
 			/* No more entries in hashtable, so done */
 			aggstate->agg_done = TRUE;
 			return NULL;
@@ -1430,19 +2402,13 @@ agg_retrieve_hash_table(AggState *aggstate)
 
 		pergroup = entry->pergroup;
 
+		prepare_projection_slot(aggstate, firstSlot, 0);
+
 		/*
 		 * Finalize each aggregate calculation, and stash results in the
 		 * per-output-tuple context.
 		 */
-		for (aggno = 0; aggno < aggstate->numaggs; aggno++)
-		{
-			AggStatePerAgg peraggstate = &peragg[aggno];
-			AggStatePerGroup pergroupstate = &pergroup[aggno];
-
-			Assert(peraggstate->numSortCols == 0);
-			finalize_aggregate(aggstate, peraggstate, pergroupstate,
-							   &aggvalues[aggno], &aggnulls[aggno]);
-		}
+		finalize_aggregates(aggstate, peragg, pergroup, 0);
 
 		/*
 		 * Use the representative input tuple for any references to
@@ -1450,34 +2416,145 @@ agg_retrieve_hash_table(AggState *aggstate)
 		 */
 		econtext->ecxt_outertuple = firstSlot;
 
-		/*
-		 * Check the qual (HAVING clause); if the group does not match, ignore
-		 * it and loop back to try to process another group.
-		 */
-		if (ExecQual(aggstate->ss.ps.qual, econtext, false))
+		result = project_aggregates(aggstate);
+		if (result)
+			return result;
+	}
+
+	/* No more groups */
+	return NULL;
+}
+
+/*
+ * ExecAgg for hashed case: load the next spilled batch into the hash table
+ *
+ * The groups emitted so far are thrown away, and the spilled tuples are
+ * aggregated into a fresh hash table for the phase they were spilled from,
+ * spilling again if need be.  Returns false if there are no batches left.
+ */
+static bool
+agg_refill_hash_table(AggState *aggstate)
+{
+	ExprContext *tmpcontext = aggstate->tmpcontext;
+	TupleTableSlot *spillslot = aggstate->hash_spill_slot;
+	HashAggBatch *batch;
+	AggHashEntry entry;
+	uint32		hashvalue;
+
+	if (aggstate->hash_batches == NIL)
+		return false;
+
+	batch = (HashAggBatch *) linitial(aggstate->hash_batches);
+	aggstate->hash_batches = list_delete_first(aggstate->hash_batches);
+
+	/*
+	 * Release the old hash table and transition values.  The scan slot might
+	 * be pointing at a group's first tuple, so clear it first.
+	 */
+	ExecClearTuple(aggstate->ss.ss_ScanTupleSlot);
+	MemoryContextResetAndDeleteChildren(aggstate->aggcontext);
+	aggstate->current_phase = batch->phase;
+	aggstate->phase = &aggstate->phases[batch->phase];
+	build_hash_table(aggstate);
+	aggstate->hash_spill_mode = false;
+	aggstate->hash_used_bits = batch->used_bits;
+
+	if (BufFileSeek(batch->input_file, 0, 0L, SEEK_SET))
+		ereport(ERROR,
+				(errcode_for_file_access(),
+			 errmsg("could not rewind hash-aggregate temporary file: %m")));
+
+	/* Aggregate the spilled tuples, just as agg_fill_hash_table does */
+	while (hash_agg_read_spilled(batch->input_file, spillslot, &hashvalue))
+	{
+		tmpcontext->ecxt_outertuple = spillslot;
+
+		entry = lookup_hash_entry(aggstate, spillslot);
+
+		if (entry != NULL)
+			advance_aggregates(aggstate, entry->pergroup);
+		else
+			hash_agg_spill_tuple(aggstate, spillslot, hashvalue);
+
+		ResetExprContext(tmpcontext);
+	}
+
+	BufFileClose(batch->input_file);
+	pfree(batch);
+
+	hash_agg_finish_spill(aggstate);
+
+	aggstate->hash_batches_used++;
+	ResetTupleHashIterator(aggstate->phase->hashtable,
+						   &aggstate->phase->hashiter);
+
+	return true;
+}
+
+/*
+ * Set up to read the input of an AGG_PLAIN node a batch at a time, if every
+ * aggregate's inputs are just columns of the outer plan's tuples.
+ * DISTINCT, ORDER BY and FILTER are not supported.
+ *
+ * All the aggregates are checked before anything is set up, so if any of
+ * them rules out batching, the node is left exactly as it was.
+ */
+static void
+agg_setup_batch(AggState *aggstate)
+{
+	int			ncols = 0;
+	int			aggno;
+
+	for (aggno = 0; aggno < aggstate->numaggs; aggno++)
+	{
+		AggStatePerAgg peraggstate = &aggstate->peragg[aggno];
+		Aggref	   *aggref = peraggstate->aggref;
+		ListCell   *lc;
+
+		if (peraggstate->numSortCols > 0 ||
+			aggref->aggfilter != NULL ||
+			aggref->aggkind != AGGKIND_NORMAL ||
+			OidIsValid(peraggstate->deserialfn_oid) ||
+			peraggstate->numTransInputs != list_length(aggref->args))
+			return;
+
+		foreach(lc, aggref->args)
 		{
-			/*
-			 * Form and return a projection tuple using the aggregate results
-			 * and the representative input tuple.
-			 */
-			TupleTableSlot *result;
-			ExprDoneCond isDone;
+			TargetEntry *tle = (TargetEntry *) lfirst(lc);
+			Var		   *var = (Var *) tle->expr;
 
-			result = ExecProject(aggstate->ss.ps.ps_ProjInfo, &isDone);
+			if (!IsA(var, Var) ||
+				var->varno != OUTER_VAR ||
+				var->varattno <= 0)
+				return;
 
-			if (isDone != ExprEndResult)
-			{
-				aggstate->ss.ps.ps_TupFromTlist =
-					(isDone == ExprMultipleResult);
-				return result;
-			}
+			ncols = Max(ncols, var->varattno);
 		}
-		else
-			InstrCountFiltered1(aggstate, 1);
 	}
 
-	/* No more groups */
-	return NULL;
+	/* Batching is possible, so note where each aggregate's inputs are */
+	for (aggno = 0; aggno < aggstate->numaggs; aggno++)
+	{
+		AggStatePerAgg peraggstate = &aggstate->peragg[aggno];
+		ListCell   *lc;
+		int			i;
+
+		peraggstate->batchInputCols = (int *)
+			palloc(Max(peraggstate->numTransInputs, 1) * sizeof(int));
+
+		i = 0;
+		foreach(lc, peraggstate->aggref->args)
+		{
+			TargetEntry *tle = (TargetEntry *) lfirst(lc);
+
+			peraggstate->batchInputCols[i++] =
+				((Var *) tle->expr)->varattno - 1;
+		}
+	}
+
+	aggstate->batch =
+		MakeTupleBatch(ExecGetResultType(outerPlanState(aggstate)),
+					   ncols, TUPLE_BATCH_ROWS);
 }
 
 /* -----------------
@@ -1496,7 +2573,13 @@ ExecInitAgg(Agg *node, EState *estate, int eflags)
 	ExprContext *econtext;
 	int			numaggs,
 				aggno;
+	int			phase;
 	ListCell   *l;
+	Bitmapset  *all_grouped_cols = NULL;
+	int			numGroupingSets = 1;
+	int			numPhases;
+	int			i = 0;
+	int			j = 0;
 
 	/* check for unsupported flags */
 	Assert(!(eflags & (EXEC_FLAG_BACKWARD | EXEC_FLAG_MARK)));
@@ -1510,45 +2593,84 @@ ExecInitAgg(Agg *node, EState *estate, int eflags)
 
 	aggstate->aggs = NIL;
 	aggstate->numaggs = 0;
-	aggstate->eqfunctions = NULL;
-	aggstate->hashfunctions = NULL;
+	aggstate->maxsets = 0;
 	aggstate->peragg = NULL;
 	aggstate->curperagg = NULL;
 	aggstate->agg_done = false;
+	aggstate->input_done = false;
 	aggstate->pergroup = NULL;
 	aggstate->grp_firstTuple = NULL;
-	aggstate->hashtable = NULL;
+	aggstate->batch = NULL;
+	aggstate->input_batches = 0;
+	aggstate->sort_in = NULL;
+	aggstate->sort_out = NULL;
+	aggstate->hash_spill_mode = false;
+	aggstate->hash_spilled = false;
+	aggstate->hash_spill = NULL;
+	aggstate->hash_batches = NIL;
+	aggstate->hash_used_bits = 0;
+	aggstate->hash_spill_slot = NULL;
+	aggstate->hash_mem_peak = 0;
+	aggstate->hash_batches_used = 0;
+	aggstate->hash_disk_used = 0;
 
 	/*
-	 * Create expression contexts.	We need two, one for per-input-tuple
-	 * processing and one for per-output-tuple processing.	We cheat a little
-	 * by using ExecAssignExprContext() to build both.
+	 * Calculate the maximum number of grouping sets in any phase; this
+	 * determines the size of some allocations.
 	 */
-	ExecAssignExprContext(estate, &aggstate->ss.ps);
-	aggstate->tmpcontext = aggstate->ss.ps.ps_ExprContext;
-	ExecAssignExprContext(estate, &aggstate->ss.ps);
+	if (node->groupingSets)
+	{
+		Assert(node->aggstrategy != AGG_HASHED || node->chain == NIL ||
+			   list_length(node->groupingSets) == 1);
+
+		numGroupingSets = list_length(node->groupingSets);
+
+		foreach(l, node->chain)
+		{
+			Agg		   *agg = lfirst(l);
+
+			numGroupingSets = Max(numGroupingSets,
+								  list_length(agg->groupingSets));
+		}
+	}
+
+	aggstate->maxsets = numGroupingSets;
+	aggstate->numphases = numPhases = 1 + list_length(node->chain);
 
 	/*
-	 * We also need a long-lived memory context for holding hashtable data
-	 * structures and transition values.  NOTE: the details of what is stored
-	 * in aggcontext and what is stored in the regular per-query memory
-	 * context are driven by a simple decision: we want to reset the
-	 * aggcontext at group boundaries (if not hashing) and in ExecReScanAgg to
-	 * recover no-longer-wanted space.
+	 * Create expression contexts.	We need three or more, one for
+	 * per-input-tuple processing, one for per-output-tuple processing, and
+	 * one for each grouping set.  The per-tuple memory context of the
+	 * per-grouping-set ExprContexts (aggcontexts) replaces the standalone
+	 * memory context formerly used to hold transition values.  We cheat a
+	 * little by using ExecAssignExprContext() to build all of them.
+	 *
+	 * NOTE: the details of what is stored in aggcontexts and what is stored
+	 * in the regular per-query memory context are driven by a simple
+	 * decision: we want to reset the aggcontext at group boundaries (if not
+	 * hashing) and in ExecReScanAgg to recover no-longer-wanted space.
 	 */
-	aggstate->aggcontext =
-		AllocSetContextCreate(CurrentMemoryContext,
-							  "AggContext",
-							  ALLOCSET_DEFAULT_MINSIZE,
-							  ALLOCSET_DEFAULT_INITSIZE,
-							  ALLOCSET_DEFAULT_MAXSIZE);
+	ExecAssignExprContext(estate, &aggstate->ss.ps);
+	aggstate->tmpcontext = aggstate->ss.ps.ps_ExprContext;
+
+	aggstate->aggcontexts = (ExprContext **)
+		palloc0(sizeof(ExprContext *) * numGroupingSets);
+	for (i = 0; i < numGroupingSets; ++i)
+	{
+		ExecAssignExprContext(estate, &aggstate->ss.ps);
+		aggstate->aggcontexts[i] = aggstate->ss.ps.ps_ExprContext;
+	}
+
+	ExecAssignExprContext(estate, &aggstate->ss.ps);
 
 	/*
 	 * tuple table initialization
 	 */
 	ExecInitScanTupleSlot(estate, &aggstate->ss);
 	ExecInitResultTupleSlot(estate, &aggstate->ss.ps);
-	aggstate->hashslot = ExecInitExtraTupleSlot(estate);
+	if (node->aggstrategy == AGG_HASHED)
+		aggstate->hash_spill_slot = ExecInitExtraTupleSlot(estate);
+	aggstate->sort_slot = ExecInitExtraTupleSlot(estate);
 
 	/*
 	 * initialize child expressions
@@ -1562,9 +2684,8 @@ ExecInitAgg(Agg *node, EState *estate, int eflags)
 	aggstate->ss.ps.targetlist = (List *)
 		ExecInitExpr((Expr *) node->plan.targetlist,
 					 (PlanState *) aggstate);
-	aggstate->ss.ps.qual = (List *)
-		ExecInitExpr((Expr *) node->plan.qual,
-					 (PlanState *) aggstate);
+	aggstate->ss.ps.qual =
+		ExecInitQual(node->plan.qual, (PlanState *) aggstate);
 
 	/*
 	 * initialize child nodes
@@ -1581,6 +2702,12 @@ ExecInitAgg(Agg *node, EState *estate, int eflags)
 	 * initialize source tuple type.
 	 */
 	ExecAssignScanTypeFromOuterPlan(&aggstate->ss);
+	if (aggstate->hash_spill_slot)
+		ExecSetSlotDescriptor(aggstate->hash_spill_slot,
+							  ExecGetResultType(outerPlanState(aggstate)));
+	if (node->chain && node->aggstrategy != AGG_HASHED)
+		ExecSetSlotDescriptor(aggstate->sort_slot,
+							  ExecGetResultType(outerPlanState(aggstate)));
 
 	/*
 	 * Initialize result tuple type and projection info.
@@ -1608,23 +2735,91 @@ ExecInitAgg(Agg *node, EState *estate, int eflags)
 	}
 
 	/*
-	 * If we are grouping, precompute fmgr lookup data for inner loop. We need
-	 * both equality and hashing functions to do it by hashing, but only
-	 * equality if not hashing.
+	 * For each phase, prepare grouping set data and fmgr lookup data for
+	 * compare functions.  Accumulate all_grouped_cols in passing.
 	 */
-	if (node->numCols > 0)
+	aggstate->phases = palloc0(numPhases * sizeof(AggStatePerPhaseData));
+
+	for (phase = 0; phase < numPhases; ++phase)
 	{
-		if (node->aggstrategy == AGG_HASHED)
-			execTuplesHashPrepare(node->numCols,
-								  node->grpOperators,
-								  &aggstate->eqfunctions,
-								  &aggstate->hashfunctions);
+		AggStatePerPhase phasedata = &aggstate->phases[phase];
+		Agg		   *aggnode;
+		Sort	   *sortnode;
+		int			num_sets;
+
+		if (phase > 0)
+		{
+			aggnode = list_nth(node->chain, phase - 1);
+			sortnode = (Sort *) aggnode->plan.lefttree;
+			Assert(sortnode == NULL || IsA(sortnode, Sort));
+		}
+		else
+		{
+			aggnode = node;
+			sortnode = NULL;
+		}
+
+		phasedata->numsets = num_sets = list_length(aggnode->groupingSets);
+
+		if (num_sets)
+		{
+			phasedata->gset_lengths = palloc(num_sets * sizeof(int));
+			phasedata->grouped_cols = palloc(num_sets * sizeof(Bitmapset *));
+
+			i = 0;
+			foreach(l, aggnode->groupingSets)
+			{
+				int			current_length = list_length(lfirst(l));
+				Bitmapset  *cols = NULL;
+
+				/* planner forces this to be correct */
+				for (j = 0; j < current_length; ++j)
+					cols = bms_add_member(cols, aggnode->grpColIdx[j]);
+
+				phasedata->grouped_cols[i] = cols;
+				phasedata->gset_lengths[i] = current_length;
+				++i;
+			}
+
+			all_grouped_cols = bms_add_members(all_grouped_cols,
+											   phasedata->grouped_cols[0]);
+		}
 		else
-			aggstate->eqfunctions =
-				execTuplesMatchPrepare(node->numCols,
-									   node->grpOperators);
+		{
+			Assert(phase == 0);
+
+			phasedata->gset_lengths = NULL;
+			phasedata->grouped_cols = NULL;
+		}
+
+		/*
+		 * If we are grouping, precompute fmgr lookup data for inner loop.
+		 * We need both equality and hashing functions to do it by hashing,
+		 * but only equality if not hashing.
+		 */
+		if (aggnode->numCols > 0)
+		{
+			if (aggnode->aggstrategy == AGG_HASHED)
+				execTuplesHashPrepare(aggnode->numCols,
+									  aggnode->grpOperators,
+									  &phasedata->eqfunctions,
+									  &phasedata->hashfunctions);
+			else
+				phasedata->eqfunctions =
+					execTuplesMatchPrepare(aggnode->numCols,
+										   aggnode->grpOperators);
+		}
+
+		phasedata->aggnode = aggnode;
+		phasedata->sortnode = sortnode;
 	}
 
+	/*
+	 * Convert all_grouped_cols to a descending-order list.
+	 */
+	while ((i = bms_first_member(all_grouped_cols)) >= 0)
+		aggstate->all_grouped_cols = lcons_int(i, aggstate->all_grouped_cols);
+
 	/*
 	 * Set up aggregate-result storage in the output expr context, and also
 	 * allocate my private per-agg working storage
@@ -1638,19 +2833,40 @@ ExecInitAgg(Agg *node, EState *estate, int eflags)
 
 	if (node->aggstrategy == AGG_HASHED)
 	{
-		build_hash_table(aggstate);
+		/* All hashed phases keep their tables in the first aggcontext */
+		select_current_set(aggstate, 0);
+
+		for (phase = 0; phase < numPhases; phase++)
+		{
+			AggStatePerPhase phasedata = &aggstate->phases[phase];
+
+			aggstate->phase = phasedata;
+			phasedata->hashslot = ExecInitExtraTupleSlot(estate);
+			build_hash_table(aggstate);
+			/* Compute the columns we actually need to hash on */
+			phasedata->hash_needed = find_hash_columns(aggstate);
+		}
+
 		aggstate->table_filled = false;
-		/* Compute the columns we actually need to hash on */
-		aggstate->hash_needed = find_hash_columns(aggstate);
+		aggstate->current_phase = 0;
+		aggstate->phase = &aggstate->phases[0];
 	}
 	else
 	{
 		AggStatePerGroup pergroup;
 
-		pergroup = (AggStatePerGroup) palloc0(sizeof(AggStatePerGroupData) * numaggs);
+		pergroup = (AggStatePerGroup) palloc0(sizeof(AggStatePerGroupData)
+											  * numaggs
+											  * numGroupingSets);
 		aggstate->pergroup = pergroup;
+
+		/* Set up the first sorted phase, and the tuplesort feeding the next */
+		initialize_phase(aggstate, 0);
 	}
 
+	aggstate->projected_set = -1;
+	select_current_set(aggstate, 0);
+
 	/*
 	 * Perform lookups of aggregate function info, and initialize the
 	 * unchanging fields of the per-agg data.  We also detect duplicate
@@ -1677,7 +2893,9 @@ ExecInitAgg(Agg *node, EState *estate, int eflags)
 		Oid			aggtranstype;
 		AclResult	aclresult;
 		Oid			transfn_oid,
-					finalfn_oid;
+					finalfn_oid,
+					serialfn_oid,
+					deserialfn_oid;
 		Expr	   *transfnexpr,
 				   *finalfnexpr;
 		Datum		textInitVal;
@@ -1710,7 +2928,8 @@ ExecInitAgg(Agg *node, EState *estate, int eflags)
 		/* Begin filling in the peraggstate data */
 		peraggstate->aggrefstate = aggrefstate;
 		peraggstate->aggref = aggref;
-		peraggstate->sortstate = NULL;
+		peraggstate->sortstates = (Tuplesortstate **)
+			palloc0(sizeof(Tuplesortstate *) * numGroupingSets);
 
 		/* Fetch the pg_aggregate row */
 		aggTuple = SearchSysCache1(AGGFNOID,
@@ -1728,8 +2947,36 @@ ExecInitAgg(Agg *node, EState *estate, int eflags)
 						   get_func_name(aggref->aggfnoid));
 		InvokeFunctionExecuteHook(aggref->aggfnoid);
 
-		peraggstate->transfn_oid = transfn_oid = aggform->aggtransfn;
-		peraggstate->finalfn_oid = finalfn_oid = aggform->aggfinalfn;
+		/*
+		 * A combining aggregate runs the combinefn over partial states in
+		 * place of the transfn, while a partial one stops short of the
+		 * finalfn; either may have to (de)serialize the states it passes.
+		 */
+		if (aggref->aggcombine)
+		{
+			if (!OidIsValid(aggform->aggcombinefn))
+				elog(ERROR, "combinefn not set for aggregate function %u",
+					 aggref->aggfnoid);
+			transfn_oid = aggform->aggcombinefn;
+		}
+		else
+			transfn_oid = aggform->aggtransfn;
+
+		finalfn_oid = aggref->aggpartial ? InvalidOid : aggform->aggfinalfn;
+
+		serialfn_oid = deserialfn_oid = InvalidOid;
+		if (node->serialStates)
+		{
+			if (aggref->aggpartial)
+				serialfn_oid = aggform->aggserialfn;
+			if (aggref->aggcombine)
+				deserialfn_oid = aggform->aggdeserialfn;
+		}
+
+		peraggstate->transfn_oid = transfn_oid;
+		peraggstate->finalfn_oid = finalfn_oid;
+		peraggstate->serialfn_oid = serialfn_oid;
+		peraggstate->deserialfn_oid = deserialfn_oid;
 
 		/* Check that aggregate owner has permission to call component fns */
 		{
@@ -1759,6 +3006,24 @@ ExecInitAgg(Agg *node, EState *estate, int eflags)
 								   get_func_name(finalfn_oid));
 				InvokeFunctionExecuteHook(finalfn_oid);
 			}
+			if (OidIsValid(serialfn_oid))
+			{
+				aclresult = pg_proc_aclcheck(serialfn_oid, aggOwner,
+											 ACL_EXECUTE);
+				if (aclresult != ACLCHECK_OK)
+					aclcheck_error(aclresult, ACL_KIND_PROC,
+								   get_func_name(serialfn_oid));
+				InvokeFunctionExecuteHook(serialfn_oid);
+			}
+			if (OidIsValid(deserialfn_oid))
+			{
+				aclresult = pg_proc_aclcheck(deserialfn_oid, aggOwner,
+											 ACL_EXECUTE);
+				if (aclresult != ACLCHECK_OK)
+					aclcheck_error(aclresult, ACL_KIND_PROC,
+								   get_func_name(deserialfn_oid));
+				InvokeFunctionExecuteHook(deserialfn_oid);
+			}
 		}
 
 		/*
@@ -1777,7 +3042,9 @@ ExecInitAgg(Agg *node, EState *estate, int eflags)
 		peraggstate->numInputs = numInputs;
 
 		/* Detect how many columns to pass to the transfn */
-		if (AGGKIND_IS_ORDERED_SET(aggref->aggkind))
+		if (aggref->aggcombine)
+			peraggstate->numTransInputs = 1;
+		else if (AGGKIND_IS_ORDERED_SET(aggref->aggkind))
 			peraggstate->numTransInputs = numInputs;
 		else
 			peraggstate->numTransInputs = numArguments;
@@ -1801,6 +3068,11 @@ ExecInitAgg(Agg *node, EState *estate, int eflags)
 								finalfn_oid,
 								&transfnexpr,
 								&finalfnexpr);
+		if (aggref->aggcombine)
+			build_aggregate_combinefn_expr(aggtranstype,
+										   aggref->inputcollid,
+										   transfn_oid,
+										   &transfnexpr);
 
 		/* set up infrastructure for calling the transfn and finalfn */
 		fmgr_info(transfn_oid, &peraggstate->transfn);
@@ -1812,6 +3084,12 @@ ExecInitAgg(Agg *node, EState *estate, int eflags)
 			fmgr_info_set_expr((Node *) finalfnexpr, &peraggstate->finalfn);
 		}
 
+		if (OidIsValid(serialfn_oid))
+			fmgr_info(serialfn_oid, &peraggstate->serialfn);
+
+		if (OidIsValid(deserialfn_oid))
+			fmgr_info(deserialfn_oid, &peraggstate->deserialfn);
+
 		peraggstate->aggCollation = aggref->inputcollid;
 
 		InitFunctionCallInfoData(peraggstate->transfn_fcinfo,
@@ -1847,9 +3125,11 @@ ExecInitAgg(Agg *node, EState *estate, int eflags)
 		 * type and transtype are the same (or at least binary-compatible), so
 		 * that it's OK to use the first aggregated input value as the initial
 		 * transValue.	This should have been checked at agg definition time,
-		 * but just in case...
+		 * but just in case...  (A combinefn's input is a transition value, so
+		 * there's nothing to check for it.)
 		 */
-		if (peraggstate->transfn.fn_strict && peraggstate->initValueIsNull)
+		if (peraggstate->transfn.fn_strict && peraggstate->initValueIsNull &&
+			!aggref->aggcombine)
 		{
 			if (numArguments <= numDirectArgs ||
 				!IsBinaryCoercible(inputTypes[numDirectArgs], aggtranstype))
@@ -1985,6 +3265,15 @@ ExecInitAgg(Agg *node, EState *estate, int eflags)
 	/* Update numaggs to match number of unique aggregates found */
 	aggstate->numaggs = aggno + 1;
 
+	/*
+	 * A plain aggregate over a child that can produce batches might be able
+	 * to read its input a batch at a time.
+	 */
+	if (node->aggstrategy == AGG_PLAIN && node->groupingSets == NIL &&
+		numPhases == 1 &&
+		ExecSupportsBatch(outerPlanState(aggstate)))
+		agg_setup_batch(aggstate);
+
 	return aggstate;
 }
 
@@ -2009,17 +3298,31 @@ ExecEndAgg(AggState *node)
 {
 	PlanState  *outerPlan;
 	int			aggno;
+	int			setno;
 
 	/* Make sure we have closed any open tuplesorts */
+	if (node->sort_in)
+		tuplesort_end(node->sort_in);
+	if (node->sort_out)
+		tuplesort_end(node->sort_out);
+
 	for (aggno = 0; aggno < node->numaggs; aggno++)
 	{
 		AggStatePerAgg peraggstate = &node->peragg[aggno];
 
-		if (peraggstate->sortstate)
-			tuplesort_end(peraggstate->sortstate);
+		for (setno = 0; setno < node->maxsets; setno++)
+		{
+			if (peraggstate->sortstates[setno])
+				tuplesort_end(peraggstate->sortstates[setno]);
+		}
 	}
 
 	/* And ensure any agg shutdown callbacks have been called */
+	for (setno = 0; setno < node->maxsets; setno++)
+	{
+		ReScanExprContext(node->aggcontexts[setno]);
+		MemoryContextDeleteChildren(node->aggcontexts[setno]->ecxt_per_tuple_memory);
+	}
 	ReScanExprContext(node->ss.ps.ps_ExprContext);
 
 	/*
@@ -2032,7 +3335,11 @@ ExecEndAgg(AggState *node)
 	/* clean up tuple table */
 	ExecClearTuple(node->ss.ss_ScanTupleSlot);
 
-	MemoryContextDelete(node->aggcontext);
+	/* close any leftover spill files */
+	hash_agg_release_spill(node);
+
+	if (node->batch != NULL)
+		TupleBatchFree(node->batch);
 
 	outerPlan = outerPlanState(node);
 	ExecEndNode(outerPlan);
@@ -2042,13 +3349,16 @@ void
 ExecReScanAgg(AggState *node)
 {
 	ExprContext *econtext = node->ss.ps.ps_ExprContext;
+	Agg		   *aggnode = (Agg *) node->ss.ps.plan;
 	int			aggno;
+	int			setno;
+	int			phase;
 
 	node->agg_done = false;
 
 	node->ss.ps.ps_TupFromTlist = false;
 
-	if (((Agg *) node->ss.ps.plan)->aggstrategy == AGG_HASHED)
+	if (aggnode->aggstrategy == AGG_HASHED)
 	{
 		/*
 		 * In the hashed case, if we haven't yet built the hash table then we
@@ -2062,11 +3372,15 @@ ExecReScanAgg(AggState *node)
 		/*
 		 * If we do have the hash table and the subplan does not have any
 		 * parameter changes, then we can just rescan the existing hash table;
-		 * no need to build it again.
+		 * no need to build it again.  That doesn't work if any groups were
+		 * spilled, though, since the table then holds only the last batch.
 		 */
-		if (node->ss.ps.lefttree->chgParam == NULL)
+		if (node->ss.ps.lefttree->chgParam == NULL && !node->hash_spilled)
 		{
-			ResetTupleHashIterator(node->hashtable, &node->hashiter);
+			node->current_phase = 0;
+			node->phase = &node->phases[0];
+			ResetTupleHashIterator(node->phase->hashtable,
+								   &node->phase->hashiter);
 			return;
 		}
 	}
@@ -2076,12 +3390,31 @@ ExecReScanAgg(AggState *node)
 	{
 		AggStatePerAgg peraggstate = &node->peragg[aggno];
 
-		if (peraggstate->sortstate)
-			tuplesort_end(peraggstate->sortstate);
-		peraggstate->sortstate = NULL;
+		for (setno = 0; setno < node->maxsets; setno++)
+		{
+			if (peraggstate->sortstates[setno])
+			{
+				tuplesort_end(peraggstate->sortstates[setno]);
+				peraggstate->sortstates[setno] = NULL;
+			}
+		}
 	}
 
-	/* We don't need to ReScanExprContext here; ExecReScan already did it */
+	/*
+	 * We don't need to ReScanExprContext the output tuple context here;
+	 * ExecReScan already did it. But we do need to reset our per-grouping-set
+	 * contexts, which may have transvalues stored in them.
+	 *
+	 * Note that with AGG_HASHED, the hash table is allocated in a sub-context
+	 * of the first aggcontext. We're going to rebuild the hash table from
+	 * scratch, so we need to delete the children too, to avoid leaking the
+	 * old hash table's memory context header.
+	 */
+	for (setno = 0; setno < node->maxsets; setno++)
+	{
+		ReScanExprContext(node->aggcontexts[setno]);
+		MemoryContextDeleteChildren(node->aggcontexts[setno]->ecxt_per_tuple_memory);
+	}
 
 	/* Release first tuple of group, if we have made a copy */
 	if (node->grp_firstTuple != NULL)
@@ -2094,19 +3427,19 @@ ExecReScanAgg(AggState *node)
 	MemSet(econtext->ecxt_aggvalues, 0, sizeof(Datum) * node->numaggs);
 	MemSet(econtext->ecxt_aggnulls, 0, sizeof(bool) * node->numaggs);
 
-	/*
-	 * Release all temp storage. Note that with AGG_HASHED, the hash table is
-	 * allocated in a sub-context of the aggcontext. We're going to rebuild
-	 * the hash table from scratch, so we need to use
-	 * MemoryContextResetAndDeleteChildren() to avoid leaking the old hash
-	 * table's memory context header.
-	 */
-	MemoryContextResetAndDeleteChildren(node->aggcontext);
-
-	if (((Agg *) node->ss.ps.plan)->aggstrategy == AGG_HASHED)
+	if (aggnode->aggstrategy == AGG_HASHED)
 	{
-		/* Rebuild an empty hash table */
-		build_hash_table(node);
+		/* Forget any spilled batches, and rebuild empty hash tables */
+		hash_agg_release_spill(node);
+		node->hash_spilled = false;
+		select_current_set(node, 0);
+		for (phase = 0; phase < node->numphases; phase++)
+		{
+			node->phase = &node->phases[phase];
+			build_hash_table(node);
+		}
+		node->current_phase = 0;
+		node->phase = &node->phases[0];
 		node->table_filled = false;
 	}
 	else
@@ -2115,9 +3448,15 @@ ExecReScanAgg(AggState *node)
 		 * Reset the per-group state (in particular, mark transvalues null)
 		 */
 		MemSet(node->pergroup, 0,
-			   sizeof(AggStatePerGroupData) * node->numaggs);
+			   sizeof(AggStatePerGroupData) * node->numaggs * node->maxsets);
+
+		/* reset to phase 0 */
+		initialize_phase(node, 0);
 	}
 
+	node->input_done = false;
+	node->projected_set = -1;
+
 	/*
 	 * if chgParam of subnode is not null then plan will be re-scanned by
 	 * first ExecProcNode.
@@ -2210,7 +3549,9 @@ AggGetPerTupleEContext(FunctionCallInfo fcinfo)
  * AggGetPerAggEContext - fetch per-output-tuple ExprContext
  *
  * This is useful for aggs to register shutdown callbacks, which will ensure
- * that non-memory resources are freed.
+ * that non-memory resources are freed.  With grouping sets, the context
+ * returned is the one belonging to the grouping set currently being
+ * processed, which is reset along with that set's transition values.
  *
  * As above, this is currently not useful for aggs called as window functions.
  */
@@ -2221,7 +3562,7 @@ AggGetPerAggEContext(FunctionCallInfo fcinfo)
 	{
 		AggState   *aggstate = (AggState *) fcinfo->context;
 
-		return aggstate->ss.ps.ps_ExprContext;
+		return aggstate->aggcontexts[aggstate->current_set];
 	}
 	return NULL;
 }
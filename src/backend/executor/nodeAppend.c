@@ -53,14 +53,38 @@
  *			  nil	nil		 Scan	 Scan	  Scan	   Scan
  *							  |		  |		   |		|
  *							person employee student student-emp
+ *
+ *		If some of the subplans are foreign scans whose FDW can run them
+ *		asynchronously, we start all of those up front, when the first
+ *		tuple is requested, so that the remote servers work on them
+ *		concurrently.  Since foreign tables can't be inheritance children,
+ *		this happens only for appendrels built from UNION ALL queries.
+ *		The synchronous subplans are then run in order as usual, after
+ *		which we return tuples from whichever asynchronous subplan has
+ *		some ready, waiting on the remote sockets through the latch
+ *		machinery when none does.  In that case the order of the output
+ *		doesn't follow the order of the subplans, but nobody expects that
+ *		from a forward scan of an Append anyway.
+ *
+ *		If the planner provided run-time pruning info, subplans that can't
+ *		return any rows given the values of the query's parameters are
+ *		not initialized at all, and those that can't given the current
+ *		values of PARAM_EXEC Params are skipped; see execPrune.c.
  */
 
 #include "postgres.h"
 
 #include "executor/execdebug.h"
 #include "executor/nodeAppend.h"
+#include "executor/nodeForeignscan.h"
+#include "miscadmin.h"
+#include "storage/latch.h"
+#include "storage/proc.h"
 
 static bool exec_append_initialize_next(AppendState *appendstate);
+static void exec_append_prune(AppendState *node);
+static void exec_append_start_async(AppendState *node);
+static TupleTableSlot *exec_append_async(AppendState *node);
 
 
 /* ----------------------------------------------------------------
@@ -124,6 +148,8 @@ ExecInitAppend(Append *node, EState *estate, int eflags)
 	int			nplans;
 	int			i;
 	ListCell   *lc;
+	ListCell   *lcq;
+	ListCell   *lcc;
 
 	/* check for unsupported flags */
 	Assert(!(eflags & EXEC_FLAG_MARK));
@@ -141,14 +167,23 @@ ExecInitAppend(Append *node, EState *estate, int eflags)
 	appendstate->ps.plan = (Plan *) node;
 	appendstate->ps.state = estate;
 	appendstate->appendplans = appendplanstates;
-	appendstate->as_nplans = nplans;
+	appendstate->as_async_started = false;
+	appendstate->as_nasync = 0;
+	appendstate->as_whichasync = 0;
+	appendstate->as_isasync = (bool *) palloc0(nplans * sizeof(bool));
+	appendstate->as_finished = (bool *) palloc0(nplans * sizeof(bool));
+	appendstate->as_prune_quals = NIL;
+	appendstate->as_prune_constraints = NIL;
+	appendstate->as_pruned = (bool *) palloc0(nplans * sizeof(bool));
 
 	/*
 	 * Miscellaneous initialization
 	 *
-	 * Append plans don't have expression contexts because they never call
-	 * ExecQual or ExecProject.
+	 * Append plans never call ExecQual or ExecProject, so they need an
+	 * expression context only for run-time pruning.
 	 */
+	if (node->prune_quals != NIL)
+		ExecAssignExprContext(estate, &appendstate->ps);
 
 	/*
 	 * append nodes still have Result slots, which hold pointers to tuples, so
@@ -159,15 +194,55 @@ ExecInitAppend(Append *node, EState *estate, int eflags)
 	/*
 	 * call ExecInitNode on each of the plans to be executed and save the
 	 * results into the array "appendplans".
+	 *
+	 * Subplans that can be pruned using the query's external parameters are
+	 * left out altogether, since those values can't change while we run.
+	 * We keep the pruning info of the rest that depend on PARAM_EXEC values,
+	 * to check them again at run time.  (If everything could be pruned, we
+	 * still keep the last subplan, since EXPLAIN wants at least one.)
 	 */
 	i = 0;
+	lcq = list_head(node->prune_quals);
+	lcc = list_head(node->prune_constraints);
 	foreach(lc, node->appendplans)
 	{
 		Plan	   *initNode = (Plan *) lfirst(lc);
+		List	   *quals = NIL;
+		List	   *constraints = NIL;
+		bool		recheck = false;
+
+		if (lcq != NULL)
+		{
+			quals = (List *) lfirst(lcq);
+			constraints = (List *) lfirst(lcc);
+			lcq = lnext(lcq);
+			lcc = lnext(lcc);
+
+			if (ExecSubplanIsPrunable(appendstate->ps.ps_ExprContext,
+									  quals, constraints, true, &recheck) &&
+				(i > 0 || lnext(lc) != NULL))
+				continue;
+		}
 
 		appendplanstates[i] = ExecInitNode(initNode, estate, eflags);
+		appendstate->as_prune_quals =
+			lappend(appendstate->as_prune_quals, recheck ? quals : NIL);
+		appendstate->as_prune_constraints =
+			lappend(appendstate->as_prune_constraints,
+					recheck ? constraints : NIL);
+		if (recheck)
+			appendstate->as_prune_pending = true;
 		i++;
 	}
+	appendstate->as_nplans = i;
+	appendstate->as_nremoved = nplans - i;
+
+	/* Don't bother with run-time pruning if no subplan depends on it */
+	if (!appendstate->as_prune_pending)
+	{
+		appendstate->as_prune_quals = NIL;
+		appendstate->as_prune_constraints = NIL;
+	}
 
 	/*
 	 * initialize output tuple type
@@ -193,29 +268,40 @@ ExecInitAppend(Append *node, EState *estate, int eflags)
 TupleTableSlot *
 ExecAppend(AppendState *node)
 {
+	if (node->as_prune_pending)
+		exec_append_prune(node);
+	if (!node->as_async_started)
+		exec_append_start_async(node);
+	if (node->as_nasync > 0)
+		return exec_append_async(node);
+
 	for (;;)
 	{
 		PlanState  *subnode;
 		TupleTableSlot *result;
 
 		/*
-		 * figure out which subplan we are currently processing
-		 */
-		subnode = node->appendplans[node->as_whichplan];
-
-		/*
-		 * get a tuple from the subplan
+		 * figure out which subplan we are currently processing, unless
+		 * run-time pruning says to skip it
 		 */
-		result = ExecProcNode(subnode);
-
-		if (!TupIsNull(result))
+		if (!node->as_pruned[node->as_whichplan])
 		{
+			subnode = node->appendplans[node->as_whichplan];
+
 			/*
-			 * If the subplan gave us something then return it as-is. We do
-			 * NOT make use of the result slot that was set up in
-			 * ExecInitAppend; there's no need for it.
+			 * get a tuple from the subplan
 			 */
-			return result;
+			result = ExecProcNode(subnode);
+
+			if (!TupIsNull(result))
+			{
+				/*
+				 * If the subplan gave us something then return it as-is. We
+				 * do NOT make use of the result slot that was set up in
+				 * ExecInitAppend; there's no need for it.
+				 */
+				return result;
+			}
 		}
 
 		/*
@@ -234,6 +320,139 @@ ExecAppend(AppendState *node)
 	}
 }
 
+/*
+ * Decide which subplans to skip, given the current values of the PARAM_EXEC
+ * Params that their pruning quals depend on.
+ */
+static void
+exec_append_prune(AppendState *node)
+{
+	ListCell   *lcq;
+	ListCell   *lcc;
+	int			i = 0;
+
+	forboth(lcq, node->as_prune_quals, lcc, node->as_prune_constraints)
+	{
+		node->as_pruned[i] =
+			ExecSubplanIsPrunable(node->ps.ps_ExprContext,
+								  (List *) lfirst(lcq), (List *) lfirst(lcc),
+								  false, NULL);
+		i++;
+	}
+	node->as_prune_pending = false;
+}
+
+/*
+ * Start every subplan that can run asynchronously.
+ */
+static void
+exec_append_start_async(AppendState *node)
+{
+	int			i;
+
+	node->as_async_started = true;
+
+	/* Not worth it for a single subplan; and only forward scans qualify */
+	if (node->as_nplans < 2 ||
+		!ScanDirectionIsForward(node->ps.state->es_direction))
+		return;
+
+	for (i = 0; i < node->as_nplans; i++)
+	{
+		PlanState  *subnode = node->appendplans[i];
+
+		/* A pruned subplan counts as finished before it starts */
+		node->as_finished[i] = node->as_pruned[i];
+		node->as_isasync[i] = false;
+		if (!node->as_pruned[i] &&
+			IsA(subnode, ForeignScanState) &&
+			ExecForeignScanStartAsync((ForeignScanState *) subnode))
+		{
+			node->as_isasync[i] = true;
+			node->as_nasync++;
+		}
+	}
+}
+
+/*
+ * ExecAppend's workhorse when some subplans run asynchronously.
+ *
+ * The synchronous subplans are run first, in order, while the asynchronous
+ * ones are busy; as_whichplan keeps track of those.  Then we return tuples
+ * from any asynchronous subplan that can provide one without waiting,
+ * preferring the one we got the last tuple from, which is likely to have
+ * more in its buffer.  When none of them is ready, we sleep until the
+ * socket of one that isn't becomes readable.  We wait on only one socket
+ * at a time, since that's what the latch machinery offers; the remote
+ * queries all keep running meanwhile, so this costs little.
+ */
+static TupleTableSlot *
+exec_append_async(AppendState *node)
+{
+	TupleTableSlot *result;
+	int			nplans = node->as_nplans;
+
+	while (node->as_whichplan < nplans)
+	{
+		int			whichplan = node->as_whichplan;
+
+		if (!node->as_isasync[whichplan] && !node->as_finished[whichplan])
+		{
+			result = ExecProcNode(node->appendplans[whichplan]);
+			if (!TupIsNull(result))
+				return result;
+			node->as_finished[whichplan] = true;
+		}
+		node->as_whichplan++;
+	}
+
+	for (;;)
+	{
+		pgsocket	waitsock = PGINVALID_SOCKET;
+		int			nremaining = 0;
+		int			k;
+
+		for (k = 0; k < nplans; k++)
+		{
+			/* Start with the subplan that gave us the previous tuple */
+			int			i = (node->as_whichasync + k) % nplans;
+			ForeignScanState *subnode;
+			pgsocket	sock;
+
+			if (!node->as_isasync[i] || node->as_finished[i])
+				continue;
+			subnode = (ForeignScanState *) node->appendplans[i];
+
+			if (ExecForeignScanReady(subnode, &sock))
+			{
+				result = ExecProcNode((PlanState *) subnode);
+				if (!TupIsNull(result))
+				{
+					node->as_whichasync = i;
+					return result;
+				}
+				node->as_finished[i] = true;
+				continue;
+			}
+
+			nremaining++;
+			if (waitsock == PGINVALID_SOCKET)
+				waitsock = sock;
+		}
+
+		/* Return the empty slot if all the subplans are done */
+		if (nremaining == 0)
+			return ExecClearTuple(node->ps.ps_ResultTupleSlot);
+
+		Assert(waitsock != PGINVALID_SOCKET);
+		WaitLatchOrSocket(&MyProc->procLatch,
+						  WL_LATCH_SET | WL_SOCKET_READABLE,
+						  waitsock, -1L);
+		ResetLatch(&MyProc->procLatch);
+		CHECK_FOR_INTERRUPTS();
+	}
+}
+
 /* ----------------------------------------------------------------
  *		ExecEndAppend
  *
@@ -260,6 +479,12 @@ ExecEndAppend(AppendState *node)
 	 */
 	for (i = 0; i < nplans; i++)
 		ExecEndNode(appendplans[i]);
+
+	/*
+	 * Free the exprcontext, if we made one for run-time pruning
+	 */
+	if (node->ps.ps_ExprContext)
+		ExecFreeExprContext(&node->ps);
 }
 
 void
@@ -287,4 +512,13 @@ ExecReScanAppend(AppendState *node)
 	}
 	node->as_whichplan = 0;
 	exec_append_initialize_next(node);
+
+	/* If the Params changed, run-time pruning must be done over */
+	if (node->as_prune_quals != NIL && node->ps.chgParam != NULL)
+		node->as_prune_pending = true;
+
+	/* Any asynchronous subplans will be started again on the next call */
+	node->as_async_started = false;
+	node->as_nasync = 0;
+	node->as_whichasync = 0;
 }
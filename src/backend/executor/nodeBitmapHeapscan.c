@@ -15,6 +15,20 @@
  * but with anything else we might return a tuple that doesn't meet the
  * required index qual conditions.
  *
+ * When the scan needs no columns from the heap (as in SELECT count(*) over
+ * a bitmap index scan), we can avoid reading heap pages altogether in much
+ * the same way as an index-only scan: if the bitmap page is exact and the
+ * visibility map says all its tuples are visible to everyone, each listed
+ * offset is a live tuple, and we just return that many empty tuples.  The
+ * prefetcher skips such pages too.
+ *
+ * That's only true if the page was all-visible already when the index scan
+ * that built the bitmap started, though.  Otherwise a concurrent VACUUM
+ * could have removed a dead tuple, and set the page's bit, after we picked
+ * up the index entry pointing to it.  So we note the WAL position before
+ * building the bitmap, and trust only visibility map bits that haven't
+ * been set since then; see visibilitymap_test_since.
+ *
  *
  * Portions Copyright (c) 1996-2014, PostgreSQL Global Development Group
  * Portions Copyright (c) 1994, Regents of the University of California
@@ -37,6 +51,8 @@
 
 #include "access/relscan.h"
 #include "access/transam.h"
+#include "access/visibilitymap.h"
+#include "access/xlog.h"
 #include "executor/execdebug.h"
 #include "executor/nodeBitmapHeapscan.h"
 #include "pgstat.h"
@@ -101,6 +117,11 @@ BitmapHeapNext(BitmapHeapScanState *node)
 	 */
 	if (tbm == NULL)
 	{
+		/* Note where WAL is before the index scan, for skip_fetch tests */
+		if (node->can_skip_fetch)
+			node->bitmap_lsn = RecoveryInProgress() ?
+				GetXLogReplayRecPtr(NULL) : GetXLogInsertRecPtr();
+
 		tbm = (TIDBitmap *) MultiExecProcNode(outerPlanState(node));
 
 		if (!tbm || !IsA(tbm, TIDBitmap))
@@ -166,9 +187,39 @@ BitmapHeapNext(BitmapHeapScanState *node)
 			}
 
 			/*
-			 * Fetch the current heap page and identify candidate tuples.
+			 * We can skip fetching the heap page if we don't need any fields
+			 * from the heap, the bitmap entries don't need rechecking (which
+			 * also means the page is exact), and all tuples on the page have
+			 * been visible to everybody since before we built the bitmap.
 			 */
-			bitgetpage(scan, tbmres);
+			node->skip_fetch = (node->can_skip_fetch &&
+								!tbmres->recheck &&
+								visibilitymap_test_since(scan->rs_rd,
+														 tbmres->blockno,
+														 &node->vmbuffer,
+														 node->bitmap_lsn));
+
+			if (node->skip_fetch)
+			{
+				/*
+				 * The number of tuples on this page goes into rs_ntuples;
+				 * rs_vistuples is not filled in, since we won't look at it.
+				 * We don't lock individual tuples either, so to be safe for
+				 * serializable transactions, lock the whole page instead.
+				 */
+				Assert(tbmres->ntuples >= 0);
+				scan->rs_ntuples = tbmres->ntuples;
+				PredicateLockPage(scan->rs_rd, tbmres->blockno,
+								  scan->rs_snapshot);
+				node->skipped_pages++;
+			}
+			else
+			{
+				/*
+				 * Fetch the current heap page and identify candidate tuples.
+				 */
+				bitgetpage(scan, tbmres);
+			}
 
 			if (tbmres->ntuples >= 0)
 				node->exact_pages++;
@@ -248,11 +299,34 @@ BitmapHeapNext(BitmapHeapScanState *node)
 					break;
 				}
 				node->prefetch_pages++;
+
+				/*
+				 * Don't bother prefetching a page that we're going to skip
+				 * fetching, as determined above for the current page.
+				 */
+				if (node->can_skip_fetch &&
+					!tbmpre->recheck &&
+					visibilitymap_test_since(scan->rs_rd,
+											 tbmpre->blockno,
+											 &node->pvmbuffer,
+											 node->bitmap_lsn))
+					continue;
+
 				PrefetchBuffer(scan->rs_rd, MAIN_FORKNUM, tbmpre->blockno);
 			}
 		}
 #endif   /* USE_PREFETCH */
 
+		if (node->skip_fetch)
+		{
+			/*
+			 * We don't need the tuple's contents, so just return an empty
+			 * one.  The qual and the targetlist make no use of it.
+			 */
+			ExecStoreAllNullTuple(slot);
+			return slot;
+		}
+
 		/*
 		 * Okay to fetch the tuple
 		 */
@@ -463,6 +537,15 @@ ExecReScanBitmapHeapScan(BitmapHeapScanState *node)
 	node->tbmiterator = NULL;
 	node->tbmres = NULL;
 	node->prefetch_iterator = NULL;
+	node->skip_fetch = false;
+
+	/* release any visibility map buffers */
+	if (node->vmbuffer != InvalidBuffer)
+		ReleaseBuffer(node->vmbuffer);
+	node->vmbuffer = InvalidBuffer;
+	if (node->pvmbuffer != InvalidBuffer)
+		ReleaseBuffer(node->pvmbuffer);
+	node->pvmbuffer = InvalidBuffer;
 
 	ExecScanReScan(&node->ss);
 
@@ -516,6 +599,14 @@ ExecEndBitmapHeapScan(BitmapHeapScanState *node)
 	if (node->tbm)
 		tbm_free(node->tbm);
 
+	/*
+	 * release visibility map buffers if any
+	 */
+	if (node->vmbuffer != InvalidBuffer)
+		ReleaseBuffer(node->vmbuffer);
+	if (node->pvmbuffer != InvalidBuffer)
+		ReleaseBuffer(node->pvmbuffer);
+
 	/*
 	 * close heap scan
 	 */
@@ -560,9 +651,14 @@ ExecInitBitmapHeapScan(BitmapHeapScan *node, EState *estate, int eflags)
 	scanstate->tbmres = NULL;
 	scanstate->exact_pages = 0;
 	scanstate->lossy_pages = 0;
+	scanstate->skipped_pages = 0;
 	scanstate->prefetch_iterator = NULL;
 	scanstate->prefetch_pages = 0;
 	scanstate->prefetch_target = 0;
+	scanstate->skip_fetch = false;
+	scanstate->bitmap_lsn = InvalidXLogRecPtr;
+	scanstate->vmbuffer = InvalidBuffer;
+	scanstate->pvmbuffer = InvalidBuffer;
 
 	/*
 	 * Miscellaneous initialization
@@ -579,9 +675,8 @@ ExecInitBitmapHeapScan(BitmapHeapScan *node, EState *estate, int eflags)
 	scanstate->ss.ps.targetlist = (List *)
 		ExecInitExpr((Expr *) node->scan.plan.targetlist,
 					 (PlanState *) scanstate);
-	scanstate->ss.ps.qual = (List *)
-		ExecInitExpr((Expr *) node->scan.plan.qual,
-					 (PlanState *) scanstate);
+	scanstate->ss.ps.qual =
+		ExecInitQual(node->scan.plan.qual, (PlanState *) scanstate);
 	scanstate->bitmapqualorig = (List *)
 		ExecInitExpr((Expr *) node->bitmapqualorig,
 					 (PlanState *) scanstate);
@@ -599,6 +694,23 @@ ExecInitBitmapHeapScan(BitmapHeapScan *node, EState *estate, int eflags)
 
 	scanstate->ss.ss_currentRelation = currentRelation;
 
+	/*
+	 * We can potentially skip fetching heap pages if we do not need any
+	 * columns of the table, either for checking non-indexable quals or for
+	 * returning data.  This test is a bit simplistic, as it checks the
+	 * stronger condition that there's no qual or return tlist at all.  But
+	 * in most cases it's probably not worth working harder than that; the
+	 * planner makes sure the tlist is empty when no columns are needed.
+	 *
+	 * Visibility map bits of unlogged relations carry no LSN, so we can't
+	 * tell when they were set.  Temporary relations don't either, but nobody
+	 * else can vacuum them while we're scanning.
+	 */
+	scanstate->can_skip_fetch = (node->scan.plan.qual == NIL &&
+								 node->scan.plan.targetlist == NIL &&
+								 (RelationNeedsWAL(currentRelation) ||
+								  RelationUsesLocalBuffers(currentRelation)));
+
 	/*
 	 * Even though we aren't going to do a conventional seqscan, it is useful
 	 * to create a HeapScanDesc --- most of the fields in it are usable.
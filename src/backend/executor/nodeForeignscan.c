@@ -19,6 +19,9 @@
  *		ExecInitForeignScan		creates and initializes state info.
  *		ExecReScanForeignScan	rescans the foreign relation.
  *		ExecEndForeignScan		releases any resources allocated.
+ *		ExecForeignScanStartAsync	starts a scan without waiting for it.
+ *		ExecForeignScanReady	checks whether an asynchronous scan can
+ *								return a tuple without waiting.
  */
 #include "postgres.h"
 
@@ -130,9 +133,8 @@ ExecInitForeignScan(ForeignScan *node, EState *estate, int eflags)
 	scanstate->ss.ps.targetlist = (List *)
 		ExecInitExpr((Expr *) node->scan.plan.targetlist,
 					 (PlanState *) scanstate);
-	scanstate->ss.ps.qual = (List *)
-		ExecInitExpr((Expr *) node->scan.plan.qual,
-					 (PlanState *) scanstate);
+	scanstate->ss.ps.qual =
+		ExecInitQual(node->scan.plan.qual, (PlanState *) scanstate);
 
 	/*
 	 * tuple table initialization
@@ -209,3 +211,44 @@ ExecReScanForeignScan(ForeignScanState *node)
 
 	ExecScanReScan(&node->ss);
 }
+
+/* ----------------------------------------------------------------
+ *		ExecForeignScanStartAsync
+ *
+ *		Asks the FDW to start the scan without waiting for its first
+ *		results, so that it can run while we do other work.  Returns
+ *		false if the FDW can't do that for this scan, in which case the
+ *		scan is run synchronously as usual.
+ * ----------------------------------------------------------------
+ */
+bool
+ExecForeignScanStartAsync(ForeignScanState *node)
+{
+	FdwRoutine *fdwroutine = node->fdwroutine;
+
+	if (fdwroutine->StartForeignScanAsync == NULL ||
+		fdwroutine->IsForeignScanReady == NULL)
+		return false;
+
+	/* Carry out any pending rescan before we start the scan */
+	if (node->ss.ps.chgParam != NULL)
+		ExecReScan((PlanState *) node);
+
+	return fdwroutine->StartForeignScanAsync(node);
+}
+
+/* ----------------------------------------------------------------
+ *		ExecForeignScanReady
+ *
+ *		For a scan started with ExecForeignScanStartAsync, returns true
+ *		if ExecForeignScan can return its next tuple, or report the end
+ *		of the scan, without waiting for the remote side.  Otherwise,
+ *		*waitsock is set to the socket to wait on for it to become ready.
+ * ----------------------------------------------------------------
+ */
+bool
+ExecForeignScanReady(ForeignScanState *node, pgsocket *waitsock)
+{
+	*waitsock = PGINVALID_SOCKET;
+	return node->fdwroutine->IsForeignScanReady(node, waitsock);
+}
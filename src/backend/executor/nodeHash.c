@@ -17,6 +17,10 @@
  *		MultiExecHash	- generate an in-memory hash table of the relation
  *		ExecInitHash	- initialize node and subnodes
  *		ExecEndHash		- shutdown node and subnodes
+ *		ExecHashSharedWorkerBegin	- attach a parallel worker to a hashtable
+ *		ExecHashSharedWorkerInsert	- store a worker's tuple, if we can
+ *		ExecHashSharedWorkerEnd		- detach a parallel worker
+ *		ExecHashFilterTuple	- test an outer scan tuple against the filter
  */
 
 #include "postgres.h"
@@ -31,14 +35,141 @@
 #include "executor/hashjoin.h"
 #include "executor/nodeHash.h"
 #include "executor/nodeHashjoin.h"
+#include "executor/nodeParallelSeqscan.h"
 #include "miscadmin.h"
+#include "nodes/nodeFuncs.h"
+#include "optimizer/clauses.h"
+#include "optimizer/planmain.h"
+#include "storage/spin.h"
 #include "utils/dynahash.h"
 #include "utils/memutils.h"
 #include "utils/lsyscache.h"
 #include "utils/syscache.h"
 
 
+/*
+ * Shared tuple storage for a parallel build.
+ *
+ * When the inner relation is read by a Parallel Seq Scan, its workers can do
+ * most of the work of building the hash table: each one computes the hash
+ * value of the tuples it scans, and copies those that belong in the first
+ * batch into a dynamic shared memory segment instead of sending them to the
+ * master.  Space in the segment is handed out in chunks, so a participant
+ * takes the lock only once per chunk.  The master stores the first-batch
+ * tuples it scans itself the same way.
+ *
+ * The tuples aren't linked into buckets while the scan is running; since
+ * the segment may be mapped at a different address in each process, they
+ * couldn't point to each other anyway.  Once the scan is over, the master is
+ * the only process still using the segment, and ExecHashSharedFinish links
+ * the tuples into its own bucket array.  From then on they are ordinary
+ * first-batch tuples, except that their space isn't given back until the
+ * end of the batch.
+ *
+ * Tuples a worker doesn't store -- those of later batches, those matching a
+ * skew bucket, and any that arrive after the segment fills up -- are sent to
+ * the master as usual and handled by the non-parallel code.  The master sets
+ * aside first-batch tuples that don't fit in the segment in a temp file, and
+ * inserts them after the shared tuples have been linked in, so that the
+ * decision to increase nbatch is made with the whole table in view.
+ */
+typedef struct HashSharedHeader
+{
+	slock_t		mutex;			/* protects the next three fields */
+	Size		chunks;			/* offset of newest chunk, or 0 if none */
+	Size		freeoff;		/* offset of first unallocated byte */
+	bool		full;			/* has an allocation failed? */
+
+	/* These are set up by the master and not changed afterwards. */
+	Size		segsize;		/* total size of the segment */
+	int			nbuckets;		/* hashtable geometry when the scan began */
+	int			log2_nbuckets;
+	int			nbatch;
+	bool		keepNulls;
+	int			nkeys;			/* number of hash keys */
+	int			nskew;			/* number of skew hash values */
+	Size		hashfn_off;		/* offset of Oid[nkeys]: inner hash functions */
+	Size		strict_off;		/* offset of bool[nkeys]: hash strictness */
+	Size		skew_off;		/* offset of uint32[nskew], sorted */
+	Size		tlist_off;		/* offset of the scan's targetlist, as text */
+	Size		hashkeys_off;	/* offset of the hash key exprs, as text */
+} HashSharedHeader;
+
+typedef struct HashSharedChunk
+{
+	Size		next;			/* offset of next older chunk, or 0 */
+	Size		size;			/* space available for tuples */
+	Size		used;			/* space used; set only by the chunk's owner */
+	/* HashJoinTuples follow, each MAXALIGN'd */
+} HashSharedChunk;
+
+#define HASH_SHARED_CHUNK_HDRSZ		MAXALIGN(sizeof(HashSharedChunk))
+#define HASH_SHARED_CHUNK_SIZE		(32 * 1024)
+
+/* Per-process state for a hashtable's shared storage. */
+typedef struct HashSharedState
+{
+	dsm_segment *seg;
+	HashSharedHeader *header;	/* the segment's base address */
+	HashSharedChunk *chunk;		/* chunk we are filling, or NULL */
+	double		nstored;		/* number of tuples we have stored */
+	BufFile    *deferred;		/* master only: tuples that didn't fit */
+} HashSharedState;
+
+/* State for a parallel worker storing tuples into a shared hashtable. */
+typedef struct HashSharedWorkerState
+{
+	HashSharedState storage;
+	HashJoinTableData hashtable;	/* just enough to compute hash values */
+	EState	   *estate;
+	ExprContext *projcontext;	/* for forming the tuple the master expects */
+	ExprContext *hashcontext;	/* for evaluating the hash keys */
+	ProjectionInfo *projection;
+	List	   *hashkeys;
+	uint32	   *skew;
+	int			nskew;
+} HashSharedWorkerState;
+
+#define HashSharedAddress(header, off)	((char *) (header) + (off))
+
+/*
+ * Bloom filter of inner hash values, for a hash join's outer scan.
+ *
+ * Each inner hash value sets two bits: one chosen by its low-order bits, and
+ * one by the high-order bits of its product with a large odd constant.
+ * With HASH_BLOOM_BITS_PER_TUPLE bits per inner tuple, that rejects all but
+ * about 5% of the outer rows that have no match.  The filter's size is
+ * limited to a fraction of work_mem; if the inner relation turns out to be
+ * much bigger than estimated, the filter fills up, and the outer scan soon
+ * notices that it isn't rejecting enough rows to be worth testing.
+ */
+#define HASH_BLOOM_BITS_PER_TUPLE	8
+#define HASH_BLOOM_MIN_LOG2			10
+#define HASH_BLOOM_MAX_LOG2			30
+#define HASH_BLOOM_WORK_MEM_PERCENT	10
+
+#define HashBloomBit1(hashtable, hashvalue) \
+	((hashvalue) & (((uint32) 1 << (hashtable)->log2_nbloombits) - 1))
+#define HashBloomBit2(hashtable, hashvalue) \
+	(((uint32) ((hashvalue) * 0x9E3779B1U)) >> \
+	 (32 - (hashtable)->log2_nbloombits))
+#define HashBloomTestBit(bloom, bit) \
+	(((bloom)[(bit) >> 6] & ((uint64) 1 << ((bit) & 63))) != 0)
+#define HashBloomSetBit(bloom, bit) \
+	((bloom)[(bit) >> 6] |= ((uint64) 1 << ((bit) & 63)))
+
+/*
+ * The outer scan tests this many rows before deciding whether the filter is
+ * worthwhile, and gives up on it if fewer than 1 in HASH_FILTER_MIN_REMOVED
+ * of them were thrown away.
+ */
+#define HASH_FILTER_TRIAL_ROWS		1024
+#define HASH_FILTER_MIN_REMOVED		8
+
 static void ExecHashIncreaseNumBatches(HashJoinTable hashtable);
+static void *dense_alloc(HashJoinTable hashtable, Size size);
+static void ExecHashBloomCreate(HashJoinTable hashtable, double ntuples);
+static inline void ExecHashBloomAdd(HashJoinTable hashtable, uint32 hashvalue);
 static void ExecHashBuildSkewHash(HashJoinTable hashtable, Hash *node,
 					  int mcvsToUse);
 static void ExecHashSkewTableInsert(HashJoinTable hashtable,
@@ -46,6 +177,18 @@ static void ExecHashSkewTableInsert(HashJoinTable hashtable,
 						uint32 hashvalue,
 						int bucketNumber);
 static void ExecHashRemoveNextSkewBucket(HashJoinTable hashtable);
+static void ExecHashSharedBegin(HashState *node);
+static void ExecHashSharedInsert(HashJoinTable hashtable,
+					 TupleTableSlot *slot,
+					 uint32 hashvalue);
+static void ExecHashSharedFinish(HashState *node);
+static void ExecHashSharedRelease(HashJoinTable hashtable);
+static bool ExecHashSharedStore(HashSharedState *sstate,
+					MinimalTuple tuple,
+					uint32 hashvalue);
+static bool ExecHashTupleIsShared(HashJoinTable hashtable,
+					  HashJoinTuple hashTuple);
+static int	uint32_cmp(const void *a, const void *b);
 
 
 /* ----------------------------------------------------------------
@@ -94,6 +237,13 @@ MultiExecHash(HashState *node)
 	hashkeys = node->hashkeys;
 	econtext = node->ps.ps_ExprContext;
 
+	/*
+	 * If the inner relation is being scanned in parallel, have the workers
+	 * build as much of the table as they can.
+	 */
+	if (IsA(outerNode, ParallelSeqScanState))
+		ExecHashSharedBegin(node);
+
 	/*
 	 * get all inner tuples and insert into the hash table (or temp files)
 	 */
@@ -110,6 +260,9 @@ MultiExecHash(HashState *node)
 		{
 			int			bucketNumber;
 
+			if (hashtable->bloom != NULL)
+				ExecHashBloomAdd(hashtable, hashvalue);
+
 			bucketNumber = ExecHashGetSkewBucket(hashtable, hashvalue);
 			if (bucketNumber != INVALID_SKEW_BUCKET_NO)
 			{
@@ -117,6 +270,11 @@ MultiExecHash(HashState *node)
 				ExecHashSkewTableInsert(hashtable, slot, hashvalue,
 										bucketNumber);
 			}
+			else if (hashtable->shared != NULL)
+			{
+				/* Store it alongside the workers' tuples */
+				ExecHashSharedInsert(hashtable, slot, hashvalue);
+			}
 			else
 			{
 				/* Not subject to skew optimization, so insert normally */
@@ -126,6 +284,13 @@ MultiExecHash(HashState *node)
 		}
 	}
 
+	/* Add the tuples the workers stored, and any that didn't fit */
+	if (hashtable->shared != NULL)
+		ExecHashSharedFinish(node);
+
+	/* The first batch is complete, so get it ready for probing */
+	ExecHashTableBuildDirectory(hashtable);
+
 	/* must provide our own instrumentation support */
 	if (node->ps.instrument)
 		InstrStopNode(node->ps.instrument, hashtable->totalTuples);
@@ -181,9 +346,8 @@ ExecInitHash(Hash *node, EState *estate, int eflags)
 	hashstate->ps.targetlist = (List *)
 		ExecInitExpr((Expr *) node->plan.targetlist,
 					 (PlanState *) hashstate);
-	hashstate->ps.qual = (List *)
-		ExecInitExpr((Expr *) node->plan.qual,
-					 (PlanState *) hashstate);
+	hashstate->ps.qual =
+		ExecInitQual(node->plan.qual, (PlanState *) hashstate);
 
 	/*
 	 * initialize child nodes
@@ -228,10 +392,14 @@ ExecEndHash(HashState *node)
  *		ExecHashTableCreate
  *
  *		create an empty hashtable data structure for hashjoin.
+ *
+ *		If useBloom is true, also make a Bloom filter of the inner hash
+ *		values, for the outer scan's HashJoinFilter.
  * ----------------------------------------------------------------
  */
 HashJoinTable
-ExecHashTableCreate(Hash *node, List *hashOperators, bool keepNulls)
+ExecHashTableCreate(Hash *node, List *hashOperators, bool keepNulls,
+					bool useBloom)
 {
 	HashJoinTable hashtable;
 	Plan	   *outerNode;
@@ -273,6 +441,11 @@ ExecHashTableCreate(Hash *node, List *hashOperators, bool keepNulls)
 	hashtable->nbuckets = nbuckets;
 	hashtable->log2_nbuckets = log2_nbuckets;
 	hashtable->buckets = NULL;
+	hashtable->chunks = NULL;
+	hashtable->dirStart = NULL;
+	hashtable->dirHashes = NULL;
+	hashtable->dirTuples = NULL;
+	hashtable->nInMemory = 0;
 	hashtable->keepNulls = keepNulls;
 	hashtable->skewEnabled = false;
 	hashtable->skewBucket = NULL;
@@ -293,6 +466,9 @@ ExecHashTableCreate(Hash *node, List *hashOperators, bool keepNulls)
 	hashtable->spaceUsedSkew = 0;
 	hashtable->spaceAllowedSkew =
 		hashtable->spaceAllowed * SKEW_WORK_MEM_PERCENT / 100;
+	hashtable->shared = NULL;
+	hashtable->bloom = NULL;
+	hashtable->log2_nbloombits = 0;
 
 	/*
 	 * Get info about the hash functions to be used for each hash key. Also
@@ -354,6 +530,9 @@ ExecHashTableCreate(Hash *node, List *hashOperators, bool keepNulls)
 		PrepareTempTablespaces();
 	}
 
+	if (useBloom)
+		ExecHashBloomCreate(hashtable, outerNode->plan_rows);
+
 	/*
 	 * Prepare context for the first-scan space allocations; allocate the
 	 * hashbucket array therein, and set each bucket "empty".
@@ -376,6 +555,90 @@ ExecHashTableCreate(Hash *node, List *hashOperators, bool keepNulls)
 }
 
 
+/*
+ * Allocate an empty Bloom filter sized for the estimated number of inner
+ * tuples.  It lives in hashCxt, since it covers every batch.
+ */
+static void
+ExecHashBloomCreate(HashJoinTable hashtable, double ntuples)
+{
+	double		nbits;
+	double		maxbits;
+	int			log2_nbits;
+
+	nbits = Max(ntuples, 1.0) * HASH_BLOOM_BITS_PER_TUPLE;
+	maxbits = (double) hashtable->spaceAllowed * BITS_PER_BYTE *
+		HASH_BLOOM_WORK_MEM_PERCENT / 100;
+	nbits = Min(nbits, maxbits);
+	nbits = Min(nbits, (double) ((uint32) 1 << HASH_BLOOM_MAX_LOG2));
+
+	log2_nbits = my_log2((long) nbits);
+	log2_nbits = Max(log2_nbits, HASH_BLOOM_MIN_LOG2);
+
+	hashtable->log2_nbloombits = log2_nbits;
+	hashtable->bloom = (uint64 *)
+		MemoryContextAllocZero(hashtable->hashCxt,
+							   ((Size) 1 << log2_nbits) / BITS_PER_BYTE);
+}
+
+/*
+ * Add an inner tuple's hash value to the Bloom filter.
+ */
+static inline void
+ExecHashBloomAdd(HashJoinTable hashtable, uint32 hashvalue)
+{
+	uint32		bit1 = HashBloomBit1(hashtable, hashvalue);
+	uint32		bit2 = HashBloomBit2(hashtable, hashvalue);
+
+	HashBloomSetBit(hashtable->bloom, bit1);
+	HashBloomSetBit(hashtable->bloom, bit2);
+}
+
+/*
+ * ExecHashFilterTuple
+ *		Test the scan tuple in econtext against a hash join's filter
+ *
+ * Returns false if the tuple's join keys can't match any inner tuple, so that
+ * the scan can discard it; true if it might match, or if the filter isn't in
+ * use.  econtext's per-tuple memory is reset.
+ */
+bool
+ExecHashFilterTuple(HashJoinFilter *filter, ExprContext *econtext)
+{
+	HashJoinTable hashtable = filter->hashtable;
+	uint32		hashvalue;
+	bool		result;
+
+	if (hashtable == NULL || !filter->enabled)
+		return true;
+	Assert(hashtable->bloom != NULL);
+
+	/*
+	 * The join doesn't return unmatched outer rows, so a row with a null key
+	 * can go too.
+	 */
+	result = ExecHashGetHashValue(hashtable, econtext, filter->keys,
+								  true, false, &hashvalue) &&
+		HashBloomTestBit(hashtable->bloom,
+						 HashBloomBit1(hashtable, hashvalue)) &&
+		HashBloomTestBit(hashtable->bloom,
+						 HashBloomBit2(hashtable, hashvalue));
+
+	filter->nprobed += 1;
+	if (!result)
+		filter->nremoved += 1;
+
+	/*
+	 * If most rows find a match, the test is a waste of time, since the join
+	 * will have to compute their hash values again anyway.
+	 */
+	if (filter->nprobed == HASH_FILTER_TRIAL_ROWS &&
+		filter->nremoved * HASH_FILTER_MIN_REMOVED < HASH_FILTER_TRIAL_ROWS)
+		filter->enabled = false;
+
+	return result;
+}
+
 /*
  * Compute appropriate size for hashtable given the estimated size of the
  * relation to be hashed (number of rows and average row width).
@@ -412,7 +675,8 @@ ExecChooseHashTableSize(double ntuples, int tupwidth, bool useskew,
 	 */
 	tupsize = HJTUPLE_OVERHEAD +
 		MAXALIGN(sizeof(MinimalTupleData)) +
-		MAXALIGN(tupwidth);
+		MAXALIGN(tupwidth) +
+		HJDIRECTORY_ENTRY_SIZE;
 	inner_rel_bytes = ntuples * tupsize;
 
 	/*
@@ -538,6 +802,9 @@ ExecHashTableDestroy(HashJoinTable hashtable)
 			BufFileClose(hashtable->outerBatchFile[i]);
 	}
 
+	/* Detach from the shared storage, if we still have it */
+	ExecHashSharedRelease(hashtable);
+
 	/* Release working memory (batchCxt is a child, so it goes away too) */
 	MemoryContextDelete(hashtable->hashCxt);
 
@@ -560,6 +827,7 @@ ExecHashIncreaseNumBatches(HashJoinTable hashtable)
 	MemoryContext oldcxt;
 	long		ninmemory;
 	long		nfreed;
+	HashMemoryChunk oldchunks;
 
 	/* do nothing if we've decided to shut off growth */
 	if (!hashtable->growEnabled)
@@ -572,6 +840,9 @@ ExecHashIncreaseNumBatches(HashJoinTable hashtable)
 	nbatch = oldnbatch * 2;
 	Assert(nbatch > 1);
 
+	/* we can only get here while loading a batch, before probing it */
+	Assert(hashtable->dirStart == NULL);
+
 #ifdef HJDEBUG
 	printf("Increasing nbatch to %d because space = %lu\n",
 		   nbatch, (unsigned long) hashtable->spaceUsed);
@@ -608,33 +879,49 @@ ExecHashIncreaseNumBatches(HashJoinTable hashtable)
 
 	/*
 	 * Scan through the existing hash table entries and dump out any that are
-	 * no longer of the current batch.
+	 * no longer of the current batch.  The ones we keep are copied into new
+	 * chunks, so that the space of those we dump can be given back; we
+	 * rebuild each bucket's chain as we go.  Tuples in the shared segment of
+	 * a parallel build stay where they are.
 	 */
 	ninmemory = nfreed = 0;
 
+	oldchunks = hashtable->chunks;
+	hashtable->chunks = NULL;
+
 	for (i = 0; i < hashtable->nbuckets; i++)
 	{
-		HashJoinTuple prevtuple;
 		HashJoinTuple tuple;
 
-		prevtuple = NULL;
 		tuple = hashtable->buckets[i];
+		hashtable->buckets[i] = NULL;
 
 		while (tuple != NULL)
 		{
-			/* save link in case we delete */
+			/* save link, since we overwrite it */
 			HashJoinTuple nexttuple = tuple->next;
+			Size		tupleSize;
 			int			bucketno;
 			int			batchno;
 
 			ninmemory++;
+			tupleSize = HJTUPLE_OVERHEAD + HJTUPLE_MINTUPLE(tuple)->t_len;
 			ExecHashGetBucketAndBatch(hashtable, tuple->hashvalue,
 									  &bucketno, &batchno);
 			Assert(bucketno == i);
 			if (batchno == curbatch)
 			{
-				/* keep tuple */
-				prevtuple = tuple;
+				/* keep tuple, moving it to a new chunk if it's ours */
+				HashJoinTuple copyTuple = tuple;
+
+				if (!ExecHashTupleIsShared(hashtable, tuple))
+				{
+					copyTuple = (HashJoinTuple) dense_alloc(hashtable,
+															tupleSize);
+					memcpy(copyTuple, tuple, tupleSize);
+				}
+				copyTuple->next = hashtable->buckets[i];
+				hashtable->buckets[i] = copyTuple;
 			}
 			else
 			{
@@ -643,15 +930,7 @@ ExecHashIncreaseNumBatches(HashJoinTable hashtable)
 				ExecHashJoinSaveTuple(HJTUPLE_MINTUPLE(tuple),
 									  tuple->hashvalue,
 									  &hashtable->innerBatchFile[batchno]);
-				/* and remove from hash table */
-				if (prevtuple)
-					prevtuple->next = nexttuple;
-				else
-					hashtable->buckets[i] = nexttuple;
-				/* prevtuple doesn't change */
-				hashtable->spaceUsed -=
-					HJTUPLE_OVERHEAD + HJTUPLE_MINTUPLE(tuple)->t_len;
-				pfree(tuple);
+				hashtable->spaceUsed -= tupleSize + HJDIRECTORY_ENTRY_SIZE;
 				nfreed++;
 			}
 
@@ -659,6 +938,17 @@ ExecHashIncreaseNumBatches(HashJoinTable hashtable)
 		}
 	}
 
+	hashtable->nInMemory -= nfreed;
+
+	/* Now the old chunks hold nothing we need */
+	while (oldchunks != NULL)
+	{
+		HashMemoryChunk nextchunk = oldchunks->next;
+
+		pfree(oldchunks);
+		oldchunks = nextchunk;
+	}
+
 #ifdef HJDEBUG
 	printf("Freed %ld of %ld tuples, space now %lu\n",
 		   nfreed, ninmemory, (unsigned long) hashtable->spaceUsed);
@@ -717,8 +1007,7 @@ ExecHashTableInsert(HashJoinTable hashtable,
 
 		/* Create the HashJoinTuple */
 		hashTupleSize = HJTUPLE_OVERHEAD + tuple->t_len;
-		hashTuple = (HashJoinTuple) MemoryContextAlloc(hashtable->batchCxt,
-													   hashTupleSize);
+		hashTuple = (HashJoinTuple) dense_alloc(hashtable, hashTupleSize);
 		hashTuple->hashvalue = hashvalue;
 		memcpy(HJTUPLE_MINTUPLE(hashTuple), tuple, tuple->t_len);
 
@@ -733,9 +1022,14 @@ ExecHashTableInsert(HashJoinTable hashtable,
 		/* Push it onto the front of the bucket's list */
 		hashTuple->next = hashtable->buckets[bucketno];
 		hashtable->buckets[bucketno] = hashTuple;
+		hashtable->nInMemory++;
 
-		/* Account for space used, and back off if we've used too much */
-		hashtable->spaceUsed += hashTupleSize;
+		/*
+		 * Account for space used, including the tuple's entry in the bucket
+		 * directory that will be built later, and back off if we've used
+		 * too much
+		 */
+		hashtable->spaceUsed += hashTupleSize + HJDIRECTORY_ENTRY_SIZE;
 		if (hashtable->spaceUsed > hashtable->spacePeak)
 			hashtable->spacePeak = hashtable->spaceUsed;
 		if (hashtable->spaceUsed > hashtable->spaceAllowed)
@@ -753,6 +1047,127 @@ ExecHashTableInsert(HashJoinTable hashtable,
 	}
 }
 
+/*
+ * dense_alloc
+ *		allocate space for a tuple of the main hash table
+ *
+ * Small requests are carved out of the current chunk, starting a new one
+ * when it's full.  Large ones get a chunk of their own, which goes behind the
+ * current chunk in the list so that the current one can keep being filled.
+ */
+static void *
+dense_alloc(HashJoinTable hashtable, Size size)
+{
+	HashMemoryChunk newChunk;
+	char	   *ptr;
+
+	/* just in case the size is not already aligned properly */
+	size = MAXALIGN(size);
+
+	if (size > HASH_CHUNK_THRESHOLD)
+	{
+		newChunk = (HashMemoryChunk)
+			MemoryContextAlloc(hashtable->batchCxt,
+							   HASH_CHUNK_HEADER_SIZE + size);
+		newChunk->maxlen = size;
+		newChunk->used = size;
+
+		if (hashtable->chunks != NULL)
+		{
+			newChunk->next = hashtable->chunks->next;
+			hashtable->chunks->next = newChunk;
+		}
+		else
+		{
+			newChunk->next = NULL;
+			hashtable->chunks = newChunk;
+		}
+
+		return newChunk->data;
+	}
+
+	if (hashtable->chunks == NULL ||
+		hashtable->chunks->maxlen - hashtable->chunks->used < size)
+	{
+		newChunk = (HashMemoryChunk)
+			MemoryContextAlloc(hashtable->batchCxt,
+							   HASH_CHUNK_HEADER_SIZE + HASH_CHUNK_SIZE);
+		newChunk->maxlen = HASH_CHUNK_SIZE;
+		newChunk->used = 0;
+		newChunk->next = hashtable->chunks;
+		hashtable->chunks = newChunk;
+	}
+
+	ptr = hashtable->chunks->data + hashtable->chunks->used;
+	hashtable->chunks->used += size;
+
+	return ptr;
+}
+
+/*
+ * ExecHashTableBuildDirectory
+ *		build the bucket directory for the current batch
+ *
+ * This must be called once all of the batch's inner tuples are in the table,
+ * before it is probed; see hashjoin.h.  The bucket chains are visited in
+ * order, so the directory is written sequentially, and a bucket's entries
+ * end up in the order of its chain.
+ */
+void
+ExecHashTableBuildDirectory(HashJoinTable hashtable)
+{
+	int			nbuckets = hashtable->nbuckets;
+	uint32		ntuples = hashtable->nInMemory;
+	uint32	   *dirStart;
+	uint32	   *dirHashes;
+	HashJoinTuple *dirTuples;
+	uint32		pos;
+	int			i;
+
+	Assert(hashtable->dirStart == NULL);
+
+	dirStart = (uint32 *)
+		MemoryContextAlloc(hashtable->batchCxt,
+						   (nbuckets + 1) * sizeof(uint32));
+	dirHashes = (uint32 *)
+		MemoryContextAlloc(hashtable->batchCxt,
+						   Max(ntuples, 1) * sizeof(uint32));
+	dirTuples = (HashJoinTuple *)
+		MemoryContextAlloc(hashtable->batchCxt,
+						   Max(ntuples, 1) * sizeof(HashJoinTuple));
+
+	pos = 0;
+	for (i = 0; i < nbuckets; i++)
+	{
+		HashJoinTuple tuple;
+
+		dirStart[i] = pos;
+		for (tuple = hashtable->buckets[i]; tuple != NULL; tuple = tuple->next)
+		{
+			if (pos >= ntuples)
+				elog(ERROR, "hash table holds more tuples than expected");
+			dirHashes[pos] = tuple->hashvalue;
+			dirTuples[pos] = tuple;
+			pos++;
+		}
+	}
+	dirStart[nbuckets] = pos;
+	Assert(pos == ntuples);
+
+	hashtable->dirStart = dirStart;
+	hashtable->dirHashes = dirHashes;
+	hashtable->dirTuples = dirTuples;
+
+	/*
+	 * The tuples' entries were counted as they went into the table.  Account
+	 * for the bucket start array too, though it's too late to do anything
+	 * about it.
+	 */
+	hashtable->spaceUsed += (nbuckets + 1) * sizeof(uint32);
+	if (hashtable->spaceUsed > hashtable->spacePeak)
+		hashtable->spacePeak = hashtable->spaceUsed;
+}
+
 /*
  * ExecHashGetHashValue
  *		Compute the hash value for a tuple
@@ -912,15 +1327,58 @@ ExecScanHashBucket(HashJoinState *hjstate,
 	 * hj_CurTuple is the address of the tuple last returned from the current
 	 * bucket, or NULL if it's time to start scanning a new bucket.
 	 *
-	 * If the tuple hashed to a skew bucket then scan the skew bucket
-	 * otherwise scan the standard hashtable bucket.
+	 * For a standard hashtable bucket, we look for hash values equal to the
+	 * outer tuple's in the bucket directory, and hj_CurDirPos is the
+	 * directory position of hj_CurTuple.
 	 */
+	if (hjstate->hj_CurSkewBucketNo == INVALID_SKEW_BUCKET_NO)
+	{
+		uint32		pos;
+		uint32		end;
+
+		Assert(hashtable->dirStart != NULL);
+		if (hashTuple != NULL)
+			pos = hjstate->hj_CurDirPos + 1;
+		else
+			pos = hashtable->dirStart[hjstate->hj_CurBucketNo];
+		end = hashtable->dirStart[hjstate->hj_CurBucketNo + 1];
+
+		for (; pos < end; pos++)
+		{
+			TupleTableSlot *inntuple;
+
+			if (hashtable->dirHashes[pos] != hashvalue)
+				continue;
+
+			/* insert hashtable's tuple into exec slot so ExecQual sees it */
+			hashTuple = hashtable->dirTuples[pos];
+			inntuple = ExecStoreMinimalTuple(HJTUPLE_MINTUPLE(hashTuple),
+											 hjstate->hj_HashTupleSlot,
+											 false);	/* do not pfree */
+			econtext->ecxt_innertuple = inntuple;
+
+			/* reset temp memory each time to avoid leaks from qual expr */
+			ResetExprContext(econtext);
+
+			if (ExecQual(hjclauses, econtext, false))
+			{
+				hjstate->hj_CurTuple = hashTuple;
+				hjstate->hj_CurDirPos = pos;
+				return true;
+			}
+		}
+
+		/*
+		 * no match
+		 */
+		return false;
+	}
+
+	/* Otherwise, scan the skew bucket's chain */
 	if (hashTuple != NULL)
 		hashTuple = hashTuple->next;
-	else if (hjstate->hj_CurSkewBucketNo != INVALID_SKEW_BUCKET_NO)
-		hashTuple = hashtable->skewBucket[hjstate->hj_CurSkewBucketNo]->tuples;
 	else
-		hashTuple = hashtable->buckets[hjstate->hj_CurBucketNo];
+		hashTuple = hashtable->skewBucket[hjstate->hj_CurSkewBucketNo]->tuples;
 
 	while (hashTuple != NULL)
 	{
@@ -1058,6 +1516,7 @@ ExecHashTableReset(HashJoinTable hashtable)
 	 * Release all the hash buckets and tuples acquired in the prior pass, and
 	 * reinitialize the context for a new pass.
 	 */
+	ExecHashSharedRelease(hashtable);
 	MemoryContextReset(hashtable->batchCxt);
 	oldcxt = MemoryContextSwitchTo(hashtable->batchCxt);
 
@@ -1065,6 +1524,13 @@ ExecHashTableReset(HashJoinTable hashtable)
 	hashtable->buckets = (HashJoinTuple *)
 		palloc0(nbuckets * sizeof(HashJoinTuple));
 
+	/* The chunks and the directory went away with the rest of batchCxt */
+	hashtable->chunks = NULL;
+	hashtable->dirStart = NULL;
+	hashtable->dirHashes = NULL;
+	hashtable->dirTuples = NULL;
+	hashtable->nInMemory = 0;
+
 	hashtable->spaceUsed = 0;
 
 	MemoryContextSwitchTo(oldcxt);
@@ -1409,11 +1875,23 @@ ExecHashRemoveNextSkewBucket(HashJoinTable hashtable)
 		/* Decide whether to put the tuple in the hash table or a temp file */
 		if (batchno == hashtable->curbatch)
 		{
-			/* Move the tuple to the main hash table */
-			hashTuple->next = hashtable->buckets[bucketno];
-			hashtable->buckets[bucketno] = hashTuple;
-			/* We have reduced skew space, but overall space doesn't change */
+			/* Move the tuple to the main hash table's storage */
+			HashJoinTuple copyTuple;
+
+			copyTuple = (HashJoinTuple) dense_alloc(hashtable, tupleSize);
+			memcpy(copyTuple, hashTuple, tupleSize);
+			pfree(hashTuple);
+
+			copyTuple->next = hashtable->buckets[bucketno];
+			hashtable->buckets[bucketno] = copyTuple;
+			hashtable->nInMemory++;
+
+			/*
+			 * We have reduced skew space, but overall space only changes by
+			 * the tuple's bucket directory entry
+			 */
 			hashtable->spaceUsedSkew -= tupleSize;
+			hashtable->spaceUsed += HJDIRECTORY_ENTRY_SIZE;
 		}
 		else
 		{
@@ -1462,3 +1940,521 @@ ExecHashRemoveNextSkewBucket(HashJoinTable hashtable)
 		hashtable->spaceUsedSkew = 0;
 	}
 }
+
+/*
+ * ExecHashSharedBegin
+ *
+ *		Set up shared storage for the first batch, if the Parallel Seq Scan
+ *		below us is going to use workers and they can compute what we need.
+ *		See the notes at the top of this file.
+ */
+static void
+ExecHashSharedBegin(HashState *node)
+{
+	HashJoinTable hashtable = node->hashtable;
+	ParallelSeqScanState *scanstate;
+	List	   *tlist;
+	List	   *keyexprs = NIL;
+	char	   *tliststr;
+	char	   *keysstr;
+	uint32	   *skew;
+	int			nkeys;
+	int			nskew;
+	Size		off;
+	Size		size;
+	HashSharedState *sstate;
+	HashSharedHeader *header;
+	Oid		   *hashfn;
+	bool	   *strict;
+	ListCell   *lc;
+	int			i;
+
+	scanstate = (ParallelSeqScanState *) outerPlanState(node);
+	Assert(IsA(scanstate, ParallelSeqScanState));
+	scanstate->pss_hashseg = NULL;
+
+	if (!ExecParallelSeqScanCanUseWorkers(scanstate))
+		return;
+
+	/*
+	 * The workers must evaluate the scan's targetlist and our hash keys, so
+	 * apply the same test the planner applied to the scan's qual.
+	 */
+	tlist = scanstate->ss.ps.plan->targetlist;
+	foreach(lc, node->hashkeys)
+		keyexprs = lappend(keyexprs, ((ExprState *) lfirst(lc))->expr);
+	if (has_parallel_hazard((Node *) tlist) ||
+		has_parallel_hazard((Node *) keyexprs) ||
+		expression_returns_set((Node *) tlist))
+		return;
+
+	tliststr = nodeToString(tlist);
+	keysstr = nodeToString(keyexprs);
+	nkeys = list_length(keyexprs);
+
+	/* Collect the skew hash values, so workers can pass those tuples on. */
+	nskew = hashtable->nSkewBuckets;
+	skew = (uint32 *) palloc(Max(nskew, 1) * sizeof(uint32));
+	for (i = 0; i < nskew; i++)
+		skew[i] = hashtable->skewBucket[hashtable->skewBucketNums[i]]->hashvalue;
+	qsort(skew, nskew, sizeof(uint32), uint32_cmp);
+
+	/*
+	 * Lay out the segment.  The tuple space is as large as the whole
+	 * in-memory table is allowed to be; pages we never touch should cost
+	 * nothing.
+	 */
+	off = MAXALIGN(sizeof(HashSharedHeader));
+	off = add_size(off, MAXALIGN(nkeys * sizeof(Oid)));
+	off = add_size(off, MAXALIGN(nkeys * sizeof(bool)));
+	off = add_size(off, MAXALIGN(nskew * sizeof(uint32)));
+	off = add_size(off, MAXALIGN(strlen(tliststr) + 1));
+	off = add_size(off, MAXALIGN(strlen(keysstr) + 1));
+	size = add_size(off, hashtable->spaceAllowed);
+
+	sstate = (HashSharedState *)
+		MemoryContextAllocZero(hashtable->hashCxt, sizeof(HashSharedState));
+	sstate->seg = dsm_create(size);
+	header = (HashSharedHeader *) dsm_segment_address(sstate->seg);
+	sstate->header = header;
+
+	SpinLockInit(&header->mutex);
+	header->chunks = 0;
+	header->full = false;
+	header->segsize = size;
+	header->nbuckets = hashtable->nbuckets;
+	header->log2_nbuckets = hashtable->log2_nbuckets;
+	header->nbatch = hashtable->nbatch;
+	header->keepNulls = hashtable->keepNulls;
+	header->nkeys = nkeys;
+	header->nskew = nskew;
+
+	off = MAXALIGN(sizeof(HashSharedHeader));
+	header->hashfn_off = off;
+	hashfn = (Oid *) HashSharedAddress(header, off);
+	for (i = 0; i < nkeys; i++)
+		hashfn[i] = hashtable->inner_hashfunctions[i].fn_oid;
+	off += MAXALIGN(nkeys * sizeof(Oid));
+
+	header->strict_off = off;
+	strict = (bool *) HashSharedAddress(header, off);
+	for (i = 0; i < nkeys; i++)
+		strict[i] = hashtable->hashStrict[i];
+	off += MAXALIGN(nkeys * sizeof(bool));
+
+	header->skew_off = off;
+	memcpy(HashSharedAddress(header, off), skew, nskew * sizeof(uint32));
+	off += MAXALIGN(nskew * sizeof(uint32));
+
+	header->tlist_off = off;
+	strcpy(HashSharedAddress(header, off), tliststr);
+	off += MAXALIGN(strlen(tliststr) + 1);
+
+	header->hashkeys_off = off;
+	strcpy(HashSharedAddress(header, off), keysstr);
+	off += MAXALIGN(strlen(keysstr) + 1);
+
+	header->freeoff = off;
+
+	pfree(skew);
+	pfree(tliststr);
+	pfree(keysstr);
+	list_free(keyexprs);
+
+	hashtable->shared = sstate;
+	scanstate->pss_hashseg = sstate->seg;
+}
+
+/*
+ * ExecHashSharedInsert
+ *
+ *		Master's equivalent of ExecHashTableInsert during a parallel build.
+ *		First-batch tuples go into the shared segment if there's room, or
+ *		are set aside until ExecHashSharedFinish if not.
+ */
+static void
+ExecHashSharedInsert(HashJoinTable hashtable,
+					 TupleTableSlot *slot,
+					 uint32 hashvalue)
+{
+	HashSharedState *sstate = hashtable->shared;
+	MinimalTuple tuple;
+	int			bucketno;
+	int			batchno;
+
+	ExecHashGetBucketAndBatch(hashtable, hashvalue, &bucketno, &batchno);
+	if (batchno != hashtable->curbatch)
+	{
+		/* it just goes to a temp file */
+		ExecHashTableInsert(hashtable, slot, hashvalue);
+		return;
+	}
+
+	tuple = ExecFetchSlotMinimalTuple(slot);
+	if (!ExecHashSharedStore(sstate, tuple, hashvalue))
+		ExecHashJoinSaveTuple(tuple, hashvalue, &sstate->deferred);
+}
+
+/*
+ * ExecHashSharedFinish
+ *
+ *		Once the inner scan is complete, link the tuples in the shared
+ *		segment into the hash table, then insert the tuples that didn't fit.
+ */
+static void
+ExecHashSharedFinish(HashState *node)
+{
+	HashJoinTable hashtable = node->hashtable;
+	HashSharedState *sstate = hashtable->shared;
+	volatile HashSharedHeader *vheader = sstate->header;
+	Size		off;
+	double		nshared = 0;
+
+	/*
+	 * All the workers have exited, so nobody else is using the segment.
+	 * Taking the lock makes sure we see everything they stored.
+	 */
+	SpinLockAcquire(&vheader->mutex);
+	off = vheader->chunks;
+	SpinLockRelease(&vheader->mutex);
+
+	while (off != 0)
+	{
+		HashSharedChunk *chunk;
+		char	   *ptr;
+		char	   *end;
+
+		chunk = (HashSharedChunk *) HashSharedAddress(sstate->header, off);
+		ptr = (char *) chunk + HASH_SHARED_CHUNK_HDRSZ;
+		end = ptr + chunk->used;
+		while (ptr < end)
+		{
+			HashJoinTuple hashTuple = (HashJoinTuple) ptr;
+			MinimalTuple tuple = HJTUPLE_MINTUPLE(hashTuple);
+			int			bucketno;
+			int			batchno;
+
+			ptr += MAXALIGN(HJTUPLE_OVERHEAD + tuple->t_len);
+			nshared += 1;
+
+			if (hashtable->bloom != NULL)
+				ExecHashBloomAdd(hashtable, hashTuple->hashvalue);
+
+			/*
+			 * nbatch may have gone up while the scan was running, if the skew
+			 * table overflowed, so some tuples may now belong to later
+			 * batches.
+			 */
+			ExecHashGetBucketAndBatch(hashtable, hashTuple->hashvalue,
+									  &bucketno, &batchno);
+			if (batchno == hashtable->curbatch)
+			{
+				hashTuple->next = hashtable->buckets[bucketno];
+				hashtable->buckets[bucketno] = hashTuple;
+				hashtable->nInMemory++;
+				hashtable->spaceUsed += HJTUPLE_OVERHEAD + tuple->t_len +
+					HJDIRECTORY_ENTRY_SIZE;
+			}
+			else
+				ExecHashJoinSaveTuple(tuple, hashTuple->hashvalue,
+									  &hashtable->innerBatchFile[batchno]);
+		}
+		off = chunk->next;
+	}
+	sstate->chunk = NULL;
+
+	/* Our own tuples were counted as we got them; count the workers' */
+	hashtable->totalTuples += nshared - sstate->nstored;
+
+	if (hashtable->spaceUsed > hashtable->spacePeak)
+		hashtable->spacePeak = hashtable->spaceUsed;
+
+	/* Now that we can see the whole table, split it if it's too big. */
+	while (hashtable->spaceUsed > hashtable->spaceAllowed &&
+		   hashtable->growEnabled)
+	{
+		int			oldnbatch = hashtable->nbatch;
+
+		ExecHashIncreaseNumBatches(hashtable);
+		if (hashtable->nbatch == oldnbatch)
+			break;
+	}
+
+	/* Finally, insert the tuples we set aside. */
+	if (sstate->deferred != NULL)
+	{
+		TupleTableSlot *slot;
+		uint32		hashvalue;
+
+		if (BufFileSeek(sstate->deferred, 0, 0L, SEEK_SET))
+			ereport(ERROR,
+					(errcode_for_file_access(),
+				   errmsg("could not rewind hash-join temporary file: %m")));
+
+		slot = MakeSingleTupleTableSlot(ExecGetResultType(&node->ps));
+		while (ExecHashJoinGetSavedTuple(sstate->deferred, &hashvalue, slot))
+			ExecHashTableInsert(hashtable, slot, hashvalue);
+		ExecDropSingleTupleTableSlot(slot);
+
+		BufFileClose(sstate->deferred);
+		sstate->deferred = NULL;
+	}
+}
+
+/*
+ * ExecHashSharedRelease
+ *
+ *		Detach from the shared segment.  Any tuples in it must already have
+ *		been unlinked from the buckets, or be about to be.
+ */
+static void
+ExecHashSharedRelease(HashJoinTable hashtable)
+{
+	HashSharedState *sstate = hashtable->shared;
+
+	if (sstate == NULL)
+		return;
+
+	if (sstate->deferred != NULL)
+		BufFileClose(sstate->deferred);
+	dsm_detach(sstate->seg);
+	pfree(sstate);
+	hashtable->shared = NULL;
+}
+
+/*
+ * ExecHashSharedStore
+ *
+ *		Copy a tuple into the shared segment.  Returns false if there's no
+ *		room for it.
+ */
+static bool
+ExecHashSharedStore(HashSharedState *sstate,
+					MinimalTuple tuple,
+					uint32 hashvalue)
+{
+	HashSharedChunk *chunk = sstate->chunk;
+	Size		hashTupleSize = MAXALIGN(HJTUPLE_OVERHEAD + tuple->t_len);
+	HashJoinTuple hashTuple;
+
+	if (chunk == NULL || chunk->size - chunk->used < hashTupleSize)
+	{
+		/* use volatile pointer to prevent code rearrangement */
+		volatile HashSharedHeader *vheader = sstate->header;
+		Size		chunksize;
+		Size		off;
+
+		chunksize = Max(HASH_SHARED_CHUNK_SIZE,
+						HASH_SHARED_CHUNK_HDRSZ + hashTupleSize);
+
+		SpinLockAcquire(&vheader->mutex);
+		if (vheader->full || vheader->segsize - vheader->freeoff < chunksize)
+		{
+			/* Once one allocation fails, everyone stops trying. */
+			vheader->full = true;
+			SpinLockRelease(&vheader->mutex);
+			return false;
+		}
+		off = vheader->freeoff;
+		vheader->freeoff += chunksize;
+		chunk = (HashSharedChunk *) HashSharedAddress(sstate->header, off);
+		chunk->next = vheader->chunks;
+		chunk->size = chunksize - HASH_SHARED_CHUNK_HDRSZ;
+		chunk->used = 0;
+		vheader->chunks = off;
+		SpinLockRelease(&vheader->mutex);
+
+		sstate->chunk = chunk;
+	}
+
+	hashTuple = (HashJoinTuple)
+		((char *) chunk + HASH_SHARED_CHUNK_HDRSZ + chunk->used);
+	hashTuple->next = NULL;
+	hashTuple->hashvalue = hashvalue;
+	memcpy(HJTUPLE_MINTUPLE(hashTuple), tuple, tuple->t_len);
+	HeapTupleHeaderClearMatch(HJTUPLE_MINTUPLE(hashTuple));
+	chunk->used += hashTupleSize;
+	sstate->nstored += 1;
+
+	return true;
+}
+
+/*
+ * ExecHashTupleIsShared
+ *
+ *		Is this tuple in the shared segment, rather than in batchCxt?
+ */
+static bool
+ExecHashTupleIsShared(HashJoinTable hashtable, HashJoinTuple hashTuple)
+{
+	HashSharedState *sstate = hashtable->shared;
+	char	   *base;
+
+	if (sstate == NULL)
+		return false;
+	base = (char *) sstate->header;
+	return (char *) hashTuple >= base &&
+		(char *) hashTuple < base + sstate->header->segsize;
+}
+
+/*
+ * ExecHashSharedWorkerBegin
+ *
+ *		Called in a parallel worker to attach to the master's shared
+ *		hashtable storage.
+ */
+HashSharedWorkerState *
+ExecHashSharedWorkerBegin(dsm_handle handle)
+{
+	HashSharedWorkerState *wstate;
+	HashSharedHeader *header;
+	HashJoinTable hashtable;
+	MemoryContext oldcontext;
+	Oid		   *hashfn;
+	bool	   *strict;
+	List	   *tlist;
+	List	   *hashkeys;
+	TupleTableSlot *resultslot;
+	int			i;
+
+	wstate = (HashSharedWorkerState *) palloc0(sizeof(HashSharedWorkerState));
+	wstate->storage.seg = dsm_attach(handle);
+	if (wstate->storage.seg == NULL)
+		ereport(ERROR,
+				(errcode(ERRCODE_OBJECT_NOT_IN_PREREQUISITE_STATE),
+				 errmsg("could not map dynamic shared memory segment")));
+	header = (HashSharedHeader *) dsm_segment_address(wstate->storage.seg);
+	wstate->storage.header = header;
+
+	/* Set up just enough of a hashtable to compute buckets and batches. */
+	hashtable = &wstate->hashtable;
+	hashtable->nbuckets = header->nbuckets;
+	hashtable->log2_nbuckets = header->log2_nbuckets;
+	hashtable->nbatch = header->nbatch;
+	hashtable->curbatch = 0;
+	hashtable->keepNulls = header->keepNulls;
+	hashtable->inner_hashfunctions =
+		(FmgrInfo *) palloc(header->nkeys * sizeof(FmgrInfo));
+	hashtable->hashStrict = (bool *) palloc(header->nkeys * sizeof(bool));
+	hashfn = (Oid *) HashSharedAddress(header, header->hashfn_off);
+	strict = (bool *) HashSharedAddress(header, header->strict_off);
+	for (i = 0; i < header->nkeys; i++)
+	{
+		fmgr_info(hashfn[i], &hashtable->inner_hashfunctions[i]);
+		hashtable->hashStrict[i] = strict[i];
+	}
+
+	wstate->skew = (uint32 *) HashSharedAddress(header, header->skew_off);
+	wstate->nskew = header->nskew;
+
+	/*
+	 * Rebuild the scan's projection, so that we store the same tuples the
+	 * master would have got from the scan, and the hash keys, which refer
+	 * to the projected tuple as the inner tuple.
+	 */
+	wstate->estate = CreateExecutorState();
+	oldcontext = MemoryContextSwitchTo(wstate->estate->es_query_cxt);
+
+	tlist = (List *) stringToNode(HashSharedAddress(header, header->tlist_off));
+	fix_opfuncids((Node *) tlist);
+	hashkeys = (List *)
+		stringToNode(HashSharedAddress(header, header->hashkeys_off));
+	fix_opfuncids((Node *) hashkeys);
+
+	wstate->projcontext = CreateExprContext(wstate->estate);
+	wstate->hashcontext = CreateExprContext(wstate->estate);
+	resultslot = ExecInitExtraTupleSlot(wstate->estate);
+	ExecSetSlotDescriptor(resultslot, ExecTypeFromTL(tlist, false));
+	wstate->projection =
+		ExecBuildProjectionInfo((List *) ExecInitExpr((Expr *) tlist, NULL),
+								wstate->projcontext, resultslot, NULL);
+	wstate->hashkeys = (List *) ExecInitExpr((Expr *) hashkeys, NULL);
+
+	MemoryContextSwitchTo(oldcontext);
+
+	return wstate;
+}
+
+/*
+ * ExecHashSharedWorkerInsert
+ *
+ *		Called in a parallel worker for each tuple that passes the scan's
+ *		qual.  Returns true if the tuple has been taken care of, or false
+ *		if it should be sent to the master.
+ */
+bool
+ExecHashSharedWorkerInsert(HashSharedWorkerState *wstate, TupleTableSlot *slot)
+{
+	HashJoinTable hashtable = &wstate->hashtable;
+	TupleTableSlot *resultslot;
+	uint32		hashvalue;
+	int			bucketno;
+	int			batchno;
+
+	/*
+	 * Once the segment is full, don't bother hashing anything.  Reading the
+	 * flag without the lock is fine, since it never goes back to false.
+	 */
+	if (wstate->storage.header->full)
+		return false;
+
+	ResetExprContext(wstate->projcontext);
+	wstate->projcontext->ecxt_scantuple = slot;
+	resultslot = ExecProject(wstate->projection, NULL);
+
+	wstate->hashcontext->ecxt_innertuple = resultslot;
+	if (!ExecHashGetHashValue(hashtable, wstate->hashcontext,
+							  wstate->hashkeys, false,
+							  hashtable->keepNulls, &hashvalue))
+		return true;			/* can't match, so the master doesn't want it */
+
+	/* Skew tuples and later batches are the master's business. */
+	if (wstate->nskew > 0 &&
+		bsearch(&hashvalue, wstate->skew, wstate->nskew, sizeof(uint32),
+				uint32_cmp) != NULL)
+		return false;
+	ExecHashGetBucketAndBatch(hashtable, hashvalue, &bucketno, &batchno);
+	if (batchno != 0)
+		return false;
+
+	return ExecHashSharedStore(&wstate->storage,
+							   ExecFetchSlotMinimalTuple(resultslot),
+							   hashvalue);
+}
+
+/*
+ * ExecHashSharedWorkerEnd
+ *
+ *		Called in a parallel worker when its scan is done.
+ */
+void
+ExecHashSharedWorkerEnd(HashSharedWorkerState *wstate)
+{
+	volatile HashSharedHeader *vheader = wstate->storage.header;
+
+	/* Make sure the master will see everything we stored. */
+	SpinLockAcquire(&vheader->mutex);
+	SpinLockRelease(&vheader->mutex);
+
+	FreeExecutorState(wstate->estate);
+	dsm_detach(wstate->storage.seg);
+	pfree(wstate->hashtable.inner_hashfunctions);
+	pfree(wstate->hashtable.hashStrict);
+	pfree(wstate);
+}
+
+/*
+ * qsort/bsearch comparator for skew hash values
+ */
+static int
+uint32_cmp(const void *a, const void *b)
+{
+	uint32		av = *(const uint32 *) a;
+	uint32		bv = *(const uint32 *) b;
+
+	if (av < bv)
+		return -1;
+	if (av > bv)
+		return 1;
+	return 0;
+}
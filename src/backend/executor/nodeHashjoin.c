@@ -42,10 +42,6 @@
 static TupleTableSlot *ExecHashJoinOuterGetTuple(PlanState *outerNode,
 						  HashJoinState *hjstate,
 						  uint32 *hashvalue);
-static TupleTableSlot *ExecHashJoinGetSavedTuple(HashJoinState *hjstate,
-						  BufFile *file,
-						  uint32 *hashvalue,
-						  TupleTableSlot *tupleSlot);
 static bool ExecHashJoinNewBatch(HashJoinState *hjstate);
 
 
@@ -168,7 +164,8 @@ ExecHashJoin(HashJoinState *node)
 				 */
 				hashtable = ExecHashTableCreate((Hash *) hashNode->ps.plan,
 												node->hj_HashOperators,
-												HJ_FILL_INNER(node));
+												HJ_FILL_INNER(node),
+												node->hj_OuterFilter != NULL);
 				node->hj_HashTable = hashtable;
 
 				/*
@@ -185,6 +182,13 @@ ExecHashJoin(HashJoinState *node)
 				if (hashtable->totalTuples == 0 && !HJ_FILL_OUTER(node))
 					return NULL;
 
+				/*
+				 * From now on, the outer scan can throw away rows that can't
+				 * match anything we just hashed.
+				 */
+				if (node->hj_OuterFilter)
+					node->hj_OuterFilter->hashtable = hashtable;
+
 				/*
 				 * need to remember whether nbatch has increased since we
 				 * began scanning the outer relation
@@ -465,13 +469,11 @@ ExecInitHashJoin(HashJoin *node, EState *estate, int eflags)
 	hjstate->js.ps.targetlist = (List *)
 		ExecInitExpr((Expr *) node->join.plan.targetlist,
 					 (PlanState *) hjstate);
-	hjstate->js.ps.qual = (List *)
-		ExecInitExpr((Expr *) node->join.plan.qual,
-					 (PlanState *) hjstate);
+	hjstate->js.ps.qual =
+		ExecInitQual(node->join.plan.qual, (PlanState *) hjstate);
 	hjstate->js.jointype = node->join.jointype;
-	hjstate->js.joinqual = (List *)
-		ExecInitExpr((Expr *) node->join.joinqual,
-					 (PlanState *) hjstate);
+	hjstate->js.joinqual =
+		ExecInitQual(node->join.joinqual, (PlanState *) hjstate);
 	hjstate->hashclauses = (List *)
 		ExecInitExpr((Expr *) node->hashclauses,
 					 (PlanState *) hjstate);
@@ -586,6 +588,31 @@ ExecInitHashJoin(HashJoin *node, EState *estate, int eflags)
 	/* child Hash node needs to evaluate inner hash keys, too */
 	((HashState *) innerPlanState(hjstate))->hashkeys = rclauses;
 
+	/*
+	 * If the planner decided the outer scan should filter its rows, give it
+	 * the filter, and the outer hash keys in a form it can evaluate.  The
+	 * filter stays inactive until we have built the hash table.
+	 */
+	hjstate->hj_OuterFilter = NULL;
+	if (node->filterkeys != NIL)
+	{
+		ScanState  *outerscan = (ScanState *) outerPlanState(hjstate);
+		HashJoinFilter *filter;
+
+		Assert(IsA(outerscan, SeqScanState) ||
+			   IsA(outerscan, IndexScanState) ||
+			   IsA(outerscan, BitmapHeapScanState));
+
+		filter = (HashJoinFilter *) palloc0(sizeof(HashJoinFilter));
+		filter->hashtable = NULL;
+		filter->keys = (List *) ExecInitExpr((Expr *) node->filterkeys,
+											 (PlanState *) outerscan);
+		filter->enabled = true;
+
+		outerscan->ss_HashFilter = filter;
+		hjstate->hj_OuterFilter = filter;
+	}
+
 	hjstate->js.ps.ps_TupFromTlist = false;
 	hjstate->hj_JoinState = HJ_BUILD_HASHTABLE;
 	hjstate->hj_MatchedOuter = false;
@@ -608,6 +635,8 @@ ExecEndHashJoin(HashJoinState *node)
 	 */
 	if (node->hj_HashTable)
 	{
+		if (node->hj_OuterFilter)
+			node->hj_OuterFilter->hashtable = NULL;
 		ExecHashTableDestroy(node->hj_HashTable);
 		node->hj_HashTable = NULL;
 	}
@@ -702,8 +731,7 @@ ExecHashJoinOuterGetTuple(PlanState *outerNode,
 		if (file == NULL)
 			return NULL;
 
-		slot = ExecHashJoinGetSavedTuple(hjstate,
-										 file,
+		slot = ExecHashJoinGetSavedTuple(file,
 										 hashvalue,
 										 hjstate->hj_OuterTupleSlot);
 		if (!TupIsNull(slot))
@@ -822,8 +850,7 @@ ExecHashJoinNewBatch(HashJoinState *hjstate)
 					(errcode_for_file_access(),
 				   errmsg("could not rewind hash-join temporary file: %m")));
 
-		while ((slot = ExecHashJoinGetSavedTuple(hjstate,
-												 innerFile,
+		while ((slot = ExecHashJoinGetSavedTuple(innerFile,
 												 &hashvalue,
 												 hjstate->hj_HashTupleSlot)))
 		{
@@ -842,6 +869,8 @@ ExecHashJoinNewBatch(HashJoinState *hjstate)
 		hashtable->innerBatchFile[curbatch] = NULL;
 	}
 
+	ExecHashTableBuildDirectory(hashtable);
+
 	/*
 	 * Rewind outer batch file (if present), so that we can start reading it.
 	 */
@@ -901,9 +930,8 @@ ExecHashJoinSaveTuple(MinimalTuple tuple, uint32 hashvalue,
  * On success, *hashvalue is set to the tuple's hash value, and the tuple
  * itself is stored in the given slot.
  */
-static TupleTableSlot *
-ExecHashJoinGetSavedTuple(HashJoinState *hjstate,
-						  BufFile *file,
+TupleTableSlot *
+ExecHashJoinGetSavedTuple(BufFile *file,
 						  uint32 *hashvalue,
 						  TupleTableSlot *tupleSlot)
 {
@@ -981,6 +1009,8 @@ ExecReScanHashJoin(HashJoinState *node)
 		else
 		{
 			/* must destroy and rebuild hash table */
+			if (node->hj_OuterFilter)
+				node->hj_OuterFilter->hashtable = NULL;
 			ExecHashTableDestroy(node->hj_HashTable);
 			node->hj_HashTable = NULL;
 			node->hj_JoinState = HJ_BUILD_HASHTABLE;
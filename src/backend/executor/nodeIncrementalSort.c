@@ -0,0 +1,355 @@
+/*-------------------------------------------------------------------------
+ *
+ * nodeIncrementalSort.c
+ *	  Routines to handle incremental sorting of relations.
+ *
+ * An incremental sort is used when the input is already sorted by a leading
+ * prefix of the required sort keys.  Rather than reading and sorting the
+ * whole input at once, we need only sort each group of tuples that have
+ * equal values in the presorted columns, and can return the first group's
+ * tuples as soon as the group is complete.  That cuts the memory and the
+ * comparisons needed, and lets a LIMIT stop reading the input early.
+ *
+ * Groups are often tiny, and starting a separate sort for each one would be
+ * expensive, so we gather at least INCSORT_MIN_BATCH_TUPLES tuples into a
+ * batch, then keep adding tuples until the group that the last of those
+ * belongs to is complete.  Since a batch is always made of whole groups,
+ * sorting it on all the sort keys gives the right result.
+ *
+ * Portions Copyright (c) 1996-2014, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, Regents of the University of California
+ *
+ *
+ * IDENTIFICATION
+ *	  src/backend/executor/nodeIncrementalSort.c
+ *
+ *-------------------------------------------------------------------------
+ */
+
+#include "postgres.h"
+
+#include "executor/execdebug.h"
+#include "executor/executor.h"
+#include "executor/nodeIncrementalSort.h"
+#include "miscadmin.h"
+#include "utils/lsyscache.h"
+#include "utils/tuplesort.h"
+
+
+static void incsort_end_batch(IncrementalSortState *node);
+static bool incsort_read_batch(IncrementalSortState *node);
+
+
+/* ----------------------------------------------------------------
+ *		ExecIncrementalSort
+ *
+ *		Returns the next tuple in sorted order, sorting a new batch of
+ *		tuples from the outer subtree whenever the previous one has been
+ *		returned in full.
+ *
+ *		Conditions:
+ *		  -- none.
+ *
+ *		Initial States:
+ *		  -- the outer child is prepared to return the first tuple.
+ * ----------------------------------------------------------------
+ */
+TupleTableSlot *
+ExecIncrementalSort(IncrementalSortState *node)
+{
+	TupleTableSlot *slot = node->ss.ps.ps_ResultTupleSlot;
+
+	for (;;)
+	{
+		if (node->tuplesortstate == NULL)
+		{
+			/* Sort the next batch, if there is one */
+			if (!incsort_read_batch(node))
+				return ExecClearTuple(slot);
+		}
+
+		if (tuplesort_gettupleslot((Tuplesortstate *) node->tuplesortstate,
+								   true, slot))
+		{
+			node->bound_Done++;
+			return slot;
+		}
+
+		/* This batch is used up; move on to the next */
+		incsort_end_batch(node);
+	}
+}
+
+/*
+ * Read the next batch of tuples from the outer plan and sort it.  Returns
+ * false if the input is exhausted.
+ */
+static bool
+incsort_read_batch(IncrementalSortState *node)
+{
+	IncrementalSort *plannode = (IncrementalSort *) node->ss.ps.plan;
+	PlanState  *outerNode = outerPlanState(node);
+	int			presortedCols = plannode->presortedCols;
+	Tuplesortstate *tuplesortstate;
+	TupleDesc	tupDesc;
+	int64		ntuples = 0;
+
+	if (node->outerNodeDone && TupIsNull(node->lookahead_slot))
+		return false;
+
+	SO1_printf("ExecIncrementalSort: %s\n",
+			   "sorting next batch");
+
+	tupDesc = ExecGetResultType(outerNode);
+	tuplesortstate = tuplesort_begin_heap(tupDesc,
+										  plannode->sort.numCols,
+										  plannode->sort.sortColIdx,
+										  plannode->sort.sortOperators,
+										  plannode->sort.collations,
+										  plannode->sort.nullsFirst,
+										  work_mem,
+										  false);
+
+	/*
+	 * If we've been told how many tuples are wanted, this batch need only
+	 * produce the ones we haven't returned yet.
+	 */
+	if (node->bounded && node->bound > node->bound_Done)
+		tuplesort_set_bound(tuplesortstate, node->bound - node->bound_Done);
+	node->tuplesortstate = (void *) tuplesortstate;
+
+	/* The tuple that ended the previous batch starts this one */
+	if (!TupIsNull(node->lookahead_slot))
+	{
+		tuplesort_puttupleslot(tuplesortstate, node->lookahead_slot);
+		ExecCopySlot(node->group_pivot, node->lookahead_slot);
+		ExecClearTuple(node->lookahead_slot);
+		ntuples++;
+	}
+
+	while (!node->outerNodeDone)
+	{
+		TupleTableSlot *slot = ExecProcNode(outerNode);
+
+		if (TupIsNull(slot))
+		{
+			node->outerNodeDone = true;
+			break;
+		}
+
+		/*
+		 * Once the batch is big enough, stop at the first tuple that isn't
+		 * in the same group as the last one we took, and save it for the
+		 * next batch.
+		 */
+		if (ntuples >= INCSORT_MIN_BATCH_TUPLES &&
+			!execTuplesMatch(node->group_pivot, slot,
+							 presortedCols, plannode->sort.sortColIdx,
+							 node->eqfunctions,
+							 node->ss.ps.ps_ExprContext->ecxt_per_tuple_memory))
+		{
+			ExecCopySlot(node->lookahead_slot, slot);
+			break;
+		}
+
+		tuplesort_puttupleslot(tuplesortstate, slot);
+		ntuples++;
+		if (ntuples == INCSORT_MIN_BATCH_TUPLES)
+			ExecCopySlot(node->group_pivot, slot);
+	}
+
+	tuplesort_performsort(tuplesortstate);
+	node->nbatches++;
+
+	SO1_printf("ExecIncrementalSort: %s\n", "sorting done");
+
+	return true;
+}
+
+/*
+ * Release the current batch's sort, remembering its space usage for
+ * EXPLAIN ANALYZE.
+ */
+static void
+incsort_end_batch(IncrementalSortState *node)
+{
+	Tuplesortstate *tuplesortstate = (Tuplesortstate *) node->tuplesortstate;
+	const char *sortMethod;
+	const char *spaceType;
+	long		spaceUsed;
+
+	tuplesort_get_stats(tuplesortstate, &sortMethod, &spaceType, &spaceUsed);
+	if (node->maxSpaceType == NULL || spaceUsed > node->maxSpaceUsed)
+	{
+		node->maxSpaceUsed = spaceUsed;
+		node->maxSpaceType = spaceType;
+	}
+
+	tuplesort_end(tuplesortstate);
+	node->tuplesortstate = NULL;
+}
+
+/* ----------------------------------------------------------------
+ *		ExecInitIncrementalSort
+ *
+ *		Creates the run-time state information for the incremental sort
+ *		node produced by the planner and initializes its outer subtree.
+ * ----------------------------------------------------------------
+ */
+IncrementalSortState *
+ExecInitIncrementalSort(IncrementalSort *node, EState *estate, int eflags)
+{
+	IncrementalSortState *incrsortstate;
+	Oid		   *eqOperators;
+	int			i;
+
+	SO1_printf("ExecInitIncrementalSort: %s\n",
+			   "initializing incremental sort node");
+
+	/* We keep only one batch at a time, so can't go back or mark. */
+	Assert(!(eflags & (EXEC_FLAG_BACKWARD | EXEC_FLAG_MARK)));
+
+	/*
+	 * create state structure
+	 */
+	incrsortstate = makeNode(IncrementalSortState);
+	incrsortstate->ss.ps.plan = (Plan *) node;
+	incrsortstate->ss.ps.state = estate;
+
+	incrsortstate->bounded = false;
+	incrsortstate->bound_Done = 0;
+	incrsortstate->outerNodeDone = false;
+	incrsortstate->tuplesortstate = NULL;
+	incrsortstate->nbatches = 0;
+	incrsortstate->maxSpaceUsed = 0;
+	incrsortstate->maxSpaceType = NULL;
+
+	/*
+	 * Miscellaneous initialization
+	 *
+	 * We need an ExprContext only for its per-tuple memory, which
+	 * execTuplesMatch uses when comparing the presorted columns.
+	 */
+	ExecAssignExprContext(estate, &incrsortstate->ss.ps);
+
+	/*
+	 * tuple table initialization
+	 */
+	ExecInitResultTupleSlot(estate, &incrsortstate->ss.ps);
+	ExecInitScanTupleSlot(estate, &incrsortstate->ss);
+	incrsortstate->group_pivot = ExecInitExtraTupleSlot(estate);
+	incrsortstate->lookahead_slot = ExecInitExtraTupleSlot(estate);
+
+	/*
+	 * initialize child nodes
+	 *
+	 * We shield the child node from the need to support REWIND, BACKWARD, or
+	 * MARK/RESTORE.
+	 */
+	eflags &= ~(EXEC_FLAG_REWIND | EXEC_FLAG_BACKWARD | EXEC_FLAG_MARK);
+
+	outerPlanState(incrsortstate) = ExecInitNode(outerPlan(node), estate,
+												 eflags);
+
+	/*
+	 * initialize tuple type.  no need to initialize projection info because
+	 * this node doesn't do projections.
+	 */
+	ExecAssignResultTypeFromTL(&incrsortstate->ss.ps);
+	ExecAssignScanTypeFromOuterPlan(&incrsortstate->ss);
+	incrsortstate->ss.ps.ps_ProjInfo = NULL;
+
+	ExecSetSlotDescriptor(incrsortstate->group_pivot,
+						  ExecGetResultType(outerPlanState(incrsortstate)));
+	ExecSetSlotDescriptor(incrsortstate->lookahead_slot,
+						  ExecGetResultType(outerPlanState(incrsortstate)));
+
+	/*
+	 * Precompute fmgr lookup data for comparing the presorted columns.
+	 */
+	eqOperators = (Oid *) palloc(node->presortedCols * sizeof(Oid));
+	for (i = 0; i < node->presortedCols; i++)
+	{
+		Oid			sortop = node->sort.sortOperators[i];
+
+		eqOperators[i] = get_equality_op_for_ordering_op(sortop, NULL);
+		if (!OidIsValid(eqOperators[i]))
+			elog(ERROR, "could not find equality operator for ordering operator %u",
+				 sortop);
+	}
+	incrsortstate->eqfunctions =
+		execTuplesMatchPrepare(node->presortedCols, eqOperators);
+	pfree(eqOperators);
+
+	SO1_printf("ExecInitIncrementalSort: %s\n",
+			   "incremental sort node initialized");
+
+	return incrsortstate;
+}
+
+/* ----------------------------------------------------------------
+ *		ExecEndIncrementalSort(node)
+ * ----------------------------------------------------------------
+ */
+void
+ExecEndIncrementalSort(IncrementalSortState *node)
+{
+	SO1_printf("ExecEndIncrementalSort: %s\n",
+			   "shutting down incremental sort node");
+
+	/*
+	 * Free the exprcontext
+	 */
+	ExecFreeExprContext(&node->ss.ps);
+
+	/*
+	 * clean out the tuple table
+	 */
+	ExecClearTuple(node->ss.ss_ScanTupleSlot);
+	/* must drop pointer to sort result tuple */
+	ExecClearTuple(node->ss.ps.ps_ResultTupleSlot);
+	ExecClearTuple(node->group_pivot);
+	ExecClearTuple(node->lookahead_slot);
+
+	/*
+	 * Release tuplesort resources
+	 */
+	if (node->tuplesortstate != NULL)
+		tuplesort_end((Tuplesortstate *) node->tuplesortstate);
+	node->tuplesortstate = NULL;
+
+	/*
+	 * shut down the subplan
+	 */
+	ExecEndNode(outerPlanState(node));
+
+	SO1_printf("ExecEndIncrementalSort: %s\n",
+			   "incremental sort node shutdown");
+}
+
+void
+ExecReScanIncrementalSort(IncrementalSortState *node)
+{
+	/*
+	 * We keep only the current batch, so there is nothing to rewind; we must
+	 * always forget what we have and read the subplan again.
+	 */
+	ExecClearTuple(node->ss.ps.ps_ResultTupleSlot);
+	ExecClearTuple(node->group_pivot);
+	ExecClearTuple(node->lookahead_slot);
+
+	if (node->tuplesortstate != NULL)
+	{
+		tuplesort_end((Tuplesortstate *) node->tuplesortstate);
+		node->tuplesortstate = NULL;
+	}
+	node->outerNodeDone = false;
+	node->bound_Done = 0;
+
+	/*
+	 * if chgParam of subnode is not null then plan will be re-scanned by
+	 * first ExecProcNode.
+	 */
+	if (node->ss.ps.lefttree->chgParam == NULL)
+		ExecReScan(node->ss.ps.lefttree);
+}
@@ -300,8 +300,8 @@ recompute_limits(LimitState *node)
 }
 
 /*
- * If we have a COUNT, and our input is a Sort node, notify it that it can
- * use bounded sort.  Also, if our input is a MergeAppend, we can apply the
+ * If we have a COUNT, and our input is a Sort or IncrementalSort node,
+ * notify it that it can use bounded sort.  Also, if our input is a MergeAppend, we can apply the
  * same bound to any Sorts that are direct children of the MergeAppend,
  * since the MergeAppend surely need read no more than that many tuples from
  * any one input.  We also have to be prepared to look through a Result,
@@ -311,9 +311,10 @@ recompute_limits(LimitState *node)
  * communicating between the two nodes; and it doesn't seem worth trying
  * to invent one without some more examples of special communication needs.
  *
- * Note: it is the responsibility of nodeSort.c to react properly to
- * changes of these parameters.  If we ever do redesign this, it'd be a
- * good idea to integrate this signaling with the parameter-change mechanism.
+ * Note: it is the responsibility of nodeSort.c and nodeIncrementalSort.c to
+ * react properly to changes of these parameters.  If we ever do redesign
+ * this, it'd be a good idea to integrate this signaling with the
+ * parameter-change mechanism.
  */
 static void
 pass_down_bound(LimitState *node, PlanState *child_node)
@@ -335,6 +336,23 @@ pass_down_bound(LimitState *node, PlanState *child_node)
 			sortState->bound = tuples_needed;
 		}
 	}
+	else if (IsA(child_node, IncrementalSortState))
+	{
+		IncrementalSortState *sortState = (IncrementalSortState *) child_node;
+		int64		tuples_needed = node->count + node->offset;
+
+		/* negative test checks for overflow in sum */
+		if (node->noCount || tuples_needed < 0)
+		{
+			/* make sure flag gets reset if needed upon rescan */
+			sortState->bounded = false;
+		}
+		else
+		{
+			sortState->bounded = true;
+			sortState->bound = tuples_needed;
+		}
+	}
 	else if (IsA(child_node, MergeAppendState))
 	{
 		MergeAppendState *maState = (MergeAppendState *) child_node;
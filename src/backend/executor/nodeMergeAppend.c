@@ -34,6 +34,9 @@
  *				/	\		  |		 |		|
  *			  nil	nil		 ...	...    ...
  *								 subplans
+ *
+ *		Run-time pruning of the subplans works as for Append nodes; see
+ *		nodeAppend.c and execPrune.c.
  */
 
 #include "postgres.h"
@@ -51,6 +54,7 @@
 typedef int32 SlotNumber;
 
 static int	heap_compare_slots(Datum a, Datum b, void *arg);
+static void exec_merge_append_prune(MergeAppendState *node);
 
 
 /* ----------------------------------------------------------------
@@ -67,6 +71,9 @@ ExecInitMergeAppend(MergeAppend *node, EState *estate, int eflags)
 	int			nplans;
 	int			i;
 	ListCell   *lc;
+	ListCell   *lcq;
+	ListCell   *lcc;
+	bool		need_prune = false;
 
 	/* check for unsupported flags */
 	Assert(!(eflags & (EXEC_FLAG_BACKWARD | EXEC_FLAG_MARK)));
@@ -84,18 +91,22 @@ ExecInitMergeAppend(MergeAppend *node, EState *estate, int eflags)
 	mergestate->ps.plan = (Plan *) node;
 	mergestate->ps.state = estate;
 	mergestate->mergeplans = mergeplanstates;
-	mergestate->ms_nplans = nplans;
 
 	mergestate->ms_slots = (TupleTableSlot **) palloc0(sizeof(TupleTableSlot *) * nplans);
 	mergestate->ms_heap = binaryheap_allocate(nplans, heap_compare_slots,
 											  mergestate);
+	mergestate->ms_prune_quals = NIL;
+	mergestate->ms_prune_constraints = NIL;
+	mergestate->ms_pruned = (bool *) palloc0(nplans * sizeof(bool));
 
 	/*
 	 * Miscellaneous initialization
 	 *
-	 * MergeAppend plans don't have expression contexts because they never
-	 * call ExecQual or ExecProject.
+	 * MergeAppend plans never call ExecQual or ExecProject, so they need an
+	 * expression context only for run-time pruning.
 	 */
+	if (node->prune_quals != NIL)
+		ExecAssignExprContext(estate, &mergestate->ps);
 
 	/*
 	 * MergeAppend nodes do have Result slots, which hold pointers to tuples,
@@ -105,16 +116,51 @@ ExecInitMergeAppend(MergeAppend *node, EState *estate, int eflags)
 
 	/*
 	 * call ExecInitNode on each of the plans to be executed and save the
-	 * results into the array "mergeplans".
+	 * results into the array "mergeplans".  As in ExecInitAppend, subplans
+	 * that can be pruned using the query's external parameters are left out.
 	 */
 	i = 0;
+	lcq = list_head(node->prune_quals);
+	lcc = list_head(node->prune_constraints);
 	foreach(lc, node->mergeplans)
 	{
 		Plan	   *initNode = (Plan *) lfirst(lc);
+		List	   *quals = NIL;
+		List	   *constraints = NIL;
+		bool		recheck = false;
+
+		if (lcq != NULL)
+		{
+			quals = (List *) lfirst(lcq);
+			constraints = (List *) lfirst(lcc);
+			lcq = lnext(lcq);
+			lcc = lnext(lcc);
+
+			if (ExecSubplanIsPrunable(mergestate->ps.ps_ExprContext,
+									  quals, constraints, true, &recheck) &&
+				(i > 0 || lnext(lc) != NULL))
+				continue;
+		}
 
 		mergeplanstates[i] = ExecInitNode(initNode, estate, eflags);
+		mergestate->ms_prune_quals =
+			lappend(mergestate->ms_prune_quals, recheck ? quals : NIL);
+		mergestate->ms_prune_constraints =
+			lappend(mergestate->ms_prune_constraints,
+					recheck ? constraints : NIL);
+		if (recheck)
+			need_prune = true;
 		i++;
 	}
+	mergestate->ms_nplans = i;
+	mergestate->ms_nremoved = nplans - i;
+
+	/* Don't bother with run-time pruning if no subplan depends on it */
+	if (!need_prune)
+	{
+		mergestate->ms_prune_quals = NIL;
+		mergestate->ms_prune_constraints = NIL;
+	}
 
 	/*
 	 * initialize output tuple type
@@ -164,10 +210,14 @@ ExecMergeAppend(MergeAppendState *node)
 	{
 		/*
 		 * First time through: pull the first tuple from each subplan, and set
-		 * up the heap.
+		 * up the heap.  Skip the subplans that run-time pruning rules out.
 		 */
+		if (node->ms_prune_quals != NIL)
+			exec_merge_append_prune(node);
 		for (i = 0; i < node->ms_nplans; i++)
 		{
+			if (node->ms_pruned[i])
+				continue;
 			node->ms_slots[i] = ExecProcNode(node->mergeplans[i]);
 			if (!TupIsNull(node->ms_slots[i]))
 				binaryheap_add_unordered(node->ms_heap, Int32GetDatum(i));
@@ -207,6 +257,27 @@ ExecMergeAppend(MergeAppendState *node)
 	return result;
 }
 
+/*
+ * Decide which subplans to skip, given the current values of the PARAM_EXEC
+ * Params that their pruning quals depend on.
+ */
+static void
+exec_merge_append_prune(MergeAppendState *node)
+{
+	ListCell   *lcq;
+	ListCell   *lcc;
+	int			i = 0;
+
+	forboth(lcq, node->ms_prune_quals, lcc, node->ms_prune_constraints)
+	{
+		node->ms_pruned[i] =
+			ExecSubplanIsPrunable(node->ps.ps_ExprContext,
+								  (List *) lfirst(lcq), (List *) lfirst(lcc),
+								  false, NULL);
+		i++;
+	}
+}
+
 /*
  * Compare the tuples in the two given slots.
  */
@@ -272,6 +343,12 @@ ExecEndMergeAppend(MergeAppendState *node)
 	 */
 	for (i = 0; i < nplans; i++)
 		ExecEndNode(mergeplans[i]);
+
+	/*
+	 * Free the exprcontext, if we made one for run-time pruning
+	 */
+	if (node->ps.ps_ExprContext)
+		ExecFreeExprContext(&node->ps);
 }
 
 void
@@ -17,15 +17,57 @@
  *		ExecNestLoop	 - process a nestloop join of two plans
  *		ExecInitNestLoop - initialize the join
  *		ExecEndNestLoop  - shut down the join
+ *
+ * When the inner side is an index scan that takes its keys from the outer
+ * row, each outer row costs a descent of the index from the root.  If the
+ * planner has given us sort keys for the parameters (numBatchKeys > 0), we
+ * read the outer rows in batches instead, sort each batch by the parameter
+ * values, and probe the inner side in that order, so that successive
+ * descents visit the same or neighbouring pages.  The inner tuples that
+ * pass the join quals are saved with their outer row, and the join rows are
+ * then produced in the original outer order, so the output is the same as
+ * without batching.
+ *
+ * Batches start with a single row and double in size up to
+ * NESTLOOP_MAX_BATCH_TUPLES, so a join that only needs a few outer rows
+ * doesn't read ahead much.  A batch also ends once its outer rows fill
+ * work_mem, and we stop probing in sorted order once the saved inner tuples
+ * do, even partway through the matches for one outer row (which are then
+ * thrown away); the rows of the batch that weren't probed yet are joined in
+ * the ordinary way, one at a time.
  */
 
 #include "postgres.h"
 
+#include "access/htup_details.h"
 #include "executor/execdebug.h"
 #include "executor/nodeNestloop.h"
+#include "miscadmin.h"
 #include "utils/memutils.h"
 
 
+/* one outer row of a batch */
+struct NestLoopBatchEntry
+{
+	HeapTuple	outertuple;		/* copy of the outer row */
+	Datum	   *keys;			/* its sort key values */
+	bool	   *nulls;			/* and their null flags */
+	bool		probed;			/* have we probed the inner side yet? */
+	bool		matched;		/* did any inner tuple pass the joinqual? */
+	List	   *matches;		/* inner tuples that did, if probed */
+};
+
+static void ExecNestLoopSetParams(NestLoopState *node,
+					  TupleTableSlot *outerTupleSlot);
+static TupleTableSlot *ExecNestLoopNextBatchOuter(NestLoopState *node);
+static bool ExecNestLoopFillBatch(NestLoopState *node);
+static bool ExecNestLoopProbeEntry(NestLoopState *node,
+					   NestLoopBatchEntry *entry,
+					   Size *space, long spaceAllowed);
+static int	batch_entry_cmp(const void *a, const void *b, void *arg);
+static void ExecNestLoopResetBatch(NestLoopState *node);
+
+
 /* ----------------------------------------------------------------
  *		ExecNestLoop(node)
  *
@@ -59,7 +101,6 @@
 TupleTableSlot *
 ExecNestLoop(NestLoopState *node)
 {
-	NestLoop   *nl;
 	PlanState  *innerPlan;
 	PlanState  *outerPlan;
 	TupleTableSlot *outerTupleSlot;
@@ -67,14 +108,13 @@ ExecNestLoop(NestLoopState *node)
 	List	   *joinqual;
 	List	   *otherqual;
 	ExprContext *econtext;
-	ListCell   *lc;
+	bool		storedMatch;
 
 	/*
 	 * get information from the node
 	 */
 	ENL1_printf("getting info from node");
 
-	nl = (NestLoop *) node->js.ps.plan;
 	joinqual = node->js.joinqual;
 	otherqual = node->js.ps.qual;
 	outerPlan = outerPlanState(node);
@@ -120,7 +160,10 @@ ExecNestLoop(NestLoopState *node)
 		if (node->nl_NeedNewOuter)
 		{
 			ENL1_printf("getting new outer tuple");
-			outerTupleSlot = ExecProcNode(outerPlan);
+			if (node->nl_Batched)
+				outerTupleSlot = ExecNestLoopNextBatchOuter(node);
+			else
+				outerTupleSlot = ExecProcNode(outerPlan);
 
 			/*
 			 * if there are no more outer tuples, then the join is complete..
@@ -136,34 +179,22 @@ ExecNestLoop(NestLoopState *node)
 			node->nl_NeedNewOuter = false;
 			node->nl_MatchedOuter = false;
 
-			/*
-			 * fetch the values of any outer Vars that must be passed to the
-			 * inner scan, and store them in the appropriate PARAM_EXEC slots.
-			 */
-			foreach(lc, nl->nestParams)
+			if (node->nl_BatchEntry != NULL && node->nl_BatchEntry->probed)
 			{
-				NestLoopParam *nlp = (NestLoopParam *) lfirst(lc);
-				int			paramno = nlp->paramno;
-				ParamExecData *prm;
-
-				prm = &(econtext->ecxt_param_exec_vals[paramno]);
-				/* Param value should be an OUTER_VAR var */
-				Assert(IsA(nlp->paramval, Var));
-				Assert(nlp->paramval->varno == OUTER_VAR);
-				Assert(nlp->paramval->varattno > 0);
-				prm->value = slot_getattr(outerTupleSlot,
-										  nlp->paramval->varattno,
-										  &(prm->isnull));
-				/* Flag parameter value as changed */
-				innerPlan->chgParam = bms_add_member(innerPlan->chgParam,
-													 paramno);
+				/* The inner side was probed already; replay the matches */
+				node->nl_MatchedOuter = node->nl_BatchEntry->matched;
+				node->nl_BatchMatch = list_head(node->nl_BatchEntry->matches);
+			}
+			else
+			{
+				/*
+				 * fetch the values of any outer Vars that must be passed to
+				 * the inner scan, and rescan the inner plan
+				 */
+				ExecNestLoopSetParams(node, outerTupleSlot);
+				ENL1_printf("rescanning inner plan");
+				ExecReScan(innerPlan);
 			}
-
-			/*
-			 * now rescan the inner plan
-			 */
-			ENL1_printf("rescanning inner plan");
-			ExecReScan(innerPlan);
 		}
 
 		/*
@@ -171,7 +202,25 @@ ExecNestLoop(NestLoopState *node)
 		 */
 		ENL1_printf("getting new inner tuple");
 
-		innerTupleSlot = ExecProcNode(innerPlan);
+		storedMatch = false;
+		if (node->nl_BatchEntry != NULL && node->nl_BatchEntry->probed)
+		{
+			if (node->nl_BatchMatch != NULL)
+			{
+				HeapTuple	match = (HeapTuple) lfirst(node->nl_BatchMatch);
+
+				innerTupleSlot = ExecStoreTuple(match,
+												node->nl_BatchInnerSlot,
+												InvalidBuffer,
+												false);
+				node->nl_BatchMatch = lnext(node->nl_BatchMatch);
+				storedMatch = true;
+			}
+			else
+				innerTupleSlot = NULL;
+		}
+		else
+			innerTupleSlot = ExecProcNode(innerPlan);
 		econtext->ecxt_innertuple = innerTupleSlot;
 
 		if (TupIsNull(innerTupleSlot))
@@ -231,11 +280,12 @@ ExecNestLoop(NestLoopState *node)
 		 * qualification.
 		 *
 		 * Only the joinquals determine MatchedOuter status, but all quals
-		 * must pass to actually return the tuple.
+		 * must pass to actually return the tuple.  Matches saved while
+		 * probing a batch have passed the joinquals already.
 		 */
 		ENL1_printf("testing qualification");
 
-		if (ExecQual(joinqual, econtext, false))
+		if (storedMatch || ExecQual(joinqual, econtext, false))
 		{
 			node->nl_MatchedOuter = true;
 
@@ -288,6 +338,272 @@ ExecNestLoop(NestLoopState *node)
 	}
 }
 
+/*
+ * Fetch the values of any outer Vars that must be passed to the inner scan,
+ * and store them in the appropriate PARAM_EXEC slots.
+ */
+static void
+ExecNestLoopSetParams(NestLoopState *node, TupleTableSlot *outerTupleSlot)
+{
+	NestLoop   *nl = (NestLoop *) node->js.ps.plan;
+	PlanState  *innerPlan = innerPlanState(node);
+	ExprContext *econtext = node->js.ps.ps_ExprContext;
+	ListCell   *lc;
+
+	foreach(lc, nl->nestParams)
+	{
+		NestLoopParam *nlp = (NestLoopParam *) lfirst(lc);
+		int			paramno = nlp->paramno;
+		ParamExecData *prm;
+
+		prm = &(econtext->ecxt_param_exec_vals[paramno]);
+		/* Param value should be an OUTER_VAR var */
+		Assert(IsA(nlp->paramval, Var));
+		Assert(nlp->paramval->varno == OUTER_VAR);
+		Assert(nlp->paramval->varattno > 0);
+		prm->value = slot_getattr(outerTupleSlot,
+								  nlp->paramval->varattno,
+								  &(prm->isnull));
+		/* Flag parameter value as changed */
+		innerPlan->chgParam = bms_add_member(innerPlan->chgParam,
+											 paramno);
+	}
+}
+
+/*
+ * Return the next outer row of the current batch, reading a new batch if
+ * the current one is used up, or NULL if the outer plan is exhausted.
+ */
+static TupleTableSlot *
+ExecNestLoopNextBatchOuter(NestLoopState *node)
+{
+	NestLoopBatchEntry *entry;
+
+	if (node->nl_BatchNext >= node->nl_BatchCount)
+	{
+		if (!ExecNestLoopFillBatch(node))
+		{
+			node->nl_BatchEntry = NULL;
+			return NULL;
+		}
+	}
+
+	entry = &node->nl_BatchEntries[node->nl_BatchNext++];
+	node->nl_BatchEntry = entry;
+	node->nl_BatchMatch = NULL;
+
+	return ExecStoreTuple(entry->outertuple, node->nl_BatchOuterSlot,
+						  InvalidBuffer, false);
+}
+
+/*
+ * Read the next batch of outer rows, and probe the inner side for them in
+ * the order of their sort keys.  Returns false if the outer plan is
+ * exhausted.
+ */
+static bool
+ExecNestLoopFillBatch(NestLoopState *node)
+{
+	NestLoop   *nl = (NestLoop *) node->js.ps.plan;
+	PlanState  *outerPlan = outerPlanState(node);
+	TupleDesc	outerDesc = node->nl_BatchOuterSlot->tts_tupleDescriptor;
+	int			numKeys = nl->numBatchKeys;
+	long		spaceAllowed = work_mem * 1024L;
+	Size		space = 0;
+	MemoryContext oldcontext;
+	int			i;
+
+	ExecNestLoopResetBatch(node);
+	if (node->nl_OuterDone)
+		return false;
+
+	while (node->nl_BatchCount < node->nl_BatchTarget &&
+		   space < spaceAllowed)
+	{
+		TupleTableSlot *outerTupleSlot = ExecProcNode(outerPlan);
+		NestLoopBatchEntry *entry;
+		int			k;
+
+		if (TupIsNull(outerTupleSlot))
+		{
+			node->nl_OuterDone = true;
+			break;
+		}
+
+		entry = &node->nl_BatchEntries[node->nl_BatchCount];
+		oldcontext = MemoryContextSwitchTo(node->nl_BatchContext);
+		entry->outertuple = ExecCopySlotTuple(outerTupleSlot);
+		MemoryContextSwitchTo(oldcontext);
+		space += HEAPTUPLESIZE + entry->outertuple->t_len;
+
+		for (k = 0; k < numKeys; k++)
+			entry->keys[k] = heap_getattr(entry->outertuple,
+										  node->nl_BatchKeyAttnos[k],
+										  outerDesc,
+										  &entry->nulls[k]);
+		entry->probed = false;
+		entry->matched = false;
+		entry->matches = NIL;
+
+		node->nl_BatchOrder[node->nl_BatchCount] = node->nl_BatchCount;
+		node->nl_BatchCount++;
+	}
+
+	if (node->nl_BatchCount == 0)
+		return false;
+
+	node->nl_NumBatches++;
+	if (node->nl_BatchCount > node->nl_MaxBatchCount)
+		node->nl_MaxBatchCount = node->nl_BatchCount;
+	if (node->nl_BatchTarget < NESTLOOP_MAX_BATCH_TUPLES)
+		node->nl_BatchTarget *= 2;
+
+	/* A lone row gains nothing from being probed ahead of time */
+	if (node->nl_BatchCount == 1)
+		return true;
+
+	qsort_arg(node->nl_BatchOrder, node->nl_BatchCount, sizeof(int),
+			  batch_entry_cmp, (void *) node);
+
+	for (i = 0; i < node->nl_BatchCount && space < spaceAllowed; i++)
+	{
+		CHECK_FOR_INTERRUPTS();
+		if (!ExecNestLoopProbeEntry(node,
+							 &node->nl_BatchEntries[node->nl_BatchOrder[i]],
+									&space, spaceAllowed))
+			break;
+	}
+
+	return true;
+}
+
+/*
+ * Scan the inner side for one outer row of the batch, saving the inner
+ * tuples that pass the joinquals.  *space is increased by the space they
+ * take.  If that goes over spaceAllowed before the scan is done, the saved
+ * tuples are discarded again, and we return false with the row left
+ * unprobed.
+ */
+static bool
+ExecNestLoopProbeEntry(NestLoopState *node, NestLoopBatchEntry *entry,
+					   Size *space, long spaceAllowed)
+{
+	PlanState  *innerPlan = innerPlanState(node);
+	ExprContext *econtext = node->js.ps.ps_ExprContext;
+	TupleTableSlot *outerTupleSlot;
+	MemoryContext oldcontext;
+	Size		entrySpace = 0;
+	double		nfiltered = 0;
+
+	outerTupleSlot = ExecStoreTuple(entry->outertuple,
+									node->nl_BatchOuterSlot,
+									InvalidBuffer,
+									false);
+	econtext->ecxt_outertuple = outerTupleSlot;
+	ExecNestLoopSetParams(node, outerTupleSlot);
+	ExecReScan(innerPlan);
+
+	for (;;)
+	{
+		TupleTableSlot *innerTupleSlot = ExecProcNode(innerPlan);
+
+		if (TupIsNull(innerTupleSlot))
+			break;
+		econtext->ecxt_innertuple = innerTupleSlot;
+
+		if (ExecQual(node->js.joinqual, econtext, false))
+		{
+			HeapTuple	tuple;
+
+			entry->matched = true;
+
+			/* In an antijoin, the row won't be returned anyway */
+			if (node->js.jointype == JOIN_ANTI)
+				break;
+
+			oldcontext = MemoryContextSwitchTo(node->nl_BatchContext);
+			tuple = ExecCopySlotTuple(innerTupleSlot);
+			entry->matches = lappend(entry->matches, tuple);
+			MemoryContextSwitchTo(oldcontext);
+			entrySpace += HEAPTUPLESIZE + tuple->t_len;
+
+			/*
+			 * Too many matches to keep?  Give up on this row; it will be
+			 * joined the ordinary way when its turn comes.
+			 */
+			if (*space + entrySpace >= spaceAllowed)
+			{
+				list_free_deep(entry->matches);
+				entry->matches = NIL;
+				entry->matched = false;
+				ResetExprContext(econtext);
+				return false;
+			}
+
+			/* In a semijoin, only the first match is needed */
+			if (node->js.jointype == JOIN_SEMI)
+				break;
+		}
+		else
+			nfiltered += 1;
+
+		ResetExprContext(econtext);
+	}
+
+	ResetExprContext(econtext);
+	InstrCountFiltered1(node, nfiltered);
+	*space += entrySpace;
+	entry->probed = true;
+	return true;
+}
+
+/*
+ * qsort_arg comparator for the indexes of batch entries, ordering them by
+ * their sort keys.  Equal keys are kept in their original order, so that
+ * probes for duplicate keys are done together.
+ */
+static int
+batch_entry_cmp(const void *a, const void *b, void *arg)
+{
+	NestLoopState *node = (NestLoopState *) arg;
+	int			ia = *(const int *) a;
+	int			ib = *(const int *) b;
+	NestLoopBatchEntry *ea = &node->nl_BatchEntries[ia];
+	NestLoopBatchEntry *eb = &node->nl_BatchEntries[ib];
+	int			numKeys = ((NestLoop *) node->js.ps.plan)->numBatchKeys;
+	int			k;
+
+	for (k = 0; k < numKeys; k++)
+	{
+		int			compare;
+
+		compare = ApplySortComparator(ea->keys[k], ea->nulls[k],
+									  eb->keys[k], eb->nulls[k],
+									  &node->nl_SortKeys[k]);
+		if (compare != 0)
+			return compare;
+	}
+
+	if (ia < ib)
+		return -1;
+	return (ia > ib) ? 1 : 0;
+}
+
+/*
+ * Forget the current batch.
+ */
+static void
+ExecNestLoopResetBatch(NestLoopState *node)
+{
+	ExecClearTuple(node->nl_BatchOuterSlot);
+	ExecClearTuple(node->nl_BatchInnerSlot);
+	MemoryContextReset(node->nl_BatchContext);
+	node->nl_BatchCount = 0;
+	node->nl_BatchNext = 0;
+	node->nl_BatchEntry = NULL;
+	node->nl_BatchMatch = NULL;
+}
+
 /* ----------------------------------------------------------------
  *		ExecInitNestLoop
  * ----------------------------------------------------------------
@@ -323,13 +639,11 @@ ExecInitNestLoop(NestLoop *node, EState *estate, int eflags)
 	nlstate->js.ps.targetlist = (List *)
 		ExecInitExpr((Expr *) node->join.plan.targetlist,
 					 (PlanState *) nlstate);
-	nlstate->js.ps.qual = (List *)
-		ExecInitExpr((Expr *) node->join.plan.qual,
-					 (PlanState *) nlstate);
+	nlstate->js.ps.qual =
+		ExecInitQual(node->join.plan.qual, (PlanState *) nlstate);
 	nlstate->js.jointype = node->join.jointype;
-	nlstate->js.joinqual = (List *)
-		ExecInitExpr((Expr *) node->join.joinqual,
-					 (PlanState *) nlstate);
+	nlstate->js.joinqual =
+		ExecInitQual(node->join.joinqual, (PlanState *) nlstate);
 
 	/*
 	 * initialize child nodes
@@ -381,6 +695,65 @@ ExecInitNestLoop(NestLoop *node, EState *estate, int eflags)
 	nlstate->nl_NeedNewOuter = true;
 	nlstate->nl_MatchedOuter = false;
 
+	/*
+	 * set up for reading the outer rows in batches, if the planner asked
+	 * for that
+	 */
+	if (node->numBatchKeys > 0)
+	{
+		int			numKeys = node->numBatchKeys;
+		int			i;
+
+		nlstate->nl_Batched = true;
+		nlstate->nl_BatchContext =
+			AllocSetContextCreate(CurrentMemoryContext,
+								  "NestLoop batch",
+								  ALLOCSET_DEFAULT_MINSIZE,
+								  ALLOCSET_DEFAULT_INITSIZE,
+								  ALLOCSET_DEFAULT_MAXSIZE);
+		nlstate->nl_BatchEntries = (NestLoopBatchEntry *)
+			palloc(NESTLOOP_MAX_BATCH_TUPLES * sizeof(NestLoopBatchEntry));
+		for (i = 0; i < NESTLOOP_MAX_BATCH_TUPLES; i++)
+		{
+			nlstate->nl_BatchEntries[i].keys = (Datum *)
+				palloc(numKeys * sizeof(Datum));
+			nlstate->nl_BatchEntries[i].nulls = (bool *)
+				palloc(numKeys * sizeof(bool));
+		}
+		nlstate->nl_BatchOrder = (int *)
+			palloc(NESTLOOP_MAX_BATCH_TUPLES * sizeof(int));
+
+		nlstate->nl_BatchKeyAttnos = (AttrNumber *)
+			palloc(numKeys * sizeof(AttrNumber));
+		nlstate->nl_SortKeys = (SortSupport)
+			palloc0(numKeys * sizeof(SortSupportData));
+		for (i = 0; i < numKeys; i++)
+		{
+			NestLoopParam *nlp;
+			SortSupport sortKey = nlstate->nl_SortKeys + i;
+
+			nlp = (NestLoopParam *) list_nth(node->nestParams,
+											 node->batchKeyParams[i]);
+			Assert(IsA(nlp->paramval, Var));
+			nlstate->nl_BatchKeyAttnos[i] = nlp->paramval->varattno;
+
+			sortKey->ssup_cxt = CurrentMemoryContext;
+			sortKey->ssup_collation = node->batchCollations[i];
+			sortKey->ssup_nulls_first = node->batchNullsFirst[i];
+			sortKey->ssup_attno = nlp->paramval->varattno;
+			PrepareSortSupportFromOrderingOp(node->batchSortOperators[i],
+											 sortKey);
+		}
+
+		nlstate->nl_BatchOuterSlot = ExecInitExtraTupleSlot(estate);
+		ExecSetSlotDescriptor(nlstate->nl_BatchOuterSlot,
+							  ExecGetResultType(outerPlanState(nlstate)));
+		nlstate->nl_BatchInnerSlot = ExecInitExtraTupleSlot(estate);
+		ExecSetSlotDescriptor(nlstate->nl_BatchInnerSlot,
+							  ExecGetResultType(innerPlanState(nlstate)));
+		nlstate->nl_BatchTarget = 1;
+	}
+
 	NL1_printf("ExecInitNestLoop: %s\n",
 			   "node initialized");
 
@@ -408,6 +781,12 @@ ExecEndNestLoop(NestLoopState *node)
 	 * clean out the tuple table
 	 */
 	ExecClearTuple(node->js.ps.ps_ResultTupleSlot);
+	if (node->nl_Batched)
+	{
+		ExecClearTuple(node->nl_BatchOuterSlot);
+		ExecClearTuple(node->nl_BatchInnerSlot);
+		MemoryContextDelete(node->nl_BatchContext);
+	}
 
 	/*
 	 * close down subplans
@@ -444,4 +823,11 @@ ExecReScanNestLoop(NestLoopState *node)
 	node->js.ps.ps_TupFromTlist = false;
 	node->nl_NeedNewOuter = true;
 	node->nl_MatchedOuter = false;
+
+	if (node->nl_Batched)
+	{
+		ExecNestLoopResetBatch(node);
+		node->nl_OuterDone = false;
+		node->nl_BatchTarget = 1;
+	}
 }
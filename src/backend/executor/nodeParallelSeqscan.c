@@ -0,0 +1,757 @@
+/*-------------------------------------------------------------------------
+ *
+ * nodeParallelSeqscan.c
+ *	  Support routines for parallel sequential scans of relations.
+ *
+ * A parallel sequential scan divides the blocks of a relation among the
+ * master backend and a set of background workers.  Each worker scans the
+ * blocks it is handed, evaluates the node's qual, and sends the qualifying
+ * tuples back to the master through a shm_mq; the master scans blocks of its
+ * own in between reading from the queues, and does any projection needed.
+ *
+ * When the scan is the inner side of a hash join, the Hash node above us
+ * can ask the workers to store the tuples it wants straight into a shared
+ * hash table instead; only the tuples it can't use that way are sent back.
+ *
+ * Workers see the master's snapshot but none of its other state, so the
+ * planner only generates this node for quals that are safe to evaluate in
+ * a worker, and we fall back to scanning the whole relation in the master
+ * if the transaction has done anything workers couldn't see.
+ *
+ * Portions Copyright (c) 1996-2014, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, Regents of the University of California
+ *
+ *
+ * IDENTIFICATION
+ *	  src/backend/executor/nodeParallelSeqscan.c
+ *
+ *-------------------------------------------------------------------------
+ */
+/*
+ * INTERFACE ROUTINES
+ *		ExecParallelSeqScan			scans a relation using parallel workers.
+ *		ExecInitParallelSeqScan		creates and initializes a parallel seqscan.
+ *		ExecEndParallelSeqScan		releases any storage allocated.
+ *		ExecReScanParallelSeqScan	rescans the relation
+ *		ExecParallelSeqScanCanUseWorkers	will the scan use workers?
+ *		ParallelSeqScanWorkerMain	scans a relation in a parallel worker
+ */
+#include "postgres.h"
+
+#include "access/parallel.h"
+#include "access/relscan.h"
+#include "access/xact.h"
+#include "executor/execdebug.h"
+#include "executor/nodeHash.h"
+#include "executor/nodeParallelSeqscan.h"
+#include "miscadmin.h"
+#include "optimizer/planmain.h"
+#include "storage/proc.h"
+#include "storage/procsignal.h"
+#include "storage/shm_mq.h"
+#include "storage/spin.h"
+#include "utils/memutils.h"
+#include "utils/rel.h"
+#include "utils/snapmgr.h"
+#include "utils/tqual.h"
+
+/* Keys for the parallel scan's shared state. */
+#define PARALLEL_SEQSCAN_KEY_SCAN		UINT64CONST(1)
+#define PARALLEL_SEQSCAN_KEY_QUAL		UINT64CONST(2)
+#define PARALLEL_SEQSCAN_KEY_QUEUES		UINT64CONST(3)
+#define PARALLEL_SEQSCAN_KEY_HASH		UINT64CONST(4)
+
+/* Size of each worker's tuple queue. */
+#define PARALLEL_SEQSCAN_QUEUE_SIZE		65536
+
+/*
+ * Each message on a tuple queue is the tuple's TID followed by the tuple
+ * itself, starting at a MAXALIGN'd offset so that it can be used in place.
+ */
+#define PARALLEL_SEQSCAN_TUPLE_OFFSET	MAXALIGN(sizeof(ItemPointerData))
+
+/* State shared by all participants in the scan. */
+typedef struct ParallelSeqScanShared
+{
+	ParallelHeapScanDescData heapscan;	/* shared block allocation */
+	slock_t		mutex;			/* protects nfiltered */
+	double		nfiltered;		/* tuples removed by workers' qual */
+} ParallelSeqScanShared;
+
+static void ParallelSeqScanBegin(ParallelSeqScanState *node);
+static void ParallelSeqScanShutdown(ParallelSeqScanState *node);
+static TupleTableSlot *ParallelSeqNext(ParallelSeqScanState *node,
+				bool *qual_checked);
+static bool ParallelSeqReadWorkerTuple(ParallelSeqScanState *node,
+						   TupleTableSlot *slot);
+
+/* ----------------------------------------------------------------
+ *						Scan Support
+ * ----------------------------------------------------------------
+ */
+
+/* ----------------------------------------------------------------
+ *		ParallelSeqScanBegin
+ *
+ *		Set up the shared scan state and launch the workers, or start
+ *		an ordinary scan if workers can't be used.
+ * ----------------------------------------------------------------
+ */
+static void
+ParallelSeqScanBegin(ParallelSeqScanState *node)
+{
+	ParallelSeqScan *plan = (ParallelSeqScan *) node->ss.ps.plan;
+	EState	   *estate = node->ss.ps.state;
+	Relation	rel = node->ss.ss_currentRelation;
+	int			nworkers = plan->num_workers;
+	ParallelContext *pcxt;
+	ParallelSeqScanShared *shared;
+	char	   *qualstr;
+	char	   *qualspace;
+	char	   *mqspace;
+	int			nkeys;
+	int			i;
+
+	node->pss_initialized = true;
+	node->pss_local_done = false;
+
+	if (!ExecParallelSeqScanCanUseWorkers(node))
+	{
+		node->ss.ss_currentScanDesc = heap_beginscan(rel,
+													 estate->es_snapshot,
+													 0,
+													 NULL);
+		return;
+	}
+
+	qualstr = nodeToString(plan->scan.plan.qual);
+
+	/* Size and create the dynamic shared memory segment. */
+	pcxt = CreateParallelContext(ParallelSeqScanWorkerMain, nworkers);
+	shm_toc_estimate_chunk(&pcxt->estimator, sizeof(ParallelSeqScanShared));
+	shm_toc_estimate_chunk(&pcxt->estimator, strlen(qualstr) + 1);
+	shm_toc_estimate_chunk(&pcxt->estimator,
+						   mul_size(PARALLEL_SEQSCAN_QUEUE_SIZE, nworkers));
+	nkeys = 3;
+	if (node->pss_hashseg != NULL)
+	{
+		shm_toc_estimate_chunk(&pcxt->estimator, sizeof(dsm_handle));
+		nkeys++;
+	}
+	shm_toc_estimate_keys(&pcxt->estimator, nkeys);
+
+	/* The workers must see exactly what our own part of the scan sees. */
+	PushActiveSnapshot(estate->es_snapshot);
+	InitializeParallelDSM(pcxt);
+	PopActiveSnapshot();
+
+	shared = shm_toc_allocate(pcxt->toc, sizeof(ParallelSeqScanShared));
+	heap_parallelscan_initialize(&shared->heapscan, rel);
+	SpinLockInit(&shared->mutex);
+	shared->nfiltered = 0;
+	shm_toc_insert(pcxt->toc, PARALLEL_SEQSCAN_KEY_SCAN, shared);
+
+	qualspace = shm_toc_allocate(pcxt->toc, strlen(qualstr) + 1);
+	strcpy(qualspace, qualstr);
+	shm_toc_insert(pcxt->toc, PARALLEL_SEQSCAN_KEY_QUAL, qualspace);
+
+	mqspace = shm_toc_allocate(pcxt->toc,
+							   mul_size(PARALLEL_SEQSCAN_QUEUE_SIZE, nworkers));
+	for (i = 0; i < nworkers; ++i)
+	{
+		shm_mq	   *mq;
+
+		mq = shm_mq_create(mqspace + i * PARALLEL_SEQSCAN_QUEUE_SIZE,
+						   PARALLEL_SEQSCAN_QUEUE_SIZE);
+		shm_mq_set_receiver(mq, MyProc);
+	}
+	shm_toc_insert(pcxt->toc, PARALLEL_SEQSCAN_KEY_QUEUES, mqspace);
+
+	if (node->pss_hashseg != NULL)
+	{
+		dsm_handle *hashhandle;
+
+		hashhandle = shm_toc_allocate(pcxt->toc, sizeof(dsm_handle));
+		*hashhandle = dsm_segment_handle(node->pss_hashseg);
+		shm_toc_insert(pcxt->toc, PARALLEL_SEQSCAN_KEY_HASH, hashhandle);
+	}
+
+	LaunchParallelWorkers(pcxt);
+
+	/*
+	 * Attach to the queues of the workers we actually got.  Passing the
+	 * worker's handle lets us notice if it fails to start.
+	 */
+	node->pss_pcxt = pcxt;
+	node->pss_nworkers_launched = pcxt->nworkers_launched;
+	node->pss_nreaders = pcxt->nworkers_launched;
+	node->pss_nreaders_active = pcxt->nworkers_launched;
+	node->pss_nextreader = 0;
+	node->pss_reader = palloc0(sizeof(shm_mq_handle *) * nworkers);
+	for (i = 0; i < pcxt->nworkers_launched; ++i)
+		node->pss_reader[i] =
+			shm_mq_attach((shm_mq *) (mqspace + i * PARALLEL_SEQSCAN_QUEUE_SIZE),
+						  pcxt->seg, pcxt->worker[i].bgwhandle);
+
+	/* And join the scan ourselves. */
+	node->ss.ss_currentScanDesc = heap_beginscan_parallel(rel,
+														  estate->es_snapshot,
+														  &shared->heapscan);
+}
+
+/* ----------------------------------------------------------------
+ *		ExecParallelSeqScanCanUseWorkers
+ *
+ *		Will starting the scan launch workers?  This is for the benefit
+ *		of a parent Hash node, which must decide whether to set up a
+ *		shared hash table before it fetches the first tuple.
+ * ----------------------------------------------------------------
+ */
+bool
+ExecParallelSeqScanCanUseWorkers(ParallelSeqScanState *node)
+{
+	ParallelSeqScan *plan = (ParallelSeqScan *) node->ss.ps.plan;
+	EState	   *estate = node->ss.ps.state;
+
+	/*
+	 * Workers can't take part in serializable conflict detection, and they
+	 * only know how to use an MVCC snapshot.  We also keep to a serial scan
+	 * once the transaction has written anything, since the query might be
+	 * reading data it is still modifying through a volatile function or
+	 * cursor.  In any of those cases, just scan serially.
+	 */
+	if (plan->num_workers <= 0 ||
+		IsParallelWorker() ||
+		TransactionIdIsValid(GetTopTransactionIdIfAny()) ||
+		IsolationIsSerializable() ||
+		!IsMVCCSnapshot(estate->es_snapshot))
+		return false;
+
+	return true;
+}
+
+/* ----------------------------------------------------------------
+ *		ParallelSeqScanShutdown
+ *
+ *		Stop the workers, if any, and end our own scan.
+ * ----------------------------------------------------------------
+ */
+static void
+ParallelSeqScanShutdown(ParallelSeqScanState *node)
+{
+	ParallelContext *pcxt = node->pss_pcxt;
+
+	if (pcxt != NULL)
+	{
+		/*
+		 * If we're stopping early, stop the workers too: hand out no more
+		 * blocks, and detach from their queues so that any worker waiting
+		 * for space to send a tuple gives up.  Letting them exit of their
+		 * own accord is cheaper and quieter than terminating them.
+		 */
+		if (node->pss_nreaders_active > 0)
+		{
+			ParallelSeqScanShared *shared;
+			char	   *mqspace;
+			int			i;
+
+			shared = shm_toc_lookup(pcxt->toc, PARALLEL_SEQSCAN_KEY_SCAN);
+			heap_parallelscan_stop(&shared->heapscan);
+
+			mqspace = shm_toc_lookup(pcxt->toc, PARALLEL_SEQSCAN_KEY_QUEUES);
+			for (i = 0; i < node->pss_nreaders; ++i)
+			{
+				if (node->pss_reader[i] != NULL)
+					shm_mq_detach((shm_mq *) (mqspace +
+										i * PARALLEL_SEQSCAN_QUEUE_SIZE));
+			}
+			WaitForParallelWorkersToExit(pcxt);
+		}
+
+		DestroyParallelContext(pcxt);
+		node->pss_pcxt = NULL;
+	}
+
+	if (node->pss_reader != NULL)
+	{
+		pfree(node->pss_reader);
+		node->pss_reader = NULL;
+	}
+	node->pss_nreaders = 0;
+	node->pss_nreaders_active = 0;
+
+	if (node->ss.ss_currentScanDesc != NULL)
+	{
+		heap_endscan(node->ss.ss_currentScanDesc);
+		node->ss.ss_currentScanDesc = NULL;
+	}
+
+	node->pss_initialized = false;
+}
+
+/* ----------------------------------------------------------------
+ *		ParallelSeqReadWorkerTuple
+ *
+ *		Try to read a tuple from one of the workers without waiting.
+ *		Returns true and stores the tuple in the slot if one was ready.
+ * ----------------------------------------------------------------
+ */
+static bool
+ParallelSeqReadWorkerTuple(ParallelSeqScanState *node, TupleTableSlot *slot)
+{
+	int			nvisited = 0;
+
+	while (node->pss_nreaders_active > 0 && nvisited < node->pss_nreaders)
+	{
+		int			i = node->pss_nextreader;
+		shm_mq_result result;
+		uint64		nbytes;
+		void	   *data;
+		HeapTuple	tuple;
+
+		node->pss_nextreader = (i + 1) % node->pss_nreaders;
+		nvisited++;
+
+		if (node->pss_reader[i] == NULL)
+			continue;
+
+		result = shm_mq_receive(node->pss_reader[i], &nbytes, &data, true);
+		if (result == SHM_MQ_WOULD_BLOCK)
+			continue;
+
+		if (result == SHM_MQ_DETACHED)
+		{
+			ParallelSeqScanShared *shared;
+
+			/* This worker is done; find out whether it succeeded. */
+			node->pss_reader[i] = NULL;
+			node->pss_nreaders_active--;
+			CheckParallelWorkerExit(node->pss_pcxt, i);
+
+			/* Once all workers are done, account for the rows they filtered. */
+			if (node->pss_nreaders_active == 0)
+			{
+				shared = shm_toc_lookup(node->pss_pcxt->toc,
+										PARALLEL_SEQSCAN_KEY_SCAN);
+				InstrCountFiltered1(node, shared->nfiltered);
+			}
+			continue;
+		}
+
+		Assert(nbytes > PARALLEL_SEQSCAN_TUPLE_OFFSET);
+
+		/*
+		 * The tuple stays valid in the queue until we next read from it,
+		 * which won't happen before we are called again.
+		 */
+		tuple = &node->pss_wtuple;
+		memcpy(&tuple->t_self, data, sizeof(ItemPointerData));
+		tuple->t_len = nbytes - PARALLEL_SEQSCAN_TUPLE_OFFSET;
+		tuple->t_tableOid = RelationGetRelid(node->ss.ss_currentRelation);
+		tuple->t_data = (HeapTupleHeader)
+			((char *) data + PARALLEL_SEQSCAN_TUPLE_OFFSET);
+		ExecStoreTuple(tuple, slot, InvalidBuffer, false);
+		return true;
+	}
+
+	return false;
+}
+
+/* ----------------------------------------------------------------
+ *		ParallelSeqNext
+ *
+ *		This is a workhorse for ExecParallelSeqScan.  *qual_checked
+ *		is set to true if the tuple came from a worker.
+ * ----------------------------------------------------------------
+ */
+static TupleTableSlot *
+ParallelSeqNext(ParallelSeqScanState *node, bool *qual_checked)
+{
+	TupleTableSlot *slot = node->ss.ss_ScanTupleSlot;
+	HeapScanDesc scandesc = node->ss.ss_currentScanDesc;
+
+	for (;;)
+	{
+		volatile bool got_tuple;
+		bool		save_set_latch_on_sigusr1;
+
+		/*
+		 * Prefer tuples the workers have already produced, so that they
+		 * don't block on a full queue while we scan.
+		 */
+		if (ParallelSeqReadWorkerTuple(node, slot))
+		{
+			*qual_checked = true;
+			return slot;
+		}
+
+		/* Otherwise, do some of the scan ourselves. */
+		if (!node->pss_local_done)
+		{
+			HeapTuple	tuple;
+
+			tuple = heap_getnext(scandesc, ForwardScanDirection);
+			if (tuple)
+			{
+				ExecStoreTuple(tuple, slot, scandesc->rs_cbuf, false);
+				*qual_checked = false;
+				return slot;
+			}
+			node->pss_local_done = true;
+			continue;
+		}
+
+		/* If every worker is done, so are we. */
+		if (node->pss_nreaders_active == 0)
+			return ExecClearTuple(slot);
+
+		/*
+		 * Nothing to do but wait for the workers.  A worker that fails to
+		 * start never touches its queue, so the only notice we get is the
+		 * postmaster's SIGUSR1; make sure that sets our latch, and check
+		 * the queues once more before sleeping.
+		 */
+		got_tuple = false;
+		save_set_latch_on_sigusr1 = set_latch_on_sigusr1;
+		set_latch_on_sigusr1 = true;
+		PG_TRY();
+		{
+			got_tuple = ParallelSeqReadWorkerTuple(node, slot);
+			if (!got_tuple && node->pss_nreaders_active > 0)
+			{
+				WaitLatch(&MyProc->procLatch, WL_LATCH_SET, 0);
+				ResetLatch(&MyProc->procLatch);
+			}
+		}
+		PG_CATCH();
+		{
+			set_latch_on_sigusr1 = save_set_latch_on_sigusr1;
+			PG_RE_THROW();
+		}
+		PG_END_TRY();
+		set_latch_on_sigusr1 = save_set_latch_on_sigusr1;
+
+		if (got_tuple)
+		{
+			*qual_checked = true;
+			return slot;
+		}
+
+		CHECK_FOR_INTERRUPTS();
+	}
+}
+
+/* ----------------------------------------------------------------
+ *		ExecParallelSeqScan(node)
+ *
+ *		Returns the next qualifying tuple of the relation.
+ *
+ *		This is ExecScan(), except that tuples which a worker has
+ *		already checked are not checked again.  EvalPlanQual is not
+ *		supported, since the planner never uses this node for a query
+ *		that could need it.
+ * ----------------------------------------------------------------
+ */
+TupleTableSlot *
+ExecParallelSeqScan(ParallelSeqScanState *node)
+{
+	ExprContext *econtext = node->ss.ps.ps_ExprContext;
+	List	   *qual = node->ss.ps.qual;
+	ProjectionInfo *projInfo = node->ss.ps.ps_ProjInfo;
+	ExprDoneCond isDone;
+	TupleTableSlot *resultSlot;
+
+	/* Start the scan on the first call, so EXPLAIN alone launches nothing. */
+	if (!node->pss_initialized)
+		ParallelSeqScanBegin(node);
+
+	/*
+	 * Check to see if we're still projecting out tuples from a previous scan
+	 * tuple (because there is a function-returning-set in the projection
+	 * expressions).  If so, try to project another one.
+	 */
+	if (node->ss.ps.ps_TupFromTlist)
+	{
+		Assert(projInfo);		/* can't get here if not projecting */
+		resultSlot = ExecProject(projInfo, &isDone);
+		if (isDone == ExprMultipleResult)
+			return resultSlot;
+		/* Done with that source tuple... */
+		node->ss.ps.ps_TupFromTlist = false;
+	}
+
+	/*
+	 * Reset per-tuple memory context to free any expression evaluation
+	 * storage allocated in the previous tuple cycle.
+	 */
+	ResetExprContext(econtext);
+
+	for (;;)
+	{
+		TupleTableSlot *slot;
+		bool		qual_checked;
+
+		CHECK_FOR_INTERRUPTS();
+
+		slot = ParallelSeqNext(node, &qual_checked);
+
+		/* if the slot returned by the accessMtd contains NULL, we're done */
+		if (TupIsNull(slot))
+		{
+			if (projInfo)
+				return ExecClearTuple(projInfo->pi_slot);
+			else
+				return slot;
+		}
+
+		/* place the current tuple into the expr context */
+		econtext->ecxt_scantuple = slot;
+
+		if (qual_checked || !qual || ExecQual(qual, econtext, false))
+		{
+			/* Found a satisfactory scan tuple. */
+			if (!projInfo)
+				return slot;
+
+			resultSlot = ExecProject(projInfo, &isDone);
+			if (isDone != ExprEndResult)
+			{
+				node->ss.ps.ps_TupFromTlist = (isDone == ExprMultipleResult);
+				return resultSlot;
+			}
+		}
+		else
+			InstrCountFiltered1(node, 1);
+
+		/* Tuple fails qual, so free per-tuple memory and try again. */
+		ResetExprContext(econtext);
+	}
+}
+
+/* ----------------------------------------------------------------
+ *		ExecInitParallelSeqScan
+ * ----------------------------------------------------------------
+ */
+ParallelSeqScanState *
+ExecInitParallelSeqScan(ParallelSeqScan *node, EState *estate, int eflags)
+{
+	ParallelSeqScanState *scanstate;
+
+	Assert(outerPlan(node) == NULL);
+	Assert(innerPlan(node) == NULL);
+
+	/*
+	 * create state structure
+	 */
+	scanstate = makeNode(ParallelSeqScanState);
+	scanstate->ss.ps.plan = (Plan *) node;
+	scanstate->ss.ps.state = estate;
+	scanstate->pss_hashseg = NULL;
+
+	/*
+	 * Miscellaneous initialization
+	 *
+	 * create expression context for node
+	 */
+	ExecAssignExprContext(estate, &scanstate->ss.ps);
+
+	/*
+	 * initialize child expressions
+	 */
+	scanstate->ss.ps.targetlist = (List *)
+		ExecInitExpr((Expr *) node->scan.plan.targetlist,
+					 (PlanState *) scanstate);
+	scanstate->ss.ps.qual =
+		ExecInitQual(node->scan.plan.qual, (PlanState *) scanstate);
+
+	/*
+	 * tuple table initialization
+	 */
+	ExecInitResultTupleSlot(estate, &scanstate->ss.ps);
+	ExecInitScanTupleSlot(estate, &scanstate->ss);
+
+	/*
+	 * open the scan relation; the scan itself starts on the first call
+	 */
+	scanstate->ss.ss_currentRelation =
+		ExecOpenScanRelation(estate, node->scan.scanrelid, eflags);
+	scanstate->ss.ss_currentScanDesc = NULL;
+	ExecAssignScanType(&scanstate->ss,
+					   RelationGetDescr(scanstate->ss.ss_currentRelation));
+
+	scanstate->ss.ps.ps_TupFromTlist = false;
+
+	/*
+	 * Initialize result tuple type and projection info.
+	 */
+	ExecAssignResultTypeFromTL(&scanstate->ss.ps);
+	ExecAssignScanProjectionInfo(&scanstate->ss);
+
+	return scanstate;
+}
+
+/* ----------------------------------------------------------------
+ *		ExecEndParallelSeqScan
+ *
+ *		frees any storage allocated through C routines.
+ * ----------------------------------------------------------------
+ */
+void
+ExecEndParallelSeqScan(ParallelSeqScanState *node)
+{
+	/*
+	 * clean out the tuple table first, since the scan slot may point into
+	 * a worker's queue or hold a buffer pin from our own scan
+	 */
+	ExecClearTuple(node->ss.ps.ps_ResultTupleSlot);
+	ExecClearTuple(node->ss.ss_ScanTupleSlot);
+
+	/*
+	 * stop the workers and close the heap scan
+	 */
+	ParallelSeqScanShutdown(node);
+
+	/*
+	 * Free the exprcontext
+	 */
+	ExecFreeExprContext(&node->ss.ps);
+
+	/*
+	 * close the heap relation.
+	 */
+	ExecCloseScanRelation(node->ss.ss_currentRelation);
+}
+
+/* ----------------------------------------------------------------
+ *						Join Support
+ * ----------------------------------------------------------------
+ */
+
+/* ----------------------------------------------------------------
+ *		ExecReScanParallelSeqScan
+ *
+ *		Rescans the relation.  The workers can't rewind their part of
+ *		the scan, so we shut everything down and start again.
+ * ----------------------------------------------------------------
+ */
+void
+ExecReScanParallelSeqScan(ParallelSeqScanState *node)
+{
+	ExecClearTuple(node->ss.ss_ScanTupleSlot);
+	ParallelSeqScanShutdown(node);
+
+	ExecScanReScan((ScanState *) node);
+}
+
+/* ----------------------------------------------------------------
+ *		ParallelSeqScanWorkerMain
+ *
+ *		Entrypoint for parallel workers: scan blocks until none are left,
+ *		sending each tuple that passes the qual back to the master, unless
+ *		the master's shared hash table takes it.
+ * ----------------------------------------------------------------
+ */
+void
+ParallelSeqScanWorkerMain(dsm_segment *seg, shm_toc *toc)
+{
+	ParallelSeqScanShared *shared;
+	volatile ParallelSeqScanShared *vshared;
+	char	   *qualstr;
+	char	   *mqspace;
+	dsm_handle *hashhandle;
+	struct HashSharedWorkerState *hashstate = NULL;
+	shm_mq	   *mq;
+	shm_mq_handle *mqh;
+	Relation	rel;
+	EState	   *estate;
+	ExprContext *econtext;
+	MemoryContext oldcontext;
+	List	   *qual;
+	TupleTableSlot *slot;
+	HeapScanDesc scan;
+	HeapTuple	tuple;
+	char	   *buf = NULL;
+	Size		bufsize = 0;
+	double		nfiltered = 0;
+
+	shared = shm_toc_lookup(toc, PARALLEL_SEQSCAN_KEY_SCAN);
+	qualstr = shm_toc_lookup(toc, PARALLEL_SEQSCAN_KEY_QUAL);
+	mqspace = shm_toc_lookup(toc, PARALLEL_SEQSCAN_KEY_QUEUES);
+	Assert(shared != NULL && qualstr != NULL && mqspace != NULL);
+	hashhandle = shm_toc_lookup(toc, PARALLEL_SEQSCAN_KEY_HASH);
+
+	/* Attach to our queue. */
+	mq = (shm_mq *) (mqspace +
+					 ParallelWorkerNumber * PARALLEL_SEQSCAN_QUEUE_SIZE);
+	shm_mq_set_sender(mq, MyProc);
+	mqh = shm_mq_attach(mq, seg, NULL);
+
+	/*
+	 * The master holds a lock on the relation until after we exit, so we
+	 * needn't take one; trying to could deadlock behind a waiting locker.
+	 */
+	rel = heap_open(shared->heapscan.phs_relid, NoLock);
+
+	/* Rebuild the qual. */
+	estate = CreateExecutorState();
+	oldcontext = MemoryContextSwitchTo(estate->es_query_cxt);
+	qual = (List *) stringToNode(qualstr);
+	fix_opfuncids((Node *) qual);
+	qual = (List *) ExecInitExpr((Expr *) qual, NULL);
+	MemoryContextSwitchTo(oldcontext);
+	econtext = GetPerTupleExprContext(estate);
+	slot = MakeSingleTupleTableSlot(RelationGetDescr(rel));
+
+	if (hashhandle != NULL)
+		hashstate = ExecHashSharedWorkerBegin(*hashhandle);
+
+	scan = heap_beginscan_parallel(rel, GetActiveSnapshot(), &shared->heapscan);
+	while ((tuple = heap_getnext(scan, ForwardScanDirection)) != NULL)
+	{
+		Size		len;
+
+		CHECK_FOR_INTERRUPTS();
+
+		ResetExprContext(econtext);
+		ExecStoreTuple(tuple, slot, scan->rs_cbuf, false);
+		econtext->ecxt_scantuple = slot;
+		if (qual != NIL && !ExecQual(qual, econtext, false))
+		{
+			nfiltered += 1;
+			continue;
+		}
+
+		if (hashstate != NULL && ExecHashSharedWorkerInsert(hashstate, slot))
+			continue;
+
+		len = PARALLEL_SEQSCAN_TUPLE_OFFSET + tuple->t_len;
+		if (len > bufsize)
+		{
+			bufsize = Max(len, 2 * bufsize);
+			if (buf == NULL)
+				buf = palloc(bufsize);
+			else
+				buf = repalloc(buf, bufsize);
+		}
+		memcpy(buf, &tuple->t_self, sizeof(ItemPointerData));
+		memcpy(buf + PARALLEL_SEQSCAN_TUPLE_OFFSET, tuple->t_data,
+			   tuple->t_len);
+
+		/* If the master has gone away, it wants no more tuples. */
+		if (shm_mq_send(mqh, len, buf, false) == SHM_MQ_DETACHED)
+			break;
+	}
+
+	if (hashstate != NULL)
+		ExecHashSharedWorkerEnd(hashstate);
+	ExecDropSingleTupleTableSlot(slot);
+	heap_endscan(scan);
+	FreeExecutorState(estate);
+	heap_close(rel, NoLock);
+
+	/* use volatile pointer to prevent code rearrangement */
+	vshared = shared;
+	SpinLockAcquire(&vshared->mutex);
+	vshared->nfiltered += nfiltered;
+	SpinLockRelease(&vshared->mutex);
+}
@@ -0,0 +1,718 @@
+/*-------------------------------------------------------------------------
+ *
+ * nodeResultCache.c
+ *	  Routines to cache the results of a parameterized subplan
+ *
+ * A result cache sits on the inner side of a nested loop join whose inner
+ * plan is parameterized by values from the outer side.  When the outer side
+ * supplies the same parameter values many times over, it is wasteful to run
+ * the inner plan again for each of them; instead, we remember the tuples the
+ * inner plan returned for each set of parameter values, and return them
+ * straight from memory when the same values come around again.
+ *
+ * The cache is a hash table keyed by the parameter values, plus a list of
+ * the entries in least-recently-used order.  Parameter values are compared
+ * bytewise rather than with their type's equality operator: the subplan can
+ * do anything with them, and values that operator considers equal, such as
+ * numeric 1.0 and 1.00, needn't give the same results.  (Equal values with
+ * different representations just get separate entries.)  Its size is limited to
+ * work_mem: when adding a tuple would exceed that, we evict the least
+ * recently used entries to make room.  If the results for a single set of
+ * parameter values don't fit even in an otherwise empty cache, we give up
+ * caching them and just pass the subplan's tuples through for that scan.
+ *
+ * An entry is only used for lookups once the subplan has been read to the
+ * end for it; an entry whose scan was cut short is discarded when found.
+ *
+ * Portions Copyright (c) 1996-2014, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, Regents of the University of California
+ *
+ *
+ * IDENTIFICATION
+ *	  src/backend/executor/nodeResultCache.c
+ *
+ *-------------------------------------------------------------------------
+ */
+
+#include "postgres.h"
+
+#include "access/hash.h"
+#include "executor/executor.h"
+#include "executor/nodeResultCache.h"
+#include "lib/ilist.h"
+#include "miscadmin.h"
+#include "nodes/nodeFuncs.h"
+#include "utils/datum.h"
+#include "utils/hsearch.h"
+#include "utils/lsyscache.h"
+#include "utils/memutils.h"
+
+
+/* States of the ExecResultCache state machine */
+#define RC_CACHE_LOOKUP				1	/* look up the next parameters */
+#define RC_CACHE_FETCH_NEXT_TUPLE	2	/* return tuples from a cache hit */
+#define RC_FILLING_CACHE			3	/* run subplan, caching its output */
+#define RC_CACHE_BYPASS				4	/* run subplan without caching */
+#define RC_END_OF_SCAN				5	/* this scan is done */
+
+/* A cached subplan result tuple */
+typedef struct ResultCacheTuple
+{
+	MinimalTuple mintuple;
+	struct ResultCacheTuple *next;
+} ResultCacheTuple;
+
+/* The cached results for one set of parameter values */
+typedef struct ResultCacheEntry
+{
+	dlist_node	lru_node;		/* position in the LRU list */
+	struct ResultCacheEntry *hashnext;	/* next entry with same hash value */
+	uint32		hashvalue;
+	Datum	   *keyvalues;		/* the parameter values */
+	bool	   *keynulls;
+	ResultCacheTuple *tuplehead;	/* the cached tuples, in order */
+	ResultCacheTuple *tupletail;
+	Size		mem;			/* memory used by the entry and its tuples */
+	bool		complete;		/* have we read the subplan to the end? */
+} ResultCacheEntry;
+
+/* Hash table entry: the chain of cache entries with a given hash value */
+typedef struct ResultCacheBucket
+{
+	uint32		hashvalue;		/* hash key, must be first */
+	ResultCacheEntry *entries;
+} ResultCacheBucket;
+
+typedef struct ResultCacheData
+{
+	HTAB	   *hashtable;
+	dlist_head	lru;			/* entries, least recently used first */
+	MemoryContext tableContext; /* holds the entries and tuples */
+	Size		mem_used;		/* memory used by all the entries */
+	Size		mem_limit;		/* how much we are allowed to use */
+} ResultCacheData;
+
+static void rc_create_hashtable(ResultCacheState *node);
+static uint32 rc_hash_keys(ResultCacheState *node, Datum *values,
+			 bool *isnull);
+static ResultCacheEntry *rc_lookup(ResultCacheState *node, uint32 hashvalue,
+		  Datum *values, bool *isnull);
+static ResultCacheEntry *rc_create_entry(ResultCacheState *node,
+				uint32 hashvalue, Datum *values, bool *isnull);
+static void rc_remove_entry(ResultCacheState *node, ResultCacheEntry *entry);
+static bool rc_cache_tuple(ResultCacheState *node, TupleTableSlot *slot);
+static bool rc_reduce_memory(ResultCacheState *node);
+static void rc_purge(ResultCacheState *node);
+
+
+/* ----------------------------------------------------------------
+ *		ExecResultCache
+ *
+ *		Returns the next tuple of the subplan's result for the current
+ *		parameter values, from the cache if we have it there.
+ * ----------------------------------------------------------------
+ */
+TupleTableSlot *
+ExecResultCache(ResultCacheState *node)
+{
+	PlanState  *outerNode = outerPlanState(node);
+	TupleTableSlot *slot;
+
+	switch (node->rc_status)
+	{
+		case RC_CACHE_LOOKUP:
+			{
+				ExprContext *econtext = node->ss.ps.ps_ExprContext;
+				Datum	   *values;
+				bool	   *isnull;
+				uint32		hashvalue;
+				ResultCacheEntry *entry;
+
+				/*
+				 * Compute the current parameter values, and look for them in
+				 * the cache.
+				 */
+				ResetExprContext(econtext);
+				values = (Datum *)
+					MemoryContextAlloc(econtext->ecxt_per_tuple_memory,
+									   node->nkeys * sizeof(Datum));
+				isnull = (bool *)
+					MemoryContextAlloc(econtext->ecxt_per_tuple_memory,
+									   node->nkeys * sizeof(bool));
+				hashvalue = rc_hash_keys(node, values, isnull);
+				entry = rc_lookup(node, hashvalue, values, isnull);
+
+				if (entry != NULL && entry->complete)
+				{
+					/* Cache hit; mark the entry as the most recently used */
+					node->hits++;
+					dlist_delete(&entry->lru_node);
+					dlist_push_tail(&node->cache->lru, &entry->lru_node);
+					node->entry = entry;
+					node->nexttuple = entry->tuplehead;
+					node->rc_status = RC_CACHE_FETCH_NEXT_TUPLE;
+					return ExecResultCache(node);
+				}
+
+				/*
+				 * Cache miss.  An entry that was never completed is of no use
+				 * to us, so get rid of it and start over.
+				 */
+				if (entry != NULL)
+					rc_remove_entry(node, entry);
+				node->misses++;
+				node->entry = rc_create_entry(node, hashvalue, values, isnull);
+				node->nexttuple = NULL;
+				node->rc_status = RC_FILLING_CACHE;
+
+				/*
+				 * If chgParam of subnode is not null then the plan will be
+				 * re-scanned by the first ExecProcNode; otherwise we must
+				 * start it over ourselves.
+				 */
+				if (outerNode->chgParam == NULL)
+					ExecReScan(outerNode);
+
+				/* The entry alone might be too big for the cache */
+				if (!rc_reduce_memory(node))
+				{
+					rc_remove_entry(node, node->entry);
+					node->entry = NULL;
+					node->overflows++;
+					node->rc_status = RC_CACHE_BYPASS;
+				}
+				return ExecResultCache(node);
+			}
+
+		case RC_CACHE_FETCH_NEXT_TUPLE:
+			{
+				ResultCacheTuple *tuple = node->nexttuple;
+
+				if (tuple == NULL)
+				{
+					node->rc_status = RC_END_OF_SCAN;
+					return ExecClearTuple(node->ss.ps.ps_ResultTupleSlot);
+				}
+				node->nexttuple = tuple->next;
+				return ExecStoreMinimalTuple(tuple->mintuple,
+											 node->ss.ps.ps_ResultTupleSlot,
+											 false);
+			}
+
+		case RC_FILLING_CACHE:
+			slot = ExecProcNode(outerNode);
+			if (TupIsNull(slot))
+			{
+				/* The entry now holds the complete result */
+				node->entry->complete = true;
+				node->entry = NULL;
+				node->rc_status = RC_END_OF_SCAN;
+				return NULL;
+			}
+
+			if (!rc_cache_tuple(node, slot))
+			{
+				/*
+				 * Even after evicting everything else, this scan's result
+				 * doesn't fit in work_mem.  Stop caching it, and just pass
+				 * the rest of the subplan's output through.
+				 */
+				rc_remove_entry(node, node->entry);
+				node->entry = NULL;
+				node->overflows++;
+				node->rc_status = RC_CACHE_BYPASS;
+			}
+			return slot;
+
+		case RC_CACHE_BYPASS:
+			slot = ExecProcNode(outerNode);
+			if (TupIsNull(slot))
+			{
+				node->rc_status = RC_END_OF_SCAN;
+				return NULL;
+			}
+			return slot;
+
+		case RC_END_OF_SCAN:
+			return NULL;
+
+		default:
+			elog(ERROR, "unrecognized result cache state: %d",
+				 node->rc_status);
+			return NULL;		/* keep compiler quiet */
+	}
+}
+
+/*
+ * Create the (empty) hash table for the cache entries.
+ */
+static void
+rc_create_hashtable(ResultCacheState *node)
+{
+	HASHCTL		hash_ctl;
+
+	MemSet(&hash_ctl, 0, sizeof(hash_ctl));
+	hash_ctl.keysize = sizeof(uint32);
+	hash_ctl.entrysize = sizeof(ResultCacheBucket);
+	hash_ctl.hash = oid_hash;
+	hash_ctl.hcxt = node->cache->tableContext;
+	node->cache->hashtable = hash_create("Result Cache", 256, &hash_ctl,
+									HASH_ELEM | HASH_FUNCTION | HASH_CONTEXT);
+}
+
+/*
+ * Evaluate the cache key expressions into values[] and isnull[], and return
+ * their combined hash value.  Varlena values are detoasted, so that we
+ * compare and keep the values themselves.
+ */
+static uint32
+rc_hash_keys(ResultCacheState *node, Datum *values, bool *isnull)
+{
+	ExprContext *econtext = node->ss.ps.ps_ExprContext;
+	MemoryContext oldcontext;
+	uint32		hashkey = 0;
+	ListCell   *lc;
+	int			i = 0;
+
+	oldcontext = MemoryContextSwitchTo(econtext->ecxt_per_tuple_memory);
+
+	foreach(lc, node->param_exprs)
+	{
+		ExprState  *keyexpr = (ExprState *) lfirst(lc);
+
+		values[i] = ExecEvalExpr(keyexpr, econtext, &isnull[i], NULL);
+
+		/* rotate hashkey left 1 bit at each step */
+		hashkey = (hashkey << 1) | ((hashkey & 0x80000000) ? 1 : 0);
+
+		/* treat nulls as having hash key 0 */
+		if (!isnull[i])
+		{
+			unsigned char *data;
+			Size		len;
+
+			if (node->keytypbyval[i])
+			{
+				data = (unsigned char *) &values[i];
+				len = sizeof(Datum);
+			}
+			else
+			{
+				if (node->keytyplen[i] == -1)
+					values[i] =
+						PointerGetDatum(PG_DETOAST_DATUM_PACKED(values[i]));
+				data = (unsigned char *) DatumGetPointer(values[i]);
+				len = datumGetSize(values[i], false, node->keytyplen[i]);
+			}
+			hashkey ^= DatumGetUInt32(hash_any(data, (int) len));
+		}
+		i++;
+	}
+
+	MemoryContextSwitchTo(oldcontext);
+
+	return hashkey;
+}
+
+/*
+ * Find the cache entry for the given parameter values, or return NULL.
+ * Nulls are considered equal to each other here, since whatever the
+ * subplan does with a null parameter, it will do the same again.
+ */
+static ResultCacheEntry *
+rc_lookup(ResultCacheState *node, uint32 hashvalue, Datum *values,
+		  bool *isnull)
+{
+	ResultCacheBucket *bucket;
+	ResultCacheEntry *entry;
+
+	bucket = (ResultCacheBucket *) hash_search(node->cache->hashtable,
+											   &hashvalue, HASH_FIND, NULL);
+	if (bucket == NULL)
+		return NULL;
+
+	for (entry = bucket->entries; entry != NULL; entry = entry->hashnext)
+	{
+		int			i;
+
+		for (i = 0; i < node->nkeys; i++)
+		{
+			if (isnull[i] || entry->keynulls[i])
+			{
+				if (isnull[i] != entry->keynulls[i])
+					break;
+			}
+			else if (!datumIsEqual(entry->keyvalues[i], values[i],
+								   node->keytypbyval[i], node->keytyplen[i]))
+				break;
+		}
+		if (i == node->nkeys)
+			break;
+	}
+
+	return entry;
+}
+
+/*
+ * Add a new, empty entry for the given parameter values to the cache.  It
+ * goes at the most-recently-used end of the LRU list.
+ */
+static ResultCacheEntry *
+rc_create_entry(ResultCacheState *node, uint32 hashvalue, Datum *values,
+				bool *isnull)
+{
+	ResultCacheData *cache = node->cache;
+	ResultCacheBucket *bucket;
+	ResultCacheEntry *entry;
+	MemoryContext oldcontext;
+	bool		found;
+	int			i;
+
+	oldcontext = MemoryContextSwitchTo(cache->tableContext);
+
+	entry = (ResultCacheEntry *) palloc(sizeof(ResultCacheEntry));
+	entry->hashvalue = hashvalue;
+	entry->keyvalues = (Datum *) palloc(node->nkeys * sizeof(Datum));
+	entry->keynulls = (bool *) palloc(node->nkeys * sizeof(bool));
+	entry->mem = GetMemoryChunkSpace(entry) +
+		GetMemoryChunkSpace(entry->keyvalues) +
+		GetMemoryChunkSpace(entry->keynulls);
+
+	for (i = 0; i < node->nkeys; i++)
+	{
+		entry->keynulls[i] = isnull[i];
+		if (isnull[i])
+			entry->keyvalues[i] = (Datum) 0;
+		else
+		{
+			entry->keyvalues[i] = datumCopy(values[i],
+											node->keytypbyval[i],
+											node->keytyplen[i]);
+			if (!node->keytypbyval[i])
+				entry->mem +=
+					GetMemoryChunkSpace(DatumGetPointer(entry->keyvalues[i]));
+		}
+	}
+	entry->tuplehead = NULL;
+	entry->tupletail = NULL;
+	entry->complete = false;
+
+	MemoryContextSwitchTo(oldcontext);
+
+	bucket = (ResultCacheBucket *) hash_search(cache->hashtable, &hashvalue,
+											   HASH_ENTER, &found);
+	if (!found)
+		bucket->entries = NULL;
+	entry->hashnext = bucket->entries;
+	bucket->entries = entry;
+
+	dlist_push_tail(&cache->lru, &entry->lru_node);
+
+	cache->mem_used += entry->mem;
+	if (cache->mem_used > node->mem_peak)
+		node->mem_peak = cache->mem_used;
+
+	return entry;
+}
+
+/*
+ * Remove an entry from the cache, and free its memory.
+ */
+static void
+rc_remove_entry(ResultCacheState *node, ResultCacheEntry *entry)
+{
+	ResultCacheData *cache = node->cache;
+	ResultCacheBucket *bucket;
+	ResultCacheEntry **prev;
+	ResultCacheTuple *tuple;
+	int			i;
+
+	bucket = (ResultCacheBucket *) hash_search(cache->hashtable,
+											   &entry->hashvalue,
+											   HASH_FIND, NULL);
+	Assert(bucket != NULL);
+	for (prev = &bucket->entries; *prev != entry; prev = &(*prev)->hashnext)
+		Assert(*prev != NULL);
+	*prev = entry->hashnext;
+	if (bucket->entries == NULL)
+		hash_search(cache->hashtable, &entry->hashvalue, HASH_REMOVE, NULL);
+
+	dlist_delete(&entry->lru_node);
+	cache->mem_used -= entry->mem;
+
+	tuple = entry->tuplehead;
+	while (tuple != NULL)
+	{
+		ResultCacheTuple *next = tuple->next;
+
+		pfree(tuple->mintuple);
+		pfree(tuple);
+		tuple = next;
+	}
+	for (i = 0; i < node->nkeys; i++)
+	{
+		if (!entry->keynulls[i] && !node->keytypbyval[i])
+			pfree(DatumGetPointer(entry->keyvalues[i]));
+	}
+	pfree(entry->keyvalues);
+	pfree(entry->keynulls);
+	pfree(entry);
+}
+
+/*
+ * Add a tuple from the subplan to the entry being filled.  Returns false if
+ * that put the cache over its memory limit, and evicting all the other
+ * entries was not enough to fix that.
+ */
+static bool
+rc_cache_tuple(ResultCacheState *node, TupleTableSlot *slot)
+{
+	ResultCacheData *cache = node->cache;
+	ResultCacheEntry *entry = node->entry;
+	ResultCacheTuple *tuple;
+	MemoryContext oldcontext;
+	Size		mem;
+
+	oldcontext = MemoryContextSwitchTo(cache->tableContext);
+	tuple = (ResultCacheTuple *) palloc(sizeof(ResultCacheTuple));
+	tuple->mintuple = ExecCopySlotMinimalTuple(slot);
+	tuple->next = NULL;
+	MemoryContextSwitchTo(oldcontext);
+
+	if (entry->tupletail == NULL)
+		entry->tuplehead = tuple;
+	else
+		entry->tupletail->next = tuple;
+	entry->tupletail = tuple;
+
+	mem = GetMemoryChunkSpace(tuple) + GetMemoryChunkSpace(tuple->mintuple);
+	entry->mem += mem;
+	cache->mem_used += mem;
+	if (cache->mem_used > node->mem_peak)
+		node->mem_peak = cache->mem_used;
+
+	return rc_reduce_memory(node);
+}
+
+/*
+ * Evict least recently used entries until the cache fits in its memory
+ * limit again.  The entry being filled is never evicted; if it alone is over
+ * the limit, return false.
+ */
+static bool
+rc_reduce_memory(ResultCacheState *node)
+{
+	ResultCacheData *cache = node->cache;
+	dlist_mutable_iter iter;
+
+	if (cache->mem_used <= cache->mem_limit)
+		return true;
+
+	dlist_foreach_modify(iter, &cache->lru)
+	{
+		ResultCacheEntry *entry = dlist_container(ResultCacheEntry, lru_node,
+												  iter.cur);
+
+		if (entry == node->entry)
+			continue;
+
+		rc_remove_entry(node, entry);
+		node->evictions++;
+
+		if (cache->mem_used <= cache->mem_limit)
+			return true;
+	}
+
+	return false;
+}
+
+/*
+ * Throw away everything in the cache.
+ */
+static void
+rc_purge(ResultCacheState *node)
+{
+	ResultCacheData *cache = node->cache;
+
+	/* The hash table's own context is a child of tableContext */
+	hash_destroy(cache->hashtable);
+	MemoryContextReset(cache->tableContext);
+	dlist_init(&cache->lru);
+	cache->mem_used = 0;
+	rc_create_hashtable(node);
+
+	node->entry = NULL;
+	node->nexttuple = NULL;
+}
+
+/* ----------------------------------------------------------------
+ *		ExecInitResultCache
+ * ----------------------------------------------------------------
+ */
+ResultCacheState *
+ExecInitResultCache(ResultCache *node, EState *estate, int eflags)
+{
+	ResultCacheState *rcstate;
+	ListCell   *lc;
+	int			i;
+
+	/* check for unsupported flags */
+	Assert(!(eflags & (EXEC_FLAG_BACKWARD | EXEC_FLAG_MARK)));
+
+	/*
+	 * create state structure
+	 */
+	rcstate = makeNode(ResultCacheState);
+	rcstate->ss.ps.plan = (Plan *) node;
+	rcstate->ss.ps.state = estate;
+	rcstate->rc_status = RC_CACHE_LOOKUP;
+	rcstate->entry = NULL;
+	rcstate->nexttuple = NULL;
+
+	/*
+	 * Miscellaneous initialization
+	 *
+	 * create expression context for node, to evaluate the cache keys in
+	 */
+	ExecAssignExprContext(estate, &rcstate->ss.ps);
+
+	/*
+	 * tuple table initialization
+	 */
+	ExecInitResultTupleSlot(estate, &rcstate->ss.ps);
+	ExecInitScanTupleSlot(estate, &rcstate->ss);
+
+	/*
+	 * initialize child nodes
+	 *
+	 * We shield the child node from the need to support REWIND, BACKWARD, or
+	 * MARK/RESTORE: it is only ever rescanned when we don't already have its
+	 * results for the parameter values at hand.
+	 */
+	eflags &= ~(EXEC_FLAG_REWIND | EXEC_FLAG_BACKWARD | EXEC_FLAG_MARK);
+
+	outerPlanState(rcstate) = ExecInitNode(outerPlan(node), estate, eflags);
+
+	/*
+	 * initialize tuple type.  no need to initialize projection info because
+	 * this node doesn't do projections.
+	 */
+	ExecAssignResultTypeFromTL(&rcstate->ss.ps);
+	ExecAssignScanTypeFromOuterPlan(&rcstate->ss);
+	rcstate->ss.ps.ps_ProjInfo = NULL;
+
+	/*
+	 * Initialize the cache key expressions, and remember which executor
+	 * Params they are made of; see ExecReScanResultCache.
+	 */
+	rcstate->nkeys = node->numKeys;
+	rcstate->param_exprs = (List *)
+		ExecInitExpr((Expr *) node->param_exprs, (PlanState *) rcstate);
+	rcstate->keyparams = NULL;
+	foreach(lc, node->param_exprs)
+	{
+		Node	   *expr = (Node *) lfirst(lc);
+
+		if (IsA(expr, Param) &&
+			((Param *) expr)->paramkind == PARAM_EXEC)
+			rcstate->keyparams = bms_add_member(rcstate->keyparams,
+												((Param *) expr)->paramid);
+	}
+
+	/*
+	 * Look up the type information we need to hash, compare and copy the
+	 * key values.
+	 */
+	rcstate->keytyplen = (int16 *) palloc(rcstate->nkeys * sizeof(int16));
+	rcstate->keytypbyval = (bool *) palloc(rcstate->nkeys * sizeof(bool));
+	i = 0;
+	foreach(lc, node->param_exprs)
+	{
+		get_typlenbyval(exprType((Node *) lfirst(lc)),
+						&rcstate->keytyplen[i], &rcstate->keytypbyval[i]);
+		i++;
+	}
+
+	/*
+	 * Set up the (empty) cache.
+	 */
+	rcstate->cache = (ResultCacheData *) palloc(sizeof(ResultCacheData));
+	rcstate->cache->tableContext =
+		AllocSetContextCreate(CurrentMemoryContext,
+							  "ResultCache",
+							  ALLOCSET_DEFAULT_MINSIZE,
+							  ALLOCSET_DEFAULT_INITSIZE,
+							  ALLOCSET_DEFAULT_MAXSIZE);
+	dlist_init(&rcstate->cache->lru);
+	rcstate->cache->mem_used = 0;
+	rcstate->cache->mem_limit = work_mem * 1024L;
+	rc_create_hashtable(rcstate);
+
+	rcstate->hits = 0;
+	rcstate->misses = 0;
+	rcstate->evictions = 0;
+	rcstate->overflows = 0;
+	rcstate->mem_peak = 0;
+
+	return rcstate;
+}
+
+/* ----------------------------------------------------------------
+ *		ExecEndResultCache
+ * ----------------------------------------------------------------
+ */
+void
+ExecEndResultCache(ResultCacheState *node)
+{
+	/*
+	 * Free the exprcontext
+	 */
+	ExecFreeExprContext(&node->ss.ps);
+
+	/*
+	 * clean out the tuple table
+	 */
+	ExecClearTuple(node->ss.ss_ScanTupleSlot);
+	ExecClearTuple(node->ss.ps.ps_ResultTupleSlot);
+
+	/*
+	 * Release the cache; its hash table's context goes along with the
+	 * table context.
+	 */
+	MemoryContextDelete(node->cache->tableContext);
+	node->cache->hashtable = NULL;
+
+	/*
+	 * shut down the subplan
+	 */
+	ExecEndNode(outerPlanState(node));
+}
+
+void
+ExecReScanResultCache(ResultCacheState *node)
+{
+	ExecClearTuple(node->ss.ps.ps_ResultTupleSlot);
+
+	/*
+	 * An entry that was being filled stays incomplete, and will be thrown
+	 * away if it is looked up again.
+	 */
+	node->entry = NULL;
+	node->nexttuple = NULL;
+	node->rc_status = RC_CACHE_LOOKUP;
+
+	/*
+	 * If any parameter other than the cache keys has changed, the subplan's
+	 * results may be different now even for the same keys, so nothing in the
+	 * cache can be trusted any more.
+	 */
+	if (node->ss.ps.chgParam != NULL &&
+		!bms_is_subset(node->ss.ps.chgParam, node->keyparams))
+		rc_purge(node);
+
+	/*
+	 * We don't rescan the subplan here: it will only be needed if the next
+	 * lookup misses in the cache, and it's ExecResultCache's job to start it
+	 * over then.
+	 */
+}
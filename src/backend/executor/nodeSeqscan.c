@@ -15,6 +15,7 @@
 /*
  * INTERFACE ROUTINES
  *		ExecSeqScan				sequentially scans a relation.
+ *		ExecSeqScanBatch		returns a batch of qualifying tuples.
  *		ExecSeqNext				retrieve next tuple in sequential order.
  *		ExecInitSeqScan			creates and initializes a seqscan node.
  *		ExecEndSeqScan			releases any storage allocated.
@@ -27,6 +28,8 @@
 #include "access/relscan.h"
 #include "executor/execdebug.h"
 #include "executor/nodeSeqscan.h"
+#include "executor/tuplebatch.h"
+#include "utils/memutils.h"
 #include "utils/rel.h"
 
 static void InitScanRelation(SeqScanState *node, EState *estate, int eflags);
@@ -55,10 +58,10 @@ SeqNext(SeqScanState *node)
 	/*
 	 * get information from the estate and scan state
 	 */
-	scandesc = node->ss_currentScanDesc;
-	estate = node->ps.state;
+	scandesc = node->ss.ss_currentScanDesc;
+	estate = node->ss.ps.state;
 	direction = estate->es_direction;
-	slot = node->ss_ScanTupleSlot;
+	slot = node->ss.ss_ScanTupleSlot;
 
 	/*
 	 * get the next tuple from the table
@@ -115,6 +118,128 @@ ExecSeqScan(SeqScanState *node)
 					(ExecScanRecheckMtd) SeqRecheck);
 }
 
+/* ----------------------------------------------------------------
+ *		ExecSeqScanSupportsBatch(node)
+ *
+ *		Can ExecSeqScanBatch be used for this node?  We don't try to
+ *		project in batch mode, nor to deal with EvalPlanQual rechecks.
+ * ----------------------------------------------------------------
+ */
+bool
+ExecSeqScanSupportsBatch(SeqScanState *node)
+{
+	return node->ss.ps.ps_ProjInfo == NULL &&
+		node->ss.ps.state->es_epqTuple == NULL &&
+		ScanDirectionIsForward(node->ss.ps.state->es_direction);
+}
+
+/* ----------------------------------------------------------------
+ *		ExecSeqScanBatch(node, batch)
+ *
+ *		Fills the batch with the next tuples satisfying the node's qual,
+ *		leaving it empty at the end of the scan.
+ *
+ *		Column values point directly into the heap pages, which the
+ *		batch keeps pinned.  Once the batch holds as many pins as it
+ *		may, a tuple from yet another page is copied instead, and ends
+ *		the batch.  Quals of simple enough form are checked over the
+ *		whole batch at once by ExecBatchQual; otherwise each tuple is
+ *		checked as it's fetched, just as ExecScan would.
+ * ----------------------------------------------------------------
+ */
+void
+ExecSeqScanBatch(SeqScanState *node, TupleBatch *batch)
+{
+	HeapScanDesc scandesc = node->ss.ss_currentScanDesc;
+	ScanDirection direction = node->ss.ps.state->es_direction;
+	TupleTableSlot *slot = node->ss.ss_ScanTupleSlot;
+	ExprContext *econtext = node->ss.ps.ps_ExprContext;
+	List	   *qual = node->ss.ps.qual;
+	bool		rowqual;
+	int			natts;
+
+	Assert(ExecSeqScanSupportsBatch(node));
+
+	if (!node->batchQualReady)
+	{
+		node->batchQual = ExecInitBatchQual(((Plan *) node->ss.ps.plan)->qual);
+		node->batchQualReady = true;
+	}
+	rowqual = (qual != NIL && node->batchQual == NIL);
+	natts = Max(batch->ncols, ExecBatchQualNeededAtts(node->batchQual));
+
+	econtext->ecxt_scantuple = slot;
+
+	do
+	{
+		bool		done = false;
+
+		TupleBatchReset(batch);
+		ResetExprContext(econtext);
+
+		while (batch->nrows < batch->maxrows)
+		{
+			HeapTuple	tuple;
+			bool		lastrow = false;
+
+			tuple = heap_getnext(scandesc, direction);
+			if (tuple == NULL)
+			{
+				done = true;
+				break;
+			}
+
+			if (TupleBatchPinBuffer(batch, scandesc->rs_cbuf))
+				ExecStoreTuple(tuple, slot, scandesc->rs_cbuf, false);
+			else
+			{
+				MemoryContext oldContext;
+
+				oldContext = MemoryContextSwitchTo(batch->batchcxt);
+				tuple = heap_copytuple(tuple);
+				MemoryContextSwitchTo(oldContext);
+				ExecStoreTuple(tuple, slot, InvalidBuffer, false);
+				lastrow = true;
+			}
+
+			if (rowqual)
+			{
+				bool		ok = ExecQual(qual, econtext, false);
+
+				ResetExprContext(econtext);
+				if (!ok)
+				{
+					InstrCountFiltered1(node, 1);
+					if (lastrow)
+						break;
+					continue;
+				}
+			}
+
+			TupleBatchAddSlot(batch, slot, natts, false);
+
+			if (lastrow)
+				break;
+		}
+
+		/* Don't leave the slot pointing at a page we may unpin */
+		ExecClearTuple(slot);
+
+		if (node->batchQual != NIL)
+		{
+			int			nremoved;
+
+			nremoved = ExecBatchQual(node->batchQual, batch, econtext);
+			ResetExprContext(econtext);
+			InstrCountFiltered1(node, nremoved);
+		}
+
+		/* Try again if every tuple was filtered out, unless at the end */
+		if (done)
+			break;
+	} while (batch->nrows == 0);
+}
+
 /* ----------------------------------------------------------------
  *		InitScanRelation
  *
@@ -132,7 +257,7 @@ InitScanRelation(SeqScanState *node, EState *estate, int eflags)
 	 * open that relation and acquire appropriate lock on it.
 	 */
 	currentRelation = ExecOpenScanRelation(estate,
-									  ((SeqScan *) node->ps.plan)->scanrelid,
+									  ((SeqScan *) node->ss.ps.plan)->scanrelid,
 										   eflags);
 
 	/* initialize a heapscan */
@@ -141,11 +266,11 @@ InitScanRelation(SeqScanState *node, EState *estate, int eflags)
 									 0,
 									 NULL);
 
-	node->ss_currentRelation = currentRelation;
-	node->ss_currentScanDesc = currentScanDesc;
+	node->ss.ss_currentRelation = currentRelation;
+	node->ss.ss_currentScanDesc = currentScanDesc;
 
 	/* and report the scan tuple slot's rowtype */
-	ExecAssignScanType(node, RelationGetDescr(currentRelation));
+	ExecAssignScanType(&node->ss, RelationGetDescr(currentRelation));
 }
 
 
@@ -169,44 +294,45 @@ ExecInitSeqScan(SeqScan *node, EState *estate, int eflags)
 	 * create state structure
 	 */
 	scanstate = makeNode(SeqScanState);
-	scanstate->ps.plan = (Plan *) node;
-	scanstate->ps.state = estate;
+	scanstate->ss.ps.plan = (Plan *) node;
+	scanstate->ss.ps.state = estate;
+	scanstate->batchQualReady = false;
+	scanstate->batchQual = NIL;
 
 	/*
 	 * Miscellaneous initialization
 	 *
 	 * create expression context for node
 	 */
-	ExecAssignExprContext(estate, &scanstate->ps);
+	ExecAssignExprContext(estate, &scanstate->ss.ps);
 
 	/*
 	 * initialize child expressions
 	 */
-	scanstate->ps.targetlist = (List *)
+	scanstate->ss.ps.targetlist = (List *)
 		ExecInitExpr((Expr *) node->plan.targetlist,
 					 (PlanState *) scanstate);
-	scanstate->ps.qual = (List *)
-		ExecInitExpr((Expr *) node->plan.qual,
-					 (PlanState *) scanstate);
+	scanstate->ss.ps.qual =
+		ExecInitQual(node->plan.qual, (PlanState *) scanstate);
 
 	/*
 	 * tuple table initialization
 	 */
-	ExecInitResultTupleSlot(estate, &scanstate->ps);
-	ExecInitScanTupleSlot(estate, scanstate);
+	ExecInitResultTupleSlot(estate, &scanstate->ss.ps);
+	ExecInitScanTupleSlot(estate, &scanstate->ss);
 
 	/*
 	 * initialize scan relation
 	 */
 	InitScanRelation(scanstate, estate, eflags);
 
-	scanstate->ps.ps_TupFromTlist = false;
+	scanstate->ss.ps.ps_TupFromTlist = false;
 
 	/*
 	 * Initialize result tuple type and projection info.
 	 */
-	ExecAssignResultTypeFromTL(&scanstate->ps);
-	ExecAssignScanProjectionInfo(scanstate);
+	ExecAssignResultTypeFromTL(&scanstate->ss.ps);
+	ExecAssignScanProjectionInfo(&scanstate->ss);
 
 	return scanstate;
 }
@@ -226,19 +352,19 @@ ExecEndSeqScan(SeqScanState *node)
 	/*
 	 * get information from node
 	 */
-	relation = node->ss_currentRelation;
-	scanDesc = node->ss_currentScanDesc;
+	relation = node->ss.ss_currentRelation;
+	scanDesc = node->ss.ss_currentScanDesc;
 
 	/*
 	 * Free the exprcontext
 	 */
-	ExecFreeExprContext(&node->ps);
+	ExecFreeExprContext(&node->ss.ps);
 
 	/*
 	 * clean out the tuple table
 	 */
-	ExecClearTuple(node->ps.ps_ResultTupleSlot);
-	ExecClearTuple(node->ss_ScanTupleSlot);
+	ExecClearTuple(node->ss.ps.ps_ResultTupleSlot);
+	ExecClearTuple(node->ss.ss_ScanTupleSlot);
 
 	/*
 	 * close heap scan
@@ -267,7 +393,7 @@ ExecReScanSeqScan(SeqScanState *node)
 {
 	HeapScanDesc scan;
 
-	scan = node->ss_currentScanDesc;
+	scan = node->ss.ss_currentScanDesc;
 
 	heap_rescan(scan,			/* scan desc */
 				NULL);			/* new scan keys */
@@ -284,7 +410,7 @@ ExecReScanSeqScan(SeqScanState *node)
 void
 ExecSeqMarkPos(SeqScanState *node)
 {
-	HeapScanDesc scan = node->ss_currentScanDesc;
+	HeapScanDesc scan = node->ss.ss_currentScanDesc;
 
 	heap_markpos(scan);
 }
@@ -298,7 +424,7 @@ ExecSeqMarkPos(SeqScanState *node)
 void
 ExecSeqRestrPos(SeqScanState *node)
 {
-	HeapScanDesc scan = node->ss_currentScanDesc;
+	HeapScanDesc scan = node->ss.ss_currentScanDesc;
 
 	/*
 	 * Clear any reference to the previously returned tuple.  This is needed
@@ -306,7 +432,7 @@ ExecSeqRestrPos(SeqScanState *node)
 	 * heap_restrpos will change; we'd have an internally inconsistent slot if
 	 * we didn't do this.
 	 */
-	ExecClearTuple(node->ss_ScanTupleSlot);
+	ExecClearTuple(node->ss.ss_ScanTupleSlot);
 
 	heap_restrpos(scan);
 }
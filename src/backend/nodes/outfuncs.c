@@ -347,6 +347,8 @@ _outAppend(StringInfo str, const Append *node)
 	_outPlanInfo(str, (const Plan *) node);
 
 	WRITE_NODE_FIELD(appendplans);
+	WRITE_NODE_FIELD(prune_quals);
+	WRITE_NODE_FIELD(prune_constraints);
 }
 
 static void
@@ -359,6 +361,8 @@ _outMergeAppend(StringInfo str, const MergeAppend *node)
 	_outPlanInfo(str, (const Plan *) node);
 
 	WRITE_NODE_FIELD(mergeplans);
+	WRITE_NODE_FIELD(prune_quals);
+	WRITE_NODE_FIELD(prune_constraints);
 
 	WRITE_INT_FIELD(numCols);
 
@@ -438,6 +442,16 @@ _outSeqScan(StringInfo str, const SeqScan *node)
 	_outScanInfo(str, (const Scan *) node);
 }
 
+static void
+_outParallelSeqScan(StringInfo str, const ParallelSeqScan *node)
+{
+	WRITE_NODE_TYPE("PARALLELSEQSCAN");
+
+	_outScanInfo(str, (const Scan *) node);
+
+	WRITE_INT_FIELD(num_workers);
+}
+
 static void
 _outIndexScan(StringInfo str, const IndexScan *node)
 {
@@ -574,11 +588,30 @@ _outJoin(StringInfo str, const Join *node)
 static void
 _outNestLoop(StringInfo str, const NestLoop *node)
 {
+	int			i;
+
 	WRITE_NODE_TYPE("NESTLOOP");
 
 	_outJoinPlanInfo(str, (const Join *) node);
 
 	WRITE_NODE_FIELD(nestParams);
+	WRITE_INT_FIELD(numBatchKeys);
+
+	appendStringInfoString(str, " :batchKeyParams");
+	for (i = 0; i < node->numBatchKeys; i++)
+		appendStringInfo(str, " %d", node->batchKeyParams[i]);
+
+	appendStringInfoString(str, " :batchSortOperators");
+	for (i = 0; i < node->numBatchKeys; i++)
+		appendStringInfo(str, " %u", node->batchSortOperators[i]);
+
+	appendStringInfoString(str, " :batchCollations");
+	for (i = 0; i < node->numBatchKeys; i++)
+		appendStringInfo(str, " %u", node->batchCollations[i]);
+
+	appendStringInfoString(str, " :batchNullsFirst");
+	for (i = 0; i < node->numBatchKeys; i++)
+		appendStringInfo(str, " %s", booltostr(node->batchNullsFirst[i]));
 }
 
 static void
@@ -620,6 +653,7 @@ _outHashJoin(StringInfo str, const HashJoin *node)
 	_outJoinPlanInfo(str, (const Join *) node);
 
 	WRITE_NODE_FIELD(hashclauses);
+	WRITE_NODE_FIELD(filterkeys);
 }
 
 static void
@@ -643,6 +677,12 @@ _outAgg(StringInfo str, const Agg *node)
 		appendStringInfo(str, " %u", node->grpOperators[i]);
 
 	WRITE_LONG_FIELD(numGroups);
+
+	WRITE_NODE_FIELD(groupingSets);
+	WRITE_NODE_FIELD(chain);
+	WRITE_BOOL_FIELD(combineStates);
+	WRITE_BOOL_FIELD(finalizeAggs);
+	WRITE_BOOL_FIELD(serialStates);
 }
 
 static void
@@ -709,11 +749,23 @@ _outMaterial(StringInfo str, const Material *node)
 }
 
 static void
-_outSort(StringInfo str, const Sort *node)
+_outResultCache(StringInfo str, const ResultCache *node)
 {
-	int			i;
+	WRITE_NODE_TYPE("RESULTCACHE");
 
-	WRITE_NODE_TYPE("SORT");
+	_outPlanInfo(str, (const Plan *) node);
+
+	WRITE_INT_FIELD(numKeys);
+	WRITE_NODE_FIELD(param_exprs);
+}
+
+/*
+ * print the basic stuff of all nodes that inherit from Sort
+ */
+static void
+_outSortInfo(StringInfo str, const Sort *node)
+{
+	int			i;
 
 	_outPlanInfo(str, (const Plan *) node);
 
@@ -736,6 +788,24 @@ _outSort(StringInfo str, const Sort *node)
 		appendStringInfo(str, " %s", booltostr(node->nullsFirst[i]));
 }
 
+static void
+_outSort(StringInfo str, const Sort *node)
+{
+	WRITE_NODE_TYPE("SORT");
+
+	_outSortInfo(str, node);
+}
+
+static void
+_outIncrementalSort(StringInfo str, const IncrementalSort *node)
+{
+	WRITE_NODE_TYPE("INCREMENTALSORT");
+
+	_outSortInfo(str, (const Sort *) node);
+
+	WRITE_INT_FIELD(presortedCols);
+}
+
 static void
 _outUnique(StringInfo str, const Unique *node)
 {
@@ -962,6 +1032,21 @@ _outAggref(StringInfo str, const Aggref *node)
 	WRITE_BOOL_FIELD(aggvariadic);
 	WRITE_CHAR_FIELD(aggkind);
 	WRITE_UINT_FIELD(agglevelsup);
+	WRITE_BOOL_FIELD(aggpartial);
+	WRITE_BOOL_FIELD(aggcombine);
+	WRITE_NODE_FIELD(aggargtypes);
+	WRITE_LOCATION_FIELD(location);
+}
+
+static void
+_outGroupingFunc(StringInfo str, const GroupingFunc *node)
+{
+	WRITE_NODE_TYPE("GROUPINGFUNC");
+
+	WRITE_NODE_FIELD(args);
+	WRITE_NODE_FIELD(refs);
+	WRITE_NODE_FIELD(cols);
+	WRITE_UINT_FIELD(agglevelsup);
 	WRITE_LOCATION_FIELD(location);
 }
 
@@ -1570,6 +1655,16 @@ _outTidPath(StringInfo str, const TidPath *node)
 	WRITE_NODE_FIELD(tidquals);
 }
 
+static void
+_outParallelSeqScanPath(StringInfo str, const ParallelSeqScanPath *node)
+{
+	WRITE_NODE_TYPE("PARALLELSEQSCANPATH");
+
+	_outPathInfo(str, (const Path *) node);
+
+	WRITE_INT_FIELD(num_workers);
+}
+
 static void
 _outForeignPath(StringInfo str, const ForeignPath *node)
 {
@@ -1621,6 +1716,19 @@ _outMaterialPath(StringInfo str, const MaterialPath *node)
 	WRITE_NODE_FIELD(subpath);
 }
 
+static void
+_outResultCachePath(StringInfo str, const ResultCachePath *node)
+{
+	WRITE_NODE_TYPE("RESULTCACHEPATH");
+
+	_outPathInfo(str, (const Path *) node);
+
+	WRITE_NODE_FIELD(subpath);
+	WRITE_NODE_FIELD(param_exprs);
+	WRITE_FLOAT_FIELD(calls, "%.0f");
+	WRITE_FLOAT_FIELD(ndistinct, "%.0f");
+}
+
 static void
 _outUniquePath(StringInfo str, const UniquePath *node)
 {
@@ -1683,6 +1791,7 @@ _outPlannerGlobal(StringInfo str, const PlannerGlobal *node)
 	WRITE_UINT_FIELD(lastPHId);
 	WRITE_UINT_FIELD(lastRowMarkId);
 	WRITE_BOOL_FIELD(transientPlan);
+	WRITE_BOOL_FIELD(parallelModeOK);
 }
 
 static void
@@ -2255,6 +2364,7 @@ _outQuery(StringInfo str, const Query *node)
 	WRITE_NODE_FIELD(withCheckOptions);
 	WRITE_NODE_FIELD(returningList);
 	WRITE_NODE_FIELD(groupClause);
+	WRITE_NODE_FIELD(groupingSets);
 	WRITE_NODE_FIELD(havingQual);
 	WRITE_NODE_FIELD(windowClause);
 	WRITE_NODE_FIELD(distinctClause);
@@ -2288,6 +2398,16 @@ _outSortGroupClause(StringInfo str, const SortGroupClause *node)
 	WRITE_BOOL_FIELD(hashable);
 }
 
+static void
+_outGroupingSet(StringInfo str, const GroupingSet *node)
+{
+	WRITE_NODE_TYPE("GROUPINGSET");
+
+	WRITE_ENUM_FIELD(kind, GroupingSetKind);
+	WRITE_NODE_FIELD(content);
+	WRITE_LOCATION_FIELD(location);
+}
+
 static void
 _outWindowClause(StringInfo str, const WindowClause *node)
 {
@@ -2795,6 +2915,9 @@ _outNode(StringInfo str, const void *obj)
 			case T_SeqScan:
 				_outSeqScan(str, obj);
 				break;
+			case T_ParallelSeqScan:
+				_outParallelSeqScan(str, obj);
+				break;
 			case T_IndexScan:
 				_outIndexScan(str, obj);
 				break;
@@ -2852,9 +2975,15 @@ _outNode(StringInfo str, const void *obj)
 			case T_Material:
 				_outMaterial(str, obj);
 				break;
+			case T_ResultCache:
+				_outResultCache(str, obj);
+				break;
 			case T_Sort:
 				_outSort(str, obj);
 				break;
+			case T_IncrementalSort:
+				_outIncrementalSort(str, obj);
+				break;
 			case T_Unique:
 				_outUnique(str, obj);
 				break;
@@ -2900,6 +3029,9 @@ _outNode(StringInfo str, const void *obj)
 			case T_Aggref:
 				_outAggref(str, obj);
 				break;
+			case T_GroupingFunc:
+				_outGroupingFunc(str, obj);
+				break;
 			case T_WindowFunc:
 				_outWindowFunc(str, obj);
 				break;
@@ -3033,6 +3165,9 @@ _outNode(StringInfo str, const void *obj)
 			case T_TidPath:
 				_outTidPath(str, obj);
 				break;
+			case T_ParallelSeqScanPath:
+				_outParallelSeqScanPath(str, obj);
+				break;
 			case T_ForeignPath:
 				_outForeignPath(str, obj);
 				break;
@@ -3048,6 +3183,9 @@ _outNode(StringInfo str, const void *obj)
 			case T_MaterialPath:
 				_outMaterialPath(str, obj);
 				break;
+			case T_ResultCachePath:
+				_outResultCachePath(str, obj);
+				break;
 			case T_UniquePath:
 				_outUniquePath(str, obj);
 				break;
@@ -3151,6 +3289,9 @@ _outNode(StringInfo str, const void *obj)
 			case T_SortGroupClause:
 				_outSortGroupClause(str, obj);
 				break;
+			case T_GroupingSet:
+				_outGroupingSet(str, obj);
+				break;
 			case T_WindowClause:
 				_outWindowClause(str, obj);
 				break;
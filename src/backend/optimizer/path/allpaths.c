@@ -58,6 +58,8 @@ static void set_plain_rel_size(PlannerInfo *root, RelOptInfo *rel,
 				   RangeTblEntry *rte);
 static void set_plain_rel_pathlist(PlannerInfo *root, RelOptInfo *rel,
 					   RangeTblEntry *rte);
+static void consider_parallel_seqscan(PlannerInfo *root, RelOptInfo *rel,
+						  RangeTblEntry *rte);
 static void set_foreign_size(PlannerInfo *root, RelOptInfo *rel,
 				 RangeTblEntry *rte);
 static void set_foreign_pathlist(PlannerInfo *root, RelOptInfo *rel,
@@ -383,6 +385,10 @@ set_plain_rel_pathlist(PlannerInfo *root, RelOptInfo *rel, RangeTblEntry *rte)
 	/* Consider sequential scan */
 	add_path(rel, create_seqscan_path(root, rel, required_outer));
 
+	/* Consider parallel sequential scan */
+	if (required_outer == NULL)
+		consider_parallel_seqscan(root, rel, rte);
+
 	/* Consider index scans */
 	create_index_paths(root, rel);
 
@@ -393,6 +399,60 @@ set_plain_rel_pathlist(PlannerInfo *root, RelOptInfo *rel, RangeTblEntry *rte)
 	set_cheapest(rel);
 }
 
+/*
+ * consider_parallel_seqscan
+ *	  Add a parallel sequential scan path for a plain relation, if the
+ *	  query and the relation's restriction clauses allow it.
+ *
+ * We ask for one worker once the relation reaches min_parallel_relation_size,
+ * and one more each time it triples in size, up to max_parallel_degree.
+ */
+static void
+consider_parallel_seqscan(PlannerInfo *root, RelOptInfo *rel,
+						  RangeTblEntry *rte)
+{
+	int			nworkers;
+	double		threshold;
+	ListCell   *lc;
+
+	/*
+	 * Only the top query level is considered, since scans in subqueries may
+	 * be rescanned many times; and rows to be locked must be read by the
+	 * master itself.
+	 */
+	if (!root->glob->parallelModeOK || root->query_level != 1 ||
+		root->rowMarks != NIL)
+		return;
+
+	/* Small relations aren't worth the cost of starting workers. */
+	threshold = Max(min_parallel_relation_size, 1);
+	if ((double) rel->pages < threshold)
+		return;
+
+	/* Temporary tables live in our local buffers, which workers can't see. */
+	if (get_rel_persistence(rte->relid) == RELPERSISTENCE_TEMP)
+		return;
+
+	/* The workers must be able to evaluate every restriction clause. */
+	foreach(lc, rel->baserestrictinfo)
+	{
+		RestrictInfo *rinfo = (RestrictInfo *) lfirst(lc);
+
+		if (has_parallel_hazard((Node *) rinfo->clause))
+			return;
+	}
+
+	nworkers = 1;
+	while (nworkers < max_parallel_degree &&
+		   (double) rel->pages >= threshold * 3)
+	{
+		nworkers++;
+		threshold *= 3;
+	}
+
+	add_path(rel, create_parallelseqscan_path(root, rel, nworkers));
+}
+
 /*
  * set_foreign_size
  *		Set size estimates for a foreign table RTE
@@ -1194,6 +1254,7 @@ set_subquery_pathlist(PlannerInfo *root, RelOptInfo *rel,
 	 */
 	if (parse->hasAggs ||
 		parse->groupClause ||
+		parse->groupingSets ||
 		parse->havingQual ||
 		parse->distinctClause ||
 		parse->sortClause ||
@@ -1976,7 +2037,8 @@ subquery_push_qual(Query *subquery, RangeTblEntry *rte, Index rti, Node *qual)
 		 * subquery uses grouping or aggregation, put it in HAVING (since the
 		 * qual really refers to the group-result rows).
 		 */
-		if (subquery->hasAggs || subquery->groupClause || subquery->havingQual)
+		if (subquery->hasAggs || subquery->groupClause ||
+			subquery->groupingSets || subquery->havingQual)
 			subquery->havingQual = make_and_qual(subquery->havingQual, qual);
 		else
 			subquery->jointree->quals =
@@ -11,6 +11,8 @@
  *	cpu_tuple_cost		Cost of typical CPU time to process a tuple
  *	cpu_index_tuple_cost  Cost of typical CPU time to process an index tuple
  *	cpu_operator_cost	Cost of CPU time to execute an operator or function
+ *	parallel_setup_cost	Cost of starting up the workers for a parallel scan
+ *	parallel_tuple_cost	Cost of passing a tuple from a worker to the master
  *
  * We expect that the kernel will typically do some amount of read-ahead
  * optimization; this in conjunction with seek costs means that seq_page_cost
@@ -77,6 +79,7 @@
 #include "access/htup_details.h"
 #include "executor/executor.h"
 #include "executor/nodeHash.h"
+#include "executor/nodeIncrementalSort.h"
 #include "miscadmin.h"
 #include "nodes/nodeFuncs.h"
 #include "optimizer/clauses.h"
@@ -103,9 +106,14 @@ double		random_page_cost = DEFAULT_RANDOM_PAGE_COST;
 double		cpu_tuple_cost = DEFAULT_CPU_TUPLE_COST;
 double		cpu_index_tuple_cost = DEFAULT_CPU_INDEX_TUPLE_COST;
 double		cpu_operator_cost = DEFAULT_CPU_OPERATOR_COST;
+double		parallel_setup_cost = DEFAULT_PARALLEL_SETUP_COST;
+double		parallel_tuple_cost = DEFAULT_PARALLEL_TUPLE_COST;
 
 int			effective_cache_size = -1;	/* will get replaced */
 
+int			max_parallel_degree = 0;
+int			min_parallel_relation_size = 1024;	/* 8MB in blocks */
+
 Cost		disable_cost = 1.0e10;
 
 bool		enable_seqscan = true;
@@ -114,9 +122,12 @@ bool		enable_indexonlyscan = true;
 bool		enable_bitmapscan = true;
 bool		enable_tidscan = true;
 bool		enable_sort = true;
+bool		enable_incremental_sort = true;
 bool		enable_hashagg = true;
 bool		enable_nestloop = true;
+bool		enable_batched_nestloop = true;
 bool		enable_material = true;
+bool		enable_resultcache = true;
 bool		enable_mergejoin = true;
 bool		enable_hashjoin = true;
 
@@ -220,6 +231,66 @@ cost_seqscan(Path *path, PlannerInfo *root,
 	path->total_cost = startup_cost + run_cost;
 }
 
+/*
+ * cost_parallel_seqscan
+ *	  Determines and returns the cost of scanning a relation sequentially
+ *	  with the help of 'nworkers' background workers.
+ *
+ * The master takes part in the scan too, so the CPU cost of examining the
+ * tuples is divided among nworkers + 1 processes.  We assume that reading
+ * the pages is limited by the storage rather than by the number of readers,
+ * so the disk cost is not divided.  On top of that we charge for starting
+ * the workers and for passing each result tuple back to the master.
+ *
+ * 'baserel' is the relation to be scanned
+ * 'nworkers' is the number of workers to be requested
+ */
+void
+cost_parallel_seqscan(Path *path, PlannerInfo *root,
+					  RelOptInfo *baserel, int nworkers)
+{
+	Cost		startup_cost = 0;
+	Cost		run_cost = 0;
+	double		spc_seq_page_cost;
+	QualCost	qpqual_cost;
+	Cost		cpu_per_tuple;
+
+	/* Should only be applied to base relations */
+	Assert(baserel->relid > 0);
+	Assert(baserel->rtekind == RTE_RELATION);
+	Assert(nworkers > 0);
+
+	/* Parallel scans are never parameterized */
+	path->rows = baserel->rows;
+
+	if (!enable_seqscan)
+		startup_cost += disable_cost;
+
+	/* fetch estimated page cost for tablespace containing table */
+	get_tablespace_page_costs(baserel->reltablespace,
+							  NULL,
+							  &spc_seq_page_cost);
+
+	/*
+	 * disk costs
+	 */
+	run_cost += spc_seq_page_cost * baserel->pages;
+
+	/* CPU costs, shared among the master and the workers */
+	get_restriction_qual_cost(root, baserel, NULL, &qpqual_cost);
+
+	startup_cost += qpqual_cost.startup;
+	cpu_per_tuple = cpu_tuple_cost + qpqual_cost.per_tuple;
+	run_cost += cpu_per_tuple * baserel->tuples / (nworkers + 1);
+
+	/* Cost of starting workers and of communicating with them */
+	startup_cost += parallel_setup_cost;
+	run_cost += parallel_tuple_cost * path->rows;
+
+	path->startup_cost = startup_cost;
+	path->total_cost = startup_cost + run_cost;
+}
+
 /*
  * cost_index
  *	  Determines and returns the cost of scanning a relation using an index.
@@ -1204,8 +1275,9 @@ cost_recursive_union(Plan *runion, Plan *nrterm, Plan *rterm)
  * total, but we will also need to write and read each tuple once per
  * merge pass.	We expect about ceil(logM(r)) merge passes where r is the
  * number of initial runs formed and M is the merge order used by tuplesort.c.
- * Since the average initial run should be about twice sort_mem, we have
- *		disk traffic = 2 * relsize * ceil(logM(p / (2*sort_mem)))
+ * Since tuplesort.c forms each initial run by quicksorting a memory-load of
+ * tuples, the average initial run should be about sort_mem, so we have
+ *		disk traffic = 2 * relsize * ceil(logM(p / sort_mem))
  *		cpu = comparison_cost * t * log2(t)
  *
  * If the sort is bounded (i.e., only the first k result tuples are needed)
@@ -1281,7 +1353,7 @@ cost_sort(Path *path, PlannerInfo *root,
 		 * We'll have to use a disk-based sort of all the tuples
 		 */
 		double		npages = ceil(input_bytes / BLCKSZ);
-		double		nruns = (input_bytes / sort_mem_bytes) * 0.5;
+		double		nruns = input_bytes / sort_mem_bytes;
 		double		mergeorder = tuplesort_merge_order(sort_mem_bytes);
 		double		log_runs;
 		double		npageaccesses;
@@ -1335,6 +1407,100 @@ cost_sort(Path *path, PlannerInfo *root,
 	path->total_cost = startup_cost + run_cost;
 }
 
+/*
+ * cost_incremental_sort
+ *	  Determines and returns the cost of an incremental sort, including the
+ *	  cost of reading the input data.
+ *
+ * The input is already sorted by the first 'presorted_keys' of the pathkeys,
+ * so the executor reads and sorts it in batches made of whole groups of
+ * tuples with equal presorted keys, and at least INCSORT_MIN_BATCH_TUPLES
+ * tuples long.  We estimate the number of groups from the presorted key
+ * expressions, and charge for sorting each batch separately, plus one
+ * comparison of the presorted keys per input tuple and a little per-batch
+ * overhead for starting a new sort.
+ *
+ * Only the first batch must be read and sorted before the first tuple can
+ * be returned, which is what makes this attractive under a LIMIT; so the
+ * startup cost covers that batch's share of the input and its sort.
+ *
+ * Other arguments are as for cost_sort.  Since we only use this on top of a
+ * plan that's already been chosen, there's no limit_tuples argument: an upper
+ * LIMIT node pro-rates our run cost.
+ */
+void
+cost_incremental_sort(Path *path, PlannerInfo *root,
+					  List *pathkeys, int presorted_keys,
+					  Cost input_startup_cost, Cost input_total_cost,
+					  double input_tuples, int width,
+					  Cost comparison_cost, int sort_mem)
+{
+	Cost		startup_cost;
+	Cost		run_cost;
+	Cost		input_run_cost = input_total_cost - input_startup_cost;
+	Cost		batch_startup_cost;
+	Cost		batch_run_cost;
+	double		input_groups;
+	double		batch_tuples;
+	double		nbatches;
+	List	   *presortedExprs = NIL;
+	ListCell   *l;
+	int			i = 0;
+	Path		sort_path;		/* dummy for result of cost_sort */
+
+	Assert(presorted_keys > 0);
+
+	if (input_tuples < 2.0)
+		input_tuples = 2.0;
+
+	/* Estimate the number of groups with equal presorted keys */
+	foreach(l, pathkeys)
+	{
+		PathKey    *key = (PathKey *) lfirst(l);
+		EquivalenceMember *member;
+
+		if (i++ >= presorted_keys)
+			break;
+		member = (EquivalenceMember *) linitial(key->pk_eclass->ec_members);
+		presortedExprs = lappend(presortedExprs, member->em_expr);
+	}
+	input_groups = estimate_num_groups(root, presortedExprs, input_tuples);
+	list_free(presortedExprs);
+
+	/* Each batch holds at least the minimum number of tuples, or a group */
+	batch_tuples = Max(input_tuples / input_groups,
+					   (double) INCSORT_MIN_BATCH_TUPLES);
+	batch_tuples = Min(batch_tuples, input_tuples);
+	nbatches = input_tuples / batch_tuples;
+
+	/*
+	 * Cost of sorting one batch.  cost_sort charges disable_cost if sorting
+	 * is disabled, but only enable_incremental_sort governs this node.
+	 */
+	cost_sort(&sort_path, root, pathkeys, 0.0, batch_tuples, width,
+			  comparison_cost, sort_mem, -1.0);
+	batch_startup_cost = sort_path.startup_cost;
+	batch_run_cost = sort_path.total_cost - sort_path.startup_cost;
+	if (!enable_sort)
+		batch_startup_cost -= disable_cost;
+
+	startup_cost = input_startup_cost + input_run_cost / nbatches +
+		batch_startup_cost;
+	run_cost = (input_run_cost / nbatches + batch_startup_cost) *
+		(nbatches - 1.0) + batch_run_cost * nbatches;
+
+	/* Compare presorted keys once per tuple, and set up each batch's sort */
+	run_cost += cpu_operator_cost * presorted_keys * input_tuples;
+	run_cost += 2.0 * cpu_tuple_cost * nbatches;
+
+	if (!enable_incremental_sort)
+		startup_cost += disable_cost;
+
+	path->rows = input_tuples;
+	path->startup_cost = startup_cost;
+	path->total_cost = startup_cost + run_cost;
+}
+
 /*
  * cost_merge_append
  *	  Determines and returns the cost of a MergeAppend node.
@@ -1454,6 +1620,29 @@ cost_material(Path *path,
 	path->total_cost = startup_cost + run_cost;
 }
 
+/*
+ * cost_resultcache
+ *	  Determines and returns the cost of the first scan of a ResultCache
+ *	  plan node, including the cost of reading the input data.
+ *
+ * As with cost_material, the first scan is all overhead; the point of the
+ * node is the savings on rescans, which are estimated in cost_rescan.  We
+ * charge cpu_operator_cost per cache key for hashing and looking up the
+ * parameter values, and 2x cpu_operator_cost per tuple for storing it.
+ */
+void
+cost_resultcache(Path *path, int nkeys,
+				 Cost input_startup_cost, Cost input_total_cost,
+				 double tuples)
+{
+	Cost		lookup_cost = cpu_operator_cost * (nkeys + 1);
+
+	path->rows = tuples;
+	path->startup_cost = input_startup_cost + lookup_cost;
+	path->total_cost = input_total_cost + lookup_cost +
+		2 * cpu_operator_cost * tuples;
+}
+
 /*
  * cost_agg
  *		Determines and returns the cost of performing an Agg plan node,
@@ -2887,6 +3076,52 @@ cost_rescan(PlannerInfo *root, Path *path,
 				*rescan_total_cost = run_cost;
 			}
 			break;
+		case T_ResultCache:
+			{
+				/*
+				 * A rescan either finds the results for the new parameter
+				 * values in the cache, and returns them for cpu_operator_cost
+				 * per tuple as a Material node would, or misses and must
+				 * rescan the subpath, storing its output as it goes.  We
+				 * expect the first call for each distinct set of values to
+				 * miss, and the others to hit as long as all the distinct
+				 * results fit in work_mem together; if they don't, assume
+				 * that the fraction of them that fits is what gets hit.
+				 */
+				ResultCachePath *rcpath = (ResultCachePath *) path;
+				Cost		lookup_cost;
+				Cost		sub_startup_cost;
+				Cost		sub_total_cost;
+				double		calls = Max(rcpath->calls, 1.0);
+				double		ndistinct = Max(rcpath->ndistinct, 1.0);
+				double		entry_bytes;
+				double		cache_entries;
+				double		hit_ratio;
+
+				cost_rescan(root, rcpath->subpath,
+							&sub_startup_cost, &sub_total_cost);
+
+				entry_bytes = relation_byte_size(path->rows,
+												 path->parent->width) +
+					MAXALIGN(sizeof(Datum) * list_length(rcpath->param_exprs)) +
+					64;
+				cache_entries = floor(work_mem * 1024.0 / entry_bytes);
+
+				hit_ratio = Max(calls - ndistinct, 0.0) / calls;
+				if (cache_entries < ndistinct)
+					hit_ratio *= cache_entries / ndistinct;
+
+				lookup_cost = cpu_operator_cost *
+					(list_length(rcpath->param_exprs) + 1);
+
+				*rescan_startup_cost = lookup_cost +
+					(1.0 - hit_ratio) * sub_startup_cost;
+				*rescan_total_cost = lookup_cost +
+					hit_ratio * cpu_operator_cost * path->rows +
+					(1.0 - hit_ratio) *
+					(sub_total_cost + 2 * cpu_operator_cost * path->rows);
+			}
+			break;
 		default:
 			*rescan_startup_cost = path->startup_cost;
 			*rescan_total_cost = path->total_cost;
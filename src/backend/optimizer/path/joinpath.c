@@ -17,9 +17,12 @@
 #include <math.h>
 
 #include "executor/executor.h"
+#include "optimizer/clauses.h"
 #include "optimizer/cost.h"
 #include "optimizer/pathnode.h"
 #include "optimizer/paths.h"
+#include "optimizer/var.h"
+#include "utils/selfuncs.h"
 
 
 #define PATH_PARAM_BY_REL(path, rel)  \
@@ -36,6 +39,9 @@ static void match_unsorted_outer(PlannerInfo *root, RelOptInfo *joinrel,
 					 JoinType jointype, SpecialJoinInfo *sjinfo,
 					 SemiAntiJoinFactors *semifactors,
 					 Relids param_source_rels, Relids extra_lateral_rels);
+static Path *get_resultcache_path(PlannerInfo *root, RelOptInfo *innerrel,
+					 RelOptInfo *outerrel, Path *innerpath,
+					 Path *outerpath, JoinType jointype);
 static void hash_inner_and_outer(PlannerInfo *root, RelOptInfo *joinrel,
 					 RelOptInfo *outerrel, RelOptInfo *innerrel,
 					 List *restrictlist,
@@ -699,6 +705,100 @@ sort_inner_and_outer(PlannerInfo *root,
 	}
 }
 
+/*
+ * get_resultcache_path
+ *	  If it looks worthwhile, build a ResultCache path on top of 'innerpath',
+ *	  a path parameterized by 'outerrel', for use as the inner side of a
+ *	  nestloop with 'outerpath' as the outer side.  Returns NULL otherwise.
+ *
+ * Caching only pays off if the outer side produces the same parameter
+ * values repeatedly, so we insist that the number of outer rows be at least
+ * twice the estimated number of distinct parameter values; below that, the
+ * lookup overhead is unlikely to be recovered, and the estimates are too
+ * rough to bother.  The cost model in cost_rescan then decides whether the
+ * cached path is actually cheaper.
+ */
+static Path *
+get_resultcache_path(PlannerInfo *root, RelOptInfo *innerrel,
+					 RelOptInfo *outerrel, Path *innerpath,
+					 Path *outerpath, JoinType jointype)
+{
+	ParamPathInfo *param_info = innerpath->param_info;
+	List	   *param_exprs = NIL;
+	double		calls;
+	double		ndistinct;
+	ListCell   *lc;
+
+	if (!enable_resultcache)
+		return NULL;
+
+	/*
+	 * The cached results are all the inner rows for the parameter values,
+	 * so the join must want to see all of them; a semi or anti join may stop
+	 * reading the inner side early.
+	 */
+	if (jointype != JOIN_INNER && jointype != JOIN_LEFT)
+		return NULL;
+
+	/*
+	 * We handle only plain relation scans parameterized by join clauses to
+	 * the outer rel.  Anything that might give different results for the
+	 * same parameter values, such as a volatile restriction clause, rules
+	 * out caching.
+	 */
+	if (param_info == NULL ||
+		!bms_is_subset(param_info->ppi_req_outer, outerrel->relids) ||
+		innerrel->reloptkind != RELOPT_BASEREL ||
+		innerrel->rtekind != RTE_RELATION ||
+		innerrel->lateral_relids != NULL ||
+		contain_volatile_functions((Node *) innerrel->baserestrictinfo))
+		return NULL;
+
+	/*
+	 * The cache keys are the outer rel's Vars that the parameterizing
+	 * clauses use, which become the subpath's nestloop Params.  We can't
+	 * deal with PlaceHolderVars.  The executor compares key values bytewise,
+	 * so any key type will do.
+	 */
+	foreach(lc, param_info->ppi_clauses)
+	{
+		RestrictInfo *rinfo = (RestrictInfo *) lfirst(lc);
+		List	   *vars;
+		ListCell   *lc2;
+
+		if (contain_volatile_functions((Node *) rinfo->clause))
+			return NULL;
+
+		vars = pull_var_clause((Node *) rinfo->clause,
+							   PVC_REJECT_AGGREGATES,
+							   PVC_INCLUDE_PLACEHOLDERS);
+		foreach(lc2, vars)
+		{
+			Var		   *var = (Var *) lfirst(lc2);
+
+			if (!IsA(var, Var))
+				return NULL;
+			if (!bms_is_member(var->varno, outerrel->relids) ||
+				list_member(param_exprs, var))
+				continue;
+
+			param_exprs = lappend(param_exprs, var);
+		}
+		list_free(vars);
+	}
+
+	if (param_exprs == NIL)
+		return NULL;
+
+	calls = outerpath->rows;
+	ndistinct = estimate_num_groups(root, param_exprs, calls);
+	if (calls < 2.0 * ndistinct)
+		return NULL;
+
+	return (Path *) create_resultcache_path(innerrel, innerpath,
+											param_exprs, calls, ndistinct);
+}
+
 /*
  * match_unsorted_outer
  *	  Creates possible join paths for processing a single join relation
@@ -896,6 +996,7 @@ match_unsorted_outer(PlannerInfo *root,
 			foreach(lc2, innerrel->cheapest_parameterized_paths)
 			{
 				Path	   *innerpath = (Path *) lfirst(lc2);
+				Path	   *rcpath;
 
 				try_nestloop_path(root,
 								  joinrel,
@@ -908,6 +1009,26 @@ match_unsorted_outer(PlannerInfo *root,
 								  innerpath,
 								  restrictlist,
 								  merge_pathkeys);
+
+				/*
+				 * Also consider caching the inner path's results for each
+				 * set of parameter values, if the outer side is likely to
+				 * repeat them.
+				 */
+				rcpath = get_resultcache_path(root, innerrel, outerrel,
+											  innerpath, outerpath, jointype);
+				if (rcpath != NULL)
+					try_nestloop_path(root,
+									  joinrel,
+									  jointype,
+									  sjinfo,
+									  semifactors,
+									  param_source_rels,
+									  extra_lateral_rels,
+									  outerpath,
+									  rcpath,
+									  restrictlist,
+									  merge_pathkeys);
 			}
 
 			/* Also consider materialized form of the cheapest inner path */
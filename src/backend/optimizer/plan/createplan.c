@@ -51,11 +51,19 @@ static Plan *create_gating_plan(PlannerInfo *root, Plan *plan, List *quals);
 static Plan *create_join_plan(PlannerInfo *root, JoinPath *best_path);
 static Plan *create_append_plan(PlannerInfo *root, AppendPath *best_path);
 static Plan *create_merge_append_plan(PlannerInfo *root, MergeAppendPath *best_path);
+static void make_prune_info(PlannerInfo *root, List *subpaths,
+				List **prune_quals, List **prune_constraints);
+static bool contain_param_walker(Node *node, void *context);
 static Result *create_result_plan(PlannerInfo *root, ResultPath *best_path);
 static Material *create_material_plan(PlannerInfo *root, MaterialPath *best_path);
+static ResultCache *create_resultcache_plan(PlannerInfo *root,
+						ResultCachePath *best_path);
 static Plan *create_unique_plan(PlannerInfo *root, UniquePath *best_path);
 static SeqScan *create_seqscan_plan(PlannerInfo *root, Path *best_path,
 					List *tlist, List *scan_clauses);
+static ParallelSeqScan *create_parallelseqscan_plan(PlannerInfo *root,
+							ParallelSeqScanPath *best_path,
+							List *tlist, List *scan_clauses);
 static Scan *create_indexscan_plan(PlannerInfo *root, IndexPath *best_path,
 					  List *tlist, List *scan_clauses, bool indexonly);
 static BitmapHeapScan *create_bitmap_scan_plan(PlannerInfo *root,
@@ -79,6 +87,7 @@ static ForeignScan *create_foreignscan_plan(PlannerInfo *root, ForeignPath *best
 						List *tlist, List *scan_clauses);
 static NestLoop *create_nestloop_plan(PlannerInfo *root, NestPath *best_path,
 					 Plan *outer_plan, Plan *inner_plan);
+static void set_nestloop_batch_keys(NestLoop *join_plan, NestPath *best_path);
 static MergeJoin *create_mergejoin_plan(PlannerInfo *root, MergePath *best_path,
 					  Plan *outer_plan, Plan *inner_plan);
 static HashJoin *create_hashjoin_plan(PlannerInfo *root, HashPath *best_path,
@@ -95,6 +104,8 @@ static List *order_qual_clauses(PlannerInfo *root, List *clauses);
 static void copy_path_costsize(Plan *dest, Path *src);
 static void copy_plan_costsize(Plan *dest, Plan *src);
 static SeqScan *make_seqscan(List *qptlist, List *qpqual, Index scanrelid);
+static ParallelSeqScan *make_parallelseqscan(List *qptlist, List *qpqual,
+					 Index scanrelid, int num_workers);
 static IndexScan *make_indexscan(List *qptlist, List *qpqual, Index scanrelid,
 			   Oid indexid, List *indexqual, List *indexqualorig,
 			   List *indexorderby, List *indexorderbyorig,
@@ -166,6 +177,8 @@ static EquivalenceMember *find_ec_member_for_tle(EquivalenceClass *ec,
 					   TargetEntry *tle,
 					   Relids relids);
 static Material *make_material(Plan *lefttree);
+static ResultCache *make_resultcache(Plan *lefttree, int numKeys,
+				 List *param_exprs);
 
 
 /*
@@ -223,6 +236,7 @@ create_plan_recurse(PlannerInfo *root, Path *best_path)
 	switch (best_path->pathtype)
 	{
 		case T_SeqScan:
+		case T_ParallelSeqScan:
 		case T_IndexScan:
 		case T_IndexOnlyScan:
 		case T_BitmapHeapScan:
@@ -257,6 +271,10 @@ create_plan_recurse(PlannerInfo *root, Path *best_path)
 			plan = (Plan *) create_material_plan(root,
 												 (MaterialPath *) best_path);
 			break;
+		case T_ResultCache:
+			plan = (Plan *) create_resultcache_plan(root,
+												(ResultCachePath *) best_path);
+			break;
 		case T_Unique:
 			plan = create_unique_plan(root,
 									  (UniquePath *) best_path);
@@ -290,8 +308,13 @@ create_scan_plan(PlannerInfo *root, Path *best_path)
 	 * optimize away projection of the table tuples, if possible.  (Note that
 	 * planner.c may replace the tlist we generate here, forcing projection to
 	 * occur.)
+	 *
+	 * But a bitmap heap scan that needn't return any columns at all is better
+	 * off with an empty tlist, because then the executor can skip fetching
+	 * heap pages whose tuples are all visible; see nodeBitmapHeapscan.c.
 	 */
-	if (use_physical_tlist(root, rel))
+	if (use_physical_tlist(root, rel) &&
+		!(best_path->pathtype == T_BitmapHeapScan && rel->reltargetlist == NIL))
 	{
 		if (best_path->pathtype == T_IndexOnlyScan)
 		{
@@ -337,6 +360,13 @@ create_scan_plan(PlannerInfo *root, Path *best_path)
 												scan_clauses);
 			break;
 
+		case T_ParallelSeqScan:
+			plan = (Plan *) create_parallelseqscan_plan(root,
+											(ParallelSeqScanPath *) best_path,
+														tlist,
+														scan_clauses);
+			break;
+
 		case T_IndexScan:
 			plan = (Plan *) create_indexscan_plan(root,
 												  (IndexPath *) best_path,
@@ -533,6 +563,7 @@ disuse_physical_tlist(PlannerInfo *root, Plan *plan, Path *path)
 	switch (path->pathtype)
 	{
 		case T_SeqScan:
+		case T_ParallelSeqScan:
 		case T_IndexScan:
 		case T_IndexOnlyScan:
 		case T_BitmapHeapScan:
@@ -717,6 +748,9 @@ create_append_plan(PlannerInfo *root, AppendPath *best_path)
 
 	plan = make_append(subplans, tlist);
 
+	make_prune_info(root, best_path->subpaths,
+					&plan->prune_quals, &plan->prune_constraints);
+
 	return (Plan *) plan;
 }
 
@@ -818,9 +852,115 @@ create_merge_append_plan(PlannerInfo *root, MergeAppendPath *best_path)
 
 	node->mergeplans = subplans;
 
+	make_prune_info(root, best_path->subpaths,
+					&node->prune_quals, &node->prune_constraints);
+
 	return (Plan *) node;
 }
 
+/*
+ * make_prune_info
+ *	  Collect what the executor needs to prune the children of an Append or
+ *	  MergeAppend at run time.
+ *
+ * relation_excluded_by_constraints has already tried to prove that each
+ * child can't return any rows, but it couldn't make use of clauses that
+ * compare against Params, such as the parameters of a generic prepared
+ * plan, the outputs of initplans, or values supplied by an outer nestloop.
+ * The executor can retry the proof once it knows those values, so for each
+ * child we give it those clauses together with the child's constraints.
+ * The results are left NIL if no child can benefit.
+ */
+static void
+make_prune_info(PlannerInfo *root, List *subpaths,
+				List **prune_quals, List **prune_constraints)
+{
+	bool		useful = false;
+	ListCell   *lc;
+
+	*prune_quals = NIL;
+	*prune_constraints = NIL;
+
+	foreach(lc, subpaths)
+	{
+		Path	   *subpath = (Path *) lfirst(lc);
+		RelOptInfo *rel = subpath->parent;
+		List	   *quals = NIL;
+		List	   *constraints = NIL;
+		ListCell   *lc2;
+
+		/* Only inheritance children can have constraints to test */
+		if (rel->reloptkind != RELOPT_OTHER_MEMBER_REL)
+		{
+			*prune_quals = lappend(*prune_quals, NIL);
+			*prune_constraints = lappend(*prune_constraints, NIL);
+			continue;
+		}
+
+		foreach(lc2, rel->baserestrictinfo)
+		{
+			RestrictInfo *rinfo = (RestrictInfo *) lfirst(lc2);
+
+			if (contain_param_walker((Node *) rinfo->clause, NULL) &&
+				!contain_volatile_functions((Node *) rinfo->clause) &&
+				!contain_subplans((Node *) rinfo->clause))
+				quals = lappend(quals, rinfo->clause);
+		}
+
+		/*
+		 * For a parameterized path, the join clauses it enforces compare
+		 * against the outer relation's values, which become Params.
+		 */
+		if (subpath->param_info)
+		{
+			List	   *joinquals = NIL;
+
+			foreach(lc2, subpath->param_info->ppi_clauses)
+			{
+				RestrictInfo *rinfo = (RestrictInfo *) lfirst(lc2);
+
+				if (!contain_volatile_functions((Node *) rinfo->clause) &&
+					!contain_subplans((Node *) rinfo->clause))
+					joinquals = lappend(joinquals, rinfo->clause);
+			}
+			quals = list_concat(quals, (List *)
+								replace_nestloop_params(root,
+														(Node *) joinquals));
+		}
+
+		if (quals != NIL)
+			constraints = relation_pruning_constraints(root, rel,
+											planner_rt_fetch(rel->relid, root));
+		if (constraints == NIL)
+			quals = NIL;
+		else
+			useful = true;
+
+		*prune_quals = lappend(*prune_quals, quals);
+		*prune_constraints = lappend(*prune_constraints, constraints);
+	}
+
+	if (!useful)
+	{
+		*prune_quals = NIL;
+		*prune_constraints = NIL;
+	}
+}
+
+/*
+ * contain_param_walker
+ *	  Does the expression contain any Params?
+ */
+static bool
+contain_param_walker(Node *node, void *context)
+{
+	if (node == NULL)
+		return false;
+	if (IsA(node, Param))
+		return true;
+	return expression_tree_walker(node, contain_param_walker, context);
+}
+
 /*
  * create_result_plan
  *	  Create a Result plan for 'best_path'.
@@ -870,6 +1010,39 @@ create_material_plan(PlannerInfo *root, MaterialPath *best_path)
 	return plan;
 }
 
+/*
+ * create_resultcache_plan
+ *	  Create a ResultCache plan for 'best_path' and (recursively) plans
+ *	  for its subpaths.
+ *
+ *	  Returns a Plan node.
+ */
+static ResultCache *
+create_resultcache_plan(PlannerInfo *root, ResultCachePath *best_path)
+{
+	ResultCache *plan;
+	Plan	   *subplan;
+	List	   *param_exprs;
+
+	subplan = create_plan_recurse(root, best_path->subpath);
+
+	/* We don't want any excess columns in the cached tuples */
+	disuse_physical_tlist(root, subplan, best_path->subpath);
+
+	/*
+	 * The cache keys are outer-relation Vars, which we must replace with the
+	 * same nestloop Params the subplan uses for them.
+	 */
+	param_exprs = (List *)
+		replace_nestloop_params(root, (Node *) best_path->param_exprs);
+
+	plan = make_resultcache(subplan, list_length(param_exprs), param_exprs);
+
+	copy_path_costsize(&plan->plan, (Path *) best_path);
+
+	return plan;
+}
+
 /*
  * create_unique_plan
  *	  Create a Unique plan for 'best_path' and (recursively) plans
@@ -1015,6 +1188,7 @@ create_unique_plan(PlannerInfo *root, UniquePath *best_path)
 								 numGroupCols,
 								 groupColIdx,
 								 groupOperators,
+								 NIL,
 								 numGroups,
 								 subplan);
 	}
@@ -1118,6 +1292,40 @@ create_seqscan_plan(PlannerInfo *root, Path *best_path,
 	return scan_plan;
 }
 
+/*
+ * create_parallelseqscan_plan
+ *	 Returns a parallel seqscan plan for the base relation scanned by
+ *	 'best_path' with restriction clauses 'scan_clauses' and targetlist
+ *	 'tlist'.
+ */
+static ParallelSeqScan *
+create_parallelseqscan_plan(PlannerInfo *root, ParallelSeqScanPath *best_path,
+							List *tlist, List *scan_clauses)
+{
+	ParallelSeqScan *scan_plan;
+	Index		scan_relid = best_path->path.parent->relid;
+
+	/* it should be an unparameterized base rel... */
+	Assert(scan_relid > 0);
+	Assert(best_path->path.parent->rtekind == RTE_RELATION);
+	Assert(best_path->path.param_info == NULL);
+
+	/* Sort clauses into best execution order */
+	scan_clauses = order_qual_clauses(root, scan_clauses);
+
+	/* Reduce RestrictInfo list to bare expressions; ignore pseudoconstants */
+	scan_clauses = extract_actual_clauses(scan_clauses, false);
+
+	scan_plan = make_parallelseqscan(tlist,
+									 scan_clauses,
+									 scan_relid,
+									 best_path->num_workers);
+
+	copy_path_costsize(&scan_plan->scan.plan, &best_path->path);
+
+	return scan_plan;
+}
+
 /*
  * create_indexscan_plan
  *	  Returns an indexscan plan for the base relation scanned by 'best_path'
@@ -2101,9 +2309,148 @@ create_nestloop_plan(PlannerInfo *root,
 
 	copy_path_costsize(&join_plan->join.plan, &best_path->path);
 
+	set_nestloop_batch_keys(join_plan, best_path);
+
 	return join_plan;
 }
 
+/*
+ * set_nestloop_batch_keys
+ *	  Decide whether the executor should probe the inner side of a nestloop
+ *	  in sorted batches of outer rows, and if so, by which keys.
+ *
+ * That pays off when the inner side is a btree index scan driven by the
+ * nestloop's Params: probing in key order means that consecutive descents
+ * touch the same or neighbouring index pages, which are then still in
+ * cache.  The sort keys are the Params compared to the leading index
+ * columns, in column order.  We don't try to cost this; the executor starts
+ * with tiny batches and grows them only while the outer side keeps
+ * producing rows, so the overhead for small outer inputs is negligible.
+ */
+static void
+set_nestloop_batch_keys(NestLoop *join_plan, NestPath *best_path)
+{
+	Plan	   *inner_plan = join_plan->join.plan.righttree;
+	IndexPath  *ipath;
+	IndexOptInfo *index;
+	List	   *indexqual;
+	int			nkeys;
+	int			indexcol;
+
+	if (!enable_batched_nestloop || join_plan->nestParams == NIL)
+		return;
+	if (best_path->outerjoinpath->rows <= 1)
+		return;
+
+	if (!IsA(best_path->innerjoinpath, IndexPath))
+		return;
+	ipath = (IndexPath *) best_path->innerjoinpath;
+	index = ipath->indexinfo;
+	if (index->sortopfamily == NULL)
+		return;
+
+	if (IsA(inner_plan, IndexScan))
+		indexqual = ((IndexScan *) inner_plan)->indexqual;
+	else if (IsA(inner_plan, IndexOnlyScan))
+		indexqual = ((IndexOnlyScan *) inner_plan)->indexqual;
+	else
+		return;
+
+	/*
+	 * Reordering the probes must not change the results, so give up if
+	 * anything evaluated for them is volatile.
+	 */
+	if (contain_volatile_functions((Node *) inner_plan->targetlist) ||
+		contain_volatile_functions((Node *) inner_plan->qual) ||
+		contain_volatile_functions((Node *) indexqual) ||
+		contain_volatile_functions((Node *) join_plan->join.joinqual))
+		return;
+
+	join_plan->batchKeyParams = (int *)
+		palloc(index->ncolumns * sizeof(int));
+	join_plan->batchSortOperators = (Oid *)
+		palloc(index->ncolumns * sizeof(Oid));
+	join_plan->batchCollations = (Oid *)
+		palloc(index->ncolumns * sizeof(Oid));
+	join_plan->batchNullsFirst = (bool *)
+		palloc(index->ncolumns * sizeof(bool));
+
+	/*
+	 * Look for an "indexkey op Param" qual on each index column in turn,
+	 * where the Param is one of ours, and stop at the first column that has
+	 * none.  fix_indexqual_references has already put the index key on the
+	 * left.
+	 */
+	nkeys = 0;
+	for (indexcol = 0; indexcol < index->ncolumns; indexcol++)
+	{
+		int			keyparam = -1;
+		Oid			keytype = InvalidOid;
+		ListCell   *lc;
+
+		foreach(lc, indexqual)
+		{
+			OpExpr	   *clause = (OpExpr *) lfirst(lc);
+			Node	   *leftop;
+			Node	   *rightop;
+			Param	   *param;
+			ListCell   *lp;
+			int			pos;
+
+			if (!IsA(clause, OpExpr) || list_length(clause->args) != 2)
+				continue;
+			leftop = (Node *) linitial(clause->args);
+			rightop = (Node *) lsecond(clause->args);
+			if (leftop && IsA(leftop, RelabelType))
+				leftop = (Node *) ((RelabelType *) leftop)->arg;
+			if (!leftop || !IsA(leftop, Var) ||
+				((Var *) leftop)->varattno != indexcol + 1)
+				continue;
+
+			param = (Param *) rightop;
+			if (param && IsA(param, RelabelType))
+				param = (Param *) ((RelabelType *) param)->arg;
+			if (!param || !IsA(param, Param) ||
+				param->paramkind != PARAM_EXEC)
+				continue;
+
+			pos = 0;
+			foreach(lp, join_plan->nestParams)
+			{
+				NestLoopParam *nlp = (NestLoopParam *) lfirst(lp);
+
+				if (nlp->paramno == param->paramid)
+				{
+					keyparam = pos;
+					keytype = exprType(rightop);
+					break;
+				}
+				pos++;
+			}
+			if (keyparam >= 0)
+				break;
+		}
+
+		if (keyparam < 0)
+			break;
+
+		join_plan->batchSortOperators[nkeys] =
+			get_opfamily_member(index->sortopfamily[indexcol],
+								keytype, keytype,
+								index->reverse_sort[indexcol] ?
+								BTGreaterStrategyNumber :
+								BTLessStrategyNumber);
+		if (!OidIsValid(join_plan->batchSortOperators[nkeys]))
+			break;
+		join_plan->batchKeyParams[nkeys] = keyparam;
+		join_plan->batchCollations[nkeys] = index->indexcollations[indexcol];
+		join_plan->batchNullsFirst[nkeys] = index->nulls_first[indexcol];
+		nkeys++;
+	}
+
+	join_plan->numBatchKeys = nkeys;
+}
+
 static MergeJoin *
 create_mergejoin_plan(PlannerInfo *root,
 					  MergePath *best_path,
@@ -2409,6 +2756,7 @@ create_hashjoin_plan(PlannerInfo *root,
 	List	   *joinclauses;
 	List	   *otherclauses;
 	List	   *hashclauses;
+	List	   *filterkeys = NIL;
 	Oid			skewTable = InvalidOid;
 	AttrNumber	skewColumn = InvalidAttrNumber;
 	bool		skewInherit = false;
@@ -2461,6 +2809,40 @@ create_hashjoin_plan(PlannerInfo *root,
 	hashclauses = get_switched_clauses(best_path->path_hashclauses,
 							 best_path->jpath.outerjoinpath->parent->relids);
 
+	/*
+	 * If the outer side is a plain scan of a relation, and the join doesn't
+	 * return unmatched outer rows, the scan can discard rows that can't have
+	 * a match, using a Bloom filter built along with the hash table.  For
+	 * that, it needs the outer hash keys, which must refer to nothing but its
+	 * own relation.  We don't try to guess here whether that will pay off;
+	 * the executor stops filtering if it doesn't remove enough rows.
+	 */
+	if ((best_path->jpath.jointype == JOIN_INNER ||
+		 best_path->jpath.jointype == JOIN_SEMI ||
+		 best_path->jpath.jointype == JOIN_RIGHT) &&
+		(IsA(outer_plan, SeqScan) ||
+		 IsA(outer_plan, IndexScan) ||
+		 IsA(outer_plan, BitmapHeapScan)))
+	{
+		Index		scanrelid = ((Scan *) outer_plan)->scanrelid;
+		Relids		keyrelids;
+		ListCell   *lc;
+
+		foreach(lc, hashclauses)
+		{
+			OpExpr	   *clause = (OpExpr *) lfirst(lc);
+
+			filterkeys = lappend(filterkeys,
+								 copyObject(linitial(clause->args)));
+		}
+
+		keyrelids = pull_varnos((Node *) filterkeys);
+		if (!bms_equal(keyrelids, bms_make_singleton(scanrelid)) ||
+			contain_volatile_functions((Node *) filterkeys) ||
+			contain_subplans((Node *) filterkeys))
+			filterkeys = NIL;
+	}
+
 	/* We don't want any excess columns in the hashed tuples */
 	disuse_physical_tlist(root, inner_plan, best_path->jpath.innerjoinpath);
 
@@ -2518,6 +2900,7 @@ create_hashjoin_plan(PlannerInfo *root,
 							  outer_plan,
 							  (Plan *) hash_plan,
 							  best_path->jpath.jointype);
+	join_plan->filterkeys = filterkeys;
 
 	copy_path_costsize(&join_plan->join.plan, &best_path->jpath.path);
 
@@ -3226,6 +3609,26 @@ make_seqscan(List *qptlist,
 	return node;
 }
 
+static ParallelSeqScan *
+make_parallelseqscan(List *qptlist,
+					 List *qpqual,
+					 Index scanrelid,
+					 int num_workers)
+{
+	ParallelSeqScan *node = makeNode(ParallelSeqScan);
+	Plan	   *plan = &node->scan.plan;
+
+	/* cost should be inserted by caller */
+	plan->targetlist = qptlist;
+	plan->qual = qpqual;
+	plan->lefttree = NULL;
+	plan->righttree = NULL;
+	node->scan.scanrelid = scanrelid;
+	node->num_workers = num_workers;
+
+	return node;
+}
+
 static IndexScan *
 make_indexscan(List *qptlist,
 			   List *qpqual,
@@ -4112,6 +4515,65 @@ make_sort_from_pathkeys(PlannerInfo *root, Plan *lefttree, List *pathkeys,
 					 nullsFirst, limit_tuples);
 }
 
+/*
+ * make_incrementalsort_from_pathkeys
+ *	  Create an incremental sort plan to sort according to given pathkeys,
+ *	  when the input is already sorted by the first presortedCols of them
+ *
+ *	  'lefttree' is the node which yields input tuples
+ *	  'pathkeys' is the list of pathkeys by which the result is to be sorted
+ *	  'presortedCols' is the number of leading pathkeys lefttree satisfies
+ */
+IncrementalSort *
+make_incrementalsort_from_pathkeys(PlannerInfo *root, Plan *lefttree,
+								   List *pathkeys, int presortedCols)
+{
+	IncrementalSort *node = makeNode(IncrementalSort);
+	Plan	   *plan = &node->sort.plan;
+	Path		sort_path;		/* dummy for result of cost_incremental_sort */
+	int			numsortkeys;
+	AttrNumber *sortColIdx;
+	Oid		   *sortOperators;
+	Oid		   *collations;
+	bool	   *nullsFirst;
+
+	Assert(presortedCols > 0 && presortedCols < list_length(pathkeys));
+
+	/* Compute sort column info, and adjust lefttree as needed */
+	lefttree = prepare_sort_from_pathkeys(root, lefttree, pathkeys,
+										  NULL,
+										  NULL,
+										  false,
+										  &numsortkeys,
+										  &sortColIdx,
+										  &sortOperators,
+										  &collations,
+										  &nullsFirst);
+
+	copy_plan_costsize(plan, lefttree); /* only care about copying size */
+	cost_incremental_sort(&sort_path, root, pathkeys, presortedCols,
+						  lefttree->startup_cost,
+						  lefttree->total_cost,
+						  lefttree->plan_rows,
+						  lefttree->plan_width,
+						  0.0,
+						  work_mem);
+	plan->startup_cost = sort_path.startup_cost;
+	plan->total_cost = sort_path.total_cost;
+	plan->targetlist = lefttree->targetlist;
+	plan->qual = NIL;
+	plan->lefttree = lefttree;
+	plan->righttree = NULL;
+	node->sort.numCols = numsortkeys;
+	node->sort.sortColIdx = sortColIdx;
+	node->sort.sortOperators = sortOperators;
+	node->sort.collations = collations;
+	node->sort.nullsFirst = nullsFirst;
+	node->presortedCols = presortedCols;
+
+	return node;
+}
+
 /*
  * make_sort_from_sortclauses
  *	  Create sort plan to sort according to given sortclauses
@@ -4225,6 +4687,24 @@ make_material(Plan *lefttree)
 	return node;
 }
 
+static ResultCache *
+make_resultcache(Plan *lefttree, int numKeys, List *param_exprs)
+{
+	ResultCache *node = makeNode(ResultCache);
+	Plan	   *plan = &node->plan;
+
+	/* cost should be inserted by caller */
+	plan->targetlist = lefttree->targetlist;
+	plan->qual = NIL;
+	plan->lefttree = lefttree;
+	plan->righttree = NULL;
+
+	node->numKeys = numKeys;
+	node->param_exprs = param_exprs;
+
+	return node;
+}
+
 /*
  * materialize_finished_plan: stick a Material node atop a completed plan
  *
@@ -4265,7 +4745,7 @@ Agg *
 make_agg(PlannerInfo *root, List *tlist, List *qual,
 		 AggStrategy aggstrategy, const AggClauseCosts *aggcosts,
 		 int numGroupCols, AttrNumber *grpColIdx, Oid *grpOperators,
-		 long numGroups,
+		 List *groupingSets, long numGroups,
 		 Plan *lefttree)
 {
 	Agg		   *node = makeNode(Agg);
@@ -4278,6 +4758,10 @@ make_agg(PlannerInfo *root, List *tlist, List *qual,
 	node->grpColIdx = grpColIdx;
 	node->grpOperators = grpOperators;
 	node->numGroups = numGroups;
+	node->groupingSets = groupingSets;
+	node->combineStates = false;
+	node->finalizeAggs = true;
+	node->serialStates = false;
 
 	copy_plan_costsize(plan, lefttree); /* only care about copying size */
 	cost_agg(&agg_path, root,
@@ -4290,11 +4774,11 @@ make_agg(PlannerInfo *root, List *tlist, List *qual,
 	plan->total_cost = agg_path.total_cost;
 
 	/*
-	 * We will produce a single output tuple if not grouping, and a tuple per
-	 * group otherwise.
+	 * We will produce a single output tuple if not grouping (or one per
+	 * grouping set, if they are all empty), and a tuple per group otherwise.
 	 */
 	if (aggstrategy == AGG_PLAIN)
-		plan->plan_rows = 1;
+		plan->plan_rows = groupingSets ? list_length(groupingSets) : 1;
 	else
 		plan->plan_rows = numGroups;
 
@@ -4835,7 +5319,9 @@ is_projection_capable_plan(Plan *plan)
 	{
 		case T_Hash:
 		case T_Material:
+		case T_ResultCache:
 		case T_Sort:
+		case T_IncrementalSort:
 		case T_Unique:
 		case T_SetOp:
 		case T_LockRows:
@@ -18,10 +18,15 @@
 #include <limits.h>
 
 #include "access/htup_details.h"
+#include "access/parallel.h"
+#include "access/xact.h"
+#include "catalog/pg_aggregate.h"
+#include "catalog/pg_type.h"
 #include "executor/executor.h"
 #include "executor/nodeAgg.h"
 #include "miscadmin.h"
 #include "nodes/makefuncs.h"
+#include "nodes/nodeFuncs.h"
 #ifdef OPTIMIZER_DEBUG
 #include "nodes/print.h"
 #endif
@@ -36,10 +41,12 @@
 #include "optimizer/subselect.h"
 #include "optimizer/tlist.h"
 #include "parser/analyze.h"
+#include "parser/parse_agg.h"
 #include "parser/parsetree.h"
 #include "rewrite/rewriteManip.h"
 #include "utils/rel.h"
 #include "utils/selfuncs.h"
+#include "utils/syscache.h"
 
 
 /* GUC parameter */
@@ -65,6 +72,7 @@ typedef struct
 {
 	List	   *tlist;			/* preprocessed query targetlist */
 	List	   *activeWindows;	/* active windows, if any */
+	List	   *groupClause;	/* overrides parse->groupClause */
 } standard_qp_extra;
 
 /* Local functions */
@@ -78,6 +86,28 @@ static double preprocess_limit(PlannerInfo *root,
 				 int64 *offset_est, int64 *count_est);
 static bool limit_needed(Query *parse);
 static void preprocess_groupclause(PlannerInfo *root);
+static List *extract_rollup_sets(List *groupingSets);
+static List *reorder_grouping_sets(List *groupingSets);
+static List *groupclause_for_set(List *groupClause, List *gset);
+static double estimate_grouping_set_groups(PlannerInfo *root, List *gsets,
+							 List *groupClause, double path_rows);
+static bool choose_hashed_grouping_sets(PlannerInfo *root,
+							double path_rows, int path_width,
+							Path *cheapest_path, Path *sorted_path,
+							List *rollup_groupclauses,
+							double dNumGroups, AggClauseCosts *agg_costs);
+static Plan *build_grouping_chain(PlannerInfo *root, List *tlist,
+					 bool use_hashed_grouping, AggClauseCosts *agg_costs,
+					 List *rollup_lists, List *rollup_groupclauses,
+					 bool need_sort_for_grouping, double path_rows,
+					 Plan *result_plan);
+static AttrNumber *remap_groupColIdx(PlannerInfo *root, List *groupClause);
+static Plan *make_partial_agg_plan(PlannerInfo *root, List *tlist,
+					  AggStrategy aggstrategy,
+					  const AggClauseCosts *aggcosts,
+					  int numGroupCols, AttrNumber *grpColIdx,
+					  Oid *grpOperators, long numGroups,
+					  Plan *input_plan, bool input_sorted);
 static void standard_qp_callback(PlannerInfo *root, void *extra);
 static bool choose_hashed_grouping(PlannerInfo *root,
 					   double tuple_fraction, double limit_tuples,
@@ -91,6 +121,14 @@ static bool choose_hashed_distinct(PlannerInfo *root,
 					   Cost sorted_startup_cost, Cost sorted_total_cost,
 					   List *sorted_pathkeys,
 					   double dNumDistinctRows);
+static Path *choose_incremental_sort_path(PlannerInfo *root,
+							 RelOptInfo *final_rel,
+							 Path *cheapest_path, Path *sorted_path,
+							 double path_rows, int path_width,
+							 double tuple_fraction);
+static bool use_incremental_sort(PlannerInfo *root, Plan *plan,
+					 List *pathkeys, int presorted_keys,
+					 double tuple_fraction, double limit_tuples);
 static List *make_subplanTargetList(PlannerInfo *root, List *tlist,
 					   AttrNumber **groupColIdx, bool *need_tlist_eval);
 static int	get_grouping_column_index(Query *parse, TargetEntry *tle);
@@ -178,6 +216,21 @@ standard_planner(Query *parse, int cursorOptions, ParamListInfo boundParams)
 	glob->lastRowMarkId = 0;
 	glob->transientPlan = false;
 
+	/*
+	 * Parallel workers may only be used for a read-only query that will be
+	 * run to completion in one go; a cursor could be left open across a
+	 * subtransaction boundary, or used after the master has written data
+	 * that the workers can't see.  The executor makes further checks, since
+	 * a plan may be executed in a different transaction than it was made in.
+	 */
+	glob->parallelModeOK = (cursorOptions & CURSOR_OPT_PARALLEL_OK) != 0 &&
+		max_parallel_degree > 0 &&
+		parse->commandType == CMD_SELECT &&
+		parse->utilityStmt == NULL &&
+		!parse->hasModifyingCTE &&
+		!IsParallelWorker() &&
+		!IsolationIsSerializable();
+
 	/* Determine what fraction of the plan is likely to be scanned */
 	if (cursorOptions & CURSOR_OPT_FAST_PLAN)
 	{
@@ -519,6 +572,11 @@ subquery_planner(PlannerGlobal *glob, Query *parse,
 	 * don't emit a bogus aggregated row. (This could be done better, but it
 	 * seems not worth optimizing.)
 	 *
+	 * With grouping sets, a grouping column can read as NULL in the rows
+	 * of sets that don't include it, so evaluating a HAVING clause against
+	 * the input rows could give a different answer.  We therefore leave all
+	 * of HAVING alone in that case.
+	 *
 	 * Note that both havingQual and parse->jointree->quals are in
 	 * implicitly-ANDed-list form at this point, even though they are declared
 	 * as Node *.
@@ -528,7 +586,8 @@ subquery_planner(PlannerGlobal *glob, Query *parse,
 	{
 		Node	   *havingclause = (Node *) lfirst(l);
 
-		if (contain_agg_clause(havingclause) ||
+		if (parse->groupingSets ||
+			contain_agg_clause(havingclause) ||
 			contain_volatile_functions(havingclause) ||
 			contain_subplans(havingclause))
 		{
@@ -1050,6 +1109,7 @@ grouping_planner(PlannerInfo *root, double tuple_fraction)
 	double		dNumGroups = 0;
 	bool		use_hashed_distinct = false;
 	bool		tested_hashed_distinct = false;
+	bool		incremental_sort_ok = false;
 
 	/* Tweak caller-supplied tuple_fraction if have LIMIT/OFFSET */
 	if (parse->limitCount || parse->limitOffset)
@@ -1148,15 +1208,56 @@ grouping_planner(PlannerInfo *root, double tuple_fraction)
 		bool		use_hashed_grouping = false;
 		WindowFuncLists *wflists = NULL;
 		List	   *activeWindows = NIL;
+		List	   *rollup_lists = NIL;
+		List	   *rollup_groupclauses = NIL;
 
 		MemSet(&agg_costs, 0, sizeof(AggClauseCosts));
 
 		/* A recursive query should always have setOperations */
 		Assert(!root->hasRecursion);
 
-		/* Preprocess GROUP BY clause, if any */
-		if (parse->groupClause)
-			preprocess_groupclause(root);
+		if (parse->groupingSets)
+		{
+			/*
+			 * Expand the grouping sets into a flat list of sets of
+			 * sortgrouprefs, and divide them into rollups, each of which can
+			 * be computed from a single sort order.  Note that we leave
+			 * parse->groupClause alone: it lists every column used in any
+			 * set, which is what make_subplanTargetList wants.
+			 */
+			parse->groupingSets = expand_grouping_sets(parse->groupingSets,
+													   -1);
+
+			if (parse->groupClause)
+			{
+				ListCell   *lc;
+
+				foreach(lc, extract_rollup_sets(parse->groupingSets))
+				{
+					List	   *current_sets;
+
+					current_sets = reorder_grouping_sets((List *) lfirst(lc));
+					rollup_lists = lappend(rollup_lists, current_sets);
+					rollup_groupclauses =
+						lappend(rollup_groupclauses,
+								groupclause_for_set(parse->groupClause,
+													linitial(current_sets)));
+				}
+			}
+			else
+			{
+				/* Only empty grouping sets, eg GROUP BY (), () */
+				rollup_lists = list_make1(parse->groupingSets);
+				rollup_groupclauses = list_make1(NIL);
+			}
+		}
+		else
+		{
+			/* Preprocess GROUP BY clause, if any */
+			if (parse->groupClause)
+				preprocess_groupclause(root);
+			rollup_groupclauses = list_make1(parse->groupClause);
+		}
 		numGroupCols = list_length(parse->groupClause);
 
 		/* Preprocess targetlist */
@@ -1222,6 +1323,7 @@ grouping_planner(PlannerInfo *root, double tuple_fraction)
 		 * grouping/aggregation operations.
 		 */
 		if (parse->groupClause ||
+			parse->groupingSets ||
 			parse->distinctClause ||
 			parse->hasAggs ||
 			parse->hasWindowFuncs ||
@@ -1233,6 +1335,7 @@ grouping_planner(PlannerInfo *root, double tuple_fraction)
 		/* Set up data needed by standard_qp_callback */
 		qp_extra.tlist = tlist;
 		qp_extra.activeWindows = activeWindows;
+		qp_extra.groupClause = (List *) linitial(rollup_groupclauses);
 
 		/*
 		 * Generate the best unsorted and presorted paths for this Query (but
@@ -1261,7 +1364,20 @@ grouping_planner(PlannerInfo *root, double tuple_fraction)
 		 */
 		dNumGroups = 1;			/* in case not grouping */
 
-		if (parse->groupClause)
+		if (parse->groupingSets)
+		{
+			/*
+			 * Every grouping set contributes its own groups.  We don't try to
+			 * exploit the sort order of the output, so we'll certainly have
+			 * to read all the input.
+			 */
+			dNumGroups = estimate_grouping_set_groups(root,
+													  parse->groupingSets,
+													  parse->groupClause,
+													  path_rows);
+			tuple_fraction = 0.0;
+		}
+		else if (parse->groupClause)
 		{
 			List	   *groupExprs;
 
@@ -1391,10 +1507,43 @@ grouping_planner(PlannerInfo *root, double tuple_fraction)
 			}
 		}
 
+		/*
+		 * If the ORDER BY is the only ordering we need, a path sorted by just
+		 * a leading part of it can be finished off with an incremental sort,
+		 * which may beat both of the alternatives above; especially under a
+		 * LIMIT, since it can return rows without reading all of its input.
+		 */
+		if (enable_incremental_sort && parse->sortClause &&
+			root->query_pathkeys != NIL &&
+			root->query_pathkeys == root->sort_pathkeys &&
+			!parse->groupClause && !parse->groupingSets &&
+			!parse->hasAggs && !root->hasHavingQual &&
+			!activeWindows && !parse->distinctClause)
+		{
+			incremental_sort_ok = true;
+			sorted_path = choose_incremental_sort_path(root, final_rel,
+													   cheapest_path,
+													   sorted_path,
+													   path_rows,
+													   path_width,
+													   tuple_fraction);
+		}
+
 		/*
 		 * Consider whether we want to use hashing instead of sorting.
 		 */
-		if (parse->groupClause)
+		if (parse->groupingSets)
+		{
+			if (parse->groupClause)
+				use_hashed_grouping =
+					choose_hashed_grouping_sets(root,
+												path_rows, path_width,
+												cheapest_path, sorted_path,
+												rollup_groupclauses,
+												dNumGroups, &agg_costs);
+			numGroups = (long) Min(dNumGroups, (double) LONG_MAX);
+		}
+		else if (parse->groupClause)
 		{
 			/*
 			 * If grouping, decide whether to use sorted or hashed grouping.
@@ -1535,8 +1684,51 @@ grouping_planner(PlannerInfo *root, double tuple_fraction)
 			 *
 			 * HAVING clause, if any, becomes qual of the Agg or Group node.
 			 */
-			if (use_hashed_grouping)
+			if (parse->groupingSets)
+			{
+				/*
+				 * root->grouping_map lets setrefs.c convert the arguments of
+				 * any GROUPING() calls into input column numbers.
+				 */
+				if (parse->groupClause)
+				{
+					ListCell   *lc;
+					Index		maxref = 0;
+					int			i = 0;
+
+					foreach(lc, parse->groupClause)
+					{
+						SortGroupClause *gc = (SortGroupClause *) lfirst(lc);
+
+						maxref = Max(maxref, gc->tleSortGroupRef);
+					}
+					root->grouping_map = (AttrNumber *)
+						palloc0((maxref + 1) * sizeof(AttrNumber));
+					foreach(lc, parse->groupClause)
+					{
+						SortGroupClause *gc = (SortGroupClause *) lfirst(lc);
+
+						root->grouping_map[gc->tleSortGroupRef] =
+							groupColIdx[i++];
+					}
+				}
+
+				result_plan = build_grouping_chain(root, tlist,
+												   use_hashed_grouping,
+												   &agg_costs,
+												   rollup_lists,
+												   rollup_groupclauses,
+												   need_sort_for_grouping,
+												   path_rows,
+												   result_plan);
+				/* The output isn't usefully ordered, see above */
+				current_pathkeys = NIL;
+			}
+			else if (use_hashed_grouping)
 			{
+				Plan	   *agg_input = result_plan;
+				Plan	   *partial_plan;
+
 				/* Hashed aggregate plan --- no sort needed */
 				result_plan = (Plan *) make_agg(root,
 												tlist,
@@ -1546,8 +1738,24 @@ grouping_planner(PlannerInfo *root, double tuple_fraction)
 												numGroupCols,
 												groupColIdx,
 									extract_grouping_ops(parse->groupClause),
+												NIL,
 												numGroups,
-												result_plan);
+												agg_input);
+
+				/* Maybe aggregating each member of an Append is cheaper */
+				partial_plan = make_partial_agg_plan(root,
+													 tlist,
+													 AGG_HASHED,
+													 &agg_costs,
+													 numGroupCols,
+													 groupColIdx,
+									extract_grouping_ops(parse->groupClause),
+													 numGroups,
+													 agg_input,
+													 false);
+				if (partial_plan &&
+					partial_plan->total_cost < result_plan->total_cost)
+					result_plan = partial_plan;
 				/* Hashed aggregation produces randomly-ordered results */
 				current_pathkeys = NIL;
 			}
@@ -1555,6 +1763,8 @@ grouping_planner(PlannerInfo *root, double tuple_fraction)
 			{
 				/* Plain aggregate plan --- sort if needed */
 				AggStrategy aggstrategy;
+				Plan	   *agg_input = result_plan;
+				Plan	   *partial_plan;
 
 				if (parse->groupClause)
 				{
@@ -1589,8 +1799,24 @@ grouping_planner(PlannerInfo *root, double tuple_fraction)
 												numGroupCols,
 												groupColIdx,
 									extract_grouping_ops(parse->groupClause),
+												NIL,
 												numGroups,
 												result_plan);
+
+				/* Maybe aggregating each member of an Append is cheaper */
+				partial_plan = make_partial_agg_plan(root,
+													 tlist,
+													 aggstrategy,
+													 &agg_costs,
+													 numGroupCols,
+													 groupColIdx,
+									extract_grouping_ops(parse->groupClause),
+													 numGroups,
+													 agg_input,
+													 !need_sort_for_grouping);
+				if (partial_plan &&
+					partial_plan->total_cost < result_plan->total_cost)
+					result_plan = partial_plan;
 			}
 			else if (parse->groupClause)
 			{
@@ -1804,7 +2030,8 @@ grouping_planner(PlannerInfo *root, double tuple_fraction)
 		 * result was already mostly unique).  If not, use the number of
 		 * distinct-groups calculated previously.
 		 */
-		if (parse->groupClause || root->hasHavingQual || parse->hasAggs)
+		if (parse->groupClause || parse->groupingSets ||
+			root->hasHavingQual || parse->hasAggs)
 			dNumDistinctRows = result_plan->plan_rows;
 		else
 			dNumDistinctRows = dNumGroups;
@@ -1845,6 +2072,7 @@ grouping_planner(PlannerInfo *root, double tuple_fraction)
 								 extract_grouping_cols(parse->distinctClause,
 													result_plan->targetlist),
 								 extract_grouping_ops(parse->distinctClause),
+											NIL,
 											numDistinctRows,
 											result_plan);
 			/* Hashed aggregation produces randomly-ordered results */
@@ -1904,12 +2132,26 @@ grouping_planner(PlannerInfo *root, double tuple_fraction)
 	 */
 	if (parse->sortClause)
 	{
-		if (!pathkeys_contained_in(root->sort_pathkeys, current_pathkeys))
+		int			presorted_keys;
+
+		if (!pathkeys_count_contained_in(root->sort_pathkeys,
+										 current_pathkeys,
+										 &presorted_keys))
 		{
-			result_plan = (Plan *) make_sort_from_pathkeys(root,
-														   result_plan,
+			if (incremental_sort_ok && presorted_keys > 0 &&
+				use_incremental_sort(root, result_plan,
+									 root->sort_pathkeys, presorted_keys,
+									 tuple_fraction, limit_tuples))
+				result_plan = (Plan *)
+					make_incrementalsort_from_pathkeys(root,
+													   result_plan,
+													   root->sort_pathkeys,
+													   presorted_keys);
+			else
+				result_plan = (Plan *) make_sort_from_pathkeys(root,
+															   result_plan,
 														 root->sort_pathkeys,
-														   limit_tuples);
+															   limit_tuples);
 			current_pathkeys = root->sort_pathkeys;
 		}
 	}
@@ -2551,6 +2793,151 @@ preprocess_groupclause(PlannerInfo *root)
 	parse->groupClause = new_groupclause;
 }
 
+/*
+ * extract_rollup_sets
+ *		Divide a list of expanded grouping sets into rollups.
+ *
+ * A rollup is a list of grouping sets each of which contains all the later
+ * ones, so that all of them can be computed from a single sort order.  We
+ * build the rollups greedily, taking the sets largest first and adding each
+ * one to the first rollup whose smallest set contains it.  That doesn't
+ * always find the smallest possible number of rollups, but it does for a
+ * plain ROLLUP or CUBE, and for the usual combinations of them.
+ *
+ * The input is the output of expand_grouping_sets, which is ordered by
+ * ascending size.  Each rollup is returned in the same order.
+ */
+static List *
+extract_rollup_sets(List *groupingSets)
+{
+	List	   *rollups = NIL;
+	List	   *descending = NIL;
+	ListCell   *lc;
+
+	foreach(lc, groupingSets)
+		descending = lcons(lfirst(lc), descending);
+
+	foreach(lc, descending)
+	{
+		List	   *gset = (List *) lfirst(lc);
+		ListCell   *lc2;
+
+		foreach(lc2, rollups)
+		{
+			List	   *rollup = (List *) lfirst(lc2);
+
+			if (list_difference_int(gset, (List *) linitial(rollup)) == NIL)
+			{
+				lfirst(lc2) = lcons(gset, rollup);
+				break;
+			}
+		}
+
+		if (lc2 == NULL)
+			rollups = lappend(rollups, list_make1(gset));
+	}
+
+	list_free(descending);
+
+	return rollups;
+}
+
+/*
+ * reorder_grouping_sets
+ *		Put the members of each set of a rollup into prefix order.
+ *
+ * The input is a rollup in ascending order of size.  The output contains the
+ * same sets in descending order of size, with the members of each set listed
+ * so that every set is a prefix of the one before it.  The first set thus
+ * gives the column order for the sort that feeds the whole rollup.
+ */
+static List *
+reorder_grouping_sets(List *groupingSets)
+{
+	List	   *previous = NIL;
+	List	   *result = NIL;
+	ListCell   *lc;
+
+	foreach(lc, groupingSets)
+	{
+		List	   *candidate = (List *) lfirst(lc);
+
+		previous = list_concat(previous,
+							   list_difference_int(candidate, previous));
+		result = lcons(list_copy(previous), result);
+	}
+
+	list_free(previous);
+
+	return result;
+}
+
+/*
+ * groupclause_for_set
+ *		Build a GROUP BY list for the given set of sortgrouprefs.
+ *
+ * The SortGroupClauses are taken from groupClause, in the order of gset.
+ */
+static List *
+groupclause_for_set(List *groupClause, List *gset)
+{
+	List	   *result = NIL;
+	ListCell   *lc;
+
+	foreach(lc, gset)
+	{
+		Index		ref = (Index) lfirst_int(lc);
+		ListCell   *lc2;
+
+		foreach(lc2, groupClause)
+		{
+			SortGroupClause *gc = (SortGroupClause *) lfirst(lc2);
+
+			if (gc->tleSortGroupRef == ref)
+			{
+				result = lappend(result, gc);
+				break;
+			}
+		}
+		if (lc2 == NULL)
+			elog(ERROR, "grouping set column %u not found in GROUP BY", ref);
+	}
+
+	return result;
+}
+
+/*
+ * estimate_grouping_set_groups
+ *		Estimate the total number of groups produced by a list of grouping
+ *		sets.  An empty grouping set always produces exactly one group.
+ */
+static double
+estimate_grouping_set_groups(PlannerInfo *root, List *gsets,
+							 List *groupClause, double path_rows)
+{
+	double		dNumGroups = 0;
+	ListCell   *lc;
+
+	foreach(lc, gsets)
+	{
+		List	   *gset = (List *) lfirst(lc);
+		List	   *groupExprs;
+
+		if (gset == NIL)
+		{
+			dNumGroups += 1;
+			continue;
+		}
+
+		groupExprs = get_sortgrouplist_exprs(groupclause_for_set(groupClause,
+																 gset),
+											 root->parse->targetList);
+		dNumGroups += estimate_num_groups(root, groupExprs, path_rows);
+	}
+
+	return dNumGroups;
+}
+
 /*
  * Compute query_pathkeys and other pathkeys during plan generation
  */
@@ -2561,17 +2948,20 @@ standard_qp_callback(PlannerInfo *root, void *extra)
 	standard_qp_extra *qp_extra = (standard_qp_extra *) extra;
 	List	   *tlist = qp_extra->tlist;
 	List	   *activeWindows = qp_extra->activeWindows;
+	List	   *groupClause = qp_extra->groupClause;
 
 	/*
 	 * Calculate pathkeys that represent grouping/ordering requirements.  The
 	 * sortClause is certainly sort-able, but GROUP BY and DISTINCT might not
-	 * be, in which case we just leave their pathkeys empty.
+	 * be, in which case we just leave their pathkeys empty.  With grouping
+	 * sets, the caller passes the GROUP BY list of the first rollup, since
+	 * that's the order the input must arrive in.
 	 */
-	if (parse->groupClause &&
-		grouping_is_sortable(parse->groupClause))
+	if (groupClause &&
+		grouping_is_sortable(groupClause))
 		root->group_pathkeys =
 			make_pathkeys_for_sortclauses(root,
-										  parse->groupClause,
+										  groupClause,
 										  tlist);
 	else
 		root->group_pathkeys = NIL;
@@ -2787,6 +3177,727 @@ choose_hashed_grouping(PlannerInfo *root,
 	return false;
 }
 
+/*
+ * choose_hashed_grouping_sets - should we use hashing for grouping sets?
+ *
+ * Hashed grouping sets get one hash table per set, all filled during a
+ * single pass over the input.  As for choose_hashed_grouping, we insist
+ * that they look like fitting in work_mem together, though the executor
+ * spills them to disk if they turn out not to.  An empty grouping set
+ * can't be hashed at all, as it has to produce a row even for empty input.
+ *
+ * Returns TRUE to select hashing, FALSE to select sorting.
+ */
+static bool
+choose_hashed_grouping_sets(PlannerInfo *root,
+							double path_rows, int path_width,
+							Path *cheapest_path, Path *sorted_path,
+							List *rollup_groupclauses,
+							double dNumGroups, AggClauseCosts *agg_costs)
+{
+	Query	   *parse = root->parse;
+	bool		can_hash;
+	bool		can_sort;
+	Size		hashentrysize;
+	int			numGroupCols = 0;
+	List	   *current_pathkeys;
+	Path		hashed_p;
+	Path		sorted_p;
+	ListCell   *lc;
+
+	can_hash = (agg_costs->numOrderedAggs == 0 &&
+				grouping_is_hashable(parse->groupClause) &&
+				!list_member(parse->groupingSets, NIL));
+	can_sort = grouping_is_sortable(parse->groupClause);
+
+	/* Quick out if only one choice is workable */
+	if (!(can_hash && can_sort))
+	{
+		if (can_hash)
+			return true;
+		else if (can_sort)
+			return false;
+		else
+			ereport(ERROR,
+					(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+					 errmsg("could not implement GROUP BY"),
+					 errdetail("Some of the datatypes only support hashing, while others only support sorting.")));
+	}
+
+	/* Prefer sorting when enable_hashagg is off */
+	if (!enable_hashagg)
+		return false;
+
+	/* Same per-entry estimate as choose_hashed_grouping */
+	hashentrysize = MAXALIGN(path_width) + MAXALIGN(sizeof(MinimalTupleData));
+	hashentrysize += agg_costs->transitionSpace;
+	hashentrysize += hash_agg_entry_size(agg_costs->numAggs);
+
+	if (hashentrysize * dNumGroups > work_mem * 1024L)
+		return false;
+
+	/*
+	 * Compare cheapest_path + one hash lookup per input row and set, versus
+	 * a sort [+ sort] ... for the rollups plus one aggregation pass for each
+	 * of them.  The first sort may not be needed if there's a suitable
+	 * presorted path.  Neither output is usefully ordered, so we needn't
+	 * consider any final sort.
+	 */
+	foreach(lc, parse->groupingSets)
+		numGroupCols += list_length((List *) lfirst(lc));
+
+	cost_agg(&hashed_p, root, AGG_HASHED, agg_costs,
+			 numGroupCols, dNumGroups,
+			 cheapest_path->startup_cost, cheapest_path->total_cost,
+			 path_rows);
+
+	if (sorted_path)
+	{
+		sorted_p.startup_cost = sorted_path->startup_cost;
+		sorted_p.total_cost = sorted_path->total_cost;
+		current_pathkeys = sorted_path->pathkeys;
+	}
+	else
+	{
+		sorted_p.startup_cost = cheapest_path->startup_cost;
+		sorted_p.total_cost = cheapest_path->total_cost;
+		current_pathkeys = cheapest_path->pathkeys;
+	}
+	if (!pathkeys_contained_in(root->group_pathkeys, current_pathkeys))
+		cost_sort(&sorted_p, root, root->group_pathkeys, sorted_p.total_cost,
+				  path_rows, path_width,
+				  0.0, work_mem, -1.0);
+
+	for_each_cell(lc, lnext(list_head(rollup_groupclauses)))
+	{
+		Path		resort_p;
+
+		cost_sort(&resort_p, root, NIL, 0.0,
+				  path_rows, path_width,
+				  0.0, work_mem, -1.0);
+		sorted_p.total_cost += resort_p.total_cost;
+	}
+
+	cost_agg(&sorted_p, root, AGG_SORTED, agg_costs,
+			 numGroupCols, dNumGroups,
+			 sorted_p.startup_cost, sorted_p.total_cost,
+			 path_rows);
+
+	return (compare_path_costs(&hashed_p, &sorted_p, TOTAL_COST) < 0);
+}
+
+/*
+ * build_grouping_chain
+ *		Make the Agg node that computes all the grouping sets of the query.
+ *
+ * For sorted grouping, each rollup in rollup_lists is a list of grouping
+ * sets in descending order of size, each a prefix of the one before, and
+ * rollup_groupclauses holds the GROUP BY list of its largest set.  The
+ * first rollup is computed from result_plan, which we sort here if
+ * need_sort_for_grouping.  Each other rollup is described by an Agg node in
+ * the top node's chain list, whose lefttree is a Sort node giving the order
+ * the executor must re-sort the input into for that rollup.
+ *
+ * For hashed grouping, every grouping set gets a hash table of its own and
+ * hence its own Agg node, none of them with a lefttree.  All the hash tables
+ * are filled in the same pass over the input.
+ */
+static Plan *
+build_grouping_chain(PlannerInfo *root, List *tlist,
+					 bool use_hashed_grouping, AggClauseCosts *agg_costs,
+					 List *rollup_lists, List *rollup_groupclauses,
+					 bool need_sort_for_grouping, double path_rows,
+					 Plan *result_plan)
+{
+	Query	   *parse = root->parse;
+	AggStrategy aggstrategy;
+	List	   *chain = NIL;
+	Plan	   *agg_plan;
+	long		numGroups;
+	ListCell   *lc;
+	ListCell   *lc2;
+
+	if (use_hashed_grouping)
+	{
+		/* One phase per grouping set, largest first */
+		rollup_lists = NIL;
+		rollup_groupclauses = NIL;
+		foreach(lc, parse->groupingSets)
+		{
+			List	   *gset = (List *) lfirst(lc);
+
+			rollup_lists = lcons(list_make1(gset), rollup_lists);
+			rollup_groupclauses =
+				lcons(groupclause_for_set(parse->groupClause, gset),
+					  rollup_groupclauses);
+		}
+		aggstrategy = AGG_HASHED;
+	}
+	else if (parse->groupClause)
+		aggstrategy = AGG_SORTED;
+	else
+		aggstrategy = AGG_PLAIN;
+
+	/*
+	 * Make the chained nodes for every rollup but the first.  Their costs
+	 * are figured as if they read result_plan's output, so correct for that
+	 * afterwards; we won't actually run result_plan again.
+	 */
+	forboth(lc, rollup_lists, lc2, rollup_groupclauses)
+	{
+		List	   *gsets = (List *) lfirst(lc);
+		List	   *groupClause = (List *) lfirst(lc2);
+		AttrNumber *grpColIdx;
+		Plan	   *sort_plan = NULL;
+
+		if (lc == list_head(rollup_lists))
+			continue;
+
+		grpColIdx = remap_groupColIdx(root, groupClause);
+		numGroups = (long)
+			Min(estimate_grouping_set_groups(root, gsets,
+											 parse->groupClause, path_rows),
+				(double) LONG_MAX);
+
+		if (aggstrategy == AGG_SORTED)
+			sort_plan = (Plan *) make_sort_from_groupcols(root, groupClause,
+														  grpColIdx,
+														  result_plan);
+
+		agg_plan = (Plan *) make_agg(root,
+									 tlist,
+									 NIL,
+									 aggstrategy,
+									 agg_costs,
+									 list_length(groupClause),
+									 grpColIdx,
+									 extract_grouping_ops(groupClause),
+									 gsets,
+									 numGroups,
+									 sort_plan ? sort_plan : result_plan);
+		agg_plan->startup_cost -= result_plan->total_cost;
+		agg_plan->total_cost -= result_plan->total_cost;
+
+		/* Nuke the things the executor won't look at */
+		agg_plan->targetlist = NIL;
+		if (sort_plan)
+		{
+			sort_plan->targetlist = NIL;
+			sort_plan->lefttree = NULL;
+		}
+		else
+			agg_plan->lefttree = NULL;
+
+		chain = lappend(chain, agg_plan);
+	}
+
+	/* Now the top node, which computes the first rollup */
+	if (need_sort_for_grouping)
+		result_plan = (Plan *)
+			make_sort_from_groupcols(root,
+									 (List *) linitial(rollup_groupclauses),
+									 remap_groupColIdx(root,
+										 (List *) linitial(rollup_groupclauses)),
+									 result_plan);
+
+	numGroups = (long) Min(estimate_grouping_set_groups(root,
+														parse->groupingSets,
+														parse->groupClause,
+														path_rows),
+						   (double) LONG_MAX);
+
+	agg_plan = (Plan *) make_agg(root,
+								 tlist,
+								 (List *) parse->havingQual,
+								 aggstrategy,
+								 agg_costs,
+							 list_length((List *) linitial(rollup_groupclauses)),
+								 remap_groupColIdx(root,
+										 (List *) linitial(rollup_groupclauses)),
+							 extract_grouping_ops(linitial(rollup_groupclauses)),
+								 (List *) linitial(rollup_lists),
+								 numGroups,
+								 result_plan);
+	((Agg *) agg_plan)->chain = chain;
+
+	/* The other passes add to the total cost, but not the startup cost */
+	foreach(lc, chain)
+		agg_plan->total_cost += ((Plan *) lfirst(lc))->total_cost;
+
+	return agg_plan;
+}
+
+/*
+ * remap_groupColIdx
+ *		Build a grouping column index array for a GROUP BY list that is
+ *		a subset of parse->groupClause, using root->grouping_map.
+ */
+static AttrNumber *
+remap_groupColIdx(PlannerInfo *root, List *groupClause)
+{
+	AttrNumber *new_grpColIdx;
+	ListCell   *lc;
+	int			i = 0;
+
+	Assert(root->grouping_map || groupClause == NIL);
+
+	new_grpColIdx = palloc0(sizeof(AttrNumber) * list_length(groupClause));
+
+	foreach(lc, groupClause)
+	{
+		SortGroupClause *gc = (SortGroupClause *) lfirst(lc);
+
+		new_grpColIdx[i++] = root->grouping_map[gc->tleSortGroupRef];
+	}
+
+	return new_grpColIdx;
+}
+
+/*
+ * Context for partial_agg_walker
+ */
+typedef struct
+{
+	List	   *group_exprs;	/* grouping expressions of the Agg's input */
+	List	   *aggrefs;		/* Aggrefs found so far */
+} partial_agg_context;
+
+/*
+ * partial_agg_walker
+ *		Collect the Aggrefs of an aggregation tlist or HAVING qual, and check
+ *		that everything outside them can be computed from the grouping
+ *		expressions, which are all the final Agg of a partial aggregation
+ *		plan gets to see besides the partial aggregates.
+ *
+ * Returns true if the expression is unsuitable.
+ */
+static bool
+partial_agg_walker(Node *node, partial_agg_context *context)
+{
+	if (node == NULL)
+		return false;
+	if (IsA(node, Aggref))
+	{
+		context->aggrefs = list_append_unique(context->aggrefs, node);
+		return false;
+	}
+	if (!IsA(node, TargetEntry) &&
+		list_member(context->group_exprs, node))
+		return false;
+	if (IsA(node, Var) || IsA(node, PlaceHolderVar))
+		return true;
+	return expression_tree_walker(node, partial_agg_walker,
+								  (void *) context);
+}
+
+/*
+ * Context for translate_append_child_mutator
+ */
+typedef struct
+{
+	List	   *parent_tlist;	/* the Append's target list */
+	List	   *child_tlist;	/* the target list of one of its members */
+	bool		failed;			/* found something we can't translate? */
+} translate_append_child_context;
+
+/*
+ * translate_append_child_mutator
+ *		Rewrite an expression over the output of an Append plan into one over
+ *		the output of one of its members.
+ *
+ * An Append just passes on its members' tuples, so column k of its target
+ * list is column k of each member's target list, whatever expressions the
+ * two lists use to describe it.
+ */
+static Node *
+translate_append_child_mutator(Node *node,
+							   translate_append_child_context *context)
+{
+	ListCell   *lc1;
+	ListCell   *lc2;
+
+	if (node == NULL)
+		return NULL;
+	if (!IsA(node, TargetEntry))
+	{
+		forboth(lc1, context->parent_tlist, lc2, context->child_tlist)
+		{
+			TargetEntry *parent_tle = (TargetEntry *) lfirst(lc1);
+			TargetEntry *child_tle = (TargetEntry *) lfirst(lc2);
+
+			if (equal(node, parent_tle->expr))
+				return copyObject(child_tle->expr);
+		}
+	}
+	if (IsA(node, Var) || IsA(node, PlaceHolderVar))
+	{
+		context->failed = true;
+		return node;
+	}
+	return expression_tree_mutator(node, translate_append_child_mutator,
+								   (void *) context);
+}
+
+/*
+ * mark_partial_aggref
+ *		Convert an Aggref into the partial aggregation step of itself, which
+ *		returns the aggregate's transition state rather than its result.
+ *
+ * If serialStates is true, an INTERNAL state is returned serialized as bytea.
+ * This is used both when building a partial aggregation plan and by
+ * setrefs.c to identify the partial aggregates a combining Agg reads.
+ */
+void
+mark_partial_aggref(Aggref *agg, bool serialStates)
+{
+	HeapTuple	aggTuple;
+	Form_pg_aggregate aggform;
+	Oid			inputTypes[FUNC_MAX_ARGS];
+	int			numArguments;
+	Oid			transtype;
+
+	Assert(!agg->aggpartial && !agg->aggcombine);
+
+	aggTuple = SearchSysCache1(AGGFNOID, ObjectIdGetDatum(agg->aggfnoid));
+	if (!HeapTupleIsValid(aggTuple))
+		elog(ERROR, "cache lookup failed for aggregate %u", agg->aggfnoid);
+	aggform = (Form_pg_aggregate) GETSTRUCT(aggTuple);
+
+	numArguments = get_aggregate_argtypes(agg, inputTypes);
+	transtype = resolve_aggregate_transtype(agg->aggfnoid,
+											aggform->aggtranstype,
+											inputTypes,
+											numArguments);
+	ReleaseSysCache(aggTuple);
+
+	if (transtype == INTERNALOID && serialStates)
+		transtype = BYTEAOID;
+
+	agg->aggpartial = true;
+	if (transtype != agg->aggtype)
+	{
+		agg->aggtype = transtype;
+		agg->aggcollid = InvalidOid;
+	}
+}
+
+/*
+ * make_partial_agg_plan
+ *		Try to build an aggregation plan that aggregates each member of an
+ *		Append separately, and then combines the results.
+ *
+ * input_plan is the plan the ordinary Agg node would read, before any Sort
+ * for grouping; input_sorted tells whether it needs one.  The other
+ * arguments are as for make_agg.  If input_plan is an Append, or a Result
+ * projecting one, and every aggregate has a combine function, we put a
+ * partial Agg (plus a Sort, for AGG_SORTED) on top of each Append member,
+ * and a final Agg that combines the partial states (again after a Sort,
+ * for AGG_SORTED) on top of the Append.  A MergeAppend already sorted for
+ * grouping is treated likewise, except that no Sorts are needed.  The final Agg's target list and
+ * qual are the same as the ordinary Agg's would be; setrefs.c replaces its
+ * Aggrefs with ones reading the partial aggregates' output.
+ *
+ * Grouping on each member first can shrink the input of the final step a
+ * great deal, and sorting the members separately is cheaper than sorting
+ * their union; the caller decides by comparing costs.  Returns NULL if the
+ * plan can't be built.
+ */
+static Plan *
+make_partial_agg_plan(PlannerInfo *root, List *tlist,
+					  AggStrategy aggstrategy,
+					  const AggClauseCosts *aggcosts,
+					  int numGroupCols, AttrNumber *grpColIdx,
+					  Oid *grpOperators, long numGroups,
+					  Plan *input_plan, bool input_sorted)
+{
+	Query	   *parse = root->parse;
+	List	   *havingQual = (List *) parse->havingQual;
+	Plan	   *append_plan = input_plan;
+	List	   *subplans;
+	bool		merge_sorted;
+	partial_agg_context context;
+	List	   *append_tlist = NIL;
+	List	   *partial_plans = NIL;
+	AttrNumber *final_grpColIdx;
+	AttrNumber *merge_sortColIdx = NULL;
+	bool		serialStates = false;
+	Agg		   *agg;
+	Plan	   *plan;
+	ListCell   *lc;
+	int			i;
+
+	/* Look for an Append, perhaps under a projection-only Result */
+	if (IsA(append_plan, Result) &&
+		append_plan->lefttree != NULL &&
+		append_plan->qual == NIL &&
+		((Result *) append_plan)->resconstantqual == NULL)
+		append_plan = append_plan->lefttree;
+	if (IsA(append_plan, Append))
+		subplans = ((Append *) append_plan)->appendplans;
+	else if (IsA(append_plan, MergeAppend))
+		subplans = ((MergeAppend *) append_plan)->mergeplans;
+	else
+		return NULL;
+	if (list_length(subplans) < 2)
+		return NULL;
+
+	/*
+	 * A MergeAppend's members are already sorted the way a sorted Agg needs,
+	 * if the MergeAppend is; then we merge the partial aggregates the same
+	 * way, instead of sorting them.
+	 */
+	merge_sorted = (aggstrategy == AGG_SORTED && input_sorted &&
+					IsA(append_plan, MergeAppend));
+
+	/* Duplicating a SubPlan into each member isn't supported */
+	if (contain_subplans((Node *) tlist) ||
+		contain_subplans((Node *) havingQual) ||
+		contain_subplans((Node *) input_plan->targetlist))
+		return NULL;
+
+	/* Check the tlist and HAVING qual, and collect their aggregates */
+	context.group_exprs = NIL;
+	context.aggrefs = NIL;
+	for (i = 0; i < numGroupCols; i++)
+	{
+		TargetEntry *tle = get_tle_by_resno(input_plan->targetlist,
+											grpColIdx[i]);
+
+		context.group_exprs = lappend(context.group_exprs, tle->expr);
+	}
+	if (partial_agg_walker((Node *) tlist, &context) ||
+		partial_agg_walker((Node *) havingQual, &context))
+		return NULL;
+
+	/* Find the MergeAppend's sort keys among the grouping columns */
+	if (merge_sorted)
+	{
+		MergeAppend *mplan = (MergeAppend *) append_plan;
+
+		merge_sortColIdx = (AttrNumber *)
+			palloc(sizeof(AttrNumber) * mplan->numCols);
+		for (i = 0; i < mplan->numCols; i++)
+		{
+			TargetEntry *tle = get_tle_by_resno(append_plan->targetlist,
+												mplan->sortColIdx[i]);
+			int			j = 0;
+
+			foreach(lc, context.group_exprs)
+			{
+				if (equal(lfirst(lc), tle->expr))
+					break;
+				j++;
+			}
+			if (lc == NULL)
+				return NULL;
+			merge_sortColIdx[i] = j + 1;
+		}
+	}
+
+	/*
+	 * Every aggregate must have a combine function.  INTERNAL states may be
+	 * passed between the Agg nodes as bare pointers only if there's no
+	 * grouping: a grouped partial Agg moves on to its next group (and may
+	 * spill to disk, or have its output sorted) long before the final Agg
+	 * reads the state, so for that we need to serialize them.
+	 */
+	foreach(lc, context.aggrefs)
+	{
+		Aggref	   *aggref = (Aggref *) lfirst(lc);
+		HeapTuple	aggTuple;
+		Form_pg_aggregate aggform;
+		Oid			inputTypes[FUNC_MAX_ARGS];
+		int			numArguments;
+		Oid			transtype;
+		bool		ok;
+
+		if (aggref->aggkind != AGGKIND_NORMAL ||
+			aggref->aggorder != NIL ||
+			aggref->aggdistinct != NIL)
+			return NULL;
+
+		aggTuple = SearchSysCache1(AGGFNOID,
+								   ObjectIdGetDatum(aggref->aggfnoid));
+		if (!HeapTupleIsValid(aggTuple))
+			elog(ERROR, "cache lookup failed for aggregate %u",
+				 aggref->aggfnoid);
+		aggform = (Form_pg_aggregate) GETSTRUCT(aggTuple);
+
+		numArguments = get_aggregate_argtypes(aggref, inputTypes);
+		transtype = resolve_aggregate_transtype(aggref->aggfnoid,
+												aggform->aggtranstype,
+												inputTypes,
+												numArguments);
+
+		ok = OidIsValid(aggform->aggcombinefn);
+		if (transtype == INTERNALOID && numGroupCols > 0)
+		{
+			if (!OidIsValid(aggform->aggserialfn))
+				ok = false;
+			serialStates = true;
+		}
+		ReleaseSysCache(aggTuple);
+
+		if (!ok)
+			return NULL;
+	}
+
+	/*
+	 * The Append of the partial aggregates returns the grouping columns
+	 * followed by the partial aggregates.
+	 */
+	final_grpColIdx = (AttrNumber *) palloc(sizeof(AttrNumber) * numGroupCols);
+	for (i = 0; i < numGroupCols; i++)
+	{
+		TargetEntry *tle = get_tle_by_resno(input_plan->targetlist,
+											grpColIdx[i]);
+
+		tle = flatCopyTargetEntry(tle);
+		tle->resno = i + 1;
+		tle->resname = NULL;
+		tle->resjunk = false;
+		append_tlist = lappend(append_tlist, tle);
+		final_grpColIdx[i] = i + 1;
+	}
+	foreach(lc, context.aggrefs)
+	{
+		Aggref	   *partial = (Aggref *) copyObject(lfirst(lc));
+
+		mark_partial_aggref(partial, serialStates);
+		append_tlist = lappend(append_tlist,
+							   makeTargetEntry((Expr *) partial,
+											   list_length(append_tlist) + 1,
+											   NULL,
+											   false));
+	}
+
+	/* Build a partial aggregation over each member of the Append */
+	foreach(lc, subplans)
+	{
+		Plan	   *subplan = (Plan *) lfirst(lc);
+		translate_append_child_context tcontext;
+		List	   *input_tlist;
+		List	   *partial_tlist;
+
+		tcontext.parent_tlist = append_plan->targetlist;
+		tcontext.child_tlist = subplan->targetlist;
+		tcontext.failed = false;
+
+		input_tlist = (List *)
+			translate_append_child_mutator((Node *) input_plan->targetlist,
+										   &tcontext);
+		partial_tlist = (List *)
+			translate_append_child_mutator((Node *) append_tlist,
+										   &tcontext);
+		if (tcontext.failed)
+			return NULL;
+
+		/* Make the member compute the columns the partial Agg needs */
+		if (!tlist_same_exprs(input_tlist, subplan->targetlist))
+		{
+			if (is_projection_capable_plan(subplan))
+			{
+				/* copy it, since the ordinary plan still uses it */
+				subplan = (Plan *) copyObject(subplan);
+				subplan->targetlist = input_tlist;
+				add_tlist_costs_to_plan(root, subplan, input_tlist);
+			}
+			else
+				subplan = (Plan *) make_result(root, input_tlist, NULL,
+											   subplan);
+		}
+
+		if (aggstrategy == AGG_SORTED && !merge_sorted)
+			subplan = (Plan *) make_sort_from_groupcols(root,
+														parse->groupClause,
+														grpColIdx,
+														subplan);
+
+		agg = make_agg(root,
+					   partial_tlist,
+					   NIL,
+					   aggstrategy,
+					   aggcosts,
+					   numGroupCols,
+					   grpColIdx,
+					   grpOperators,
+					   NIL,
+					   (long) Min((double) numGroups,
+								  clamp_row_est(subplan->plan_rows)),
+					   subplan);
+		agg->finalizeAggs = false;
+		agg->serialStates = serialStates;
+
+		partial_plans = lappend(partial_plans, agg);
+	}
+
+	/* And combine their results */
+	if (merge_sorted)
+	{
+		MergeAppend *mplan = (MergeAppend *) append_plan;
+		MergeAppend *node = makeNode(MergeAppend);
+		Path		merge_path; /* dummy for result of cost_merge_append */
+		Cost		input_startup_cost = 0;
+		Cost		input_total_cost = 0;
+		double		total_size = 0;
+
+		plan = &node->plan;
+		plan->plan_rows = 0;
+		foreach(lc, partial_plans)
+		{
+			Plan	   *subplan = (Plan *) lfirst(lc);
+
+			input_startup_cost += subplan->startup_cost;
+			input_total_cost += subplan->total_cost;
+			plan->plan_rows += subplan->plan_rows;
+			total_size += subplan->plan_width * subplan->plan_rows;
+		}
+		cost_merge_append(&merge_path, root, NIL,
+						  list_length(partial_plans),
+						  input_startup_cost, input_total_cost,
+						  plan->plan_rows);
+		plan->startup_cost = merge_path.startup_cost;
+		plan->total_cost = merge_path.total_cost;
+		if (plan->plan_rows > 0)
+			plan->plan_width = rint(total_size / plan->plan_rows);
+		else
+			plan->plan_width = 0;
+		plan->targetlist = append_tlist;
+		node->mergeplans = partial_plans;
+		node->numCols = mplan->numCols;
+		node->sortColIdx = merge_sortColIdx;
+		node->sortOperators = mplan->sortOperators;
+		node->collations = mplan->collations;
+		node->nullsFirst = mplan->nullsFirst;
+	}
+	else
+	{
+		plan = (Plan *) make_append(partial_plans, append_tlist);
+
+		if (aggstrategy == AGG_SORTED)
+			plan = (Plan *) make_sort_from_groupcols(root,
+													 parse->groupClause,
+													 final_grpColIdx,
+													 plan);
+	}
+
+	agg = make_agg(root,
+				   tlist,
+				   havingQual,
+				   aggstrategy,
+				   aggcosts,
+				   numGroupCols,
+				   final_grpColIdx,
+				   grpOperators,
+				   NIL,
+				   numGroups,
+				   plan);
+	agg->combineStates = true;
+	agg->serialStates = serialStates;
+
+	return (Plan *) agg;
+}
+
 /*
  * choose_hashed_distinct - should we use hashing for DISTINCT?
  *
@@ -2938,6 +4049,99 @@ choose_hashed_distinct(PlannerInfo *root,
 	return false;
 }
 
+/*
+ * choose_incremental_sort_path - should we sort a partially sorted path?
+ *
+ * Considers each path of the final rel that is sorted by a leading part of
+ * the ORDER BY, with an incremental sort on top, against what we'd do
+ * otherwise: use sorted_path if it's not NULL, else sort the cheapest-total
+ * path.  Returns the path to use in place of sorted_path.
+ */
+static Path *
+choose_incremental_sort_path(PlannerInfo *root, RelOptInfo *final_rel,
+							 Path *cheapest_path, Path *sorted_path,
+							 double path_rows, int path_width,
+							 double tuple_fraction)
+{
+	Path		best_p;			/* dummy for cost of the best choice so far */
+	Path	   *best_path = sorted_path;
+	ListCell   *lc;
+
+	if (sorted_path)
+	{
+		best_p.startup_cost = sorted_path->startup_cost;
+		best_p.total_cost = sorted_path->total_cost;
+	}
+	else if (pathkeys_contained_in(root->query_pathkeys,
+								   cheapest_path->pathkeys))
+	{
+		/* The cheapest path needs no sort at all */
+		return NULL;
+	}
+	else
+		cost_sort(&best_p, root, root->query_pathkeys,
+				  cheapest_path->total_cost,
+				  path_rows, path_width,
+				  0.0, work_mem, root->limit_tuples);
+
+	foreach(lc, final_rel->pathlist)
+	{
+		Path	   *path = (Path *) lfirst(lc);
+		Path		incsort_p;	/* dummy for result of cost_incremental_sort */
+		int			presorted_keys;
+
+		if (pathkeys_count_contained_in(root->query_pathkeys, path->pathkeys,
+										&presorted_keys) ||
+			presorted_keys == 0 ||
+			PATH_REQ_OUTER(path) != NULL)
+			continue;
+
+		cost_incremental_sort(&incsort_p, root, root->query_pathkeys,
+							  presorted_keys,
+							  path->startup_cost, path->total_cost,
+							  path_rows, path_width,
+							  0.0, work_mem);
+
+		if (compare_fractional_path_costs(&incsort_p, &best_p,
+										  tuple_fraction) < 0)
+		{
+			best_p.startup_cost = incsort_p.startup_cost;
+			best_p.total_cost = incsort_p.total_cost;
+			best_path = path;
+		}
+	}
+
+	return best_path;
+}
+
+/*
+ * use_incremental_sort - should we sort a plan's output incrementally?
+ *
+ * The plan's output is sorted by the first presorted_keys of the pathkeys.
+ * Usually choose_incremental_sort_path picked it for that reason, but the
+ * plan may also have come out partially sorted by chance; either way, see
+ * whether an incremental sort is cheaper than a full one.
+ */
+static bool
+use_incremental_sort(PlannerInfo *root, Plan *plan,
+					 List *pathkeys, int presorted_keys,
+					 double tuple_fraction, double limit_tuples)
+{
+	Path		sort_p;			/* dummy for result of cost_sort */
+	Path		incsort_p;		/* dummy for result of cost_incremental_sort */
+
+	cost_sort(&sort_p, root, pathkeys, plan->total_cost,
+			  plan->plan_rows, plan->plan_width,
+			  0.0, work_mem, limit_tuples);
+	cost_incremental_sort(&incsort_p, root, pathkeys, presorted_keys,
+						  plan->startup_cost, plan->total_cost,
+						  plan->plan_rows, plan->plan_width,
+						  0.0, work_mem);
+
+	return compare_fractional_path_costs(&incsort_p, &sort_p,
+										 tuple_fraction) <= 0;
+}
+
 /*
  * make_subplanTargetList
  *	  Generate appropriate target list when grouping is required.
@@ -2996,8 +4200,8 @@ make_subplanTargetList(PlannerInfo *root,
 	 * If we're not grouping or aggregating, there's nothing to do here;
 	 * query_planner should receive the unmodified target list.
 	 */
-	if (!parse->hasAggs && !parse->groupClause && !root->hasHavingQual &&
-		!parse->hasWindowFuncs)
+	if (!parse->hasAggs && !parse->groupClause && !parse->groupingSets &&
+		!root->hasHavingQual && !parse->hasWindowFuncs)
 	{
 		*need_tlist_eval = true;
 		return tlist;
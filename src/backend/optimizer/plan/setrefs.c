@@ -99,6 +99,7 @@ static Node *fix_scan_expr_mutator(Node *node, fix_scan_expr_context *context);
 static bool fix_scan_expr_walker(Node *node, fix_scan_expr_context *context);
 static void set_join_references(PlannerInfo *root, Join *join, int rtoffset);
 static void set_upper_references(PlannerInfo *root, Plan *plan, int rtoffset);
+static Node *convert_combining_aggrefs(Node *node, void *context);
 static void set_dummy_tlist_references(Plan *plan, int rtoffset);
 static indexed_tlist *build_tlist_index(List *tlist);
 static Var *search_indexed_tlist_for_var(Var *var,
@@ -443,6 +444,17 @@ set_plan_refs(PlannerInfo *root, Plan *plan, int rtoffset)
 					fix_scan_list(root, splan->plan.qual, rtoffset);
 			}
 			break;
+		case T_ParallelSeqScan:
+			{
+				ParallelSeqScan *splan = (ParallelSeqScan *) plan;
+
+				splan->scan.scanrelid += rtoffset;
+				splan->scan.plan.targetlist =
+					fix_scan_list(root, splan->scan.plan.targetlist, rtoffset);
+				splan->scan.plan.qual =
+					fix_scan_list(root, splan->scan.plan.qual, rtoffset);
+			}
+			break;
 		case T_IndexScan:
 			{
 				IndexScan  *splan = (IndexScan *) plan;
@@ -585,6 +597,7 @@ set_plan_refs(PlannerInfo *root, Plan *plan, int rtoffset)
 		case T_Hash:
 		case T_Material:
 		case T_Sort:
+		case T_IncrementalSort:
 		case T_Unique:
 		case T_SetOp:
 
@@ -603,6 +616,22 @@ set_plan_refs(PlannerInfo *root, Plan *plan, int rtoffset)
 			 */
 			Assert(plan->qual == NIL);
 			break;
+		case T_ResultCache:
+			{
+				ResultCache *rcplan = (ResultCache *) plan;
+
+				/*
+				 * Like Material, ResultCache doesn't evaluate its tlist or
+				 * quals, but its cache key expressions must be fixed up.
+				 */
+				set_dummy_tlist_references(plan, rtoffset);
+				Assert(plan->qual == NIL);
+
+				rcplan->param_exprs = (List *)
+					fix_scan_expr(root, (Node *) rcplan->param_exprs,
+								  rtoffset);
+			}
+			break;
 		case T_LockRows:
 			{
 				LockRows   *splan = (LockRows *) plan;
@@ -644,6 +673,27 @@ set_plan_refs(PlannerInfo *root, Plan *plan, int rtoffset)
 			}
 			break;
 		case T_Agg:
+			{
+				Agg		   *agg = (Agg *) plan;
+
+				/*
+				 * If this Agg combines the output of partial aggregation
+				 * steps, its Aggrefs must be made to read the partial
+				 * aggregates' states instead of evaluating their arguments.
+				 */
+				if (agg->combineStates)
+				{
+					plan->targetlist = (List *)
+						convert_combining_aggrefs((Node *) plan->targetlist,
+												  (void *) agg);
+					plan->qual = (List *)
+						convert_combining_aggrefs((Node *) plan->qual,
+												  (void *) agg);
+				}
+
+				set_upper_references(root, plan, rtoffset);
+			}
+			break;
 		case T_Group:
 			set_upper_references(root, plan, rtoffset);
 			break;
@@ -1116,6 +1166,32 @@ fix_expr_common(PlannerInfo *root, Node *node)
 				lappend_oid(root->glob->relationOids,
 							DatumGetObjectId(con->constvalue));
 	}
+	else if (IsA(node, GroupingFunc))
+	{
+		GroupingFunc *g = (GroupingFunc *) node;
+		AttrNumber *grouping_map = root->grouping_map;
+
+		/*
+		 * Convert the sortgrouprefs into the input column numbers that the
+		 * executor checks against the current grouping set.  Without grouping
+		 * sets there is no map, and GROUPING() just returns 0.
+		 */
+		Assert(grouping_map || g->cols == NIL);
+
+		if (grouping_map)
+		{
+			ListCell   *lc;
+			List	   *cols = NIL;
+
+			foreach(lc, g->refs)
+				cols = lappend_int(cols, grouping_map[lfirst_int(lc)]);
+
+			Assert(!g->cols || equal(cols, g->cols));
+
+			if (!g->cols)
+				g->cols = cols;
+		}
+	}
 }
 
 /*
@@ -1290,6 +1366,10 @@ set_join_references(PlannerInfo *root, Join *join, int rtoffset)
 										inner_itlist,
 										(Index) 0,
 										rtoffset);
+
+		/* the filter keys are evaluated by the outer scan itself */
+		hj->filterkeys = (List *)
+			fix_scan_expr(root, (Node *) hj->filterkeys, rtoffset);
 	}
 
 	pfree(outer_itlist);
@@ -1367,6 +1447,60 @@ set_upper_references(PlannerInfo *root, Plan *plan, int rtoffset)
 	pfree(subplan_itlist);
 }
 
+/*
+ * convert_combining_aggrefs
+ *	  Replace each Aggref in the tlist or qual of a combining Agg node with
+ *	  one that combines the states computed by the partial Agg nodes below.
+ *
+ * The new Aggref's only argument is the partial Aggref the planner put in
+ * the input's target list, so set_upper_references() will turn it into a
+ * reference to the input column holding the state.  The Aggrefs are left
+ * alone until now because upper plan nodes match them by equal().
+ */
+static Node *
+convert_combining_aggrefs(Node *node, void *context)
+{
+	Agg		   *agg = (Agg *) context;
+
+	if (node == NULL)
+		return NULL;
+	if (IsA(node, Aggref))
+	{
+		Aggref	   *orig_agg = (Aggref *) node;
+		Aggref	   *child_agg;
+		Aggref	   *parent_agg;
+		List	   *argtypes = NIL;
+		ListCell   *lc;
+
+		foreach(lc, orig_agg->args)
+		{
+			TargetEntry *tle = (TargetEntry *) lfirst(lc);
+
+			argtypes = lappend_oid(argtypes, exprType((Node *) tle->expr));
+		}
+
+		/* This must match what make_partial_agg_plan put in the tlist */
+		child_agg = (Aggref *) copyObject(orig_agg);
+		mark_partial_aggref(child_agg, agg->serialStates);
+
+		parent_agg = makeNode(Aggref);
+		memcpy(parent_agg, orig_agg, sizeof(Aggref));
+		parent_agg->aggcombine = true;
+		parent_agg->aggargtypes = argtypes;
+		parent_agg->aggdirectargs = NIL;
+		parent_agg->args = list_make1(makeTargetEntry((Expr *) child_agg,
+													  1, NULL, false));
+		parent_agg->aggorder = NIL;
+		parent_agg->aggdistinct = NIL;
+		parent_agg->aggfilter = NULL;
+		parent_agg->aggstar = false;
+		parent_agg->aggvariadic = false;
+
+		return (Node *) parent_agg;
+	}
+	return expression_tree_mutator(node, convert_combining_aggrefs, context);
+}
+
 /*
  * set_dummy_tlist_references
  *	  Replace the targetlist of an upper-level plan node with a simple
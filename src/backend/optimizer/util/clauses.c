@@ -98,6 +98,7 @@ static bool contain_volatile_functions_walker(Node *node, void *context);
 static bool contain_volatile_functions_not_nextval_walker(Node *node, void *context);
 static bool contain_nonstrict_functions_walker(Node *node, void *context);
 static bool contain_leaky_functions_walker(Node *node, void *context);
+static bool has_parallel_hazard_walker(Node *node, void *context);
 static Relids find_nonnullable_rels_walker(Node *node, bool top_level);
 static List *find_nonnullable_vars_walker(Node *node, bool top_level);
 static bool is_strict_saop(ScalarArrayOpExpr *expr, bool falseOK);
@@ -417,6 +418,11 @@ contain_agg_clause_walker(Node *node, void *context)
 		Assert(((Aggref *) node)->agglevelsup == 0);
 		return true;			/* abort the tree traversal and return true */
 	}
+	if (IsA(node, GroupingFunc))
+	{
+		Assert(((GroupingFunc *) node)->agglevelsup == 0);
+		return true;			/* abort the tree traversal and return true */
+	}
 	Assert(!IsA(node, SubLink));
 	return expression_tree_walker(node, contain_agg_clause_walker, context);
 }
@@ -1455,6 +1461,85 @@ contain_leaky_functions_walker(Node *node, void *context)
 								  context);
 }
 
+/*****************************************************************************
+ *		Check clauses for parallel safety
+ *****************************************************************************/
+
+/*
+ * has_parallel_hazard
+ *		Recursively search for anything a parallel worker can't evaluate.
+ *
+ * A parallel worker evaluates a scan's quals in a separate backend, having
+ * received them through nodeToString() and stringToNode(), and without the
+ * master's parameter values, subplans or other session state.  So we accept
+ * only expressions over the current query level's columns and constants,
+ * built from node types that can be read back in, and calling only immutable
+ * functions.
+ */
+bool
+has_parallel_hazard(Node *clause)
+{
+	if (contain_mutable_functions(clause))
+		return true;
+	return has_parallel_hazard_walker(clause, NULL);
+}
+
+static bool
+has_parallel_hazard_walker(Node *node, void *context)
+{
+	if (node == NULL)
+		return false;
+
+	switch (nodeTag(node))
+	{
+		case T_Var:
+			/* Outer-level Vars would need the master's parameter values */
+			if (((Var *) node)->varlevelsup != 0)
+				return true;
+			break;
+
+		case T_Const:
+		case T_FuncExpr:
+		case T_OpExpr:
+		case T_DistinctExpr:
+		case T_NullIfExpr:
+		case T_ScalarArrayOpExpr:
+		case T_BoolExpr:
+		case T_FieldSelect:
+		case T_RelabelType:
+		case T_CoerceViaIO:
+		case T_ArrayCoerceExpr:
+		case T_CollateExpr:
+		case T_CaseExpr:
+		case T_CaseWhen:
+		case T_CaseTestExpr:
+		case T_ArrayExpr:
+		case T_RowExpr:
+		case T_RowCompareExpr:
+		case T_CoalesceExpr:
+		case T_MinMaxExpr:
+		case T_NullTest:
+		case T_BooleanTest:
+		case T_List:
+
+			/*
+			 * We know these node types are safe in themselves; but something
+			 * further down in the node tree might not be.
+			 */
+			break;
+
+		default:
+
+			/*
+			 * Anything else, notably Params, SubLinks and SubPlans, might
+			 * depend on state the worker doesn't have.
+			 */
+			return true;
+	}
+	return expression_tree_walker(node, has_parallel_hazard_walker,
+								  context);
+}
+
 /*
  * find_nonnullable_rels
  *		Determine which base rels are forced nonnullable by given clause.
@@ -4287,6 +4372,7 @@ inline_function(Oid funcid, Oid result_type, Oid result_collid,
 		querytree->jointree->fromlist ||
 		querytree->jointree->quals ||
 		querytree->groupClause ||
+		querytree->groupingSets ||
 		querytree->havingQual ||
 		querytree->windowClause ||
 		querytree->distinctClause ||
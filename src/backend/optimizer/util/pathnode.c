@@ -706,6 +706,27 @@ create_seqscan_path(PlannerInfo *root, RelOptInfo *rel, Relids required_outer)
 	return pathnode;
 }
 
+/*
+ * create_parallelseqscan_path
+ *	  Creates a path corresponding to a sequential scan shared with
+ *	  'nworkers' background workers, returning the pathnode.
+ */
+Path *
+create_parallelseqscan_path(PlannerInfo *root, RelOptInfo *rel, int nworkers)
+{
+	ParallelSeqScanPath *pathnode = makeNode(ParallelSeqScanPath);
+
+	pathnode->path.pathtype = T_ParallelSeqScan;
+	pathnode->path.parent = rel;
+	pathnode->path.param_info = NULL;	/* never parameterized */
+	pathnode->path.pathkeys = NIL;	/* seqscan has unordered result */
+	pathnode->num_workers = nworkers;
+
+	cost_parallel_seqscan(&pathnode->path, root, rel, nworkers);
+
+	return (Path *) pathnode;
+}
+
 /*
  * create_index_path
  *	  Creates a path node for an index scan.
@@ -1070,6 +1091,44 @@ create_material_path(RelOptInfo *rel, Path *subpath)
 	return pathnode;
 }
 
+/*
+ * create_resultcache_path
+ *	  Creates a path corresponding to a ResultCache plan, returning the
+ *	  pathnode.
+ *
+ * param_exprs are the outer-relation expressions that the subpath's
+ * parameters are computed from.  calls is the expected number of scans of
+ * the path, and
+ * ndistinct the expected number of distinct values of param_exprs among
+ * those; cost_rescan uses them to estimate the cache's hit ratio.
+ */
+ResultCachePath *
+create_resultcache_path(RelOptInfo *rel, Path *subpath, List *param_exprs,
+						double calls, double ndistinct)
+{
+	ResultCachePath *pathnode = makeNode(ResultCachePath);
+
+	Assert(subpath->parent == rel);
+
+	pathnode->path.pathtype = T_ResultCache;
+	pathnode->path.parent = rel;
+	pathnode->path.param_info = subpath->param_info;
+	pathnode->path.pathkeys = subpath->pathkeys;
+
+	pathnode->subpath = subpath;
+	pathnode->param_exprs = param_exprs;
+	pathnode->calls = calls;
+	pathnode->ndistinct = ndistinct;
+
+	cost_resultcache(&pathnode->path,
+					 list_length(param_exprs),
+					 subpath->startup_cost,
+					 subpath->total_cost,
+					 subpath->rows);
+
+	return pathnode;
+}
+
 /*
  * create_unique_path
  *	  Creates a path representing elimination of distinct rows from the
@@ -1496,10 +1555,10 @@ query_is_distinct_for(Query *query, List *colnos, List *opids)
 	}
 
 	/*
-	 * Similarly, GROUP BY guarantees uniqueness if all the grouped columns
-	 * appear in colnos and operator semantics match.
+	 * Similarly, GROUP BY without GROUPING SETS guarantees uniqueness if all
+	 * the grouped columns appear in colnos and operator semantics match.
 	 */
-	if (query->groupClause)
+	if (query->groupClause && !query->groupingSets)
 	{
 		foreach(l, query->groupClause)
 		{
@@ -1515,6 +1574,27 @@ query_is_distinct_for(Query *query, List *colnos, List *opids)
 		if (l == NULL)			/* had matches for all? */
 			return true;
 	}
+	else if (query->groupingSets)
+	{
+		/*
+		 * If we have grouping sets with expressions, we probably don't have
+		 * uniqueness and analysis would be hard. Punt.
+		 */
+		if (query->groupClause)
+			return false;
+
+		/*
+		 * If we have no groupClause (therefore no grouping expressions), we
+		 * might have one or many empty grouping sets. If there's just one,
+		 * then we're returning only one row and are certainly unique. But
+		 * otherwise, we know we're certainly not unique.
+		 */
+		if (list_length(query->groupingSets) == 1 &&
+			((GroupingSet *) linitial(query->groupingSets))->kind == GROUPING_SET_EMPTY)
+			return true;
+		else
+			return false;
+	}
 	else
 	{
 		/*
@@ -54,6 +54,8 @@ static int32 get_rel_data_width(Relation rel, int32 *attr_widths);
 static List *get_relation_constraints(PlannerInfo *root,
 						 Oid relationObjectId, RelOptInfo *rel,
 						 bool include_notnull);
+static List *get_safe_constraints(PlannerInfo *root, RelOptInfo *rel,
+					 RangeTblEntry *rte);
 static List *build_index_tlist(PlannerInfo *root, IndexOptInfo *index,
 				  Relation heapRelation);
 
@@ -748,7 +750,6 @@ relation_excluded_by_constraints(PlannerInfo *root,
 								 RelOptInfo *rel, RangeTblEntry *rte)
 {
 	List	   *safe_restrictions;
-	List	   *constraint_pred;
 	List	   *safe_constraints;
 	ListCell   *lc;
 
@@ -785,9 +786,65 @@ relation_excluded_by_constraints(PlannerInfo *root,
 	if (rte->rtekind != RTE_RELATION || rte->inh)
 		return false;
 
+	safe_constraints = get_safe_constraints(root, rel, rte);
+
+	/*
+	 * The constraints are effectively ANDed together, so we can just try to
+	 * refute the entire collection at once.  This may allow us to make proofs
+	 * that would fail if we took them individually.
+	 *
+	 * Note: we use rel->baserestrictinfo, not safe_restrictions as might seem
+	 * an obvious optimization.  Some of the clauses might be OR clauses that
+	 * have volatile and nonvolatile subclauses, and it's OK to make
+	 * deductions with the nonvolatile parts.
+	 */
+	if (predicate_refuted_by(safe_constraints, rel->baserestrictinfo))
+		return true;
+
+	return false;
+}
+
+/*
+ * relation_pruning_constraints
+ *
+ * Return the constraints that the executor may test against the relation's
+ * restriction clauses once the values of their Params are known, so as to
+ * skip scanning it after all.  This is the run-time counterpart of
+ * relation_excluded_by_constraints, and is subject to the same settings.
+ * Returns NIL if there are none to use.
+ */
+List *
+relation_pruning_constraints(PlannerInfo *root,
+							 RelOptInfo *rel, RangeTblEntry *rte)
+{
+	/* Run-time pruning applies only to inheritance children */
+	if (constraint_exclusion == CONSTRAINT_EXCLUSION_OFF ||
+		rel->reloptkind != RELOPT_OTHER_MEMBER_REL)
+		return NIL;
+
+	if (rte->rtekind != RTE_RELATION || rte->inh)
+		return NIL;
+
+	return get_safe_constraints(root, rel, rte);
+}
+
+/*
+ * get_safe_constraints
+ *
+ * Fetch the relation's constraint expressions that are safe to draw
+ * conclusions from, for relation_excluded_by_constraints and
+ * relation_pruning_constraints.
+ */
+static List *
+get_safe_constraints(PlannerInfo *root, RelOptInfo *rel, RangeTblEntry *rte)
+{
+	List	   *constraint_pred;
+	List	   *safe_constraints;
+	ListCell   *lc;
+
 	/*
-	 * OK to fetch the constraint expressions.	Include "col IS NOT NULL"
-	 * expressions for attnotnull columns, in case we can refute those.
+	 * Include "col IS NOT NULL" expressions for attnotnull columns, in case
+	 * we can refute those.
 	 */
 	constraint_pred = get_relation_constraints(root, rte->relid, rel, true);
 
@@ -807,20 +864,7 @@ relation_excluded_by_constraints(PlannerInfo *root,
 			safe_constraints = lappend(safe_constraints, pred);
 	}
 
-	/*
-	 * The constraints are effectively ANDed together, so we can just try to
-	 * refute the entire collection at once.  This may allow us to make proofs
-	 * that would fail if we took them individually.
-	 *
-	 * Note: we use rel->baserestrictinfo, not safe_restrictions as might seem
-	 * an obvious optimization.  Some of the clauses might be OR clauses that
-	 * have volatile and nonvolatile subclauses, and it's OK to make
-	 * deductions with the nonvolatile parts.
-	 */
-	if (predicate_refuted_by(safe_constraints, rel->baserestrictinfo))
-		return true;
-
-	return false;
+	return safe_constraints;
 }
 
 
@@ -1715,6 +1715,10 @@ FigureColnameInternal(Node *node, char **name)
 			/* make ROW() act like a function */
 			*name = "row";
 			return 2;
+		case T_GroupingFunc:
+			/* make GROUPING() act like a regular function */
+			*name = "grouping";
+			return 2;
 		case T_CoalesceExpr:
 			/* make coalesce() act like a regular function */
 			*name = "coalesce";
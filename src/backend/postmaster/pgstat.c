@@ -33,6 +33,7 @@
 
 #include "access/heapam.h"
 #include "access/htup_details.h"
+#include "access/parallel.h"
 #include "access/transam.h"
 #include "access/twophase_rmgr.h"
 #include "access/xact.h"
@@ -1896,15 +1897,24 @@ void
 AtEOXact_PgStat(bool isCommit)
 {
 	PgStat_SubXactStatus *xact_state;
+	bool		isWorker = IsParallelWorker();
 
 	/*
 	 * Count transaction commit or abort.  (We use counters, not just bools,
 	 * in case the reporting message isn't sent right away.)
+	 *
+	 * A parallel worker's transaction is only a part of the master's, and
+	 * what a worker inserts, updates or deletes is committed or aborted
+	 * along with that.  So a worker counts neither its transaction nor the
+	 * transactional counts below; the master accounts for the work instead.
 	 */
-	if (isCommit)
-		pgStatXactCommit++;
-	else
-		pgStatXactRollback++;
+	if (!isWorker)
+	{
+		if (isCommit)
+			pgStatXactCommit++;
+		else
+			pgStatXactRollback++;
+	}
 
 	/*
 	 * Transfer transactional insert/update counts into the base tabstat
@@ -1926,6 +1936,11 @@ AtEOXact_PgStat(bool isCommit)
 			Assert(trans->upper == NULL);
 			tabstat = trans->parent;
 			Assert(tabstat->trans == trans);
+			if (isWorker)
+			{
+				tabstat->trans = NULL;
+				continue;
+			}
 			/* count attempted actions regardless of commit/abort */
 			tabstat->t_counts.t_tuples_inserted += trans->tuples_inserted;
 			tabstat->t_counts.t_tuples_updated += trans->tuples_updated;
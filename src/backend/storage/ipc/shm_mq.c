@@ -143,6 +143,8 @@ static shm_mq_result shm_mq_receive_bytes(shm_mq *mq, uint64 bytes_needed,
 					 bool nowait, uint64 *nbytesp, void **datap);
 static bool shm_mq_wait_internal(volatile shm_mq *mq, PGPROC * volatile *ptr,
 					 BackgroundWorkerHandle *handle);
+static bool shm_mq_counterparty_gone(volatile shm_mq *mq,
+						 BackgroundWorkerHandle *handle);
 static uint64 shm_mq_get_bytes_read(volatile shm_mq *mq, bool *detached);
 static void shm_mq_inc_bytes_read(volatile shm_mq *mq, uint64 n);
 static uint64 shm_mq_get_bytes_written(volatile shm_mq *mq, bool *detached);
@@ -377,7 +379,10 @@ shm_mq_send(shm_mq_handle *mqh, uint64 nbytes, void *data, bool nowait)
  * When nowait = true, we do not manipulate the state of the process latch;
  * instead, whenever the buffer is empty and we need to read from it, we
  * return SHM_MQ_WOULD_BLOCK.  In this case, the caller should call this
- * function again after the process latch has been set.
+ * function again after the process latch has been set.  If the queue was
+ * attached with a background worker handle and that worker exits without
+ * ever attaching, SHM_MQ_DETACHED is returned; the caller should therefore
+ * arrange to be woken up on worker state changes, too.
  */
 shm_mq_result
 shm_mq_receive(shm_mq_handle *mqh, uint64 *nbytesp, void **datap, bool nowait)
@@ -397,7 +402,26 @@ shm_mq_receive(shm_mq_handle *mqh, uint64 *nbytesp, void **datap, bool nowait)
 		if (nowait)
 		{
 			if (shm_mq_get_sender(mq) == NULL)
-				return SHM_MQ_WOULD_BLOCK;
+			{
+				bool		gone;
+
+				/*
+				 * If the sender will never attach, report that now rather
+				 * than leaving the caller to wait forever.  Recheck after
+				 * deciding, since a sender that attached, sent its data and
+				 * exited in the meantime has not really gone anywhere.
+				 */
+				gone = shm_mq_counterparty_gone(mq, mqh->mqh_handle);
+				if (shm_mq_get_sender(mq) == NULL)
+				{
+					if (gone)
+					{
+						mq->mq_detached = true;
+						return SHM_MQ_DETACHED;
+					}
+					return SHM_MQ_WOULD_BLOCK;
+				}
+			}
 		}
 		else if (!shm_mq_wait_internal(mq, &mq->mq_sender, mqh->mqh_handle))
 		{
@@ -636,7 +660,14 @@ shm_mq_send_bytes(shm_mq_handle *mqh, uint64 nbytes, void *data, bool nowait,
 				if (nowait)
 				{
 					if (shm_mq_get_receiver(mq) == NULL)
+					{
+						if (shm_mq_counterparty_gone(mq, mqh->mqh_handle))
+						{
+							mq->mq_detached = true;
+							return SHM_MQ_DETACHED;
+						}
 						return SHM_MQ_WOULD_BLOCK;
+					}
 				}
 				else if (!shm_mq_wait_internal(mq, &mq->mq_receiver,
 											   mqh->mqh_handle))
@@ -851,6 +882,38 @@ shm_mq_wait_internal(volatile shm_mq *mq, PGPROC * volatile *ptr,
 	return result;
 }
 
+/*
+ * Test whether the counterparty has detached from the queue, or is a
+ * background worker that has exited (or failed to start) and therefore never
+ * will attach.  This is the non-blocking equivalent of the checks made by
+ * shm_mq_wait_internal.
+ */
+static bool
+shm_mq_counterparty_gone(volatile shm_mq *mq, BackgroundWorkerHandle *handle)
+{
+	bool		detached;
+	pid_t		pid;
+
+	/* Acquire the lock just long enough to check the flag. */
+	SpinLockAcquire(&mq->mq_mutex);
+	detached = mq->mq_detached;
+	SpinLockRelease(&mq->mq_mutex);
+
+	if (detached)
+		return true;
+
+	if (handle != NULL)
+	{
+		BgwHandleStatus status;
+
+		status = GetBackgroundWorkerPid(handle, &pid);
+		if (status != BGWH_STARTED && status != BGWH_NOT_YET_STARTED)
+			return true;
+	}
+
+	return false;
+}
+
 /*
  * Get the number of bytes read.  The receiver need not use this to access
  * the count of bytes read, but the sender must.
@@ -12,6 +12,7 @@
  */
 #include "postgres.h"
 
+#include "libpq/pqformat.h"
 #include "utils/array.h"
 #include "utils/builtins.h"
 #include "utils/lsyscache.h"
@@ -508,6 +509,157 @@ array_agg_transfn(PG_FUNCTION_ARGS)
 	PG_RETURN_POINTER(state);
 }
 
+/*
+ * array_agg_combine
+ *		Append the elements accumulated in one array_agg state onto another.
+ *
+ * Must be non-strict: when the running state is NULL we build a fresh one in
+ * our own aggregate context rather than adopting the second argument, which
+ * belongs to somebody else.
+ */
+Datum
+array_agg_combine(PG_FUNCTION_ARGS)
+{
+	MemoryContext aggcontext;
+	ArrayBuildState *state1;
+	ArrayBuildState *state2;
+	int			i;
+
+	if (!AggCheckCallContext(fcinfo, &aggcontext))
+		elog(ERROR, "array_agg_combine called in non-aggregate context");
+
+	state1 = PG_ARGISNULL(0) ? NULL : (ArrayBuildState *) PG_GETARG_POINTER(0);
+	state2 = PG_ARGISNULL(1) ? NULL : (ArrayBuildState *) PG_GETARG_POINTER(1);
+
+	if (state2 == NULL)
+		PG_RETURN_POINTER(state1);
+
+	for (i = 0; i < state2->nelems; i++)
+		state1 = accumArrayResult(state1,
+								  state2->dvalues[i],
+								  state2->dnulls[i],
+								  state2->element_type,
+								  aggcontext);
+
+	PG_RETURN_POINTER(state1);
+}
+
+/*
+ * array_agg_serialize
+ *		Flatten an array_agg state into a bytea.
+ *
+ * The format is the element type OID and element count, followed by a null
+ * flag and, for non-null elements, the binary send representation of each
+ * element.
+ */
+Datum
+array_agg_serialize(PG_FUNCTION_ARGS)
+{
+	ArrayBuildState *state;
+	StringInfoData buf;
+	Oid			typsend;
+	bool		typisvarlena;
+	int			i;
+
+	if (!AggCheckCallContext(fcinfo, NULL))
+		elog(ERROR, "array_agg_serialize called in non-aggregate context");
+
+	state = (ArrayBuildState *) PG_GETARG_POINTER(0);
+
+	getTypeBinaryOutputInfo(state->element_type, &typsend, &typisvarlena);
+
+	pq_begintypsend(&buf);
+	pq_sendint(&buf, state->element_type, sizeof(Oid));
+	pq_sendint(&buf, state->nelems, 4);
+
+	for (i = 0; i < state->nelems; i++)
+	{
+		bytea	   *outputbytes;
+
+		pq_sendbyte(&buf, state->dnulls[i]);
+		if (state->dnulls[i])
+			continue;
+
+		outputbytes = OidSendFunctionCall(typsend, state->dvalues[i]);
+		pq_sendint(&buf, VARSIZE(outputbytes) - VARHDRSZ, 4);
+		pq_sendbytes(&buf, VARDATA(outputbytes),
+					 VARSIZE(outputbytes) - VARHDRSZ);
+		pfree(outputbytes);
+	}
+
+	PG_RETURN_BYTEA_P(pq_endtypsend(&buf));
+}
+
+/*
+ * array_agg_deserialize
+ *		Rebuild an array_agg state from the output of array_agg_serialize.
+ *
+ * The second argument is a dummy that only serves to make the signature
+ * type-safe.  The state is built directly in the current memory context,
+ * since it need only survive until array_agg_combine has copied it.
+ */
+Datum
+array_agg_deserialize(PG_FUNCTION_ARGS)
+{
+	bytea	   *sstate = PG_GETARG_BYTEA_P(0);
+	ArrayBuildState *state;
+	StringInfoData buf;
+	Oid			typreceive;
+	Oid			typioparam;
+	int			i;
+
+	if (!AggCheckCallContext(fcinfo, NULL))
+		elog(ERROR, "array_agg_deserialize called in non-aggregate context");
+
+	buf.data = VARDATA(sstate);
+	buf.len = VARSIZE(sstate) - VARHDRSZ;
+	buf.maxlen = buf.len;
+	buf.cursor = 0;
+
+	state = (ArrayBuildState *) palloc(sizeof(ArrayBuildState));
+	state->mcontext = CurrentMemoryContext;
+	state->element_type = (Oid) pq_getmsgint(&buf, sizeof(Oid));
+	state->nelems = pq_getmsgint(&buf, 4);
+	if (state->nelems < 0)
+		elog(ERROR, "invalid array_agg state");
+	state->alen = Max(state->nelems, 1);
+	state->dvalues = (Datum *) palloc(state->alen * sizeof(Datum));
+	state->dnulls = (bool *) palloc(state->alen * sizeof(bool));
+	get_typlenbyvalalign(state->element_type,
+						 &state->typlen,
+						 &state->typbyval,
+						 &state->typalign);
+	getTypeBinaryInputInfo(state->element_type, &typreceive, &typioparam);
+
+	for (i = 0; i < state->nelems; i++)
+	{
+		StringInfoData elem_buf;
+		int			itemlen;
+
+		state->dnulls[i] = (pq_getmsgbyte(&buf) != 0);
+		if (state->dnulls[i])
+		{
+			state->dvalues[i] = (Datum) 0;
+			continue;
+		}
+
+		/* Make a null-terminated copy for the receive function's sake */
+		itemlen = pq_getmsgint(&buf, 4);
+		if (itemlen < 0 || itemlen > (buf.len - buf.cursor))
+			elog(ERROR, "invalid array_agg state");
+		initStringInfo(&elem_buf);
+		appendBinaryStringInfo(&elem_buf, pq_getmsgbytes(&buf, itemlen),
+							   itemlen);
+
+		state->dvalues[i] = OidReceiveFunctionCall(typreceive, &elem_buf,
+												   typioparam, -1);
+		pfree(elem_buf.data);
+	}
+	pq_getmsgend(&buf);
+
+	PG_RETURN_POINTER(state);
+}
+
 Datum
 array_agg_finalfn(PG_FUNCTION_ARGS)
 {
@@ -1855,6 +1855,60 @@ float8_accum(PG_FUNCTION_ARGS)
 	}
 }
 
+/*
+ * float8_combine
+ *
+ * Combine two float8_accum/float4_accum transition states, so that partial
+ * aggregates computed over disjoint inputs can be merged.
+ */
+Datum
+float8_combine(PG_FUNCTION_ARGS)
+{
+	ArrayType  *transarray1 = PG_GETARG_ARRAYTYPE_P(0);
+	ArrayType  *transarray2 = PG_GETARG_ARRAYTYPE_P(1);
+	float8	   *transvalues1;
+	float8	   *transvalues2;
+	float8		N,
+				sumX,
+				sumX2;
+
+	transvalues1 = check_float8_array(transarray1, "float8_combine", 3);
+	transvalues2 = check_float8_array(transarray2, "float8_combine", 3);
+
+	N = transvalues1[0] + transvalues2[0];
+	sumX = transvalues1[1] + transvalues2[1];
+	CHECKFLOATVAL(sumX, isinf(transvalues1[1]) || isinf(transvalues2[1]),
+				  true);
+	sumX2 = transvalues1[2] + transvalues2[2];
+	CHECKFLOATVAL(sumX2, isinf(transvalues1[2]) || isinf(transvalues2[2]),
+				  true);
+
+	/* As in float8_accum, scribble on the first state if we're allowed to */
+	if (AggCheckCallContext(fcinfo, NULL))
+	{
+		transvalues1[0] = N;
+		transvalues1[1] = sumX;
+		transvalues1[2] = sumX2;
+
+		PG_RETURN_ARRAYTYPE_P(transarray1);
+	}
+	else
+	{
+		Datum		transdatums[3];
+		ArrayType  *result;
+
+		transdatums[0] = Float8GetDatumFast(N);
+		transdatums[1] = Float8GetDatumFast(sumX);
+		transdatums[2] = Float8GetDatumFast(sumX2);
+
+		result = construct_array(transdatums, 3,
+								 FLOAT8OID,
+								 sizeof(float8), FLOAT8PASSBYVAL, 'd');
+
+		PG_RETURN_ARRAYTYPE_P(result);
+	}
+}
+
 Datum
 float4_accum(PG_FUNCTION_ARGS)
 {
@@ -350,6 +350,9 @@ static void get_target_list(List *targetList, deparse_context *context,
 static void get_setop_query(Node *setOp, Query *query,
 				deparse_context *context,
 				TupleDesc resultDesc);
+static void get_rule_groupingset(GroupingSet *gset, List *groupClause,
+					 List *targetlist, bool omit_parens,
+					 deparse_context *context);
 static Node *get_rule_sortgroupclause(SortGroupClause *srt, List *tlist,
 						 bool force_colno,
 						 deparse_context *context);
@@ -373,7 +376,10 @@ static void get_rule_expr(Node *node, deparse_context *context,
 static void get_oper_expr(OpExpr *expr, deparse_context *context);
 static void get_func_expr(FuncExpr *expr, deparse_context *context,
 			  bool showimplicit);
-static void get_agg_expr(Aggref *aggref, deparse_context *context);
+static void get_agg_expr(Aggref *aggref, deparse_context *context,
+			 Aggref *original_aggref);
+static void get_agg_combine_expr(Node *node, deparse_context *context,
+					 Aggref *original_aggref);
 static void get_windowfunc_expr(WindowFunc *wfunc, deparse_context *context);
 static void get_coercion_expr(Node *arg, deparse_context *context,
 				  Oid resulttype, int32 resulttypmod,
@@ -4484,19 +4490,35 @@ get_basic_select_query(Query *query, deparse_context *context,
 	}
 
 	/* Add the GROUP BY clause if given */
-	if (query->groupClause != NULL)
+	if (query->groupClause != NULL || query->groupingSets != NULL)
 	{
 		appendContextKeyword(context, " GROUP BY ",
 							 -PRETTYINDENT_STD, PRETTYINDENT_STD, 1);
-		sep = "";
-		foreach(l, query->groupClause)
+		if (query->groupingSets == NIL)
 		{
-			SortGroupClause *grp = (SortGroupClause *) lfirst(l);
+			sep = "";
+			foreach(l, query->groupClause)
+			{
+				SortGroupClause *grp = (SortGroupClause *) lfirst(l);
 
-			appendStringInfoString(buf, sep);
-			get_rule_sortgroupclause(grp, query->targetList,
-									 false, context);
-			sep = ", ";
+				appendStringInfoString(buf, sep);
+				get_rule_sortgroupclause(grp, query->targetList,
+										 false, context);
+				sep = ", ";
+			}
+		}
+		else
+		{
+			sep = "";
+			foreach(l, query->groupingSets)
+			{
+				GroupingSet *grp = lfirst(l);
+
+				appendStringInfoString(buf, sep);
+				get_rule_groupingset(grp, query->groupClause,
+									 query->targetList, true, context);
+				sep = ", ";
+			}
 		}
 	}
 
@@ -4783,6 +4805,81 @@ get_rule_sortgroupclause(SortGroupClause *srt, List *tlist, bool force_colno,
 	return expr;
 }
 
+/*
+ * Display a GroupingSet.  The expressions of SIMPLE sets are found through
+ * the query's groupClause by their sortgroupref.
+ */
+static void
+get_rule_groupingset(GroupingSet *gset, List *groupClause, List *targetlist,
+					 bool omit_parens, deparse_context *context)
+{
+	ListCell   *l;
+	StringInfo	buf = context->buf;
+	bool		omit_child_parens = true;
+	char	   *sep = "";
+
+	switch (gset->kind)
+	{
+		case GROUPING_SET_EMPTY:
+			appendStringInfoString(buf, "()");
+			return;
+
+		case GROUPING_SET_SIMPLE:
+			{
+				if (!omit_parens || list_length(gset->content) != 1)
+					appendStringInfoString(buf, "(");
+
+				foreach(l, gset->content)
+				{
+					Index		ref = lfirst_int(l);
+					SortGroupClause *grp = NULL;
+					ListCell   *lc;
+
+					foreach(lc, groupClause)
+					{
+						grp = (SortGroupClause *) lfirst(lc);
+						if (grp->tleSortGroupRef == ref)
+							break;
+						grp = NULL;
+					}
+					if (grp == NULL)
+						elog(ERROR, "could not find grouping clause for ref %u",
+							 ref);
+
+					appendStringInfoString(buf, sep);
+					get_rule_sortgroupclause(grp, targetlist,
+											 false, context);
+					sep = ", ";
+				}
+
+				if (!omit_parens || list_length(gset->content) != 1)
+					appendStringInfoString(buf, ")");
+			}
+			return;
+
+		case GROUPING_SET_ROLLUP:
+			appendStringInfoString(buf, "ROLLUP(");
+			break;
+		case GROUPING_SET_CUBE:
+			appendStringInfoString(buf, "CUBE(");
+			break;
+		case GROUPING_SET_SETS:
+			appendStringInfoString(buf, "GROUPING SETS (");
+			omit_child_parens = false;
+			break;
+	}
+
+	foreach(l, gset->content)
+	{
+		appendStringInfoString(buf, sep);
+		get_rule_groupingset(lfirst(l), groupClause, targetlist,
+							 omit_child_parens, context);
+		sep = ", ";
+	}
+
+	appendStringInfoString(buf, ")");
+}
+
 /*
  * Display an ORDER BY list.
  */
@@ -6165,6 +6262,7 @@ isSimpleNode(Node *node, Node *parentNode, int prettyFlags)
 		case T_XmlExpr:
 		case T_NullIfExpr:
 		case T_Aggref:
+		case T_GroupingFunc:
 		case T_WindowFunc:
 		case T_FuncExpr:
 			/* function-like: name(..) or name[..] */
@@ -6281,6 +6379,7 @@ isSimpleNode(Node *node, Node *parentNode, int prettyFlags)
 				case T_XmlExpr:	/* own parentheses */
 				case T_NullIfExpr:		/* other separators */
 				case T_Aggref:	/* own parentheses */
+				case T_GroupingFunc:	/* own parentheses */
 				case T_WindowFunc:		/* own parentheses */
 				case T_CaseExpr:		/* other separators */
 					return true;
@@ -6331,6 +6430,7 @@ isSimpleNode(Node *node, Node *parentNode, int prettyFlags)
 				case T_XmlExpr:	/* own parentheses */
 				case T_NullIfExpr:		/* other separators */
 				case T_Aggref:	/* own parentheses */
+				case T_GroupingFunc:	/* own parentheses */
 				case T_WindowFunc:		/* own parentheses */
 				case T_CaseExpr:		/* other separators */
 					return true;
@@ -6466,7 +6566,17 @@ get_rule_expr(Node *node, deparse_context *context,
 			break;
 
 		case T_Aggref:
-			get_agg_expr((Aggref *) node, context);
+			get_agg_expr((Aggref *) node, context, (Aggref *) node);
+			break;
+
+		case T_GroupingFunc:
+			{
+				GroupingFunc *gexpr = (GroupingFunc *) node;
+
+				appendStringInfoString(buf, "GROUPING(");
+				get_rule_expr((Node *) gexpr->args, context, true);
+				appendStringInfoChar(buf, ')');
+			}
 			break;
 
 		case T_WindowFunc:
@@ -7524,13 +7634,32 @@ get_func_expr(FuncExpr *expr, deparse_context *context,
  * get_agg_expr			- Parse back an Aggref node
  */
 static void
-get_agg_expr(Aggref *aggref, deparse_context *context)
+get_agg_expr(Aggref *aggref, deparse_context *context,
+			 Aggref *original_aggref)
 {
 	StringInfo	buf = context->buf;
 	Oid			argtypes[FUNC_MAX_ARGS];
 	int			nargs;
 	bool		use_variadic;
 
+	/*
+	 * A combining aggregate's argument refers to the output of a partial
+	 * aggregate further down the plan.  Print that aggregate instead, but
+	 * decorated as the combining one would be.
+	 */
+	if (aggref->aggcombine)
+	{
+		TargetEntry *tle = (TargetEntry *) linitial(aggref->args);
+
+		Assert(list_length(aggref->args) == 1);
+		get_agg_combine_expr((Node *) tle->expr, context, original_aggref);
+		return;
+	}
+
+	/* Mark as PARTIAL, if appropriate */
+	if (original_aggref->aggpartial)
+		appendStringInfoString(buf, "PARTIAL ");
+
 	/* Extract the argument types as seen by the parser */
 	nargs = get_aggregate_argtypes(aggref, argtypes);
 
@@ -7598,6 +7727,42 @@ get_agg_expr(Aggref *aggref, deparse_context *context)
 	appendStringInfoChar(buf, ')');
 }
 
+/*
+ * get_agg_combine_expr - find and print the partial aggregate that a
+ * combining aggregate's argument refers to
+ *
+ * In a plan tree the argument is an OUTER_VAR reference, which we chase down
+ * through the child plans' target lists until we reach the Aggref.
+ */
+static void
+get_agg_combine_expr(Node *node, deparse_context *context,
+					 Aggref *original_aggref)
+{
+	deparse_namespace *dpns;
+
+	dpns = (deparse_namespace *) linitial(context->namespaces);
+
+	if (IsA(node, Var) &&
+		((Var *) node)->varno == OUTER_VAR && dpns->outer_tlist)
+	{
+		Var		   *var = (Var *) node;
+		TargetEntry *tle;
+		deparse_namespace save_dpns;
+
+		tle = get_tle_by_resno(dpns->outer_tlist, var->varattno);
+		if (!tle)
+			elog(ERROR, "bogus varattno for OUTER_VAR var: %d", var->varattno);
+
+		push_child_plan(dpns, dpns->outer_planstate, &save_dpns);
+		get_agg_combine_expr((Node *) tle->expr, context, original_aggref);
+		pop_child_plan(dpns, &save_dpns);
+	}
+	else if (IsA(node, Aggref))
+		get_agg_expr((Aggref *) node, context, original_aggref);
+	else
+		elog(ERROR, "combining aggregate does not refer to a partial aggregate");
+}
+
 /*
  * get_windowfunc_expr	- Parse back a WindowFunc node
  */
@@ -6222,6 +6222,93 @@ add_predicate_to_quals(IndexOptInfo *index, List *indexQuals)
 	return list_concat(predExtraQuals, indexQuals);
 }
 
+/*
+ * Estimate the cost of a btree skip scan.
+ *
+ * When there are no quals on the first index column but there are some on
+ * the second, nbtree does one primitive index scan for each distinct value
+ * of the first column, using the quals on the second column as boundaries
+ * within it (see _bt_preprocess_skip_key).  Each such scan costs two descents
+ * of the tree, one to find the value and one to position on the matching
+ * entries, plus at least one leaf page visit.  If we have statistics to tell
+ * us how many distinct values there are, fill *costs with the estimate and
+ * return true; otherwise return false.
+ */
+static bool
+btskipcostestimate(PlannerInfo *root, IndexPath *path, double loop_count,
+				   GenericCosts *costs)
+{
+	IndexOptInfo *index = path->indexinfo;
+	List	   *skipBoundQuals = NIL;
+	TargetEntry *leadtle;
+	VariableStatData vardata;
+	double		ndistinct;
+	bool		isdefault;
+	Selectivity btreeSelectivity;
+	double		numIndexTuples;
+	Cost		descentCost;
+	ListCell   *lcc,
+			   *lci;
+
+	if (index->ncolumns < 2 || index->indextlist == NIL)
+		return false;
+
+	/* nbtree doesn't skip if there are ScalarArrayOpExprs, either */
+	forboth(lcc, path->indexquals, lci, path->indexqualcols)
+	{
+		RestrictInfo *rinfo = (RestrictInfo *) lfirst(lcc);
+		int			indexcol = lfirst_int(lci);
+
+		if (indexcol == 0 || IsA(rinfo->clause, ScalarArrayOpExpr))
+			return false;
+		if (indexcol == 1)
+			skipBoundQuals = lappend(skipBoundQuals, rinfo);
+	}
+	if (skipBoundQuals == NIL)
+		return false;
+
+	/* How many distinct values does the first column have? */
+	leadtle = (TargetEntry *) linitial(index->indextlist);
+	examine_variable(root, (Node *) leadtle->expr, 0, &vardata);
+	ndistinct = get_variable_numdistinct(&vardata, &isdefault);
+	ReleaseVariableStats(vardata);
+	if (isdefault)
+		return false;
+
+	/*
+	 * Within each value, the quals on the second column act as boundary
+	 * quals; but each primitive scan reads at least part of one leaf page,
+	 * so charge for a leaf page's worth of tuples per value, too.
+	 */
+	btreeSelectivity = clauselist_selectivity(root,
+									add_predicate_to_quals(index,
+														   skipBoundQuals),
+											  index->rel->relid,
+											  JOIN_INNER,
+											  NULL);
+	numIndexTuples = btreeSelectivity * index->rel->tuples;
+	if (index->pages > 1)
+		numIndexTuples += ndistinct * index->tuples / index->pages;
+	numIndexTuples = rint(Min(numIndexTuples, index->tuples));
+
+	MemSet(costs, 0, sizeof(GenericCosts));
+	costs->numIndexTuples = Max(numIndexTuples, 1.0);
+
+	genericcostestimate(root, path, loop_count, costs);
+
+	/*
+	 * Charge for the descents just as btcostestimate does for a single one,
+	 * but twice per value.
+	 */
+	descentCost = (index->tree_height + 1) * 50.0 * cpu_operator_cost;
+	if (index->tuples > 1)		/* avoid computing log(0) */
+		descentCost += ceil(log(index->tuples) / log(2.0)) * cpu_operator_cost;
+	costs->indexStartupCost += 2 * descentCost;
+	costs->indexTotalCost += 2 * ndistinct * descentCost;
+
+	return true;
+}
+
 
 Datum
 btcostestimate(PG_FUNCTION_ARGS)
@@ -6454,6 +6541,29 @@ btcostestimate(PG_FUNCTION_ARGS)
 	costs.indexStartupCost += descentCost;
 	costs.indexTotalCost += costs.num_sa_scans * descentCost;
 
+	/*
+	 * Without any quals on the first index column, everything above assumes
+	 * that the whole index will be read.  But if there are quals on the
+	 * second column, nbtree can skip from one value of the first column to
+	 * the next instead; use that estimate if it's cheaper.  (If the values
+	 * prove to be too dense for skipping to pay off, nbtree reverts to
+	 * reading the index sequentially, so the cheaper of the two estimates is
+	 * the right one to believe.)
+	 */
+	if (indexBoundQuals == NIL && path->indexquals != NIL)
+	{
+		GenericCosts skipcosts;
+
+		if (btskipcostestimate(root, path, loop_count, &skipcosts) &&
+			skipcosts.indexTotalCost < costs.indexTotalCost)
+		{
+			costs.indexStartupCost = skipcosts.indexStartupCost;
+			costs.indexTotalCost = skipcosts.indexTotalCost;
+			costs.numIndexPages = skipcosts.numIndexPages;
+			costs.numIndexTuples = skipcosts.numIndexTuples;
+		}
+	}
+
 	/*
 	 * If we can get an estimate of the first column's ordering correlation C
 	 * from pg_statistic, estimate the index correlation as C for a
@@ -258,6 +258,11 @@ MemoryContextSetParent(MemoryContext context, MemoryContext new_parent)
 	if (context->parent)
 	{
 		MemoryContext parent = context->parent;
+		MemoryContext ancestor;
+
+		/* Its space no longer counts against its former ancestors */
+		for (ancestor = parent; ancestor; ancestor = ancestor->parent)
+			ancestor->mem_allocated -= context->mem_allocated;
 
 		if (context == parent->firstchild)
 			parent->firstchild = context->nextchild;
@@ -279,10 +284,15 @@ MemoryContextSetParent(MemoryContext context, MemoryContext new_parent)
 	/* And relink */
 	if (new_parent)
 	{
+		MemoryContext ancestor;
+
 		AssertArg(MemoryContextIsValid(new_parent));
 		context->parent = new_parent;
 		context->nextchild = new_parent->firstchild;
 		new_parent->firstchild = context;
+
+		for (ancestor = new_parent; ancestor; ancestor = ancestor->parent)
+			ancestor->mem_allocated += context->mem_allocated;
 	}
 	else
 	{
@@ -384,6 +394,42 @@ MemoryContextIsEmpty(MemoryContext context)
 	return (*context->methods->is_empty) (context);
 }
 
+/*
+ * MemoryContextMemAllocated
+ *		Return the amount of memory obtained from malloc() by the context
+ *		and all its descendants.
+ *
+ * This counts whole blocks, including free space within them, so it is a
+ * better measure of the process's real memory consumption than the sum of
+ * the chunks handed out.  It's cheap enough to call once per tuple.
+ */
+Size
+MemoryContextMemAllocated(MemoryContext context)
+{
+	AssertArg(MemoryContextIsValid(context));
+
+	return context->mem_allocated;
+}
+
+/*
+ * MemoryContextUpdateAllocation
+ *		Adjust the amount of memory recorded as malloc'd by a context.
+ *
+ * The change applies to all the context's ancestors too, so that looking
+ * up the total for a context never requires a walk over its descendants.
+ * Since blocks are obtained from malloc() only rarely, walking up the
+ * parent chain here costs little.
+ */
+void
+MemoryContextUpdateAllocation(MemoryContext context, int64 delta)
+{
+	for (; context != NULL; context = context->parent)
+	{
+		Assert(delta >= 0 || context->mem_allocated >= (Size) -delta);
+		context->mem_allocated += delta;
+	}
+}
+
 /*
  * MemoryContextStats
  *		Print statistics about the named context and all its descendants.
@@ -541,6 +587,7 @@ MemoryContextCreate(NodeTag tag, Size size,
 	node->firstchild = NULL;
 	node->nextchild = NULL;
 	node->isReset = true;
+	node->mem_allocated = 0;
 	node->name = ((char *) node) + size;
 	strcpy(node->name, name);
 
@@ -11,24 +11,19 @@
  * algorithm.
  *
  * See Knuth, volume 3, for more than you want to know about the external
- * sorting algorithm.  We divide the input into sorted runs using replacement
- * selection, in the form of a priority tree implemented as a heap
- * (essentially his Algorithm 5.2.3H), then merge the runs using polyphase
- * merge, Knuth's Algorithm 5.4.2D.  The logical "tapes" used by Algorithm D
- * are implemented by logtape.c, which avoids space wastage by recycling
- * disk space as soon as each block is read from its "tape".
- *
- * We do not form the initial runs using Knuth's recommended replacement
- * selection data structure (Algorithm 5.4.1R), because it uses a fixed
- * number of records in memory at all times.  Since we are dealing with
- * tuples that may vary considerably in size, we want to be able to vary
- * the number of records kept in memory to ensure full utilization of the
- * allowed sort memory space.  So, we keep the tuples in a variable-size
- * heap, with the next record to go out at the top of the heap.  Like
- * Algorithm 5.4.1R, each record is stored with the run number that it
- * must go into, and we use (run number, key) as the ordering key for the
- * heap.  When the run number at the top of the heap changes, we know that
- * no more records of the prior run are left in the heap.
+ * sorting algorithm.  Historically, we divided the input into sorted runs
+ * using replacement selection, in the form of a priority tree implemented
+ * as a heap (essentially his Algorithm 5.2.3H).  That produces runs about
+ * twice the size of memory on random input, but a heap the size of a large
+ * workMem is extremely cache-unfriendly, and each tuple costs O(log n)
+ * comparisons with poor locality both when it enters and when it leaves the
+ * heap.  We now instead fill memory, quicksort it, and write the result out
+ * as a run; the runs are then merged using polyphase merge, Knuth's
+ * Algorithm 5.4.2D.  Since quicksorted runs are about as large as workMem,
+ * there are rarely more runs than tapes, and Algorithm D then degenerates
+ * into a single multiway merge.  The logical "tapes" used by Algorithm D are
+ * implemented by logtape.c, which avoids space wastage by recycling disk
+ * space as soon as each block is read from its "tape".
  *
  * The approximate amount of memory allowed for any one sort operation
  * is specified in kilobytes by the caller (most pass work_mem).  Initially,
@@ -36,13 +31,12 @@
  * we haven't exceeded workMem.  If we reach the end of the input without
  * exceeding workMem, we sort the array using qsort() and subsequently return
  * tuples just by scanning the tuple array sequentially.  If we do exceed
- * workMem, we construct a heap using Algorithm H and begin to emit tuples
- * into sorted runs in temporary tapes, emitting just enough tuples at each
- * step to get back within the workMem limit.  Whenever the run number at
- * the top of the heap changes, we begin a new run with a new output tape
- * (selected per Algorithm D).	After the end of the input is reached,
- * we dump out remaining tuples in memory into a final run (or two),
- * then merge the runs using Algorithm D.
+ * workMem, we begin to emit tuples into sorted runs in temporary tapes.
+ * Each time memory fills up again, we sort the array using qsort() and write
+ * all of it to the current output tape, then select a new output tape for
+ * the next run (per Algorithm D).  After the end of the input is reached,
+ * we dump out remaining tuples in memory into a final run, then merge the
+ * runs using Algorithm D.
  *
  * When merging runs, we use a heap containing just the frontmost tuple from
  * each source run; we repeatedly output the smallest tuple and insert the
@@ -84,7 +78,16 @@
  * code we determine the number of tapes M on the basis of workMem: we want
  * workMem/M to be large enough that we read a fair amount of data each time
  * we preread from a tape, so as to maintain the locality of access described
- * above.  Nonetheless, with large workMem we can have many tapes.
+ * above.  M is capped at MAXORDER, though: beyond that, a merge heap of M
+ * entries hurts more than another merge pass would, and tape buffers would
+ * use up memory better spent on prereading.  When the runs all fit in a
+ * single merge, the buffer space reserved for unused tapes is given back for
+ * prereading before the merge starts.
+ *
+ * Instead of accepting tuples one at a time, a sort can be given a set of
+ * input streams that are already sorted (for instance, the output of
+ * sorts done by parallel workers).  In that case there's nothing to do but
+ * the final merge, which is performed on-the-fly like the tape-based one.
  *
  *
  * Portions Copyright (c) 1996-2014, PostgreSQL Global Development Group
@@ -147,16 +150,20 @@ bool		optimize_bounded_sort = true;
  * case where the first key determines the comparison result.  Note that
  * for a pass-by-reference datatype, datum1 points into the "tuple" storage.
  *
+ * There is one special case: when the sort support infrastructure provides an
+ * "abbreviated key" representation, where the key is (typically) a pass by
+ * value proxy for a pass by reference type.  In this case, the abbreviated key
+ * is stored in datum1 in place of the actual first key column.
+ *
  * When sorting single Datums, the data value is represented directly by
  * datum1/isnull1.	If the datatype is pass-by-reference and isnull1 is false,
  * then datum1 points to a separately palloc'd data value that is also pointed
  * to by the "tuple" pointer; otherwise "tuple" is NULL.
  *
- * While building initial runs, tupindex holds the tuple's run number.  During
- * merge passes, we re-use it to hold the input tape number that each tuple in
- * the heap was read from, or to hold the index of the next tuple pre-read
- * from the same tape in the case of pre-read entries.	tupindex goes unused
- * if the sort occurs entirely in memory.
+ * During merge passes, tupindex holds the input tape number that each tuple
+ * in the heap was read from, or the index of the next tuple pre-read from
+ * the same tape in the case of pre-read entries.  tupindex goes unused while
+ * building initial runs, and if the sort occurs entirely in memory.
  */
 typedef struct
 {
@@ -178,7 +185,9 @@ typedef enum
 	TSS_BUILDRUNS,				/* Loading tuples; writing to tape */
 	TSS_SORTEDINMEM,			/* Sort completed entirely in memory */
 	TSS_SORTEDONTAPE,			/* Sort completed, final run is on tape */
-	TSS_FINALMERGE				/* Performing final merge on-the-fly */
+	TSS_FINALMERGE,				/* Performing final merge on-the-fly */
+	TSS_SOURCES,				/* Waiting to merge presorted input streams */
+	TSS_MERGESOURCES			/* Merging presorted input streams on-the-fly */
 } TupSortStatus;
 
 /*
@@ -193,6 +202,7 @@ typedef enum
  * tape during a preread cycle (see discussion at top of file).
  */
 #define MINORDER		6		/* minimum merge order */
+#define MAXORDER		500		/* maximum merge order */
 #define TAPE_BUFFER_OVERHEAD		(BLCKSZ * 3)
 #define MERGE_BUFFER_SIZE			(BLCKSZ * 32)
 
@@ -279,8 +289,9 @@ struct Tuplesortstate
 	bool		growmemtuples;	/* memtuples' growth still underway? */
 
 	/*
-	 * While building initial runs, this is the current output run number
-	 * (starting at 0).  Afterwards, it is the number of initial runs we made.
+	 * While building initial runs, this is the number of runs written so far
+	 * (including the one being written, if any).  Afterwards, it is the
+	 * number of initial runs we made.
 	 */
 	int			currentRun;
 
@@ -352,12 +363,31 @@ struct Tuplesortstate
 	 */
 	SortSupport onlyKey;
 
+	/*
+	 * Additional state for managing "abbreviated key" sortsupport routines
+	 * (which currently may be used by all cases except the Datum sort case
+	 * and CLUSTER).  Tracks the intervals at which the optimization's
+	 * effectiveness is tested.
+	 */
+	int			abbrevNext;		/* Tuple # at which to next check
+								 * applicability */
+
+	/*
+	 * These variables are used only when the input is a set of presorted
+	 * streams supplied by tuplesort_attach_sources(), rather than tuples
+	 * passed to the put routines.  The merge heap holds one tuple from each
+	 * stream, with tupindex identifying the stream it came from.
+	 */
+	int			nsources;		/* number of input streams */
+	TuplesortSourceFetch sourcefetch;	/* fetches next tuple of a stream */
+	void	   *sourcearg;		/* passthrough argument for sourcefetch */
+
 	/*
 	 * These variables are specific to the CLUSTER case; they are set by
-	 * tuplesort_begin_cluster.  Note CLUSTER also uses tupDesc and
-	 * indexScanKey.
+	 * tuplesort_begin_cluster.  Note CLUSTER also uses tupDesc.
 	 */
 	IndexInfo  *indexInfo;		/* info about index being used for reference */
+	ScanKey		indexScanKey;	/* btree comparison info for index columns */
 	EState	   *estate;			/* for evaluating index expressions */
 
 	/*
@@ -368,7 +398,6 @@ struct Tuplesortstate
 	Relation	indexRel;		/* index being built */
 
 	/* These are specific to the index_btree subcase: */
-	ScanKey		indexScanKey;
 	bool		enforceUnique;	/* complain if we find duplicate tuples */
 
 	/* These are specific to the index_hash subcase: */
@@ -453,17 +482,21 @@ static Tuplesortstate *tuplesort_begin_common(int workMem, bool randomAccess);
 static void puttuple_common(Tuplesortstate *state, SortTuple *tuple);
 static void inittapes(Tuplesortstate *state);
 static void selectnewtape(Tuplesortstate *state);
+static bool consider_abort_common(Tuplesortstate *state);
 static void mergeruns(Tuplesortstate *state);
 static void mergeonerun(Tuplesortstate *state);
 static void beginmerge(Tuplesortstate *state);
 static void mergepreread(Tuplesortstate *state);
 static void mergeprereadone(Tuplesortstate *state, int srcTape);
+static void beginsourcemerge(Tuplesortstate *state);
+static void mergesourceone(Tuplesortstate *state, int source);
 static void dumptuples(Tuplesortstate *state, bool alltuples);
 static void make_bounded_heap(Tuplesortstate *state);
 static void sort_bounded_heap(Tuplesortstate *state);
+static void tuplesort_sort_memtuples(Tuplesortstate *state);
 static void tuplesort_heap_insert(Tuplesortstate *state, SortTuple *tuple,
-					  int tupleindex, bool checkIndex);
-static void tuplesort_heap_siftup(Tuplesortstate *state, bool checkIndex);
+					  int tupleindex);
+static void tuplesort_heap_siftup(Tuplesortstate *state);
 static unsigned int getlen(Tuplesortstate *state, int tapenum, bool eofOK);
 static void markrunend(Tuplesortstate *state, int tapenum);
 static int comparetup_heap(const SortTuple *a, const SortTuple *b,
@@ -481,6 +514,7 @@ static void writetup_cluster(Tuplesortstate *state, int tapenum,
 				 SortTuple *stup);
 static void readtup_cluster(Tuplesortstate *state, SortTuple *stup,
 				int tapenum, unsigned int len);
+static void reversedirection_cluster(Tuplesortstate *state);
 static int comparetup_index_btree(const SortTuple *a, const SortTuple *b,
 					   Tuplesortstate *state);
 static int comparetup_index_hash(const SortTuple *a, const SortTuple *b,
@@ -590,6 +624,8 @@ tuplesort_begin_common(int workMem, bool randomAccess)
 
 	state->result_tape = -1;	/* flag that result tape has not been formed */
 
+	state->abbrevNext = 10;
+
 	MemoryContextSwitchTo(oldcontext);
 
 	return state;
@@ -647,11 +683,19 @@ tuplesort_begin_heap(TupleDesc tupDesc,
 		sortKey->ssup_collation = sortCollations[i];
 		sortKey->ssup_nulls_first = nullsFirstFlags[i];
 		sortKey->ssup_attno = attNums[i];
+		/* Convey if abbreviation optimization is applicable in principle */
+		sortKey->abbreviate = (i == 0);
 
 		PrepareSortSupportFromOrderingOp(sortOperators[i], sortKey);
 	}
 
-	if (nkeys == 1)
+	/*
+	 * The "onlyKey" optimization cannot be used with abbreviated keys, since
+	 * tie-breaker comparisons may be required.  Typically, the optimization
+	 * is only of value to pass-by-value types anyway, whereas abbreviated
+	 * keys are typically only of value to pass-by-reference types.
+	 */
+	if (nkeys == 1 && !state->sortKeys->abbrev_converter)
 		state->onlyKey = state->sortKeys;
 
 	MemoryContextSwitchTo(oldcontext);
@@ -691,7 +735,7 @@ tuplesort_begin_cluster(TupleDesc tupDesc,
 	state->copytup = copytup_cluster;
 	state->writetup = writetup_cluster;
 	state->readtup = readtup_cluster;
-	state->reversedirection = reversedirection_index_btree;
+	state->reversedirection = reversedirection_cluster;
 
 	state->indexInfo = BuildIndexInfo(indexRel);
 	state->indexScanKey = _bt_mkscankey_nodata(indexRel);
@@ -727,7 +771,9 @@ tuplesort_begin_index_btree(Relation heapRel,
 							int workMem, bool randomAccess)
 {
 	Tuplesortstate *state = tuplesort_begin_common(workMem, randomAccess);
+	ScanKey		indexScanKey;
 	MemoryContext oldcontext;
+	int			i;
 
 	oldcontext = MemoryContextSwitchTo(state->sortcontext);
 
@@ -755,9 +801,38 @@ tuplesort_begin_index_btree(Relation heapRel,
 
 	state->heapRel = heapRel;
 	state->indexRel = indexRel;
-	state->indexScanKey = _bt_mkscankey_nodata(indexRel);
 	state->enforceUnique = enforceUnique;
 
+	indexScanKey = _bt_mkscankey_nodata(indexRel);
+
+	/* Prepare SortSupport data for each column */
+	state->sortKeys = (SortSupport) palloc0(state->nKeys *
+											sizeof(SortSupportData));
+
+	for (i = 0; i < state->nKeys; i++)
+	{
+		SortSupport sortKey = state->sortKeys + i;
+		ScanKey		scanKey = indexScanKey + i;
+		int16		strategy;
+
+		sortKey->ssup_cxt = CurrentMemoryContext;
+		sortKey->ssup_collation = scanKey->sk_collation;
+		sortKey->ssup_nulls_first =
+			(scanKey->sk_flags & SK_BT_NULLS_FIRST) != 0;
+		sortKey->ssup_attno = scanKey->sk_attno;
+		/* Convey if abbreviation optimization is applicable in principle */
+		sortKey->abbreviate = (i == 0);
+
+		AssertState(sortKey->ssup_attno != 0);
+
+		strategy = (scanKey->sk_flags & SK_BT_DESC) != 0 ?
+			BTGreaterStrategyNumber : BTLessStrategyNumber;
+
+		PrepareSortSupportFromIndexRel(indexRel, strategy, sortKey);
+	}
+
+	_bt_freeskey(indexScanKey);
+
 	MemoryContextSwitchTo(oldcontext);
 
 	return state;
@@ -1251,7 +1326,7 @@ puttuple_common(Tuplesortstate *state, SortTuple *tuple)
 			inittapes(state);
 
 			/*
-			 * Dump tuples until we are back under the limit.
+			 * Sort and dump all the tuples we have as the first run.
 			 */
 			dumptuples(state, false);
 			break;
@@ -1276,34 +1351,24 @@ puttuple_common(Tuplesortstate *state, SortTuple *tuple)
 			{
 				/* discard top of heap, sift up, insert new tuple */
 				free_sort_tuple(state, &state->memtuples[0]);
-				tuplesort_heap_siftup(state, false);
-				tuplesort_heap_insert(state, tuple, 0, false);
+				tuplesort_heap_siftup(state);
+				tuplesort_heap_insert(state, tuple, 0);
 			}
 			break;
 
 		case TSS_BUILDRUNS:
 
 			/*
-			 * Insert the tuple into the heap, with run number currentRun if
-			 * it can go into the current run, else run number currentRun+1.
-			 * The tuple can go into the current run if it is >= the first
-			 * not-yet-output tuple.  (Actually, it could go into the current
-			 * run if it is >= the most recently output tuple ... but that
-			 * would require keeping around the tuple we last output, and it's
-			 * simplest to let writetup free each tuple as soon as it's
-			 * written.)
-			 *
-			 * Note there will always be at least one tuple in the heap at
-			 * this point; see dumptuples.
+			 * Save the tuple into the unsorted array (there must be space;
+			 * dumptuples empties the array whenever it fills up).  We don't
+			 * grow the array any further once building runs, since the
+			 * memory it would take is better spent on tuples.
 			 */
-			Assert(state->memtupcount > 0);
-			if (COMPARETUP(state, tuple, &state->memtuples[0]) >= 0)
-				tuplesort_heap_insert(state, tuple, state->currentRun, true);
-			else
-				tuplesort_heap_insert(state, tuple, state->currentRun + 1, true);
+			Assert(state->memtupcount < state->memtupsize);
+			state->memtuples[state->memtupcount++] = *tuple;
 
 			/*
-			 * If we are over the memory limit, dump tuples till we're under.
+			 * If we are over the memory limit, sort and dump all tuples.
 			 */
 			dumptuples(state, false);
 			break;
@@ -1314,6 +1379,113 @@ puttuple_common(Tuplesortstate *state, SortTuple *tuple)
 	}
 }
 
+/*
+ * Decide whether to give up on abbreviated keys for the leading sort key.
+ *
+ * The opclass's abbrev_abort callback is consulted at geometrically
+ * increasing intervals while tuples are still being accumulated in memory.
+ * Returns true if abbreviation has just been abandoned, in which case the
+ * caller must replace the abbreviated datum1 of every tuple already in
+ * memtuples with the original leading column value.
+ */
+static bool
+consider_abort_common(Tuplesortstate *state)
+{
+	Assert(state->sortKeys[0].abbrev_converter != NULL);
+	Assert(state->sortKeys[0].abbrev_abort != NULL);
+	Assert(state->sortKeys[0].abbrev_full_comparator != NULL);
+
+	/*
+	 * Check effectiveness of abbreviation optimization.  Consider aborting
+	 * when still within memory limit.
+	 */
+	if (state->status == TSS_INITIAL &&
+		state->memtupcount >= state->abbrevNext)
+	{
+		state->abbrevNext *= 2;
+
+		/*
+		 * Check opclass-supplied abbreviation abort routine.  It may indicate
+		 * that abbreviation should not proceed.
+		 */
+		if (!state->sortKeys->abbrev_abort(state->memtupcount,
+										   state->sortKeys))
+			return false;
+
+		/*
+		 * Finally, restore authoritative comparator, and indicate that
+		 * abbreviation is not in play by setting abbrev_converter to NULL
+		 */
+		state->sortKeys[0].comparator =
+			state->sortKeys[0].abbrev_full_comparator;
+		state->sortKeys[0].abbrev_converter = NULL;
+		/* Not strictly necessary, but be tidy */
+		state->sortKeys[0].abbrev_abort = NULL;
+		state->sortKeys[0].abbrev_full_comparator = NULL;
+
+		/* Give up - expect original pass-by-value representation */
+		return true;
+	}
+
+	return false;
+}
+
+/*
+ * Arrange for the sort's input to be nsources streams of tuples that are
+ * each already sorted according to the sort's keys, rather than tuples
+ * passed to the put routines.  tuplesort_performsort() and the get routines
+ * then merge the streams on the fly, calling fetch(arg, i) whenever the
+ * next tuple of stream i is needed.
+ *
+ * fetch must return tuples in the form the put routine for this kind of
+ * sort would accept (a TupleTableSlot for a heap sort, an IndexTuple for an
+ * index sort, and so on), or NULL once stream i is exhausted.  The tuple
+ * need only remain valid until the next call for the same stream, since we
+ * copy it.  Datum sorts aren't supported, and the result can only be read
+ * forwards, once.
+ */
+void
+tuplesort_attach_sources(Tuplesortstate *state, int nsources,
+						 TuplesortSourceFetch fetch, void *arg)
+{
+	MemoryContext oldcontext = MemoryContextSwitchTo(state->sortcontext);
+
+	Assert(state->status == TSS_INITIAL);
+	Assert(state->memtupcount == 0);
+	Assert(!state->randomAccess && !state->bounded);
+	Assert(nsources > 0);
+
+	/*
+	 * Each tuple is compared only about log2(nsources) times, so generating
+	 * abbreviated keys for them isn't worth it.
+	 */
+	if (state->sortKeys != NULL && state->sortKeys->abbrev_converter != NULL)
+	{
+		state->sortKeys->comparator = state->sortKeys->abbrev_full_comparator;
+		state->sortKeys->abbrev_converter = NULL;
+		state->sortKeys->abbrev_abort = NULL;
+		state->sortKeys->abbrev_full_comparator = NULL;
+	}
+
+	/* The merge heap needs a slot for each stream, and no more. */
+	if (nsources > state->memtupsize)
+	{
+		FREEMEM(state, GetMemoryChunkSpace(state->memtuples));
+		state->memtuples = (SortTuple *)
+			repalloc(state->memtuples, nsources * sizeof(SortTuple));
+		state->memtupsize = nsources;
+		USEMEM(state, GetMemoryChunkSpace(state->memtuples));
+	}
+	state->growmemtuples = false;
+
+	state->nsources = nsources;
+	state->sourcefetch = fetch;
+	state->sourcearg = arg;
+	state->status = TSS_SOURCES;
+
+	MemoryContextSwitchTo(oldcontext);
+}
+
 /*
  * All tuples have been provided; finish the sort.
  */
@@ -1336,18 +1508,7 @@ tuplesort_performsort(Tuplesortstate *state)
 			 * We were able to accumulate all the tuples within the allowed
 			 * amount of memory.  Just qsort 'em and we're done.
 			 */
-			if (state->memtupcount > 1)
-			{
-				/* Can we use the single-key sort function? */
-				if (state->onlyKey != NULL)
-					qsort_ssup(state->memtuples, state->memtupcount,
-							   state->onlyKey);
-				else
-					qsort_tuple(state->memtuples,
-								state->memtupcount,
-								state->comparetup,
-								state);
-			}
+			tuplesort_sort_memtuples(state);
 			state->current = 0;
 			state->eof_reached = false;
 			state->markpos_offset = 0;
@@ -1373,10 +1534,11 @@ tuplesort_performsort(Tuplesortstate *state)
 		case TSS_BUILDRUNS:
 
 			/*
-			 * Finish tape-based sort.	First, flush all tuples remaining in
-			 * memory out to tape; then merge until we have a single remaining
-			 * run (or, if !randomAccess, one run per tape). Note that
-			 * mergeruns sets the correct state->status.
+			 * Finish tape-based sort.	First, sort and flush all tuples
+			 * remaining in memory out to tape as the final run; then merge
+			 * until we have a single remaining run (or, if !randomAccess, one
+			 * run per tape).  Note that mergeruns sets the correct
+			 * state->status.
 			 */
 			dumptuples(state, true);
 			mergeruns(state);
@@ -1386,6 +1548,17 @@ tuplesort_performsort(Tuplesortstate *state)
 			state->markpos_eof = false;
 			break;
 
+		case TSS_SOURCES:
+
+			/*
+			 * The input streams are already sorted, so all that's needed is
+			 * to load the first tuple of each into the merge heap.
+			 */
+			beginsourcemerge(state);
+			state->eof_reached = false;
+			state->status = TSS_MERGESOURCES;
+			break;
+
 		default:
 			elog(ERROR, "invalid tuplesort state");
 			break;
@@ -1398,6 +1571,10 @@ tuplesort_performsort(Tuplesortstate *state)
 			elog(LOG, "performsort done (except %d-way final merge): %s",
 				 state->activeTapes,
 				 pg_rusage_show(&state->ru_start));
+		else if (state->status == TSS_MERGESOURCES)
+			elog(LOG, "performsort done (except %d-way merge of input streams): %s",
+				 state->nsources,
+				 pg_rusage_show(&state->ru_start));
 		else
 			elog(LOG, "performsort done: %s",
 				 pg_rusage_show(&state->ru_start));
@@ -1571,7 +1748,7 @@ tuplesort_gettuple_common(Tuplesortstate *state, bool forward,
 					state->availMem += tuplen;
 					state->mergeavailmem[srcTape] += tuplen;
 				}
-				tuplesort_heap_siftup(state, false);
+				tuplesort_heap_siftup(state);
 				if ((tupIndex = state->mergenext[srcTape]) == 0)
 				{
 					/*
@@ -1593,7 +1770,7 @@ tuplesort_gettuple_common(Tuplesortstate *state, bool forward,
 				state->mergenext[srcTape] = newtup->tupindex;
 				if (state->mergenext[srcTape] == 0)
 					state->mergelast[srcTape] = 0;
-				tuplesort_heap_insert(state, newtup, srcTape, false);
+				tuplesort_heap_insert(state, newtup, srcTape);
 				/* put the now-unused memtuples entry on the freelist */
 				newtup->tupindex = state->mergefreelist;
 				state->mergefreelist = tupIndex;
@@ -1602,6 +1779,27 @@ tuplesort_gettuple_common(Tuplesortstate *state, bool forward,
 			}
 			return false;
 
+		case TSS_MERGESOURCES:
+			Assert(forward);
+			*should_free = true;
+
+			if (state->memtupcount > 0)
+			{
+				int			source = state->memtuples[0].tupindex;
+
+				*stup = state->memtuples[0];
+				/* returned tuple is no longer counted in our memory space */
+				if (stup->tuple)
+					FREEMEM(state, GetMemoryChunkSpace(stup->tuple));
+				tuplesort_heap_siftup(state);
+
+				/* replace it with the next tuple from the same stream */
+				mergesourceone(state, source);
+				return true;
+			}
+			state->eof_reached = true;
+			return false;
+
 		default:
 			elog(ERROR, "invalid tuplesort state");
 			return false;		/* keep compiler quiet */
@@ -1757,6 +1955,7 @@ tuplesort_skiptuples(Tuplesortstate *state, int64 ntuples, bool forward)
 
 		case TSS_SORTEDONTAPE:
 		case TSS_FINALMERGE:
+		case TSS_MERGESOURCES:
 
 			/*
 			 * We could probably optimize these cases better, but for now it's
@@ -1811,8 +2010,17 @@ tuplesort_merge_order(int64 allowedMem)
 	mOrder = (allowedMem - TAPE_BUFFER_OVERHEAD) /
 		(MERGE_BUFFER_SIZE + TAPE_BUFFER_OVERHEAD);
 
-	/* Even in minimum memory, use at least a MINORDER merge */
+	/*
+	 * Even in minimum memory, use at least a MINORDER merge.  On the other
+	 * hand, even when we have lots of memory, do not use more than a
+	 * MAXORDER merge.  Tapes are pretty cheap, but they're not entirely
+	 * free: each one costs TAPE_BUFFER_OVERHEAD of memory that could be
+	 * used for prereading instead, and a very wide merge heap is itself
+	 * cache-unfriendly.  Since runs are about the size of workMem, a MAXORDER
+	 * merge is enough to handle inputs many times workMem in a single pass.
+	 */
 	mOrder = Max(mOrder, MINORDER);
+	mOrder = Min(mOrder, MAXORDER);
 
 	return mOrder;
 }
@@ -1826,7 +2034,6 @@ static void
 inittapes(Tuplesortstate *state)
 {
 	int			maxTapes,
-				ntuples,
 				j;
 	int64		tapeSpace;
 
@@ -1884,24 +2091,9 @@ inittapes(Tuplesortstate *state)
 	state->tp_tapenum = (int *) palloc0(maxTapes * sizeof(int));
 
 	/*
-	 * Convert the unsorted contents of memtuples[] into a heap. Each tuple is
-	 * marked as belonging to run number zero.
-	 *
-	 * NOTE: we pass false for checkIndex since there's no point in comparing
-	 * indexes in this step, even though we do intend the indexes to be part
-	 * of the sort key...
+	 * The unsorted contents of memtuples[] are left in place; the caller
+	 * immediately dumps them out as the first run.
 	 */
-	ntuples = state->memtupcount;
-	state->memtupcount = 0;		/* make the heap empty */
-	for (j = 0; j < ntuples; j++)
-	{
-		/* Must copy source tuple to avoid possible overwrite */
-		SortTuple	stup = state->memtuples[j];
-
-		tuplesort_heap_insert(state, &stup, 0, false);
-	}
-	Assert(state->memtupcount == ntuples);
-
 	state->currentRun = 0;
 
 	/*
@@ -1975,6 +2167,20 @@ mergeruns(Tuplesortstate *state)
 	Assert(state->status == TSS_BUILDRUNS);
 	Assert(state->memtupcount == 0);
 
+	if (state->sortKeys != NULL && state->sortKeys->abbrev_converter != NULL)
+	{
+		/*
+		 * If there are multiple runs to be merged, when we go to read back
+		 * tuples from disk, abbreviated keys will not have been stored, and
+		 * we don't care to regenerate them.  Disable abbreviation from this
+		 * point on.
+		 */
+		state->sortKeys->comparator = state->sortKeys->abbrev_full_comparator;
+		state->sortKeys->abbrev_converter = NULL;
+		state->sortKeys->abbrev_abort = NULL;
+		state->sortKeys->abbrev_full_comparator = NULL;
+	}
+
 	/*
 	 * If we produced only one initial run (quite likely if the total data
 	 * volume is between 1X and 2X workMem), we can just use that tape as the
@@ -1990,6 +2196,32 @@ mergeruns(Tuplesortstate *state)
 		return;
 	}
 
+	/*
+	 * If all the runs fit on the input tapes without any dummy-run juggling
+	 * (ie, we never had to increase the Algorithm D level), a single merge
+	 * pass will finish the job, and only the tapes that actually received a
+	 * run take part in it.  Give the buffer space we set aside for the other
+	 * tapes back to the preread pool, so that each input tape gets a larger
+	 * share of memory and is read in bigger sequential chunks.
+	 */
+	if (state->Level == 1)
+	{
+		int			unusedTapes = state->maxTapes - (state->currentRun + 1);
+
+		if (unusedTapes > 0)
+		{
+			int64		tapeSpace = (int64) unusedTapes * TAPE_BUFFER_OVERHEAD;
+
+			/*
+			 * inittapes doesn't charge for tape buffers if that would leave
+			 * no room for tuples; don't refund what was never charged.
+			 */
+			if (state->availMem + tapeSpace +
+				GetMemoryChunkSpace(state->memtuples) <= state->allowedMem)
+				FREEMEM(state, tapeSpace);
+		}
+	}
+
 	/* End of step D2: rewind all output tapes to prepare for merging */
 	for (tapenum = 0; tapenum < state->tapeRange; tapenum++)
 		LogicalTapeRewind(state->tapeset, tapenum, false);
@@ -2129,7 +2361,7 @@ mergeonerun(Tuplesortstate *state)
 		spaceFreed = state->availMem - priorAvail;
 		state->mergeavailmem[srcTape] += spaceFreed;
 		/* compact the heap */
-		tuplesort_heap_siftup(state, false);
+		tuplesort_heap_siftup(state);
 		if ((tupIndex = state->mergenext[srcTape]) == 0)
 		{
 			/* out of preloaded data on this tape, try to read more */
@@ -2143,7 +2375,7 @@ mergeonerun(Tuplesortstate *state)
 		state->mergenext[srcTape] = tup->tupindex;
 		if (state->mergenext[srcTape] == 0)
 			state->mergelast[srcTape] = 0;
-		tuplesort_heap_insert(state, tup, srcTape, false);
+		tuplesort_heap_insert(state, tup, srcTape);
 		/* put the now-unused memtuples entry on the freelist */
 		tup->tupindex = state->mergefreelist;
 		state->mergefreelist = tupIndex;
@@ -2246,7 +2478,7 @@ beginmerge(Tuplesortstate *state)
 			state->mergenext[srcTape] = tup->tupindex;
 			if (state->mergenext[srcTape] == 0)
 				state->mergelast[srcTape] = 0;
-			tuplesort_heap_insert(state, tup, srcTape, false);
+			tuplesort_heap_insert(state, tup, srcTape);
 			/* put the now-unused memtuples entry on the freelist */
 			tup->tupindex = state->mergefreelist;
 			state->mergefreelist = tupIndex;
@@ -2343,67 +2575,122 @@ mergeprereadone(Tuplesortstate *state, int srcTape)
 }
 
 /*
- * dumptuples - remove tuples from heap and write to tape
+ * beginsourcemerge - load the first tuple of each input stream into the
+ * merge heap
+ */
+static void
+beginsourcemerge(Tuplesortstate *state)
+{
+	int			source;
+
+	Assert(state->memtupcount == 0);
+
+	for (source = 0; source < state->nsources; source++)
+		mergesourceone(state, source);
+}
+
+/*
+ * mergesourceone - add the next tuple of one input stream to the merge heap,
+ * unless the stream is exhausted
+ */
+static void
+mergesourceone(Tuplesortstate *state, int source)
+{
+	void	   *tup;
+	SortTuple	stup;
+
+	tup = (*state->sourcefetch) (state->sourcearg, source);
+	if (tup == NULL)
+		return;
+
+	COPYTUP(state, &stup, tup);
+	tuplesort_heap_insert(state, &stup, source);
+}
+
+/*
+ * dumptuples - sort the tuples in memory and write them to tape as a run
  *
  * This is used during initial-run building, but not during merging.
  *
- * When alltuples = false, dump only enough tuples to get under the
- * availMem limit (and leave at least one tuple in the heap in any case,
- * since puttuple assumes it always has a tuple to compare to).  We also
- * insist there be at least one free slot in the memtuples[] array.
+ * When alltuples = false, do nothing unless we are out of memory or of
+ * memtuples[] slots; in that case, quicksort everything currently in memory
+ * and write it out as a complete run, then select the tape for the next run.
  *
- * When alltuples = true, dump everything currently in memory.
- * (This case is only used at end of input data.)
- *
- * If we empty the heap, close out the current run and return (this should
- * only happen at end of input data).  If we see that the tuple run number
- * at the top of the heap has changed, start a new run.
+ * When alltuples = true, dump everything currently in memory as the final
+ * run.  (This case is only used at end of input data.)  The final run may be
+ * empty, if the previous run happened to use up the last input tuple; that
+ * is harmless, since the merge simply finds that tape's run exhausted at
+ * once.
  */
 static void
 dumptuples(Tuplesortstate *state, bool alltuples)
 {
-	while (alltuples ||
-		   (LACKMEM(state) && state->memtupcount > 1) ||
-		   state->memtupcount >= state->memtupsize)
+	int			memtupwrite;
+	int			i;
+
+	/*
+	 * Nothing to do if we still fit in available memory and have array
+	 * slots, unless this is the final call during initial run generation.
+	 */
+	if (state->memtupcount < state->memtupsize && !LACKMEM(state) &&
+		!alltuples)
+		return;
+
+	Assert(state->status == TSS_BUILDRUNS);
+
+	/*
+	 * It seems unlikely that this limit will ever be exceeded, but take no
+	 * chances
+	 */
+	if (state->currentRun == INT_MAX)
+		ereport(ERROR,
+				(errcode(ERRCODE_PROGRAM_LIMIT_EXCEEDED),
+				 errmsg("cannot have more than %d runs for an external sort",
+						INT_MAX)));
+
+	state->currentRun++;
+
+#ifdef TRACE_SORT
+	if (trace_sort)
+		elog(LOG, "starting quicksort of run %d: %s",
+			 state->currentRun, pg_rusage_show(&state->ru_start));
+#endif
+
+	/*
+	 * Sort all tuples accumulated within the allowed amount of memory for
+	 * this run using quicksort
+	 */
+	tuplesort_sort_memtuples(state);
+
+#ifdef TRACE_SORT
+	if (trace_sort)
+		elog(LOG, "finished quicksort of run %d: %s",
+			 state->currentRun, pg_rusage_show(&state->ru_start));
+#endif
+
+	memtupwrite = state->memtupcount;
+	for (i = 0; i < memtupwrite; i++)
 	{
-		/*
-		 * Dump the heap's frontmost entry, and sift up to remove it from the
-		 * heap.
-		 */
-		Assert(state->memtupcount > 0);
 		WRITETUP(state, state->tp_tapenum[state->destTape],
-				 &state->memtuples[0]);
-		tuplesort_heap_siftup(state, true);
+				 &state->memtuples[i]);
+		state->memtupcount--;
+	}
+	Assert(state->memtupcount == 0);
 
-		/*
-		 * If the heap is empty *or* top run number has changed, we've
-		 * finished the current run.
-		 */
-		if (state->memtupcount == 0 ||
-			state->currentRun != state->memtuples[0].tupindex)
-		{
-			markrunend(state, state->tp_tapenum[state->destTape]);
-			state->currentRun++;
-			state->tp_runs[state->destTape]++;
-			state->tp_dummy[state->destTape]--; /* per Alg D step D2 */
+	markrunend(state, state->tp_tapenum[state->destTape]);
+	state->tp_runs[state->destTape]++;
+	state->tp_dummy[state->destTape]--; /* per Alg D step D2 */
 
 #ifdef TRACE_SORT
-			if (trace_sort)
-				elog(LOG, "finished writing%s run %d to tape %d: %s",
-					 (state->memtupcount == 0) ? " final" : "",
-					 state->currentRun, state->destTape,
-					 pg_rusage_show(&state->ru_start));
+	if (trace_sort)
+		elog(LOG, "finished writing%s run %d to tape %d: %s",
+			 alltuples ? " final" : "",
+			 state->currentRun, state->destTape,
+			 pg_rusage_show(&state->ru_start));
 #endif
 
-			/*
-			 * Done if heap is empty, else prepare for new run.
-			 */
-			if (state->memtupcount == 0)
-				break;
-			Assert(state->currentRun == state->memtuples[0].tupindex);
-			selectnewtape(state);
-		}
-	}
+	if (!alltuples)
+		selectnewtape(state);
 }
 
 /*
@@ -2552,6 +2839,9 @@ tuplesort_get_stats(Tuplesortstate *state,
 		case TSS_FINALMERGE:
 			*sortMethod = "external merge";
 			break;
+		case TSS_MERGESOURCES:
+			*sortMethod = "merge of sorted streams";
+			break;
 		default:
 			*sortMethod = "still in progress";
 			break;
@@ -2559,17 +2849,37 @@ tuplesort_get_stats(Tuplesortstate *state,
 }
 
 
+/*
+ * Sort all memtuples using qsort.
+ *
+ * Quicksort is used both for small in-memory sorts, and for external sort
+ * runs.
+ */
+static void
+tuplesort_sort_memtuples(Tuplesortstate *state)
+{
+	if (state->memtupcount > 1)
+	{
+		/* Can we use the single-key sort function? */
+		if (state->onlyKey != NULL)
+			qsort_ssup(state->memtuples, state->memtupcount,
+					   state->onlyKey);
+		else
+			qsort_tuple(state->memtuples,
+						state->memtupcount,
+						state->comparetup,
+						state);
+	}
+}
+
 /*
  * Heap manipulation routines, per Knuth's Algorithm 5.2.3H.
  *
- * Compare two SortTuples.	If checkIndex is true, use the tuple index
- * as the front of the sort key; otherwise, no.
+ * The heap is used for bounded sorts and for merging; it is ordered by the
+ * sort key alone.
  */
 
-#define HEAPCOMPARE(tup1,tup2) \
-	(checkIndex && ((tup1)->tupindex != (tup2)->tupindex) ? \
-	 ((tup1)->tupindex) - ((tup2)->tupindex) : \
-	 COMPARETUP(state, tup1, tup2))
+#define HEAPCOMPARE(tup1,tup2) COMPARETUP(state, tup1, tup2)
 
 /*
  * Convert the existing unordered array of SortTuples to a bounded heap,
@@ -2579,10 +2889,6 @@ tuplesort_get_stats(Tuplesortstate *state,
  * at the root (array entry zero), instead of the smallest as in the normal
  * sort case.  This allows us to discard the largest entry cheaply.
  * Therefore, we temporarily reverse the sort direction.
- *
- * We assume that all entries in a bounded heap will always have tupindex
- * zero; it therefore doesn't matter that HEAPCOMPARE() doesn't reverse
- * the direction of comparison for tupindexes.
  */
 static void
 make_bounded_heap(Tuplesortstate *state)
@@ -2613,13 +2919,13 @@ make_bounded_heap(Tuplesortstate *state)
 			/* Must copy source tuple to avoid possible overwrite */
 			SortTuple	stup = state->memtuples[i];
 
-			tuplesort_heap_insert(state, &stup, 0, false);
+			tuplesort_heap_insert(state, &stup, 0);
 
 			/* If heap too full, discard largest entry */
 			if (state->memtupcount > state->bound)
 			{
 				free_sort_tuple(state, &state->memtuples[0]);
-				tuplesort_heap_siftup(state, false);
+				tuplesort_heap_siftup(state);
 			}
 		}
 	}
@@ -2650,7 +2956,7 @@ sort_bounded_heap(Tuplesortstate *state)
 		SortTuple	stup = state->memtuples[0];
 
 		/* this sifts-up the next-largest entry and decreases memtupcount */
-		tuplesort_heap_siftup(state, false);
+		tuplesort_heap_siftup(state);
 		state->memtuples[state->memtupcount] = stup;
 	}
 	state->memtupcount = tupcount;
@@ -2677,7 +2983,7 @@ sort_bounded_heap(Tuplesortstate *state)
  */
 static void
 tuplesort_heap_insert(Tuplesortstate *state, SortTuple *tuple,
-					  int tupleindex, bool checkIndex)
+					  int tupleindex)
 {
 	SortTuple  *memtuples;
 	int			j;
@@ -2717,7 +3023,7 @@ tuplesort_heap_insert(Tuplesortstate *state, SortTuple *tuple,
  * Decrement memtupcount, and sift up to maintain the heap invariant.
  */
 static void
-tuplesort_heap_siftup(Tuplesortstate *state, bool checkIndex)
+tuplesort_heap_siftup(Tuplesortstate *state)
 {
 	SortTuple  *memtuples = state->memtuples;
 	SortTuple  *tuple;
@@ -2856,6 +3162,11 @@ comparetup_heap(const SortTuple *a, const SortTuple *b, Tuplesortstate *state)
 	TupleDesc	tupDesc;
 	int			nkey;
 	int32		compare;
+	AttrNumber	attno;
+	Datum		datum1,
+				datum2;
+	bool		isnull1,
+				isnull2;
 
 	/* Compare the leading sort key */
 	compare = ApplySortComparator(a->datum1, a->isnull1,
@@ -2870,14 +3181,26 @@ comparetup_heap(const SortTuple *a, const SortTuple *b, Tuplesortstate *state)
 	rtup.t_len = ((MinimalTuple) b->tuple)->t_len + MINIMAL_TUPLE_OFFSET;
 	rtup.t_data = (HeapTupleHeader) ((char *) b->tuple - MINIMAL_TUPLE_OFFSET);
 	tupDesc = state->tupDesc;
+
+	if (sortKey->abbrev_converter)
+	{
+		/* Equal abbreviated keys; break the tie on the original values */
+		attno = sortKey->ssup_attno;
+
+		datum1 = heap_getattr(&ltup, attno, tupDesc, &isnull1);
+		datum2 = heap_getattr(&rtup, attno, tupDesc, &isnull2);
+
+		compare = ApplySortAbbrevFullComparator(datum1, isnull1,
+												datum2, isnull2,
+												sortKey);
+		if (compare != 0)
+			return compare;
+	}
+
 	sortKey++;
 	for (nkey = 1; nkey < state->nKeys; nkey++, sortKey++)
 	{
-		AttrNumber	attno = sortKey->ssup_attno;
-		Datum		datum1,
-					datum2;
-		bool		isnull1,
-					isnull2;
+		attno = sortKey->ssup_attno;
 
 		datum1 = heap_getattr(&ltup, attno, tupDesc, &isnull1);
 		datum2 = heap_getattr(&rtup, attno, tupDesc, &isnull2);
@@ -2902,6 +3225,7 @@ copytup_heap(Tuplesortstate *state, SortTuple *stup, void *tup)
 	TupleTableSlot *slot = (TupleTableSlot *) tup;
 	MinimalTuple tuple;
 	HeapTupleData htup;
+	Datum		original;
 
 	/* copy the tuple into sort storage */
 	tuple = ExecCopySlotMinimalTuple(slot);
@@ -2910,10 +3234,58 @@ copytup_heap(Tuplesortstate *state, SortTuple *stup, void *tup)
 	/* set up first-column key value */
 	htup.t_len = tuple->t_len + MINIMAL_TUPLE_OFFSET;
 	htup.t_data = (HeapTupleHeader) ((char *) tuple - MINIMAL_TUPLE_OFFSET);
-	stup->datum1 = heap_getattr(&htup,
-								state->sortKeys[0].ssup_attno,
-								state->tupDesc,
-								&stup->isnull1);
+	original = heap_getattr(&htup,
+							state->sortKeys[0].ssup_attno,
+							state->tupDesc,
+							&stup->isnull1);
+
+	if (!state->sortKeys->abbrev_converter || stup->isnull1)
+	{
+		/*
+		 * Store ordinary Datum representation, or NULL value.  If there is a
+		 * converter it won't expect NULL values, and cost model is not
+		 * required to account for NULL, so in that case we avoid calling
+		 * converter and just set datum1 to zeroed representation (to be
+		 * consistent).
+		 */
+		stup->datum1 = original;
+	}
+	else if (!consider_abort_common(state))
+	{
+		/* Store abbreviated key representation */
+		stup->datum1 = state->sortKeys->abbrev_converter(original,
+														 state->sortKeys);
+	}
+	else
+	{
+		/* Abort abbreviation */
+		int			i;
+
+		stup->datum1 = original;
+
+		/*
+		 * Set state to be consistent with never trying abbreviation.
+		 *
+		 * Alter datum1 representation in already-copied tuples, so as to
+		 * ensure a consistent representation (current tuple was just
+		 * handled).  Note that we rely on all tuples copied so far actually
+		 * being contained within memtuples array.
+		 */
+		for (i = 0; i < state->memtupcount; i++)
+		{
+			SortTuple  *mtup = &state->memtuples[i];
+
+			htup.t_len = ((MinimalTuple) mtup->tuple)->t_len +
+				MINIMAL_TUPLE_OFFSET;
+			htup.t_data = (HeapTupleHeader) ((char *) mtup->tuple -
+											 MINIMAL_TUPLE_OFFSET);
+
+			mtup->datum1 = heap_getattr(&htup,
+										state->sortKeys[0].ssup_attno,
+										state->tupDesc,
+										&mtup->isnull1);
+		}
+	}
 }
 
 static void
@@ -3158,6 +3530,18 @@ readtup_cluster(Tuplesortstate *state, SortTuple *stup,
 									&stup->isnull1);
 }
 
+static void
+reversedirection_cluster(Tuplesortstate *state)
+{
+	ScanKey		scanKey = state->indexScanKey;
+	int			nkey;
+
+	for (nkey = 0; nkey < state->nKeys; nkey++, scanKey++)
+	{
+		scanKey->sk_flags ^= (SK_BT_DESC | SK_BT_NULLS_FIRST);
+	}
+}
+
 
 /*
  * Routines specialized for IndexTuple case
@@ -3177,7 +3561,7 @@ comparetup_index_btree(const SortTuple *a, const SortTuple *b,
 	 * whether any null fields are present.  Also see the special treatment
 	 * for equal keys at the end.
 	 */
-	ScanKey		scanKey = state->indexScanKey;
+	SortSupport sortKey = state->sortKeys;
 	IndexTuple	tuple1;
 	IndexTuple	tuple2;
 	int			keysz;
@@ -3185,39 +3569,50 @@ comparetup_index_btree(const SortTuple *a, const SortTuple *b,
 	bool		equal_hasnull = false;
 	int			nkey;
 	int32		compare;
+	Datum		datum1,
+				datum2;
+	bool		isnull1,
+				isnull2;
 
 	/* Compare the leading sort key */
-	compare = inlineApplySortFunction(&scanKey->sk_func, scanKey->sk_flags,
-									  scanKey->sk_collation,
-									  a->datum1, a->isnull1,
-									  b->datum1, b->isnull1);
+	compare = ApplySortComparator(a->datum1, a->isnull1,
+								  b->datum1, b->isnull1,
+								  sortKey);
 	if (compare != 0)
 		return compare;
 
-	/* they are equal, so we only need to examine one null flag */
-	if (a->isnull1)
-		equal_hasnull = true;
-
 	/* Compare additional sort keys */
 	tuple1 = (IndexTuple) a->tuple;
 	tuple2 = (IndexTuple) b->tuple;
 	keysz = state->nKeys;
 	tupDes = RelationGetDescr(state->indexRel);
-	scanKey++;
-	for (nkey = 2; nkey <= keysz; nkey++, scanKey++)
+
+	if (sortKey->abbrev_converter)
 	{
-		Datum		datum1,
-					datum2;
-		bool		isnull1,
-					isnull2;
+		/* Equal abbreviated keys; break the tie on the original values */
+		datum1 = index_getattr(tuple1, 1, tupDes, &isnull1);
+		datum2 = index_getattr(tuple2, 1, tupDes, &isnull2);
 
+		compare = ApplySortAbbrevFullComparator(datum1, isnull1,
+												datum2, isnull2,
+												sortKey);
+		if (compare != 0)
+			return compare;
+	}
+
+	/* they are equal, so we only need to examine one null flag */
+	if (a->isnull1)
+		equal_hasnull = true;
+
+	sortKey++;
+	for (nkey = 2; nkey <= keysz; nkey++, sortKey++)
+	{
 		datum1 = index_getattr(tuple1, nkey, tupDes, &isnull1);
 		datum2 = index_getattr(tuple2, nkey, tupDes, &isnull2);
 
-		compare = inlineApplySortFunction(&scanKey->sk_func, scanKey->sk_flags,
-										  scanKey->sk_collation,
-										  datum1, isnull1,
-										  datum2, isnull2);
+		compare = ApplySortComparator(datum1, isnull1,
+									  datum2, isnull2,
+									  sortKey);
 		if (compare != 0)
 			return compare;		/* done when we find unequal attributes */
 
@@ -3338,6 +3733,7 @@ copytup_index(Tuplesortstate *state, SortTuple *stup, void *tup)
 	IndexTuple	tuple = (IndexTuple) tup;
 	unsigned int tuplen = IndexTupleSize(tuple);
 	IndexTuple	newtuple;
+	Datum		original;
 
 	/* copy the tuple into sort storage */
 	newtuple = (IndexTuple) palloc(tuplen);
@@ -3345,10 +3741,56 @@ copytup_index(Tuplesortstate *state, SortTuple *stup, void *tup)
 	USEMEM(state, GetMemoryChunkSpace(newtuple));
 	stup->tuple = (void *) newtuple;
 	/* set up first-column key value */
-	stup->datum1 = index_getattr(newtuple,
-								 1,
-								 RelationGetDescr(state->indexRel),
-								 &stup->isnull1);
+	original = index_getattr(newtuple,
+							 1,
+							 RelationGetDescr(state->indexRel),
+							 &stup->isnull1);
+
+	/* hash indexes never abbreviate, and have no sortKeys */
+	if (!state->sortKeys || !state->sortKeys->abbrev_converter ||
+		stup->isnull1)
+	{
+		/*
+		 * Store ordinary Datum representation, or NULL value.  If there is a
+		 * converter it won't expect NULL values, and cost model is not
+		 * required to account for NULL, so in that case we avoid calling
+		 * converter and just set datum1 to zeroed representation (to be
+		 * consistent).
+		 */
+		stup->datum1 = original;
+	}
+	else if (!consider_abort_common(state))
+	{
+		/* Store abbreviated key representation */
+		stup->datum1 = state->sortKeys->abbrev_converter(original,
+														 state->sortKeys);
+	}
+	else
+	{
+		/* Abort abbreviation */
+		int			i;
+
+		stup->datum1 = original;
+
+		/*
+		 * Set state to be consistent with never trying abbreviation.
+		 *
+		 * Alter datum1 representation in already-copied tuples, so as to
+		 * ensure a consistent representation (current tuple was just
+		 * handled).  Note that we rely on all tuples copied so far actually
+		 * being contained within memtuples array.
+		 */
+		for (i = 0; i < state->memtupcount; i++)
+		{
+			SortTuple  *mtup = &state->memtuples[i];
+
+			tuple = (IndexTuple) mtup->tuple;
+			mtup->datum1 = index_getattr(tuple,
+										 1,
+										 RelationGetDescr(state->indexRel),
+										 &mtup->isnull1);
+		}
+	}
 }
 
 static void
@@ -3394,12 +3836,13 @@ readtup_index(Tuplesortstate *state, SortTuple *stup,
 static void
 reversedirection_index_btree(Tuplesortstate *state)
 {
-	ScanKey		scanKey = state->indexScanKey;
+	SortSupport sortKey = state->sortKeys;
 	int			nkey;
 
-	for (nkey = 0; nkey < state->nKeys; nkey++, scanKey++)
+	for (nkey = 0; nkey < state->nKeys; nkey++, sortKey++)
 	{
-		scanKey->sk_flags ^= (SK_BT_DESC | SK_BT_NULLS_FIRST);
+		sortKey->ssup_reverse = !sortKey->ssup_reverse;
+		sortKey->ssup_nulls_first = !sortKey->ssup_nulls_first;
 	}
 }
 
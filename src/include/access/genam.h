@@ -130,6 +130,11 @@ extern bool index_insert(Relation indexRelation,
 			 ItemPointer heap_t_ctid,
 			 Relation heapRelation,
 			 IndexUniqueCheck checkUnique);
+extern void index_insert_multi(Relation indexRelation,
+				   Datum *values, bool *isnull,
+				   ItemPointer heap_t_ctids,
+				   Relation heapRelation,
+				   int ntuples);
 
 extern IndexScanDesc index_beginscan(Relation heapRelation,
 				Relation indexRelation,
@@ -144,6 +149,7 @@ extern void index_rescan(IndexScanDesc scan,
 extern void index_endscan(IndexScanDesc scan);
 extern void index_markpos(IndexScanDesc scan);
 extern void index_restrpos(IndexScanDesc scan);
+extern void index_batch_init(IndexScanDesc scan);
 extern ItemPointer index_getnext_tid(IndexScanDesc scan,
 				  ScanDirection direction);
 extern HeapTuple index_fetch_heap(IndexScanDesc scan);
@@ -55,6 +55,11 @@ typedef struct
  * functions are invoked in tempCxt, which is typically short-lifespan
  * (that is, it's reset after each tuple).  However, tempCxt can be the same
  * as scanCxt if we're not bothering with per-tuple context resets.
+ *
+ * fetchTupdesc is set up only by scans that want index tuples back (index-only
+ * scans).  It describes the tuples reconstructed by the fetch functions,
+ * which hold the indexed values in their original datatypes rather than in
+ * the index's storage types.
  */
 typedef struct GISTSTATE
 {
@@ -71,6 +76,10 @@ typedef struct GISTSTATE
 	FmgrInfo	picksplitFn[INDEX_MAX_KEYS];
 	FmgrInfo	equalFn[INDEX_MAX_KEYS];
 	FmgrInfo	distanceFn[INDEX_MAX_KEYS];
+	FmgrInfo	fetchFn[INDEX_MAX_KEYS];
+
+	/* Tuple descriptor for reconstructed tuples, or NULL if not needed */
+	TupleDesc	fetchTupdesc;
 
 	/* Collations to pass to the support functions */
 	Oid			supportCollation[INDEX_MAX_KEYS];
@@ -102,6 +111,8 @@ typedef struct GISTSearchHeapItem
 {
 	ItemPointerData heapPtr;
 	bool		recheck;		/* T if quals must be rechecked */
+	IndexTuple	ftup;			/* data fetched back from the index, used in
+								 * index-only scans */
 } GISTSearchHeapItem;
 
 /* Unvisited item, either index page or heap tuple */
@@ -155,6 +166,8 @@ typedef struct GISTScanOpaqueData
 	GISTSearchHeapItem pageData[BLCKSZ / sizeof(IndexTupleData)];
 	OffsetNumber nPageData;		/* number of valid items in array */
 	OffsetNumber curPageData;	/* next item to return */
+	MemoryContext pageDataCxt;	/* context holding the fetched tuples, for
+								 * index-only scans */
 } GISTScanOpaqueData;
 
 typedef GISTScanOpaqueData *GISTScanOpaque;
@@ -454,6 +467,7 @@ extern XLogRecPtr gistXLogSplit(RelFileNode node,
 /* gistget.c */
 extern Datum gistgettuple(PG_FUNCTION_ARGS);
 extern Datum gistgetbitmap(PG_FUNCTION_ARGS);
+extern Datum gistcanreturn(PG_FUNCTION_ARGS);
 
 /* gistutil.c */
 
@@ -484,6 +498,8 @@ extern IndexTuple gistgetadjusted(Relation r,
 				GISTSTATE *giststate);
 extern IndexTuple gistFormTuple(GISTSTATE *giststate,
 			  Relation r, Datum *attdata, bool *isnull, bool newValues);
+extern IndexTuple gistFetchTuple(GISTSTATE *giststate, Relation r,
+			   IndexTuple tuple);
 
 extern OffsetNumber gistchoose(Relation r, Page p,
 		   IndexTuple it,
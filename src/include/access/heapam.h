@@ -96,6 +96,7 @@ extern Relation heap_openrv_extended(const RangeVar *relation,
 
 /* struct definition appears in relscan.h */
 typedef struct HeapScanDescData *HeapScanDesc;
+typedef struct ParallelHeapScanDescData *ParallelHeapScanDesc;
 
 /*
  * HeapScanIsValid
@@ -114,6 +115,12 @@ extern HeapScanDesc heap_beginscan_bm(Relation relation, Snapshot snapshot,
 				  int nkeys, ScanKey key);
 extern void heap_rescan(HeapScanDesc scan, ScanKey key);
 extern void heap_endscan(HeapScanDesc scan);
+extern Size heap_parallelscan_estimate(void);
+extern void heap_parallelscan_initialize(ParallelHeapScanDesc target,
+							 Relation relation);
+extern void heap_parallelscan_stop(ParallelHeapScanDesc pscan);
+extern HeapScanDesc heap_beginscan_parallel(Relation relation,
+						Snapshot snapshot, ParallelHeapScanDesc parallel_scan);
 extern HeapTuple heap_getnext(HeapScanDesc scan, ScanDirection direction);
 
 extern bool heap_fetch(Relation relation, Snapshot snapshot,
@@ -540,6 +540,43 @@ typedef struct BTArrayKeyInfo
 	Datum	   *elem_values;	/* array of num_elems Datums */
 } BTArrayKeyInfo;
 
+/*
+ * Skip scan support.  When there are no scan keys for the first index column
+ * but there are some for the second, we do one primitive index scan for each
+ * distinct value of the first column, with an implicit "column = value" key
+ * placed ahead of the real ones; see _bt_preprocess_skip_key().
+ */
+typedef struct BTSkipKeyInfo
+{
+	MemoryContext skipContext;	/* scan-lifespan context for skip data */
+	ScanKey		keyData;		/* skip key, followed by copy of
+								 * scan->keyData */
+	FmgrInfo	eqproc;			/* "=" function for first column */
+	FmgrInfo	geproc;			/* ">=" function for first column */
+	FmgrInfo	leproc;			/* "<=" function for first column */
+	BlockNumber cur_blkno;		/* leaf page the current value was found on */
+	int			num_dense;		/* # of successive values found on one page */
+	ScanDirection final_dir;	/* scan direction when BTSKIP_FINAL was set */
+	uint32		generation;		/* incremented whenever skip key changes */
+	int			mark_state;		/* skipState when mark was set */
+	ScanDirection mark_final_dir;	/* final_dir when mark was set */
+	uint32		mark_generation;	/* generation when mark was set */
+	ScanKeyData mark_key;		/* skip key when mark was set */
+} BTSkipKeyInfo;
+
+/* Possible values of so->skipState */
+#define BTSKIP_NONE		0		/* not a skip scan */
+#define BTSKIP_ACTIVE	1		/* skip key is "= current value" */
+#define BTSKIP_FINAL	2		/* skip key is a plain boundary condition */
+#define BTSKIP_NULLS	3		/* skip key is "IS NULL", and it's the last */
+
+/*
+ * Once this many successive values of the first column have turned up on the
+ * same leaf page as the previous one, skipping isn't saving us anything, and
+ * we revert to scanning the rest of the index in the ordinary way.
+ */
+#define BTSKIP_MAX_DENSE	4
+
 typedef struct BTScanOpaqueData
 {
 	/* these fields are set by _bt_preprocess_keys(): */
@@ -554,6 +591,10 @@ typedef struct BTScanOpaqueData
 	BTArrayKeyInfo *arrayKeys;	/* info about each equality-type array key */
 	MemoryContext arrayContext; /* scan-lifespan context for array data */
 
+	/* workspace for skip scan support */
+	int			skipState;		/* BTSKIP_xxx code, see above */
+	BTSkipKeyInfo *skipKey;		/* NULL if never set up */
+
 	/* info about killed items if any (killedItems is NULL if never used) */
 	int		   *killedItems;	/* currPos.items indexes of killed items */
 	int			numKilled;		/* number of currently stored items */
@@ -599,9 +640,11 @@ typedef BTScanOpaqueData *BTScanOpaque;
 extern Datum btbuild(PG_FUNCTION_ARGS);
 extern Datum btbuildempty(PG_FUNCTION_ARGS);
 extern Datum btinsert(PG_FUNCTION_ARGS);
+extern Datum btinsertmulti(PG_FUNCTION_ARGS);
 extern Datum btbeginscan(PG_FUNCTION_ARGS);
 extern Datum btgettuple(PG_FUNCTION_ARGS);
 extern Datum btgetbitmap(PG_FUNCTION_ARGS);
+extern Datum btgetbatch(PG_FUNCTION_ARGS);
 extern Datum btrescan(PG_FUNCTION_ARGS);
 extern Datum btendscan(PG_FUNCTION_ARGS);
 extern Datum btmarkpos(PG_FUNCTION_ARGS);
@@ -616,6 +659,8 @@ extern Datum btoptions(PG_FUNCTION_ARGS);
  */
 extern bool _bt_doinsert(Relation rel, IndexTuple itup,
 			 IndexUniqueCheck checkUnique, Relation heapRel);
+extern void _bt_doinsert_multi(Relation rel, IndexTuple *itups, int ntuples,
+				   Relation heapRel);
 extern Buffer _bt_getstackbuf(Relation rel, BTStack stack, int access);
 extern void _bt_insert_parent(Relation rel, Buffer buf, Buffer rbuf,
 				  BTStack stack, bool is_root, bool is_only);
@@ -656,6 +701,9 @@ extern int32 _bt_compare(Relation rel, int keysz, ScanKey scankey,
 extern bool _bt_first(IndexScanDesc scan, ScanDirection dir);
 extern bool _bt_next(IndexScanDesc scan, ScanDirection dir);
 extern Buffer _bt_get_endpoint(Relation rel, uint32 level, bool rightmost);
+extern bool _bt_skip_next_value(IndexScanDesc scan, ScanDirection dir,
+					bool havePrev, Datum *value, bool *isnull,
+					BlockNumber *blkno);
 
 /*
  * prototypes for functions in nbtutils.c
@@ -669,6 +717,11 @@ extern void _bt_start_array_keys(IndexScanDesc scan, ScanDirection dir);
 extern bool _bt_advance_array_keys(IndexScanDesc scan, ScanDirection dir);
 extern void _bt_mark_array_keys(IndexScanDesc scan);
 extern void _bt_restore_array_keys(IndexScanDesc scan);
+extern void _bt_preprocess_skip_key(IndexScanDesc scan);
+extern bool _bt_start_skip_key(IndexScanDesc scan, ScanDirection dir);
+extern bool _bt_advance_skip_key(IndexScanDesc scan, ScanDirection dir);
+extern void _bt_mark_skip_key(IndexScanDesc scan);
+extern void _bt_restore_skip_key(IndexScanDesc scan);
 extern void _bt_preprocess_keys(IndexScanDesc scan);
 extern IndexTuple _bt_checkkeys(IndexScanDesc scan,
 			  Page page, OffsetNumber offnum,
@@ -685,12 +738,18 @@ extern void BTreeShmemInit(void);
  * prototypes for functions in nbtsort.c
  */
 typedef struct BTSpool BTSpool; /* opaque type known only within nbtsort.c */
+struct IndexInfo;				/* avoid including nodes/execnodes.h here */
 
 extern BTSpool *_bt_spoolinit(Relation heap, Relation index,
 			  bool isunique, bool isdead);
 extern void _bt_spooldestroy(BTSpool *btspool);
 extern void _bt_spool(IndexTuple itup, BTSpool *btspool);
 extern void _bt_leafbuild(BTSpool *btspool, BTSpool *spool2);
+extern int	_bt_parallel_degree(Relation heap, struct IndexInfo *indexInfo);
+extern double _bt_parallel_spool(Relation heap, Relation index,
+				   struct IndexInfo *indexInfo, int nworkers,
+				   BTSpool **spoolp, BTSpool **spool2p,
+				   double *indtuples);
 
 /*
  * prototypes for functions in nbtxlog.c
@@ -19,7 +19,22 @@
 #include "access/htup_details.h"
 #include "access/itup.h"
 #include "access/tupdesc.h"
+#include "storage/spin.h"
 
+/*
+ * Shared state for a parallel heap scan.
+ *
+ * This lives in dynamic shared memory, so it must not contain any pointers.
+ * Each participating process hands out ranges of blocks to itself by
+ * advancing phs_cblock under phs_mutex.
+ */
+typedef struct ParallelHeapScanDescData
+{
+	Oid			phs_relid;		/* OID of relation to scan */
+	BlockNumber phs_nblocks;	/* # blocks in relation at start of scan */
+	slock_t		phs_mutex;		/* mutual exclusion for block allocation */
+	BlockNumber phs_cblock;		/* next block not yet handed out */
+}	ParallelHeapScanDescData;
 
 typedef struct HeapScanDescData
 {
@@ -39,6 +54,9 @@ typedef struct HeapScanDescData
 	BlockNumber rs_startblock;	/* block # to start at */
 	BufferAccessStrategy rs_strategy;	/* access strategy for reads */
 	bool		rs_syncscan;	/* report location to syncscan logic? */
+	ParallelHeapScanDesc rs_parallel;	/* parallel scan information */
+	BlockNumber rs_pnext;		/* next block in our claimed range */
+	BlockNumber rs_pend;		/* end (exclusive) of our claimed range */
 
 	/* scan current state */
 	bool		rs_inited;		/* false = scan not init'd yet */
@@ -55,6 +73,43 @@ typedef struct HeapScanDescData
 	OffsetNumber rs_vistuples[MaxHeapTuplesPerPage];	/* their offsets */
 }	HeapScanDescData;
 
+/*
+ * A batch of matching index entries, returned by an AM's amgetbatch function
+ * for an index scan that uses index_batch_init.  The AM fills in the heap
+ * TIDs and recheck flags of up to MaxIndexTuplesPerPage entries, in scan
+ * order, and sets nitems.  The remaining fields belong to indexam.c, which
+ * hands the entries out one at a time and prefetches the heap pages they
+ * point to.
+ *
+ * killedItems lists the entries of the batch that the caller found to be
+ * dead (cf. kill_prior_tuple), by their position in the batch.  The AM must
+ * deal with them, and reset nkilled, before it replaces the batch contents
+ * in its next amgetbatch call, and in amrescan and amendscan.
+ */
+typedef struct IndexScanBatchData
+{
+	/* filled by the AM */
+	int			nitems;			/* number of valid entries */
+	ItemPointerData *heapTids;	/* heap TIDs of the entries */
+	bool	   *recheck;		/* must the scan keys be rechecked? */
+
+	/* tuples found to be dead, to be dealt with by the AM */
+	int			nkilled;
+	int		   *killedItems;
+
+	/* position of the scan within the batch */
+	ScanDirection dir;			/* direction the batch was read in */
+	int			nextItem;		/* next entry to return */
+
+	/* heap prefetching state */
+	int			prefetchItem;	/* next entry to consider for prefetching */
+	BlockNumber prefetchBlock;	/* heap block of previous such entry */
+	int			prefetchPages;	/* # heap pages prefetched beyond nextItem */
+	int			prefetchTarget;	/* current prefetch distance, in pages */
+}	IndexScanBatchData;
+
+typedef IndexScanBatchData *IndexScanBatch;
+
 /*
  * We use the same IndexScanDescData structure for both amgettuple-based
  * and amgetbitmap-based index scans.  Some fields are only relevant in
@@ -93,6 +148,9 @@ typedef struct IndexScanDescData
 
 	/* state data for traversing HOT chains in index_getnext */
 	bool		xs_continue_hot;	/* T if must keep walking HOT chain */
+
+	/* batch of entries fetched using amgetbatch, or NULL if not batching */
+	IndexScanBatch xs_batch;
 }	IndexScanDescData;
 
 /* Struct for heap-or-index scans of system tables */
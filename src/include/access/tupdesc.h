@@ -43,6 +43,30 @@ typedef struct tupleConstr
 	bool		has_not_null;
 } TupleConstr;
 
+/*
+ * Layout information used when deforming tuples, built on first use from a
+ * TupleDesc by TupleDescBuildDeformInfo and kept with it.  It holds just the
+ * per-attribute fields that deforming needs, packed into one array, plus
+ * the offset of each attribute in a tuple with no nulls before it (-1 if
+ * that depends on the data, as after a varlena column).
+ *
+ * nfixed is the number of leading attributes having such an offset.  In a
+ * tuple with nulls, the offsets remain valid up to the first null one.
+ */
+typedef struct TupleDeformAttr
+{
+	int32		off;			/* fixed offset in tuple data, or -1 */
+	int16		len;			/* attlen */
+	bool		byval;			/* attbyval */
+	char		align;			/* attalign */
+} TupleDeformAttr;
+
+typedef struct TupleDeformInfo
+{
+	int			nfixed;			/* # of leading attrs at fixed offsets */
+	TupleDeformAttr attrs[FLEXIBLE_ARRAY_MEMBER];
+} TupleDeformInfo;
+
 /*
  * This struct is passed around within the backend to describe the structure
  * of tuples.  For tuples coming from on-disk relations, the information is
@@ -78,6 +102,7 @@ typedef struct tupleDesc
 	int32		tdtypmod;		/* typmod for tuple type */
 	bool		tdhasoid;		/* tuple has oid attribute in its header */
 	int			tdrefcount;		/* reference count, or -1 if not counting */
+	TupleDeformInfo *tddeform;	/* deforming info, or NULL if not built yet */
 }	*TupleDesc;
 
 
@@ -95,6 +120,8 @@ extern void TupleDescCopyEntry(TupleDesc dst, AttrNumber dstAttno,
 
 extern void FreeTupleDesc(TupleDesc tupdesc);
 
+extern TupleDeformInfo *TupleDescBuildDeformInfo(TupleDesc tupdesc);
+
 extern void IncrTupleDescRefCount(TupleDesc tupdesc);
 extern void DecrTupleDescRefCount(TupleDesc tupdesc);
 
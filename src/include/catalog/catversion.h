@@ -53,6 +53,6 @@
  */
 
 /*							yyyymmddN */
-#define CATALOG_VERSION_NO	201402251
+#define CATALOG_VERSION_NO	201402257
 
 #endif
@@ -214,6 +214,12 @@ extern TupleTableSlot *EvalPlanQualNext(EPQState *epqstate);
 extern void EvalPlanQualBegin(EPQState *epqstate, EState *parentestate);
 extern void EvalPlanQualEnd(EPQState *epqstate);
 
+/*
+ * prototypes from functions in execPrune.c
+ */
+extern bool ExecSubplanIsPrunable(ExprContext *econtext, List *quals,
+					  List *constraints, bool initial, bool *needs_recheck);
+
 /*
  * prototypes from functions in execProcnode.c
  */
@@ -236,6 +242,7 @@ extern Tuplestorestate *ExecMakeTableFunctionResult(ExprState *funcexpr,
 extern Datum ExecEvalExprSwitchContext(ExprState *expression, ExprContext *econtext,
 						  bool *isNull, ExprDoneCond *isDone);
 extern ExprState *ExecInitExpr(Expr *node, PlanState *parent);
+extern bool ExecScalarArrayOpUsesHash(ScalarArrayOpExpr *opexpr);
 extern ExprState *ExecPrepareExpr(Expr *node, EState *estate);
 extern bool ExecQual(List *qual, ExprContext *econtext, bool resultForNull);
 extern int	ExecTargetListLength(List *targetlist);
@@ -243,6 +250,12 @@ extern int	ExecCleanTargetListLength(List *targetlist);
 extern TupleTableSlot *ExecProject(ProjectionInfo *projInfo,
 			ExprDoneCond *isDone);
 
+/*
+ * prototypes from functions in execFlatExpr.c
+ */
+extern ExprState *ExecInitExprFlat(Expr *node, PlanState *parent);
+extern List *ExecInitQual(List *qual, PlanState *parent);
+
 /*
  * prototypes from functions in execScan.c
  */
@@ -350,6 +363,8 @@ extern void ExecOpenIndices(ResultRelInfo *resultRelInfo);
 extern void ExecCloseIndices(ResultRelInfo *resultRelInfo);
 extern List *ExecInsertIndexTuples(TupleTableSlot *slot, ItemPointer tupleid,
 					  EState *estate);
+extern void ExecSetupIndexBatches(ResultRelInfo *resultRelInfo, int maxtuples);
+extern void ExecFlushIndexBatches(ResultRelInfo *resultRelInfo);
 extern bool check_exclusion_constraint(Relation heap, Relation index,
 						   IndexInfo *indexInfo,
 						   ItemPointer tupleid,
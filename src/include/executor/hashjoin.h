@@ -54,6 +54,13 @@
  * inner batch file.  Subsequently, while reading either inner or outer batch
  * files, we might find tuples that no longer belong to the current batch;
  * if so, we just dump them out to the correct batch file.
+ *
+ * If the inner relation is read by a Parallel Seq Scan, the workers store
+ * most first-batch tuples directly into a dynamic shared memory segment
+ * owned by the hashtable, and the master links them into its buckets once
+ * the scan is done; see ExecHashSharedFinish.  Such tuples must not be
+ * pfree'd, and the segment is released along with the rest of the first
+ * batch's storage.
  * ----------------------------------------------------------------
  */
 
@@ -72,6 +79,46 @@ typedef struct HashJoinTupleData
 #define HJTUPLE_MINTUPLE(hjtup)  \
 	((MinimalTuple) ((char *) (hjtup) + HJTUPLE_OVERHEAD))
 
+/*
+ * The tuples of the main hash table are not palloc'd one at a time, but
+ * packed densely into large chunks allocated in batchCxt, which saves the
+ * per-palloc overhead and keeps tuples that arrived together close together
+ * in memory.  Tuples too large to pack usefully get a chunk of their own.
+ * Individual tuples are never freed; when increasing nbatch moves some of
+ * the tuples out, the rest are copied into new chunks and the old chunks
+ * are released.  (Skew bucket tuples are still palloc'd separately, since
+ * skew buckets are removed one at a time.)
+ */
+typedef struct HashMemoryChunkData
+{
+	struct HashMemoryChunkData *next;	/* next chunk in hashtable's list */
+	Size		maxlen;			/* space available for tuples */
+	Size		used;			/* space used so far */
+	char		data[FLEXIBLE_ARRAY_MEMBER];	/* tuples, each MAXALIGN'd */
+}	HashMemoryChunkData;
+
+typedef struct HashMemoryChunkData *HashMemoryChunk;
+
+#define HASH_CHUNK_SIZE			(32 * 1024L)
+#define HASH_CHUNK_HEADER_SIZE	offsetof(HashMemoryChunkData, data)
+#define HASH_CHUNK_THRESHOLD	(HASH_CHUNK_SIZE / 4)
+
+/*
+ * Once all the inner tuples of a batch are in the table, we build a bucket
+ * directory before probing it: an array holding the hash values of all the
+ * tuples in the table, in bucket order, with a parallel array of pointers to
+ * the tuples themselves, and an array giving where each bucket's entries
+ * begin.  A probe then reads its bucket's hash values sequentially, usually
+ * from a single cache line, and looks at a tuple only when the hash values
+ * are equal, instead of dereferencing every tuple in the bucket's chain just
+ * to find out that it has a different hash value.  The chains are kept, for
+ * the code that needs to visit every tuple.  Each tuple costs
+ * HJDIRECTORY_ENTRY_SIZE bytes more in the directory, which is counted in
+ * spaceUsed as soon as the tuple goes into the table, so that the table is
+ * split before the directory would take it over work_mem.
+ */
+#define HJDIRECTORY_ENTRY_SIZE	(sizeof(uint32) + sizeof(HashJoinTuple))
+
 /*
  * If the outer relation's distribution is sufficiently nonuniform, we attempt
  * to optimize the join by treating the hash values corresponding to the outer
@@ -112,6 +159,19 @@ typedef struct HashJoinTableData
 	struct HashJoinTupleData **buckets;
 	/* buckets array is per-batch storage, as are all the tuples */
 
+	/* chunks holding the main table's tuples, newest first */
+	HashMemoryChunk chunks;
+
+	/*
+	 * The bucket directory, or NULLs if not built yet for this batch.  The
+	 * entries for bucket i are at positions dirStart[i] to dirStart[i + 1]
+	 * - 1 of dirHashes[] and dirTuples[].  Per-batch storage, too.
+	 */
+	uint32	   *dirStart;
+	uint32	   *dirHashes;
+	struct HashJoinTupleData **dirTuples;
+	uint32		nInMemory;		/* # tuples in the main table's buckets */
+
 	bool		keepNulls;		/* true to store unmatchable NULL tuples */
 
 	bool		skewEnabled;	/* are we using skew optimization? */
@@ -157,6 +217,17 @@ typedef struct HashJoinTableData
 
 	MemoryContext hashCxt;		/* context for whole-hash-join storage */
 	MemoryContext batchCxt;		/* context for this-batch-only storage */
+
+	/* shared tuple storage for a parallel build, or NULL */
+	struct HashSharedState *shared;
+
+	/*
+	 * Bloom filter of the hash values of all inner tuples, of every batch,
+	 * for the outer scan's HashJoinFilter; NULL if there isn't one.  It has
+	 * 2^log2_nbloombits bits.
+	 */
+	uint64	   *bloom;
+	int			log2_nbloombits;
 }	HashJoinTableData;
 
 #endif   /* HASHJOIN_H */
@@ -15,6 +15,7 @@
 #define NODEHASH_H
 
 #include "nodes/execnodes.h"
+#include "storage/dsm.h"
 
 extern HashState *ExecInitHash(Hash *node, EState *estate, int eflags);
 extern TupleTableSlot *ExecHash(HashState *node);
@@ -23,11 +24,12 @@ extern void ExecEndHash(HashState *node);
 extern void ExecReScanHash(HashState *node);
 
 extern HashJoinTable ExecHashTableCreate(Hash *node, List *hashOperators,
-					bool keepNulls);
+					bool keepNulls, bool useBloom);
 extern void ExecHashTableDestroy(HashJoinTable hashtable);
 extern void ExecHashTableInsert(HashJoinTable hashtable,
 					TupleTableSlot *slot,
 					uint32 hashvalue);
+extern void ExecHashTableBuildDirectory(HashJoinTable hashtable);
 extern bool ExecHashGetHashValue(HashJoinTable hashtable,
 					 ExprContext *econtext,
 					 List *hashkeys,
@@ -49,5 +51,11 @@ extern void ExecChooseHashTableSize(double ntuples, int tupwidth, bool useskew,
 						int *numbatches,
 						int *num_skew_mcvs);
 extern int	ExecHashGetSkewBucket(HashJoinTable hashtable, uint32 hashvalue);
+extern bool ExecHashFilterTuple(HashJoinFilter *filter, ExprContext *econtext);
+
+extern struct HashSharedWorkerState *ExecHashSharedWorkerBegin(dsm_handle handle);
+extern bool ExecHashSharedWorkerInsert(struct HashSharedWorkerState *wstate,
+						   TupleTableSlot *slot);
+extern void ExecHashSharedWorkerEnd(struct HashSharedWorkerState *wstate);
 
 #endif   /* NODEHASH_H */
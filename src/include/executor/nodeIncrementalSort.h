@@ -0,0 +1,31 @@
+/*-------------------------------------------------------------------------
+ *
+ * nodeIncrementalSort.h
+ *
+ *
+ *
+ * Portions Copyright (c) 1996-2014, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, Regents of the University of California
+ *
+ * src/include/executor/nodeIncrementalSort.h
+ *
+ *-------------------------------------------------------------------------
+ */
+#ifndef NODEINCREMENTALSORT_H
+#define NODEINCREMENTALSORT_H
+
+#include "nodes/execnodes.h"
+
+/*
+ * Minimum number of tuples in each batch that an incremental sort sorts; the
+ * planner's cost_incremental_sort() assumes this too.
+ */
+#define INCSORT_MIN_BATCH_TUPLES	32
+
+extern IncrementalSortState *ExecInitIncrementalSort(IncrementalSort *node,
+						EState *estate, int eflags);
+extern TupleTableSlot *ExecIncrementalSort(IncrementalSortState *node);
+extern void ExecEndIncrementalSort(IncrementalSortState *node);
+extern void ExecReScanIncrementalSort(IncrementalSortState *node);
+
+#endif   /* NODEINCREMENTALSORT_H */
@@ -16,6 +16,9 @@
 
 #include "nodes/execnodes.h"
 
+/* largest number of outer rows read into one batch */
+#define NESTLOOP_MAX_BATCH_TUPLES	1024
+
 extern NestLoopState *ExecInitNestLoop(NestLoop *node, EState *estate, int eflags);
 extern TupleTableSlot *ExecNestLoop(NestLoopState *node);
 extern void ExecEndNestLoop(NestLoopState *node);
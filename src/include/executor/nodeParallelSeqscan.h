@@ -0,0 +1,29 @@
+/*-------------------------------------------------------------------------
+ *
+ * nodeParallelSeqscan.h
+ *
+ *
+ *
+ * Portions Copyright (c) 1996-2014, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, Regents of the University of California
+ *
+ * src/include/executor/nodeParallelSeqscan.h
+ *
+ *-------------------------------------------------------------------------
+ */
+#ifndef NODEPARALLELSEQSCAN_H
+#define NODEPARALLELSEQSCAN_H
+
+#include "nodes/execnodes.h"
+#include "storage/dsm.h"
+#include "storage/shm_toc.h"
+
+extern ParallelSeqScanState *ExecInitParallelSeqScan(ParallelSeqScan *node,
+						EState *estate, int eflags);
+extern TupleTableSlot *ExecParallelSeqScan(ParallelSeqScanState *node);
+extern void ExecEndParallelSeqScan(ParallelSeqScanState *node);
+extern void ExecReScanParallelSeqScan(ParallelSeqScanState *node);
+extern bool ExecParallelSeqScanCanUseWorkers(ParallelSeqScanState *node);
+extern void ParallelSeqScanWorkerMain(dsm_segment *seg, shm_toc *toc);
+
+#endif   /* NODEPARALLELSEQSCAN_H */
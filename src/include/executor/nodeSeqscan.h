@@ -14,10 +14,13 @@
 #ifndef NODESEQSCAN_H
 #define NODESEQSCAN_H
 
+#include "executor/tuplebatch.h"
 #include "nodes/execnodes.h"
 
 extern SeqScanState *ExecInitSeqScan(SeqScan *node, EState *estate, int eflags);
 extern TupleTableSlot *ExecSeqScan(SeqScanState *node);
+extern bool ExecSeqScanSupportsBatch(SeqScanState *node);
+extern void ExecSeqScanBatch(SeqScanState *node, TupleBatch *batch);
 extern void ExecEndSeqScan(SeqScanState *node);
 extern void ExecSeqMarkPos(SeqScanState *node);
 extern void ExecSeqRestrPos(SeqScanState *node);
@@ -0,0 +1,81 @@
+/*-------------------------------------------------------------------------
+ *
+ * tuplebatch.h
+ *	  batch-at-a-time tuple passing between executor nodes
+ *
+ * A TupleBatch carries a group of rows, already deformed into one array of
+ * values (and null flags) per column, from a plan node to its parent.  Nodes
+ * that know how to fill one can hand over up to TUPLE_BATCH_ROWS rows per
+ * call; their parent can then run its per-column work as tight loops rather
+ * than calling the child once per row.  See ExecProcNodeBatch.
+ *
+ *
+ * Portions Copyright (c) 1996-2014, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, Regents of the University of California
+ *
+ * src/include/executor/tuplebatch.h
+ *
+ *-------------------------------------------------------------------------
+ */
+#ifndef TUPLEBATCH_H
+#define TUPLEBATCH_H
+
+#include "access/tupdesc.h"
+#include "executor/tuptable.h"
+#include "nodes/execnodes.h"
+#include "storage/buf.h"
+
+/* default number of rows in a batch */
+#define TUPLE_BATCH_ROWS		1024
+
+/* maximum number of buffer pins a batch may hold at once */
+#define TUPLE_BATCH_MAX_PINS	8
+
+/*----------
+ * Values of pass-by-reference columns point either into a disk buffer, which
+ * the batch keeps pinned, or into memory in batchcxt.  Either way they stay
+ * valid until the batch is reset or refilled.
+ *
+ * The consumer says how many leading columns it needs (ncols); the producer
+ * may fill in more than that (nvalid), for instance to evaluate its own qual.
+ * Column arrays are allocated only when first filled in.
+ *----------
+ */
+typedef struct TupleBatch
+{
+	TupleDesc	tupdesc;		/* descriptor of the rows */
+	int			maxrows;		/* capacity of each column array */
+	int			nrows;			/* number of rows currently held */
+	int			ncols;			/* number of columns the consumer needs */
+	int			nvalid;			/* number of columns filled in */
+	int			nallocated;		/* number of column arrays allocated */
+	Datum	  **values;			/* per-column arrays of values */
+	bool	  **isnull;			/* per-column arrays of null flags */
+	bool	   *keep;			/* workspace for ExecBatchQual */
+	MemoryContext batchcxt;		/* copied values; reset with the batch */
+	int			nbuffers;		/* number of pinned buffers */
+	Buffer		buffers[TUPLE_BATCH_MAX_PINS];	/* pinned buffers */
+} TupleBatch;
+
+/*
+ * prototypes from functions in execBatch.c
+ */
+extern TupleBatch *MakeTupleBatch(TupleDesc tupdesc, int ncols, int maxrows);
+extern void TupleBatchReset(TupleBatch *batch);
+extern void TupleBatchFree(TupleBatch *batch);
+extern bool TupleBatchPinBuffer(TupleBatch *batch, Buffer buffer);
+extern void TupleBatchAddSlot(TupleBatch *batch, TupleTableSlot *slot,
+				  int natts, bool copy);
+extern void TupleBatchCompact(TupleBatch *batch);
+extern List *ExecInitBatchQual(List *qual);
+extern int	ExecBatchQualNeededAtts(List *batchqual);
+extern int	ExecBatchQual(List *batchqual, TupleBatch *batch,
+			  ExprContext *econtext);
+
+/*
+ * prototypes from functions in execProcnode.c
+ */
+extern bool ExecSupportsBatch(PlanState *node);
+extern int	ExecProcNodeBatch(PlanState *node, TupleBatch *batch);
+
+#endif   /* TUPLEBATCH_H */
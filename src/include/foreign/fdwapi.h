@@ -100,6 +100,11 @@ typedef bool (*AnalyzeForeignTable_function) (Relation relation,
 												 AcquireSampleRowsFunc *func,
 													BlockNumber *totalpages);
 
+typedef bool (*StartForeignScanAsync_function) (ForeignScanState *node);
+
+typedef bool (*IsForeignScanReady_function) (ForeignScanState *node,
+														 pgsocket *waitsock);
+
 /*
  * FdwRoutine is the struct returned by a foreign-data wrapper's handler
  * function.  It provides pointers to the callback functions needed by the
@@ -144,6 +149,10 @@ typedef struct FdwRoutine
 
 	/* Support functions for ANALYZE */
 	AnalyzeForeignTable_function AnalyzeForeignTable;
+
+	/* Support functions for asynchronous execution */
+	StartForeignScanAsync_function StartForeignScanAsync;
+	IsForeignScanReady_function IsForeignScanReady;
 } FdwRoutine;
 
 
@@ -284,6 +284,24 @@ typedef struct JunkFilter
 	AttrNumber	jf_junkAttNo;
 } JunkFilter;
 
+/* ----------------
+ *	  IndexInsertBatch information
+ *
+ *		Index entries collected by ExecInsertIndexTuples, waiting to be
+ *		inserted into one index with a single index_insert_multi call.
+ *		See ExecSetupIndexBatches.
+ * ----------------
+ */
+typedef struct IndexInsertBatch
+{
+	int			ntuples;		/* number of entries collected */
+	int			maxtuples;		/* allocated number of entries */
+	Datum	   *values;			/* index column values, natts per entry */
+	bool	   *isnull;			/* null flags, natts per entry */
+	ItemPointerData *heapTids;	/* heap TIDs of the entries */
+	MemoryContext context;		/* holds copies of pass-by-ref values */
+} IndexInsertBatch;
+
 /* ----------------
  *	  ResultRelInfo information
  *
@@ -297,6 +315,7 @@ typedef struct JunkFilter
  *		NumIndices				# of indices existing on result relation
  *		IndexRelationDescs		array of relation descriptors for indices
  *		IndexRelationInfo		array of key/attr info for indices
+ *		IndexBatches			array of pending index insertions, or NULL
  *		TrigDesc				triggers to be fired, if any
  *		TrigFunctions			cached lookup info for trigger functions
  *		TrigWhenExprs			array of trigger WHEN expr states
@@ -318,6 +337,7 @@ typedef struct ResultRelInfo
 	int			ri_NumIndices;
 	RelationPtr ri_IndexRelationDescs;
 	IndexInfo **ri_IndexRelationInfo;
+	IndexInsertBatch **ri_IndexBatches;
 	TriggerDesc *ri_TrigDesc;
 	FmgrInfo   *ri_TrigFunctions;
 	List	  **ri_TrigWhenExprs;
@@ -593,6 +613,20 @@ typedef struct AggrefExprState
 	int			aggno;			/* ID number for agg within its plan node */
 } AggrefExprState;
 
+/* ----------------
+ *		GroupingFuncExprState node
+ *
+ * The list of column numbers refers to the input tuples of the Agg node to
+ * which the GroupingFunc belongs.
+ * ----------------
+ */
+typedef struct GroupingFuncExprState
+{
+	ExprState	xprstate;
+	struct AggState *aggstate;
+	List	   *clauses;		/* integer list of column numbers */
+} GroupingFuncExprState;
+
 /* ----------------
  *		WindowFuncExprState node
  * ----------------
@@ -698,8 +732,16 @@ typedef struct FuncExprState
  *		ScalarArrayOpExprState node
  *
  * This is a FuncExprState plus some additional data.
+ *
+ * If the array is a large constant and the operator (or for ALL, its
+ * negator) is hashable, the elements are put in a hash table the first
+ * time through, and each evaluation is a single lookup; see
+ * ExecEvalHashedScalarArrayOp.
  * ----------------
  */
+/* private in execQual.c: */
+typedef struct ScalarArrayOpHashEntry ScalarArrayOpHashEntry;
+
 typedef struct ScalarArrayOpExprState
 {
 	FuncExprState fxprstate;
@@ -708,6 +750,14 @@ typedef struct ScalarArrayOpExprState
 	int16		typlen;
 	bool		typbyval;
 	char		typalign;
+	/* Info for hashed evaluation, if useHash */
+	bool		useHash;
+	FmgrInfo	hash_eqfunc;	/* equality function (negator's, for ALL) */
+	FmgrInfo	hash_lhs_func;	/* hash function for the scalar */
+	FmgrInfo	hash_rhs_func;	/* hash function for the array elements */
+	ScalarArrayOpHashEntry *hash_entries;	/* NULL until built */
+	uint32		hash_mask;		/* number of entries - 1 */
+	bool		hash_has_nulls; /* does the array contain NULLs? */
 } ScalarArrayOpExprState;
 
 /* ----------------
@@ -965,6 +1015,24 @@ typedef struct DomainConstraintState
 	ExprState  *check_expr;		/* for CHECK, a boolean expression */
 } DomainConstraintState;
 
+/* ----------------
+ *		ExprProgramState node
+ *
+ * An expression flattened into a linear array of steps by ExecInitExprFlat,
+ * evaluated by a single dispatch loop rather than by recursing through a
+ * tree of ExprState nodes.  The step representation is private to
+ * execFlatExpr.c.
+ * ----------------
+ */
+typedef struct ExprProgramState
+{
+	ExprState	xprstate;
+	int			nsteps;			/* number of steps, including the final one */
+	struct ExprStep *steps;		/* array of steps */
+	Datum		resvalue;		/* where the last step leaves the result */
+	bool		resnull;
+} ExprProgramState;
+
 
 /* ----------------------------------------------------------------
  *				 Executor State Trees
@@ -1095,6 +1163,18 @@ typedef struct ModifyTableState
  *
  *		nplans			how many plans are in the array
  *		whichplan		which plan is being executed (0 .. n-1)
+ *		async_started	have we tried to start asynchronous subplans yet?
+ *		nasync			how many subplans are running asynchronously
+ *		whichasync		asynchronous subplan we got the last tuple from
+ *		isasync			which subplans are running asynchronously
+ *		finished		which subplans have returned all their tuples,
+ *						when there are asynchronous ones
+ *		nremoved		how many of the plan's subplans were pruned at
+ *						startup, and so are not in the array at all
+ *		prune_quals		per-subplan quals for run-time pruning, or NIL
+ *		prune_constraints per-subplan constraints for run-time pruning
+ *		prune_pending	must we redo run-time pruning before scanning?
+ *		pruned			which subplans run-time pruning says to skip
  * ----------------
  */
 typedef struct AppendState
@@ -1103,6 +1183,16 @@ typedef struct AppendState
 	PlanState **appendplans;	/* array of PlanStates for my inputs */
 	int			as_nplans;
 	int			as_whichplan;
+	bool		as_async_started;
+	int			as_nasync;
+	int			as_whichasync;
+	bool	   *as_isasync;
+	bool	   *as_finished;
+	int			as_nremoved;
+	List	   *as_prune_quals;
+	List	   *as_prune_constraints;
+	bool		as_prune_pending;
+	bool	   *as_pruned;
 } AppendState;
 
 /* ----------------
@@ -1114,6 +1204,8 @@ typedef struct AppendState
  *		slots			current output tuple of each subplan
  *		heap			heap of active tuples
  *		initialized		true if we have fetched first tuple from each subplan
+ *		nremoved, prune_quals, prune_constraints, pruned
+ *						as for AppendState
  * ----------------
  */
 typedef struct MergeAppendState
@@ -1126,6 +1218,10 @@ typedef struct MergeAppendState
 	TupleTableSlot **ms_slots;	/* array of length ms_nplans */
 	struct binaryheap *ms_heap; /* binary heap of slot indices */
 	bool		ms_initialized; /* are subplans started? */
+	int			ms_nremoved;	/* # of subplans pruned at startup */
+	List	   *ms_prune_quals; /* per-subplan quals for run-time pruning */
+	List	   *ms_prune_constraints;	/* and constraints they may refute */
+	bool	   *ms_pruned;		/* which subplans to skip in this scan */
 } MergeAppendState;
 
 /* ----------------
@@ -1193,6 +1289,7 @@ typedef struct BitmapOrState
  *		currentRelation    relation being scanned (NULL if none)
  *		currentScanDesc    current scan descriptor for scan (NULL if none)
  *		ScanTupleSlot	   pointer to slot in tuple table holding scan tuple
+ *		HashFilter		   filter supplied by a parent hash join (NULL if none)
  * ----------------
  */
 typedef struct ScanState
@@ -1201,13 +1298,63 @@ typedef struct ScanState
 	Relation	ss_currentRelation;
 	HeapScanDesc ss_currentScanDesc;
 	TupleTableSlot *ss_ScanTupleSlot;
+	struct HashJoinFilter *ss_HashFilter;
 } ScanState;
 
-/*
- * SeqScan uses a bare ScanState as its state node, since it needs
- * no additional fields.
+/* ----------------
+ *	 SeqScanState information
+ *
+ *		batchQualReady	true once batchQual has been set up
+ *		batchQual		the node's qual as batch kernels, or NIL if it
+ *						can't be evaluated that way (see execBatch.c)
+ * ----------------
+ */
+typedef struct SeqScanState
+{
+	ScanState	ss;				/* its first field is NodeTag */
+	bool		batchQualReady;
+	List	   *batchQual;
+} SeqScanState;
+
+/* ----------------
+ *	 ParallelSeqScanState information
+ *
+ *		pss_pcxt			parallel context, or NULL if not using workers
+ *		pss_initialized		has the scan been started yet?
+ *		pss_local_done		has our own share of the scan finished?
+ *		pss_nreaders		number of entries in pss_reader[]
+ *		pss_nreaders_active	number of workers still sending tuples
+ *		pss_nextreader		next queue to poll for a tuple
+ *		pss_nworkers_launched number of workers we actually got
+ *		pss_reader			per-worker tuple queues (NULL once drained)
+ *		pss_wtuple			header for the last tuple read from a worker
+ *		pss_hashseg			shared hash table for workers to fill, or NULL
+ *
+ *	Worker tuples have already passed the node's qual; tuples scanned by
+ *	the master have not.  If no workers can be used, the master simply
+ *	scans the whole relation itself.  pss_hashseg is set by a parent Hash
+ *	node that wants the workers to store tuples directly into its table
+ *	rather than send them back (see nodeHash.c).
+ * ----------------
  */
-typedef ScanState SeqScanState;
+struct ParallelContext;
+struct shm_mq_handle;
+struct dsm_segment;
+
+typedef struct ParallelSeqScanState
+{
+	ScanState	ss;				/* its first field is NodeTag */
+	struct ParallelContext *pss_pcxt;
+	bool		pss_initialized;
+	bool		pss_local_done;
+	int			pss_nreaders;
+	int			pss_nreaders_active;
+	int			pss_nextreader;
+	int			pss_nworkers_launched;
+	struct shm_mq_handle **pss_reader;
+	HeapTupleData pss_wtuple;
+	struct dsm_segment *pss_hashseg;
+} ParallelSeqScanState;
 
 /*
  * These structs store information about index quals that don't have simple
@@ -1340,9 +1487,15 @@ typedef struct BitmapIndexScanState
  *		tbmres			   current-page data
  *		exact_pages		   total number of exact pages retrieved
  *		lossy_pages		   total number of lossy pages retrieved
+ *		skipped_pages	   total number of exact pages not fetched
  *		prefetch_iterator  iterator for prefetching ahead of current page
  *		prefetch_pages	   # pages prefetch iterator is ahead of current
  *		prefetch_target    target prefetch distance
+ *		can_skip_fetch	   can we potentially skip tuple fetches in this scan?
+ *		skip_fetch		   are we skipping the fetch of the current page?
+ *		bitmap_lsn		   WAL position before the bitmap was built
+ *		vmbuffer		   buffer for visibility-map lookups
+ *		pvmbuffer		   ditto, for prefetched pages
  * ----------------
  */
 typedef struct BitmapHeapScanState
@@ -1354,9 +1507,15 @@ typedef struct BitmapHeapScanState
 	TBMIterateResult *tbmres;
 	long		exact_pages;
 	long		lossy_pages;
+	long		skipped_pages;
 	TBMIterator *prefetch_iterator;
 	int			prefetch_pages;
 	int			prefetch_target;
+	bool		can_skip_fetch;
+	bool		skip_fetch;
+	XLogRecPtr	bitmap_lsn;
+	Buffer		vmbuffer;
+	Buffer		pvmbuffer;
 } BitmapHeapScanState;
 
 /* ----------------
@@ -1525,14 +1684,37 @@ typedef struct JoinState
  *		NeedNewOuter	   true if need new outer tuple on next call
  *		MatchedOuter	   true if found a join match for current outer tuple
  *		NullInnerTupleSlot prepared null tuple for left outer joins
+ *
+ *	The remaining fields are used only if the plan asks for the outer rows
+ *	to be read in batches (numBatchKeys > 0); see nodeNestloop.c.
  * ----------------
  */
+/* private in nodeNestloop.c: */
+typedef struct NestLoopBatchEntry NestLoopBatchEntry;
+
 typedef struct NestLoopState
 {
 	JoinState	js;				/* its first field is NodeTag */
 	bool		nl_NeedNewOuter;
 	bool		nl_MatchedOuter;
 	TupleTableSlot *nl_NullInnerTupleSlot;
+	bool		nl_Batched;		/* reading the outer rows in batches? */
+	MemoryContext nl_BatchContext;	/* holds the current batch's tuples */
+	NestLoopBatchEntry *nl_BatchEntries;	/* outer rows of current batch */
+	int		   *nl_BatchOrder;	/* their indexes, sorted by key */
+	AttrNumber *nl_BatchKeyAttnos;	/* outer columns of the sort keys */
+	SortSupport nl_SortKeys;	/* array of length numBatchKeys */
+	int			nl_BatchCount;	/* number of entries in current batch */
+	int			nl_BatchTarget; /* size to aim for with the next batch */
+	int			nl_BatchNext;	/* next entry to return */
+	NestLoopBatchEntry *nl_BatchEntry;	/* entry being returned, or NULL */
+	ListCell   *nl_BatchMatch;	/* next stored match of nl_BatchEntry */
+	bool		nl_OuterDone;	/* outer plan exhausted? */
+	TupleTableSlot *nl_BatchOuterSlot;	/* holds an outer row of the batch */
+	TupleTableSlot *nl_BatchInnerSlot;	/* holds a stored inner match */
+	/* statistics for EXPLAIN ANALYZE */
+	long		nl_NumBatches;	/* number of batches read */
+	int			nl_MaxBatchCount;	/* largest batch, in outer rows */
 } NestLoopState;
 
 /* ----------------
@@ -1594,6 +1776,8 @@ typedef struct MergeJoinState
  *		hj_CurSkewBucketNo		skew bucket# for current outer tuple
  *		hj_CurTuple				last inner tuple matched to current outer
  *								tuple, or NULL if starting search
+ *		hj_CurDirPos			bucket directory position of hj_CurTuple,
+ *								if it's in a regular bucket
  *								(hj_CurXXX variables are undefined if
  *								OuterTupleSlot is empty!)
  *		hj_OuterTupleSlot		tuple slot for outer tuples
@@ -1604,6 +1788,7 @@ typedef struct MergeJoinState
  *		hj_JoinState			current state of ExecHashJoin state machine
  *		hj_MatchedOuter			true if found a join match for current outer
  *		hj_OuterNotEmpty		true if outer relation known not empty
+ *		hj_OuterFilter			filter used by the outer scan, or NULL
  * ----------------
  */
 
@@ -1611,6 +1796,35 @@ typedef struct MergeJoinState
 typedef struct HashJoinTupleData *HashJoinTuple;
 typedef struct HashJoinTableData *HashJoinTable;
 
+/* ----------------
+ *	 HashJoinFilter information
+ *
+ *		When the outer side of a hash join is a plain relation scan, and the
+ *		join doesn't return unmatched outer rows, the scan can throw away
+ *		rows whose join keys hash to a value not present in the inner side,
+ *		before doing any other work on them.  The hash table keeps a Bloom
+ *		filter of the inner hash values for that purpose; see nodeHash.c.
+ *		The join owns this struct, and the scan points to it.
+ *
+ *		hashtable		   hash table to consult, or NULL while it is not
+ *						   built, in which case every row passes
+ *		keys			   outer hash key ExprStates, evaluated against the
+ *						   scan tuple
+ *		enabled			   false once the filter has proven not to be worth
+ *						   its cost
+ *		nprobed			   number of rows tested so far
+ *		nremoved		   number of rows thrown away so far
+ * ----------------
+ */
+typedef struct HashJoinFilter
+{
+	HashJoinTable hashtable;
+	List	   *keys;			/* list of ExprState nodes */
+	bool		enabled;
+	double		nprobed;
+	double		nremoved;
+} HashJoinFilter;
+
 typedef struct HashJoinState
 {
 	JoinState	js;				/* its first field is NodeTag */
@@ -1623,6 +1837,7 @@ typedef struct HashJoinState
 	int			hj_CurBucketNo;
 	int			hj_CurSkewBucketNo;
 	HashJoinTuple hj_CurTuple;
+	uint32		hj_CurDirPos;
 	TupleTableSlot *hj_OuterTupleSlot;
 	TupleTableSlot *hj_HashTupleSlot;
 	TupleTableSlot *hj_NullOuterTupleSlot;
@@ -1631,6 +1846,7 @@ typedef struct HashJoinState
 	int			hj_JoinState;
 	bool		hj_MatchedOuter;
 	bool		hj_OuterNotEmpty;
+	HashJoinFilter *hj_OuterFilter;
 } HashJoinState;
 
 
@@ -1656,6 +1872,35 @@ typedef struct MaterialState
 	Tuplestorestate *tuplestorestate;
 } MaterialState;
 
+/* ----------------
+ *	 ResultCacheState information
+ *
+ *		result cache nodes keep the results of their parameterized
+ *		subplan for each set of parameter values they have seen, as long
+ *		as they fit in work_mem; see nodeResultCache.c.
+ * ----------------
+ */
+typedef struct ResultCacheState
+{
+	ScanState	ss;				/* its first field is NodeTag */
+	int			rc_status;		/* state of ExecResultCache state machine */
+	int			nkeys;			/* number of cache keys */
+	List	   *param_exprs;	/* ExprStates giving the key values */
+	Bitmapset  *keyparams;		/* IDs of the Params the keys are made of */
+	int16	   *keytyplen;		/* per-key type info, for hashing, comparing
+								 * and copying values */
+	bool	   *keytypbyval;
+	struct ResultCacheData *cache;	/* the cache itself, private to
+									 * nodeResultCache.c */
+	struct ResultCacheEntry *entry; /* entry being filled or read, or NULL */
+	struct ResultCacheTuple *nexttuple; /* next cached tuple to return */
+	long		hits;			/* statistics for EXPLAIN ANALYZE */
+	long		misses;
+	long		evictions;
+	long		overflows;
+	Size		mem_peak;
+} ResultCacheState;
+
 /* ----------------
  *	 SortState information
  * ----------------
@@ -1672,6 +1917,32 @@ typedef struct SortState
 	void	   *tuplesortstate; /* private state of tuplesort.c */
 } SortState;
 
+/* ----------------
+ *	 IncrementalSortState information
+ *
+ *		Tuples are read and sorted in batches, each made up of whole groups
+ *		of tuples with equal presorted keys.  The first tuple of the next
+ *		batch is held back in lookahead_slot, and group_pivot holds a tuple
+ *		of the group that must be completed before the batch can be sorted.
+ * ----------------
+ */
+typedef struct IncrementalSortState
+{
+	ScanState	ss;				/* its first field is NodeTag */
+	bool		bounded;		/* is the result set bounded? */
+	int64		bound;			/* if bounded, how many tuples are needed */
+	int64		bound_Done;		/* number of tuples returned so far */
+	bool		outerNodeDone;	/* finished fetching from outer node? */
+	FmgrInfo   *eqfunctions;	/* equality fns for presorted columns */
+	TupleTableSlot *group_pivot;	/* tuple of the batch's last group */
+	TupleTableSlot *lookahead_slot; /* first tuple of the next batch */
+	void	   *tuplesortstate; /* private state of tuplesort.c */
+	/* statistics for EXPLAIN ANALYZE */
+	long		nbatches;		/* number of batches sorted */
+	long		maxSpaceUsed;	/* largest batch's space, in kB */
+	const char *maxSpaceType;	/* "Memory" or "Disk" */
+} IncrementalSortState;
+
 /* ---------------------
  *	GroupState information
  * -------------------------
@@ -1692,34 +1963,68 @@ typedef struct GroupState
  *	ecxt_aggnulls arrays, which hold the computed agg values for the current
  *	input group during evaluation of an Agg node's output tuple(s).  We
  *	create a second ExprContext, tmpcontext, in which to evaluate input
- *	expressions and run the aggregate transition functions.
+ *	expressions and run the aggregate transition functions.  Transition
+ *	values live in one further ExprContext per grouping set, aggcontexts[];
+ *	aggcontext is the memory context of whichever of those is in use.
+ *
+ *	With grouping sets, the node runs in one or more phases, one for the
+ *	node itself and one for each Agg node in its chain.  Each sorted phase
+ *	computes a rollup of grouping sets from a single sort order, the input
+ *	of later phases being re-sorted from a copy kept by the previous phase;
+ *	each hashed phase has a hash table of its own, and all the tables are
+ *	filled in a single pass.
  * -------------------------
  */
 /* these structs are private in nodeAgg.c: */
 typedef struct AggStatePerAggData *AggStatePerAgg;
 typedef struct AggStatePerGroupData *AggStatePerGroup;
+typedef struct AggStatePerPhaseData *AggStatePerPhase;
+typedef struct HashAggSpill HashAggSpill;
+struct TupleBatch;
+struct Tuplesortstate;
 
 typedef struct AggState
 {
 	ScanState	ss;				/* its first field is NodeTag */
 	List	   *aggs;			/* all Aggref nodes in targetlist & quals */
 	int			numaggs;		/* length of list (could be zero!) */
-	FmgrInfo   *eqfunctions;	/* per-grouping-field equality fns */
-	FmgrInfo   *hashfunctions;	/* per-grouping-field hash fns */
+	AggStatePerPhase phase;		/* pointer to current phase data */
+	int			numphases;		/* number of phases */
+	int			current_phase;	/* current phase number */
+	AggStatePerPhase phases;	/* array of all phases */
 	AggStatePerAgg peragg;		/* per-Aggref information */
-	MemoryContext aggcontext;	/* memory context for long-lived data */
+	MemoryContext aggcontext;	/* memory context of current grouping set */
+	ExprContext **aggcontexts;	/* econtexts for long-lived data (per set) */
 	ExprContext *tmpcontext;	/* econtext for input expressions */
 	AggStatePerAgg curperagg;	/* identifies currently active aggregate */
+	bool		input_done;		/* indicates end of input */
 	bool		agg_done;		/* indicates completion of Agg scan */
+	int			maxsets;		/* max number of grouping sets in a phase */
+	int			projected_set;	/* last projected grouping set */
+	int			current_set;	/* grouping set being evaluated */
+	Bitmapset  *grouped_cols;	/* grouped cols in current projection */
+	List	   *all_grouped_cols;		/* all grouped cols, in desc order */
+	struct Tuplesortstate *sort_in;		/* sorted input to phases > 0 */
+	struct Tuplesortstate *sort_out;	/* input copied here for next phase */
+	TupleTableSlot *sort_slot;	/* slot for sort results */
 	/* these fields are used in AGG_PLAIN and AGG_SORTED modes: */
-	AggStatePerGroup pergroup;	/* per-Aggref-per-group working state */
+	AggStatePerGroup pergroup;	/* per-Aggref-per-set-per-group state */
 	HeapTuple	grp_firstTuple; /* copy of first tuple of current group */
+	struct TupleBatch *batch;	/* input batch, if AGG_PLAIN reads batches */
+	long		input_batches;	/* number of input batches read */
 	/* these fields are used in AGG_HASHED mode: */
-	TupleHashTable hashtable;	/* hash table with one entry per group */
-	TupleTableSlot *hashslot;	/* slot for loading hash table */
-	List	   *hash_needed;	/* list of columns needed in hash table */
-	bool		table_filled;	/* hash table filled yet? */
-	TupleHashIterator hashiter; /* for iterating through hash table */
+	bool		table_filled;	/* hash tables filled yet? */
+	bool		hash_spill_mode;	/* spilling tuples of new groups? */
+	bool		hash_spilled;	/* has hash table ever spilled since reset? */
+	HashAggSpill *hash_spill;	/* per-phase spill files of current pass,
+								 * or NULL */
+	List	   *hash_batches;	/* spilled batches still to be processed */
+	int			hash_used_bits; /* hash bits that selected current batch */
+	TupleTableSlot *hash_spill_slot;	/* slot for reading spilled tuples */
+	/* these are reported by EXPLAIN ANALYZE: */
+	Size		hash_mem_peak;	/* peak memory used by hash table & states */
+	long		hash_batches_used;	/* number of batches processed */
+	uint64		hash_disk_used; /* bytes written to spill files */
 } AggState;
 
 /* ----------------
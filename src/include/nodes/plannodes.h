@@ -182,12 +182,21 @@ typedef struct ModifyTable
 /* ----------------
  *	 Append node -
  *		Generate the concatenation of the results of sub-plans.
+ *
+ * prune_quals and prune_constraints let the executor skip sub-plans that
+ * can't return any rows once the values of Params are known.  If not NIL,
+ * they have one member per sub-plan: a list of the sub-plan's restriction
+ * clauses that involve Params, and a list of its relation's constraints
+ * those might refute.  Either list is NIL for a sub-plan that can't be
+ * pruned.
  * ----------------
  */
 typedef struct Append
 {
 	Plan		plan;
 	List	   *appendplans;
+	List	   *prune_quals;	/* per-subplan lists of clauses with Params */
+	List	   *prune_constraints;	/* per-subplan lists of constraints */
 } Append;
 
 /* ----------------
@@ -199,6 +208,8 @@ typedef struct MergeAppend
 {
 	Plan		plan;
 	List	   *mergeplans;
+	List	   *prune_quals;	/* run-time pruning info, as for Append */
+	List	   *prune_constraints;
 	/* remaining fields are just like the sort-key info in struct Sort */
 	int			numCols;		/* number of sort-key columns */
 	AttrNumber *sortColIdx;		/* their indexes in the target list */
@@ -272,6 +283,20 @@ typedef struct Scan
  */
 typedef Scan SeqScan;
 
+/* ----------------
+ *		parallel sequential scan node
+ *
+ * Like SeqScan, but the relation's blocks are shared out among the master
+ * and up to num_workers background workers, which evaluate the scan's qual
+ * before passing qualifying tuples back to the master.
+ * ----------------
+ */
+typedef struct ParallelSeqScan
+{
+	Scan		scan;
+	int			num_workers;	/* number of workers to request */
+} ParallelSeqScan;
+
 /* ----------------
  *		index scan node
  *
@@ -518,12 +543,22 @@ typedef struct Join
  * Vars, but perhaps someday that'd be worth relaxing.  (Note: during plan
  * creation, the paramval can actually be a PlaceHolderVar expression; but it
  * must be a Var with varno OUTER_VAR by the time it gets to the executor.)
+ *
+ * If numBatchKeys > 0, the executor reads the outer rows in batches, and
+ * probes the inner side for each batch in the order of the given Params'
+ * values (see nodeNestloop.c).  batchKeyParams holds the positions of those
+ * Params in the nestParams list.
  * ----------------
  */
 typedef struct NestLoop
 {
 	Join		join;
 	List	   *nestParams;		/* list of NestLoopParam nodes */
+	int			numBatchKeys;	/* number of sort keys for outer batches */
+	int		   *batchKeyParams; /* their positions in nestParams */
+	Oid		   *batchSortOperators;		/* OIDs of operators to sort them by */
+	Oid		   *batchCollations;	/* OIDs of collations */
+	bool	   *batchNullsFirst;	/* NULLS FIRST/LAST directions */
 } NestLoop;
 
 typedef struct NestLoopParam
@@ -557,12 +592,17 @@ typedef struct MergeJoin
 
 /* ----------------
  *		hash join node
+ *
+ * filterkeys are the outer hash keys, expressed in terms of the outer scan's
+ * own relation, if the outer scan is to discard rows that can't match; see
+ * HashJoinFilter in execnodes.h.  NIL if not.
  * ----------------
  */
 typedef struct HashJoin
 {
 	Join		join;
 	List	   *hashclauses;
+	List	   *filterkeys;
 } HashJoin;
 
 /* ----------------
@@ -574,6 +614,21 @@ typedef struct Material
 	Plan		plan;
 } Material;
 
+/* ----------------
+ *		result cache node
+ *
+ * Caches the results of its parameterized subplan, for each distinct
+ * combination of the values of param_exprs, which are the Params the
+ * subplan depends on.  The values are compared bytewise.
+ * ----------------
+ */
+typedef struct ResultCache
+{
+	Plan		plan;
+	int			numKeys;		/* number of cache keys */
+	List	   *param_exprs;	/* expressions giving the key values */
+} ResultCache;
+
 /* ----------------
  *		sort node
  * ----------------
@@ -588,6 +643,19 @@ typedef struct Sort
 	bool	   *nullsFirst;		/* NULLS FIRST/LAST directions */
 } Sort;
 
+/* ----------------
+ *		incremental sort node
+ *
+ * The input is already sorted by the first presortedCols sort keys, so only
+ * runs of tuples with equal values in those columns need sorting.
+ * ----------------
+ */
+typedef struct IncrementalSort
+{
+	Sort		sort;
+	int			presortedCols;	/* number of presorted columns */
+} IncrementalSort;
+
 /* ---------------
  *	 group node -
  *		Used for queries with GROUP BY (but no aggregates) specified.
@@ -614,6 +682,15 @@ typedef struct Group
  * executor startup.  (It is possible that there are no aggregate functions;
  * this could happen if they get optimized away by constant-folding, or if
  * we are using the Agg node to implement hash-based grouping.)
+ *
+ * For grouping sets, groupingSets is a list of integer lists, each giving
+ * the ressortgrouprefs of one set; the sets of a sorted Agg are ordered so
+ * that each is a prefix of grpColIdx, longest first.  Grouping sets that
+ * need a different input ordering (or, for AGG_HASHED, a separate hash
+ * table) are handled by the additional Agg nodes in "chain", which are
+ * executed by the top node's AggState and whose lefttrees, if any, are
+ * Sort nodes describing the re-sort needed for that phase.  Chained nodes
+ * have no targetlist or quals of their own and are never run directly.
  * ---------------
  */
 typedef enum AggStrategy
@@ -631,6 +708,11 @@ typedef struct Agg
 	AttrNumber *grpColIdx;		/* their indexes in the target list */
 	Oid		   *grpOperators;	/* equality operators to compare with */
 	long		numGroups;		/* estimated number of groups in input */
+	List	   *groupingSets;	/* grouping sets to use */
+	List	   *chain;			/* chained Agg/Sort nodes */
+	bool		combineStates;	/* input consists of transition states */
+	bool		finalizeAggs;	/* should we call the finalfn on agg states? */
+	bool		serialStates;	/* INTERNAL states are passed as bytea */
 } Agg;
 
 /* ----------------
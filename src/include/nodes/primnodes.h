@@ -243,6 +243,16 @@ typedef struct Param
  * DISTINCT is not supported in this case, so aggdistinct will be NIL.
  * The direct arguments appear in aggdirectargs (as a list of plain
  * expressions, not TargetEntry nodes).
+ *
+ * The planner may split a normal aggregate into a partial step, which emits
+ * the aggregate's transition state (serialized to bytea if the state type is
+ * INTERNAL and the state must pass through a sort or hash table) instead of
+ * the final result, and a combining step that merges such states using the
+ * aggregate's combine function.  A partial Aggref has aggpartial set and its
+ * aggtype is the type of the emitted state.  A combining Aggref has
+ * aggcombine set; its sole argument is the partial state, and aggargtypes
+ * keeps the original argument types, which are needed to resolve
+ * polymorphic transition and result types.  The parser never sets these.
  */
 typedef struct Aggref
 {
@@ -260,9 +270,50 @@ typedef struct Aggref
 	bool		aggvariadic;	/* TRUE if VARIADIC was used in call */
 	char		aggkind;		/* aggregate kind (see pg_aggregate.h) */
 	Index		agglevelsup;	/* > 0 if agg belongs to outer query */
+	bool		aggpartial;		/* TRUE if agg emits its transition state */
+	bool		aggcombine;		/* TRUE if agg combines partial states */
+	List	   *aggargtypes;	/* original arg type OIDs, if aggcombine */
 	int			location;		/* token location, or -1 if unknown */
 } Aggref;
 
+/*
+ * GroupingFunc
+ *
+ * A GroupingFunc is a GROUPING(...) expression, which behaves in many ways
+ * like an aggregate function (e.g. it "belongs" to a specific query level,
+ * which might not be the one immediately containing it), but also differs in
+ * an important respect: it never evaluates its arguments, they merely
+ * designate expressions from the GROUP BY clause of the query level to which
+ * it belongs.
+ *
+ * The spec defines the evaluation of GROUPING() purely by syntactic
+ * replacement, but we make it a real expression for optimization purposes so
+ * that one Agg node can handle multiple grouping sets at once.  Evaluating the
+ * result only needs the column positions to check against the grouping set
+ * being projected.  However, for EXPLAIN to produce meaningful output, we have
+ * to keep the original expressions around, since expression deparse does not
+ * give us any feasible way to get at the GROUP BY clause.
+ *
+ * Also, we treat two GroupingFunc nodes as equal if they have equal arguments
+ * lists and agglevelsup, without comparing the refs and cols annotations.
+ *
+ * In raw parse output we have only the args list; parse analysis fills in the
+ * refs list, and the planner fills in the cols list.  A GROUPING() that
+ * appears in a subquery but refers to an outer query level's grouping
+ * columns has agglevelsup > 0, and is replaced by a Param during planning
+ * just like an outer-level Aggref.
+ */
+typedef struct GroupingFunc
+{
+	Expr		xpr;
+	List	   *args;			/* arguments, not evaluated but kept for
+								 * benefit of EXPLAIN etc. */
+	List	   *refs;			/* ressortgrouprefs of arguments */
+	List	   *cols;			/* actual column positions set by planner */
+	Index		agglevelsup;	/* same as Aggref.agglevelsup */
+	int			location;		/* token location */
+} GroupingFunc;
+
 /*
  * WindowFunc
  */
@@ -99,6 +99,8 @@ typedef struct PlannerGlobal
 	Index		lastRowMarkId;	/* highest PlanRowMark ID assigned */
 
 	bool		transientPlan;	/* redo plan when TransactionXmin changes? */
+
+	bool		parallelModeOK;	/* may parallel workers be used? */
 } PlannerGlobal;
 
 /* macro for fetching the Plan associated with a SubPlan node */
@@ -247,6 +249,9 @@ typedef struct PlannerInfo
 	int			wt_param_id;	/* PARAM_EXEC ID for the work table */
 	struct Plan *non_recursive_plan;	/* plan for non-recursive term */
 
+	/* Maps sortgrouprefs to input columns for GroupingFunc fixup */
+	AttrNumber *grouping_map;
+
 	/* These fields are workspace for createplan.c */
 	Relids		curOuterRels;	/* outer rels above current node */
 	List	   *curOuterParams; /* not-yet-assigned NestLoopParams */
@@ -861,6 +866,19 @@ typedef struct TidPath
 	List	   *tidquals;		/* qual(s) involving CTID = something */
 } TidPath;
 
+/*
+ * ParallelSeqScanPath represents a sequential scan whose blocks are divided
+ * among the master and some background workers
+ *
+ * num_workers is the number of workers the plan will ask for.  The master
+ * always takes part in the scan, so the scan is split num_workers + 1 ways.
+ */
+typedef struct ParallelSeqScanPath
+{
+	Path		path;
+	int			num_workers;	/* number of workers to request */
+} ParallelSeqScanPath;
+
 /*
  * ForeignPath represents a potential scan of a foreign table
  *
@@ -935,6 +953,23 @@ typedef struct MaterialPath
 	Path	   *subpath;
 } MaterialPath;
 
+/*
+ * ResultCachePath represents use of a ResultCache plan node, which caches
+ * the results of a parameterized subpath for each set of parameter values,
+ * for the benefit of a nestloop whose outer side repeats them.  param_exprs
+ * are the outer-relation expressions the subpath's parameters come from;
+ * calls and ndistinct are the expected numbers of rescans and of distinct
+ * parameter values.
+ */
+typedef struct ResultCachePath
+{
+	Path		path;
+	Path	   *subpath;
+	List	   *param_exprs;	/* cache keys, in terms of the outer rel */
+	double		calls;
+	double		ndistinct;
+} ResultCachePath;
+
 /*
  * UniquePath represents elimination of distinct rows from the output of
  * its subpath.
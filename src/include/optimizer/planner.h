@@ -40,6 +40,8 @@ extern void add_tlist_costs_to_plan(PlannerInfo *root, Plan *plan,
 
 extern bool is_dummy_plan(Plan *plan);
 
+extern void mark_partial_aggref(Aggref *agg, bool serialStates);
+
 extern Expr *expression_planner(Expr *expr);
 
 extern Expr *preprocess_phv_expression(PlannerInfo *root, Expr *expr);
@@ -290,6 +290,9 @@ extern ArrayType *create_singleton_array(FunctionCallInfo fcinfo,
 					   int ndims);
 
 extern Datum array_agg_transfn(PG_FUNCTION_ARGS);
+extern Datum array_agg_combine(PG_FUNCTION_ARGS);
+extern Datum array_agg_serialize(PG_FUNCTION_ARGS);
+extern Datum array_agg_deserialize(PG_FUNCTION_ARGS);
 extern Datum array_agg_finalfn(PG_FUNCTION_ARGS);
 
 /*
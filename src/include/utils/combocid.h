@@ -21,5 +21,8 @@
  */
 
 extern void AtEOXact_ComboCid(void);
+extern Size EstimateComboCIDStateSpace(void);
+extern void SerializeComboCIDState(Size maxsize, char *start_address);
+extern void RestoreComboCIDState(char *comboCIDstate);
 
 #endif   /* COMBOCID_H */
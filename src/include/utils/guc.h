@@ -213,6 +213,10 @@ extern PGDLLIMPORT bool check_function_bodies;
 extern bool default_with_oids;
 extern bool SQL_inheritance;
 
+#ifdef TRACE_SORT
+extern bool trace_sort;
+#endif
+
 extern int	log_min_error_statement;
 extern int	log_min_messages;
 extern int	client_min_messages;
@@ -100,6 +100,7 @@ extern Size GetMemoryChunkSpace(void *pointer);
 extern MemoryContext GetMemoryChunkContext(void *pointer);
 extern MemoryContext MemoryContextGetParent(MemoryContext context);
 extern bool MemoryContextIsEmpty(MemoryContext context);
+extern Size MemoryContextMemAllocated(MemoryContext context);
 extern void MemoryContextStats(MemoryContext context);
 
 #ifdef MEMORY_CONTEXT_CHECKING
@@ -117,6 +118,12 @@ extern MemoryContext MemoryContextCreate(NodeTag tag, Size size,
 					MemoryContext parent,
 					const char *name);
 
+/*
+ * Context-type-specific routines must report each block they get from
+ * malloc() or give back to it, so that MemoryContextMemAllocated works.
+ */
+extern void MemoryContextUpdateAllocation(MemoryContext context, int64 delta);
+
 
 /*
  * Memory-context-type-specific functions
@@ -53,9 +53,11 @@ typedef LockInfoData *LockInfo;
 typedef struct RelationAmInfo
 {
 	FmgrInfo	aminsert;
+	FmgrInfo	aminsertmulti;
 	FmgrInfo	ambeginscan;
 	FmgrInfo	amgettuple;
 	FmgrInfo	amgetbitmap;
+	FmgrInfo	amgetbatch;
 	FmgrInfo	amrescan;
 	FmgrInfo	amendscan;
 	FmgrInfo	ammarkpos;
@@ -31,6 +31,14 @@
  * data can be stored using the ssup_extra field.  Any such data
  * should be allocated in the ssup_cxt memory context.
  *
+ * Sort support functions may also offer "abbreviated keys": a pass-by-value
+ * Datum computed once per input value that is cheaper to compare than the
+ * original, and whose comparisons agree with the authoritative comparator
+ * whenever they are not equal.  tuplesort.c stores the abbreviated key in
+ * place of the original leading-column datum and only consults the
+ * authoritative comparator when two abbreviated keys compare equal.  See the
+ * abbreviation fields below.
+ *
  * Note: since pg_amproc functions are indexed by (lefttype, righttype)
  * it is possible to associate a BTSORTSUPPORT function with a cross-type
  * comparison.	This could sensibly be used to provide a fast comparator
@@ -48,6 +56,7 @@
 #define SORTSUPPORT_H
 
 #include "access/attnum.h"
+#include "utils/relcache.h"
 
 typedef struct SortSupportData *SortSupport;
 
@@ -96,8 +105,43 @@ typedef struct SortSupportData
 	int			(*comparator) (Datum x, Datum y, SortSupport ssup);
 
 	/*
-	 * Additional sort-acceleration functions might be added here later.
+	 * "Abbreviated key" infrastructure follows.
+	 *
+	 * abbreviate is set by the caller before calling the BTSORTSUPPORT
+	 * function, to indicate that the caller is able to make use of an
+	 * abbreviated representation (currently, only the leading key of a
+	 * tuplesort is a candidate).  The opclass is free to ignore it.
+	 *
+	 * If the opclass supports abbreviation, it sets abbrev_converter,
+	 * abbrev_abort and abbrev_full_comparator, and replaces comparator with
+	 * a function that compares abbreviated keys.  Abbreviated keys are
+	 * always pass-by-value Datums; a 0 result from comparator means the
+	 * caller must fall back on abbrev_full_comparator, applied to the
+	 * original values, to get an authoritative answer.  Callers that decide
+	 * not to abbreviate after all restore comparator from
+	 * abbrev_full_comparator and forget about the other fields.
+	 */
+	bool		abbreviate;
+
+	/*
+	 * Converts an original representation to an abbreviated key.  The
+	 * original value is guaranteed not null.
 	 */
+	Datum		(*abbrev_converter) (Datum original, SortSupport ssup);
+
+	/*
+	 * Called periodically while abbreviated keys are being generated, with
+	 * the number of tuples converted so far.  Returns true if abbreviation
+	 * looks unlikely to pay off, in which case the caller stops abbreviating
+	 * and rebuilds its leading datums from the original values.
+	 */
+	bool		(*abbrev_abort) (int memtupcount, SortSupport ssup);
+
+	/*
+	 * Full, authoritative comparator for the original representation, used
+	 * to resolve ties between abbreviated keys.
+	 */
+	int			(*abbrev_full_comparator) (Datum x, Datum y, SortSupport ssup);
 } SortSupportData;
 
 
@@ -109,6 +153,9 @@ typedef struct SortSupportData
 extern int ApplySortComparator(Datum datum1, bool isNull1,
 					Datum datum2, bool isNull2,
 					SortSupport ssup);
+extern int ApplySortAbbrevFullComparator(Datum datum1, bool isNull1,
+							  Datum datum2, bool isNull2,
+							  SortSupport ssup);
 #endif   /* !PG_USE_INLINE */
 #if defined(PG_USE_INLINE) || defined(SORTSUPPORT_INCLUDE_DEFINITIONS)
 /*
@@ -147,10 +194,50 @@ ApplySortComparator(Datum datum1, bool isNull1,
 
 	return compare;
 }
+
+/*
+ * Apply a sort comparator function and return a 3-way comparison using full,
+ * authoritative comparator.  This takes care of handling reverse-sort and
+ * NULLs-ordering properly.
+ */
+STATIC_IF_INLINE int
+ApplySortAbbrevFullComparator(Datum datum1, bool isNull1,
+							  Datum datum2, bool isNull2,
+							  SortSupport ssup)
+{
+	int			compare;
+
+	if (isNull1)
+	{
+		if (isNull2)
+			compare = 0;		/* NULL "=" NULL */
+		else if (ssup->ssup_nulls_first)
+			compare = -1;		/* NULL "<" NOT_NULL */
+		else
+			compare = 1;		/* NULL ">" NOT_NULL */
+	}
+	else if (isNull2)
+	{
+		if (ssup->ssup_nulls_first)
+			compare = 1;		/* NOT_NULL ">" NULL */
+		else
+			compare = -1;		/* NOT_NULL "<" NULL */
+	}
+	else
+	{
+		compare = (*ssup->abbrev_full_comparator) (datum1, datum2, ssup);
+		if (ssup->ssup_reverse)
+			compare = -compare;
+	}
+
+	return compare;
+}
 #endif   /*-- PG_USE_INLINE || SORTSUPPORT_INCLUDE_DEFINITIONS */
 
 /* Other functions in utils/sort/sortsupport.c */
 extern void PrepareSortSupportComparisonShim(Oid cmpFunc, SortSupport ssup);
 extern void PrepareSortSupportFromOrderingOp(Oid orderingOp, SortSupport ssup);
+extern void PrepareSortSupportFromIndexRel(Relation indexRel, int16 strategy,
+							   SortSupport ssup);
 
 #endif   /* SORTSUPPORT_H */
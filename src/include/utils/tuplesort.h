@@ -31,6 +31,12 @@
  */
 typedef struct Tuplesortstate Tuplesortstate;
 
+/*
+ * Callback used to read presorted input streams; see
+ * tuplesort_attach_sources().
+ */
+typedef void *(*TuplesortSourceFetch) (void *arg, int source);
+
 /*
  * We provide multiple interfaces to what is essentially the same code,
  * since different callers have different data to be sorted and want to
@@ -80,6 +86,8 @@ extern Tuplesortstate *tuplesort_begin_datum(Oid datumType,
 					  int workMem, bool randomAccess);
 
 extern void tuplesort_set_bound(Tuplesortstate *state, int64 bound);
+extern void tuplesort_attach_sources(Tuplesortstate *state, int nsources,
+						 TuplesortSourceFetch fetch, void *arg);
 
 extern void tuplesort_puttupleslot(Tuplesortstate *state,
 					   TupleTableSlot *slot);
@@ -590,3 +590,92 @@ drop view aggordview1;
 -- variadic aggregates
 select least_agg(q1,q2) from int8_tbl;
 select least_agg(variadic array[q1,q2]) from int8_tbl;
+
+-- hash aggregation that overflows work_mem and has to spill to disk
+set work_mem = '64kB';
+set enable_sort = off;
+explain (costs off)
+select g % 3000 as k, count(*) as c, sum(g) as s
+  from generate_series(1, 6000) g group by 1;
+select count(*), min(c), max(c), sum(s)
+  from (select g % 3000 as k, count(*) as c, sum(g) as s
+          from generate_series(1, 6000) g group by 1) ss;
+-- check from EXPLAIN ANALYZE that it really did spill
+create function hashagg_spill_info(query text,
+                                   out multiple_batches bool,
+                                   out used_disk bool)
+language plpgsql as
+$$
+declare
+  plan json;
+begin
+  execute 'explain (analyze, format json) ' || query into plan;
+  multiple_batches := (plan->0->'Plan'->>'HashAgg Batches')::int > 1;
+  used_disk := (plan->0->'Plan'->>'Disk Usage')::int > 0;
+end;
+$$;
+select * from hashagg_spill_info(
+  'select g % 3000, count(*), sum(g) from generate_series(1, 6000) g group by 1');
+reset work_mem;
+-- with enough memory, the same query doesn't spill
+select * from hashagg_spill_info(
+  'select g % 3000, count(*), sum(g) from generate_series(1, 6000) g group by 1');
+reset enable_sort;
+drop function hashagg_spill_info(text);
+
+-- plain aggregates over a seqscan, which read their input in batches
+select count(*), sum(unique1), max(stringu1), min(ten) from tenk1;
+select count(*), sum(unique1), max(stringu1), min(string4)
+  from tenk1 where ten < 3 and 1 < four;
+select count(*), sum(unique1), max(stringu1)
+  from tenk1 where hundred % 10 = 3;
+create temp table batch_tbl as
+  select g as a, case when g % 4 = 0 then null else g end as b, g::text as c
+  from generate_series(1, 3000) g;
+select count(*), count(b), sum(b), max(c) from batch_tbl;
+select count(*), sum(b) from batch_tbl where b > 1000;
+drop table batch_tbl;
+-- check from EXPLAIN ANALYZE whether the aggregate read batches
+create function agg_input_batches(query text) returns bool
+language plpgsql as
+$$
+declare
+  plan json;
+begin
+  execute 'explain (analyze, format json) ' || query into plan;
+  return coalesce((plan->0->'Plan'->>'Input Batches')::int > 0, false);
+end;
+$$;
+select agg_input_batches('select count(*), sum(unique1), max(stringu1) from tenk1');
+-- an expression argument in a later aggregate rules out batching
+select agg_input_batches('select sum(unique1), sum(unique2 + 1) from tenk1');
+select agg_input_batches(
+  'select count(*) filter (where ten = 0), sum(unique1) from tenk1');
+select sum(unique1), sum(unique2 + 1) from tenk1;
+drop function agg_input_batches(text);
+
+-- aggregation split over the members of an inheritance tree, with the
+-- partial results combined on top
+create temp table pagg_p (k int, v int);
+create temp table pagg_c1 () inherits (pagg_p);
+create temp table pagg_c2 () inherits (pagg_p);
+insert into pagg_p values (1, 100000), (null, 3);
+insert into pagg_c1 select g % 4, g from generate_series(1, 5000) g;
+insert into pagg_c2 select g % 4, g from generate_series(5001, 10000) g;
+analyze pagg_p;
+analyze pagg_c1;
+analyze pagg_c2;
+set enable_hashagg = off;
+explain (costs off)
+select k, count(*), count(v), sum(v), min(v), max(v), avg(v)
+  from pagg_p group by k order by k;
+select k, count(*), count(v), sum(v), min(v), max(v), avg(v)
+  from pagg_p group by k order by k;
+-- internal states have to be serialized between the steps
+explain (costs off)
+select k, sum(v::int8), array_length(array_agg(v), 1), sum_combinable(v)
+  from pagg_p group by k having count(*) > 1 order by k;
+select k, sum(v::int8), array_length(array_agg(v), 1), sum_combinable(v)
+  from pagg_p group by k having count(*) > 1 order by k;
+reset enable_hashagg;
+drop table pagg_p cascade;
@@ -256,6 +256,41 @@ select null::int = all ('{1,2,3}');
 select 33 = all ('{1,null,3}');
 select 33 = all ('{33,null,33}');
 
+-- hashed evaluation of large constant arrays
+select 33 = any ('{1,2,3,4,5,6,7,8,9,33}'::int[]);
+select 34 = any ('{1,2,3,4,5,6,7,8,9,33}'::int[]);
+select 9 = any ('{1,2,3,4,5,6,7,8,9,null}'::int[]);
+select 34 = any ('{1,2,3,4,5,6,7,8,9,null}'::int[]);
+select null::int = any ('{1,2,3,4,5,6,7,8,9}'::int[]);
+select 34 <> all ('{1,2,3,4,5,6,7,8,9,33}'::int[]);
+select 33 <> all ('{1,2,3,4,5,6,7,8,9,33}'::int[]);
+select 34 <> all ('{1,2,3,4,5,6,7,8,9,null}'::int[]);
+select 33::int8 = any ('{1,2,3,4,5,6,7,8,9,33}'::int4[]);
+select 'foo' in ('a', 'b', 'c', 'd', 'e', 'f', 'g', 'h', 'foo');
+select 'foo' not in ('a', 'b', 'c', 'd', 'e', 'f', 'g', 'h', 'i');
+select count(*) from tenk1
+  where unique1 + 0 in (1, 2, 3, 5, 8, 13, 21, 34, 55, 89, 144, 10000);
+select count(*) from tenk1
+  where unique1 + 0 not in (1, 2, 3, 5, 8, 13, 21, 34, 55, 89, 144, 10000);
+select count(*) from tenk1
+  where unique1 + 0 not in (1, 2, 3, 5, 8, 13, 21, 34, 55, 89, 144, null);
+-- quals and target lists must use the hash table too; an equality operator
+-- that reports its calls shows that only matching elements are compared
+create function saop_int_eq(int, int) returns bool
+  language plpgsql strict immutable as
+$$ begin raise notice 'saop_int_eq(%, %)', $1, $2; return $1 = $2; end $$;
+create operator === (procedure = saop_int_eq,
+                     leftarg = int, rightarg = int, hashes);
+create operator class saop_int_ops for type int using hash as
+  operator 1 ===, function 1 hashint4(int);
+select x from (values (3), (12)) v(x)
+  where x === any ('{1,2,3,4,5,6,7,8,9,10}'::int[]);
+select x, x === any ('{1,2,3,4,5,6,7,8,9,10}'::int[]) as found
+  from (values (3), (12)) v(x);
+drop operator family saop_int_ops using hash;
+drop operator === (int, int);
+drop function saop_int_eq(int, int);
+
 -- test indexes on arrays
 create temp table arr_tbl (f1 int[] unique);
 insert into arr_tbl values ('{1,2,3}');
@@ -156,6 +156,30 @@ UPDATE CASE_TBL
 
 SELECT * FROM CASE_TBL;
 
+--
+-- Quals and target lists that are evaluated as flattened step programs
+--
+
+SELECT i, j,
+  CASE i WHEN 1 THEN 'one'
+         WHEN 2 THEN CASE WHEN j < -3 THEN 'two-big' ELSE 'two' END
+         ELSE 'other' END AS c,
+  (i > 1 AND j < -2) AS "and",
+  (i > 1 OR j < -2) AS "or",
+  NOT CASE WHEN j < -2 THEN true WHEN j >= -2 THEN false END AS "not",
+  i IN (1, 3) AS "in",
+  j IS NULL AS "isnull"
+  FROM CASE2_TBL;
+
+SELECT i, j FROM CASE2_TBL
+  WHERE (i IN (2, 3) OR j IS NULL)
+    AND CASE WHEN j < -3 THEN false ELSE true END;
+
+SELECT a.i, a.j, b.j
+  FROM CASE2_TBL a JOIN CASE2_TBL b
+    ON a.i = b.i AND (a.j < b.j OR b.j IS NULL)
+  ORDER BY a.i, a.j, b.j;
+
 --
 -- Clean up
 --
@@ -272,6 +272,35 @@ COMMIT;
 SELECT * FROM vistest;
 DROP TABLE vistest;
 DROP FUNCTION truncate_in_subxact();
+-- parallel COPY FROM
+-- (a unique index would make it load serially)
+CREATE TABLE partest (a int CHECK (a > 0), b text, c text DEFAULT 'dflt');
+CREATE INDEX partest_a_idx ON partest (a);
+COPY partest TO stdout (PARALLEL 2);
+COPY partest FROM stdin (FORMAT binary, PARALLEL 2);
+COPY partest FROM stdin (PARALLEL -1);
+COPY partest (a, b) FROM stdin (PARALLEL 2);
+1	one
+2	two
+3	\N
+\.
+COPY partest (a, b) FROM stdin (FORMAT csv, HEADER, PARALLEL 2);
+a,b
+4,"four
+lines"
+5,""
+6,
+\.
+SELECT * FROM partest ORDER BY a;
+-- the whole load fails if any worker fails
+\set VERBOSITY terse
+COPY partest (a, b) FROM stdin (PARALLEL 2);
+7	seven
+0	zero
+\.
+\set VERBOSITY default
+SELECT count(*) FROM partest;
+DROP TABLE partest;
 DROP TABLE x, y;
 DROP FUNCTION fn_x_before();
 DROP FUNCTION fn_x_after();
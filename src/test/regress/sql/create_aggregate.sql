@@ -101,3 +101,26 @@ alter aggregate my_rank(VARIADIC "any" ORDER BY VARIADIC "any")
   rename to test_rank;
 
 \da test_*
+
+-- aggregates that can be computed in parts and combined
+create aggregate sum_combinable(int4) (
+  stype = int8, sfunc = int4_sum, combinefunc = int8pl
+);
+
+-- invalid: serialization functions are only for internal states
+create aggregate sum_serial(int4) (
+  stype = int8, sfunc = int4_sum, combinefunc = int8pl,
+  serialfunc = numeric_serialize, deserialfunc = numeric_deserialize
+);
+
+-- invalid: serialfunc needs a deserialfunc
+create aggregate avg_serial(numeric) (
+  stype = internal, sfunc = numeric_avg_accum, finalfunc = numeric_avg,
+  combinefunc = numeric_combine, serialfunc = numeric_serialize
+);
+
+-- invalid: ordered-set aggregates can't be combined
+create aggregate percentile_combine(float8 ORDER BY anyelement) (
+  stype = internal, sfunc = ordered_set_transition,
+  finalfunc = percentile_disc_final, combinefunc = array_agg_combine
+);
@@ -917,3 +917,106 @@ ORDER BY thousand;
 SELECT thousand, tenthous FROM tenk1
 WHERE thousand < 2 AND tenthous IN (1001,3000)
 ORDER BY thousand;
+
+--
+-- Check bitmap heap scans that skip fetching all-visible heap pages
+--
+
+CREATE TABLE bmscantest (a int, t text);
+INSERT INTO bmscantest
+  SELECT r, 'fooooooooooooooooooooooooooooooooooooooooooooooooo'
+  FROM generate_series(1,1000) r;
+CREATE INDEX bmscantest_a_idx ON bmscantest (a);
+VACUUM bmscantest;
+
+SET enable_seqscan = OFF;
+SET enable_indexscan = OFF;
+SET enable_indexonlyscan = OFF;
+
+EXPLAIN (COSTS OFF)
+SELECT count(*) FROM bmscantest WHERE a < 100;
+SELECT count(*) FROM bmscantest WHERE a < 100;
+
+-- Heap pages that VACUUM marked all-visible are not fetched.  Whether it could
+-- mark them depends on what else is running, so don't rely on how many it did.
+CREATE FUNCTION bmscan_heap_blocks(query text,
+                                   OUT exact_blocks int,
+                                   OUT skipped_blocks int)
+LANGUAGE plpgsql AS
+$$
+DECLARE
+  plan json;
+BEGIN
+  EXECUTE 'EXPLAIN (ANALYZE, FORMAT JSON) ' || query INTO plan;
+  plan := plan->0->'Plan'->'Plans'->0;
+  exact_blocks := (plan->>'Exact Heap Blocks')::int;
+  skipped_blocks := (plan->>'Skipped Heap Blocks')::int;
+END;
+$$;
+SELECT exact_blocks > 0 AND skipped_blocks <= exact_blocks AS consistent
+  FROM bmscan_heap_blocks('SELECT count(*) FROM bmscantest WHERE a < 100');
+
+-- Updates and deletes clear the visibility map bits of the pages touched
+UPDATE bmscantest SET t = 'bar' WHERE a % 10 = 0;
+SELECT count(*) FROM bmscantest WHERE a < 100;
+SELECT skipped_blocks FROM bmscan_heap_blocks('SELECT count(*) FROM bmscantest WHERE a < 100');
+DELETE FROM bmscantest WHERE a BETWEEN 50 AND 59;
+SELECT count(*) FROM bmscantest WHERE a < 100;
+SELECT skipped_blocks FROM bmscan_heap_blocks('SELECT count(*) FROM bmscantest WHERE a < 100');
+
+-- ... until VACUUM sets them again, if it can
+VACUUM bmscantest;
+SELECT count(*) FROM bmscantest WHERE a < 100;
+SELECT exact_blocks > 0 AND skipped_blocks <= exact_blocks AS consistent
+  FROM bmscan_heap_blocks('SELECT count(*) FROM bmscantest WHERE a < 100');
+
+RESET enable_seqscan;
+RESET enable_indexscan;
+RESET enable_indexonlyscan;
+
+DROP FUNCTION bmscan_heap_blocks(text);
+DROP TABLE bmscantest;
+
+--
+-- Check btree skip scans, for quals on the second index column only
+--
+
+CREATE TABLE skiptest (a int, b int, c text);
+INSERT INTO skiptest SELECT i % 5, i, 'x' || i FROM generate_series(1, 10000) i;
+INSERT INTO skiptest VALUES (NULL, 42, 'null'), (NULL, 43, 'null2');
+CREATE INDEX skiptest_a_b_idx ON skiptest (a, b);
+ANALYZE skiptest;
+
+SET enable_bitmapscan = OFF;
+EXPLAIN (COSTS OFF)
+SELECT * FROM skiptest WHERE b = 42;
+SELECT * FROM skiptest WHERE b = 42;
+SELECT a, b FROM skiptest WHERE b BETWEEN 40 AND 44 ORDER BY a DESC, b DESC;
+SELECT count(*) FROM skiptest WHERE b < 100;
+RESET enable_bitmapscan;
+
+-- When the leading values are dense, the scan reverts to reading the index
+CREATE TABLE skipdense (a int, b int);
+INSERT INTO skipdense SELECT i / 2, i % 3 FROM generate_series(1, 1000) i;
+INSERT INTO skipdense VALUES (NULL, 1);
+CREATE INDEX skipdense_a_b_idx ON skipdense (a, b);
+
+SET enable_seqscan = OFF;
+SELECT count(*), sum(a) FROM skipdense WHERE b = 1;
+SELECT a, b FROM skipdense WHERE b = 1 ORDER BY a DESC LIMIT 3;
+
+-- A scroll cursor must be able to back up past where skipping was given up
+SET enable_bitmapscan = OFF;
+BEGIN;
+DECLARE skipcur SCROLL CURSOR FOR SELECT a, b FROM skipdense WHERE b = 1;
+MOVE FORWARD 10 IN skipcur;
+FETCH BACKWARD ALL FROM skipcur;
+-- ... and past the pass that picks up the nulls
+MOVE FORWARD 335 IN skipcur;
+FETCH BACKWARD 3 FROM skipcur;
+COMMIT;
+RESET enable_bitmapscan;
+RESET enable_seqscan;
+
+DROP TABLE skiptest;
+DROP TABLE skipdense;
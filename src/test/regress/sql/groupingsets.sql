@@ -0,0 +1,120 @@
+--
+-- grouping sets
+--
+
+-- test data sources
+
+create temp table gstest1 (a integer, b integer, v integer);
+insert into gstest1 values (1,1,10),(1,1,11),(1,2,12),(1,2,13),(1,3,14),
+  (2,3,15),(3,3,16),(3,4,17),(4,1,18),(4,1,19);
+
+-- simple rollup with grouping()
+select a, b, grouping(a,b), sum(v), count(*), max(v)
+  from gstest1 group by rollup (a,b) order by a, b;
+explain (costs off)
+  select a, b, sum(v) from gstest1 group by rollup (a,b);
+
+-- cube needs more than one sort order
+select a, b, grouping(a,b), sum(v)
+  from gstest1 group by cube (a,b) order by a, b;
+select a, b, sum(v), count(*)
+  from gstest1 group by grouping sets ((a),(b)) order by a, b;
+
+-- HAVING and ORDER BY involving grouping sets
+select a, b, sum(v)
+  from gstest1 group by rollup (a,b) having sum(v) > 30 order by a, b;
+select a, sum(v), grouping(a)
+  from gstest1 group by rollup (a) order by grouping(a), a;
+
+-- ordered aggregates are computed separately for each grouping set
+select a, count(distinct b)
+  from gstest1 group by rollup (a) order by a;
+
+-- empty input still produces a row for the empty grouping set
+select a, sum(v), count(*) from gstest1 where a > 100 group by rollup (a);
+
+-- empty, duplicate and nested grouping sets
+select count(*), sum(v) from gstest1 group by ();
+select a, count(*), sum(v)
+  from gstest1 group by grouping sets ((), (a), ()) order by a;
+select a, b, sum(v)
+  from gstest1 group by grouping sets ((a), grouping sets ((b), ()))
+  order by a, b;
+
+-- HAVING on grouping columns and GROUPING()
+select a, b, sum(v)
+  from gstest1 group by rollup (a,b) having a is null or b = 3 order by a, b;
+select a, b, sum(v)
+  from gstest1 group by cube (a,b) having grouping(a,b) = 2 order by b;
+
+-- GROUPING() in a subquery can refer to the outer query's grouping
+select a, b, (select grouping(a,b) from (values (1)) v(x)) as g
+  from gstest1 group by rollup (a,b) order by a, b;
+select a, g, s
+  from (select a, grouping(a) as g, sum(v) as s
+          from gstest1 group by rollup (a)) ss
+  where g = 1;
+
+-- window functions over the grouped rows
+select a, sum(v), sum(sum(v)) over (order by a)
+  from gstest1 group by rollup (a) order by a;
+select a, b, grouping(a,b) as g, sum(v),
+       rank() over (partition by grouping(a,b) order by sum(v) desc)
+  from gstest1 group by rollup (a,b) order by g, rank;
+
+-- deparsing of grouping sets in views
+create temp view gstest_view as
+  select a, b, grouping(a,b), sum(v)
+    from gstest1 group by grouping sets (rollup (a,b), cube (b), (a,b), ());
+select pg_get_viewdef('gstest_view'::regclass, true);
+create temp view gstest_view2 as
+  select a, b, count(*) from gstest1 group by rollup (a), b;
+select pg_get_viewdef('gstest_view2'::regclass, true);
+drop view gstest_view;
+drop view gstest_view2;
+
+-- hashed grouping sets
+set enable_sort = off;
+select a, b, grouping(a,b), sum(v)
+  from gstest1 group by grouping sets ((a),(b)) order by a, b;
+
+-- hashed grouping sets that outgrow work_mem spill each set's table
+set work_mem = '64kB';
+select a is null as a_null, count(*), min(n), max(n), sum(s)
+  from (select a, b, count(*) as n, sum(g) as s
+          from (select g, g % 3000 as a, g % 2000 as b
+                  from generate_series(1, 6000) g) s1
+          group by grouping sets ((a), (b))) s2
+  group by 1 order by 1;
+create function gstest_spill_info(query text,
+                                  out strategy text,
+                                  out multiple_batches bool,
+                                  out used_disk bool)
+language plpgsql as
+$$
+declare
+  plan json;
+begin
+  execute 'explain (analyze, format json) ' || query into plan;
+  strategy := plan->0->'Plan'->>'Strategy';
+  multiple_batches := (plan->0->'Plan'->>'HashAgg Batches')::int > 1;
+  used_disk := (plan->0->'Plan'->>'Disk Usage')::int > 0;
+end;
+$$;
+select * from gstest_spill_info(
+  'select a, b, count(*), sum(g)
+     from (select g, g % 3000 as a, g % 2000 as b
+             from generate_series(1, 6000) g) s
+     group by grouping sets ((a), (b))');
+set work_mem = '4MB';
+select * from gstest_spill_info(
+  'select a, b, count(*), sum(g)
+     from (select g, g % 3000 as a, g % 2000 as b
+             from generate_series(1, 6000) g) s
+     group by grouping sets ((a), (b))');
+drop function gstest_spill_info(text);
+reset work_mem;
+reset enable_sort;
+
+-- errors
+select a, grouping(v) from gstest1 group by rollup (a);
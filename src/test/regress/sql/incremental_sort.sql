@@ -0,0 +1,33 @@
+--
+-- INCREMENTAL SORT
+--
+create table incsort_t (a int, b int);
+insert into incsort_t select i / 10, (i * 7919) % 1000
+  from generate_series(1, 10000) i;
+insert into incsort_t values (null, 5), (null, 1), (0, null);
+create index incsort_t_a_idx on incsort_t (a);
+analyze incsort_t;
+
+-- an index on a leading sort column can feed an incremental sort
+explain (costs off)
+select a, b from incsort_t order by a, b limit 12;
+select a, b from incsort_t order by a, b limit 12;
+
+-- without incremental sort, we must sort everything
+set enable_incremental_sort = off;
+explain (costs off)
+select a, b from incsort_t order by a, b limit 12;
+reset enable_incremental_sort;
+
+-- check the whole output, which takes many batches
+set enable_sort = off;
+explain (costs off)
+select a, b from incsort_t order by a, b;
+select count(*) as nrows,
+       sum(case when (pa, pb) > (a, b) then 1 else 0 end) as out_of_order,
+       sum(case when a is null then 1 else 0 end) as null_a
+  from (select a, b, lag(a) over () as pa, lag(b) over () as pb
+        from (select a, b from incsort_t order by a, b) s) ss;
+reset enable_sort;
+
+drop table incsort_t;
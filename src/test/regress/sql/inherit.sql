@@ -473,3 +473,35 @@ FROM generate_series(1, 3) g(i);
 reset enable_seqscan;
 reset enable_indexscan;
 reset enable_bitmapscan;
+
+--
+-- Run-time pruning of inheritance children
+--
+create table rtp (a int);
+create table rtp_1 (check (a = 1)) inherits (rtp);
+create table rtp_2 (check (a = 2)) inherits (rtp);
+create table rtp_3 (check (a = 3)) inherits (rtp);
+insert into rtp_1 values (1);
+insert into rtp_2 values (2);
+insert into rtp_3 values (3);
+analyze rtp_1;
+analyze rtp_2;
+analyze rtp_3;
+
+-- after five custom plans, the generic plan is used; the children that
+-- can't match $1 are removed when it starts up
+prepare rtp_q(int) as select * from rtp where a = $1;
+execute rtp_q(1);
+execute rtp_q(2);
+execute rtp_q(3);
+execute rtp_q(1);
+execute rtp_q(2);
+explain (costs off) execute rtp_q(1);
+execute rtp_q(3);
+deallocate rtp_q;
+
+-- the values of initplan outputs and nestloop parameters are only known
+-- at run time, so the children are just skipped while they can't match
+select * from rtp where a = (select 2);
+select * from (values (1), (3)) v(x), lateral (select * from rtp where a = v.x) s;
+drop table rtp cascade;
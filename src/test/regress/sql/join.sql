@@ -1172,3 +1172,115 @@ update xx1 set x2 = f1 from xx1, lateral (select * from int4_tbl where f1 = x1)
 delete from xx1 using (select * from int4_tbl where f1 = x1) ss;
 delete from xx1 using (select * from int4_tbl where f1 = xx1.x1) ss;
 delete from xx1 using lateral (select * from int4_tbl where f1 = x1) ss;
+
+--
+-- hash joins whose outer scan throws away rows that can't match, using
+-- a Bloom filter of the inner side's keys
+--
+set enable_mergejoin = off;
+set enable_nestloop = off;
+select count(*), sum(a.unique1) from tenk1 a join tenk1 b
+  on a.thousand = b.unique1 where b.ten = 3;
+select count(*), sum(a.unique1) from tenk1 a join tenk1 b
+  on a.thousand = b.unique1 and a.ten = b.ten where b.hundred = 3;
+select count(*) from tenk1 a where a.hundred in (select f1 from int4_tbl);
+select count(*), count(a.unique1) from tenk1 a right join int4_tbl b
+  on a.unique1 = b.f1;
+reset enable_mergejoin;
+reset enable_nestloop;
+
+--
+-- hash joins that have to split the inner relation into batches at run time
+--
+set work_mem = 64;
+set enable_mergejoin = off;
+set enable_nestloop = off;
+select count(*), sum(a.unique1) from tenk1 a
+  join (select * from tenk1 where unique2 % 2 = 0) b on a.unique1 = b.unique2;
+select count(*), count(a.unique1) from tenk1 a
+  right join (select * from tenk1 where unique2 % 2 = 0) b
+  on a.unique1 = b.unique2 * 2;
+reset work_mem;
+reset enable_mergejoin;
+reset enable_nestloop;
+
+--
+-- nested loops that cache the inner side's results for repeated outer values
+--
+set enable_hashjoin = off;
+set enable_mergejoin = off;
+create temp table rc_outer as
+  select i % 10 as a, i % 100 as b from generate_series(1, 1000) i;
+analyze rc_outer;
+select count(*), sum(t.unique1) from rc_outer o join tenk1 t
+  on t.unique1 = o.a;
+select count(*), count(t.unique1), sum(t.unique1) from rc_outer o
+  left join tenk1 t on t.unique1 = o.a + 9995;
+set work_mem = 64;
+select count(*), sum(t.unique1) from rc_outer o join tenk1 t
+  on t.hundred = o.b;
+reset work_mem;
+-- check the cache key and the hit counts
+create function explain_resultcache(query text) returns setof text
+language plpgsql as
+$$
+declare
+  ln text;
+begin
+  for ln in execute 'explain (analyze, costs off, timing off) ' || query loop
+    if ln ~ 'Result Cache|Cache Key|Hits:' then
+      ln := regexp_replace(ln, '^\s*(->\s*)?', '');
+      ln := regexp_replace(ln, ' \(actual .*\)$', '');
+      ln := regexp_replace(ln, 'Memory Usage: \d+', 'Memory Usage: N');
+      return next ln;
+    end if;
+  end loop;
+end;
+$$;
+select explain_resultcache('select count(*), sum(t.unique1) from rc_outer o
+  join tenk1 t on t.unique1 = o.a');
+-- key values are compared bytewise: numeric 1.0 and 1.00 are equal, but
+-- give different results once cast to text
+create temp table rc_num as
+  select (case when i % 2 = 0 then '1.0' else '1.00' end)::numeric as n
+    from generate_series(1, 100) i;
+analyze rc_num;
+create temp table rc_text as select i::text as s from generate_series(1, 1000) i;
+insert into rc_text values ('1.0'), ('1.00');
+create index on rc_text (s);
+analyze rc_text;
+select t.s, count(*) from rc_num o join rc_text t on t.s = o.n::text
+  group by t.s order by t.s;
+select explain_resultcache('select t.s from rc_num o
+  join rc_text t on t.s = o.n::text');
+drop function explain_resultcache(text);
+drop table rc_num;
+drop table rc_text;
+drop table rc_outer;
+reset enable_hashjoin;
+reset enable_mergejoin;
+
+--
+-- nested loops that probe the inner index in sorted batches of outer rows
+--
+set enable_hashjoin = off;
+set enable_mergejoin = off;
+set enable_resultcache = off;
+explain (verbose, costs off)
+select i.f1, t.unique2 from int4_tbl i left join tenk1 t on t.unique2 = i.f1;
+select i.f1, t.unique2 from int4_tbl i left join tenk1 t on t.unique2 = i.f1;
+-- the output must keep the order of the outer rows
+select o.a, t.unique1 from (values (3), (1), (2), (1)) o(a)
+  join tenk1 t on t.unique1 = o.a;
+-- many inner matches per outer row mustn't overrun work_mem
+set enable_bitmapscan = off;
+set work_mem = '64kB';
+select o.a, count(*), sum(t.unique1)
+  from (select g % 4 as a from generate_series(1, 16) g) o
+  join tenk1 t on t.hundred = o.a
+  group by o.a order by o.a;
+reset work_mem;
+reset enable_bitmapscan;
+reset enable_hashjoin;
+reset enable_mergejoin;
+reset enable_resultcache;
@@ -828,3 +828,22 @@ select 12345678901234567890 % 123;
 select 12345678901234567890 / 123;
 select div(12345678901234567890, 123);
 select div(12345678901234567890, 123) * 123 + 12345678901234567890 % 123;
+
+--
+-- Test sorting, including values whose abbreviated sort keys collide or
+-- are clamped
+--
+CREATE TABLE num_sort (id int4, n numeric);
+INSERT INTO num_sort VALUES (1, 'NaN'), (2, 0), (3, 1e-200), (4, -1e-200),
+  (5, 1e400), (6, -1e400), (7, 12345678.9), (8, 12345678.8),
+  (9, 1.00000000000000002), (10, 1.00000000000000001), (11, -5), (12, 5),
+  (13, NULL);
+SELECT id FROM num_sort ORDER BY n;
+SELECT id FROM num_sort ORDER BY n DESC;
+CREATE INDEX num_sort_n_idx ON num_sort (n);
+SET enable_seqscan = off;
+SET enable_bitmapscan = off;
+SELECT id FROM num_sort ORDER BY n;
+RESET enable_seqscan;
+RESET enable_bitmapscan;
+DROP TABLE num_sort;
@@ -29,6 +29,10 @@ SELECT	ctid, aminsert
 FROM	pg_catalog.pg_am fk
 WHERE	aminsert != 0 AND
 	NOT EXISTS(SELECT 1 FROM pg_catalog.pg_proc pk WHERE pk.oid = fk.aminsert);
+SELECT	ctid, aminsertmulti
+FROM	pg_catalog.pg_am fk
+WHERE	aminsertmulti != 0 AND
+	NOT EXISTS(SELECT 1 FROM pg_catalog.pg_proc pk WHERE pk.oid = fk.aminsertmulti);
 SELECT	ctid, ambeginscan
 FROM	pg_catalog.pg_am fk
 WHERE	ambeginscan != 0 AND
@@ -41,6 +45,10 @@ SELECT	ctid, amgetbitmap
 FROM	pg_catalog.pg_am fk
 WHERE	amgetbitmap != 0 AND
 	NOT EXISTS(SELECT 1 FROM pg_catalog.pg_proc pk WHERE pk.oid = fk.amgetbitmap);
+SELECT	ctid, amgetbatch
+FROM	pg_catalog.pg_am fk
+WHERE	amgetbatch != 0 AND
+	NOT EXISTS(SELECT 1 FROM pg_catalog.pg_proc pk WHERE pk.oid = fk.amgetbatch);
 SELECT	ctid, amrescan
 FROM	pg_catalog.pg_am fk
 WHERE	amrescan != 0 AND
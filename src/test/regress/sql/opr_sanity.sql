@@ -992,7 +992,7 @@ WHERE p1.amprocfamily = p3.oid AND p3.opfmethod = p2.oid AND
 
 -- Detect missing pg_amproc entries: should have as many support functions
 -- as AM expects for each datatype combination supported by the opfamily.
--- btree/GiST/GIN each allow one optional support function, though.
+-- btree and GIN each allow one optional support function, GiST two.
 
 SELECT p1.amname, p2.opfname, p3.amproclefttype, p3.amprocrighttype
 FROM pg_am AS p1, pg_opfamily AS p2, pg_amproc AS p3
@@ -1002,12 +1002,13 @@ WHERE p2.opfmethod = p1.oid AND p3.amprocfamily = p2.oid AND
            p4.amproclefttype = p3.amproclefttype AND
            p4.amprocrighttype = p3.amprocrighttype)
     NOT BETWEEN
-      (CASE WHEN p1.amname IN ('btree', 'gist', 'gin') THEN p1.amsupport - 1
+      (CASE WHEN p1.amname IN ('btree', 'gin') THEN p1.amsupport - 1
+            WHEN p1.amname = 'gist' THEN p1.amsupport - 2
             ELSE p1.amsupport END)
       AND p1.amsupport;
 
 -- Also, check if there are any pg_opclass entries that don't seem to have
--- pg_amproc support.  Again, opclasses with an optional support proc have
+-- pg_amproc support.  Again, opclasses with optional support procs have
 -- to be checked specially.
 
 SELECT amname, opcname, count(*)
@@ -1024,7 +1025,8 @@ FROM pg_am am JOIN pg_opclass op ON opcmethod = am.oid
          amproclefttype = amprocrighttype AND amproclefttype = opcintype
 WHERE am.amname = 'btree' OR am.amname = 'gist' OR am.amname = 'gin'
 GROUP BY amname, amsupport, opcname, amprocfamily
-HAVING (count(*) != amsupport AND count(*) != amsupport - 1)
+HAVING (count(*) != amsupport AND count(*) != amsupport - 1 AND
+        (amname <> 'gist' OR count(*) != amsupport - 2))
     OR amprocfamily IS NULL;
 
 -- Unfortunately, we can't check the amproc link very well because the
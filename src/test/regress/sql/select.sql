@@ -207,3 +207,29 @@ drop function sillysrf(int);
 -- (see bug #5084)
 select * from (values (2),(null),(1)) v(k) where k = k order by k;
 select * from (values (2),(null),(1)) v(k) where k = k;
+
+-- Deforming tuples whose leading columns are NOT NULL and fixed-width
+CREATE TEMP TABLE deform_tbl (a int2 NOT NULL, b int8 NOT NULL,
+  c text NOT NULL, d int4, e float8 NOT NULL, f text);
+INSERT INTO deform_tbl VALUES (1, 10, 'one', NULL, 1.5, NULL),
+  (2, 20, 'two', 4, 2.5, 'x'), (3, 30, 'three', NULL, 3.5, 'y');
+SELECT * FROM deform_tbl;
+SELECT e, c, a FROM deform_tbl WHERE d IS NULL;
+ALTER TABLE deform_tbl DROP COLUMN b;
+INSERT INTO deform_tbl VALUES (4, 'four', NULL, 4.5, NULL);
+SELECT * FROM deform_tbl;
+SELECT c, f FROM deform_tbl WHERE a > 1;
+DROP TABLE deform_tbl;
+
+-- Sorts that overflow work_mem are done as quicksorted runs plus a merge
+SET work_mem = '64kB';
+SELECT count(*) AS nrows, count(CASE WHEN prev > x THEN 1 END) AS out_of_order
+  FROM (SELECT x, lag(x) OVER (ORDER BY x) AS prev
+          FROM (SELECT (i * 7919) % 20011 AS x
+                  FROM generate_series(1, 20000) i) s) ss;
+SELECT count(*) AS nrows,
+       count(CASE WHEN prev > t COLLATE "C" THEN 1 END) AS out_of_order
+  FROM (SELECT t, lag(t) OVER (ORDER BY t COLLATE "C") AS prev
+          FROM (SELECT md5(i::text) AS t
+                  FROM generate_series(1, 20000) i) s) ss;
+RESET work_mem;
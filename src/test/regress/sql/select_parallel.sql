@@ -0,0 +1,66 @@
+--
+-- PARALLEL
+--
+
+-- encourage use of parallel plans
+set parallel_setup_cost = 0;
+set parallel_tuple_cost = 0;
+set min_parallel_relation_size = 0;
+set max_parallel_degree = 2;
+
+explain (costs off)
+  select count(*) from tenk1 where ten = 3;
+select count(*) from tenk1 where ten = 3;
+
+-- stopping early must shut the workers down cleanly
+select count(*) from (select * from tenk1 where ten = 3 limit 5) ss;
+
+-- workers can't evaluate volatile functions
+explain (costs off)
+  select count(*) from tenk1 where ten = 3 and random() < 2;
+
+-- nor see the contents of temporary tables
+create temp table parallel_temp as select * from tenk1;
+analyze parallel_temp;
+explain (costs off)
+  select count(*) from parallel_temp where ten = 3;
+drop table parallel_temp;
+
+-- a parallel scan feeding a hash join lets the workers build the hash table
+set enable_mergejoin = off;
+set enable_nestloop = off;
+select count(*) from tenk1 a join tenk2 b on a.unique1 = b.unique2
+  where b.ten < 5;
+-- including when it doesn't all fit in memory
+set work_mem = '64kB';
+select count(*) from tenk1 a join tenk2 b on a.unique1 = b.unique2
+  where b.ten < 5;
+reset work_mem;
+reset enable_nestloop;
+reset enable_mergejoin;
+
+-- btree index builds can share out the heap scan and sort among workers
+create table parallel_index as select * from tenk1;
+create index parallel_index_idx on parallel_index (unique1);
+create unique index parallel_index_uidx on parallel_index (unique2);
+set enable_seqscan = off;
+set enable_bitmapscan = off;
+select count(*), sum(unique1) from parallel_index
+  where unique1 between 100 and 199;
+select count(*) from
+  (select unique1, lag(unique1) over (order by unique1) as prev
+   from parallel_index) ss
+  where prev + 1 <> unique1;
+reset enable_bitmapscan;
+reset enable_seqscan;
+-- uniqueness is checked across the participants' sorted output
+insert into parallel_index (unique1, unique2) values (42, 10000);
+\set VERBOSITY terse
+create unique index parallel_index_dup on parallel_index (unique1);
+\set VERBOSITY default
+drop table parallel_index;
+
+reset max_parallel_degree;
+reset min_parallel_relation_size;
+reset parallel_tuple_cost;
+reset parallel_setup_cost;
@@ -116,3 +116,22 @@ select format('>>%-s<<', 'Hello');
 select format('>>%10L<<', NULL);
 select format('>>%2$*1$L<<', NULL, 'Hello');
 select format('>>%2$*1$L<<', 0, 'Hello');
+
+--
+-- Sorting with abbreviated keys: values that agree in their leading bytes
+-- must still be ordered by the full comparator
+--
+CREATE TEMP TABLE text_sort (t text, b bytea);
+INSERT INTO text_sort VALUES ('abcdefghij', '\x6163'), ('b', '\x61620000'),
+  ('abcdefgh', '\x6162'), ('abc', '\x'), ('abcdefghi', '\x616200'),
+  ('', NULL), (NULL, '\x6161ffffffffffffff');
+SELECT t FROM text_sort ORDER BY t;
+SELECT t FROM text_sort ORDER BY t COLLATE "C" DESC;
+SELECT encode(b, 'hex') FROM text_sort ORDER BY b;
+CREATE INDEX text_sort_t_idx ON text_sort (t COLLATE "C");
+SET enable_seqscan = off;
+SET enable_bitmapscan = off;
+SELECT t FROM text_sort ORDER BY t COLLATE "C";
+RESET enable_seqscan;
+RESET enable_bitmapscan;
+DROP TABLE text_sort;